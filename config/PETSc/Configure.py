@@ -609,6 +609,26 @@ class Configure(config.base.Configure):
     if self.checkLink('#define _POSIX_C_SOURCE 200112L\n#include <stdlib.h>','long v = atoll("25")') or self.checkLink ('#include <stdlib.h>','long v = atoll("25")'):
        self.addDefine('HAVE_ATOLL', '1')
 
+  def configureMPIWinAllocateShared(self):
+    '''Checks for the MPI-3 shared memory windows used by VecScatter with -vecscatter_shared'''
+    if self.mpi.usingMPIUni:
+      return
+    oldFlags = self.compilers.CPPFLAGS
+    oldLibs  = self.compilers.LIBS
+    self.compilers.CPPFLAGS += ' '+self.headers.toString(self.mpi.include)
+    self.compilers.LIBS      = self.libraries.toString(self.mpi.lib)+' '+self.compilers.LIBS
+    self.pushLanguage('C')
+    if self.checkLink('#include <mpi.h>\n', 'MPI_Comm comm;\nMPI_Win win;\nMPI_Aint size;\nint disp;\nvoid *base;\n'
+                      'MPI_Comm_split_type(MPI_COMM_WORLD,MPI_COMM_TYPE_SHARED,0,MPI_INFO_NULL,&comm);\n'
+                      'MPI_Win_allocate_shared(0,1,MPI_INFO_NULL,comm,&base,&win);\n'
+                      'MPI_Win_shared_query(win,0,&size,&disp,&base);\n'
+                      'MPI_Win_lock_all(MPI_MODE_NOCHECK,win);\nMPI_Win_sync(win);\nMPI_Win_unlock_all(win);\n'):
+      self.addDefine('HAVE_MPI_WIN_ALLOCATE_SHARED', 1)
+    self.popLanguage()
+    self.compilers.CPPFLAGS = oldFlags
+    self.compilers.LIBS     = oldLibs
+    return
+
   def configureUnused(self):
     '''Sees if __attribute((unused)) is supported'''
     if self.framework.argDB['with-ios']:
@@ -890,6 +910,7 @@ class Configure(config.base.Configure):
     self.executeTest(self.configureFortranFlush)
     self.executeTest(self.configureFeatureTestMacros)
     self.executeTest(self.configureAtoll)
+    self.executeTest(self.configureMPIWinAllocateShared)
     # dummy rules, always needed except for remote builds
     self.addMakeRule('remote','')
     self.addMakeRule('remoteclean','')
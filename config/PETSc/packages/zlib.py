@@ -0,0 +1,11 @@
+import PETSc.package
+
+class Configure(PETSc.package.NewPackage):
+  def __init__(self, framework):
+    PETSc.package.NewPackage.__init__(self, framework)
+    self.functions = ['compress2']
+    self.includes  = ['zlib.h']
+    self.liblist   = [['libz.a']]
+    self.double    = 0
+    self.complex   = 1
+    return
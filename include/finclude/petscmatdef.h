@@ -136,6 +136,7 @@
 #define MATSOLVERMATLAB       'matlab'
 #define MATSOLVERPETSC        'petsc'
 #define MATSOLVERBAS          'bas'
+#define MATSOLVERETREE        'etree'
 #define MATSOLVERCUSPARSE     'cusparse'
 #define MATSOLVERBSTRM        'bstrm'
 #define MATSOLVERSBSTRM       'sbstrm'
@@ -33,6 +33,7 @@
 #define TSSSP             'ssp'
 #define TSARKIMEX         'arkimex'
 #define TSROSW            'rosw'
+#define TSLSRK            'lsrk'
 
 #define TSSSPType character*(80)
 #define TSSSPRKS2  'rks2'
@@ -82,4 +83,9 @@
 #define TSROSWVELDD4      'veldd4'
 #define TSROSW4L          '4l'
 
+#define TSLSRKType character*(80)
+#define TSLSRKW2  'w2'
+#define TSLSRKW3  'w3'
+#define TSLSRKCK4 'ck4'
+
 #endif
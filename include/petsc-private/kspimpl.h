@@ -187,7 +187,22 @@ PETSC_EXTERN PetscErrorCode DMCopyDMKSP(DM,DM);
 #define KSP_PCApplyBAorAB(ksp,x,y,w)    (!ksp->transpose_solve) ? (PCApplyBAorAB(ksp->pc,ksp->pc_side,x,y,w) || KSP_RemoveNullSpace(ksp,y)) : PCApplyBAorABTranspose(ksp->pc,ksp->pc_side,x,y,w)
 #define KSP_PCApplyBAorABTranspose(ksp,x,y,w)    (!ksp->transpose_solve) ? (PCApplyBAorABTranspose(ksp->pc,ksp->pc_side,x,y,w) || KSP_RemoveNullSpace(ksp,y)) : PCApplyBAorAB(ksp->pc,ksp->pc_side,x,y,w)
 
-PETSC_EXTERN PetscLogEvent KSP_GMRESOrthogonalization, KSP_SetUp, KSP_Solve;
+PETSC_EXTERN PetscLogEvent KSP_GMRESOrthogonalization, KSP_SetUp, KSP_Solve, KSP_MatPowers;
+
+/*
+    The s-step (communication avoiding) methods build s Krylov vectors at once with the three term recurrence
+
+       g_j y_{j+1} = Op y_j - a_j y_j - b_j y_{j-1},   b_0 = 0
+
+    which is the monomial, Newton or Chebyshev basis depending on the coefficients. KSPMatPowers computes the
+    recurrence for Op = A of type MATMPIAIJ, gathering the ghost values needed by all the s steps with one VecScatter.
+*/
+typedef struct _n_KSPMatPowers *KSPMatPowers;
+PETSC_EXTERN PetscErrorCode KSPMatPowersSetUp(Mat,PetscInt,KSPMatPowers*);
+PETSC_EXTERN PetscErrorCode KSPMatPowersApply(KSPMatPowers,PetscInt,const PetscScalar[],const PetscScalar[],const PetscScalar[],Vec[]);
+PETSC_EXTERN PetscErrorCode KSPMatPowersDestroy(KSPMatPowers*);
+PETSC_EXTERN PetscErrorCode KSPCALejaOrder(PetscInt,PetscReal[],PetscReal[]);
+PETSC_EXTERN PetscErrorCode KSPCABasisCoefficients(KSPCABasisType,PetscInt,PetscInt,const PetscReal[],const PetscReal[],PetscScalar[],PetscScalar[],PetscScalar[]);
 
 
 #endif
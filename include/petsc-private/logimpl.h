@@ -83,6 +83,9 @@ PETSC_EXTERN PetscErrorCode PetscLogEventBeginComplete(PetscLogEvent, int, Petsc
 PETSC_EXTERN PetscErrorCode PetscLogEventEndComplete(PetscLogEvent, int, PetscObject, PetscObject, PetscObject, PetscObject);
 PETSC_EXTERN PetscErrorCode PetscLogEventBeginTrace(PetscLogEvent, int, PetscObject, PetscObject, PetscObject, PetscObject);
 PETSC_EXTERN PetscErrorCode PetscLogEventEndTrace(PetscLogEvent, int, PetscObject, PetscObject, PetscObject, PetscObject);
+PETSC_EXTERN PetscErrorCode PetscLogEventBeginTimeline(PetscLogEvent, int, PetscObject, PetscObject, PetscObject, PetscObject);
+PETSC_EXTERN PetscErrorCode PetscLogEventEndTimeline(PetscLogEvent, int, PetscObject, PetscObject, PetscObject, PetscObject);
+PETSC_EXTERN PetscErrorCode PetscLogTimelineDestroy(void);
 
 /* Creation and destruction functions */
 PETSC_EXTERN PetscErrorCode PetscClassRegLogCreate(PetscClassRegLog *);
@@ -212,6 +212,9 @@ PETSC_EXTERN PetscErrorCode MatHeaderMerge(Mat,Mat);
 PETSC_EXTERN PetscErrorCode MatHeaderReplace(Mat,Mat);
 PETSC_EXTERN PetscErrorCode MatAXPYGetxtoy_Private(PetscInt,PetscInt*,PetscInt*,PetscInt*, PetscInt*,PetscInt*,PetscInt*, PetscInt**);
 PETSC_EXTERN PetscErrorCode MatDiagonalSet_Default(Mat,Vec,InsertMode);
+#if defined(PETSC_HAVE_MPIIO)
+PETSC_EXTERN PetscErrorCode MatLoadReadRows_MPIIO_Private(PetscViewer,const PetscInt[],PetscInt,PetscInt,PetscInt[],PetscInt**,PetscScalar**);
+#endif
 
 #if defined(PETSC_USE_DEBUG)
 #  define MatCheckPreallocated(A,arg) do {                              \
@@ -462,6 +465,17 @@ struct  _p_MatFDColoring{
   ISColoringType ctype;            /* IS_COLORING_GLOBAL or IS_COLORING_GHOSTED */
 
   void           *ftn_func_pointer,*ftn_func_cntx; /* serve the same purpose as *fortran_func_pointers in PETSc objects */
+
+  PetscErrorCode (*fmulti)(void*,PetscInt,Vec[],Vec[],void*); /* optional function evaluating several vectors at once */
+  void           *fmultictx;       /* optional user-defined context for use by fmulti */
+  PetscInt       nbatch;           /* number of colors whose perturbed vectors are passed together to fmulti */
+  PetscInt       nwork;            /* number of vectors in wx and wf */
+  Vec            *wx,*wf;          /* perturbed vectors of a batch of colors and their function values */
+  PetscInt       **valaddr;        /* for each color and row, location in the values of the AIJ matrix: k >= 0 in the
+                                      (diagonal) block, -k-1 in the off-diagonal block */
+  PetscInt       valaddr_id;       /* id of the matrix for which valaddr was computed */
+  PetscInt       valaddr_nz;       /* number of nonzeros of that matrix when valaddr was computed */
+  PetscBool      setvalues;        /* insert the differences with MatSetValues() even when valaddr could be computed */
 };
 
 struct  _p_MatTransposeColoring{
@@ -163,7 +163,8 @@ PETSC_EXTERN PetscErrorCode PetscHeaderCreate_Private(PetscObject,PetscClassId,P
    PetscComposedQuantitiesDestroy((PetscObject)*h) || \
    PetscHeaderDestroy_Private((PetscObject)(*h)) ||   \
    PetscFree((*h)->ops) ||                            \
-   PetscFree(*h))
+   PetscFree(*h) ||                                   \
+   PetscMallocPoolRelease())
 
 PETSC_EXTERN PetscErrorCode PetscHeaderDestroy_Private(PetscObject);
 PETSC_EXTERN PetscErrorCode PetscObjectCopyFortranFunctionPointers(PetscObject,PetscObject);
@@ -161,6 +161,9 @@ struct _DMSNESOps {
   /* User-defined smoother */
   PetscErrorCode (*computegs)(SNES,Vec,Vec,void*);
 
+  /* options of the DM-specific callbacks, called by SNESSetFromOptions() */
+  PetscErrorCode (*setfromoptions)(SNES,DMSNES);
+
   PetscErrorCode (*destroy)(DMSNES);
   PetscErrorCode (*duplicate)(DMSNES,DMSNES);
 };
@@ -102,6 +102,7 @@ struct _PetscThreadCommOps {
   PetscErrorCode (*view)(PetscThreadComm,PetscViewer);
   PetscErrorCode (*barrier)(PetscThreadComm);
   PetscErrorCode (*getrank)(PetscInt*);
+  PetscErrorCode (*runrangekernel)(PetscThreadComm,PetscInt,PetscThreadRangeKernel,PetscInt,PetscInt,void*);
 };
 
 struct _p_PetscThreadComm{
@@ -129,10 +130,25 @@ PETSC_EXTERN PetscErrorCode PetscThreadCommRegisterAll(const char path[]);
 #define PetscThreadCommRegisterDynamic(a,b,c,d) PetscThreadCommRegister(a,b,c,d)
 #endif
 
+PETSC_EXTERN PetscLogEvent ThreadComm_RunKernel, ThreadComm_Barrier, ThreadComm_Kernel;
+
+/* Each run of a kernel by a thread is an interval in the timeline of that thread, the other
+   logging is not thread safe so the event is not logged otherwise */
+#if defined(PETSC_USE_LOG)
+#define PetscThreadCommLogKernelBegin() (petsc_logTimeline ? PetscLogEventBegin(ThreadComm_Kernel,0,0,0,0) : 0)
+#define PetscThreadCommLogKernelEnd()   (petsc_logTimeline ? PetscLogEventEnd(ThreadComm_Kernel,0,0,0,0) : 0)
+#else
+#define PetscThreadCommLogKernelBegin() 0
+#define PetscThreadCommLogKernelEnd()   0
+#endif
+
 #undef __FUNCT__
 #define __FUNCT__
 PETSC_STATIC_INLINE PetscErrorCode PetscRunKernel(PetscInt trank,PetscInt nargs,PetscThreadCommJobCtx job)
 {
+  PetscErrorCode ierr;
+
+  ierr = PetscThreadCommLogKernelBegin();if (ierr) return ierr;
   switch(nargs) {
   case 0:
     (*job->pfunc)(trank);
@@ -168,11 +184,11 @@ PETSC_STATIC_INLINE PetscErrorCode PetscRunKernel(PetscInt trank,PetscInt nargs,
     (*job->pfunc)(trank,job->args[0],job->args[1],job->args[2],job->args[3],job->args[4],job->args[5],job->args[6],job->args[7],job->args[8],job->args[9]);
     break;
   }
+  ierr = PetscThreadCommLogKernelEnd();if (ierr) return ierr;
   return 0;
 }
 
 PETSC_EXTERN PetscErrorCode PetscThreadCommReductionCreate(PetscThreadComm,PetscThreadCommReduction*);
 PETSC_EXTERN PetscErrorCode PetscThreadCommReductionDestroy(PetscThreadCommReduction);
 
-PETSC_EXTERN PetscLogEvent ThreadComm_RunKernel, ThreadComm_Barrier;
 #endif
@@ -85,6 +85,18 @@ struct _p_TS {
     PetscBool imex;             /* Flag of the method if it was started as an imex method */
   } ijacobian;
 
+  /* The Jacobian dF/dU + shift*dF/dU_t formed from a constant dF/dU_t and a lagged dF/dU, see TSSetIJacobianSplit() */
+  struct {
+    TSIJacobianSplit f;
+    void *ctx;
+    Mat M;                      /* dF/dU_t */
+    Mat J;                      /* dF/dU */
+    MatStructure mstructure;    /* Nonzero pattern of M relative to the one of J */
+    PetscInt lag;               /* dF/dU is computed at every lag-th evaluation of the Jacobian, only at the first if -1 */
+    PetscInt age;               /* Number of evaluations since dF/dU was computed, -1 before the first */
+    PetscInt nj,nshift;         /* Number of evaluations of dF/dU and of evaluations changing only the shift */
+  } ijacobiansplit;
+
   /* ---------------------Nonlinear Iteration------------------------------*/
   SNES  snes;
 
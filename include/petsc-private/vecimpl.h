@@ -285,6 +285,8 @@ struct _VecOps {
   PetscErrorCode (*dotnorm2)(Vec,Vec,PetscScalar*,PetscScalar*);
   PetscErrorCode (*getsubvector)(Vec,IS,Vec*);
   PetscErrorCode (*restoresubvector)(Vec,IS,Vec*);
+  PetscErrorCode (*mdotnorm)(Vec,PetscInt,const Vec[],PetscScalar*,PetscReal*);
+  PetscErrorCode (*maxpynorm)(Vec,PetscInt,const PetscScalar*,Vec*,PetscReal*);
 };
 
 /*
@@ -310,9 +312,10 @@ typedef struct {
   MPI_Request   *recv_waits;            /* array of receive requests */
   MPI_Status    *send_status;           /* array of send status */
   PetscInt      nsends,nrecvs;          /* numbers of sends and receives */
-  PetscScalar   *svalues,*rvalues;      /* sending and receiving data */
-  PetscInt      *sindices,*rindices;
-  PetscInt      rmax;                   /* maximum message length */
+  PetscScalar   *svalues;               /* sending data */
+  PetscInt      *sindices;
+  PetscScalar   **rvalues;              /* receiving data (values), one buffer per message */
+  PetscInt      **rindices;             /* receiving data (indices) */
   PetscInt      *nprocs;                /* tmp data used both during scatterbegin and end */
   PetscInt      nprocessed;             /* number of messages already processed */
   PetscBool     donotstash;
@@ -356,6 +359,7 @@ PETSC_EXTERN PetscLogEvent VEC_AssemblyEnd, VEC_PointwiseMult, VEC_SetValues, VE
 PETSC_EXTERN PetscLogEvent VEC_SetRandom, VEC_ReduceArithmetic, VEC_ReduceBarrier, VEC_ReduceCommunication;
 PETSC_EXTERN PetscLogEvent VEC_ReduceBegin,VEC_ReduceEnd;
 PETSC_EXTERN PetscLogEvent VEC_Swap, VEC_AssemblyBegin, VEC_NormBarrier, VEC_DotNormBarrier, VEC_DotNorm, VEC_AXPBYPCZ, VEC_Ops;
+PETSC_EXTERN PetscLogEvent VEC_MDotNormBarrier, VEC_MDotNorm, VEC_MAXPYNorm;
 PETSC_EXTERN PetscLogEvent VEC_CUSPCopyToGPU, VEC_CUSPCopyFromGPU;
 PETSC_EXTERN PetscLogEvent VEC_CUSPCopyToGPUSome, VEC_CUSPCopyFromGPUSome;
 
@@ -520,6 +524,14 @@ typedef struct {
   PetscInt               bs;
   PetscBool              sendfirst;
   PetscBool              contiq;
+  /* the indices of each message as runs of blocks with a constant distance, used when they are much fewer than the indices */
+  PetscBool              use_runs;
+  PetscInt               *runstarts;    /* the runs of message i are runstarts[i] to runstarts[i+1]-1 */
+  PetscInt               *runs;         /* first index, number of blocks and distance between the blocks of each run */
+  /* for VecScatterBeginMulti(), one message with the values of several vectors to or from each process */
+  PetscInt               multisize;     /* number of scalars multivalues can hold */
+  PetscScalar            *multivalues;
+  MPI_Request            *multirequests;
   /* for MPI_Alltoallv() approach */
   PetscBool              use_alltoallv;
   PetscMPIInt            *counts,*displs;
@@ -533,6 +545,16 @@ typedef struct {
 #if defined(PETSC_HAVE_MPI_WIN_CREATE)
   MPI_Win                window;
   PetscInt               *winstarts;    /* displacements in the processes I am putting to */
+#endif
+  /* for MPI-3 shared memory, the last nshared messages are with processes on this node and are not sent with MPI */
+  PetscBool              use_shared;
+  PetscInt               nshared;
+#if defined(PETSC_HAVE_MPI_WIN_ALLOCATE_SHARED)
+  MPI_Comm               shmcomm;       /* processes of the scatter on this node */
+  MPI_Win                shmwin;        /* memory each process packs its messages to the node into */
+  PetscScalar            **shmsend;     /* where each message to the node is packed, for both buffers */
+  PetscScalar            **shmrecv;     /* where each message from the node is read, for both buffers */
+  PetscInt               shmparity;     /* buffer used by the current scatter */
 #endif
 } VecScatter_MPI_General;
 
@@ -546,6 +568,8 @@ struct _p_VecScatter {
   PetscBool      reproduce;            /* always receive the ghost points in the same order of processes */
   PetscErrorCode (*begin)(VecScatter,Vec,Vec,InsertMode,ScatterMode);
   PetscErrorCode (*end)(VecScatter,Vec,Vec,InsertMode,ScatterMode);
+  PetscErrorCode (*beginmulti)(VecScatter,PetscInt,Vec*,Vec*,InsertMode,ScatterMode);
+  PetscErrorCode (*endmulti)(VecScatter,PetscInt,Vec*,Vec*,InsertMode,ScatterMode);
   PetscErrorCode (*copy)(VecScatter,VecScatter);
   PetscErrorCode (*destroy)(VecScatter);
   PetscErrorCode (*view)(VecScatter,PetscViewer);
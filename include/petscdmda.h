@@ -265,6 +265,7 @@ M*/
 typedef struct {PetscScalar x,y,z;} DMDACoor3d;
 
 PETSC_EXTERN PetscErrorCode DMDAGetLocalInfo(DM,DMDALocalInfo*);
+PETSC_EXTERN PetscErrorCode DMDAGetLocalInfoSplit(DM,DMDALocalInfo*,PetscInt*,DMDALocalInfo[]);
 
 PETSC_EXTERN PetscErrorCode MatRegisterDAAD(void);
 PETSC_EXTERN PetscErrorCode MatCreateDAAD(DM,Mat*);
@@ -183,6 +183,7 @@ struct _p_ISLocalToGlobalMapping{
   PetscInt globalstart;        /* first global referenced in indices */
   PetscInt globalend;          /* last + 1 global referenced in indices */
   PetscInt *globals;           /* local index for each global index between start and end */
+  void     *globalht;          /* hash table from global to local index, used instead of globals when the globals are sparse */
 };
 typedef struct _p_ISLocalToGlobalMapping* ISLocalToGlobalMapping;
 
@@ -33,6 +33,7 @@ typedef const char* KSPType;
 #define KSPCG         "cg"
 #define KSPGROPPCG    "groppcg"
 #define KSPPIPECG     "pipecg"
+#define KSPCACG       "cacg"
 #define   KSPCGNE       "cgne"
 #define   KSPNASH       "nash"
 #define   KSPSTCG       "stcg"
@@ -42,6 +43,7 @@ typedef const char* KSPType;
 #define   KSPLGMRES     "lgmres"
 #define   KSPDGMRES     "dgmres"
 #define   KSPPGMRES     "pgmres"
+#define   KSPCAGMRES    "cagmres"
 #define KSPTCQMR      "tcqmr"
 #define KSPBCGS       "bcgs"
 #define   KSPIBCGS      "ibcgs"
@@ -573,6 +575,22 @@ PETSC_EXTERN const char *const KSPCGTypes[];
 PETSC_EXTERN PetscErrorCode KSPCGSetType(KSP,KSPCGType);
 PETSC_EXTERN PetscErrorCode KSPCGUseSingleReduction(KSP,PetscBool );
 
+/*E
+    KSPCABasisType - The polynomial basis used by the s-step (communication avoiding) Krylov methods
+       to build several Krylov vectors between two reductions
+
+   Level: advanced
+
+.seealso: KSPCACGSetBasisType(), KSPCAGMRESSetBasisType(), KSPCACG, KSPCAGMRES
+E*/
+typedef enum {KSP_CA_BASIS_MONOMIAL,KSP_CA_BASIS_NEWTON,KSP_CA_BASIS_CHEBYSHEV} KSPCABasisType;
+PETSC_EXTERN const char *const KSPCABasisTypes[];
+
+PETSC_EXTERN PetscErrorCode KSPCACGSetSteps(KSP,PetscInt);
+PETSC_EXTERN PetscErrorCode KSPCACGSetBasisType(KSP,KSPCABasisType);
+PETSC_EXTERN PetscErrorCode KSPCAGMRESSetSteps(KSP,PetscInt);
+PETSC_EXTERN PetscErrorCode KSPCAGMRESSetBasisType(KSP,KSPCABasisType);
+
 PETSC_EXTERN PetscErrorCode KSPNASHSetRadius(KSP,PetscReal);
 PETSC_EXTERN PetscErrorCode KSPNASHGetNormD(KSP,PetscReal *);
 PETSC_EXTERN PetscErrorCode KSPNASHGetObjFcn(KSP,PetscReal *);
@@ -236,6 +236,7 @@ PETSC_EXTERN PetscErrorCode (*PetscLogPHD)(PetscObject);
 PETSC_EXTERN PetscErrorCode PetscLogBegin(void);
 PETSC_EXTERN PetscErrorCode PetscLogAllBegin(void);
 PETSC_EXTERN PetscErrorCode PetscLogTraceBegin(FILE *);
+PETSC_EXTERN PetscErrorCode PetscLogTimelineBegin(PetscInt);
 PETSC_EXTERN PetscErrorCode PetscLogActions(PetscBool);
 PETSC_EXTERN PetscErrorCode PetscLogObjects(PetscBool);
 /* General functions */
@@ -249,6 +250,8 @@ PETSC_EXTERN PetscErrorCode PetscLogView(PetscViewer);
 PETSC_EXTERN PetscErrorCode PetscLogViewPython(PetscViewer);
 PETSC_EXTERN PetscErrorCode PetscLogPrintDetailed(MPI_Comm, const char[]);
 PETSC_EXTERN PetscErrorCode PetscLogDump(const char[]);
+PETSC_EXTERN PetscErrorCode PetscLogTimelineDump(const char[]);
+PETSC_EXTERN PetscBool      petsc_logTimeline;
 
 PETSC_EXTERN PetscErrorCode PetscGetFlops(PetscLogDouble *);
 
@@ -452,6 +455,8 @@ PETSC_STATIC_INLINE PetscErrorCode PetscMPITypeSizeComm(MPI_Comm comm, PetscLogD
 #define PetscLogPrintDetailed(comm,file)    0
 #define PetscLogBegin()                     0
 #define PetscLogTraceBegin(file)            0
+#define PetscLogTimelineBegin(size)         0
+#define PetscLogTimelineDump(c)             0
 #define PetscLogSet(lb,le)                  0
 #define PetscLogAllBegin()                  0
 #define PetscLogDump(c)                     0
@@ -1064,6 +1064,8 @@ PETSC_EXTERN PetscErrorCode (*PetscTrMalloc)(size_t,int,const char[],const char[
 PETSC_EXTERN PetscErrorCode (*PetscTrFree)(void*,int,const char[],const char[],const char[]);
 PETSC_EXTERN PetscErrorCode PetscMallocSet(PetscErrorCode (*)(size_t,int,const char[],const char[],const char[],void**),PetscErrorCode (*)(void*,int,const char[],const char[],const char[]));
 PETSC_EXTERN PetscErrorCode PetscMallocClear(void);
+PETSC_EXTERN PetscErrorCode PetscMallocPool(size_t,int,const char[],const char[],const char[],void**);
+PETSC_EXTERN PetscErrorCode PetscFreePool(void*,int,const char[],const char[],const char[]);
 
 /*
     PetscLogDouble variables are used to contain double precision numbers
@@ -1085,6 +1087,8 @@ PETSC_EXTERN PetscErrorCode PetscMallocValidate(int,const char[],const char[],co
 PETSC_EXTERN PetscErrorCode PetscMallocSetDumpLog(void);
 PETSC_EXTERN PetscErrorCode PetscMallocSetDumpLogThreshold(PetscLogDouble);
 PETSC_EXTERN PetscErrorCode PetscMallocGetDumpLog(PetscBool*);
+PETSC_EXTERN PetscErrorCode PetscMallocPoolGetUsage(PetscLogDouble*,PetscLogDouble*,PetscLogDouble*,PetscLogDouble*);
+PETSC_EXTERN PetscErrorCode PetscMallocPoolRelease(void);
 
 /*E
     PetscDataType - Used for handling different basic data types.
@@ -1244,6 +1248,15 @@ typedef struct _n_PetscOpFunctionList *PetscOpFunctionList;
 E*/
 typedef enum {FILE_MODE_READ, FILE_MODE_WRITE, FILE_MODE_APPEND, FILE_MODE_UPDATE, FILE_MODE_APPEND_UPDATE} PetscFileMode;
 
+/*S
+     PetscAsyncWriter - Writes data to files in the background, from a pool of staging buffers
+
+   Level: developer
+
+.seealso:  PetscAsyncWriterCreate(), PetscAsyncWriterGetBuffer(), PetscAsyncWriterPost()
+S*/
+typedef struct _n_PetscAsyncWriter *PetscAsyncWriter;
+
 #include <petscviewer.h>
 #include <petscoptions.h>
 
@@ -2380,6 +2393,12 @@ PETSC_EXTERN PetscErrorCode PetscBinarySeek(int,off_t,PetscBinarySeekType,off_t*
 PETSC_EXTERN PetscErrorCode PetscBinarySynchronizedSeek(MPI_Comm,int,off_t,PetscBinarySeekType,off_t*);
 PETSC_EXTERN PetscErrorCode PetscByteSwap(void *,PetscDataType,PetscInt);
 
+PETSC_EXTERN PetscErrorCode PetscAsyncWriterCreate(PetscInt,PetscAsyncWriter*);
+PETSC_EXTERN PetscErrorCode PetscAsyncWriterGetBuffer(PetscAsyncWriter,size_t,void**);
+PETSC_EXTERN PetscErrorCode PetscAsyncWriterPost(PetscAsyncWriter,const char[],PetscInt,const Petsc64bitInt[],const size_t[],Petsc64bitInt);
+PETSC_EXTERN PetscErrorCode PetscAsyncWriterFlush(PetscAsyncWriter);
+PETSC_EXTERN PetscErrorCode PetscAsyncWriterDestroy(PetscAsyncWriter*);
+
 PETSC_EXTERN PetscErrorCode PetscSetDebugTerminal(const char[]);
 PETSC_EXTERN PetscErrorCode PetscSetDebugger(const char[],PetscBool );
 PETSC_EXTERN PetscErrorCode PetscSetDefaultDebugger(void);
@@ -2393,6 +2412,9 @@ PETSC_EXTERN PetscErrorCode PetscGatherMessageLengths2(MPI_Comm,PetscMPIInt,Pets
 PETSC_EXTERN PetscErrorCode PetscPostIrecvInt(MPI_Comm,PetscMPIInt,PetscMPIInt,const PetscMPIInt[],const PetscMPIInt[],PetscInt***,MPI_Request**);
 PETSC_EXTERN PetscErrorCode PetscPostIrecvScalar(MPI_Comm,PetscMPIInt,PetscMPIInt,const PetscMPIInt[],const PetscMPIInt[],PetscScalar***,MPI_Request**);
 PETSC_EXTERN PetscErrorCode PetscCommBuildTwoSided(MPI_Comm,PetscMPIInt,MPI_Datatype,PetscInt,const PetscMPIInt*,const void*,PetscInt*,PetscMPIInt**,void*) PetscAttrMPIPointerWithType(6,3);
+PETSC_EXTERN PetscErrorCode PetscCommBuildTwoSidedF(MPI_Comm,PetscMPIInt,MPI_Datatype,PetscInt,const PetscMPIInt*,const void*,PetscInt*,PetscMPIInt**,void*,PetscMPIInt,MPI_Request**,MPI_Request**,
+                                                    PetscErrorCode (*send)(MPI_Comm,const PetscMPIInt[],PetscMPIInt,PetscMPIInt,void*,MPI_Request[],void*),
+                                                    PetscErrorCode (*recv)(MPI_Comm,const PetscMPIInt[],PetscMPIInt,void*,MPI_Request[],void*),void*) PetscAttrMPIPointerWithType(6,3);
 
 PETSC_EXTERN PetscErrorCode PetscSSEIsEnabled(MPI_Comm,PetscBool  *,PetscBool  *);
 
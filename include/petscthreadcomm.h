@@ -6,6 +6,9 @@
 /* Function pointer cast for the kernel function */
 PETSC_EXTERN_TYPEDEF typedef PetscErrorCode (*PetscThreadKernel)(PetscInt,...);
 
+/* Kernel run on the subrange [start,end) of an iteration space: kernel(thread_id,start,end,ctx) */
+PETSC_EXTERN_TYPEDEF typedef PetscErrorCode (*PetscThreadRangeKernel)(PetscInt,PetscInt,PetscInt,void*);
+
 /*
   PetscThreadComm - Abstract object that manages all thread communication models
 
@@ -28,6 +31,7 @@ typedef const char* PetscThreadCommType;
 #define PTHREAD             "pthread"
 #define NOTHREAD            "nothread"
 #define OPENMP              "openmp"
+#define WORKSTEAL           "worksteal"
 
 PETSC_EXTERN PetscFunctionList PetscThreadCommList;
 
@@ -54,6 +58,8 @@ PETSC_EXTERN PetscErrorCode PetscThreadCommRunKernel2(MPI_Comm,PetscErrorCode (*
 PETSC_EXTERN PetscErrorCode PetscThreadCommRunKernel3(MPI_Comm,PetscErrorCode (*)(PetscInt,...),void*,void*,void*);
 PETSC_EXTERN PetscErrorCode PetscThreadCommRunKernel4(MPI_Comm,PetscErrorCode (*)(PetscInt,...),void*,void*,void*,void*);
 PETSC_EXTERN PetscErrorCode PetscThreadCommRunKernel6(MPI_Comm,PetscErrorCode (*)(PetscInt,...),void*,void*,void*,void*,void*,void*);
+PETSC_EXTERN PetscErrorCode PetscThreadCommRunRangeKernel(MPI_Comm,PetscThreadRangeKernel,PetscInt,PetscInt,void*);
+PETSC_EXTERN PetscErrorCode PetscThreadKernelRunRange(PetscInt,PetscThreadComm,PetscThreadRangeKernel,PetscInt,PetscInt,void*);
 PETSC_EXTERN PetscErrorCode PetscThreadCommBarrier(MPI_Comm);
 PETSC_EXTERN PetscErrorCode PetscThreadCommGetOwnershipRanges(MPI_Comm,PetscInt,PetscInt*[]);
 PETSC_EXTERN PetscErrorCode PetscThreadCommRegisterDestroy(void);
@@ -40,6 +40,7 @@ typedef const char* TSType;
 #define TSSSP             "ssp"
 #define TSARKIMEX         "arkimex"
 #define TSROSW            "rosw"
+#define TSLSRK            "lsrk"
 
 /*E
     TSProblemType - Determines the type of problem this TS object is to be used to solve
@@ -205,6 +206,11 @@ PETSC_EXTERN PetscErrorCode TSMonitorSolutionBinary(TS,PetscInt,PetscReal,Vec,vo
 PETSC_EXTERN PetscErrorCode TSMonitorSolutionVTK(TS,PetscInt,PetscReal,Vec,void*);
 PETSC_EXTERN PetscErrorCode TSMonitorSolutionVTKDestroy(void*);
 
+typedef struct _n_TSMonitorAsyncCtx*  TSMonitorAsyncCtx;
+PETSC_EXTERN PetscErrorCode TSMonitorAsyncCtxCreate(MPI_Comm,PetscViewerType,const char[],PetscInt,TSMonitorAsyncCtx*);
+PETSC_EXTERN PetscErrorCode TSMonitorAsyncCtxDestroy(TSMonitorAsyncCtx*);
+PETSC_EXTERN PetscErrorCode TSMonitorSolutionAsync(TS,PetscInt,PetscReal,Vec,void*);
+
 PETSC_EXTERN PetscErrorCode TSStep(TS);
 PETSC_EXTERN PetscErrorCode TSEvaluateStep(TS,PetscInt,Vec,PetscBool*);
 PETSC_EXTERN PetscErrorCode TSSolve(TS,Vec);
@@ -244,6 +250,9 @@ PETSC_EXTERN PetscErrorCode TSSetIFunction(TS,Vec,TSIFunction,void*);
 PETSC_EXTERN PetscErrorCode TSGetIFunction(TS,Vec*,TSIFunction*,void**);
 PETSC_EXTERN PetscErrorCode TSSetIJacobian(TS,Mat,Mat,TSIJacobian,void*);
 PETSC_EXTERN PetscErrorCode TSGetIJacobian(TS,Mat*,Mat*,TSIJacobian*,void**);
+PETSC_EXTERN_TYPEDEF typedef PetscErrorCode (*TSIJacobianSplit)(TS,PetscReal,Vec,Vec,Mat,void*);
+PETSC_EXTERN PetscErrorCode TSSetIJacobianSplit(TS,Mat,Mat,Mat,MatStructure,Mat,TSIJacobianSplit,void*);
+PETSC_EXTERN PetscErrorCode TSSetIJacobianSplitLag(TS,PetscInt);
 
 PETSC_EXTERN PetscErrorCode TSComputeRHSFunctionLinear(TS,PetscReal,Vec,Vec,void*);
 PETSC_EXTERN PetscErrorCode TSComputeRHSJacobianConstant(TS,PetscReal,Vec,Mat*,Mat*,MatStructure*,void*);
@@ -760,6 +769,25 @@ PETSC_EXTERN PetscErrorCode TSARKIMEXInitializePackage(const char path[]);
 PETSC_EXTERN PetscErrorCode TSARKIMEXRegisterDestroy(void);
 PETSC_EXTERN PetscErrorCode TSARKIMEXRegisterAll(void);
 
+/*J
+    TSLSRKType - String with the name of a low-storage Runge-Kutta method.
+
+   Level: beginner
+
+.seealso: TSLSRKSetType(), TS, TSLSRK, TSLSRKRegister()
+J*/
+typedef const char* TSLSRKType;
+#define TSLSRKW2  "w2"
+#define TSLSRKW3  "w3"
+#define TSLSRKCK4 "ck4"
+PETSC_EXTERN PetscErrorCode TSLSRKGetType(TS ts,TSLSRKType*);
+PETSC_EXTERN PetscErrorCode TSLSRKSetType(TS ts,TSLSRKType);
+PETSC_EXTERN PetscErrorCode TSLSRKRegister(TSLSRKType,PetscInt,PetscInt,const PetscReal[],const PetscReal[],const PetscReal[]);
+PETSC_EXTERN PetscErrorCode TSLSRKFinalizePackage(void);
+PETSC_EXTERN PetscErrorCode TSLSRKInitializePackage(const char path[]);
+PETSC_EXTERN PetscErrorCode TSLSRKRegisterDestroy(void);
+PETSC_EXTERN PetscErrorCode TSLSRKRegisterAll(void);
+
 /*J
     TSRosWType - String with the name of a Rosenbrock-W method.
 
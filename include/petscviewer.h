@@ -274,6 +274,10 @@ PETSC_EXTERN PetscErrorCode PetscViewerHDF5OpenGroup(PetscViewer, hid_t *, hid_t
 typedef enum {PETSC_VTK_POINT_FIELD, PETSC_VTK_POINT_VECTOR_FIELD, PETSC_VTK_CELL_FIELD, PETSC_VTK_CELL_VECTOR_FIELD} PetscViewerVTKFieldType;
 PETSC_EXTERN PetscErrorCode PetscViewerVTKAddField(PetscViewer,PetscObject,PetscErrorCode (*PetscViewerVTKWriteFunction)(PetscObject,PetscViewer),PetscViewerVTKFieldType,PetscObject);
 PETSC_EXTERN PetscErrorCode PetscViewerVTKOpen(MPI_Comm,const char[],PetscFileMode,PetscViewer*);
+PETSC_EXTERN PetscErrorCode PetscViewerVTKSetAggregators(PetscViewer,PetscInt);
+PETSC_EXTERN PetscErrorCode PetscViewerVTKSetMPIIO(PetscViewer,PetscBool);
+PETSC_EXTERN PetscErrorCode PetscViewerVTKSetCompression(PetscViewer,PetscInt);
+PETSC_EXTERN PetscErrorCode PetscViewerVTKSetAsyncWriter(PetscViewer,PetscAsyncWriter);
 
 /*
      These are all the default viewers that do not have
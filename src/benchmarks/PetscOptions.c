@@ -0,0 +1,66 @@
+static char help[] = "Times options database lookups as the number of options grows.\n\n\
+  -nmax <n>   largest number of options in the database\n\
+  -its <its>  number of lookups timed for each size\n\n";
+
+#include <petscsys.h>
+extern PetscErrorCode PetscOptionsFindPairPrefix_Private(const char[],const char[],char*[],PetscBool*);
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       nmax = 8192,its = 100000,n,nset = 0,i,value;
+  PetscBool      flg;
+  char           name[64],pre[64],str[16];
+  PetscLogDouble x,y,thit,tmiss,tprefix;
+
+  PetscInitialize(&argc,&argv,0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-nmax",&nmax,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-its",&its,PETSC_NULL);CHKERRQ(ierr);
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%8s %14s %14s %14s\n","Options","Found (sec)","Missing (sec)","Prefix (sec)");CHKERRQ(ierr);
+  for (n=16; n<=nmax; n*=2) {
+    /* add options such as -sys17_ksp_rtol until there are n of them, as for many prefixed solvers */
+    for (; nset<n; nset++) {
+      ierr = PetscSNPrintf(name,sizeof(name),"-sys%D_ksp_rtol",nset);CHKERRQ(ierr);
+      ierr = PetscSNPrintf(str,sizeof(str),"%D",nset);CHKERRQ(ierr);
+      ierr = PetscOptionsSetValue(name,str);CHKERRQ(ierr);
+    }
+
+    ierr = PetscGetTime(&x);CHKERRQ(ierr);
+    for (i=0; i<its; i++) {
+      ierr = PetscSNPrintf(pre,sizeof(pre),"sys%D_",(i*7919)%n);CHKERRQ(ierr);
+      ierr = PetscOptionsGetInt(pre,"-ksp_rtol",&value,&flg);CHKERRQ(ierr);
+      if (!flg || value != (i*7919)%n) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Option %s not found",pre);
+    }
+    ierr = PetscGetTime(&y);CHKERRQ(ierr);
+    thit = (y-x)/its;
+
+    ierr = PetscGetTime(&x);CHKERRQ(ierr);
+    for (i=0; i<its; i++) {
+      ierr = PetscSNPrintf(pre,sizeof(pre),"sys%D_",(i*7919)%n);CHKERRQ(ierr);
+      ierr = PetscOptionsHasName(pre,"-ksp_atol",&flg);CHKERRQ(ierr);
+      if (flg) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Option %sksp_atol should not be set",pre);
+    }
+    ierr = PetscGetTime(&y);CHKERRQ(ierr);
+    tmiss = (y-x)/its;
+
+    ierr = PetscGetTime(&x);CHKERRQ(ierr);
+    for (i=0; i<its; i++) {
+      ierr = PetscSNPrintf(pre,sizeof(pre),"-sys%D_ksp",(i*7919)%n);CHKERRQ(ierr);
+      ierr = PetscOptionsFindPairPrefix_Private(PETSC_NULL,pre,PETSC_NULL,&flg);CHKERRQ(ierr);
+      if (!flg) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_PLIB,"No option starts with %s",pre);
+    }
+    ierr = PetscGetTime(&y);CHKERRQ(ierr);
+    tprefix = (y-x)/its;
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%8D %14e %14e %14e\n",n,thit,tmiss,tprefix);CHKERRQ(ierr);
+  }
+
+  for (i=0; i<nset; i++) {
+    ierr = PetscSNPrintf(name,sizeof(name),"-sys%D_ksp_rtol",i);CHKERRQ(ierr);
+    ierr = PetscOptionsClearValue(name);CHKERRQ(ierr);
+  }
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,104 @@
+
+static char help[] = "Measures the ghost point exchange of a 3d DMDA, DMGlobalToLocalBegin() and DMGlobalToLocalEnd(), with MPI and\n\
+with MPI-3 shared memory for the processes on the same node (-vecscatter_shared).\n\n\
+  -da_grid_x <M>, -da_grid_y <N>, -da_grid_z <P>  size of the grid\n\
+  -dof <dof>        number of degrees of freedom per grid point\n\
+  -stencil_width <s> width of the ghost region\n\
+  -box              use a box stencil instead of a star stencil\n\
+  -its <its>        number of exchanges timed\n\n";
+
+/*
+   For example, on one node
+      mpiexec -n 8 ./HaloExchange -da_grid_x 128 -da_grid_y 128 -da_grid_z 128 -dof 3 -its 200
+*/
+#include <petscdmda.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "TimeExchange"
+/* returns the time of one exchange, the slowest process counts */
+static PetscErrorCode TimeExchange(DM da,Vec g,Vec l,PetscInt its,PetscLogDouble *time)
+{
+  PetscErrorCode ierr;
+  PetscInt       i;
+  PetscLogDouble t0,t1;
+
+  PetscFunctionBegin;
+  /* the first exchanges set up the communication and are not timed */
+  for (i=0; i<3; i++) {
+    ierr = DMGlobalToLocalBegin(da,g,INSERT_VALUES,l);CHKERRQ(ierr);
+    ierr = DMGlobalToLocalEnd(da,g,INSERT_VALUES,l);CHKERRQ(ierr);
+  }
+  ierr = MPI_Barrier(((PetscObject)da)->comm);CHKERRQ(ierr);
+  ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+  for (i=0; i<its; i++) {
+    ierr = DMGlobalToLocalBegin(da,g,INSERT_VALUES,l);CHKERRQ(ierr);
+    ierr = DMGlobalToLocalEnd(da,g,INSERT_VALUES,l);CHKERRQ(ierr);
+  }
+  ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+  t1  -= t0;
+  ierr = MPI_Allreduce(&t1,time,1,MPIU_PETSCLOGDOUBLE,MPI_MAX,((PetscObject)da)->comm);CHKERRQ(ierr);
+  *time /= its;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode  ierr;
+  PetscInt        M = 64,N = 64,P = 64,dof = 1,s = 1,its = 100,nlocal,nghost,k,ghosts,totalghosts;
+  PetscBool       box = PETSC_FALSE;
+  PetscMPIInt     size;
+  PetscReal       nrm;
+  PetscLogDouble  time[2];
+  DM              da[2];
+  Vec             g,l[2];
+  const char      *names[2] = {"MPI","MPI-3 shared memory"};
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-da_grid_x",&M,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-da_grid_y",&N,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-da_grid_z",&P,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-dof",&dof,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-stencil_width",&s,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-its",&its,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-box",&box,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+
+  /* the scatters of the two DMDAs are set up without and with the shared memory messages */
+  for (k=0; k<2; k++) {
+    if (k) {ierr = PetscOptionsSetValue("-vecscatter_shared",PETSC_NULL);CHKERRQ(ierr);}
+    ierr = DMDACreate3d(PETSC_COMM_WORLD,DMDA_BOUNDARY_NONE,DMDA_BOUNDARY_NONE,DMDA_BOUNDARY_NONE,box ? DMDA_STENCIL_BOX : DMDA_STENCIL_STAR,
+                        M,N,P,PETSC_DECIDE,PETSC_DECIDE,PETSC_DECIDE,dof,s,PETSC_NULL,PETSC_NULL,PETSC_NULL,&da[k]);CHKERRQ(ierr);
+    if (k) {ierr = PetscOptionsClearValue("-vecscatter_shared");CHKERRQ(ierr);}
+    ierr = DMCreateLocalVector(da[k],&l[k]);CHKERRQ(ierr);
+  }
+  ierr = DMCreateGlobalVector(da[0],&g);CHKERRQ(ierr);
+  ierr = VecSetRandom(g,PETSC_NULL);CHKERRQ(ierr);
+
+  /* the ghost points received by each process */
+  ierr = VecGetLocalSize(g,&nlocal);CHKERRQ(ierr);
+  ierr = VecGetLocalSize(l[0],&nghost);CHKERRQ(ierr);
+  ghosts = nghost - nlocal;
+  ierr = MPI_Allreduce(&ghosts,&totalghosts,1,MPIU_INT,MPI_SUM,PETSC_COMM_WORLD);CHKERRQ(ierr);
+
+  for (k=0; k<2; k++) {
+    ierr = TimeExchange(da[k],g,l[k],its,&time[k]);CHKERRQ(ierr);
+  }
+  ierr = VecAXPY(l[1],-1.0,l[0]);CHKERRQ(ierr);
+  ierr = VecNorm(l[1],NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  if (nrm != 0.0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Shared memory exchange differs by %G",nrm);
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Grid %D x %D x %D, %D dof, stencil width %D, %d processes, %D ghost values in total\n",M,N,P,dof,s,size,totalghosts);CHKERRQ(ierr);
+  for (k=0; k<2; k++) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"  %-20s %10.3e s per exchange, %8.1f MB/s\n",names[k],time[k],1.e-6*totalghosts*sizeof(PetscScalar)/time[k]);CHKERRQ(ierr);
+  }
+
+  for (k=0; k<2; k++) {
+    ierr = VecDestroy(&l[k]);CHKERRQ(ierr);
+    ierr = DMDestroy(&da[k]);CHKERRQ(ierr);
+  }
+  ierr = VecDestroy(&g);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,142 @@
+static char help[] = "Tests and benchmarks the ways of writing a DMDA vector to VTK XML files.\n\n\
+  -M <M>, -N <N>, -P <P>    grid size\n\
+  -aggregators <n>          number of processes writing the pieces of the parallel file\n\
+  -compress <level>         zlib compression level, 0 for none\n\
+  -benchmark                print the time and the size of the output of each way\n\n";
+
+/*
+   The vector is written to a single .vts file by the first process, which receives the data of the others, to a
+   single .vts file with collective MPI-IO writes, and to a .pvts index with pieces written by -aggregators processes.
+   The two single files must be identical; the index is printed. Compare the ways on a large grid with, for example,
+
+      mpiexec -n 64 ./ex42 -M 200 -N 200 -P 200 -aggregators 8 -benchmark
+      mpiexec -n 64 ./ex42 -M 200 -N 200 -P 200 -aggregators 8 -benchmark -compress 1
+*/
+#include <petscdmda.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FileSize"
+/* the size of a file, 0 if it does not exist */
+static PetscErrorCode FileSize(const char name[],long *size)
+{
+  FILE *fp;
+
+  PetscFunctionBegin;
+  *size = 0;
+  fp    = fopen(name,"rb");
+  if (!fp) PetscFunctionReturn(0);
+  if (fseek(fp,0,SEEK_END)) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_READ,"Cannot seek in file %s",name);
+  *size = ftell(fp);
+  fclose(fp);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CompareFiles"
+static PetscErrorCode CompareFiles(const char name0[],const char name1[],PetscBool *same)
+{
+  FILE   *fp0,*fp1;
+  int    c0,c1;
+
+  PetscFunctionBegin;
+  fp0 = fopen(name0,"rb");
+  if (!fp0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file %s",name0);
+  fp1 = fopen(name1,"rb");
+  if (!fp1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file %s",name1);
+  do {
+    c0 = getc(fp0);
+    c1 = getc(fp1);
+  } while (c0 == c1 && c0 != EOF);
+  *same = (c0 == c1) ? PETSC_TRUE : PETSC_FALSE;
+  fclose(fp0);
+  fclose(fp1);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       M = 9,N = 7,P = 5,naggregators = 2,compress = 0,i,j,k,xs,ys,zs,xm,ym,zm,way;
+  PetscBool      benchmark = PETSC_FALSE,same;
+  PetscMPIInt    rank;
+  DM             da;
+  Vec            x;
+  PetscScalar    ****a;
+  PetscViewer    viewer;
+  PetscLogDouble t0,t1,tloc,tmax;
+  long           size,piece;
+  char           line[PETSC_MAX_PATH_LEN];
+  FILE           *fp;
+  const char     *names[3] = {"ex42_0.vts","ex42_1.vts","ex42_2.pvts"};
+  const char     *ways[3]  = {"single file written by the first process","single file written with MPI-IO","parallel file"};
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-M",&M,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-N",&N,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-P",&P,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-aggregators",&naggregators,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-compress",&compress,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-benchmark",&benchmark,PETSC_NULL);CHKERRQ(ierr);
+
+  ierr = DMDACreate3d(PETSC_COMM_WORLD,DMDA_BOUNDARY_NONE,DMDA_BOUNDARY_NONE,DMDA_BOUNDARY_NONE,DMDA_STENCIL_STAR,M,N,P,PETSC_DECIDE,PETSC_DECIDE,PETSC_DECIDE,2,1,0,0,0,&da);CHKERRQ(ierr);
+  ierr = DMDASetFieldName(da,0,"u");CHKERRQ(ierr);
+  ierr = DMDASetFieldName(da,1,"v");CHKERRQ(ierr);
+  ierr = DMDASetUniformCoordinates(da,0.0,1.0,0.0,1.0,0.0,1.0);CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(da,&x);CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject)x,"x_");CHKERRQ(ierr);
+  ierr = DMDAGetCorners(da,&xs,&ys,&zs,&xm,&ym,&zm);CHKERRQ(ierr);
+  ierr = DMDAVecGetArrayDOF(da,x,&a);CHKERRQ(ierr);
+  for (k=zs; k<zs+zm; k++) {
+    for (j=ys; j<ys+ym; j++) {
+      for (i=xs; i<xs+xm; i++) {
+        a[k][j][i][0] = PetscSinReal(0.1*i)*PetscCosReal(0.2*j) + k;
+        a[k][j][i][1] = i + M*(j + N*k);
+      }
+    }
+  }
+  ierr = DMDAVecRestoreArrayDOF(da,x,&a);CHKERRQ(ierr);
+
+  for (way=0; way<3; way++) {
+    ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+    ierr = PetscViewerVTKOpen(PETSC_COMM_WORLD,names[way],FILE_MODE_WRITE,&viewer);CHKERRQ(ierr);
+    if (compress) {ierr = PetscViewerVTKSetCompression(viewer,compress);CHKERRQ(ierr);}
+#if defined(PETSC_HAVE_MPIIO)
+    /* without MPI-IO the file is written by the first process, which is also correct */
+    if (way == 1) {ierr = PetscViewerVTKSetMPIIO(viewer,PETSC_TRUE);CHKERRQ(ierr);}
+#endif
+    if (way == 2) {ierr = PetscViewerVTKSetAggregators(viewer,naggregators);CHKERRQ(ierr);}
+    ierr = VecView(x,viewer);CHKERRQ(ierr);
+    ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+    if (benchmark) {
+      tloc = t1 - t0;
+      ierr = MPI_Allreduce(&tloc,&tmax,1,MPI_DOUBLE,MPI_MAX,PETSC_COMM_WORLD);CHKERRQ(ierr);
+      ierr = FileSize(names[way],&size);CHKERRQ(ierr);
+      for (k=0, piece=1; way == 2 && piece; k++) {
+        ierr  = PetscSNPrintf(line,sizeof line,"ex42_2_%D.vts",k);CHKERRQ(ierr);
+        ierr  = FileSize(line,&piece);CHKERRQ(ierr);
+        size += piece;
+      }
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: %G s, %G MB\n",ways[way],tmax,size/1048576.0);CHKERRQ(ierr);
+    }
+  }
+
+  if (!rank) {
+    ierr = CompareFiles(names[0],names[1],&same);CHKERRQ(ierr);
+    if (!same) {ierr = PetscPrintf(PETSC_COMM_SELF,"The files written by the first process and with MPI-IO differ\n");CHKERRQ(ierr);}
+    fp = fopen(names[2],"r");
+    if (!fp) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file %s",names[2]);
+    while (fgets(line,sizeof line,fp)) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s",line);CHKERRQ(ierr);
+    }
+    fclose(fp);
+  }
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = DMDestroy(&da);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
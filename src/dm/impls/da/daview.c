@@ -256,3 +256,78 @@ PetscErrorCode  DMDAGetLocalInfo(DM da,DMDALocalInfo *info)
   info->gzm = (dd->Ze - dd->Zs);
   PetscFunctionReturn(0);
 }
+
+#undef __FUNCT__
+#define __FUNCT__ "DMDAGetLocalInfoSplit"
+/*@C
+   DMDAGetLocalInfoSplit - Divides the part of the grid owned by this process into the interior box, whose stencils only
+   touch points owned by this process, and the boundary strips around it
+
+   Not Collective
+
+   Input Parameter:
+.  da - the distributed array
+
+   Output Parameters:
++  interior - the local information with the starting points and sizes of the interior box, which may be empty
+.  nboundary - the number of boundary strips
+-  boundary - the local information of each boundary strip, an array with room for 6 entries
+
+   Notes:
+   The interior is the owned box shrunk by the stencil width on each side where the process has ghost points, so a local
+   function called with the interior information can run before DMGlobalToLocalEnd() while it only reads points within
+   the stencil width. The boundary strips do not overlap and together with the interior cover the owned box. The other
+   entries, in particular the ghosted box, are the same as those from DMDAGetLocalInfo(), so the same arrays from
+   DMDAVecGetArray() are used with all of them.
+
+   Level: advanced
+
+.keywords: distributed array, get, information, overlap
+
+.seealso: DMDAGetLocalInfo(), DMDASNESSetOverlap(), DMGlobalToLocalBegin()
+@*/
+PetscErrorCode  DMDAGetLocalInfoSplit(DM da,DMDALocalInfo *interior,PetscInt *nboundary,DMDALocalInfo boundary[])
+{
+  PetscErrorCode ierr;
+  DMDALocalInfo  info;
+  PetscInt       s[3],m[3],gs[3],gm[3],lo[3],hi[3],is[3],im[3],d,n = 0;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(da,DM_CLASSID,1);
+  PetscValidPointer(interior,2);
+  PetscValidIntPointer(nboundary,3);
+  PetscValidPointer(boundary,4);
+  ierr = DMDAGetLocalInfo(da,&info);CHKERRQ(ierr);
+  s[0] = info.xs;  s[1] = info.ys;  s[2] = info.zs;
+  m[0] = info.xm;  m[1] = info.ym;  m[2] = info.zm;
+  gs[0] = info.gxs; gs[1] = info.gys; gs[2] = info.gzs;
+  gm[0] = info.gxm; gm[1] = info.gym; gm[2] = info.gzm;
+  for (d=0; d<3; d++) {
+    lo[d] = (gs[d] < s[d]) ? info.sw : 0;
+    hi[d] = (gs[d]+gm[d] > s[d]+m[d]) ? info.sw : 0;
+    is[d] = s[d] + lo[d];
+    im[d] = m[d] - lo[d] - hi[d];
+  }
+  *interior = info;
+  if (im[0] <= 0 || im[1] <= 0 || im[2] <= 0) {
+    /* no point is far enough from the ghosts, everything is boundary */
+    interior->xm = interior->ym = interior->zm = 0;
+    if (m[0] && m[1] && m[2]) boundary[n++] = info;
+    *nboundary = n;
+    PetscFunctionReturn(0);
+  }
+  interior->xs = is[0]; interior->xm = im[0];
+  interior->ys = is[1]; interior->ym = im[1];
+  interior->zs = is[2]; interior->zm = im[2];
+  /* slabs below and above the interior in z spanning the owned box in x and y */
+  if (lo[2]) {boundary[n] = info; boundary[n].zm = lo[2]; n++;}
+  if (hi[2]) {boundary[n] = info; boundary[n].zs = is[2]+im[2]; boundary[n].zm = hi[2]; n++;}
+  /* then in y within the z range of the interior */
+  if (lo[1]) {boundary[n] = info; boundary[n].zs = is[2]; boundary[n].zm = im[2]; boundary[n].ym = lo[1]; n++;}
+  if (hi[1]) {boundary[n] = info; boundary[n].zs = is[2]; boundary[n].zm = im[2]; boundary[n].ys = is[1]+im[1]; boundary[n].ym = hi[1]; n++;}
+  /* then in x within the y and z range of the interior */
+  if (lo[0]) {boundary[n] = *interior; boundary[n].xs = s[0]; boundary[n].xm = lo[0]; n++;}
+  if (hi[0]) {boundary[n] = *interior; boundary[n].xs = is[0]+im[0]; boundary[n].xm = hi[0]; n++;}
+  *nboundary = n;
+  PetscFunctionReturn(0);
+}
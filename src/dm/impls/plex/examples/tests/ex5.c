@@ -0,0 +1,162 @@
+static char help[] = "Tests writing a DMPlex vector to VTK XML unstructured grid files.\n\n\
+  -nx <nx>, -ny <ny>        number of cells of each process in each direction\n\
+  -aggregators <n>          number of files of the pieces of the parallel file\n\n";
+
+/*
+   Each process makes its own block of quadrilaterals, next to the block of the previous process, with a field at the
+   vertices. The vector is written to a single .vtu file by the first process, to a single .vtu file with collective
+   MPI-IO writes, and to a .pvtu index with pieces written into -aggregators files. The two single files must be
+   identical; the index is printed, with the number of pieces in each of the files it lists.
+*/
+#include <petscdmplex.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "CreateMesh"
+static PetscErrorCode CreateMesh(MPI_Comm comm,PetscInt nx,PetscInt ny,DM *dm)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    rank;
+  PetscInt       i,j,pStart,pEnd;
+  int            *cells;
+  double         *coords;
+  PetscSF        sf;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = PetscMalloc2(4*nx*ny,int,&cells,2*(nx+1)*(ny+1),double,&coords);CHKERRQ(ierr);
+  for (j=0; j<ny; j++) {
+    for (i=0; i<nx; i++) {
+      int *c = cells + 4*(j*nx+i);
+      c[0] = (int)(j*(nx+1) + i);
+      c[1] = c[0] + 1;
+      c[2] = c[1] + (int)(nx+1);
+      c[3] = c[0] + (int)(nx+1);
+    }
+  }
+  for (j=0; j<=ny; j++) {
+    for (i=0; i<=nx; i++) {
+      coords[2*(j*(nx+1)+i)+0] = (double)(rank*nx + i);
+      coords[2*(j*(nx+1)+i)+1] = (double)j;
+    }
+  }
+  ierr = DMPlexCreateFromCellList(comm,2,nx*ny,(nx+1)*(ny+1),4,PETSC_FALSE,cells,coords,dm);CHKERRQ(ierr);
+  ierr = PetscFree2(cells,coords);CHKERRQ(ierr);
+  /* the blocks share no points, every process owns all of its own */
+  ierr = DMPlexGetChart(*dm,&pStart,&pEnd);CHKERRQ(ierr);
+  ierr = DMGetPointSF(*dm,&sf);CHKERRQ(ierr);
+  ierr = PetscSFSetGraph(sf,pEnd-pStart,0,PETSC_NULL,PETSC_OWN_POINTER,PETSC_NULL,PETSC_OWN_POINTER);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CompareFiles"
+static PetscErrorCode CompareFiles(const char name0[],const char name1[],PetscBool *same)
+{
+  FILE *fp0,*fp1;
+  int  c0,c1;
+
+  PetscFunctionBegin;
+  fp0 = fopen(name0,"rb");
+  if (!fp0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file %s",name0);
+  fp1 = fopen(name1,"rb");
+  if (!fp1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file %s",name1);
+  do {
+    c0 = getc(fp0);
+    c1 = getc(fp1);
+  } while (c0 == c1 && c0 != EOF);
+  *same = (c0 == c1) ? PETSC_TRUE : PETSC_FALSE;
+  fclose(fp0);
+  fclose(fp1);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CountPieces"
+/* the number of <Piece> elements in the XML header of a file, which ends where the appended data begins */
+static PetscErrorCode CountPieces(const char name[],PetscInt *npieces)
+{
+  FILE           *fp;
+  char           line[PETSC_MAX_PATH_LEN],*found;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  *npieces = 0;
+  fp       = fopen(name,"rb");
+  if (!fp) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file %s",name);
+  while (fgets(line,sizeof line,fp)) {
+    ierr = PetscStrstr(line,"<AppendedData",&found);CHKERRQ(ierr);
+    if (found) break;
+    ierr = PetscStrstr(line,"<Piece ",&found);CHKERRQ(ierr);
+    if (found) (*npieces)++;
+  }
+  fclose(fp);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       nx = 3,ny = 2,naggregators = 2,numComp[1] = {1},numDof[3] = {1,0,0},vStart,vEnd,v,k,npieces,way;
+  PetscBool      same,exists;
+  PetscMPIInt    rank;
+  DM             dm;
+  PetscSection   section;
+  Vec            x;
+  PetscScalar    *a;
+  PetscViewer    viewer;
+  char           line[PETSC_MAX_PATH_LEN];
+  FILE           *fp;
+  const char     *names[3] = {"ex5_0.vtu","ex5_1.vtu","ex5_2.pvtu"};
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-nx",&nx,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-ny",&ny,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-aggregators",&naggregators,PETSC_NULL);CHKERRQ(ierr);
+
+  ierr = CreateMesh(PETSC_COMM_WORLD,nx,ny,&dm);CHKERRQ(ierr);
+  ierr = DMPlexCreateSection(dm,2,1,numComp,numDof,0,PETSC_NULL,PETSC_NULL,&section);CHKERRQ(ierr);
+  ierr = DMSetDefaultSection(dm,section);CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(dm,&x);CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject)x,"x_");CHKERRQ(ierr);
+  ierr = DMPlexGetDepthStratum(dm,0,&vStart,&vEnd);CHKERRQ(ierr);
+  ierr = VecGetArray(x,&a);CHKERRQ(ierr);
+  for (v=vStart; v<vEnd; v++) a[v-vStart] = rank*100 + (v-vStart);
+  ierr = VecRestoreArray(x,&a);CHKERRQ(ierr);
+
+  for (way=0; way<3; way++) {
+    ierr = PetscViewerVTKOpen(PETSC_COMM_WORLD,names[way],FILE_MODE_WRITE,&viewer);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPIIO)
+    /* without MPI-IO the file is written by the first process, which is also correct */
+    if (way == 1) {ierr = PetscViewerVTKSetMPIIO(viewer,PETSC_TRUE);CHKERRQ(ierr);}
+#endif
+    if (way == 2) {ierr = PetscViewerVTKSetAggregators(viewer,naggregators);CHKERRQ(ierr);}
+    ierr = VecView(x,viewer);CHKERRQ(ierr);
+    ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+  }
+
+  if (!rank) {
+    ierr = CompareFiles(names[0],names[1],&same);CHKERRQ(ierr);
+    if (!same) {ierr = PetscPrintf(PETSC_COMM_SELF,"The files written by the first process and with MPI-IO differ\n");CHKERRQ(ierr);}
+    fp = fopen(names[2],"r");
+    if (!fp) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file %s",names[2]);
+    while (fgets(line,sizeof line,fp)) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s",line);CHKERRQ(ierr);
+    }
+    fclose(fp);
+    for (k=0; ; k++) {
+      ierr = PetscSNPrintf(line,sizeof line,"ex5_2_%D.vtu",k);CHKERRQ(ierr);
+      ierr = PetscTestFile(line,'r',&exists);CHKERRQ(ierr);
+      if (!exists) break;
+      ierr = CountPieces(line,&npieces);CHKERRQ(ierr);
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s: number of pieces %D\n",line,npieces);CHKERRQ(ierr);
+    }
+  }
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = DMDestroy(&dm);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,584 @@
+/*
+    This file implements the s-step (communication avoiding) conjugate gradient method. Each outer
+    step builds polynomial bases of degree s for the search direction and of degree s-1 for the
+    preconditioned residual, computes all of their inner products with one reduction and then does
+    s steps of CG on the coordinates in these bases, without any communication.
+
+    References:
+      Chronopoulos and Gear, s-step iterative methods for symmetric linear systems, 1989.
+      Hoemmen, Communication-avoiding Krylov subspace methods, PhD thesis, 2010.
+      Carson, Knight and Demmel, Avoiding communication in two-sided Krylov subspace methods, 2011.
+*/
+#include <petsc-private/kspimpl.h>              /*I "petscksp.h" I*/
+#include <petscblaslapack.h>
+
+typedef struct {
+  PetscInt       s;                 /* number of steps between two reductions */
+  KSPCABasisType basis;
+  PetscBool      matpowers;         /* use the matrix powers kernel when there is no preconditioner */
+  KSPMatPowers   mp;
+  PetscBool      nopc;              /* the preconditioner is the identity, so Yt is Y */
+  Vec            *Y,*Yt;            /* the bases and their images M Y by the preconditioner M, 2s+1 vectors each */
+  Vec            ptmp,qtmp,ztmp,rtmp;
+  PetscInt       neig;              /* number of eigenvalue estimates for the basis */
+  PetscReal      *re,*im;
+  PetscScalar    *a,*b,*g;          /* coefficients of the recurrence of the basis */
+  PetscScalar    *G,*Gn,*T;         /* Gram matrices and the operator in the basis */
+  PetscScalar    *xc,*pc,*zc,*w;    /* coordinates in the basis */
+  PetscReal      *alpha,*beta;      /* CG coefficients of the first outer step, for the eigenvalue estimates */
+} KSP_CACG;
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetUp_CACG"
+static PetscErrorCode KSPSetUp_CACG(KSP ksp)
+{
+  KSP_CACG       *cacg = (KSP_CACG*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       s = cacg->s,N = 2*s+1,i;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)ksp->pc,PCNONE,&cacg->nopc);CHKERRQ(ierr);
+  if (ksp->nullsp) cacg->nopc = PETSC_FALSE;
+  ierr = KSPDefaultGetWork(ksp,cacg->nopc ? N+2 : 2*N+4);CHKERRQ(ierr);
+  ierr = PetscFree2(cacg->Y,cacg->Yt);CHKERRQ(ierr);
+  ierr = PetscMalloc2(N,Vec,&cacg->Y,N,Vec,&cacg->Yt);CHKERRQ(ierr);
+  for (i=0; i<N; i++) {
+    cacg->Y[i]  = ksp->work[i];
+    cacg->Yt[i] = cacg->nopc ? ksp->work[i] : ksp->work[N+i];
+  }
+  cacg->ptmp = ksp->work[cacg->nopc ? N : 2*N];
+  cacg->ztmp = ksp->work[cacg->nopc ? N+1 : 2*N+1];
+  cacg->qtmp = cacg->nopc ? cacg->ptmp : ksp->work[2*N+2];
+  cacg->rtmp = cacg->nopc ? cacg->ztmp : ksp->work[2*N+3];
+
+  ierr = PetscFree5(cacg->re,cacg->im,cacg->a,cacg->b,cacg->g);CHKERRQ(ierr);
+  ierr = PetscMalloc5(s,PetscReal,&cacg->re,s,PetscReal,&cacg->im,s,PetscScalar,&cacg->a,s,PetscScalar,&cacg->b,s,PetscScalar,&cacg->g);CHKERRQ(ierr);
+  ierr = PetscFree3(cacg->G,cacg->Gn,cacg->T);CHKERRQ(ierr);
+  ierr = PetscMalloc3(N*N,PetscScalar,&cacg->G,N*N,PetscScalar,&cacg->Gn,N*N,PetscScalar,&cacg->T);CHKERRQ(ierr);
+  ierr = PetscFree4(cacg->xc,cacg->pc,cacg->zc,cacg->w);CHKERRQ(ierr);
+  ierr = PetscMalloc4(N,PetscScalar,&cacg->xc,N,PetscScalar,&cacg->pc,N,PetscScalar,&cacg->zc,N,PetscScalar,&cacg->w);CHKERRQ(ierr);
+  ierr = PetscFree2(cacg->alpha,cacg->beta);CHKERRQ(ierr);
+  ierr = PetscMalloc2(s,PetscReal,&cacg->alpha,s,PetscReal,&cacg->beta);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory(ksp,3*N*N*sizeof(PetscScalar));CHKERRQ(ierr);
+  /* a new operator needs new estimates of its eigenvalues */
+  cacg->neig = 0;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCACGComputeBasis"
+/*
+   Computes Y[1..n] from Y[0] with the recurrence for Op = M^{-1} A, and Yt[j] = M Y[j] from Yt[0] = M Y[0]
+   using M Y[j+1] = (A Y[j] - a_j M Y[j] - b_j M Y[j-1])/g_j.
+*/
+static PetscErrorCode KSPCACGComputeBasis(KSP ksp,Mat Amat,PetscInt n,Vec *Y,Vec *Yt)
+{
+  KSP_CACG       *cacg = (KSP_CACG*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       j;
+  PetscScalar    *a = cacg->a,*b = cacg->b,*g = cacg->g;
+
+  PetscFunctionBegin;
+  if (cacg->mp) {
+    ierr = KSPMatPowersApply(cacg->mp,n,a,b,g,Y);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  for (j=0; j<n; j++) {
+    ierr = KSP_MatMult(ksp,Amat,Y[j],Yt[j+1]);CHKERRQ(ierr);
+    if (!cacg->nopc) {ierr = KSP_PCApply(ksp,Yt[j+1],Y[j+1]);CHKERRQ(ierr);}
+    if (a[j] == 0.0 && (!j || b[j] == 0.0) && g[j] == 1.0) continue;
+    if (j && b[j] != 0.0) {
+      ierr = VecAXPBYPCZ(Y[j+1],-a[j]/g[j],-b[j]/g[j],1.0/g[j],Y[j],Y[j-1]);CHKERRQ(ierr);
+      if (!cacg->nopc) {ierr = VecAXPBYPCZ(Yt[j+1],-a[j]/g[j],-b[j]/g[j],1.0/g[j],Yt[j],Yt[j-1]);CHKERRQ(ierr);}
+    } else {
+      ierr = VecAXPBY(Y[j+1],-a[j]/g[j],1.0/g[j],Y[j]);CHKERRQ(ierr);
+      if (!cacg->nopc) {ierr = VecAXPBY(Yt[j+1],-a[j]/g[j],1.0/g[j],Yt[j]);CHKERRQ(ierr);}
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCACGForm"
+/* returns u^H G v for the Hermitian N x N matrix G */
+PETSC_STATIC_INLINE PetscScalar KSPCACGForm(PetscInt N,const PetscScalar *G,const PetscScalar *u,const PetscScalar *v)
+{
+  PetscInt    i,j;
+  PetscScalar sum = 0.0,t;
+
+  for (j=0; j<N; j++) {
+    if (v[j] == 0.0) continue;
+    t = 0.0;
+    for (i=0; i<N; i++) t += PetscConj(u[i])*G[i+j*N];
+    sum += t*v[j];
+  }
+  return sum;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCACGEstimateEigenvalues"
+/*
+   The Ritz values of the Lanczos matrix of the first n steps of CG are the estimates used by the Newton and Chebyshev bases
+*/
+static PetscErrorCode KSPCACGEstimateEigenvalues(KSP ksp,PetscInt n)
+{
+  KSP_CACG       *cacg = (KSP_CACG*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       i;
+  PetscReal      *d = cacg->re,*e,*work;
+  PetscScalar    sdummy;
+  PetscBLASInt   bn,ldz = 1,lierr;
+
+  PetscFunctionBegin;
+  if (n < 1) PetscFunctionReturn(0);
+  ierr = PetscMalloc2(n,PetscReal,&e,2*n,PetscReal,&work);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    d[i] = 1.0/cacg->alpha[i];
+    if (i) d[i] += cacg->beta[i-1]/cacg->alpha[i-1];
+    e[i] = PetscSqrtReal(cacg->beta[i])/cacg->alpha[i];
+    cacg->im[i] = 0.0;
+  }
+  bn   = PetscBLASIntCast(n);
+#if defined(PETSC_MISSING_LAPACK_STEQR)
+  SETERRQ(((PetscObject)ksp)->comm,PETSC_ERR_SUP,"STEQR - Lapack routine is unavailable.");
+#else
+  ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+  LAPACKsteqr_("N",&bn,d,e,&sdummy,&ldz,work,&lierr);
+  ierr = PetscFPTrapPop();CHKERRQ(ierr);
+  if (lierr) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine %d",(int)lierr);
+#endif
+  ierr = PetscFree2(e,work);CHKERRQ(ierr);
+  /* steqr sorts the eigenvalues in increasing order */
+  ierr = PetscInfo3(ksp,"%D eigenvalue estimates in [%G, %G]\n",n,d[0],d[n-1]);CHKERRQ(ierr);
+  if (cacg->basis == KSP_CA_BASIS_NEWTON) {ierr = KSPCALejaOrder(n,cacg->re,cacg->im);CHKERRQ(ierr);}
+  cacg->neig = n;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSolve_CACG"
+static PetscErrorCode KSPSolve_CACG(KSP ksp)
+{
+  KSP_CACG       *cacg = (KSP_CACG*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       s = cacg->s,N = 2*s+1,i,j,k,l,m;
+  PetscScalar    *G = cacg->G,*Gn = cacg->Gn,*T = cacg->T,*xc = cacg->xc,*pc = cacg->pc,*zc = cacg->zc,*w = cacg->w;
+  PetscScalar    delta,deltanew,pAp,alpha,beta;
+  PetscReal      dp = 0.0;
+  PetscBool      estimate;
+  Vec            X,B,*Y = cacg->Y,*Yt = cacg->Yt,tmp;
+  Mat            Amat,Pmat;
+  MatStructure   pflag;
+  MPI_Comm       comm = ((PetscObject)ksp)->comm;
+
+  PetscFunctionBegin;
+  X    = ksp->vec_sol;
+  B    = ksp->vec_rhs;
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat,&pflag);CHKERRQ(ierr);
+  if (cacg->matpowers && cacg->nopc && !ksp->transpose_solve) {
+    ierr = KSPMatPowersSetUp(Amat,s,&cacg->mp);CHKERRQ(ierr);
+  } else {
+    ierr = KSPMatPowersDestroy(&cacg->mp);CHKERRQ(ierr);
+  }
+
+  /* the search direction p is Y[0], the preconditioned residual z is Y[s+1], with M p in Yt[0] and the residual r in Yt[s+1] */
+  ksp->its = 0;
+  if (!ksp->guess_zero) {
+    ierr = KSP_MatMult(ksp,Amat,X,Yt[s+1]);CHKERRQ(ierr);
+    ierr = VecAYPX(Yt[s+1],-1.0,B);CHKERRQ(ierr);
+  } else {
+    ierr = VecCopy(B,Yt[s+1]);CHKERRQ(ierr);
+  }
+  if (!cacg->nopc) {ierr = KSP_PCApply(ksp,Yt[s+1],Y[s+1]);CHKERRQ(ierr);}
+  ierr = VecCopy(Y[s+1],Y[0]);CHKERRQ(ierr);
+  if (!cacg->nopc) {ierr = VecCopy(Yt[s+1],Yt[0]);CHKERRQ(ierr);}
+  switch (ksp->normtype) {
+  case KSP_NORM_PRECONDITIONED:
+    ierr = VecNorm(Y[s+1],NORM_2,&dp);CHKERRQ(ierr);
+    break;
+  case KSP_NORM_UNPRECONDITIONED:
+    ierr = VecNorm(Yt[s+1],NORM_2,&dp);CHKERRQ(ierr);
+    break;
+  case KSP_NORM_NATURAL:
+    ierr = VecDot(Y[s+1],Yt[s+1],&delta);CHKERRQ(ierr);
+    dp   = PetscSqrtReal(PetscAbsScalar(delta));
+    break;
+  case KSP_NORM_NONE:
+    dp = 0.0;
+    break;
+  default: SETERRQ1(comm,PETSC_ERR_SUP,"%s",KSPNormTypes[ksp->normtype]);
+  }
+  ierr = PetscObjectTakeAccess(ksp);CHKERRQ(ierr);
+  ksp->rnorm = dp;
+  ierr = PetscObjectGrantAccess(ksp);CHKERRQ(ierr);
+  KSPLogResidualHistory(ksp,dp);
+  ierr = KSPMonitor(ksp,0,dp);CHKERRQ(ierr);
+  ierr = (*ksp->converged)(ksp,0,dp,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+
+  while (!ksp->reason) {
+    /* the first outer step with a Newton or Chebyshev basis uses the monomial one and estimates the eigenvalues */
+    estimate = (PetscBool)(!cacg->neig && cacg->basis != KSP_CA_BASIS_MONOMIAL);
+    ierr = KSPCABasisCoefficients(cacg->basis,s,cacg->neig,cacg->re,cacg->im,cacg->a,cacg->b,cacg->g);CHKERRQ(ierr);
+    ierr = KSPCACGComputeBasis(ksp,Amat,s,Y,Yt);CHKERRQ(ierr);
+    ierr = KSPCACGComputeBasis(ksp,Amat,s-1,Y+s+1,Yt+s+1);CHKERRQ(ierr);
+
+    /* all the inner products of the outer step in one reduction, G = Yt^H Y = Y^H M Y */
+    for (m=0; m<N; m++) {
+      ierr = VecMDotBegin(Y[m],m+1,Yt,G+m*N);CHKERRQ(ierr);
+      if (cacg->nopc) continue;
+      if (ksp->normtype == KSP_NORM_PRECONDITIONED) {
+        ierr = VecMDotBegin(Y[m],m+1,Y,Gn+m*N);CHKERRQ(ierr);
+      } else if (ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+        ierr = VecMDotBegin(Yt[m],m+1,Yt,Gn+m*N);CHKERRQ(ierr);
+      }
+    }
+    ierr = PetscCommSplitReductionBegin(comm);CHKERRQ(ierr);
+    for (m=0; m<N; m++) {
+      ierr = VecMDotEnd(Y[m],m+1,Yt,G+m*N);CHKERRQ(ierr);
+      if (cacg->nopc) continue;
+      if (ksp->normtype == KSP_NORM_PRECONDITIONED) {
+        ierr = VecMDotEnd(Y[m],m+1,Y,Gn+m*N);CHKERRQ(ierr);
+      } else if (ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+        ierr = VecMDotEnd(Yt[m],m+1,Yt,Gn+m*N);CHKERRQ(ierr);
+      }
+    }
+    if (cacg->nopc || ksp->normtype == KSP_NORM_NATURAL || ksp->normtype == KSP_NORM_NONE) Gn = G;
+    else Gn = cacg->Gn;
+    for (m=0; m<N; m++) {
+      for (l=m+1; l<N; l++) {
+        G[l+m*N] = PetscConj(G[m+l*N]);
+        if (Gn != G) Gn[l+m*N] = PetscConj(Gn[m+l*N]);
+      }
+    }
+
+    /* the preconditioned operator in the basis, it maps the first s-1 and s vectors of the two bases */
+    ierr = PetscMemzero(T,N*N*sizeof(PetscScalar));CHKERRQ(ierr);
+    for (j=0; j<s; j++) {
+      T[j+1+j*N] = cacg->g[j];
+      T[j+j*N]   = cacg->a[j];
+      if (j) T[j-1+j*N] = cacg->b[j];
+      if (j == s-1) break;
+      l = s+1+j;
+      T[l+1+l*N] = cacg->g[j];
+      T[l+l*N]   = cacg->a[j];
+      if (j) T[l-1+l*N] = cacg->b[j];
+    }
+
+    /* s steps of CG on the coordinates */
+    for (i=0; i<N; i++) xc[i] = pc[i] = zc[i] = 0.0;
+    pc[0]   = 1.0;
+    zc[s+1] = 1.0;
+    delta   = G[(s+1)+(s+1)*N];
+    for (k=0; k<s; k++) {
+      for (i=0; i<N; i++) {
+        w[i] = 0.0;
+        for (j=PetscMax(0,i-1); j<PetscMin(N,i+2); j++) w[i] += T[i+j*N]*pc[j];
+      }
+      pAp = KSPCACGForm(N,G,pc,w);
+      if (PetscRealPart(pAp) <= 0.0) {
+        ksp->reason = KSP_DIVERGED_INDEFINITE_MAT;
+        ierr = PetscInfo(ksp,"Diverged due to indefinite matrix\n");CHKERRQ(ierr);
+        break;
+      }
+      alpha = delta/pAp;
+      for (i=0; i<N; i++) {
+        xc[i] += alpha*pc[i];
+        zc[i] -= alpha*w[i];
+      }
+      deltanew = KSPCACGForm(N,G,zc,zc);
+      if (PetscRealPart(deltanew) < 0.0) {
+        ksp->reason = KSP_DIVERGED_INDEFINITE_PC;
+        ierr = PetscInfo(ksp,"Diverged due to indefinite or negative definite preconditioner\n");CHKERRQ(ierr);
+        k++;
+        break;
+      }
+      beta = deltanew/delta;
+      for (i=0; i<N; i++) pc[i] = zc[i] + beta*pc[i];
+      if (estimate) {
+        cacg->alpha[k] = PetscRealPart(alpha);
+        cacg->beta[k]  = PetscRealPart(beta);
+      }
+      delta = deltanew;
+
+      switch (ksp->normtype) {
+      case KSP_NORM_NATURAL:
+        dp = PetscSqrtReal(PetscAbsScalar(delta));
+        break;
+      case KSP_NORM_NONE:
+        dp = 0.0;
+        break;
+      default:
+        dp = PetscSqrtReal(PetscAbsScalar(KSPCACGForm(N,Gn,zc,zc)));
+      }
+      ierr = PetscObjectTakeAccess(ksp);CHKERRQ(ierr);
+      ksp->its++;
+      ksp->rnorm = dp;
+      ierr = PetscObjectGrantAccess(ksp);CHKERRQ(ierr);
+      KSPLogResidualHistory(ksp,dp);
+      ierr = KSPMonitor(ksp,ksp->its,dp);CHKERRQ(ierr);
+      ierr = (*ksp->converged)(ksp,ksp->its,dp,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+      if (ksp->reason) {k++; break;}
+    }
+    ierr = PetscLogFlops(k*(4.0*N*N + 10.0*N));CHKERRQ(ierr);
+    if (estimate && k > 1) {ierr = KSPCACGEstimateEigenvalues(ksp,k);CHKERRQ(ierr);}
+
+    /* back from the coordinates to the vectors */
+    ierr = VecMAXPY(X,N,xc,Y);CHKERRQ(ierr);
+    if (ksp->reason) break;
+    ierr = VecSet(cacg->ptmp,0.0);CHKERRQ(ierr);
+    ierr = VecMAXPY(cacg->ptmp,N,pc,Y);CHKERRQ(ierr);
+    ierr = VecSet(cacg->ztmp,0.0);CHKERRQ(ierr);
+    ierr = VecMAXPY(cacg->ztmp,N,zc,Y);CHKERRQ(ierr);
+    if (!cacg->nopc) {
+      ierr = VecSet(cacg->qtmp,0.0);CHKERRQ(ierr);
+      ierr = VecMAXPY(cacg->qtmp,N,pc,Yt);CHKERRQ(ierr);
+      ierr = VecSet(cacg->rtmp,0.0);CHKERRQ(ierr);
+      ierr = VecMAXPY(cacg->rtmp,N,zc,Yt);CHKERRQ(ierr);
+      tmp = Yt[0];   Yt[0]   = cacg->qtmp; cacg->qtmp = tmp;
+      tmp = Yt[s+1]; Yt[s+1] = cacg->rtmp; cacg->rtmp = tmp;
+    }
+    tmp = Y[0];   Y[0]   = cacg->ptmp; cacg->ptmp = tmp;
+    tmp = Y[s+1]; Y[s+1] = cacg->ztmp; cacg->ztmp = tmp;
+    if (cacg->nopc) {
+      Yt[0] = Y[0]; Yt[s+1] = Y[s+1];
+      cacg->qtmp = cacg->ptmp; cacg->rtmp = cacg->ztmp;
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPReset_CACG"
+static PetscErrorCode KSPReset_CACG(KSP ksp)
+{
+  KSP_CACG       *cacg = (KSP_CACG*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPMatPowersDestroy(&cacg->mp);CHKERRQ(ierr);
+  ierr = PetscFree2(cacg->Y,cacg->Yt);CHKERRQ(ierr);
+  ierr = PetscFree5(cacg->re,cacg->im,cacg->a,cacg->b,cacg->g);CHKERRQ(ierr);
+  ierr = PetscFree3(cacg->G,cacg->Gn,cacg->T);CHKERRQ(ierr);
+  ierr = PetscFree4(cacg->xc,cacg->pc,cacg->zc,cacg->w);CHKERRQ(ierr);
+  ierr = PetscFree2(cacg->alpha,cacg->beta);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPDestroy_CACG"
+static PetscErrorCode KSPDestroy_CACG(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPReset_CACG(ksp);CHKERRQ(ierr);
+  ierr = KSPDefaultDestroy(ksp);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPCACGSetSteps_C","",PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPCACGSetBasisType_C","",PETSC_NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPView_CACG"
+static PetscErrorCode KSPView_CACG(KSP ksp,PetscViewer viewer)
+{
+  KSP_CACG       *cacg = (KSP_CACG*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  CACG: %D steps per reduction, %s basis\n",cacg->s,KSPCABasisTypes[cacg->basis]);CHKERRQ(ierr);
+    if (cacg->mp) {ierr = PetscViewerASCIIPrintf(viewer,"  CACG: using the matrix powers kernel\n");CHKERRQ(ierr);}
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetFromOptions_CACG"
+static PetscErrorCode KSPSetFromOptions_CACG(KSP ksp)
+{
+  KSP_CACG       *cacg = (KSP_CACG*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       s;
+  KSPCABasisType basis;
+  PetscBool      flg;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead("KSP CACG options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_cacg_s","Number of steps between two reductions","KSPCACGSetSteps",cacg->s,&s,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = KSPCACGSetSteps(ksp,s);CHKERRQ(ierr);}
+  ierr = PetscOptionsEnum("-ksp_cacg_basis","Polynomial basis","KSPCACGSetBasisType",KSPCABasisTypes,(PetscEnum)cacg->basis,(PetscEnum*)&basis,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = KSPCACGSetBasisType(ksp,basis);CHKERRQ(ierr);}
+  ierr = PetscOptionsBool("-ksp_cacg_matrix_powers","Use the matrix powers kernel for MATMPIAIJ without preconditioner","None",cacg->matpowers,&cacg->matpowers,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "KSPCACGSetSteps_CACG"
+PetscErrorCode KSPCACGSetSteps_CACG(KSP ksp,PetscInt s)
+{
+  KSP_CACG       *cacg = (KSP_CACG*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (s < 1) SETERRQ1(((PetscObject)ksp)->comm,PETSC_ERR_ARG_OUTOFRANGE,"Number of steps %D must be positive",s);
+  if (s != cacg->s && ksp->setupstage) {ierr = KSPReset(ksp);CHKERRQ(ierr);}
+  cacg->s = s;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCACGSetBasisType_CACG"
+PetscErrorCode KSPCACGSetBasisType_CACG(KSP ksp,KSPCABasisType basis)
+{
+  KSP_CACG *cacg = (KSP_CACG*)ksp->data;
+
+  PetscFunctionBegin;
+  cacg->basis = basis;
+  cacg->neig  = 0;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCACGSetSteps"
+/*@
+   KSPCACGSetSteps - Sets the number of steps of the s-step conjugate gradient method between two reductions
+
+   Logically Collective on KSP
+
+   Input Parameters:
++  ksp - the Krylov space context
+-  s - the number of steps, the default is 4
+
+   Options Database Key:
+.  -ksp_cacg_s <s> - the number of steps
+
+   Notes:
+   Each outer step stores 2s+1 vectors, twice as many with a preconditioner, and computes (s+1)(2s+1) inner
+   products in one reduction. The polynomial bases become ill-conditioned for large s, values up to about 8
+   work with the Newton and Chebyshev bases.
+
+   Level: intermediate
+
+.keywords: KSP, CACG, s-step, communication avoiding
+
+.seealso: KSPCACG, KSPCACGSetBasisType()
+@*/
+PetscErrorCode KSPCACGSetSteps(KSP ksp,PetscInt s)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveInt(ksp,s,2);
+  ierr = PetscTryMethod(ksp,"KSPCACGSetSteps_C",(KSP,PetscInt),(ksp,s));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCACGSetBasisType"
+/*@
+   KSPCACGSetBasisType - Sets the polynomial basis of the s-step conjugate gradient method
+
+   Logically Collective on KSP
+
+   Input Parameters:
++  ksp - the Krylov space context
+-  basis - KSP_CA_BASIS_MONOMIAL, KSP_CA_BASIS_NEWTON (the default) or KSP_CA_BASIS_CHEBYSHEV
+
+   Options Database Key:
+.  -ksp_cacg_basis <monomial,newton,chebyshev> - the basis
+
+   Notes:
+   The Newton and Chebyshev bases need estimates of the eigenvalues of the preconditioned operator, they are the
+   Ritz values of the first outer step, which uses the monomial basis. The estimates are computed again after
+   each KSPSetUp().
+
+   Level: intermediate
+
+.keywords: KSP, CACG, s-step, communication avoiding
+
+.seealso: KSPCACG, KSPCACGSetSteps(), KSPCABasisType
+@*/
+PetscErrorCode KSPCACGSetBasisType(KSP ksp,KSPCABasisType basis)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveEnum(ksp,basis,2);
+  ierr = PetscTryMethod(ksp,"KSPCACGSetBasisType_C",(KSP,KSPCABasisType),(ksp,basis));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+    KSPCACG - The s-step (communication avoiding) preconditioned conjugate gradient method
+
+   Options Database Keys:
++   -ksp_cacg_s <4> - number of steps between two reductions
+.   -ksp_cacg_basis <newton> - polynomial basis, monomial, newton or chebyshev
+-   -ksp_cacg_matrix_powers - with a MATMPIAIJ operator and no preconditioner, compute the bases with one VecScatter each
+
+    Level: intermediate
+
+    Notes:
+    Every s iterations the method builds the bases [p, Op p, ... Op^s p] and [z, Op z, ... Op^(s-1) z] of the Krylov
+    space for the search direction p and the preconditioned residual z, where Op is the preconditioned operator,
+    computes all the inner products of these vectors in one reduction, then runs s iterations of CG on the coordinates
+    in the bases without any communication. Compared to KSPCG, which needs two reductions per iteration, there is one
+    reduction every s iterations, at the price of 2s+1 work vectors (twice as many with a preconditioner) and of the
+    loss of accuracy from the conditioning of the bases. Both the operator and the preconditioner must be symmetric
+    (Hermitian) positive definite. The solution is only updated every s iterations.
+
+    The default norm is the natural norm, the unpreconditioned and preconditioned norms are also available, at the cost
+    of more inner products in the same reduction.
+
+    With -ksp_cacg_matrix_powers and PCNONE the matrix powers kernel gathers the ghost values needed by all the s
+    steps with a single VecScatter and computes the rows near the process boundary redundantly.
+
+   References:
+   Chronopoulos and Gear, s-step iterative methods for symmetric linear systems, 1989.
+   Hoemmen, Communication-avoiding Krylov subspace methods, PhD thesis, 2010.
+
+.seealso: KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPCG, KSPPIPECG, KSPCAGMRES,
+          KSPCACGSetSteps(), KSPCACGSetBasisType()
+M*/
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "KSPCreate_CACG"
+PetscErrorCode KSPCreate_CACG(KSP ksp)
+{
+  KSP_CACG       *cacg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(ksp,KSP_CACG,&cacg);CHKERRQ(ierr);
+  cacg->s         = 4;
+  cacg->basis     = KSP_CA_BASIS_NEWTON;
+  cacg->matpowers = PETSC_FALSE;
+  ksp->data       = (void*)cacg;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NATURAL,PC_LEFT,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,1);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_LEFT,1);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_LEFT,1);CHKERRQ(ierr);
+
+  ksp->ops->setup          = KSPSetUp_CACG;
+  ksp->ops->solve          = KSPSolve_CACG;
+  ksp->ops->reset          = KSPReset_CACG;
+  ksp->ops->destroy        = KSPDestroy_CACG;
+  ksp->ops->view           = KSPView_CACG;
+  ksp->ops->setfromoptions = KSPSetFromOptions_CACG;
+  ksp->ops->buildsolution  = KSPDefaultBuildSolution;
+  ksp->ops->buildresidual  = KSPDefaultBuildResidual;
+
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPCACGSetSteps_C","KSPCACGSetSteps_CACG",KSPCACGSetSteps_CACG);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPCACGSetBasisType_C","KSPCACGSetBasisType_CACG",KSPCACGSetBasisType_CACG);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
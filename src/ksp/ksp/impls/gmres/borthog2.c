@@ -71,8 +71,15 @@ PetscErrorCode  KSPGMRESClassicalGramSchmidtOrthogonalization(KSP  ksp,PetscInt
   /*
          This is really a matrix vector product:
          [h[0],h[1],...]*[ v[0]; v[1]; ...] subtracted from v[it+1].
+
+         Unless the refinement is always done the norm of the result is computed in the
+         same sweep over v[it+1]; it is cached with the vector for the normalization.
   */
-  ierr = VecMAXPY(VEC_VV(it+1),it+1,lhh,&VEC_VV(0));CHKERRQ(ierr);
+  if (refine) {
+    ierr = VecMAXPY(VEC_VV(it+1),it+1,lhh,&VEC_VV(0));CHKERRQ(ierr);
+  } else {
+    ierr = VecMAXPYNorm(VEC_VV(it+1),it+1,lhh,&VEC_VV(0),&wnrm);CHKERRQ(ierr);
+  }
   /* note lhh[j] is -<v,vnew> , hence the subtraction */
   for (j=0; j<=it; j++) {
     hh[j]  -= lhh[j];     /* hh += <v,vnew> */
@@ -89,7 +96,6 @@ PetscErrorCode  KSPGMRESClassicalGramSchmidtOrthogonalization(KSP  ksp,PetscInt
       hnrm  +=  PetscRealPart(lhh[j] * PetscConj(lhh[j]));
     }
     hnrm = PetscSqrtReal(hnrm);
-    ierr = VecNorm(VEC_VV(it+1),NORM_2, &wnrm);CHKERRQ(ierr);
     if (wnrm < 1.0286 * hnrm) {
       refine = PETSC_TRUE;
       ierr = PetscInfo2(ksp,"Performing iterative refinement wnorm %G hnorm %G\n",wnrm,hnrm);CHKERRQ(ierr);
@@ -99,7 +105,7 @@ PetscErrorCode  KSPGMRESClassicalGramSchmidtOrthogonalization(KSP  ksp,PetscInt
   if (refine) {
     ierr = VecMDot(VEC_VV(it+1),it+1,&(VEC_VV(0)),lhh);CHKERRQ(ierr); /* <v,vnew> */
     for (j=0; j<=it; j++) lhh[j] = - lhh[j];
-    ierr = VecMAXPY(VEC_VV(it+1),it+1,lhh,&VEC_VV(0));CHKERRQ(ierr);
+    ierr = VecMAXPYNorm(VEC_VV(it+1),it+1,lhh,&VEC_VV(0),&wnrm);CHKERRQ(ierr);
     /* note lhh[j] is -<v,vnew> , hence the subtraction */
     for (j=0; j<=it; j++) {
       hh[j]  -= lhh[j];     /* hh += <v,vnew> */
@@ -0,0 +1,781 @@
+/*
+    This file implements CAGMRES, the s-step (communication avoiding) GMRES. The Krylov basis is extended by
+    blocks of s vectors computed with a polynomial recurrence and orthogonalized against the previous basis
+    and among themselves with two reductions per block.
+
+    References:
+      Hoemmen, Communication-avoiding Krylov subspace methods, PhD thesis, 2010.
+      Bai, Hu and Reichel, A Newton basis GMRES implementation, 1994.
+*/
+
+#include <../src/ksp/ksp/impls/gmres/cagmres/cagmresimpl.h>       /*I  "petscksp.h"  I*/
+#include <petscblaslapack.h>
+#define CAGMRES_DELTA_DIRECTIONS 10
+#define CAGMRES_DEFAULT_MAXK     30
+
+static PetscErrorCode KSPCAGMRESUpdateHessenberg(KSP,PetscInt,PetscBool*,PetscReal*);
+static PetscErrorCode KSPCAGMRESBuildSoln(PetscScalar*,Vec,Vec,KSP,PetscInt);
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetUp_CAGMRES"
+static PetscErrorCode KSPSetUp_CAGMRES(KSP ksp)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES*)ksp->data;
+  PetscInt       s = cagmres->s,max_k = cagmres->max_k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPSetUp_GMRES(ksp);CHKERRQ(ierr);
+  ierr = PetscFree5(cagmres->re,cagmres->im,cagmres->a,cagmres->b,cagmres->g);CHKERRQ(ierr);
+  ierr = PetscMalloc5(s,PetscReal,&cagmres->re,s,PetscReal,&cagmres->im,s,PetscScalar,&cagmres->a,s,PetscScalar,&cagmres->b,s,PetscScalar,&cagmres->g);CHKERRQ(ierr);
+  ierr = PetscFree5(cagmres->C,cagmres->G,cagmres->C2,cagmres->G2,cagmres->hcol);CHKERRQ(ierr);
+  ierr = PetscMalloc5((max_k+1)*s,PetscScalar,&cagmres->C,s*s,PetscScalar,&cagmres->G,(max_k+1)*s,PetscScalar,&cagmres->C2,s*s,PetscScalar,&cagmres->G2,max_k+2,PetscScalar,&cagmres->hcol);CHKERRQ(ierr);
+  if (!cagmres->orthogwork) {ierr = PetscMalloc((max_k+2)*sizeof(PetscScalar),&cagmres->orthogwork);CHKERRQ(ierr);}
+  ierr = PetscLogObjectMemory(ksp,(2*(max_k+1)*s+2*s*s+2*max_k+4)*sizeof(PetscScalar));CHKERRQ(ierr);
+  /* a new operator needs new estimates of its eigenvalues */
+  cagmres->neig = 0;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESComputeBasis"
+/*
+   Computes W[1..n] from W[0] with the recurrence g_j W[j+1] = Op W[j] - a_j W[j] - b_j W[j-1]
+*/
+static PetscErrorCode KSPCAGMRESComputeBasis(KSP ksp,PetscInt n,Vec *W)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       j;
+  PetscScalar    *a = cagmres->a,*b = cagmres->b,*g = cagmres->g;
+
+  PetscFunctionBegin;
+  if (cagmres->mp) {
+    ierr = KSPMatPowersApply(cagmres->mp,n,a,b,g,W);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  for (j=0; j<n; j++) {
+    ierr = KSP_PCApplyBAorAB(ksp,W[j],W[j+1],VEC_TEMP_MATOP);CHKERRQ(ierr);
+    if (a[j] == 0.0 && (!j || b[j] == 0.0) && g[j] == 1.0) continue;
+    if (j && b[j] != 0.0) {
+      ierr = VecAXPBYPCZ(W[j+1],-a[j]/g[j],-b[j]/g[j],1.0/g[j],W[j],W[j-1]);CHKERRQ(ierr);
+    } else {
+      ierr = VecAXPBY(W[j+1],-a[j]/g[j],1.0/g[j],W[j]);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESEstimateEigenvalues"
+/*
+   The Ritz values of the leading n x n block of the Hessenberg matrix are the shifts of the Newton basis
+*/
+static PetscErrorCode KSPCAGMRESEstimateEigenvalues(KSP ksp,PetscInt n)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES*)ksp->data;
+  PetscErrorCode ierr;
+#if defined(PETSC_MISSING_LAPACK_GEEV) || defined(PETSC_HAVE_ESSL)
+  PetscFunctionBegin;
+  ierr = PetscInfo(ksp,"No eigenvalue estimates without LAPACK geev(), using the monomial basis\n");CHKERRQ(ierr);
+  cagmres->basis = KSP_CA_BASIS_MONOMIAL;
+#else
+  PetscInt       i,j;
+  PetscScalar    *R,*work,sdummy;
+  PetscBLASInt   bn,lwork,idummy = 1,lierr;
+#if defined(PETSC_USE_COMPLEX)
+  PetscScalar    *eigs;
+  PetscReal      *rwork;
+#endif
+
+  PetscFunctionBegin;
+  bn    = PetscBLASIntCast(n);
+  lwork = PetscBLASIntCast(5*n);
+  ierr  = PetscMalloc2(n*n,PetscScalar,&R,5*n,PetscScalar,&work);CHKERRQ(ierr);
+  for (j=0; j<n; j++) for (i=0; i<n; i++) R[i+j*n] = *HES(i,j);
+  ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+#if !defined(PETSC_USE_COMPLEX)
+  LAPACKgeev_("N","N",&bn,R,&bn,cagmres->re,cagmres->im,&sdummy,&idummy,&sdummy,&idummy,work,&lwork,&lierr);
+#else
+  ierr = PetscMalloc2(n,PetscScalar,&eigs,2*n,PetscReal,&rwork);CHKERRQ(ierr);
+  LAPACKgeev_("N","N",&bn,R,&bn,eigs,&sdummy,&idummy,&sdummy,&idummy,work,&lwork,rwork,&lierr);
+  for (i=0; i<n; i++) {
+    cagmres->re[i] = PetscRealPart(eigs[i]);
+    cagmres->im[i] = PetscImaginaryPart(eigs[i]);
+  }
+  ierr = PetscFree2(eigs,rwork);CHKERRQ(ierr);
+#endif
+  ierr = PetscFPTrapPop();CHKERRQ(ierr);
+  if (lierr) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine %d",(int)lierr);
+  ierr = PetscFree2(R,work);CHKERRQ(ierr);
+  ierr = KSPCALejaOrder(n,cagmres->re,cagmres->im);CHKERRQ(ierr);
+  cagmres->neig = n;
+  ierr = PetscInfo1(ksp,"%D eigenvalue estimates for the basis\n",n);CHKERRQ(ierr);
+#endif
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESBlockOrthogonalize"
+/*
+   One pass of block classical Gram-Schmidt of the n vectors following VV(it) against VV(0..it), with one reduction
+   for C = V^H W and the Gram matrix W^H W, whose projection G - C^H C is factored in place as R^H R. On return
+   the leading k vectors of the block are replaced by Q = (W - V C) R^{-1}; k is smaller than n when R is not
+   numerically nonsingular, or when a diagonal entry of R is small enough relative to the norm of its vector
+   that cancellation left it with few correct digits.
+*/
+static PetscErrorCode KSPCAGMRESBlockOrthogonalize(KSP ksp,PetscInt it,PetscInt n,PetscScalar *C,PetscScalar *G,PetscInt *k)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       s = cagmres->s,ldc = cagmres->max_k+1,i,j,l;
+  PetscScalar    *nrm2 = cagmres->hcol,*work = cagmres->orthogwork;
+  PetscBLASInt   bn,bs,info;
+
+  PetscFunctionBegin;
+  for (i=0; i<n; i++) {
+    ierr = VecMDotBegin(VEC_VV(it+1+i),it+1,&VEC_VV(0),C+i*ldc);CHKERRQ(ierr);
+    ierr = VecMDotBegin(VEC_VV(it+1+i),i+1,&VEC_VV(it+1),G+i*s);CHKERRQ(ierr);
+  }
+  ierr = PetscCommSplitReductionBegin(((PetscObject)ksp)->comm);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    ierr = VecMDotEnd(VEC_VV(it+1+i),it+1,&VEC_VV(0),C+i*ldc);CHKERRQ(ierr);
+    ierr = VecMDotEnd(VEC_VV(it+1+i),i+1,&VEC_VV(it+1),G+i*s);CHKERRQ(ierr);
+  }
+
+  for (i=0; i<n; i++) {
+    nrm2[i] = G[i+i*s];
+    for (l=0; l<=i; l++) {
+      for (j=0; j<=it; j++) G[l+i*s] -= PetscConj(C[j+l*ldc])*C[j+i*ldc];
+    }
+  }
+  ierr = PetscLogFlops(2.0*(it+1)*n*(n+1)/2);CHKERRQ(ierr);
+  bn   = PetscBLASIntCast(n);
+  bs   = PetscBLASIntCast(s);
+#if defined(PETSC_MISSING_LAPACK_POTRF)
+  SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"POTRF - Lapack routine is unavailable.");
+#else
+  LAPACKpotrf_("U",&bn,G,&bs,&info);
+#endif
+  if (info < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine %d",(int)info);
+  *k = info > 0 ? info-1 : n;
+  for (i=0; i<*k; i++) {
+    if (PetscSqr(PetscRealPart(G[i+i*s])) < PETSC_SMALL*PetscRealPart(nrm2[i])) {*k = i; break;}
+  }
+
+  /* Q_i = (W_i - V C_i - sum_{l<i} Q_l R(l,i))/R(i,i), the basis and the block are contiguous */
+  for (i=0; i<*k; i++) {
+    for (j=0; j<=it; j++) work[j] = -C[j+i*ldc];
+    for (l=0; l<i; l++) work[it+1+l] = -G[l+i*s];
+    ierr = VecMAXPY(VEC_VV(it+1+i),it+1+i,work,&VEC_VV(0));CHKERRQ(ierr);
+    ierr = VecScale(VEC_VV(it+1+i),1.0/G[i+i*s]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESCycle"
+/*
+    KSPCAGMRESCycle - Runs one cycle of cagmres, up to the restart
+
+    Notes:
+    On entry, the value in vector VEC_VV(0) should be the initial residual.
+
+    Each block starts from the last orthonormal vector V_it = W_0 and computes W_1 ... W_ns. With V the basis
+    V_0 ... V_it, two passes of KSPCAGMRESBlockOrthogonalize() give W = V C + V_new R. With the recurrence of the
+    basis Op W_i = g_i W_{i+1} + a_i W_i + b_i W_{i-1}, and the columns of the Hessenberg matrix computed so far,
+    this gives the new columns of the Hessenberg matrix without further communication. If the block is too
+    ill-conditioned only its leading vectors are kept, and the first one is orthogonalized explicitly if none is left.
+*/
+static PetscErrorCode KSPCAGMRESCycle(PetscInt *itcount,KSP ksp)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES*)(ksp->data);
+  PetscErrorCode ierr;
+  PetscReal      res,nrm;
+  PetscInt       it = 0,s = cagmres->s,max_k = cagmres->max_k,ldc = max_k+1,ns,k,k2,i,j,l,c,pass,it0;
+  PetscScalar    *C = cagmres->C,*G = cagmres->G,*C2 = cagmres->C2,*G2 = cagmres->G2,*h = cagmres->hcol,*work = cagmres->orthogwork,coef;
+  PetscBool      hapend = PETSC_FALSE;
+  MPI_Comm       comm = ((PetscObject)ksp)->comm;
+
+  PetscFunctionBegin;
+  if (itcount) *itcount = 0;
+  ierr   = VecNormalize(VEC_VV(0),&res);CHKERRQ(ierr);
+  *RS(0) = res;
+
+  ierr = PetscObjectTakeAccess(ksp);CHKERRQ(ierr);
+  ksp->rnorm = res;
+  ierr = PetscObjectGrantAccess(ksp);CHKERRQ(ierr);
+  cagmres->it = it-1;
+  KSPLogResidualHistory(ksp,res);
+  ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+  if (!res) {
+    ksp->reason = KSP_CONVERGED_ATOL;
+    ierr = PetscInfo(ksp,"Converged due to zero residual norm on entry\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+
+  while (!ksp->reason && it < max_k && ksp->its < ksp->max_it) {
+    ns = PetscMin(s,max_k-it);
+    while (cagmres->vv_allocated <= it + ns + VEC_OFFSET) {
+      ierr = KSPGMRESGetNewVectors(ksp,cagmres->vv_allocated-VEC_OFFSET);CHKERRQ(ierr);
+    }
+    ierr = KSPCABasisCoefficients(cagmres->basis,ns,cagmres->neig,cagmres->re,cagmres->im,cagmres->a,cagmres->b,cagmres->g);CHKERRQ(ierr);
+    ierr = KSPCAGMRESComputeBasis(ksp,ns,&VEC_VV(it));CHKERRQ(ierr);
+
+    /*
+       Two passes of block classical Gram-Schmidt, each with one reduction. The first pass alone loses orthogonality
+       in proportion to the square of the condition number of the block, the second one restores it.
+    */
+    ierr = PetscLogEventBegin(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
+    ierr = KSPCAGMRESBlockOrthogonalize(ksp,it,ns,C,G,&k);CHKERRQ(ierr);
+    if (k) {
+      ierr = KSPCAGMRESBlockOrthogonalize(ksp,it,k,C2,G2,&k2);CHKERRQ(ierr);
+    } else {
+      for (j=0; j<=it; j++) C[j] = 0.0;
+      G[0] = 1.0;
+      k = 1; k2 = 0;
+    }
+    if (k2) {
+      if (k2 < ns) {ierr = PetscInfo2(ksp,"Block Gram matrix ill-conditioned, keeping %D of %D vectors\n",k2,ns);CHKERRQ(ierr);}
+      k = k2;
+    } else {
+      /* W_1 is numerically in the span of the basis, orthogonalize it explicitly with two passes of classical Gram-Schmidt */
+      ierr = PetscInfo1(ksp,"Block Gram matrix ill-conditioned at column %D, orthogonalizing explicitly\n",it);CHKERRQ(ierr);
+      for (j=0; j<=it; j++) C2[j] = 0.0;
+      for (pass=0; pass<2; pass++) {
+        ierr = VecMDot(VEC_VV(it+1),it+1,&VEC_VV(0),work);CHKERRQ(ierr);
+        for (j=0; j<=it; j++) {
+          C2[j]  += work[j];
+          work[j] = -work[j];
+        }
+        ierr = VecMAXPY(VEC_VV(it+1),it+1,work,&VEC_VV(0));CHKERRQ(ierr);
+      }
+      ierr  = VecNorm(VEC_VV(it+1),NORM_2,&nrm);CHKERRQ(ierr);
+      G2[0] = nrm;
+      if (nrm > 0.0) {ierr = VecScale(VEC_VV(it+1),1.0/nrm);CHKERRQ(ierr);}
+      k = 1;
+    }
+    /* W = V C + Q1 R = V (C + C2 R) + Q2 (R2 R), computed in place from the first row of R down */
+    for (i=0; i<k; i++) {
+      for (l=0; l<=i; l++) {
+        for (j=0; j<=it; j++) C[j+i*ldc] += C2[j+l*ldc]*G[l+i*s];
+      }
+      for (l=0; l<=i; l++) {
+        coef = 0.0;
+        for (j=l; j<=i; j++) coef += G2[l+j*s]*G[j+i*s];
+        G[l+i*s] = coef;
+      }
+    }
+    ierr = PetscLogFlops(2.0*(it+1)*k*(k+1)/2+k*(k+1)*(k+2)/3);CHKERRQ(ierr);
+    ierr = PetscLogEventEnd(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
+
+    /*
+       The new columns of the Hessenberg matrix. With W_m = sum_col Rf(col,m) V_col, where Rf(:,0) = e_it and
+       Rf(:,m) = [C_{m-1}; R(:,m-1)], column it+i is (Rf B(:,i) - sum_{col<it+i} Rf(col,i) H(:,col))/Rf(it+i,i)
+    */
+    it0 = it;
+    for (i=0; i<k; i++) {
+      c = it0+i;
+      for (j=0; j<=c+1; j++) h[j] = 0.0;
+#define RF(row,m) ((m) ? ((row) <= it0 ? C[(row)+((m)-1)*ldc] : ((row)-it0-1 < (m) ? G[((row)-it0-1)+((m)-1)*s] : 0.0)) : ((row) == it0 ? 1.0 : 0.0))
+      for (j=0; j<=c+1; j++) {
+        h[j] += cagmres->g[i]*RF(j,i+1) + cagmres->a[i]*RF(j,i);
+        if (i) h[j] += cagmres->b[i]*RF(j,i-1);
+      }
+      for (l=0; l<c; l++) {
+        coef = RF(l,i);
+        if (coef == 0.0) continue;
+        for (j=0; j<=l+1; j++) h[j] -= coef * *HES(j,l);
+      }
+      coef = RF(c,i);
+      for (j=0; j<=c+1; j++) *HH(j,c) = h[j]/coef;
+#undef RF
+      ierr = PetscLogFlops(2.0*(c+2)*(c+3));CHKERRQ(ierr);
+
+      ierr = KSPCAGMRESUpdateHessenberg(ksp,c,&hapend,&res);CHKERRQ(ierr);
+      it++;
+      cagmres->it = it-1;
+      ksp->its++;
+      ksp->rnorm  = res;
+      if (ksp->reason) break;
+      ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+      if (hapend) {
+        if (!ksp->reason) SETERRQ1(comm,PETSC_ERR_PLIB,"You reached the happy break down, but convergence was not indicated. Residual norm = %G",res);
+        break;
+      }
+      if (ksp->reason || ksp->its >= ksp->max_it) break;
+      if (it < max_k) {
+        KSPLogResidualHistory(ksp,res);
+        ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+      }
+    }
+
+    /* the shifts of the Newton basis come from the first block of the first cycle */
+    if (!cagmres->neig && cagmres->basis != KSP_CA_BASIS_MONOMIAL && it > 0) {
+      ierr = KSPCAGMRESEstimateEigenvalues(ksp,PetscMin(it,s));CHKERRQ(ierr);
+    }
+  }
+
+  /* Monitor if we know that we will not return for a restart */
+  if (it && (ksp->reason || ksp->its >= ksp->max_it)) {
+    KSPLogResidualHistory(ksp,res);
+    ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+  }
+  if (itcount) *itcount = it;
+  ierr = KSPCAGMRESBuildSoln(RS(0),ksp->vec_sol,ksp->vec_sol,ksp,it-1);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSolve_CAGMRES"
+static PetscErrorCode KSPSolve_CAGMRES(KSP ksp)
+{
+  PetscErrorCode ierr;
+  PetscInt       its,itcount;
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES *)ksp->data;
+  PetscBool      guess_zero = ksp->guess_zero,nopc,dscale;
+  Mat            Amat,Pmat;
+  MatStructure   pflag;
+
+  PetscFunctionBegin;
+  if (ksp->calc_sings && !cagmres->Rsvd) SETERRQ(((PetscObject)ksp)->comm,PETSC_ERR_ORDER,"Must call KSPSetComputeSingularValues() before KSPSetUp() is called");
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat,&pflag);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)ksp->pc,PCNONE,&nopc);CHKERRQ(ierr);
+  ierr = PCGetDiagonalScale(ksp->pc,&dscale);CHKERRQ(ierr);
+  if (cagmres->matpowers && nopc && !dscale && !ksp->nullsp && !ksp->transpose_solve) {
+    ierr = KSPMatPowersSetUp(Amat,cagmres->s,&cagmres->mp);CHKERRQ(ierr);
+  } else {
+    ierr = KSPMatPowersDestroy(&cagmres->mp);CHKERRQ(ierr);
+  }
+
+  ierr = PetscObjectTakeAccess(ksp);CHKERRQ(ierr);
+  ksp->its = 0;
+  ierr = PetscObjectGrantAccess(ksp);CHKERRQ(ierr);
+
+  itcount     = 0;
+  ksp->reason = KSP_CONVERGED_ITERATING;
+  while (!ksp->reason) {
+    ierr     = KSPInitialResidual(ksp,ksp->vec_sol,VEC_TEMP,VEC_TEMP_MATOP,VEC_VV(0),ksp->vec_rhs);CHKERRQ(ierr);
+    ierr     = KSPCAGMRESCycle(&its,ksp);CHKERRQ(ierr);
+    itcount += its;
+    if (itcount >= ksp->max_it) {
+      if (!ksp->reason) ksp->reason = KSP_DIVERGED_ITS;
+      break;
+    }
+    ksp->guess_zero = PETSC_FALSE; /* every future call to KSPInitialResidual() will have nonzero guess */
+  }
+  ksp->guess_zero = guess_zero; /* restore if user provided nonzero initial guess */
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPReset_CAGMRES"
+static PetscErrorCode KSPReset_CAGMRES(KSP ksp)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPMatPowersDestroy(&cagmres->mp);CHKERRQ(ierr);
+  ierr = PetscFree5(cagmres->re,cagmres->im,cagmres->a,cagmres->b,cagmres->g);CHKERRQ(ierr);
+  ierr = PetscFree5(cagmres->C,cagmres->G,cagmres->C2,cagmres->G2,cagmres->hcol);CHKERRQ(ierr);
+  ierr = KSPReset_GMRES(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPDestroy_CAGMRES"
+static PetscErrorCode KSPDestroy_CAGMRES(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPReset_CAGMRES(ksp);CHKERRQ(ierr);
+  ierr = KSPDestroy_GMRES(ksp);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPCAGMRESSetSteps_C","",PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPCAGMRESSetBasisType_C","",PETSC_NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPCAGMRESBuildSoln - create the solution from the starting vector and the
+                      current iterates.
+
+    Input parameters:
+        nrs - work area of size it + 1.
+        vguess  - index of initial guess
+        vdest - index of result.  Note that vguess may == vdest (replace
+                guess with the solution).
+        it - HH upper triangular part is a block of size (it+1) x (it+1)
+
+     This is an internal routine that knows about the CAGMRES internals.
+ */
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESBuildSoln"
+static PetscErrorCode KSPCAGMRESBuildSoln(PetscScalar *nrs,Vec vguess,Vec vdest,KSP ksp,PetscInt it)
+{
+  PetscScalar    tt;
+  PetscErrorCode ierr;
+  PetscInt       k,j;
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES *)(ksp->data);
+
+  PetscFunctionBegin;
+  if (it < 0) {                                 /* no cagmres steps have been performed */
+    ierr = VecCopy(vguess,vdest);CHKERRQ(ierr); /* VecCopy() is smart, exits immediately if vguess == vdest */
+    PetscFunctionReturn(0);
+  }
+
+  /* solve the upper triangular system - RS is the right side and HH is
+     the upper triangular matrix  - put soln in nrs */
+  if (*HH(it,it) != 0.0) {
+    nrs[it] = *RS(it) / *HH(it,it);
+  } else {
+    nrs[it] = 0.0;
+  }
+  for (k=it-1; k>=0; k--) {
+    tt  = *RS(k);
+    for (j=k+1; j<=it; j++) tt -= *HH(k,j) * nrs[j];
+    nrs[k]   = tt / *HH(k,k);
+  }
+
+  /* Accumulate the correction to the solution of the preconditioned problem in TEMP */
+  ierr = VecZeroEntries(VEC_TEMP);CHKERRQ(ierr);
+  ierr = VecMAXPY(VEC_TEMP,it+1,nrs,&VEC_VV(0));CHKERRQ(ierr);
+  ierr = KSPUnwindPreconditioner(ksp,VEC_TEMP,VEC_TEMP_MATOP);CHKERRQ(ierr);
+  /* add solution to previous solution */
+  if (vdest == vguess) {
+    ierr = VecAXPY(vdest,1.0,VEC_TEMP);CHKERRQ(ierr);
+  } else {
+    ierr = VecWAXPY(vdest,1.0,VEC_TEMP,vguess);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+    KSPCAGMRESUpdateHessenberg - Do the scalar work for the orthogonalization.
+                            Return new residual.
+
+    input parameters:
+
+.        ksp -    Krylov space object
+.        it  -    plane rotations are applied to the (it+1)th column of the
+                  modified hessenberg (i.e. HH(:,it))
+.        hapend - PETSC_FALSE not happy breakdown ending.
+
+    output parameters:
+.        res - the new residual
+
+ */
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESUpdateHessenberg"
+static PetscErrorCode KSPCAGMRESUpdateHessenberg(KSP ksp,PetscInt it,PetscBool *hapend,PetscReal *res)
+{
+  PetscScalar    *hh,*cc,*ss,*rs;
+  PetscInt       j;
+  PetscReal      hapbnd;
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES *)(ksp->data);
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  hh  = HH(0,it);  /* pointer to beginning of column to update */
+  cc  = CC(0);     /* beginning of cosine rotations */
+  ss  = SS(0);     /* beginning of sine rotations */
+  rs  = RS(0);     /* right hand side of least squares system */
+
+  /* The Hessenberg matrix is now correct through column it, save that form for the following columns and for spectral analysis */
+  for (j=0; j<=it+1; j++) *HES(j,it) = hh[j];
+
+  /* check for the happy breakdown */
+  hapbnd = PetscMin(PetscAbsScalar(hh[it+1] / rs[it]),cagmres->haptol);
+  if (PetscAbsScalar(hh[it+1]) < hapbnd) {
+    ierr = PetscInfo4(ksp,"Detected happy breakdown, current hapbnd = %14.12e H(%D,%D) = %14.12e\n",(double)hapbnd,it+1,it,(double)PetscAbsScalar(*HH(it+1,it)));CHKERRQ(ierr);
+    *hapend = PETSC_TRUE;
+  }
+
+  /* Apply all the previously computed plane rotations to the new column
+     of the Hessenberg matrix */
+  for (j=0; j<it; j++) {
+    PetscScalar hhj = hh[j];
+    hh[j]   = PetscConj(cc[j])*hhj + ss[j]*hh[j+1];
+    hh[j+1] =          -ss[j] *hhj + cc[j]*hh[j+1];
+  }
+
+  /* compute the new plane rotation, and apply it to the right hand side and to the new column */
+  if (!*hapend) {
+    PetscReal delta = PetscSqrtReal(PetscSqr(PetscAbsScalar(hh[it])) + PetscSqr(PetscAbsScalar(hh[it+1])));
+    if (delta == 0.0) {
+      ksp->reason = KSP_DIVERGED_NULL;
+      PetscFunctionReturn(0);
+    }
+
+    cc[it] = hh[it] / delta;    /* new cosine value */
+    ss[it] = hh[it+1] / delta;  /* new sine value */
+
+    hh[it] = PetscConj(cc[it])*hh[it] + ss[it]*hh[it+1];
+    rs[it+1]  = -ss[it]*rs[it];
+    rs[it]    = PetscConj(cc[it])*rs[it];
+    *res = PetscAbsScalar(rs[it+1]);
+  } else { /* happy breakdown: HH(it+1, it) = 0, the residual is zero */
+    *res = 0.0;
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPBuildSolution_CAGMRES"
+static PetscErrorCode KSPBuildSolution_CAGMRES(KSP ksp,Vec ptr,Vec *result)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES *)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!ptr) {
+    if (!cagmres->sol_temp) {
+      ierr = VecDuplicate(ksp->vec_sol,&cagmres->sol_temp);CHKERRQ(ierr);
+      ierr = PetscLogObjectParent(ksp,cagmres->sol_temp);CHKERRQ(ierr);
+    }
+    ptr = cagmres->sol_temp;
+  }
+  if (!cagmres->nrs) {
+    /* allocate the work area */
+    ierr = PetscMalloc(cagmres->max_k*sizeof(PetscScalar),&cagmres->nrs);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory(ksp,cagmres->max_k*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+
+  ierr = KSPCAGMRESBuildSoln(cagmres->nrs,ksp->vec_sol,ptr,ksp,cagmres->it);CHKERRQ(ierr);
+  if (result) *result = ptr;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPView_CAGMRES"
+static PetscErrorCode KSPView_CAGMRES(KSP ksp,PetscViewer viewer)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  CAGMRES: restart=%D, %D steps per reduction, %s basis\n",cagmres->max_k,cagmres->s,KSPCABasisTypes[cagmres->basis]);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"  CAGMRES: happy breakdown tolerance %G\n",cagmres->haptol);CHKERRQ(ierr);
+    if (cagmres->mp) {ierr = PetscViewerASCIIPrintf(viewer,"  CAGMRES: using the matrix powers kernel\n");CHKERRQ(ierr);}
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPSetFromOptions_CAGMRES"
+static PetscErrorCode KSPSetFromOptions_CAGMRES(KSP ksp)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       s;
+  KSPCABasisType basis;
+  PetscBool      flg;
+
+  PetscFunctionBegin;
+  ierr = KSPSetFromOptions_GMRES(ksp);CHKERRQ(ierr);
+  ierr = PetscOptionsHead("KSP CAGMRES Options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_cagmres_s","Number of basis vectors orthogonalized together","KSPCAGMRESSetSteps",cagmres->s,&s,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = KSPCAGMRESSetSteps(ksp,s);CHKERRQ(ierr);}
+  ierr = PetscOptionsEnum("-ksp_cagmres_basis","Polynomial basis","KSPCAGMRESSetBasisType",KSPCABasisTypes,(PetscEnum)cagmres->basis,(PetscEnum*)&basis,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = KSPCAGMRESSetBasisType(ksp,basis);CHKERRQ(ierr);}
+  ierr = PetscOptionsBool("-ksp_cagmres_matrix_powers","Use the matrix powers kernel for MATMPIAIJ without preconditioner","None",cagmres->matpowers,&cagmres->matpowers,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESSetSteps_CAGMRES"
+PetscErrorCode KSPCAGMRESSetSteps_CAGMRES(KSP ksp,PetscInt s)
+{
+  KSP_CAGMRES    *cagmres = (KSP_CAGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (s < 1) SETERRQ1(((PetscObject)ksp)->comm,PETSC_ERR_ARG_OUTOFRANGE,"Number of steps %D must be positive",s);
+  if (s != cagmres->s && ksp->setupstage) {ierr = KSPReset(ksp);CHKERRQ(ierr);}
+  cagmres->s = s;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESSetBasisType_CAGMRES"
+PetscErrorCode KSPCAGMRESSetBasisType_CAGMRES(KSP ksp,KSPCABasisType basis)
+{
+  KSP_CAGMRES *cagmres = (KSP_CAGMRES*)ksp->data;
+
+  PetscFunctionBegin;
+  cagmres->basis = basis;
+  cagmres->neig  = 0;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESSetSteps"
+/*@
+   KSPCAGMRESSetSteps - Sets the number of basis vectors that CAGMRES computes and orthogonalizes together
+
+   Logically Collective on KSP
+
+   Input Parameters:
++  ksp - the Krylov space context
+-  s - the number of vectors, the default is 5
+
+   Options Database Key:
+.  -ksp_cagmres_s <s> - the number of vectors
+
+   Notes:
+   The restart, set with KSPGMRESSetRestart(), should be a multiple of s, otherwise the last block of each cycle
+   is shorter. The polynomial bases become ill-conditioned for large s, values up to about 8 work with the Newton basis.
+
+   Level: intermediate
+
+.keywords: KSP, CAGMRES, s-step, communication avoiding
+
+.seealso: KSPCAGMRES, KSPCAGMRESSetBasisType(), KSPGMRESSetRestart()
+@*/
+PetscErrorCode KSPCAGMRESSetSteps(KSP ksp,PetscInt s)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveInt(ksp,s,2);
+  ierr = PetscTryMethod(ksp,"KSPCAGMRESSetSteps_C",(KSP,PetscInt),(ksp,s));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCAGMRESSetBasisType"
+/*@
+   KSPCAGMRESSetBasisType - Sets the polynomial basis of CAGMRES
+
+   Logically Collective on KSP
+
+   Input Parameters:
++  ksp - the Krylov space context
+-  basis - KSP_CA_BASIS_MONOMIAL, KSP_CA_BASIS_NEWTON (the default) or KSP_CA_BASIS_CHEBYSHEV
+
+   Options Database Key:
+.  -ksp_cagmres_basis <monomial,newton,chebyshev> - the basis
+
+   Notes:
+   The Newton basis uses the Ritz values of the first block, computed with the monomial basis, as shifts. The
+   Chebyshev basis uses the interval spanned by their real parts and is only suited to a real spectrum.
+   The estimates are computed again after each KSPSetUp().
+
+   Level: intermediate
+
+.keywords: KSP, CAGMRES, s-step, communication avoiding
+
+.seealso: KSPCAGMRES, KSPCAGMRESSetSteps(), KSPCABasisType
+@*/
+PetscErrorCode KSPCAGMRESSetBasisType(KSP ksp,KSPCABasisType basis)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveEnum(ksp,basis,2);
+  ierr = PetscTryMethod(ksp,"KSPCAGMRESSetBasisType_C",(KSP,KSPCABasisType),(ksp,basis));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPCAGMRES - Implements the s-step (communication avoiding) Generalized Minimal Residual method.
+
+   Options Database Keys:
++   -ksp_gmres_restart <restart> - the number of Krylov directions to orthogonalize against
+.   -ksp_gmres_haptol <tol> - sets the tolerance for "happy ending" (exact convergence)
+.   -ksp_gmres_preallocate - preallocate all the Krylov search directions initially (otherwise groups of
+                             vectors are allocated as needed)
+.   -ksp_cagmres_s <5> - number of basis vectors orthogonalized together
+.   -ksp_cagmres_basis <newton> - polynomial basis, monomial, newton or chebyshev
+-   -ksp_cagmres_matrix_powers - with a MATMPIAIJ operator and no preconditioner, compute each block with one VecScatter
+
+   Level: intermediate
+
+   Notes:
+   The Krylov basis is extended by blocks of s vectors computed with a polynomial recurrence, each block is
+   orthogonalized with two passes of block Gram-Schmidt that use the Cholesky factor of its Gram matrix projected on
+   the complement of the previous basis, so that there are two reductions per s iterations instead of one or two per
+   iteration with KSPGMRES. The orthogonalization options of KSPGMRES are ignored.
+
+   With -ksp_cagmres_matrix_powers and PCNONE the matrix powers kernel gathers the ghost values needed by all the
+   s products with a single VecScatter and computes the rows near the process boundary redundantly.
+
+   Reference:
+   Hoemmen, Communication-avoiding Krylov subspace methods, PhD thesis, 2010.
+
+   Developer Notes: This object is subclassed off of KSPGMRES
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPGMRES, KSPPGMRES, KSPCACG,
+           KSPCAGMRESSetSteps(), KSPCAGMRESSetBasisType(), KSPGMRESSetRestart(), KSPGMRESSetHapTol(), KSPGMRESSetPreAllocateVectors()
+M*/
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "KSPCreate_CAGMRES"
+PetscErrorCode KSPCreate_CAGMRES(KSP ksp)
+{
+  KSP_CAGMRES    *cagmres;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(ksp,KSP_CAGMRES,&cagmres);CHKERRQ(ierr);
+  ksp->data                              = (void*)cagmres;
+  ksp->ops->buildsolution                = KSPBuildSolution_CAGMRES;
+  ksp->ops->setup                        = KSPSetUp_CAGMRES;
+  ksp->ops->solve                        = KSPSolve_CAGMRES;
+  ksp->ops->reset                        = KSPReset_CAGMRES;
+  ksp->ops->destroy                      = KSPDestroy_CAGMRES;
+  ksp->ops->view                         = KSPView_CAGMRES;
+  ksp->ops->setfromoptions               = KSPSetFromOptions_CAGMRES;
+  ksp->ops->computeextremesingularvalues = KSPComputeExtremeSingularValues_GMRES;
+  ksp->ops->computeeigenvalues           = KSPComputeEigenvalues_GMRES;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_RIGHT,1);CHKERRQ(ierr);
+
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPGMRESSetPreAllocateVectors_C",
+                                    "KSPGMRESSetPreAllocateVectors_GMRES",
+                                     KSPGMRESSetPreAllocateVectors_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPGMRESSetRestart_C",
+                                    "KSPGMRESSetRestart_GMRES",
+                                     KSPGMRESSetRestart_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPGMRESGetRestart_C",
+                                    "KSPGMRESGetRestart_GMRES",
+                                     KSPGMRESGetRestart_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPGMRESSetHapTol_C",
+                                    "KSPGMRESSetHapTol_GMRES",
+                                     KSPGMRESSetHapTol_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPCAGMRESSetSteps_C",
+                                    "KSPCAGMRESSetSteps_CAGMRES",
+                                     KSPCAGMRESSetSteps_CAGMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ksp,"KSPCAGMRESSetBasisType_C",
+                                    "KSPCAGMRESSetBasisType_CAGMRES",
+                                     KSPCAGMRESSetBasisType_CAGMRES);CHKERRQ(ierr);
+
+  cagmres->nextra_vecs         = 1;
+  cagmres->haptol              = 1.0e-30;
+  cagmres->q_preallocate       = 0;
+  cagmres->delta_allocate      = CAGMRES_DELTA_DIRECTIONS;
+  cagmres->orthog              = KSPGMRESClassicalGramSchmidtOrthogonalization;
+  cagmres->nrs                 = 0;
+  cagmres->sol_temp            = 0;
+  cagmres->max_k               = CAGMRES_DEFAULT_MAXK;
+  cagmres->Rsvd                = 0;
+  cagmres->orthogwork          = 0;
+  cagmres->cgstype             = KSP_GMRES_CGS_REFINE_NEVER;
+  cagmres->s                   = 5;
+  cagmres->basis               = KSP_CA_BASIS_NEWTON;
+  cagmres->matpowers           = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
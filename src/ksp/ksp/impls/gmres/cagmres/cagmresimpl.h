@@ -0,0 +1,42 @@
+#if !defined(__CAGMRES)
+#define __CAGMRES
+
+#include <petsc-private/kspimpl.h>
+#define KSPGMRES_NO_MACROS
+#include <../src/ksp/ksp/impls/gmres/gmresimpl.h>
+
+typedef struct {
+  KSPGMRESHEADER
+  PetscInt       s;              /* number of basis vectors computed between two reductions */
+  KSPCABasisType basis;
+  PetscBool      matpowers;      /* use the matrix powers kernel when there is no preconditioner */
+  KSPMatPowers   mp;
+  PetscInt       neig;           /* number of eigenvalue estimates for the basis */
+  PetscReal      *re,*im;
+  PetscScalar    *a,*b,*g;       /* coefficients of the recurrence of the basis */
+  PetscScalar    *C;             /* inner products of the new block with the orthonormal basis, (max_k+1) x s */
+  PetscScalar    *G;             /* Gram matrix of the new block, then its projection and Cholesky factor, s x s */
+  PetscScalar    *C2,*G2;        /* the same for the second pass of the orthogonalization */
+  PetscScalar    *hcol;          /* column of the Hessenberg matrix being computed */
+} KSP_CAGMRES;
+
+#define HH(a,b)  (cagmres->hh_origin + (b)*(cagmres->max_k+2)+(a))
+                 /* HH will be size (max_k+2)*(max_k+1)  -  think of HH as
+                    being stored columnwise for access purposes. */
+#define HES(a,b) (cagmres->hes_origin + (b)*(cagmres->max_k+1)+(a))
+                  /* HES will be size (max_k + 1) * (max_k + 1) -
+                     again, think of HES as being stored columnwise */
+#define CC(a)    (cagmres->cc_origin + (a)) /* CC will be length (max_k+1) - cosines */
+#define SS(a)    (cagmres->ss_origin + (a)) /* SS will be length (max_k+1) - sines */
+#define RS(a)    (cagmres->rs_origin + (a)) /* RS will be length (max_k+2) - rt side */
+
+/* vector names */
+#define VEC_OFFSET     2
+#define VEC_TEMP       cagmres->vecs[0]               /* work space */
+#define VEC_TEMP_MATOP cagmres->vecs[1]               /* work space */
+#define VEC_VV(i)      cagmres->vecs[VEC_OFFSET+i]    /* use to access
+                                                        othog basis vectors */
+#endif
+
+
+
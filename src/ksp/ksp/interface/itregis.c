@@ -7,6 +7,7 @@ extern PetscErrorCode  KSPCreate_Chebyshev(KSP);
 extern PetscErrorCode  KSPCreate_CG(KSP);
 extern PetscErrorCode  KSPCreate_GROPPCG(KSP);
 extern PetscErrorCode  KSPCreate_PIPECG(KSP);
+extern PetscErrorCode  KSPCreate_CACG(KSP);
 extern PetscErrorCode  KSPCreate_CGNE(KSP);
 extern PetscErrorCode  KSPCreate_NASH(KSP);
 extern PetscErrorCode  KSPCreate_STCG(KSP);
@@ -33,6 +34,7 @@ extern PetscErrorCode  KSPCreate_LGMRES(KSP);
 extern PetscErrorCode  KSPCreate_LCD(KSP);
 extern PetscErrorCode  KSPCreate_GCR(KSP);
 extern PetscErrorCode  KSPCreate_PGMRES(KSP);
+extern PetscErrorCode  KSPCreate_CAGMRES(KSP);
 extern PetscErrorCode  KSPCreate_SpecEst(KSP);
 #if !defined(PETSC_USE_COMPLEX)
 extern PetscErrorCode  KSPCreate_DGMRES(KSP);
@@ -69,6 +71,7 @@ PetscErrorCode  KSPRegisterAll(const char path[])
   ierr = KSPRegisterDynamic(KSPCG,         path,"KSPCreate_CG",        KSPCreate_CG);CHKERRQ(ierr);
   ierr = KSPRegisterDynamic(KSPGROPPCG,    path,"KSPCreate_GROPPCG",   KSPCreate_GROPPCG);CHKERRQ(ierr);
   ierr = KSPRegisterDynamic(KSPPIPECG,     path,"KSPCreate_PIPECG",    KSPCreate_PIPECG);CHKERRQ(ierr);
+  ierr = KSPRegisterDynamic(KSPCACG,       path,"KSPCreate_CACG",      KSPCreate_CACG);CHKERRQ(ierr);
   ierr = KSPRegisterDynamic(KSPCGNE,       path,"KSPCreate_CGNE",      KSPCreate_CGNE);CHKERRQ(ierr);
   ierr = KSPRegisterDynamic(KSPNASH,       path,"KSPCreate_NASH",      KSPCreate_NASH);CHKERRQ(ierr);
   ierr = KSPRegisterDynamic(KSPSTCG,       path,"KSPCreate_STCG",      KSPCreate_STCG);CHKERRQ(ierr);
@@ -97,6 +100,7 @@ PetscErrorCode  KSPRegisterAll(const char path[])
   ierr = KSPRegisterDynamic(KSPLCD,        path,"KSPCreate_LCD",       KSPCreate_LCD);CHKERRQ(ierr);
   ierr = KSPRegisterDynamic(KSPGCR,        path,"KSPCreate_GCR",       KSPCreate_GCR);CHKERRQ(ierr);
   ierr = KSPRegisterDynamic(KSPPGMRES,     path,"KSPCreate_PGMRES",    KSPCreate_PGMRES);CHKERRQ(ierr);
+  ierr = KSPRegisterDynamic(KSPCAGMRES,    path,"KSPCreate_CAGMRES",   KSPCreate_CAGMRES);CHKERRQ(ierr);
   ierr = KSPRegisterDynamic(KSPSPECEST,    path,"KSPCreate_SpecEst",  KSPCreate_SpecEst);CHKERRQ(ierr);
 #if !defined(PETSC_USE_COMPLEX)
   ierr = KSPRegisterDynamic(KSPDGMRES,     path,"KSPCreate_DGMRES", KSPCreate_DGMRES);CHKERRQ(ierr);
@@ -0,0 +1,358 @@
+
+/*
+   Support for the s-step (communication avoiding) Krylov methods KSPCACG and KSPCAGMRES: the coefficients
+   of the polynomial bases and the matrix powers kernel for MATMPIAIJ.
+*/
+#include <petsc-private/kspimpl.h>       /*I "petscksp.h" I*/
+
+struct _n_KSPMatPowers {
+  Mat         mat;            /* the operator, not referenced */
+  PetscInt    state;          /* state of the operator when its rows were extracted */
+  PetscInt    s;              /* number of levels, that is the largest number of steps of one KSPMatPowersApply() */
+  PetscInt    *m;             /* m[k] is the number of rows within distance k of the owned rows, m[0] the local size */
+  PetscInt    *ia,*ja;        /* the rows 0..m[s-1]-1 of the operator in the local numbering */
+  PetscScalar *aa;
+  Vec         ghost;          /* the entries m[0]..m[s]-1 of the local numbering */
+  VecScatter  scatter;        /* gathers all of the ghost entries at once */
+  PetscScalar *work;          /* three arrays of length m[s], for y_{j-1}, y_j and y_{j+1} */
+};
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPMatPowersDestroy"
+/*
+   KSPMatPowersDestroy - Frees the matrix powers kernel
+*/
+PetscErrorCode KSPMatPowersDestroy(KSPMatPowers *mp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!*mp) PetscFunctionReturn(0);
+  ierr = PetscFree((*mp)->m);CHKERRQ(ierr);
+  ierr = PetscFree3((*mp)->ia,(*mp)->ja,(*mp)->aa);CHKERRQ(ierr);
+  ierr = PetscFree((*mp)->work);CHKERRQ(ierr);
+  ierr = VecDestroy(&(*mp)->ghost);CHKERRQ(ierr);
+  ierr = VecScatterDestroy(&(*mp)->scatter);CHKERRQ(ierr);
+  ierr = PetscFree(*mp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPMatPowersSetUp"
+/*
+   KSPMatPowersSetUp - Builds the matrix powers kernel for s steps with the operator A
+
+   Collective on Mat
+
+   Input Parameters:
++  A  - the operator, the kernel is only built for MATMPIAIJ
+-  s  - the number of levels
+
+   Output Parameter:
+.  mp - the kernel, PETSC_NULL if A is not supported
+
+   Notes:
+   The rows within distance s of the owned rows in the graph of A, found with MatIncreaseOverlap(), are numbered
+   locally by distance, so that step j of the recurrence only needs the leading m[s-1-j] rows. An existing kernel
+   is kept if it was built for the same number of levels and for the same state of A.
+*/
+PetscErrorCode KSPMatPowersSetUp(Mat A,PetscInt s,KSPMatPowers *mp)
+{
+  PetscErrorCode ierr;
+  PetscBool      flg;
+  PetscInt       state,rstart,rend,nloc,k,i,j,n,nprev,nnew,*prev,*cur,*gidx,*newg,*sorted,*lidx,*rowlen,nz,row;
+  const PetscInt *idx,*cols;
+  const PetscScalar *vals;
+  IS             is,isrow,iscol;
+  Mat            *sub;
+  Vec            x;
+  KSPMatPowers   p;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectStateQuery((PetscObject)A,&state);CHKERRQ(ierr);
+  if (*mp && (*mp)->mat == A && (*mp)->state == state && (*mp)->s == s) PetscFunctionReturn(0);
+  ierr = KSPMatPowersDestroy(mp);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATMPIAIJ,&flg);CHKERRQ(ierr);
+  if (!flg) PetscFunctionReturn(0);
+  if (s < 1) SETERRQ1(((PetscObject)A)->comm,PETSC_ERR_ARG_OUTOFRANGE,"Number of levels %D must be positive",s);
+
+  ierr = PetscNew(struct _n_KSPMatPowers,&p);CHKERRQ(ierr);
+  p->mat   = A;
+  p->state = state;
+  p->s     = s;
+  ierr = PetscMalloc((s+1)*sizeof(PetscInt),&p->m);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  nloc = rend - rstart;
+
+  /* the owned rows come first, then the rows at distance 1, 2, ... s each sorted; prev holds the sorted rows within distance k-1 */
+  ierr = PetscMalloc(nloc*sizeof(PetscInt),&gidx);CHKERRQ(ierr);
+  ierr = PetscMalloc(nloc*sizeof(PetscInt),&prev);CHKERRQ(ierr);
+  for (i=0; i<nloc; i++) gidx[i] = prev[i] = rstart + i;
+  p->m[0] = nprev = nloc;
+  cur     = PETSC_NULL;
+  ierr = ISCreateStride(PETSC_COMM_SELF,nloc,rstart,1,&is);CHKERRQ(ierr);
+  for (k=1; k<=s; k++) {
+    ierr = MatIncreaseOverlap(A,1,&is,1);CHKERRQ(ierr);
+    ierr = ISSort(is);CHKERRQ(ierr);
+    ierr = ISGetLocalSize(is,&n);CHKERRQ(ierr);
+    ierr = ISGetIndices(is,&idx);CHKERRQ(ierr);
+    ierr = PetscMalloc(n*sizeof(PetscInt),&newg);CHKERRQ(ierr);
+    ierr = PetscMemcpy(newg,gidx,nprev*sizeof(PetscInt));CHKERRQ(ierr);
+    for (i=0,j=0,nnew=nprev; i<n; i++) {
+      while (j < nprev && prev[j] < idx[i]) j++;
+      if (j < nprev && prev[j] == idx[i]) continue;
+      newg[nnew++] = idx[i];
+    }
+    ierr = PetscFree(gidx);CHKERRQ(ierr);
+    gidx = newg;
+    /* cur keeps the sorted rows within distance k-1, the rows of the submatrix below */
+    ierr = PetscFree(cur);CHKERRQ(ierr);
+    cur  = prev;
+    ierr = PetscMalloc(n*sizeof(PetscInt),&prev);CHKERRQ(ierr);
+    ierr = PetscMemcpy(prev,idx,n*sizeof(PetscInt));CHKERRQ(ierr);
+    ierr = ISRestoreIndices(is,&idx);CHKERRQ(ierr);
+    p->m[k] = nprev = n;
+  }
+  ierr = ISDestroy(&is);CHKERRQ(ierr);
+
+  /* local number of each of the sorted rows within distance s */
+  n    = p->m[s];
+  ierr = PetscMalloc2(n,PetscInt,&sorted,n,PetscInt,&lidx);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {sorted[i] = gidx[i]; lidx[i] = i;}
+  ierr = PetscSortIntWithArray(n,sorted,lidx);CHKERRQ(ierr);
+
+  /* the rows within distance s-1 restricted to the columns within distance s */
+  ierr = ISCreateGeneral(PETSC_COMM_SELF,p->m[s-1],cur,PETSC_USE_POINTER,&isrow);CHKERRQ(ierr);
+  ierr = ISCreateGeneral(PETSC_COMM_SELF,n,sorted,PETSC_USE_POINTER,&iscol);CHKERRQ(ierr);
+  ierr = MatGetSubMatrices(A,1,&isrow,&iscol,MAT_INITIAL_MATRIX,&sub);CHKERRQ(ierr);
+  ierr = ISDestroy(&isrow);CHKERRQ(ierr);
+  ierr = ISDestroy(&iscol);CHKERRQ(ierr);
+
+  ierr = PetscMalloc((p->m[s-1]+1)*sizeof(PetscInt),&rowlen);CHKERRQ(ierr);
+  for (i=0; i<p->m[s-1]; i++) {
+    ierr = PetscFindInt(cur[i],n,sorted,&j);CHKERRQ(ierr);
+    row  = lidx[j];
+    ierr = MatGetRow(sub[0],i,&nz,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+    rowlen[row] = nz;
+    ierr = MatRestoreRow(sub[0],i,&nz,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+  }
+  for (i=0,nz=0; i<p->m[s-1]; i++) nz += rowlen[i];
+  ierr = PetscMalloc3(p->m[s-1]+1,PetscInt,&p->ia,nz,PetscInt,&p->ja,nz,PetscScalar,&p->aa);CHKERRQ(ierr);
+  p->ia[0] = 0;
+  for (i=0; i<p->m[s-1]; i++) p->ia[i+1] = p->ia[i] + rowlen[i];
+  for (i=0; i<p->m[s-1]; i++) {
+    ierr = PetscFindInt(cur[i],n,sorted,&j);CHKERRQ(ierr);
+    row  = lidx[j];
+    ierr = MatGetRow(sub[0],i,&nz,&cols,&vals);CHKERRQ(ierr);
+    for (j=0; j<nz; j++) {
+      p->ja[p->ia[row]+j] = lidx[cols[j]];
+      p->aa[p->ia[row]+j] = vals[j];
+    }
+    ierr = MatRestoreRow(sub[0],i,&nz,&cols,&vals);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(rowlen);CHKERRQ(ierr);
+  ierr = MatDestroyMatrices(1,&sub);CHKERRQ(ierr);
+
+  /* one scatter for the ghost entries of all the levels */
+  ierr = MatGetVecs(A,&x,PETSC_NULL);CHKERRQ(ierr);
+  ierr = VecCreateSeq(PETSC_COMM_SELF,n-nloc,&p->ghost);CHKERRQ(ierr);
+  ierr = ISCreateGeneral(PETSC_COMM_SELF,n-nloc,gidx+nloc,PETSC_USE_POINTER,&is);CHKERRQ(ierr);
+  ierr = VecScatterCreate(x,is,p->ghost,PETSC_NULL,&p->scatter);CHKERRQ(ierr);
+  ierr = ISDestroy(&is);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = PetscMalloc(3*n*sizeof(PetscScalar),&p->work);CHKERRQ(ierr);
+
+  ierr = PetscInfo4(A,"%D levels, %D local rows, %D rows computed redundantly, %D ghost entries\n",s,nloc,p->m[s-1]-nloc,n-nloc);CHKERRQ(ierr);
+  ierr = PetscFree2(sorted,lidx);CHKERRQ(ierr);
+  ierr = PetscFree(cur);CHKERRQ(ierr);
+  ierr = PetscFree(prev);CHKERRQ(ierr);
+  ierr = PetscFree(gidx);CHKERRQ(ierr);
+  *mp = p;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPMatPowersApply"
+/*
+   KSPMatPowersApply - Computes n steps of the three term recurrence g_j y_{j+1} = A y_j - a_j y_j - b_j y_{j-1}
+
+   Collective on Vec
+
+   Input Parameters:
++  mp    - the kernel from KSPMatPowersSetUp()
+.  n     - the number of steps, at most the number of levels of the kernel
+.  a,b,g - the coefficients of the recurrence
+-  y     - y[0] is the starting vector
+
+   Output Parameter:
+.  y - y[1] ... y[n]
+
+   Notes:
+   The ghost entries of y[0] for all the steps are gathered with one VecScatter, the rows near the process
+   boundary are then computed redundantly on the neighbouring processes.
+*/
+PetscErrorCode KSPMatPowersApply(KSPMatPowers mp,PetscInt n,const PetscScalar a[],const PetscScalar b[],const PetscScalar g[],Vec y[])
+{
+  PetscErrorCode    ierr;
+  PetscInt          s = mp->s,M = mp->m[s],m0 = mp->m[0],i,j,k,nrows;
+  const PetscInt    *ia = mp->ia,*ja = mp->ja;
+  const PetscScalar *aa = mp->aa,*x;
+  PetscScalar       *prev = mp->work,*cur = mp->work+M,*next = mp->work+2*M,*t,*v,sum,ginv;
+  PetscLogDouble    flops = 0.0;
+
+  PetscFunctionBegin;
+  if (n > s) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Cannot compute %D steps with a kernel of %D levels",n,s);
+  ierr = PetscLogEventBegin(KSP_MatPowers,mp->mat,0,0,0);CHKERRQ(ierr);
+  ierr = VecScatterBegin(mp->scatter,y[0],mp->ghost,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(y[0],&x);CHKERRQ(ierr);
+  ierr = PetscMemcpy(cur,x,m0*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(y[0],&x);CHKERRQ(ierr);
+  ierr = VecScatterEnd(mp->scatter,y[0],mp->ghost,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(mp->ghost,&x);CHKERRQ(ierr);
+  ierr = PetscMemcpy(cur+m0,x,(M-m0)*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(mp->ghost,&x);CHKERRQ(ierr);
+
+  for (j=0; j<n; j++) {
+    /* y_j is correct on the rows within distance s-j, so y_{j+1} is on those within distance s-j-1 */
+    nrows = mp->m[s-1-j];
+    ginv  = 1.0/g[j];
+    for (i=0; i<nrows; i++) {
+      sum = -a[j]*cur[i];
+      for (k=ia[i]; k<ia[i+1]; k++) sum += aa[k]*cur[ja[k]];
+      if (j) sum -= b[j]*prev[i];
+      next[i] = sum*ginv;
+    }
+    flops += 2.0*ia[nrows] + 5.0*nrows;
+    ierr = VecGetArray(y[j+1],&v);CHKERRQ(ierr);
+    ierr = PetscMemcpy(v,next,m0*sizeof(PetscScalar));CHKERRQ(ierr);
+    ierr = VecRestoreArray(y[j+1],&v);CHKERRQ(ierr);
+    t = prev; prev = cur; cur = next; next = t;
+  }
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  ierr = PetscLogEventEnd(KSP_MatPowers,mp->mat,0,0,0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCALejaOrder"
+/*
+   KSPCALejaOrder - Orders the estimates of the eigenvalues for the Newton basis
+
+   Input Parameters:
++  n  - the number of values
+-  re,im - the real and imaginary parts
+
+   Notes:
+   The first value is the one of largest modulus, each following one maximizes the product of the distances to the
+   values already taken. In real arithmetic a complex value is directly followed by its conjugate, the one with
+   positive imaginary part first, so that the basis can be computed in real arithmetic.
+*/
+PetscErrorCode KSPCALejaOrder(PetscInt n,PetscReal re[],PetscReal im[])
+{
+  PetscErrorCode ierr;
+  PetscInt       i,j,k,cnt = 0;
+  PetscReal      *ore,*oim,*logprod,best,d;
+  PetscBool      *used;
+
+  PetscFunctionBegin;
+  if (n < 2) PetscFunctionReturn(0);
+  ierr = PetscMalloc4(n,PetscReal,&ore,n,PetscReal,&oim,n,PetscReal,&logprod,n,PetscBool,&used);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {logprod[i] = 0.0; used[i] = PETSC_FALSE;}
+  for (i=1,k=0; i<n; i++) if (PetscSqr(re[i])+PetscSqr(im[i]) > PetscSqr(re[k])+PetscSqr(im[k])) k = i;
+  while (cnt < n) {
+    /* take k and, in real arithmetic, its conjugate */
+    for (j=0; j<2; j++) {
+      used[k]   = PETSC_TRUE;
+      ore[cnt]  = re[k];
+      oim[cnt]  = im[k];
+#if !defined(PETSC_USE_COMPLEX)
+      if (!j && oim[cnt] < 0.0) oim[cnt] = -oim[cnt];
+      else if (j) oim[cnt] = -oim[cnt-1];
+#endif
+      cnt++;
+      for (i=0; i<n; i++) {
+        if (used[i]) continue;
+        d           = PetscSqrtReal(PetscSqr(re[i]-re[k])+PetscSqr(im[i]-im[k]));
+        logprod[i] += PetscLogReal(PetscMax(d,PETSC_SMALL*PetscSqrtReal(PetscSqr(re[k])+PetscSqr(im[k]))+PETSC_MACHINE_EPSILON));
+      }
+#if !defined(PETSC_USE_COMPLEX)
+      if (j || im[k] == 0.0) break;
+      {
+        PetscInt conj = -1;
+        for (i=0; i<n; i++) {
+          if (used[i]) continue;
+          if (conj < 0 || PetscAbsReal(re[i]-re[k])+PetscAbsReal(im[i]+im[k]) < PetscAbsReal(re[conj]-re[k])+PetscAbsReal(im[conj]+im[k])) conj = i;
+        }
+        if (conj < 0) break;
+        k = conj;
+      }
+#else
+      break;
+#endif
+    }
+    for (i=0,k=-1,best=0.0; i<n; i++) {
+      if (used[i]) continue;
+      if (k < 0 || logprod[i] > best) {k = i; best = logprod[i];}
+    }
+    if (k < 0) break;
+  }
+  ierr = PetscMemcpy(re,ore,n*sizeof(PetscReal));CHKERRQ(ierr);
+  ierr = PetscMemcpy(im,oim,n*sizeof(PetscReal));CHKERRQ(ierr);
+  ierr = PetscFree4(ore,oim,logprod,used);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "KSPCABasisCoefficients"
+/*
+   KSPCABasisCoefficients - Computes the coefficients of the three term recurrence of a polynomial basis
+
+   Input Parameters:
++  type  - the basis
+.  s     - the number of steps of the recurrence
+.  n     - the number of eigenvalue estimates, the monomial basis is used if there are none
+-  re,im - the estimates, Leja ordered with KSPCALejaOrder() for the Newton basis
+
+   Output Parameters:
+.  a,b,g - the coefficients of g_j y_{j+1} = Op y_j - a_j y_j - b_j y_{j-1}, arrays of length s
+
+   Notes:
+   The Newton basis uses the estimates as shifts, cyclically if there are fewer than s. In real arithmetic a
+   conjugate pair re +- i im gives the two real steps y_{j+1} = (Op - re) y_j and y_{j+2} = (Op - re) y_{j+1} + im^2 y_j.
+   The Chebyshev basis is the one of the interval spanned by the real parts of the estimates.
+*/
+PetscErrorCode KSPCABasisCoefficients(KSPCABasisType type,PetscInt s,PetscInt n,const PetscReal re[],const PetscReal im[],PetscScalar a[],PetscScalar b[],PetscScalar g[])
+{
+  PetscInt  j,k;
+  PetscReal lmin,lmax,c,d;
+
+  PetscFunctionBegin;
+  for (j=0; j<s; j++) {a[j] = 0.0; b[j] = 0.0; g[j] = 1.0;}
+  if (type == KSP_CA_BASIS_MONOMIAL || !n) PetscFunctionReturn(0);
+  if (type == KSP_CA_BASIS_NEWTON) {
+    for (j=0; j<s; j++) {
+      k = j % n;
+#if !defined(PETSC_USE_COMPLEX)
+      a[j] = re[k];
+      if (im[k] > 0.0 && j+1 < s && k+1 < n) {
+        a[j+1] = re[k];
+        b[j+1] = -im[k]*im[k];
+        j++;
+      }
+#else
+      a[j] = re[k] + PETSC_i*im[k];
+#endif
+    }
+  } else {
+    lmin = lmax = re[0];
+    for (k=1; k<n; k++) {lmin = PetscMin(lmin,re[k]); lmax = PetscMax(lmax,re[k]);}
+    c = 0.5*(lmax + lmin);
+    d = 0.5*(lmax - lmin);
+    for (j=0; j<s; j++) a[j] = c;
+    if (d > PETSC_SMALL*PetscAbsReal(c)) {
+      g[0] = d;
+      for (j=1; j<s; j++) {g[j] = 0.5*d; b[j] = 0.5*d;}
+    }
+  }
+  PetscFunctionReturn(0);
+}
@@ -0,0 +1,88 @@
+
+static char help[] = "Times MatAssemblyBegin/End() and VecAssemblyBegin/End() with off-process entries to a few neighbors.\n\n\
+  -m <m>        number of locally owned rows\n\
+  -nbrs <k>     each process sets entries in the rows of its k neighbors on either side\n\
+  -its <its>    number of assemblies timed\n\
+  -timing       print the average assembly times\n\n";
+
+/*
+  Run with increasing numbers of processes and compare, for example,
+     mpiexec -n 64 ./ex169 -timing -build_twosided ibarrier
+     mpiexec -n 64 ./ex169 -timing -build_twosided allreduce
+  With ibarrier the cost of discovering who sends to whom depends on the number of
+  neighbors, not on the number of processes.
+*/
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  Mat            A;
+  Vec            x;
+  PetscErrorCode ierr;
+  PetscMPIInt    rank,size;
+  PetscInt       m = 100,nbrs = 2,its = 10,i,j,k,p,rstart,N,row,col;
+  PetscScalar    v;
+  PetscReal      nrm,xnrm;
+  PetscBool      timing = PETSC_FALSE;
+  PetscLogDouble t0,t1,tmat = 0.0,tvec = 0.0;
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-nbrs",&nbrs,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-its",&its,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-timing",&timing,PETSC_NULL);CHKERRQ(ierr);
+  nbrs = PetscMin(nbrs,(size-1)/2);
+  N    = m*size;
+
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,m,m,N,N,2*nbrs+1,PETSC_NULL,2*nbrs+1,PETSC_NULL,&A);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatGetVecs(A,&x,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,PETSC_NULL);CHKERRQ(ierr);
+
+  for (k=0; k<its; k++) {
+    ierr = MatZeroEntries(A);CHKERRQ(ierr);
+    ierr = VecSet(x,0.0);CHKERRQ(ierr);
+    /* entry (i,j) of the block coupling this process to process p, including p == rank */
+    for (p=rank-nbrs; p<=rank+nbrs; p++) {
+      for (i=0; i<m; i++) {
+        row = ((p+size)%size)*m + i;
+        col = rstart + i;
+        v   = 1.0;
+        ierr = MatSetValues(A,1,&row,1,&col,&v,ADD_VALUES);CHKERRQ(ierr);
+        ierr = VecSetValues(x,1,&row,&v,ADD_VALUES);CHKERRQ(ierr);
+      }
+    }
+    ierr = MPI_Barrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+    ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+    tmat += t1 - t0;
+    ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+    ierr = VecAssemblyBegin(x);CHKERRQ(ierr);
+    ierr = VecAssemblyEnd(x);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+    tvec += t1 - t0;
+  }
+
+  /* each row receives one entry from each of its 2*nbrs+1 neighbors */
+  ierr = MatNorm(A,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = VecNorm(x,NORM_INFINITY,&xnrm);CHKERRQ(ierr);
+  j    = 2*nbrs+1;
+  if (nrm != (PetscReal)j || xnrm != (PetscReal)j) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Wrong result: matrix norm %G vector norm %G expected %D\n",nrm,xnrm,j);CHKERRQ(ierr);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Assembled %D rows from %D neighbors per process\n",N,2*nbrs);CHKERRQ(ierr);
+  if (timing) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Processes %d: MatAssembly %G ms, VecAssembly %G ms\n",size,1.e3*tmat/its,1.e3*tvec/its);CHKERRQ(ierr);
+  }
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
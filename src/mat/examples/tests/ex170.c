@@ -0,0 +1,160 @@
+
+static char help[] = "Tests the products of MATSELL matrices against MATAIJ.\n\n\
+  -m <m>        number of locally owned rows\n\
+  -timing       also time MatMult() for both formats\n\
+  -its <its>    number of products timed\n\n";
+
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckProducts"
+static PetscErrorCode CheckProducts(Mat A,Mat S,const char *stage)
+{
+  PetscErrorCode ierr;
+  Vec            x,y,z,ya,ys,xt,yt;
+  PetscReal      nrm[4],ref[4];
+  PetscInt       i;
+  PetscRandom    rand;
+
+  PetscFunctionBegin;
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = MatGetVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&z);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&ya);CHKERRQ(ierr);
+  ierr = VecDuplicate(y,&ys);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&xt);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&yt);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(z,rand);CHKERRQ(ierr);
+
+  ierr = MatMult(A,x,ya);CHKERRQ(ierr);
+  ierr = MatMult(S,x,ys);CHKERRQ(ierr);
+  ierr = VecAXPY(ys,-1.0,ya);CHKERRQ(ierr);
+  ierr = VecNorm(ys,NORM_INFINITY,&nrm[0]);CHKERRQ(ierr);
+  ierr = VecNorm(ya,NORM_INFINITY,&ref[0]);CHKERRQ(ierr);
+
+  ierr = MatMultAdd(A,x,z,ya);CHKERRQ(ierr);
+  ierr = VecCopy(z,ys);CHKERRQ(ierr);
+  ierr = MatMultAdd(S,x,ys,ys);CHKERRQ(ierr);
+  ierr = VecAXPY(ys,-1.0,ya);CHKERRQ(ierr);
+  ierr = VecNorm(ys,NORM_INFINITY,&nrm[1]);CHKERRQ(ierr);
+  ierr = VecNorm(ya,NORM_INFINITY,&ref[1]);CHKERRQ(ierr);
+
+  ierr = MatMultTranspose(A,z,xt);CHKERRQ(ierr);
+  ierr = MatMultTranspose(S,z,yt);CHKERRQ(ierr);
+  ierr = VecAXPY(yt,-1.0,xt);CHKERRQ(ierr);
+  ierr = VecNorm(yt,NORM_INFINITY,&nrm[2]);CHKERRQ(ierr);
+  ierr = VecNorm(xt,NORM_INFINITY,&ref[2]);CHKERRQ(ierr);
+
+  ierr = MatMultTransposeAdd(A,z,x,xt);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd(S,z,x,yt);CHKERRQ(ierr);
+  ierr = VecAXPY(yt,-1.0,xt);CHKERRQ(ierr);
+  ierr = VecNorm(yt,NORM_INFINITY,&nrm[3]);CHKERRQ(ierr);
+  ierr = VecNorm(xt,NORM_INFINITY,&ref[3]);CHKERRQ(ierr);
+
+  for (i=0; i<4; i++) {
+    if (nrm[i] > 100.0*PETSC_MACHINE_EPSILON*ref[i]) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: product %D differs from AIJ by %G\n",stage,i,nrm[i]/ref[i]);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: products checked\n",stage);CHKERRQ(ierr);
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&ya);CHKERRQ(ierr);
+  ierr = VecDestroy(&ys);CHKERRQ(ierr);
+  ierr = VecDestroy(&xt);CHKERRQ(ierr);
+  ierr = VecDestroy(&yt);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  Mat            A,S,T;
+  Vec            x,y;
+  PetscErrorCode ierr;
+  PetscInt       m = 97,N,rstart,rend,i,j,nz,col,its = 100;
+  PetscScalar    v;
+  PetscBool      timing = PETSC_FALSE;
+  PetscLogDouble t0,t1,taij,tsell;
+  MatType        type;
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-its",&its,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-timing",&timing,PETSC_NULL);CHKERRQ(ierr);
+
+  /* a matrix with irregular row lengths, including empty rows, and couplings to other processes */
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,m,m,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
+  ierr = MatSetType(A,MATAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,14,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,14,PETSC_NULL,13,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(A,&N,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) {
+    if (i % 11 == 5) continue;
+    nz = 1 + ((i%13)*(i%13)) % 13;
+    for (j=0; j<nz; j++) {
+      col  = (i + j*j*7 + (j%2 ? N/3 : 0)) % N;
+      v    = 1.0 + i%5 + 0.5*j;
+      ierr = MatSetValues(A,1,&i,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = MatConvert(A,MATSELL,MAT_INITIAL_MATRIX,&S);CHKERRQ(ierr);
+  ierr = MatGetType(S,&type);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Converted to %s\n",type);CHKERRQ(ierr);
+  ierr = CheckProducts(A,S,"MatConvert()");CHKERRQ(ierr);
+
+  /* the SELL copy must follow changes of the values */
+  ierr = MatScale(A,2.0);CHKERRQ(ierr);
+  ierr = MatScale(S,2.0);CHKERRQ(ierr);
+  ierr = CheckProducts(A,S,"MatScale()");CHKERRQ(ierr);
+  ierr = MatAXPY(A,-0.5,A,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatDuplicate(S,MAT_COPY_VALUES,&T);CHKERRQ(ierr);
+  ierr = MatAXPY(S,-0.5,T,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatDestroy(&T);CHKERRQ(ierr);
+  ierr = CheckProducts(A,S,"MatAXPY()");CHKERRQ(ierr);
+
+  /* reassembly with new values */
+  for (i=rstart; i<rend; i++) {
+    if (i % 11 == 5) continue;
+    v    = -1.0*i;
+    ierr = MatSetValues(A,1,&i,1,&i,&v,ADD_VALUES);CHKERRQ(ierr);
+    ierr = MatSetValues(S,1,&i,1,&i,&v,ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(S,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(S,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = CheckProducts(A,S,"MatAssemblyEnd()");CHKERRQ(ierr);
+
+  if (timing) {
+    ierr = MatGetVecs(A,&x,&y);CHKERRQ(ierr);
+    ierr = VecSet(x,1.0);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+    for (i=0; i<its; i++) {ierr = MatMult(A,x,y);CHKERRQ(ierr);}
+    ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+    taij = (t1-t0)/its;
+    ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+    for (i=0; i<its; i++) {ierr = MatMult(S,x,y);CHKERRQ(ierr);}
+    ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+    tsell = (t1-t0)/its;
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"MatMult AIJ %G ms, SELL %G ms, speedup %G\n",1.e3*taij,1.e3*tsell,taij/tsell);CHKERRQ(ierr);
+    ierr = VecDestroy(&x);CHKERRQ(ierr);
+    ierr = VecDestroy(&y);CHKERRQ(ierr);
+  }
+
+  ierr = MatDestroy(&S);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,98 @@
+
+static char help[] = "Tests MatLoad() with MPI-IO for the AIJ, BAIJ and SBAIJ formats.\n\n\
+  -n <n>        global number of rows\n\
+  -timing       print the time of each load\n\n";
+
+/*
+   The matrix is saved with MatView() and loaded back once with the default binary viewer,
+   where the first process reads the file and sends each process its rows, and once with
+   a viewer in MPI-IO mode where each process reads its own rows.  With -matload_block_size
+   not dividing n the block formats pad the matrix with extra rows.
+*/
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "LoadMatrix"
+static PetscErrorCode LoadMatrix(MatType type,PetscBool mpiio,Mat *A,PetscLogDouble *time)
+{
+  PetscErrorCode ierr;
+  PetscViewer    viewer;
+  PetscLogDouble t0,t1;
+
+  PetscFunctionBegin;
+  ierr = PetscViewerCreate(PETSC_COMM_WORLD,&viewer);CHKERRQ(ierr);
+  ierr = PetscViewerSetType(viewer,PETSCVIEWERBINARY);CHKERRQ(ierr);
+  if (mpiio) {ierr = PetscViewerBinarySetMPIIO(viewer);CHKERRQ(ierr);}
+  ierr = PetscViewerFileSetMode(viewer,FILE_MODE_READ);CHKERRQ(ierr);
+  ierr = PetscViewerFileSetName(viewer,"matrix.dat");CHKERRQ(ierr);
+  ierr = MatCreate(PETSC_COMM_WORLD,A);CHKERRQ(ierr);
+  ierr = MatSetType(*A,type);CHKERRQ(ierr);
+  ierr = MPI_Barrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+  ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+  ierr = MatLoad(*A,viewer);CHKERRQ(ierr);
+  ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+  *time = t1 - t0;
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  Mat            A,B,C;
+  PetscViewer    viewer;
+  PetscErrorCode ierr;
+  PetscInt       n = 53,i,j,k,rstart,rend,col[5];
+  PetscScalar    v[5];
+  PetscBool      flg,timing = PETSC_FALSE;
+  PetscLogDouble tdef,tmpiio;
+  MatType        types[3];
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-timing",&timing,PETSC_NULL);CHKERRQ(ierr);
+
+  /* a symmetric matrix with couplings to rows owned by other processes */
+  ierr = MatCreateAIJ(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n,n,5,PETSC_NULL,4,PETSC_NULL,&A);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  for (i=rstart; i<rend; i++) {
+    k = 0;
+    col[k] = i; v[k++] = 4.0 + i%3;
+    for (j=1; j<=n/2; j*=n/3+1) {
+      if (i-j >= 0) {col[k] = i-j; v[k++] = -1.0/(1 + (i-j)%4 + j);}
+      if (i+j < n)  {col[k] = i+j; v[k++] = -1.0/(1 + i%4 + j);}
+    }
+    ierr = MatSetValues(A,1,&i,k,col,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD,"matrix.dat",FILE_MODE_WRITE,&viewer);CHKERRQ(ierr);
+  ierr = MatView(A,viewer);CHKERRQ(ierr);
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+
+  types[0] = MATAIJ; types[1] = MATBAIJ; types[2] = MATSBAIJ;
+  for (i=0; i<3; i++) {
+    ierr = LoadMatrix(types[i],PETSC_FALSE,&B,&tdef);CHKERRQ(ierr);
+    ierr = LoadMatrix(types[i],PETSC_TRUE,&C,&tmpiio);CHKERRQ(ierr);
+    ierr = MatEqual(B,C,&flg);CHKERRQ(ierr);
+    if (!flg) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: matrix loaded with MPI-IO differs\n",types[i]);CHKERRQ(ierr);
+    }
+    if (!i) {
+      ierr = MatEqual(A,C,&flg);CHKERRQ(ierr);
+      if (!flg) {ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: matrix loaded with MPI-IO differs from the one saved\n",types[i]);CHKERRQ(ierr);}
+    }
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: loaded\n",types[i]);CHKERRQ(ierr);
+    if (timing) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: MatLoad %G s, with MPI-IO %G s\n",types[i],tdef,tmpiio);CHKERRQ(ierr);
+    }
+    ierr = MatDestroy(&B);CHKERRQ(ierr);
+    ierr = MatDestroy(&C);CHKERRQ(ierr);
+  }
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
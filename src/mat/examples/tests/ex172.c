@@ -0,0 +1,174 @@
+
+static char help[] = "Tests MatSOR() for SeqAIJ in the multicolor ordering, -mat_sor_multicolor, against the natural ordering of the permuted matrix.\n\n\
+  -m <m>        number of grid points in each direction\n\n";
+
+/*
+   Run with threads to relax the rows of each color in parallel, for example
+      ./ex172 -threadcomm_type pthread -threadcomm_nthreads 4
+*/
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "PermuteByColor"
+/*
+   Builds B = P A P^T for the ordering of the rows by color that MatSOR() uses with -mat_sor_multicolor, perm[i] is the
+   position of row i of A in B
+*/
+static PetscErrorCode PermuteByColor(Mat A,PetscInt *perm,Mat *B)
+{
+  PetscErrorCode    ierr;
+  ISColoring        iscoloring;
+  PetscInt          m,i,j,c,k,ncols;
+  const PetscInt    *cols;
+  const PetscScalar *vals;
+
+  PetscFunctionBegin;
+  ierr = MatGetSize(A,&m,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MatGetColoring(A,MATCOLORINGSL,&iscoloring);CHKERRQ(ierr);
+  for (c=0,k=0; c<iscoloring->n; c++) {
+    for (i=0; i<m; i++) if ((PetscInt)iscoloring->colors[i] == c) perm[i] = k++;
+  }
+  ierr = ISColoringDestroy(&iscoloring);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_SELF,B);CHKERRQ(ierr);
+  ierr = MatSetSizes(*B,m,m,m,m);CHKERRQ(ierr);
+  ierr = MatSetOptionsPrefix(*B,"nat_");CHKERRQ(ierr);
+  ierr = MatSetType(*B,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(*B,7,PETSC_NULL);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    ierr = MatGetRow(A,i,&ncols,&cols,&vals);CHKERRQ(ierr);
+    for (j=0; j<ncols; j++) {
+      ierr = MatSetValue(*B,perm[i],perm[cols[j]],vals[j],INSERT_VALUES);CHKERRQ(ierr);
+    }
+    ierr = MatRestoreRow(A,i,&ncols,&cols,&vals);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(*B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(*B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckSOR"
+/* compares MatSOR() of A, in the multicolor ordering, with MatSOR() of B = P A P^T in the natural ordering */
+static PetscErrorCode CheckSOR(Mat A,Mat B,const PetscInt *perm,Vec b,Vec x0,MatSORType flag,PetscReal omega,PetscInt its,const char *name)
+{
+  PetscErrorCode    ierr;
+  Vec               x,pb,px;
+  PetscInt          m,i;
+  const PetscScalar *xa,*ba,*x0a;
+  PetscScalar       *pba,*pxa;
+  PetscReal         nrm,err;
+
+  PetscFunctionBegin;
+  ierr = VecGetSize(b,&m);CHKERRQ(ierr);
+  ierr = VecDuplicate(b,&x);CHKERRQ(ierr);
+  ierr = VecDuplicate(b,&pb);CHKERRQ(ierr);
+  ierr = VecDuplicate(b,&px);CHKERRQ(ierr);
+  ierr = VecCopy(x0,x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(b,&ba);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(x0,&x0a);CHKERRQ(ierr);
+  ierr = VecGetArray(pb,&pba);CHKERRQ(ierr);
+  ierr = VecGetArray(px,&pxa);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    pba[perm[i]] = ba[i];
+    pxa[perm[i]] = x0a[i];
+  }
+  ierr = VecRestoreArrayRead(b,&ba);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(x0,&x0a);CHKERRQ(ierr);
+  ierr = VecRestoreArray(pb,&pba);CHKERRQ(ierr);
+  ierr = VecRestoreArray(px,&pxa);CHKERRQ(ierr);
+
+  ierr = MatSOR(A,b,omega,flag,0.0,its,1,x);CHKERRQ(ierr);
+  ierr = MatSOR(B,pb,omega,flag,0.0,its,1,px);CHKERRQ(ierr);
+
+  ierr = VecNorm(px,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(x,&xa);CHKERRQ(ierr);
+  ierr = VecGetArray(px,&pxa);CHKERRQ(ierr);
+  err  = 0.0;
+  for (i=0; i<m; i++) err = PetscMax(err,PetscAbsScalar(xa[i]-pxa[perm[i]]));
+  ierr = VecRestoreArrayRead(x,&xa);CHKERRQ(ierr);
+  ierr = VecRestoreArray(px,&pxa);CHKERRQ(ierr);
+  if (err > 1.e-12*nrm) {
+    ierr = PetscPrintf(PETSC_COMM_SELF,"%s: multicolor and permuted natural ordering differ by %G\n",name,err/nrm);CHKERRQ(ierr);
+  } else {
+    ierr = PetscPrintf(PETSC_COMM_SELF,"%s: checked\n",name);CHKERRQ(ierr);
+  }
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&pb);CHKERRQ(ierr);
+  ierr = VecDestroy(&px);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A,B;
+  Vec            b,x0;
+  PetscInt       m = 12,n,i,j,row,*perm,pass;
+  PetscScalar    v;
+  PetscRandom    rand;
+  PetscErrorCode ierr;
+
+  PetscInitialize(&argc,&args,(char *)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);CHKERRQ(ierr);
+  n    = m*m;
+  ierr = PetscOptionsSetValue("-mc_mat_sor_multicolor",PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsSetValue("-nat_mat_no_inode",PETSC_NULL);CHKERRQ(ierr);
+
+  /* a convection-diffusion operator, so that the sweeps depend on the order of the couplings */
+  ierr = MatCreate(PETSC_COMM_SELF,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,n,n,n,n);CHKERRQ(ierr);
+  ierr = MatSetOptionsPrefix(A,"mc_");CHKERRQ(ierr);
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,5,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MatSetOption(A,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_FALSE);CHKERRQ(ierr);
+  for (row=0; row<n; row++) {
+    i = row/m; j = row - i*m;
+    if (i>0)   {ierr = MatSetValue(A,row,row-m,-1.3,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {ierr = MatSetValue(A,row,row+m,-0.7,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {ierr = MatSetValue(A,row,row-1,-1.2,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j<m-1) {ierr = MatSetValue(A,row,row+1,-0.8,INSERT_VALUES);CHKERRQ(ierr);}
+    v    = 4.0 + 0.01*j;
+    ierr = MatSetValue(A,row,row,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = PetscRandomCreate(PETSC_COMM_SELF,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = MatGetVecs(A,&x0,&b);CHKERRQ(ierr);
+  ierr = VecSetRandom(b,rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(x0,rand);CHKERRQ(ierr);
+  ierr = PetscMalloc(n*sizeof(PetscInt),&perm);CHKERRQ(ierr);
+
+  for (pass=0; pass<2; pass++) {
+    if (pass) {
+      /* new couplings change the coloring, which must be computed again */
+      ierr = PetscPrintf(PETSC_COMM_SELF,"With new nonzeros\n");CHKERRQ(ierr);
+      ierr = MatSetValue(A,0,n-1,-0.5,INSERT_VALUES);CHKERRQ(ierr);
+      ierr = MatSetValue(A,n-1,0,-0.5,INSERT_VALUES);CHKERRQ(ierr);
+      ierr = MatSetValue(A,1,m+2,-0.25,INSERT_VALUES);CHKERRQ(ierr);
+      ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+      ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+      ierr = MatDestroy(&B);CHKERRQ(ierr);
+    }
+    ierr = PermuteByColor(A,perm,&B);CHKERRQ(ierr);
+    ierr = CheckSOR(A,B,perm,b,x0,(MatSORType)(SOR_FORWARD_SWEEP | SOR_ZERO_INITIAL_GUESS),1.0,1,"forward, zero initial guess");CHKERRQ(ierr);
+    ierr = CheckSOR(A,B,perm,b,x0,SOR_FORWARD_SWEEP,1.2,2,"forward, omega 1.2, 2 iterations");CHKERRQ(ierr);
+    ierr = CheckSOR(A,B,perm,b,x0,SOR_BACKWARD_SWEEP,0.9,1,"backward, omega 0.9");CHKERRQ(ierr);
+    ierr = CheckSOR(A,B,perm,b,x0,(MatSORType)(SOR_SYMMETRIC_SWEEP | SOR_ZERO_INITIAL_GUESS),1.3,3,"symmetric, zero initial guess, omega 1.3, 3 iterations");CHKERRQ(ierr);
+    ierr = CheckSOR(A,B,perm,b,x0,SOR_LOCAL_SYMMETRIC_SWEEP,1.0,2,"local symmetric, 2 iterations");CHKERRQ(ierr);
+    ierr = CheckSOR(A,B,perm,b,x0,SOR_EISENSTAT,1.1,1,"Eisenstat, omega 1.1");CHKERRQ(ierr);
+    ierr = CheckSOR(A,B,perm,b,x0,SOR_APPLY_UPPER,1.1,1,"apply upper, omega 1.1");CHKERRQ(ierr);
+  }
+
+  ierr = PetscFree(perm);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = VecDestroy(&x0);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
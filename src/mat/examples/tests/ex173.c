@@ -0,0 +1,174 @@
+static char help[] = "Tests the level scheduled triangular solves of LU, ILU, Cholesky and ICC factors, -mat_solve_levels, for SeqAIJ,\n\
+SeqBAIJ and SeqSBAIJ matrices against the default solves.\n\n\
+  -m <m>        number of grid points in each direction\n\n";
+
+/*
+   Run with threads to solve the rows of each level in parallel, for example
+      ./ex173 -threadcomm_type pthread -threadcomm_nthreads 4
+*/
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckSolve"
+/*
+   Factors A and Alev, which has the prefix lev_ and so the level scheduled solves, twice with the same nonzero structure
+   and compares the solutions
+*/
+static PetscErrorCode CheckSolve(Mat A,Mat Alev,MatFactorType ftype,const MatOrderingType otype,PetscReal levels,Vec b,const char *name)
+{
+  PetscErrorCode ierr;
+  Mat            F[2],M[2];
+  Vec            x[2];
+  IS             row,col;
+  MatFactorInfo  info;
+  PetscInt       k,pass;
+  PetscReal      nrm,err;
+
+  PetscFunctionBegin;
+  M[0] = A; M[1] = Alev;
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  info.levels = levels;
+  info.fill   = 3.0;
+  ierr = MatGetOrdering(A,otype,&row,&col);CHKERRQ(ierr);
+  for (k=0; k<2; k++) {
+    ierr = MatGetFactor(M[k],MATSOLVERPETSC,ftype,&F[k]);CHKERRQ(ierr);
+    if (ftype == MAT_FACTOR_LU) {
+      ierr = MatLUFactorSymbolic(F[k],M[k],row,col,&info);CHKERRQ(ierr);
+    } else if (ftype == MAT_FACTOR_ILU) {
+      ierr = MatILUFactorSymbolic(F[k],M[k],row,col,&info);CHKERRQ(ierr);
+    } else if (ftype == MAT_FACTOR_CHOLESKY) {
+      ierr = MatCholeskyFactorSymbolic(F[k],M[k],row,&info);CHKERRQ(ierr);
+    } else {
+      ierr = MatICCFactorSymbolic(F[k],M[k],row,&info);CHKERRQ(ierr);
+    }
+    ierr = VecDuplicate(b,&x[k]);CHKERRQ(ierr);
+  }
+  for (pass=0; pass<2; pass++) {
+    for (k=0; k<2; k++) {
+      if (ftype == MAT_FACTOR_LU || ftype == MAT_FACTOR_ILU) {
+        ierr = MatLUFactorNumeric(F[k],M[k],&info);CHKERRQ(ierr);
+      } else {
+        ierr = MatCholeskyFactorNumeric(F[k],M[k],&info);CHKERRQ(ierr);
+      }
+      ierr = MatSolve(F[k],b,x[k]);CHKERRQ(ierr);
+    }
+    ierr = VecNorm(x[0],NORM_INFINITY,&nrm);CHKERRQ(ierr);
+    ierr = VecAXPY(x[1],-1.0,x[0]);CHKERRQ(ierr);
+    ierr = VecNorm(x[1],NORM_INFINITY,&err);CHKERRQ(ierr);
+    if (err > 1.e-12*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s, factorization %D: level scheduled solve differs by %G\n",name,pass,err/nrm);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscPrintf(PETSC_COMM_SELF,"%s: checked\n",name);CHKERRQ(ierr);
+  for (k=0; k<2; k++) {
+    ierr = MatDestroy(&F[k]);CHKERRQ(ierr);
+    ierr = VecDestroy(&x[k]);CHKERRQ(ierr);
+  }
+  ierr = ISDestroy(&row);CHKERRQ(ierr);
+  ierr = ISDestroy(&col);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "DuplicateWithLevels"
+static PetscErrorCode DuplicateWithLevels(Mat A,Mat *Alev)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatDuplicate(A,MAT_COPY_VALUES,Alev);CHKERRQ(ierr);
+  ierr = MatSetOptionsPrefix(*Alev,"lev_");CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A,Alev,S,Slev,Ssb,Ssblev,B,Blev;
+  Vec            b,bb;
+  PetscInt       m = 12,n,i,j,k,row,bs = 9,cols[5],nc;
+  PetscScalar    v,vals[81*5];
+  PetscReal      r;
+  PetscRandom    rand;
+  PetscErrorCode ierr;
+
+  PetscInitialize(&argc,&args,(char *)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);CHKERRQ(ierr);
+  n    = m*m;
+  ierr = PetscOptionsSetValue("-lev_mat_solve_levels",PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_SELF,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+
+  /* a convection-diffusion operator A and the diffusion operator S */
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,n,n,5,PETSC_NULL,&A);CHKERRQ(ierr);
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,n,n,5,PETSC_NULL,&S);CHKERRQ(ierr);
+  for (row=0; row<n; row++) {
+    i = row/m; j = row - i*m;
+    if (i>0)   {ierr = MatSetValue(A,row,row-m,-1.3,INSERT_VALUES);CHKERRQ(ierr);ierr = MatSetValue(S,row,row-m,-1.0,INSERT_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {ierr = MatSetValue(A,row,row+m,-0.7,INSERT_VALUES);CHKERRQ(ierr);ierr = MatSetValue(S,row,row+m,-1.0,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {ierr = MatSetValue(A,row,row-1,-1.2,INSERT_VALUES);CHKERRQ(ierr);ierr = MatSetValue(S,row,row-1,-1.0,INSERT_VALUES);CHKERRQ(ierr);}
+    if (j<m-1) {ierr = MatSetValue(A,row,row+1,-0.8,INSERT_VALUES);CHKERRQ(ierr);ierr = MatSetValue(S,row,row+1,-1.0,INSERT_VALUES);CHKERRQ(ierr);}
+    v    = 4.0 + 0.01*j;
+    ierr = MatSetValue(A,row,row,v,INSERT_VALUES);CHKERRQ(ierr);
+    ierr = MatSetValue(S,row,row,v,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(S,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(S,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatSetOption(S,MAT_SYMMETRIC,PETSC_TRUE);CHKERRQ(ierr);
+  ierr = MatConvert(S,MATSEQSBAIJ,MAT_INITIAL_MATRIX,&Ssb);CHKERRQ(ierr);
+  ierr = DuplicateWithLevels(A,&Alev);CHKERRQ(ierr);
+  ierr = DuplicateWithLevels(S,&Slev);CHKERRQ(ierr);
+  ierr = DuplicateWithLevels(Ssb,&Ssblev);CHKERRQ(ierr);
+
+  ierr = MatGetVecs(A,PETSC_NULL,&b);CHKERRQ(ierr);
+  ierr = VecSetRandom(b,rand);CHKERRQ(ierr);
+  ierr = CheckSolve(A,Alev,MAT_FACTOR_LU,MATORDERINGNATURAL,0,b,"AIJ LU, natural ordering");CHKERRQ(ierr);
+  ierr = CheckSolve(A,Alev,MAT_FACTOR_LU,MATORDERINGND,0,b,"AIJ LU, nested dissection");CHKERRQ(ierr);
+  ierr = CheckSolve(A,Alev,MAT_FACTOR_ILU,MATORDERINGNATURAL,0,b,"AIJ ILU(0), natural ordering");CHKERRQ(ierr);
+  ierr = CheckSolve(A,Alev,MAT_FACTOR_ILU,MATORDERINGRCM,1,b,"AIJ ILU(1), reverse Cuthill-McKee");CHKERRQ(ierr);
+  ierr = CheckSolve(S,Slev,MAT_FACTOR_CHOLESKY,MATORDERINGRCM,0,b,"AIJ Cholesky, reverse Cuthill-McKee");CHKERRQ(ierr);
+  ierr = CheckSolve(S,Slev,MAT_FACTOR_ICC,MATORDERINGNATURAL,0,b,"AIJ ICC(0), natural ordering");CHKERRQ(ierr);
+  ierr = CheckSolve(Ssb,Ssblev,MAT_FACTOR_ICC,MATORDERINGNATURAL,1,b,"SBAIJ ICC(1), natural ordering");CHKERRQ(ierr);
+
+  /* a block version of A with dense 9x9 blocks, factored by the kernels for a general block size */
+  ierr = MatCreateSeqBAIJ(PETSC_COMM_SELF,bs,bs*n,bs*n,5,PETSC_NULL,&B);CHKERRQ(ierr);
+  for (row=0; row<n; row++) {
+    i = row/m; j = row - i*m; nc = 0;
+    if (i>0)   cols[nc++] = row-m;
+    if (j>0)   cols[nc++] = row-1;
+    cols[nc++] = row;
+    if (j<m-1) cols[nc++] = row+1;
+    if (i<m-1) cols[nc++] = row+m;
+    for (k=0; k<bs*bs*nc; k++) {
+      ierr    = PetscRandomGetValueReal(rand,&r);CHKERRQ(ierr);
+      vals[k] = -0.1*r;
+    }
+    for (k=0; k<bs; k++) vals[k*bs*nc + ((i>0)+(j>0))*bs + k] = 20.0; /* the diagonal of the diagonal block */
+    ierr = MatSetValuesBlocked(B,1,&row,nc,cols,vals,INSERT_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = DuplicateWithLevels(B,&Blev);CHKERRQ(ierr);
+  ierr = MatGetVecs(B,PETSC_NULL,&bb);CHKERRQ(ierr);
+  ierr = VecSetRandom(bb,rand);CHKERRQ(ierr);
+  ierr = CheckSolve(B,Blev,MAT_FACTOR_LU,MATORDERINGNATURAL,0,bb,"BAIJ LU, natural ordering");CHKERRQ(ierr);
+  ierr = CheckSolve(B,Blev,MAT_FACTOR_ILU,MATORDERINGRCM,0,bb,"BAIJ ILU(0), reverse Cuthill-McKee");CHKERRQ(ierr);
+  ierr = CheckSolve(B,Blev,MAT_FACTOR_ILU,MATORDERINGNATURAL,1,bb,"BAIJ ILU(1), natural ordering");CHKERRQ(ierr);
+
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = VecDestroy(&bb);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&Alev);CHKERRQ(ierr);
+  ierr = MatDestroy(&S);CHKERRQ(ierr);
+  ierr = MatDestroy(&Slev);CHKERRQ(ierr);
+  ierr = MatDestroy(&Ssb);CHKERRQ(ierr);
+  ierr = MatDestroy(&Ssblev);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = MatDestroy(&Blev);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,126 @@
+static char help[] = "Tests the threaded LU and ILU(k) factorization of SeqAIJ matrices, MATSOLVERETREE, against MATSOLVERPETSC.\n\n\
+  -m <m>        number of grid points in each direction\n\
+  -dof <dof>    number of coupled unknowns at each grid point\n\n";
+
+/*
+   Run with threads to factor the subtrees of the elimination tree in parallel, for example
+      ./ex174 -threadcomm_type pthread -threadcomm_nthreads 4 -info | grep supernodes
+   -mat_etree_supernode_size bounds the rows of the supernodes factored in dense panels
+*/
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckFactor"
+/* factors A twice with both packages and compares the solutions */
+static PetscErrorCode CheckFactor(Mat A,MatFactorType ftype,const MatOrderingType otype,PetscReal levels,MatFactorShiftType shifttype,Vec b,const char *name)
+{
+  PetscErrorCode   ierr;
+  Mat              F[2];
+  Vec              x[2];
+  IS               row,col;
+  MatFactorInfo    info;
+  PetscInt         k,pass;
+  PetscReal        nrm,err;
+  const MatSolverPackage packages[2] = {MATSOLVERPETSC,MATSOLVERETREE};
+
+  PetscFunctionBegin;
+  ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
+  info.levels      = levels;
+  info.fill        = 5.0;
+  info.shifttype   = (PetscReal)shifttype;
+  info.shiftamount = 1.e-2;
+  ierr = MatGetOrdering(A,otype,&row,&col);CHKERRQ(ierr);
+  for (k=0; k<2; k++) {
+    ierr = MatGetFactor(A,packages[k],ftype,&F[k]);CHKERRQ(ierr);
+    if (ftype == MAT_FACTOR_LU) {
+      ierr = MatLUFactorSymbolic(F[k],A,row,col,&info);CHKERRQ(ierr);
+    } else {
+      ierr = MatILUFactorSymbolic(F[k],A,row,col,&info);CHKERRQ(ierr);
+    }
+    ierr = VecDuplicate(b,&x[k]);CHKERRQ(ierr);
+  }
+  for (pass=0; pass<2; pass++) {
+    for (k=0; k<2; k++) {
+      ierr = MatLUFactorNumeric(F[k],A,&info);CHKERRQ(ierr);
+      ierr = MatSolve(F[k],b,x[k]);CHKERRQ(ierr);
+    }
+    ierr = VecNorm(x[0],NORM_INFINITY,&nrm);CHKERRQ(ierr);
+    ierr = VecAXPY(x[1],-1.0,x[0]);CHKERRQ(ierr);
+    ierr = VecNorm(x[1],NORM_INFINITY,&err);CHKERRQ(ierr);
+    if (err > 1.e-12*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s, factorization %D: solutions differ by %G\n",name,pass,err/nrm);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscPrintf(PETSC_COMM_SELF,"%s: checked\n",name);CHKERRQ(ierr);
+  for (k=0; k<2; k++) {
+    ierr = MatDestroy(&F[k]);CHKERRQ(ierr);
+    ierr = VecDestroy(&x[k]);CHKERRQ(ierr);
+  }
+  ierr = ISDestroy(&row);CHKERRQ(ierr);
+  ierr = ISDestroy(&col);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A;
+  Vec            b;
+  PetscInt       m = 14,dof = 2,n,i,j,c,d,node,row,nbrs[5],nn,k;
+  PetscScalar    v;
+  PetscRandom    rand;
+  PetscErrorCode ierr;
+
+  PetscInitialize(&argc,&args,(char *)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-dof",&dof,PETSC_NULL);CHKERRQ(ierr);
+  n    = m*m*dof;
+
+  /* a convection-diffusion operator with dof coupled unknowns at each grid point, whose rows form supernodes */
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,n,n,5*dof,PETSC_NULL,&A);CHKERRQ(ierr);
+  for (node=0; node<m*m; node++) {
+    i = node/m; j = node - i*m; nn = 0;
+    if (i>0)   nbrs[nn++] = node-m;
+    if (j>0)   nbrs[nn++] = node-1;
+    if (j<m-1) nbrs[nn++] = node+1;
+    if (i<m-1) nbrs[nn++] = node+m;
+    for (c=0; c<dof; c++) {
+      row = node*dof + c;
+      for (k=0; k<nn; k++) {
+        for (d=0; d<dof; d++) {
+          v    = (d == c) ? (nbrs[k] < node ? -1.3 : -0.7) : -0.1;
+          ierr = MatSetValue(A,row,nbrs[k]*dof+d,v,INSERT_VALUES);CHKERRQ(ierr);
+        }
+      }
+      for (d=0; d<dof; d++) {
+        v    = (d == c) ? 4.0 + 0.1*dof + 0.01*j : 0.2*(d-c);
+        ierr = MatSetValue(A,row,node*dof+d,v,INSERT_VALUES);CHKERRQ(ierr);
+      }
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = PetscRandomCreate(PETSC_COMM_SELF,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = MatGetVecs(A,PETSC_NULL,&b);CHKERRQ(ierr);
+  ierr = VecSetRandom(b,rand);CHKERRQ(ierr);
+
+  ierr = CheckFactor(A,MAT_FACTOR_LU,MATORDERINGNATURAL,0,MAT_SHIFT_NONE,b,"LU, natural ordering");CHKERRQ(ierr);
+  ierr = CheckFactor(A,MAT_FACTOR_LU,MATORDERINGND,0,MAT_SHIFT_NONE,b,"LU, nested dissection");CHKERRQ(ierr);
+  ierr = CheckFactor(A,MAT_FACTOR_ILU,MATORDERINGNATURAL,0,MAT_SHIFT_NONE,b,"ILU(0), natural ordering");CHKERRQ(ierr);
+  ierr = CheckFactor(A,MAT_FACTOR_ILU,MATORDERINGRCM,2,MAT_SHIFT_NONE,b,"ILU(2), reverse Cuthill-McKee");CHKERRQ(ierr);
+
+  /* a zero on the diagonal: the factorization is repeated sequentially with the shift */
+  ierr = MatSetValue(A,0,0,0.0,INSERT_VALUES);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = CheckFactor(A,MAT_FACTOR_ILU,MATORDERINGNATURAL,0,MAT_SHIFT_NONZERO,b,"ILU(0) with a zero pivot, nonzero shift");CHKERRQ(ierr);
+
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,168 @@
+static char help[] = "Benchmarks and tests MatPtAP() on the Galerkin hierarchy of a 3D elasticity operator.\n\n\
+  -M <M>        number of grid points in each direction on the coarsest grid\n\
+  -levels <l>   number of grids\n\
+  -benchmark    print the time and the memory of MatPtAP() on each level\n\n";
+
+/*
+   The operator -mu Laplacian(u) - (lambda+mu) grad(div(u)) on the finest grid is projected to the coarser grids with
+   the trilinear interpolation of DMDA, as PCMG does with -pc_mg_galerkin. Each product is checked against
+   P^T*(A*P) and computed a second time with MAT_REUSE_MATRIX after A is scaled. Compare the algorithms with, for example,
+
+      mpiexec -n 8 ./ex175 -M 9 -levels 4 -benchmark -malloc
+      mpiexec -n 8 ./ex175 -M 9 -levels 4 -benchmark -malloc -matptap_allatonce
+
+   The memory of the products is that of PetscMalloc(), tracked with -malloc or in debug builds; the peak is that of the
+   whole run, whose largest allocation is normally the product on the finest level.
+*/
+#include <petscdmda.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FormElasticity"
+static PetscErrorCode FormElasticity(DM da,Mat A)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,j,k,c,d,xs,ys,zs,xm,ym,zm,mx,my,mz,n,s,t,p[3],q[3],lo[3];
+  PetscReal      mu = 1.0,lambda = 1.0;
+  PetscScalar    v[3*19];
+  MatStencil     row,col[3*19];
+
+  PetscFunctionBegin;
+  ierr = DMDAGetInfo(da,0,&mx,&my,&mz,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(da,&xs,&ys,&zs,&xm,&ym,&zm);CHKERRQ(ierr);
+  lo[0] = mx; lo[1] = my; lo[2] = mz;
+  for (k=zs; k<zs+zm; k++) {
+    for (j=ys; j<ys+ym; j++) {
+      for (i=xs; i<xs+xm; i++) {
+        p[0] = i; p[1] = j; p[2] = k;
+        for (c=0; c<3; c++) {
+          row.i = i; row.j = j; row.k = k; row.c = c;
+          n     = 0;
+          /* mu times the 7 point Laplacian and (lambda+mu) times the second derivative in direction c */
+          col[n] = row; v[n++] = 6.0*mu + 2.0*(lambda+mu);
+          for (d=0; d<3; d++) {
+            for (s=-1; s<=1; s+=2) {
+              q[0] = p[0]; q[1] = p[1]; q[2] = p[2]; q[d] += s;
+              if (q[d] < 0 || q[d] >= lo[d]) continue;
+              col[n].i = q[0]; col[n].j = q[1]; col[n].k = q[2]; col[n].c = c;
+              v[n++]   = -mu - (d == c ? (lambda+mu) : 0.0);
+            }
+          }
+          /* (lambda+mu) times the mixed derivatives coupling component c to the other components */
+          for (d=0; d<3; d++) {
+            if (d == c) continue;
+            for (s=-1; s<=1; s+=2) {
+              for (t=-1; t<=1; t+=2) {
+                q[0] = p[0]; q[1] = p[1]; q[2] = p[2]; q[c] += s; q[d] += t;
+                if (q[c] < 0 || q[c] >= lo[c] || q[d] < 0 || q[d] >= lo[d]) continue;
+                col[n].i = q[0]; col[n].j = q[1]; col[n].k = q[2]; col[n].c = d;
+                v[n++]   = -0.25*(lambda+mu)*s*t;
+              }
+            }
+          }
+          ierr = MatSetValuesStencil(A,1,&row,n,col,v,INSERT_VALUES);CHKERRQ(ierr);
+        }
+      }
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckProduct"
+/* compares C with P^T*(A*P) scaled by alpha; P, a MAIJ matrix from DMCreateInterpolation(), is converted to AIJ for the products */
+static PetscErrorCode CheckProduct(Mat A,Mat P,Mat C,PetscScalar alpha,const char *name,PetscInt level)
+{
+  PetscErrorCode ierr;
+  Mat            Paij,AP,R;
+  PetscReal      nrm,err;
+
+  PetscFunctionBegin;
+  ierr = MatConvert(P,MATAIJ,MAT_INITIAL_MATRIX,&Paij);CHKERRQ(ierr);
+  ierr = MatMatMult(A,Paij,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&AP);CHKERRQ(ierr);
+  ierr = MatTransposeMatMult(Paij,AP,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&R);CHKERRQ(ierr);
+  ierr = MatScale(R,alpha);CHKERRQ(ierr);
+  ierr = MatNorm(R,NORM_FROBENIUS,&nrm);CHKERRQ(ierr);
+  ierr = MatAXPY(R,-1.0,C,DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatNorm(R,NORM_FROBENIUS,&err);CHKERRQ(ierr);
+  if (err > 1.e-12*nrm) {
+    ierr = PetscPrintf(((PetscObject)A)->comm,"Level %D, %s: MatPtAP() differs from P^T*(A*P) by %G\n",level,name,err/nrm);CHKERRQ(ierr);
+  }
+  ierr = MatDestroy(&Paij);CHKERRQ(ierr);
+  ierr = MatDestroy(&AP);CHKERRQ(ierr);
+  ierr = MatDestroy(&R);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  PetscErrorCode ierr;
+  PetscInt       M = 3,nlevels = 3,l,N;
+  PetscBool      benchmark = PETSC_FALSE;
+  DM             *da;
+  Mat            *A,P;
+  PetscLogDouble t0,t1,t2,t3,mem0,mem1,tmax[2],tloc[2],memmax,peak;
+  MPI_Comm       comm;
+
+  PetscInitialize(&argc,&args,(char *)0,help);
+  comm = PETSC_COMM_WORLD;
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-M",&M,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-levels",&nlevels,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-benchmark",&benchmark,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nlevels,DM,&da,nlevels,Mat,&A);CHKERRQ(ierr);
+
+  ierr = DMDACreate3d(comm,DMDA_BOUNDARY_NONE,DMDA_BOUNDARY_NONE,DMDA_BOUNDARY_NONE,DMDA_STENCIL_BOX,M,M,M,PETSC_DECIDE,PETSC_DECIDE,PETSC_DECIDE,3,1,0,0,0,&da[0]);CHKERRQ(ierr);
+  for (l=1; l<nlevels; l++) {
+    ierr = DMRefine(da[l-1],comm,&da[l]);CHKERRQ(ierr);
+  }
+  ierr = DMCreateMatrix(da[nlevels-1],MATAIJ,&A[nlevels-1]);CHKERRQ(ierr);
+  ierr = FormElasticity(da[nlevels-1],A[nlevels-1]);CHKERRQ(ierr);
+
+  for (l=nlevels-1; l>0; l--) {
+    ierr = DMCreateInterpolation(da[l-1],da[l],&P,PETSC_NULL);CHKERRQ(ierr);
+
+    ierr = PetscMallocGetCurrentUsage(&mem0);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+    ierr = MatPtAP(A[l],P,MAT_INITIAL_MATRIX,2.0,&A[l-1]);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+    ierr = PetscMallocGetCurrentUsage(&mem1);CHKERRQ(ierr);
+    ierr = CheckProduct(A[l],P,A[l-1],1.0,"initial product",l-1);CHKERRQ(ierr);
+
+    /* the numeric product alone, with the same nonzero structure */
+    ierr = MatScale(A[l],2.0);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t2);CHKERRQ(ierr);
+    ierr = MatPtAP(A[l],P,MAT_REUSE_MATRIX,2.0,&A[l-1]);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t3);CHKERRQ(ierr);
+    ierr = MatScale(A[l],0.5);CHKERRQ(ierr);
+    ierr = CheckProduct(A[l],P,A[l-1],2.0,"reused product",l-1);CHKERRQ(ierr);
+    ierr = MatScale(A[l-1],0.5);CHKERRQ(ierr);
+
+    ierr = MatGetSize(A[l-1],&N,PETSC_NULL);CHKERRQ(ierr);
+    ierr = PetscPrintf(comm,"Level %D: %D rows, checked\n",l-1,N);CHKERRQ(ierr);
+    if (benchmark) {
+      tloc[0] = t1 - t0;
+      tloc[1] = t3 - t2;
+      ierr    = MPI_Allreduce(tloc,tmax,2,MPI_DOUBLE,MPI_MAX,comm);CHKERRQ(ierr);
+      tloc[0] = mem1 - mem0;
+      ierr    = MPI_Allreduce(tloc,&memmax,1,MPI_DOUBLE,MPI_MAX,comm);CHKERRQ(ierr);
+      ierr    = PetscPrintf(comm,"  MatPtAP() %G s, numeric only %G s; memory held by the product %G MB on the largest process\n",tmax[0],tmax[1],memmax/1048576.0);CHKERRQ(ierr);
+    }
+    ierr = MatDestroy(&P);CHKERRQ(ierr);
+  }
+  if (benchmark) {
+    ierr = PetscMallocGetMaximumUsage(&peak);CHKERRQ(ierr);
+    ierr = MPI_Allreduce(&peak,&memmax,1,MPI_DOUBLE,MPI_MAX,comm);CHKERRQ(ierr);
+    ierr = PetscPrintf(comm,"Peak memory %G MB on the largest process\n",memmax/1048576.0);CHKERRQ(ierr);
+  }
+
+  for (l=0; l<nlevels; l++) {
+    ierr = MatDestroy(&A[l]);CHKERRQ(ierr);
+    ierr = DMDestroy(&da[l]);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(da,A);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,117 @@
+static char help[] = "Tests the threaded Gustavson products MatMatMult() and MatMatTransposeMult() of SeqAIJ matrices.\n\n\
+  -m <m>        number of grid points in each direction\n\
+  -stride <s>   every s-th grid point is kept by the restriction\n\n";
+
+/*
+   The products of the default threaded algorithm are compared with those of MatMatMultSymbolic() and MatMatMultNumeric(),
+   which use the sequential condensed linked list, for a product with dense accumulators (A*A) and for one whose
+   estimated fill selects hash tables on several threads (R*A); -matmatmult_hash forces the hash tables for both.
+   Run with -info to see the choice, for example
+      ./ex176 -threadcomm_type pthread -threadcomm_nthreads 4 -info | grep accumulators
+*/
+#include <petscmat.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckProduct"
+/* compares C with the product formed by the sequential algorithm, once as computed and once after scaling A by 2 */
+static PetscErrorCode CheckProduct(Mat A,Mat B,PetscBool transpose,const char *name)
+{
+  PetscErrorCode ierr;
+  Mat            C,D,Bt = PETSC_NULL,P = B;
+  PetscInt       pass;
+  PetscReal      nrm,err;
+  MatInfo        cinfo,dinfo;
+
+  PetscFunctionBegin;
+  if (transpose) {
+    ierr = MatMatTransposeMult(A,P,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+    ierr = MatTranspose(P,MAT_INITIAL_MATRIX,&Bt);CHKERRQ(ierr);
+    B    = Bt;
+  } else {
+    ierr = MatMatMult(A,B,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+  }
+  for (pass=0; pass<2; pass++) {
+    if (pass) {
+      ierr = MatScale(A,2.0);CHKERRQ(ierr);
+      if (transpose) {
+        ierr = MatMatTransposeMult(A,P,MAT_REUSE_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+        ierr = MatTranspose(P,MAT_REUSE_MATRIX,&Bt);CHKERRQ(ierr);
+      } else {
+        ierr = MatMatMult(A,B,MAT_REUSE_MATRIX,PETSC_DEFAULT,&C);CHKERRQ(ierr);
+      }
+    }
+    ierr = MatMatMultSymbolic(A,B,PETSC_DEFAULT,&D);CHKERRQ(ierr);
+    ierr = MatMatMultNumeric(A,B,D);CHKERRQ(ierr);
+    ierr = MatGetInfo(C,MAT_LOCAL,&cinfo);CHKERRQ(ierr);
+    ierr = MatGetInfo(D,MAT_LOCAL,&dinfo);CHKERRQ(ierr);
+    if (cinfo.nz_used != dinfo.nz_used) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s: %D nonzeros instead of %D\n",name,(PetscInt)cinfo.nz_used,(PetscInt)dinfo.nz_used);CHKERRQ(ierr);
+    }
+    ierr = MatNorm(D,NORM_FROBENIUS,&nrm);CHKERRQ(ierr);
+    ierr = MatAXPY(D,-1.0,C,DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = MatNorm(D,NORM_FROBENIUS,&err);CHKERRQ(ierr);
+    if (err > 1.e-12*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_SELF,"%s, pass %D: products differ by %G\n",name,pass,err/nrm);CHKERRQ(ierr);
+    }
+    ierr = MatDestroy(&D);CHKERRQ(ierr);
+  }
+  ierr = MatScale(A,0.5);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"%s: checked\n",name);CHKERRQ(ierr);
+  ierr = MatDestroy(&Bt);CHKERRQ(ierr);
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  Mat            A,R;
+  PetscInt       m = 30,stride = 16,n,nc,i,j,k,row,col,di,dj;
+  PetscScalar    v;
+  PetscErrorCode ierr;
+
+  PetscInitialize(&argc,&args,(char *)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-m",&m,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-stride",&stride,PETSC_NULL);CHKERRQ(ierr);
+  n    = m*m;
+  nc   = (n + stride - 1)/stride;
+
+  /* a nonsymmetric 9 point operator */
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,n,n,9,PETSC_NULL,&A);CHKERRQ(ierr);
+  for (row=0; row<n; row++) {
+    i = row/m; j = row - i*m;
+    for (di=-1; di<=1; di++) {
+      for (dj=-1; dj<=1; dj++) {
+        if (i+di < 0 || i+di >= m || j+dj < 0 || j+dj >= m) continue;
+        col  = row + di*m + dj;
+        v    = (col == row) ? 8.0 : -1.0 + 0.1*di - 0.05*dj;
+        ierr = MatSetValues(A,1,&row,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);
+      }
+    }
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  /* a restriction to every stride-th grid point, averaging it with the next points */
+  ierr = MatCreateSeqAIJ(PETSC_COMM_SELF,nc,n,3,PETSC_NULL,&R);CHKERRQ(ierr);
+  for (row=0; row<nc; row++) {
+    for (k=0; k<3 && row*stride+k<n; k++) {
+      col  = row*stride + k;
+      v    = 1.0/(1.0 + k);
+      ierr = MatSetValues(R,1,&row,1,&col,&v,INSERT_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(R,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(R,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = CheckProduct(A,A,PETSC_FALSE,"A*A");CHKERRQ(ierr);
+  ierr = CheckProduct(R,A,PETSC_FALSE,"R*A");CHKERRQ(ierr);
+  ierr = CheckProduct(A,A,PETSC_TRUE,"A*A^T");CHKERRQ(ierr);
+  ierr = CheckProduct(A,R,PETSC_TRUE,"A*R^T");CHKERRQ(ierr);
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&R);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
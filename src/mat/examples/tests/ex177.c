@@ -0,0 +1,132 @@
+static char help[] = "Tests MatFDColoringApply() with a function evaluating several perturbed vectors at once.\n\n\
+  -M <M>        number of grid points in each direction\n\n";
+
+/*
+   The Jacobian of a nonlinear function of 3 coupled fields on a 2D grid with the box stencil is computed by finite
+   differences with MatFDColoringSetFunction() and with MatFDColoringSetFunctionMulti(), which receives the perturbed
+   vectors of -mat_fd_coloring_batch colors together. The reference Jacobian is inserted with MatSetValues()
+   (-mat_fd_coloring_set_values), the other one directly into the values of the matrix. The second Jacobian at another
+   point reuses the locations of the entries computed by the first; see them with -info | grep locations
+*/
+#include <petscdmda.h>
+
+typedef struct {
+  DM       da;
+  PetscInt nmulti;   /* number of calls of FormFunctionMulti() */
+} AppCtx;
+
+#undef __FUNCT__
+#define __FUNCT__ "FormFunction"
+static PetscErrorCode FormFunction(void *sctx,Vec X,Vec F,void *ptr)
+{
+  AppCtx         *user = (AppCtx*)ptr;
+  PetscErrorCode ierr;
+  Vec            Xl;
+  PetscScalar    ***x,***f;
+  PetscInt       i,j,c,d,di,dj,xs,ys,xm,ym,mx,my;
+
+  PetscFunctionBegin;
+  ierr = DMDAGetInfo(user->da,0,&mx,&my,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(user->da,&xs,&ys,0,&xm,&ym,0);CHKERRQ(ierr);
+  ierr = DMGetLocalVector(user->da,&Xl);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalBegin(user->da,X,INSERT_VALUES,Xl);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(user->da,X,INSERT_VALUES,Xl);CHKERRQ(ierr);
+  ierr = DMDAVecGetArrayDOF(user->da,Xl,&x);CHKERRQ(ierr);
+  ierr = DMDAVecGetArrayDOF(user->da,F,&f);CHKERRQ(ierr);
+  for (j=ys; j<ys+ym; j++) {
+    for (i=xs; i<xs+xm; i++) {
+      for (c=0; c<3; c++) {
+        f[j][i][c] = x[j][i][c]*x[j][i][c]*x[j][i][c];
+        for (dj=-1; dj<=1; dj++) {
+          for (di=-1; di<=1; di++) {
+            if (i+di < 0 || i+di >= mx || j+dj < 0 || j+dj >= my) continue;
+            for (d=0; d<3; d++) {
+              f[j][i][c] += (1.0 + 0.1*c - 0.2*d + 0.3*di - 0.05*dj)*x[j+dj][i+di][d]*x[j+dj][i+di][d];
+            }
+          }
+        }
+      }
+    }
+  }
+  ierr = DMDAVecRestoreArrayDOF(user->da,Xl,&x);CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArrayDOF(user->da,F,&f);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(user->da,&Xl);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "FormFunctionMulti"
+static PetscErrorCode FormFunctionMulti(void *sctx,PetscInt n,Vec X[],Vec F[],void *ptr)
+{
+  AppCtx         *user = (AppCtx*)ptr;
+  PetscErrorCode ierr;
+  PetscInt       k;
+
+  PetscFunctionBegin;
+  user->nmulti++;
+  for (k=0; k<n; k++) {
+    ierr = FormFunction(sctx,X[k],F[k],ptr);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  PetscErrorCode ierr;
+  AppCtx         user;
+  PetscInt       M = 9,pass;
+  ISColoring     iscoloring;
+  MatFDColoring  fd[2];
+  Mat            J[2];
+  Vec            x;
+  MatStructure   flag;
+  PetscRandom    rand;
+  PetscReal      nrm,err;
+
+  PetscInitialize(&argc,&args,(char *)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-M",&M,PETSC_NULL);CHKERRQ(ierr);
+  ierr = DMDACreate2d(PETSC_COMM_WORLD,DMDA_BOUNDARY_NONE,DMDA_BOUNDARY_NONE,DMDA_STENCIL_BOX,M,M,PETSC_DECIDE,PETSC_DECIDE,3,1,0,0,&user.da);CHKERRQ(ierr);
+  user.nmulti = 0;
+
+  ierr = DMCreateColoring(user.da,IS_COLORING_GLOBAL,MATAIJ,&iscoloring);CHKERRQ(ierr);
+  ierr = DMCreateMatrix(user.da,MATAIJ,&J[0]);CHKERRQ(ierr);
+  ierr = DMCreateMatrix(user.da,MATAIJ,&J[1]);CHKERRQ(ierr);
+  ierr = MatFDColoringCreate(J[0],iscoloring,&fd[0]);CHKERRQ(ierr);
+  ierr = MatFDColoringSetFunction(fd[0],(PetscErrorCode (*)(void))FormFunction,&user);CHKERRQ(ierr);
+  ierr = PetscOptionsSetValue("-mat_fd_coloring_set_values",PETSC_NULL);CHKERRQ(ierr);
+  ierr = MatFDColoringSetFromOptions(fd[0]);CHKERRQ(ierr);
+  ierr = PetscOptionsClearValue("-mat_fd_coloring_set_values");CHKERRQ(ierr);
+  ierr = MatFDColoringCreate(J[1],iscoloring,&fd[1]);CHKERRQ(ierr);
+  ierr = MatFDColoringSetFunctionMulti(fd[1],FormFunctionMulti,&user);CHKERRQ(ierr);
+  ierr = MatFDColoringSetFromOptions(fd[1]);CHKERRQ(ierr);
+  ierr = ISColoringDestroy(&iscoloring);CHKERRQ(ierr);
+
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(user.da,&x);CHKERRQ(ierr);
+  for (pass=0; pass<2; pass++) {
+    ierr = VecSetRandom(x,rand);CHKERRQ(ierr);
+    ierr = MatFDColoringApply(J[0],fd[0],x,&flag,PETSC_NULL);CHKERRQ(ierr);
+    ierr = MatFDColoringApply(J[1],fd[1],x,&flag,PETSC_NULL);CHKERRQ(ierr);
+    ierr = MatNorm(J[0],NORM_FROBENIUS,&nrm);CHKERRQ(ierr);
+    ierr = MatAXPY(J[1],-1.0,J[0],SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = MatNorm(J[1],NORM_FROBENIUS,&err);CHKERRQ(ierr);
+    if (err > 1.e-12*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"Jacobian %D: direct insertion of batched evaluations and MatSetValues() of single evaluations differ by %G\n",pass,err/nrm);CHKERRQ(ierr);
+    }
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Jacobian %D: checked, %D calls of the multi-vector function\n",pass,user.nmulti);CHKERRQ(ierr);
+    user.nmulti = 0;
+  }
+
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = MatFDColoringDestroy(&fd[0]);CHKERRQ(ierr);
+  ierr = MatFDColoringDestroy(&fd[1]);CHKERRQ(ierr);
+  ierr = MatDestroy(&J[0]);CHKERRQ(ierr);
+  ierr = MatDestroy(&J[1]);CHKERRQ(ierr);
+  ierr = DMDestroy(&user.da);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -3,6 +3,7 @@
 #define __MPIAIJ_H
 
 #include <../src/mat/impls/aij/seq/aij.h>
+#include <petscbt.h>
 
 typedef struct { /* used by MatCreateMPIAIJSumSeqAIJ for reusing the merged matrix */
   PetscLayout    rowmap;
@@ -27,6 +28,13 @@ typedef struct { /* used by MatPtAP_MPIAIJ_MPIAIJ() and MatMatMult_MPIAIJ_MPIAIJ
   Mat            Pt;           /* used by MatTransposeMatMult(), Pt = P^T */
   PetscBool      scalable;     /* flag determines scalable or non-scalable implementation */
 
+  /* used by the all-at-once MatPtAP() (-matptap_allatonce), which never forms A*P */
+  PetscInt       nac,*acols;        /* the global columns of P_loc and P_oth, sorted; the work arrays are indexed by position in acols */
+  PetscInt       *pjc_loc,*pjc_oth; /* the column indices of P_loc and P_oth as positions in acols */
+  PetscInt       *aprow,*apg;       /* the columns of a row of A*P, as positions in acols and as global indices */
+  PetscScalar    *apv,*apw;         /* the values of a row of A*P and their multiples */
+  PetscBT        apbt;              /* the columns of acols present in the current row of A*P */
+
   Mat_Merge_SeqsToMPI *merge;
   PetscErrorCode (*destroy)(Mat);
   PetscErrorCode (*duplicate)(Mat,MatDuplicateOption,Mat*);
@@ -350,8 +350,9 @@ PetscErrorCode MatMatMult_MPIAIJ_MPIDense(Mat A,Mat B,MatReuse scall,PetscReal f
 
 typedef struct {
   Mat         workB;
-  PetscScalar *rvalues,*svalues;
-  MPI_Request *rwaits,*swaits;
+  PetscInt    ncols;
+  Vec         *bvecs;   /* the local columns of B, their arrays are placed for each product */
+  Vec         *wvecs;   /* the columns of workB */
 } MPIAIJ_MPIDense;
 
 #undef __FUNCT__
@@ -360,10 +361,15 @@ PetscErrorCode MatMPIAIJ_MPIDenseDestroy(void *ctx)
 {
   MPIAIJ_MPIDense *contents = (MPIAIJ_MPIDense*) ctx;
   PetscErrorCode  ierr;
+  PetscInt        j;
 
   PetscFunctionBegin;
   ierr = MatDestroy(&contents->workB);CHKERRQ(ierr);
-  ierr = PetscFree4(contents->rvalues,contents->svalues,contents->rwaits,contents->swaits);CHKERRQ(ierr);
+  for (j=0; j<contents->ncols; j++) {
+    ierr = VecDestroy(&contents->bvecs[j]);CHKERRQ(ierr);
+    ierr = VecDestroy(&contents->wvecs[j]);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(contents->bvecs,contents->wvecs);CHKERRQ(ierr);
   ierr = PetscFree(contents);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -377,10 +383,8 @@ PetscErrorCode MatMatMultSymbolic_MPIAIJ_MPIDense(Mat A,Mat B,PetscReal fill,Mat
   PetscInt               nz = aij->B->cmap->n;
   PetscContainer         container;
   MPIAIJ_MPIDense        *contents;
-  VecScatter             ctx = aij->Mvctx;
-  VecScatter_MPI_General *from = (VecScatter_MPI_General*) ctx->fromdata;
-  VecScatter_MPI_General *to   = ( VecScatter_MPI_General*) ctx->todata;
-  PetscInt               m=A->rmap->n,n=B->cmap->n;
+  PetscInt               m=A->rmap->n,n=B->cmap->n,j;
+  PetscScalar            *w;
 
   PetscFunctionBegin;
   ierr = MatCreate(((PetscObject)B)->comm,C);CHKERRQ(ierr);
@@ -395,11 +399,15 @@ PetscErrorCode MatMatMultSymbolic_MPIAIJ_MPIDense(Mat A,Mat B,PetscReal fill,Mat
   ierr = PetscNew(MPIAIJ_MPIDense,&contents);CHKERRQ(ierr);
   /* Create work matrix used to store off processor rows of B needed for local product */
   ierr = MatCreateSeqDense(PETSC_COMM_SELF,nz,B->cmap->N,PETSC_NULL,&contents->workB);CHKERRQ(ierr);
-  /* Create work arrays needed */
-  ierr = PetscMalloc4(B->cmap->N*from->starts[from->n],PetscScalar,&contents->rvalues,
-                      B->cmap->N*to->starts[to->n],PetscScalar,&contents->svalues,
-                      from->n,MPI_Request,&contents->rwaits,
-                      to->n,MPI_Request,&contents->swaits);CHKERRQ(ierr);
+  /* Create the column vectors the rows of B are scattered with, all the columns together */
+  contents->ncols = B->cmap->N;
+  ierr = PetscMalloc2(contents->ncols,Vec,&contents->bvecs,contents->ncols,Vec,&contents->wvecs);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(contents->workB,&w);CHKERRQ(ierr);
+  for (j=0; j<contents->ncols; j++) {
+    ierr = VecCreateMPIWithArray(((PetscObject)B)->comm,1,B->rmap->n,B->rmap->N,PETSC_NULL,&contents->bvecs[j]);CHKERRQ(ierr);
+    ierr = VecCreateSeqWithArray(PETSC_COMM_SELF,1,nz,w + nz*j,&contents->wvecs[j]);CHKERRQ(ierr);
+  }
+  ierr = MatDenseRestoreArray(contents->workB,&w);CHKERRQ(ierr);
 
   ierr = PetscContainerCreate(((PetscObject)A)->comm,&container);CHKERRQ(ierr);
   ierr = PetscContainerSetPointer(container,contents);CHKERRQ(ierr);
@@ -412,24 +420,16 @@ PetscErrorCode MatMatMultSymbolic_MPIAIJ_MPIDense(Mat A,Mat B,PetscReal fill,Mat
 #undef __FUNCT__
 #define __FUNCT__ "MatMPIDenseScatter"
 /*
-    Performs an efficient scatter on the rows of B needed by this process; this is
-    a modification of the VecScatterBegin_() routines.
+    Scatters the rows of B needed by this process into workB, all the columns of B in one message to each process
 */
 PetscErrorCode MatMPIDenseScatter(Mat A,Mat B,Mat C,Mat *outworkB)
 {
   Mat_MPIAIJ             *aij = (Mat_MPIAIJ*)A->data;
+  Mat_MPIDense           *bdense = (Mat_MPIDense*)B->data;
   PetscErrorCode         ierr;
-  PetscScalar            *b,*w,*svalues,*rvalues;
-  VecScatter             ctx = aij->Mvctx;
-  VecScatter_MPI_General *from = (VecScatter_MPI_General*) ctx->fromdata;
-  VecScatter_MPI_General *to   = ( VecScatter_MPI_General*) ctx->todata;
-  PetscInt               i,j,k;
-  PetscInt               *sindices,*sstarts,*rindices,*rstarts;
-  PetscMPIInt            *sprocs,*rprocs,nrecvs;
-  MPI_Request            *swaits,*rwaits;
+  PetscScalar            *b;
+  PetscInt               j,lda = ((Mat_SeqDense*)bdense->A->data)->lda,nrows = aij->B->cmap->n;
   MPI_Comm               comm = ((PetscObject)A)->comm;
-  PetscMPIInt            tag = ((PetscObject)ctx)->tag,ncols = B->cmap->N, nrows = aij->B->cmap->n,imdex,nrowsB = B->rmap->n;
-  MPI_Status             status;
   MPIAIJ_MPIDense        *contents;
   PetscContainer         container;
   Mat                    workB;
@@ -440,55 +440,18 @@ PetscErrorCode MatMPIDenseScatter(Mat A,Mat B,Mat C,Mat *outworkB)
   ierr = PetscContainerGetPointer(container,(void**)&contents);CHKERRQ(ierr);
 
   workB = *outworkB = contents->workB;
-  if (nrows != workB->rmap->n) SETERRQ2(comm,PETSC_ERR_PLIB,"Number of rows of workB %D not equal to columns of aij->B %D",nrows,workB->cmap->n);
-  sindices  = to->indices;
-  sstarts   = to->starts;
-  sprocs    = to->procs;
-  swaits    = contents->swaits;
-  svalues   = contents->svalues;
-
-  rindices  = from->indices;
-  rstarts   = from->starts;
-  rprocs    = from->procs;
-  rwaits    = contents->rwaits;
-  rvalues   = contents->rvalues;
+  if (nrows != workB->rmap->n) SETERRQ2(comm,PETSC_ERR_PLIB,"Number of rows of workB %D not equal to columns of aij->B %D",workB->rmap->n,nrows);
 
   ierr = MatDenseGetArray(B,&b);CHKERRQ(ierr);
-  ierr = MatDenseGetArray(workB,&w);CHKERRQ(ierr);
-
-  for (i=0; i<from->n; i++) {
-    ierr = MPI_Irecv(rvalues+ncols*rstarts[i],ncols*(rstarts[i+1]-rstarts[i]),MPIU_SCALAR,rprocs[i],tag,comm,rwaits+i);CHKERRQ(ierr);
+  for (j=0; j<contents->ncols; j++) {
+    ierr = VecPlaceArray(contents->bvecs[j],b + lda*j);CHKERRQ(ierr);
   }
-
-  for (i=0; i<to->n; i++) {
-    /* pack a message at a time */
-    CHKMEMQ;
-    for (j=0; j<sstarts[i+1]-sstarts[i]; j++){
-      for (k=0; k<ncols; k++) {
-        svalues[ncols*(sstarts[i] + j) + k] = b[sindices[sstarts[i]+j] + nrowsB*k];
-      }
-    }
-    CHKMEMQ;
-    ierr = MPI_Isend(svalues+ncols*sstarts[i],ncols*(sstarts[i+1]-sstarts[i]),MPIU_SCALAR,sprocs[i],tag,comm,swaits+i);CHKERRQ(ierr);
+  ierr = VecScatterBeginMulti(aij->Mvctx,contents->ncols,contents->bvecs,contents->wvecs,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = VecScatterEndMulti(aij->Mvctx,contents->ncols,contents->bvecs,contents->wvecs,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  for (j=0; j<contents->ncols; j++) {
+    ierr = VecResetArray(contents->bvecs[j]);CHKERRQ(ierr);
   }
-
-  nrecvs = from->n;
-  while (nrecvs) {
-    ierr = MPI_Waitany(from->n,rwaits,&imdex,&status);CHKERRQ(ierr);
-    nrecvs--;
-    /* unpack a message at a time */
-    CHKMEMQ;
-    for (j=0; j<rstarts[imdex+1]-rstarts[imdex]; j++){
-      for (k=0; k<ncols; k++) {
-        w[rindices[rstarts[imdex]+j] + nrows*k] = rvalues[ncols*(rstarts[imdex] + j) + k];
-      }
-    }
-    CHKMEMQ;
-  }
-  if (to->n) {ierr = MPI_Waitall(to->n,swaits,to->sstatus);CHKERRQ(ierr);}
-
   ierr = MatDenseRestoreArray(B,&b);CHKERRQ(ierr);
-  ierr = MatDenseRestoreArray(workB,&w);CHKERRQ(ierr);
   ierr = MatAssemblyBegin(workB,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   ierr = MatAssemblyEnd(workB,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   PetscFunctionReturn(0);
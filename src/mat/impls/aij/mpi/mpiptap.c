@@ -12,6 +12,7 @@
 /* #define PTAP_PROFILE */
 
 extern PetscErrorCode MatDestroy_MPIAIJ(Mat);
+static PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_AllAtOnce(Mat,Mat,PetscReal,Mat*);
 #undef __FUNCT__
 #define __FUNCT__ "MatDestroy_MPIAIJ_PtAP"
 PetscErrorCode MatDestroy_MPIAIJ_PtAP(Mat A)
@@ -31,6 +32,11 @@ PetscErrorCode MatDestroy_MPIAIJ_PtAP(Mat A)
     if (ptap->api){ierr = PetscFree(ptap->api);CHKERRQ(ierr);}
     if (ptap->apj){ierr = PetscFree(ptap->apj);CHKERRQ(ierr);}
     if (ptap->apa){ierr = PetscFree(ptap->apa);CHKERRQ(ierr);}
+    ierr = PetscFree(ptap->acols);CHKERRQ(ierr);
+    ierr = PetscFree(ptap->pjc_loc);CHKERRQ(ierr);
+    ierr = PetscFree(ptap->pjc_oth);CHKERRQ(ierr);
+    if (ptap->aprow) {ierr = PetscFree4(ptap->aprow,ptap->apg,ptap->apv,ptap->apw);CHKERRQ(ierr);}
+    if (ptap->apbt) {ierr = PetscBTDestroy(&ptap->apbt);CHKERRQ(ierr);}
     if (merge) {
       ierr = PetscFree(merge->id_r);CHKERRQ(ierr);
       ierr = PetscFree(merge->len_s);CHKERRQ(ierr);
@@ -79,7 +85,7 @@ PetscErrorCode MatPtAP_MPIAIJ_MPIAIJ(Mat A,Mat P,MatReuse scall,PetscReal fill,M
   if (scall == MAT_INITIAL_MATRIX){
     ierr = MatPtAPSymbolic_MPIAIJ_MPIAIJ(A,P,fill,C);CHKERRQ(ierr);
   }
-  ierr = MatPtAPNumeric_MPIAIJ_MPIAIJ(A,P,*C);CHKERRQ(ierr);
+  ierr = (*(*C)->ops->ptapnumeric)(A,P,*C);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -111,6 +117,7 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat A,Mat P,PetscReal fill,Mat *C)
   PetscInt             *api,*apj,*Jptr,apnz,*prmap=p->garray,pon,nspacedouble=0,j,ap_rmax=0;
   PetscReal            afill=1.0,afill_tmp;
   PetscInt             rmax;
+  PetscBool            allatonce=PETSC_FALSE;
 #if defined(PTAP_PROFILE)
   PetscLogDouble       t0,t1,t2,t3,t4;
 #endif
@@ -128,6 +135,12 @@ PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ(Mat A,Mat P,PetscReal fill,Mat *C)
     SETERRQ4(comm,PETSC_ERR_ARG_SIZ,"Matrix local dimensions are incompatible, Acol (%D, %D) != Prow (%D,%D)",A->cmap->rstart,A->cmap->rend,P->rmap->rstart,P->rmap->rend);
   }
 
+  ierr = PetscOptionsGetBool(((PetscObject)A)->prefix,"-matptap_allatonce",&allatonce,PETSC_NULL);CHKERRQ(ierr);
+  if (allatonce) {
+    ierr = MatPtAPSymbolic_MPIAIJ_MPIAIJ_AllAtOnce(A,P,fill,C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
   ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
   ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
 
@@ -820,3 +833,457 @@ PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ(Mat A,Mat P,Mat C)
 #endif
   PetscFunctionReturn(0);
 }
+
+/*
+   All-at-once C = P^T*A*P (-matptap_allatonce): the rows of A*P are computed one at a time in the work arrays of
+   Mat_PtAPMPI and added at once to the rows of C they contribute to, so A*P is never stored. The work arrays have one
+   entry per column of P used by this process (ptap->acols) rather than per column of P. The rows of C owned by other
+   processes, Co = (p->B)^T*A*P, are summed in a buffer whose structure and messages are computed by the symbolic
+   product and reused by every numeric product.
+*/
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPAllAtOnceAddRow_Private"
+/*
+   Adds row i of A*P = Ad*P_loc + Ao*P_oth to the work arrays: the columns not yet in the row are appended to
+   ptap->aprow[*n] as positions in ptap->acols and, when numeric, the values are added to ptap->apa
+*/
+static PetscErrorCode MatPtAPAllAtOnceAddRow_Private(Mat_SeqAIJ *ad,Mat_SeqAIJ *ao,Mat_SeqAIJ *p_loc,Mat_SeqAIJ *p_oth,Mat_PtAPMPI *ptap,PetscInt i,PetscBool numeric,PetscInt *n)
+{
+  PetscErrorCode ierr;
+  PetscInt       j,k,row,pnz,*pj,*aprow=ptap->aprow,cnt=*n;
+  PetscBT        bt=ptap->apbt;
+  MatScalar      *pa,*apa=ptap->apa,valtmp;
+  PetscLogDouble flops=0.0;
+
+  PetscFunctionBegin;
+  /* diagonal portion of A */
+  for (j=ad->i[i]; j<ad->i[i+1]; j++) {
+    row = ad->j[j];
+    pnz = p_loc->i[row+1] - p_loc->i[row];
+    pj  = ptap->pjc_loc + p_loc->i[row];
+    for (k=0; k<pnz; k++) {
+      if (!PetscBTLookupSet(bt,pj[k])) aprow[cnt++] = pj[k];
+    }
+    if (numeric) {
+      pa     = p_loc->a + p_loc->i[row];
+      valtmp = ad->a[j];
+      for (k=0; k<pnz; k++) apa[pj[k]] += valtmp*pa[k];
+      flops += 2.0*pnz;
+    }
+  }
+  /* off-diagonal portion of A */
+  for (j=ao->i[i]; j<ao->i[i+1]; j++) {
+    row = ao->j[j];
+    pnz = p_oth->i[row+1] - p_oth->i[row];
+    pj  = ptap->pjc_oth + p_oth->i[row];
+    for (k=0; k<pnz; k++) {
+      if (!PetscBTLookupSet(bt,pj[k])) aprow[cnt++] = pj[k];
+    }
+    if (numeric) {
+      pa     = p_oth->a + p_oth->i[row];
+      valtmp = ao->a[j];
+      for (k=0; k<pnz; k++) apa[pj[k]] += valtmp*pa[k];
+      flops += 2.0*pnz;
+    }
+  }
+  *n = cnt;
+  if (numeric) {ierr = PetscLogFlops(flops);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPAllAtOnceAddToC_Private"
+/*
+   Adds scale*vals to the local row of the assembled matrix C, where the global columns gcols are sorted and in the
+   nonzero structure of the row. The off-diagonal part of C is numbered as the sorted c->garray, so both parts of the
+   row are in the order of gcols.
+*/
+static PetscErrorCode MatPtAPAllAtOnceAddToC_Private(Mat C,PetscInt row,PetscInt n,const PetscInt gcols[],const MatScalar vals[],MatScalar scale)
+{
+  Mat_MPIAIJ *c=(Mat_MPIAIJ*)C->data;
+  Mat_SeqAIJ *cd=(Mat_SeqAIJ*)(c->A)->data,*co=(Mat_SeqAIJ*)(c->B)->data;
+  PetscInt   cstart=C->cmap->rstart,cend=C->cmap->rend,k=0,j,jo,*cj,*garray=c->garray;
+  MatScalar  *ca;
+
+  PetscFunctionBegin;
+  cj = co->j + co->i[row];
+  ca = co->a + co->i[row];
+  for (jo=0; k<n && gcols[k]<cstart; jo++) {
+    if (garray[cj[jo]] == gcols[k]) ca[jo] += scale*vals[k++];
+  }
+  cj = cd->j + cd->i[row];
+  ca = cd->a + cd->i[row];
+  for (j=0; k<n && gcols[k]<cend; j++) {
+    if (cj[j] == gcols[k]-cstart) ca[j] += scale*vals[k++];
+  }
+  cj = co->j + co->i[row];
+  ca = co->a + co->i[row];
+  for (; k<n; jo++) {
+    if (garray[cj[jo]] == gcols[k]) ca[jo] += scale*vals[k++];
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPNumeric_MPIAIJ_MPIAIJ_AllAtOnce"
+static PetscErrorCode MatPtAPNumeric_MPIAIJ_MPIAIJ_AllAtOnce(Mat A,Mat P,Mat C)
+{
+  PetscErrorCode       ierr;
+  Mat_MPIAIJ           *a=(Mat_MPIAIJ*)A->data,*p=(Mat_MPIAIJ*)P->data,*c=(Mat_MPIAIJ*)C->data;
+  Mat_SeqAIJ           *ad=(Mat_SeqAIJ*)(a->A)->data,*ao=(Mat_SeqAIJ*)(a->B)->data,*po=(Mat_SeqAIJ*)(p->B)->data;
+  Mat_SeqAIJ           *p_loc,*p_oth;
+  Mat_PtAPMPI          *ptap=c->ptap;
+  Mat_Merge_SeqsToMPI  *merge;
+  MPI_Comm             comm=((PetscObject)C)->comm;
+  PetscMPIInt          size,taga,*len_s;
+  MPI_Request          *s_waits,*r_waits=PETSC_NULL;
+  MPI_Status           *status;
+  PetscInt             am=A->rmap->n,pon=(p->B)->cmap->n,pcstart=P->cmap->rstart,pcend=P->cmap->rend,crstart=C->rmap->rstart;
+  PetscInt             i,j,k,n,pass,proc,row,col,pnz,cnz,nextap,nrows,*pj,*poJ,*cj,*ci,*coi,*coj,*aprow,*apg;
+  MatScalar            *pa,*ca,*coa,**abuf_r=PETSC_NULL,*apa,*apv,*apw,valtmp;
+  PetscBool            sendrow,assembled=C->assembled;
+  PetscLogDouble       flops=0.0;
+
+  PetscFunctionBegin;
+  if (!ptap) SETERRQ(comm,PETSC_ERR_ARG_INCOMP,"MatPtAP() has not been called to create matrix C yet, cannot use MAT_REUSE_MATRIX");
+  ierr  = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  merge = ptap->merge;
+
+  /* get P_oth = ptap->P_oth and P_loc = ptap->P_loc, whose nonzero structure and so ptap->pjc_loc and ptap->pjc_oth are unchanged */
+  if (ptap->reuse == MAT_INITIAL_MATRIX){
+    ptap->reuse = MAT_REUSE_MATRIX;
+  } else {
+    ierr = MatGetBrowsOfAoCols_MPIAIJ(A,P,MAT_REUSE_MATRIX,&ptap->startsj_s,&ptap->startsj_r,&ptap->bufa,&ptap->P_oth);CHKERRQ(ierr);
+    ierr = MatMPIAIJGetLocalMat(P,MAT_REUSE_MATRIX,&ptap->P_loc);CHKERRQ(ierr);
+  }
+  /* the first product inserts into C with MatSetValues(); the others add directly to its nonzero structure */
+  if (assembled) {ierr = MatZeroEntries(C);CHKERRQ(ierr);}
+  p_loc = (Mat_SeqAIJ*)(ptap->P_loc)->data;
+  p_oth = (Mat_SeqAIJ*)(ptap->P_oth)->data;
+  aprow = ptap->aprow; apg = ptap->apg; apa = ptap->apa; apv = ptap->apv; apw = ptap->apw;
+
+  coi   = merge->coi; coj = merge->coj; len_s = merge->len_s;
+  ierr  = PetscMalloc((coi[pon]+1)*sizeof(MatScalar),&coa);CHKERRQ(ierr);
+  ierr  = PetscMemzero(coa,coi[pon]*sizeof(MatScalar));CHKERRQ(ierr);
+  ierr  = PetscMalloc2(merge->nsend+1,MPI_Request,&s_waits,size,MPI_Status,&status);CHKERRQ(ierr);
+
+  /* the rows of A*P that contribute to Co go first, so that Co is sent while the other rows are added */
+  for (pass=0; pass<2; pass++) {
+    for (i=0; i<am; i++) {
+      sendrow = (po->i[i+1] > po->i[i]) ? PETSC_TRUE : PETSC_FALSE;
+      if (sendrow != (pass ? PETSC_FALSE : PETSC_TRUE)) continue;
+
+      /* row i of A*P with its columns sorted */
+      n    = 0;
+      ierr = MatPtAPAllAtOnceAddRow_Private(ad,ao,p_loc,p_oth,ptap,i,PETSC_TRUE,&n);CHKERRQ(ierr);
+      ierr = PetscSortInt(n,aprow);CHKERRQ(ierr);
+      for (k=0; k<n; k++) {
+        apg[k]        = ptap->acols[aprow[k]];
+        apv[k]        = apa[aprow[k]];
+        apa[aprow[k]] = 0.0;
+        ierr = PetscBTClear(ptap->apbt,aprow[k]);CHKERRQ(ierr);
+      }
+
+      /* add P(i,col)*(A*P)(i,:) to row col of C, directly when it is local and to Co otherwise */
+      pnz = p_loc->i[i+1] - p_loc->i[i];
+      pj  = p_loc->j + p_loc->i[i];
+      pa  = p_loc->a + p_loc->i[i];
+      poJ = po->j + po->i[i];
+      for (j=0; j<pnz; j++) {
+        col    = pj[j];
+        valtmp = pa[j];
+        if (col >= pcstart && col < pcend) {
+          if (assembled) {
+            ierr = MatPtAPAllAtOnceAddToC_Private(C,col-crstart,n,apg,apv,valtmp);CHKERRQ(ierr);
+          } else {
+            for (k=0; k<n; k++) apw[k] = valtmp*apv[k];
+            ierr = MatSetValues(C,1,&col,n,apg,apw,ADD_VALUES);CHKERRQ(ierr);
+          }
+        } else {
+          row = *poJ++;
+          cj  = coj + coi[row];
+          ca  = coa + coi[row];
+          for (k=0,nextap=0; nextap<n; k++) {
+            if (cj[k] == apg[nextap]) ca[k] += valtmp*apv[nextap++];
+          }
+        }
+        flops += 2.0*n;
+      }
+    }
+
+    if (!pass) { /* send Co to the owners of its rows */
+      ierr = PetscCommGetNewTag(comm,&taga);CHKERRQ(ierr);
+      ierr = PetscPostIrecvScalar(comm,taga,merge->nrecv,merge->id_r,merge->len_r,&abuf_r,&r_waits);CHKERRQ(ierr);
+      for (proc=0,k=0; proc<size; proc++){
+        if (!len_s[proc]) continue;
+        i    = merge->owners_co[proc];
+        ierr = MPI_Isend(coa+coi[i],len_s[proc],MPIU_MATSCALAR,proc,taga,comm,s_waits+k);CHKERRQ(ierr);
+        k++;
+      }
+    }
+  }
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+
+  /* add the rows of C computed by other processes */
+  if (merge->nrecv) {ierr = MPI_Waitall(merge->nrecv,r_waits,status);CHKERRQ(ierr);}
+  for (k=0; k<merge->nrecv; k++) {
+    nrows = merge->buf_ri[k][0];
+    ci    = merge->buf_ri[k] + nrows + 1;
+    for (j=0; j<nrows; j++) {
+      row  = merge->buf_ri[k][j+1];
+      cnz  = ci[j+1] - ci[j];
+      if (assembled) {
+        ierr = MatPtAPAllAtOnceAddToC_Private(C,row,cnz,merge->buf_rj[k]+ci[j],abuf_r[k]+ci[j],1.0);CHKERRQ(ierr);
+      } else {
+        row += crstart;
+        ierr = MatSetValues(C,1,&row,cnz,merge->buf_rj[k]+ci[j],abuf_r[k]+ci[j],ADD_VALUES);CHKERRQ(ierr);
+      }
+    }
+  }
+  if (merge->nsend) {ierr = MPI_Waitall(merge->nsend,s_waits,status);CHKERRQ(ierr);}
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  ierr = PetscFree2(s_waits,status);CHKERRQ(ierr);
+  ierr = PetscFree(r_waits);CHKERRQ(ierr);
+  ierr = PetscFree(abuf_r[0]);CHKERRQ(ierr);
+  ierr = PetscFree(abuf_r);CHKERRQ(ierr);
+  ierr = PetscFree(coa);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatPtAPSymbolic_MPIAIJ_MPIAIJ_AllAtOnce"
+static PetscErrorCode MatPtAPSymbolic_MPIAIJ_MPIAIJ_AllAtOnce(Mat A,Mat P,PetscReal fill,Mat *C)
+{
+  PetscErrorCode       ierr;
+  Mat                  Cmpi;
+  Mat_PtAPMPI          *ptap;
+  PetscFreeSpaceList   free_space=PETSC_NULL,current_space=PETSC_NULL;
+  Mat_MPIAIJ           *a=(Mat_MPIAIJ*)A->data,*p=(Mat_MPIAIJ*)P->data,*c;
+  Mat_SeqAIJ           *ad=(Mat_SeqAIJ*)(a->A)->data,*ao=(Mat_SeqAIJ*)(a->B)->data,*p_loc,*p_oth;
+  Mat_Merge_SeqsToMPI  *merge;
+  MPI_Comm             comm=((PetscObject)A)->comm;
+  PetscMPIInt          size,rank,tagi,tagj,*len_si,*len_s,*len_ri,icompleted=0;
+  MPI_Request          *swaits,*rwaits;
+  MPI_Status           *sstatus,rstatus;
+  PetscInt             pm=P->rmap->n,pn=P->cmap->n,pon=(p->B)->cmap->n,om=(a->B)->cmap->n,*prmap=p->garray,*owners=P->cmap->range;
+  PetscInt             *pdti,*pdtj,*poti,*potj,*coi,*coj,*owners_co,*acols,*dnz,*onz,*rowbuf,rowbufsize;
+  PetscInt             **buf_ri,**buf_rj,**nextrow,**nextci,*buf_s,*buf_si,*buf_si_i;
+  PetscInt             i,j,k,n,nnz,cnz,len,proc,nrows,nspacedouble=0;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+
+  ierr = PetscNew(Mat_PtAPMPI,&ptap);CHKERRQ(ierr);
+  ptap->reuse = MAT_INITIAL_MATRIX;
+  ierr = MatGetBrowsOfAoCols_MPIAIJ(A,P,MAT_INITIAL_MATRIX,&ptap->startsj_s,&ptap->startsj_r,&ptap->bufa,&ptap->P_oth);CHKERRQ(ierr);
+  ierr = MatMPIAIJGetLocalMat(P,MAT_INITIAL_MATRIX,&ptap->P_loc);CHKERRQ(ierr);
+  p_loc = (Mat_SeqAIJ*)(ptap->P_loc)->data;
+  p_oth = (Mat_SeqAIJ*)(ptap->P_oth)->data;
+
+  /* number the columns of P_loc and P_oth, which index the work arrays */
+  nnz  = p_loc->i[pm] + p_oth->i[om];
+  ierr = PetscMalloc((nnz+1)*sizeof(PetscInt),&acols);CHKERRQ(ierr);
+  ierr = PetscMemcpy(acols,p_loc->j,p_loc->i[pm]*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(acols+p_loc->i[pm],p_oth->j,p_oth->i[om]*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscSortRemoveDupsInt(&nnz,acols);CHKERRQ(ierr);
+  ptap->nac = nnz;
+  ierr = PetscMalloc((nnz+1)*sizeof(PetscInt),&ptap->acols);CHKERRQ(ierr);
+  ierr = PetscMemcpy(ptap->acols,acols,nnz*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscFree(acols);CHKERRQ(ierr);
+  ierr = PetscMalloc((p_loc->i[pm]+1)*sizeof(PetscInt),&ptap->pjc_loc);CHKERRQ(ierr);
+  ierr = PetscMalloc((p_oth->i[om]+1)*sizeof(PetscInt),&ptap->pjc_oth);CHKERRQ(ierr);
+  for (k=0; k<p_loc->i[pm]; k++) {ierr = PetscFindInt(p_loc->j[k],nnz,ptap->acols,&ptap->pjc_loc[k]);CHKERRQ(ierr);}
+  for (k=0; k<p_oth->i[om]; k++) {ierr = PetscFindInt(p_oth->j[k],nnz,ptap->acols,&ptap->pjc_oth[k]);CHKERRQ(ierr);}
+  ierr = PetscMalloc((nnz+1)*sizeof(PetscScalar),&ptap->apa);CHKERRQ(ierr);
+  ierr = PetscMemzero(ptap->apa,nnz*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscMalloc4(nnz+1,PetscInt,&ptap->aprow,nnz+1,PetscInt,&ptap->apg,nnz+1,PetscScalar,&ptap->apv,nnz+1,PetscScalar,&ptap->apw);CHKERRQ(ierr);
+  ierr = PetscBTCreate(nnz,&ptap->apbt);CHKERRQ(ierr);
+
+  /* symbolic Co = (p->B)^T*A*P: row k is the union of the rows i of A*P with p->B(i,k) nonzero */
+  /*-------------------------------------------------------------------------------------------*/
+  ierr = MatGetSymbolicTranspose_SeqAIJ(p->B,&poti,&potj);CHKERRQ(ierr);
+  ierr = PetscMalloc((pon+1)*sizeof(PetscInt),&coi);CHKERRQ(ierr);
+  coi[0] = 0;
+  ierr = PetscFreeSpaceGet((PetscInt)(fill*(poti[pon] + ad->i[pm] + ao->i[pm])) + 1,&free_space);CHKERRQ(ierr);
+  current_space = free_space;
+  for (k=0; k<pon; k++) {
+    n = 0;
+    for (j=poti[k]; j<poti[k+1]; j++) {
+      ierr = MatPtAPAllAtOnceAddRow_Private(ad,ao,p_loc,p_oth,ptap,potj[j],PETSC_FALSE,&n);CHKERRQ(ierr);
+    }
+    if (current_space->local_remaining < n) {
+      ierr = PetscFreeSpaceGet(n+current_space->total_array_size,&current_space);CHKERRQ(ierr);
+      nspacedouble++;
+    }
+    ierr = PetscSortInt(n,ptap->aprow);CHKERRQ(ierr);
+    for (i=0; i<n; i++) {
+      current_space->array[i] = ptap->acols[ptap->aprow[i]];
+      ierr = PetscBTClear(ptap->apbt,ptap->aprow[i]);CHKERRQ(ierr);
+    }
+    current_space->array           += n;
+    current_space->local_used      += n;
+    current_space->local_remaining -= n;
+    coi[k+1] = coi[k] + n;
+  }
+  ierr = PetscMalloc((coi[pon]+1)*sizeof(PetscInt),&coj);CHKERRQ(ierr);
+  ierr = PetscFreeSpaceContiguous(&free_space,coj);CHKERRQ(ierr);
+  ierr = MatRestoreSymbolicTranspose_SeqAIJ(p->B,&poti,&potj);CHKERRQ(ierr);
+
+  /* send the structure of Co to the owners of its rows */
+  /*-----------------------------------------------------*/
+  ierr = PetscNew(Mat_Merge_SeqsToMPI,&merge);CHKERRQ(ierr);
+  ierr = PetscMalloc2(size,PetscMPIInt,&len_si,size,MPI_Status,&sstatus);CHKERRQ(ierr);
+  ierr = PetscMemzero(len_si,size*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  ierr = PetscMalloc(size*sizeof(PetscMPIInt),&merge->len_s);CHKERRQ(ierr);
+  len_s = merge->len_s;
+  ierr = PetscMemzero(len_s,size*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  ierr = PetscMalloc((size+2)*sizeof(PetscInt),&owners_co);CHKERRQ(ierr);
+
+  proc = 0;
+  for (i=0; i<pon; i++){
+    while (prmap[i] >= owners[proc+1]) proc++;
+    len_si[proc]++;  /* num of rows in Co to be sent to [proc] */
+    len_s[proc] += coi[i+1] - coi[i];
+  }
+  len          = 0;  /* max length of buf_si[] */
+  owners_co[0] = 0;
+  merge->nsend = 0;
+  for (proc=0; proc<size; proc++){
+    owners_co[proc+1] = owners_co[proc] + len_si[proc];
+    if (len_s[proc]){
+      merge->nsend++;
+      len_si[proc] = 2*(len_si[proc] + 1);
+      len += len_si[proc];
+    } else len_si[proc] = 0;
+  }
+  ierr = PetscGatherNumberOfMessages(comm,PETSC_NULL,len_s,&merge->nrecv);CHKERRQ(ierr);
+  ierr = PetscGatherMessageLengths2(comm,merge->nsend,merge->nrecv,len_s,len_si,&merge->id_r,&merge->len_r,&len_ri);CHKERRQ(ierr);
+
+  /* coj */
+  ierr = PetscCommGetNewTag(comm,&tagj);CHKERRQ(ierr);
+  ierr = PetscPostIrecvInt(comm,tagj,merge->nrecv,merge->id_r,merge->len_r,&buf_rj,&rwaits);CHKERRQ(ierr);
+  ierr = PetscMalloc((merge->nsend+1)*sizeof(MPI_Request),&swaits);CHKERRQ(ierr);
+  for (proc=0,k=0; proc<size; proc++){
+    if (!len_s[proc]) continue;
+    i    = owners_co[proc];
+    ierr = MPI_Isend(coj+coi[i],len_s[proc],MPIU_INT,proc,tagj,comm,swaits+k);CHKERRQ(ierr);
+    k++;
+  }
+  for (i=0; i<merge->nrecv; i++){
+    ierr = MPI_Waitany(merge->nrecv,rwaits,&icompleted,&rstatus);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(rwaits);CHKERRQ(ierr);
+  if (merge->nsend) {ierr = MPI_Waitall(merge->nsend,swaits,sstatus);CHKERRQ(ierr);}
+
+  /* the i-structure: buf_si[0] is the number of rows, buf_si[1:nrows] their local indices on [proc] and
+     buf_si[nrows+1:2*nrows+1] their offsets in the message of coj */
+  ierr = PetscCommGetNewTag(comm,&tagi);CHKERRQ(ierr);
+  ierr = PetscPostIrecvInt(comm,tagi,merge->nrecv,merge->id_r,len_ri,&buf_ri,&rwaits);CHKERRQ(ierr);
+  ierr = PetscMalloc((len+1)*sizeof(PetscInt),&buf_s);CHKERRQ(ierr);
+  buf_si = buf_s;
+  for (proc=0,k=0; proc<size; proc++){
+    if (!len_s[proc]) continue;
+    nrows       = len_si[proc]/2 - 1;
+    buf_si_i    = buf_si + nrows+1;
+    buf_si[0]   = nrows;
+    buf_si_i[0] = 0;
+    nrows       = 0;
+    for (i=owners_co[proc]; i<owners_co[proc+1]; i++){
+      buf_si_i[nrows+1] = buf_si_i[nrows] + coi[i+1] - coi[i];
+      buf_si[nrows+1]   = prmap[i] - owners[proc];
+      nrows++;
+    }
+    ierr = MPI_Isend(buf_si,len_si[proc],MPIU_INT,proc,tagi,comm,swaits+k);CHKERRQ(ierr);
+    k++;
+    buf_si += len_si[proc];
+  }
+  for (i=0; i<merge->nrecv; i++){
+    ierr = MPI_Waitany(merge->nrecv,rwaits,&icompleted,&rstatus);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(rwaits);CHKERRQ(ierr);
+  if (merge->nsend) {ierr = MPI_Waitall(merge->nsend,swaits,sstatus);CHKERRQ(ierr);}
+  ierr = PetscFree2(len_si,sstatus);CHKERRQ(ierr);
+  ierr = PetscFree(len_ri);CHKERRQ(ierr);
+  ierr = PetscFree(swaits);CHKERRQ(ierr);
+  ierr = PetscFree(buf_s);CHKERRQ(ierr);
+
+  /* preallocate the local rows of C: row k is the union of the rows i of A*P with p->A(i,k) nonzero and of the rows
+     received for it */
+  /*---------------------------------------------------------------------------------------------------------------*/
+  ierr = MatGetSymbolicTranspose_SeqAIJ(p->A,&pdti,&pdtj);CHKERRQ(ierr);
+  ierr = PetscMalloc2(merge->nrecv,PetscInt*,&nextrow,merge->nrecv,PetscInt*,&nextci);CHKERRQ(ierr);
+  for (k=0; k<merge->nrecv; k++){
+    nextrow[k] = buf_ri[k] + 1;
+    nextci[k]  = buf_ri[k] + buf_ri[k][0] + 1;
+  }
+  rowbufsize = ptap->nac + 1;
+  ierr = PetscMalloc(rowbufsize*sizeof(PetscInt),&rowbuf);CHKERRQ(ierr);
+  ierr = MatPreallocateInitialize(comm,pn,pn,dnz,onz);CHKERRQ(ierr);
+  for (i=0; i<pn; i++) {
+    n = 0;
+    for (j=pdti[i]; j<pdti[i+1]; j++) {
+      ierr = MatPtAPAllAtOnceAddRow_Private(ad,ao,p_loc,p_oth,ptap,pdtj[j],PETSC_FALSE,&n);CHKERRQ(ierr);
+    }
+    cnz = n;
+    for (k=0; k<merge->nrecv; k++){
+      if (i == *nextrow[k]) cnz += nextci[k][1] - nextci[k][0];
+    }
+    if (cnz > rowbufsize) {
+      ierr       = PetscFree(rowbuf);CHKERRQ(ierr);
+      rowbufsize = PetscMax(2*rowbufsize,cnz);
+      ierr       = PetscMalloc(rowbufsize*sizeof(PetscInt),&rowbuf);CHKERRQ(ierr);
+    }
+    for (j=0; j<n; j++) {
+      rowbuf[j] = ptap->acols[ptap->aprow[j]];
+      ierr = PetscBTClear(ptap->apbt,ptap->aprow[j]);CHKERRQ(ierr);
+    }
+    nnz = n;
+    for (k=0; k<merge->nrecv; k++){
+      if (i == *nextrow[k]) {
+        cnz  = nextci[k][1] - nextci[k][0];
+        ierr = PetscMemcpy(rowbuf+nnz,buf_rj[k]+nextci[k][0],cnz*sizeof(PetscInt));CHKERRQ(ierr);
+        nnz += cnz;
+        nextrow[k]++; nextci[k]++;
+      }
+    }
+    ierr = PetscSortRemoveDupsInt(&nnz,rowbuf);CHKERRQ(ierr);
+    ierr = MatPreallocateSet(i+owners[rank],nnz,rowbuf,dnz,onz);CHKERRQ(ierr);
+  }
+  ierr = MatRestoreSymbolicTranspose_SeqAIJ(p->A,&pdti,&pdtj);CHKERRQ(ierr);
+  ierr = PetscFree2(nextrow,nextci);CHKERRQ(ierr);
+  ierr = PetscFree(rowbuf);CHKERRQ(ierr);
+
+  /* create symbolic parallel matrix Cmpi */
+  /*--------------------------------------*/
+  ierr = MatCreate(comm,&Cmpi);CHKERRQ(ierr);
+  ierr = MatSetSizes(Cmpi,pn,pn,PETSC_DETERMINE,PETSC_DETERMINE);CHKERRQ(ierr);
+  ierr = MatSetBlockSizes(Cmpi,P->cmap->bs,P->cmap->bs);CHKERRQ(ierr);
+  ierr = MatSetType(Cmpi,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(Cmpi,0,dnz,0,onz);CHKERRQ(ierr);
+  ierr = MatPreallocateFinalize(dnz,onz);CHKERRQ(ierr);
+
+  merge->coi       = coi;
+  merge->coj       = coj;
+  merge->buf_ri    = buf_ri;
+  merge->buf_rj    = buf_rj;
+  merge->owners_co = owners_co;
+  merge->destroy   = Cmpi->ops->destroy;
+  merge->duplicate = Cmpi->ops->duplicate;
+
+  /* Cmpi is not ready for use - assembly will be done by MatPtAPNumeric() */
+  Cmpi->assembled        = PETSC_FALSE;
+  Cmpi->ops->destroy     = MatDestroy_MPIAIJ_PtAP;
+  Cmpi->ops->duplicate   = MatDuplicate_MPIAIJ_MatPtAP;
+  Cmpi->ops->ptapnumeric = MatPtAPNumeric_MPIAIJ_MPIAIJ_AllAtOnce;
+
+  c           = (Mat_MPIAIJ*)Cmpi->data;
+  c->ptap     = ptap;
+  ptap->merge = merge;
+  *C          = Cmpi;
+
+  ierr = PetscInfo4(Cmpi,"All-at-once product: %D columns of P in the work arrays, %D nonzeros of Co in %D rows; reallocs %D\n",ptap->nac,coi[pon],pon,nspacedouble);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
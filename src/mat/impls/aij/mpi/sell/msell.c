@@ -0,0 +1,224 @@
+/*
+  Defines the MATMPISELL matrix class.
+  This class is derived from the MATMPIAIJ class, the diagonal and off-diagonal
+  blocks of each process are MATSEQSELL matrices so the MPIAIJ products use the
+  sliced ELLPACK kernels of the sequential class for the local work.
+
+   See src/mat/impls/aij/seq/sell/sell.c for the sequential version
+*/
+
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <../src/mat/impls/aij/seq/sell/sell.h>
+
+extern PetscErrorCode MatDestroy_MPIAIJ(Mat);
+EXTERN_C_BEGIN
+extern PetscErrorCode MatConvert_SeqAIJ_SeqSELL(Mat,MatType,MatReuse,Mat*);
+EXTERN_C_END
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMPISELLSetUpBlocks_Private"
+/*
+   Converts the diagonal and off-diagonal blocks to MATSEQSELL, the MPIAIJ code creates them
+   as MATSEQAIJ during preallocation. The blocks have no options prefix so they get the
+   chunk size and sorting window from the options of the parallel matrix.
+*/
+static PetscErrorCode MatMPISELLSetUpBlocks_Private(Mat A)
+{
+  Mat_MPIAIJ     *a = (Mat_MPIAIJ*)A->data;
+  Mat            blocks[2];
+  Mat_SeqSELL    *sell;
+  PetscInt       i,C = 8,sigma = 1;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsGetInt(((PetscObject)A)->prefix,"-mat_sell_chunk_size",&C,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(((PetscObject)A)->prefix,"-mat_sell_sigma",&sigma,PETSC_NULL);CHKERRQ(ierr);
+  blocks[0] = a->A;
+  blocks[1] = a->B;
+  for (i=0; i<2; i++) {
+    if (!blocks[i]) continue;
+    ierr = PetscObjectTypeCompare((PetscObject)blocks[i],MATSEQSELL,&flg);CHKERRQ(ierr);
+    if (!flg) {
+      ierr = MatConvert_SeqAIJ_SeqSELL(blocks[i],MATSEQSELL,MAT_REUSE_MATRIX,&blocks[i]);CHKERRQ(ierr);
+    }
+    sell = (Mat_SeqSELL*)blocks[i]->spptr;
+    if (!sell->C) {
+      sell->C     = C;
+      sell->sigma = sigma;
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDestroy_MPISELL"
+PetscErrorCode MatDestroy_MPISELL(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectChangeTypeName((PetscObject)A,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatDestroy_MPIAIJ(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+extern PetscErrorCode MatAssemblyEnd_MPIAIJ(Mat,MatAssemblyType);
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAssemblyEnd_MPISELL"
+PetscErrorCode MatAssemblyEnd_MPISELL(Mat A,MatAssemblyType mode)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMPISELLSetUpBlocks_Private(A);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd_MPIAIJ(A,mode);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+extern PetscErrorCode MatAXPY_MPIAIJ(Mat,PetscScalar,Mat,MatStructure);
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAXPY_MPISELL"
+PetscErrorCode MatAXPY_MPISELL(Mat Y,PetscScalar a,Mat X,MatStructure str)
+{
+  Mat_MPIAIJ     *y;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatAXPY_MPIAIJ(Y,a,X,str);CHKERRQ(ierr);
+  /* the values of the blocks may have been changed without going through MatAXPY() on the blocks */
+  y    = (Mat_MPIAIJ*)Y->data;
+  ierr = PetscObjectStateIncrease((PetscObject)y->A);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)y->B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* MatConvert_MPIAIJ_MPISELL converts a MPIAIJ matrix into a
+ * MPISELL matrix.  This routine is called by the MatCreate_MPISELL()
+ * routine, but can also be used to convert an assembled MPIAIJ matrix
+ * into a MPISELL one. */
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "MatConvert_MPIAIJ_MPISELL"
+PetscErrorCode  MatConvert_MPIAIJ_MPISELL(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* Set function pointers for methods that we inherit from MPIAIJ but override. */
+  B->ops->assemblyend = MatAssemblyEnd_MPISELL;
+  B->ops->destroy     = MatDestroy_MPISELL;
+  B->ops->axpy        = MatAXPY_MPISELL;
+
+  /* If A has already been assembled, switch the blocks now. */
+  if (A->assembled) {
+    ierr = MatMPISELLSetUpBlocks_Private(B);CHKERRQ(ierr);
+  }
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATMPISELL);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
+#undef __FUNCT__
+#define __FUNCT__ "MatCreateMPISELL"
+/*@C
+   MatCreateMPISELL - Creates a sparse parallel matrix of type MPISELL.
+   This type inherits from MPIAIJ, the diagonal and off-diagonal blocks
+   of each process are MATSEQSELL matrices, which keep a sliced ELLPACK
+   (SELL-C-sigma) copy of the matrix for the products with vectors.
+   As with the AIJ type, it is important to preallocate matrix storage
+   in order to get good assembly performance.
+
+   Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator
+.  m - number of local rows (or PETSC_DECIDE to have calculated if M is given)
+.  n - number of local columns (or PETSC_DECIDE to have calculated if N is given)
+.  M - number of global rows (or PETSC_DETERMINE to have calculated if m is given)
+.  N - number of global columns (or PETSC_DETERMINE to have calculated if n is given)
+.  d_nz - number of nonzeros per row in the diagonal portion of the local submatrix (same for all local rows)
+.  d_nnz - array containing the number of nonzeros in the various rows of the diagonal portion or PETSC_NULL
+.  o_nz - number of nonzeros per row in the off-diagonal portion of the local submatrix (same for all local rows)
+-  o_nnz - array containing the number of nonzeros in the various rows of the off-diagonal portion or PETSC_NULL
+
+   Output Parameter:
+.  A - the matrix
+
+   Options Database Keys:
++  -mat_sell_chunk_size <C> - number of rows in a slice, default 8
+-  -mat_sell_sigma <sigma> - rows are sorted by decreasing length within windows of sigma rows, default 1 (no sorting)
+
+   Level: intermediate
+
+.keywords: matrix, ellpack, sell, sparse, parallel, vectorization
+
+.seealso: MatCreate(), MatCreateSeqSELL(), MatCreateAIJ(), MatSetValues()
+@*/
+PetscErrorCode  MatCreateMPISELL(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt M,PetscInt N,PetscInt d_nz,const PetscInt d_nnz[],PetscInt o_nz,const PetscInt o_nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,M,N);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATMPISELL);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(*A,d_nz,d_nnz,o_nz,o_nnz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATMPISELL - MATMPISELL = "mpisell" - A parallel matrix type for sparse matrices whose products
+   with vectors use the sliced ELLPACK (SELL-C-sigma) format for the local work.
+
+   The matrix is an MATMPIAIJ matrix whose diagonal and off-diagonal blocks are MATSEQSELL matrices.
+
+   Options Database Keys:
++  -mat_type mpisell - sets the matrix type to "mpisell" during a call to MatSetFromOptions()
+.  -mat_sell_chunk_size <C> - number of rows in a slice, at most 64, default 8
+-  -mat_sell_sigma <sigma> - rows are sorted by decreasing length within windows of sigma rows, default 1
+
+   Level: intermediate
+
+.seealso: MatCreateMPISELL(), MATSEQSELL, MATSELL, MATMPIAIJ
+M*/
+
+/*MC
+   MATSELL - MATSELL = "sell" - A matrix type for sparse matrices whose products with vectors use
+   the sliced ELLPACK (SELL-C-sigma) format.
+
+   This matrix type is identical to MATSEQSELL when constructed with a single process communicator,
+   and MATMPISELL otherwise.  As a result, for single process communicators,
+   MatSeqAIJSetPreallocation() is supported, and similarly MatMPIAIJSetPreallocation() is supported
+  for communicators controlling multiple processes.  It is recommended that you call both of
+  the above preallocation routines for simplicity.
+
+   Options Database Keys:
+. -mat_type sell - sets the matrix type to "sell" during a call to MatSetFromOptions()
+
+  Level: beginner
+
+.seealso: MatCreateMPISELL(), MATSEQSELL, MATMPISELL
+M*/
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "MatCreate_MPISELL"
+PetscErrorCode  MatCreate_MPISELL(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATMPIAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_MPIAIJ_MPISELL(A,MATMPISELL,MAT_REUSE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
@@ -351,6 +351,7 @@ PetscErrorCode MatSetValues_SeqAIJ(Mat A,PetscInt m,const PetscInt im[],PetscInt
       if (nonew == -1) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Inserting a new nonzero at (%D,%D) in the matrix",row,col);
       MatSeqXAIJReallocateAIJ(A,A->rmap->n,1,nrow,row,col,rmax,aa,ai,aj,rp,ap,imax,nonew,MatScalar);
       N = nrow++ - 1; a->nz++; high++;
+      a->sorcolor.valid = PETSC_FALSE;
       /* shift up all the later entries in this row */
       for (ii=N; ii>=i; ii--) {
         rp[ii+1] = rp[ii];
@@ -954,6 +955,8 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = PetscFree(a->ibdiag);CHKERRQ(ierr);
   ierr = PetscFree2(a->imax,a->ilen);CHKERRQ(ierr);
   ierr = PetscFree3(a->idiag,a->mdiag,a->ssor_work);CHKERRQ(ierr);
+  ierr = PetscFree4(a->sorcolor.start,a->sorcolor.rows,a->sorcolor.color,a->sorcolor.tstarts);CHKERRQ(ierr);
+  ierr = MatSolveLevelsDestroy_Private(&a->solvelevels);CHKERRQ(ierr);
   ierr = PetscFree(a->solve_work);CHKERRQ(ierr);
   ierr = ISDestroy(&a->icol);CHKERRQ(ierr);
   ierr = PetscFree(a->saved_values);CHKERRQ(ierr);
@@ -1457,6 +1460,184 @@ PetscErrorCode  MatInvertDiagonal_SeqAIJ(Mat A,PetscScalar omega,PetscScalar fsh
 }
 EXTERN_C_END
 
+#undef __FUNCT__
+#define __FUNCT__ "MatSORColorSetUp_SeqAIJ"
+/*
+   Computes the multicolor ordering used by MatSOR_SeqAIJ() with -mat_sor_multicolor. The column coloring of
+   MatGetColoring() gives different colors to any two rows coupled by a nonzero, because both columns have a
+   nonzero in the row of the coupling entry (the diagonal is stored). The rows of each color are split among the
+   threads with about the same number of nonzeros each.
+*/
+static PetscErrorCode MatSORColorSetUp_SeqAIJ(Mat A)
+{
+  Mat_SeqAIJ          *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJ_SORColor *sc = &a->sorcolor;
+  PetscErrorCode      ierr;
+  ISColoring          iscoloring;
+  PetscInt            m = A->rmap->n,nc,nt = 1,c,i,k,t,*next,nz,cnt;
+  const PetscInt      *ai = a->i;
+
+  PetscFunctionBegin;
+  if (sc->valid) PetscFunctionReturn(0);
+#if defined(PETSC_THREADCOMM_ACTIVE)
+  ierr = PetscThreadCommGetNThreads(((PetscObject)A)->comm,&nt);CHKERRQ(ierr);
+#endif
+  ierr = PetscFree4(sc->start,sc->rows,sc->color,sc->tstarts);CHKERRQ(ierr);
+  ierr = MatGetColoring(A,MATCOLORINGSL,&iscoloring);CHKERRQ(ierr);
+  nc   = iscoloring->n;
+  ierr = PetscMalloc4(nc+1,PetscInt,&sc->start,m,PetscInt,&sc->rows,m,PetscInt,&sc->color,nc*(nt+1),PetscInt,&sc->tstarts);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory(A,(nc+1+2*m+nc*(nt+1))*sizeof(PetscInt));CHKERRQ(ierr);
+
+  /* sort the rows by color, keeping their order within a color */
+  ierr = PetscMemzero(sc->start,(nc+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    sc->color[i] = (PetscInt)iscoloring->colors[i];
+    sc->start[sc->color[i]+1]++;
+  }
+  for (c=0; c<nc; c++) sc->start[c+1] += sc->start[c];
+  ierr = PetscMalloc(nc*sizeof(PetscInt),&next);CHKERRQ(ierr);
+  ierr = PetscMemcpy(next,sc->start,nc*sizeof(PetscInt));CHKERRQ(ierr);
+  for (i=0; i<m; i++) sc->rows[next[sc->color[i]]++] = i;
+  ierr = PetscFree(next);CHKERRQ(ierr);
+  ierr = ISColoringDestroy(&iscoloring);CHKERRQ(ierr);
+
+  for (c=0; c<nc; c++) {
+    PetscInt *ts = sc->tstarts + c*(nt+1);
+    nz = 0;
+    for (k=sc->start[c]; k<sc->start[c+1]; k++) nz += ai[sc->rows[k]+1] - ai[sc->rows[k]];
+    ts[0] = sc->start[c];
+    cnt   = 0;
+    for (t=1,k=sc->start[c]; t<nt; t++) {
+      while (k < sc->start[c+1] && (PetscReal)cnt*nt < (PetscReal)t*nz) {cnt += ai[sc->rows[k]+1] - ai[sc->rows[k]]; k++;}
+      ts[t] = k;
+    }
+    ts[nt] = sc->start[c+1];
+  }
+  sc->ncolors  = nc;
+  sc->nthreads = nt;
+  sc->valid    = PETSC_TRUE;
+  ierr = PetscInfo2(A,"Multicolor ordering for MatSOR() with %D colors on %D threads\n",nc,nt);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* the update of a row in MatSOR_SeqAIJ_Multicolor_Kernel() */
+#define MAT_SOR_COLOR_RELAX 0 /* x_i = (1-omega) x_i + omega/(d_i+fshift) (b_i - A_i x + d_i x_i) */
+#define MAT_SOR_COLOR_LOWER 1 /* x_i = omega/(d_i+fshift) (b_i - L_i x), L the couplings to the lower colors */
+#define MAT_SOR_COLOR_UPPER 2 /* x_i = omega/(d_i+fshift) (b_i - U_i x), U the couplings to the higher colors */
+
+static PetscErrorCode MatSOR_SeqAIJ_Multicolor_Kernel(PetscInt thread_id,Mat A,const PetscScalar *b,PetscScalar *x,PetscInt *color,PetscInt *type)
+{
+  Mat_SeqAIJ          *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJ_SORColor *sc = &a->sorcolor;
+  const PetscInt      *rows = sc->rows,*rcolor = sc->color,*ai = a->i,*aj,*ts = sc->tstarts + (*color)*(sc->nthreads+1);
+  const PetscScalar   *idiag = a->idiag,*mdiag = a->mdiag;
+  const MatScalar     *aa;
+  PetscScalar         sum,omega = a->omega;
+  PetscInt            c = *color,i,j,k,n;
+
+  for (k=ts[thread_id]; k<ts[thread_id+1]; k++) {
+    i   = rows[k];
+    n   = ai[i+1] - ai[i];
+    aj  = a->j + ai[i];
+    aa  = a->a + ai[i];
+    sum = b[i];
+    switch (*type) {
+    case MAT_SOR_COLOR_RELAX:
+      PetscSparseDenseMinusDot(sum,x,aa,aj,n);
+      x[i] = (1. - omega)*x[i] + (sum + mdiag[i]*x[i])*idiag[i];
+      break;
+    case MAT_SOR_COLOR_LOWER:
+      for (j=0; j<n; j++) if (rcolor[aj[j]] < c) sum -= aa[j]*x[aj[j]];
+      x[i] = sum*idiag[i];
+      break;
+    case MAT_SOR_COLOR_UPPER:
+      for (j=0; j<n; j++) if (rcolor[aj[j]] > c) sum -= aa[j]*x[aj[j]];
+      x[i] = sum*idiag[i];
+      break;
+    }
+  }
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSORColorSweep_SeqAIJ"
+/* updates the rows of one color, b and x may be the same array for the LOWER and UPPER updates */
+static PetscErrorCode MatSORColorSweep_SeqAIJ(Mat A,const PetscScalar *b,PetscScalar *x,PetscInt color,PetscInt type)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+#if defined(PETSC_THREADCOMM_ACTIVE)
+  ierr = PetscThreadCommRunKernel(((PetscObject)A)->comm,(PetscThreadKernel)MatSOR_SeqAIJ_Multicolor_Kernel,5,A,b,x,&color,&type);CHKERRQ(ierr);
+  ierr = PetscThreadCommBarrier(((PetscObject)A)->comm);CHKERRQ(ierr);
+#else
+  ierr = MatSOR_SeqAIJ_Multicolor_Kernel(0,A,b,x,&color,&type);CHKERRQ(ierr);
+#endif
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSOR_SeqAIJ_Multicolor"
+/*
+   MatSOR_SeqAIJ() in the multicolor ordering: the forward sweeps go through the colors in increasing order, the
+   backward sweeps in decreasing order, and the rows of a color are updated in parallel. This is SOR on the
+   symmetrically permuted matrix, so the results differ from those in the natural ordering. The diagonal and its
+   inverse are set up by the caller.
+*/
+static PetscErrorCode MatSOR_SeqAIJ_Multicolor(Mat A,Vec bb,MatSORType flag,PetscInt its,Vec xx)
+{
+  Mat_SeqAIJ          *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJ_SORColor *sc = &a->sorcolor;
+  PetscErrorCode      ierr;
+  PetscScalar         *x,*t = a->ssor_work,sum,scale;
+  const PetscScalar   *b,*mdiag = a->mdiag,*v;
+  PetscInt            m = A->rmap->n,i,j,c,n,nc;
+  const PetscInt      *idx;
+
+  PetscFunctionBegin;
+  ierr = MatSORColorSetUp_SeqAIJ(A);CHKERRQ(ierr);
+  nc   = sc->ncolors;
+  if (flag == SOR_APPLY_LOWER) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"SOR_APPLY_LOWER is not implemented");
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  if (flag == SOR_APPLY_UPPER) {
+    /* apply (U + D/omega) to the vector */
+    for (i=0; i<m; i++) {
+      n   = a->i[i+1] - a->i[i];
+      idx = a->j + a->i[i];
+      v   = a->a + a->i[i];
+      sum = b[i]*(a->fshift + mdiag[i])/a->omega;
+      for (j=0; j<n; j++) if (sc->color[idx[j]] > sc->color[i]) sum += v[j]*b[idx[j]];
+      x[i] = sum;
+    }
+    ierr = PetscLogFlops(a->nz);CHKERRQ(ierr);
+  } else if (flag & SOR_EISENSTAT) {
+    /* (L + E)^{-1} A (U + E)^{-1} applied with Eisenstat's trick, as in MatSOR_SeqAIJ() */
+    scale = (2.0/a->omega) - 1.0;
+    for (c=nc-1; c>=0; c--) {ierr = MatSORColorSweep_SeqAIJ(A,b,x,c,MAT_SOR_COLOR_UPPER);CHKERRQ(ierr);}
+    for (i=0; i<m; i++) t[i] = b[i] - scale*mdiag[i]*x[i];
+    for (c=0; c<nc; c++) {ierr = MatSORColorSweep_SeqAIJ(A,t,t,c,MAT_SOR_COLOR_LOWER);CHKERRQ(ierr);}
+    for (i=0; i<m; i++) x[i] += t[i];
+    ierr = PetscLogFlops(6.0*m-1 + 2.0*a->nz);CHKERRQ(ierr);
+  } else {
+    /* with a zero initial guess the first sweep is a relaxation of x = 0 */
+    if (flag & SOR_ZERO_INITIAL_GUESS) {ierr = PetscMemzero(x,m*sizeof(PetscScalar));CHKERRQ(ierr);}
+    while (its--) {
+      if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+        for (c=0; c<nc; c++) {ierr = MatSORColorSweep_SeqAIJ(A,b,x,c,MAT_SOR_COLOR_RELAX);CHKERRQ(ierr);}
+        ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+      }
+      if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+        for (c=nc-1; c>=0; c--) {ierr = MatSORColorSweep_SeqAIJ(A,b,x,c,MAT_SOR_COLOR_RELAX);CHKERRQ(ierr);}
+        ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+      }
+    }
+  }
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #include <../src/mat/impls/aij/seq/ftn-kernels/frelax.h>
 #undef __FUNCT__
 #define __FUNCT__ "MatSOR_SeqAIJ"
@@ -1477,6 +1658,10 @@ PetscErrorCode MatSOR_SeqAIJ(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscR
   if (!a->idiagvalid) {ierr = MatInvertDiagonal_SeqAIJ(A,omega,fshift);CHKERRQ(ierr);}
   a->fshift = fshift;
   a->omega  = omega;
+  if (a->sorcolor.use) {
+    ierr = MatSOR_SeqAIJ_Multicolor(A,bb,flag,its,xx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
 
   diag = a->diag;
   t     = a->ssor_work;
@@ -1691,7 +1876,8 @@ PetscErrorCode MatZeroRows_SeqAIJ(Mat A,PetscInt N,const PetscInt rows[],PetscSc
         a->ilen[rows[i]] = 0;
       }
     }
-    A->same_nonzero = PETSC_FALSE;
+    A->same_nonzero   = PETSC_FALSE;
+    a->sorcolor.valid = PETSC_FALSE;
   }
   ierr = MatAssemblyEnd_SeqAIJ(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -3413,7 +3599,8 @@ PetscErrorCode  MatRetrieveValues(Mat mat)
 
    Options Database Keys:
 +  -mat_no_inode  - Do not use inodes
--  -mat_inode_limit <limit> - Sets inode limit (max limit=5)
+.  -mat_inode_limit <limit> - Sets inode limit (max limit=5)
+-  -mat_sor_multicolor - Use a multicolor ordering in MatSOR(), the rows of each color are relaxed in parallel by the threads
 
    Level: intermediate
 
@@ -3477,6 +3664,7 @@ PetscErrorCode  MatCreateSeqAIJ(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,
    Options Database Keys:
 +  -mat_no_inode  - Do not use inodes
 .  -mat_inode_limit <limit> - Sets inode limit (max limit=5)
+.  -mat_sor_multicolor - Use a multicolor ordering in MatSOR(), the rows of each color are relaxed in parallel by the threads
 -  -mat_aij_oneindex - Internally use indexing starting at 1
         rather than 0.  Note that when calling MatSetValues(),
         the user still MUST index entries starting at 0!
@@ -3568,6 +3756,8 @@ PetscErrorCode  MatSeqAIJSetPreallocation_SeqAIJ(Mat B,PetscInt nz,const PetscIn
   b->nz                = 0;
   b->maxnz             = nz;
   B->info.nz_unneeded  = (double)b->maxnz;
+  b->sorcolor.valid    = PETSC_FALSE;
+  b->solvelevels.valid = PETSC_FALSE;
   if (realalloc) {ierr = MatSetOption(B,MAT_NEW_NONZERO_ALLOCATION_ERR,PETSC_TRUE);CHKERRQ(ierr);}
   PetscFunctionReturn(0);
 }
@@ -3746,11 +3936,17 @@ PetscErrorCode MatMatMult_SeqDense_SeqAIJ(Mat A,Mat B,MatReuse scall,PetscReal f
    based on compressed sparse row format.
 
    Options Database Keys:
-. -mat_type seqaij - sets the matrix type to "seqaij" during a call to MatSetFromOptions()
++ -mat_type seqaij - sets the matrix type to "seqaij" during a call to MatSetFromOptions()
+- -mat_sor_multicolor - use a multicolor ordering in MatSOR() so that PCSOR and the multigrid smoothers run on all the threads
+
+   Notes:
+   With -mat_sor_multicolor the rows are ordered by the colors of MatGetColoring() with MATCOLORINGSL, computed the first time
+   MatSOR() is called and kept until the nonzero structure changes. The sweeps are those of SOR on the symmetrically permuted
+   matrix, so the iterates differ from those of the natural ordering.
 
   Level: beginner
 
-.seealso: MatCreateSeqAIJ(), MatSetFromOptions(), MatSetType(), MatCreate(), MatType
+.seealso: MatCreateSeqAIJ(), MatSetFromOptions(), MatSetType(), MatCreate(), MatType, MatSOR(), PCSOR
 M*/
 
 /*MC
@@ -3765,7 +3961,7 @@ M*/
    Options Database Keys:
 . -mat_type aij - sets the matrix type to "aij" during a call to MatSetFromOptions()
 
-  Developer Notes: Subclasses include MATAIJCUSP, MATAIJPERM, MATAIJCRL, and also automatically switches over to use inodes when
+  Developer Notes: Subclasses include MATAIJCUSP, MATAIJPERM, MATAIJCRL, MATSELL, and also automatically switches over to use inodes when
    enough exist.
 
   Level: beginner
@@ -3798,8 +3994,10 @@ extern PetscErrorCode MatGetFactor_seqaij_pastix(Mat,MatFactorType,Mat*);
 extern PetscErrorCode MatGetFactor_seqaij_essl(Mat,MatFactorType,Mat *);
 #endif
 extern PetscErrorCode  MatConvert_SeqAIJ_SeqAIJCRL(Mat,MatType,MatReuse,Mat*);
+extern PetscErrorCode  MatConvert_SeqAIJ_SeqSELL(Mat,MatType,MatReuse,Mat*);
 extern PetscErrorCode  MatGetFactor_seqaij_petsc(Mat,MatFactorType,Mat*);
 extern PetscErrorCode  MatGetFactor_seqaij_bas(Mat,MatFactorType,Mat*);
+extern PetscErrorCode  MatGetFactor_seqaij_etree(Mat,MatFactorType,Mat*);
 extern PetscErrorCode  MatGetFactorAvailable_seqaij_petsc(Mat,MatFactorType,PetscBool  *);
 #if defined(PETSC_HAVE_MUMPS)
 extern PetscErrorCode  MatGetFactor_aij_mumps(Mat,MatFactorType,Mat*);
@@ -3959,6 +4157,7 @@ PetscErrorCode  MatCreate_SeqAIJ(Mat B)
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatGetFactor_petsc_C","MatGetFactor_seqaij_petsc",MatGetFactor_seqaij_petsc);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatGetFactorAvailable_petsc_C","MatGetFactorAvailable_seqaij_petsc",MatGetFactorAvailable_seqaij_petsc);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatGetFactor_bas_C","MatGetFactor_seqaij_bas",MatGetFactor_seqaij_bas);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatGetFactor_etree_C","MatGetFactor_seqaij_etree",MatGetFactor_seqaij_etree);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatSeqAIJSetColumnIndices_C","MatSeqAIJSetColumnIndices_SeqAIJ",MatSeqAIJSetColumnIndices_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatStoreValues_C","MatStoreValues_SeqAIJ",MatStoreValues_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatRetrieveValues_C","MatRetrieveValues_SeqAIJ",MatRetrieveValues_SeqAIJ);CHKERRQ(ierr);
@@ -3966,6 +4165,7 @@ PetscErrorCode  MatCreate_SeqAIJ(Mat B)
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatConvert_seqaij_seqbaij_C","MatConvert_SeqAIJ_SeqBAIJ",MatConvert_SeqAIJ_SeqBAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatConvert_seqaij_seqaijperm_C","MatConvert_SeqAIJ_SeqAIJPERM",MatConvert_SeqAIJ_SeqAIJPERM);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatConvert_seqaij_seqaijcrl_C","MatConvert_SeqAIJ_SeqAIJCRL",MatConvert_SeqAIJ_SeqAIJCRL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatConvert_seqaij_seqsell_C","MatConvert_SeqAIJ_SeqSELL",MatConvert_SeqAIJ_SeqSELL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatIsTranspose_C","MatIsTranspose_SeqAIJ",MatIsTranspose_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatIsHermitianTranspose_C","MatIsHermitianTranspose_SeqAIJ",MatIsTranspose_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)B,"MatSeqAIJSetPreallocation_C","MatSeqAIJSetPreallocation_SeqAIJ",MatSeqAIJSetPreallocation_SeqAIJ);CHKERRQ(ierr);
@@ -4524,6 +4724,7 @@ void PETSC_STDCALL matsetvaluesseqaij_(Mat *AA,PetscInt *mm,const PetscInt im[],
       if (nonew == -1) SETERRABORT(((PetscObject)A)->comm,PETSC_ERR_ARG_OUTOFRANGE,"Inserting a new nonzero in the matrix");
       MatSeqXAIJReallocateAIJ(A,A->rmap->n,1,nrow,row,col,rmax,aa,ai,aj,rp,ap,imax,nonew,MatScalar);
       N = nrow++ - 1; a->nz++; high++;
+      a->sorcolor.valid = PETSC_FALSE;
       /* shift up all the later entries in this row */
       for (ii=N; ii>=i; ii--) {
         rp[ii+1] = rp[ii];
@@ -4,6 +4,23 @@
 
 #include <petsc-private/matimpl.h>
 
+/*
+    Level schedule of the triangular solves of a factor, -mat_solve_levels. The rows of a level depend only on rows
+    of earlier levels, so the rows of each level are solved in parallel by the threads.
+*/
+typedef struct {
+  PetscBool   use;                           /* use the level schedule, set with -mat_solve_levels */
+  PetscBool   valid;                         /* the levels match the nonzero structure of the factor */
+  PetscBool   natural;                       /* the factor has no row and column permutations */
+  PetscInt    nthreads;
+  PetscInt    nlevels[2];                    /* levels of the forward [0] and backward [1] solves */
+  PetscInt    *start[2];                     /* rows of level l are rows[start[l]] ... rows[start[l+1]-1], in increasing order */
+  PetscInt    *rows[2];
+  PetscInt    *tstarts[2];                   /* the rows of level l handled by thread t start at tstarts[l*(nthreads+1)+t] */
+  PetscInt    *ti,*tj,*tv;                   /* the factor by columns for the forward solve with U^T of SBAIJ: rows and locations in a */
+  PetscScalar *work;                         /* a block of work space for each thread */
+} Mat_SeqAIJ_SolveLevels;
+
 /*
     Struct header shared by SeqAIJ, SeqBAIJ and SeqSBAIJ matrix formats
 */
@@ -35,6 +52,7 @@
   PetscScalar       *solve_work;      /* work space used in MatSolve */                    \
   IS                row, col, icol;   /* index sets, used for reorderings */ \
   PetscBool         pivotinblocks;    /* pivot inside factorization of each diagonal block */ \
+  Mat_SeqAIJ_SolveLevels solvelevels; /* level schedule of the triangular solves of a factor */ \
   Mat               parent             /* set if this matrix was formed with MatDuplicate(...,MAT_SHARE_NONZERO_PATTERN,....);
                                          means that this shares some data structures with the parent including diag, ilen, imax, i, j */
 
@@ -43,6 +61,8 @@ typedef struct {
   Mat                       Bt_den;  /* dense matrix of B^T */
   Mat                       ABt_den; /* dense matrix of A*B^T */
   PetscBool                 usecoloring;
+  Mat                       Bt;      /* B^T with values for the threaded product A*Bt */
+  PetscInt                  *btperm; /* position in Bt of each nonzero of B */
   PetscErrorCode (*destroy)(Mat);
 } Mat_MatMatTransMult;
 
@@ -86,6 +106,18 @@ typedef struct {
   PetscBool  checked;                       /* if inodes have been checked for */
 } Mat_SeqAIJ_Inode;
 
+/* Multicolor ordering used by MatSOR_SeqAIJ(), rows of the same color are not coupled and are relaxed in parallel */
+typedef struct {
+  PetscBool  use;                           /* use the multicolor ordering, set with -mat_sor_multicolor */
+  PetscBool  valid;                         /* the ordering matches the nonzero structure */
+  PetscInt   ncolors;
+  PetscInt   *start;                        /* rows of color c are rows[start[c]] ... rows[start[c+1]-1] */
+  PetscInt   *rows;
+  PetscInt   *color;                        /* color of each row */
+  PetscInt   nthreads;
+  PetscInt   *tstarts;                      /* the rows of color c handled by thread t start at tstarts[c*(nthreads+1)+t] */
+} Mat_SeqAIJ_SORColor;
+
 extern PetscErrorCode MatView_SeqAIJ_Inode(Mat,PetscViewer);
 extern PetscErrorCode MatAssemblyEnd_SeqAIJ_Inode(Mat,MatAssemblyType);
 extern PetscErrorCode MatDestroy_SeqAIJ_Inode(Mat);
@@ -95,6 +127,10 @@ extern PetscErrorCode MatDuplicate_SeqAIJ_Inode(Mat,MatDuplicateOption,Mat*);
 extern PetscErrorCode MatDuplicateNoCreate_SeqAIJ(Mat,Mat,MatDuplicateOption,PetscBool );
 extern PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode_inplace(Mat,Mat,const MatFactorInfo*);
 extern PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode(Mat,Mat,const MatFactorInfo*);
+extern PetscErrorCode MatSolveLevelsCreate_Private(PetscInt,const PetscInt*,const PetscInt*,const PetscInt*,PetscBool,PetscInt,PetscInt*,PetscInt**,PetscInt**,PetscInt**);
+extern PetscErrorCode MatSolveLevelsDestroy_Private(Mat_SeqAIJ_SolveLevels*);
+extern PetscErrorCode MatSolveLevelsSetFromOptions_Private(Mat,Mat,Mat_SeqAIJ_SolveLevels*);
+extern PetscErrorCode MatFactorSetUpSolveLevels_SeqAIJ(Mat,Mat);
 
 typedef struct {
   SEQAIJHEADER(MatScalar);
@@ -106,6 +142,7 @@ typedef struct {
   PetscScalar      *ibdiag;                   /* inverses of block diagonals */
   PetscBool        ibdiagvalid;               /* inverses of block diagonals are valid. */
   PetscScalar      fshift,omega;                   /* last used omega and fshift */
+  Mat_SeqAIJ_SORColor sorcolor;              /* multicolor ordering for MatSOR() */
 
   ISColoring       coloring;                  /* set with MatADSetColoring() used by MatADSetValues() */
 
@@ -236,8 +273,10 @@ extern PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Scalable(Mat,Mat,PetscRea
 extern PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Scalable_fast(Mat,Mat,PetscReal,Mat*);
 extern PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Heap(Mat,Mat,PetscReal,Mat*);
 extern PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_BTHeap(Mat,Mat,PetscReal,Mat*);
+extern PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson(Mat,Mat,PetscReal,Mat*);
 extern PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ(Mat,Mat,Mat);
 extern PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Scalable(Mat,Mat,Mat);
+extern PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Gustavson(Mat,Mat,Mat);
 
 extern PetscErrorCode MatPtAP_SeqAIJ_SeqAIJ(Mat,Mat,MatReuse,PetscReal,Mat*);
 extern PetscErrorCode MatPtAPSymbolic_SeqAIJ_SeqAIJ(Mat,Mat,PetscReal,Mat*);
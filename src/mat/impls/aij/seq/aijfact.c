@@ -3,6 +3,7 @@
 #include <../src/mat/impls/sbaij/seq/sbaij.h>
 #include <petscbt.h>
 #include <../src/mat/utils/freespace.h>
+#include <petscthreadcomm.h>
 
 EXTERN_C_BEGIN
 #undef __FUNCT__
@@ -621,6 +622,7 @@ PetscErrorCode MatLUFactorNumeric_SeqAIJ(Mat B,Mat A,const MatFactorInfo *info)
     }
   }
   ierr = Mat_CheckInode_FactorLU(C,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatFactorSetUpSolveLevels_SeqAIJ(C,A);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -1642,6 +1644,7 @@ PetscErrorCode MatILUFactorSymbolic_SeqAIJ_ilu0(Mat fact,Mat A,IS isrow,IS iscol
   ierr = ISInvertPermutation(iscol,PETSC_DECIDE,&isicol);CHKERRQ(ierr);
   ierr = MatDuplicateNoCreate_SeqAIJ(fact,A,MAT_DO_NOT_COPY_VALUES,PETSC_FALSE);CHKERRQ(ierr);
   b    = (Mat_SeqAIJ*)(fact)->data;
+  b->solvelevels.valid = PETSC_FALSE;
 
   /* allocate matrix arrays for new data structure */
   ierr = PetscMalloc3(ai[n]+1,PetscScalar,&b->a,ai[n]+1,PetscInt,&b->j,n+1,PetscInt,&b->i);CHKERRQ(ierr);
@@ -2210,6 +2213,7 @@ PetscErrorCode MatCholeskyFactorNumeric_SeqAIJ(Mat B,Mat A,const MatFactorInfo *
     B->ops->forwardsolve    = MatForwardSolve_SeqSBAIJ_1;
     B->ops->backwardsolve   = MatBackwardSolve_SeqSBAIJ_1;
   }
+  ierr = MatFactorSetUpSolveLevels_SeqSBAIJ_1(B,A);CHKERRQ(ierr);
 
   C->assembled    = PETSC_TRUE;
   C->preallocated = PETSC_TRUE;
@@ -3222,6 +3226,233 @@ PetscErrorCode MatSolve_SeqAIJ(Mat A,Vec bb,Vec xx)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "MatSolveLevelsCreate_Private"
+/*
+   MatSolveLevelsCreate_Private - Computes the levels of a triangular solve and splits the rows of each level among the threads
+
+   Input Parameters:
++  n - number of (block) rows
+.  rs,re - the rows that row i depends on are j[rs[i]] ... j[re[i]-1]
+.  j - the column indices
+.  forward - rows depend on earlier rows (forward solve) or on later rows (backward solve)
+-  nt - number of threads
+
+   Output Parameters:
++  nlevels - number of levels
+.  start - the rows of level l are rows[start[l]] ... rows[start[l+1]-1]
+.  rows - the rows ordered by level, in increasing order within a level
+-  tstarts - the rows of level l handled by thread t start at tstarts[l*(nt+1)+t], balanced by the number of nonzeros
+
+   The arrays are obtained with PetscMalloc3() and freed with PetscFree3(start,rows,tstarts).
+*/
+PetscErrorCode MatSolveLevelsCreate_Private(PetscInt n,const PetscInt *rs,const PetscInt *re,const PetscInt *j,PetscBool forward,PetscInt nt,PetscInt *nlevels,PetscInt **start,PetscInt **rows,PetscInt **tstarts)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,k,l,t,nl = 0,*level,nz,cnt;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc((n+1)*sizeof(PetscInt),&level);CHKERRQ(ierr);
+  for (k=0; k<n; k++) {
+    i = forward ? k : n-1-k;
+    l = 0;
+    for (t=rs[i]; t<re[i]; t++) l = PetscMax(l,level[j[t]]+1);
+    level[i] = l;
+    nl       = PetscMax(nl,l+1);
+  }
+  ierr = PetscMalloc3(nl+1,PetscInt,start,n,PetscInt,rows,nl*(nt+1),PetscInt,tstarts);CHKERRQ(ierr);
+
+  /* sort the rows by level, keeping their order within a level */
+  ierr = PetscMemzero(*start,(nl+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (i=0; i<n; i++) (*start)[level[i]+1]++;
+  for (l=0; l<nl; l++) (*start)[l+1] += (*start)[l];
+  for (i=0; i<n; i++) (*rows)[(*start)[level[i]]++] = i;
+  for (l=nl; l>0; l--) (*start)[l] = (*start)[l-1];
+  (*start)[0] = 0;
+
+  for (l=0; l<nl; l++) {
+    PetscInt *ts = *tstarts + l*(nt+1);
+    nz = 0;
+    for (k=(*start)[l]; k<(*start)[l+1]; k++) nz += re[(*rows)[k]] - rs[(*rows)[k]] + 1;
+    ts[0] = (*start)[l];
+    cnt   = 0;
+    for (t=1,k=(*start)[l]; t<nt; t++) {
+      while (k < (*start)[l+1] && (PetscReal)cnt*nt < (PetscReal)t*nz) {cnt += re[(*rows)[k]] - rs[(*rows)[k]] + 1; k++;}
+      ts[t] = k;
+    }
+    ts[nt] = (*start)[l+1];
+  }
+  ierr = PetscFree(level);CHKERRQ(ierr);
+  *nlevels = nl;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolveLevelsDestroy_Private"
+PetscErrorCode MatSolveLevelsDestroy_Private(Mat_SeqAIJ_SolveLevels *sl)
+{
+  PetscErrorCode ierr;
+  PetscInt       d;
+
+  PetscFunctionBegin;
+  for (d=0; d<2; d++) {
+    ierr = PetscFree3(sl->start[d],sl->rows[d],sl->tstarts[d]);CHKERRQ(ierr);
+    sl->nlevels[d] = 0;
+  }
+  ierr = PetscFree3(sl->ti,sl->tj,sl->tv);CHKERRQ(ierr);
+  ierr = PetscFree(sl->work);CHKERRQ(ierr);
+  sl->valid = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolveLevelsSetFromOptions_Private"
+/*
+   Checks -mat_solve_levels for the matrix A being factored into fact, and whether the factor is in the natural ordering
+*/
+PetscErrorCode MatSolveLevelsSetFromOptions_Private(Mat fact,Mat A,Mat_SeqAIJ_SolveLevels *sl)
+{
+  PetscErrorCode ierr;
+  Mat_SeqAIJ     *b = (Mat_SeqAIJ*)fact->data;
+  PetscBool      row_identity = PETSC_TRUE,col_identity = PETSC_TRUE;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsGetBool(((PetscObject)A)->prefix,"-mat_solve_levels",&sl->use,PETSC_NULL);CHKERRQ(ierr);
+  if (!sl->use) PetscFunctionReturn(0);
+  if (b->row) {ierr = ISIdentity(b->row,&row_identity);CHKERRQ(ierr);}
+  if (b->col) {ierr = ISIdentity(b->col,&col_identity);CHKERRQ(ierr);}
+  sl->natural  = (PetscBool)(row_identity && col_identity);
+  sl->nthreads = 1;
+#if defined(PETSC_THREADCOMM_ACTIVE)
+  ierr = PetscThreadCommGetNThreads(((PetscObject)fact)->comm,&sl->nthreads);CHKERRQ(ierr);
+#endif
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolveLevels_SeqAIJ_Kernel"
+/*
+   Solves the rows of one level handled by thread_id: the forward solve with L into t, or the backward solve with U in t,
+   copying the result to x in the column ordering when c is given
+*/
+PetscErrorCode MatSolveLevels_SeqAIJ_Kernel(PetscInt thread_id,Mat A,const PetscScalar *b,PetscScalar *t,PetscScalar *x,const PetscInt *r,const PetscInt *c,PetscInt *dir,PetscInt *level)
+{
+  Mat_SeqAIJ             *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJ_SolveLevels *sl = &a->solvelevels;
+  const PetscInt         *ai = a->i,*aj = a->j,*adiag = a->diag,*rows = sl->rows[*dir],*ts = sl->tstarts[*dir] + (*level)*(sl->nthreads+1),*vi;
+  const MatScalar        *aa = a->a,*v;
+  PetscScalar            sum;
+  PetscInt               i,k,nz;
+
+  if (*dir == 0) {
+    for (k=ts[thread_id]; k<ts[thread_id+1]; k++) {
+      i   = rows[k];
+      nz  = ai[i+1] - ai[i];
+      v   = aa + ai[i];
+      vi  = aj + ai[i];
+      sum = r ? b[r[i]] : b[i];
+      PetscSparseDenseMinusDot(sum,t,v,vi,nz);
+      t[i] = sum;
+    }
+  } else {
+    for (k=ts[thread_id]; k<ts[thread_id+1]; k++) {
+      i   = rows[k];
+      v   = aa + adiag[i+1] + 1;
+      vi  = aj + adiag[i+1] + 1;
+      nz  = adiag[i] - adiag[i+1] - 1;
+      sum = t[i];
+      PetscSparseDenseMinusDot(sum,t,v,vi,nz);
+      t[i] = sum*v[nz]; /* v[nz] = aa[adiag[i]] */
+      if (c) x[c[i]] = t[i];
+    }
+  }
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolve_SeqAIJ_Levels"
+/*
+   MatSolve_SeqAIJ() with the rows of each level of the forward and backward solves computed by all the threads. Each
+   row is computed as in MatSolve_SeqAIJ(), so the results are the same.
+*/
+PetscErrorCode MatSolve_SeqAIJ_Levels(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ             *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJ_SolveLevels *sl = &a->solvelevels;
+  PetscErrorCode         ierr;
+  PetscInt               n = A->rmap->n,l,dir;
+  const PetscInt         *r = PETSC_NULL,*c = PETSC_NULL;
+  PetscScalar            *x,*t;
+  const PetscScalar      *b;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  if (sl->natural) {
+    t = x;
+  } else {
+    t    = a->solve_work;
+    ierr = ISGetIndices(a->row,&r);CHKERRQ(ierr);
+    ierr = ISGetIndices(a->col,&c);CHKERRQ(ierr);
+  }
+
+  for (dir=0; dir<2; dir++) {
+    for (l=0; l<sl->nlevels[dir]; l++) {
+#if defined(PETSC_THREADCOMM_ACTIVE)
+      ierr = PetscThreadCommRunKernel(((PetscObject)A)->comm,(PetscThreadKernel)MatSolveLevels_SeqAIJ_Kernel,8,A,b,t,x,r,c,&dir,&l);CHKERRQ(ierr);
+      ierr = PetscThreadCommBarrier(((PetscObject)A)->comm);CHKERRQ(ierr);
+#else
+      ierr = MatSolveLevels_SeqAIJ_Kernel(0,A,b,t,x,r,c,&dir,&l);CHKERRQ(ierr);
+#endif
+    }
+  }
+
+  if (!sl->natural) {
+    ierr = ISRestoreIndices(a->row,&r);CHKERRQ(ierr);
+    ierr = ISRestoreIndices(a->col,&c);CHKERRQ(ierr);
+  }
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*a->nz - A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatFactorSetUpSolveLevels_SeqAIJ"
+/*
+   Called at the end of the numeric LU and ILU factorizations, switches the solve to MatSolve_SeqAIJ_Levels() with
+   -mat_solve_levels. The levels are computed once for the nonzero structure of the factor.
+*/
+PetscErrorCode MatFactorSetUpSolveLevels_SeqAIJ(Mat fact,Mat A)
+{
+  Mat_SeqAIJ             *b = (Mat_SeqAIJ*)fact->data;
+  Mat_SeqAIJ_SolveLevels *sl = &b->solvelevels;
+  PetscErrorCode         ierr;
+  PetscInt               n = fact->rmap->n,i,*rs,*re;
+
+  PetscFunctionBegin;
+  ierr = MatSolveLevelsSetFromOptions_Private(fact,A,sl);CHKERRQ(ierr);
+  if (!sl->use) PetscFunctionReturn(0);
+  if (!sl->valid) {
+    ierr = MatSolveLevelsDestroy_Private(sl);CHKERRQ(ierr);
+    ierr = MatSolveLevelsCreate_Private(n,b->i,b->i+1,b->j,PETSC_TRUE,sl->nthreads,&sl->nlevels[0],&sl->start[0],&sl->rows[0],&sl->tstarts[0]);CHKERRQ(ierr);
+    /* U is stored from the last row to the first, row i at adiag[i+1]+1 ... adiag[i]-1 followed by its inverse diagonal */
+    ierr = PetscMalloc2(n,PetscInt,&rs,n,PetscInt,&re);CHKERRQ(ierr);
+    for (i=0; i<n; i++) {
+      rs[i] = b->diag[i+1] + 1;
+      re[i] = b->diag[i];
+    }
+    ierr = MatSolveLevelsCreate_Private(n,rs,re,b->j,PETSC_FALSE,sl->nthreads,&sl->nlevels[1],&sl->start[1],&sl->rows[1],&sl->tstarts[1]);CHKERRQ(ierr);
+    ierr = PetscFree2(rs,re);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory(fact,2*(2*n+(sl->nlevels[0]+sl->nlevels[1])*(sl->nthreads+2))*sizeof(PetscInt));CHKERRQ(ierr);
+    sl->valid = PETSC_TRUE;
+    ierr = PetscInfo4(fact,"Level scheduled triangular solves with %D and %D levels for %D rows on %D threads\n",sl->nlevels[0],sl->nlevels[1],n,sl->nthreads);CHKERRQ(ierr);
+  }
+  fact->ops->solve = MatSolve_SeqAIJ_Levels;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "MatILUDTFactor_SeqAIJ"
 /*
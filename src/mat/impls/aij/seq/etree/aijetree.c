@@ -0,0 +1,588 @@
+
+/*
+    Threaded supernodal numeric LU and ILU(k) factorization of SeqAIJ matrices that factors the independent subtrees of
+    the elimination tree of the factor concurrently on the threads of the matrix's PetscThreadComm.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+#include <petscthreadcomm.h>
+#include <petscblaslapack.h>
+
+EXTERN_C_BEGIN
+extern PetscErrorCode MatGetFactor_seqaij_petsc(Mat,MatFactorType,Mat*);
+EXTERN_C_END
+
+/*MC
+  MATSOLVERETREE - LU and ILU(k) of SeqAIJ matrices with the numeric factorization spread over the threads of the
+  matrix's PetscThreadComm
+
+  Works with MATSEQAIJ matrices; the factor is the same as with MATSOLVERPETSC.
+
+  The rows of the factor are grouped into supernodes, consecutive rows with the same nonzero structure, and the
+  supernodes into the elimination tree of the factor. Contiguous pieces of the postorder of the tree, of equal work, are
+  factored by the threads independently; the supernodes that depend on the pieces of other threads are then factored
+  level by level. The rows of a supernode are gathered into a dense panel, which is updated by each supernode it
+  depends on with BLAS trsm and gemm, factored and scattered back into the factor. Supernodes of a single row are
+  factored with the sparse row kernel of MatLUFactorNumeric_SeqAIJ().
+
+  When a pivot is small the factorization is repeated sequentially, which applies the shift selected with
+  -pc_factor_shift_type or reports the zero pivot.
+
+  Options Database Keys:
++ -pc_factor_mat_solver_package etree - select this solver
+. -threadcomm_nthreads <n> - number of threads
+. -mat_etree_supernode_size <size> - the largest number of rows of a supernode, 32 by default
+- -info - reports the number of supernodes and levels and the part of the work in independent subtrees
+
+  Level: intermediate
+
+.seealso: PCFactorSetMatSolverPackage(), MatSolverPackage, MATSOLVERPETSC, PetscThreadCommGetNThreads()
+
+M*/
+
+typedef struct {
+  PetscInt       nthreads;
+  PetscInt       nunits;                /* supernodes; supernode u is rows ustart[u] ... ustart[u+1]-1 */
+  PetscInt       *ustart,*unit;         /* unit[i] is the supernode of row i */
+  PetscInt       *cunits,*cstart;       /* supernodes factored independently by thread t: cunits[cstart[t]] ... cunits[cstart[t+1]-1] */
+  PetscInt       nlevels;               /* levels of the remaining supernodes */
+  PetscInt       *tunits,*tstarts;      /* supernodes of level l for thread t start at tunits[tstarts[l*(nthreads+1)+t]] */
+  MatScalar      *rtmp;                 /* a dense row for each thread */
+  PetscInt       *smallpivot;           /* first row of each thread with a small pivot, or -1 */
+  PetscLogDouble *flops;
+  PetscInt       maxsize,maxext;        /* rows of the largest supernode, largest number of columns of U beyond a supernode */
+  PetscInt       panelsize;             /* length of the dense workspace of each thread */
+  PetscInt       *colmap;               /* for each thread, the column of the panel of each column of the factor, or -1 */
+  MatScalar      *panel;                /* for each thread, the panel, the diagonal block and the U beyond a supernode it
+                                           depends on, and their product */
+} Mat_SeqAIJ_ETree;
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscContainerDestroy_Mat_SeqAIJ_ETree"
+static PetscErrorCode PetscContainerDestroy_Mat_SeqAIJ_ETree(void *ptr)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJ_ETree *et = (Mat_SeqAIJ_ETree*)ptr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree3(et->ustart,et->cunits,et->cstart);CHKERRQ(ierr);
+  ierr = PetscFree2(et->tunits,et->tstarts);CHKERRQ(ierr);
+  ierr = PetscFree3(et->rtmp,et->smallpivot,et->flops);CHKERRQ(ierr);
+  ierr = PetscFree(et->unit);CHKERRQ(ierr);
+  ierr = PetscFree2(et->colmap,et->panel);CHKERRQ(ierr);
+  ierr = PetscFree(et);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* whether row i+1 of the factor has the nonzero structure of row i, that is column i+1 moved from U to L */
+static PetscBool MatSeqAIJETreeSameStructure_Private(const PetscInt *bi,const PetscInt *bj,const PetscInt *bdiag,PetscInt i)
+{
+  const PetscInt nL = bi[i+1] - bi[i],nU = bdiag[i] - bdiag[i+1] - 1,*L0 = bj + bi[i],*L1 = bj + bi[i+1];
+  const PetscInt *U0 = bj + bdiag[i+1] + 1,*U1 = bj + bdiag[i+2] + 1;
+  PetscInt       j;
+
+  if (bi[i+2] - bi[i+1] != nL + 1 || bdiag[i+1] - bdiag[i+2] - 1 != nU - 1) return PETSC_FALSE;
+  if (L1[nL] != i || U0[0] != i+1) return PETSC_FALSE;
+  for (j=0; j<nL; j++) if (L1[j] != L0[j]) return PETSC_FALSE;
+  for (j=0; j<nU-1; j++) if (U1[j] != U0[j+1]) return PETSC_FALSE;
+  return PETSC_TRUE;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJETreeSetUp_Private"
+/*
+   Builds the supernodes and the schedule of the numeric factorization from the nonzero structure of the factor B.
+   Supernode v depends on supernode u when a row of v has a nonzero of L in a column of u; the parent of u in the
+   elimination tree is the first supernode that depends on it.
+*/
+static PetscErrorCode MatSeqAIJETreeSetUp_Private(Mat B)
+{
+  Mat_SeqAIJ       *b = (Mat_SeqAIJ*)B->data;
+  PetscErrorCode   ierr;
+  Mat_SeqAIJ_ETree *et;
+  PetscContainer   container;
+  const PetscInt   *bi = b->i,*bj = b->j,*bdiag = b->diag;
+  PetscInt         n = B->rmap->n,nt = 1,nu,u,d,i,j,k,l,t,p,sp,*unit,*parent,*child,*sibling,*next,*stack,*order,*chunk,*level,*lstart,cnt;
+  PetscInt         maxsize = 32,s,ext,maxpanel = 0;
+  PetscBool        *local;
+  PetscReal        *work,total = 0.0,cum,localwork = 0.0,lwork;
+
+  PetscFunctionBegin;
+#if defined(PETSC_THREADCOMM_ACTIVE)
+  ierr = PetscThreadCommGetNThreads(((PetscObject)B)->comm,&nt);CHKERRQ(ierr);
+#endif
+  ierr = PetscOptionsGetInt(((PetscObject)B)->prefix,"-mat_etree_supernode_size",&maxsize,PETSC_NULL);CHKERRQ(ierr);
+  if (maxsize < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Supernode size %D must be positive",maxsize);
+  ierr = PetscNew(Mat_SeqAIJ_ETree,&et);CHKERRQ(ierr);
+  et->nthreads = nt;
+
+  /* the supernodes, consecutive rows with the same nonzero structure */
+  ierr = PetscMalloc(n*sizeof(PetscInt),&et->unit);CHKERRQ(ierr);
+  unit = et->unit;
+  for (i=0,nu=0; i<n; i=j,nu++) {
+    for (j=i+1; j<n && j-i<maxsize && MatSeqAIJETreeSameStructure_Private(bi,bj,bdiag,j-1); j++) ;
+    for (k=i; k<j; k++) unit[k] = nu;
+  }
+  ierr = PetscMalloc3(nu+1,PetscInt,&et->ustart,nu,PetscInt,&et->cunits,nt+1,PetscInt,&et->cstart);CHKERRQ(ierr);
+  et->nunits    = nu;
+  et->ustart[0] = 0;
+  for (i=0; i<n; i++) et->ustart[unit[i]+1] = i+1;
+
+  /* the dense workspace: a panel has the columns of L of its first row, the diagonal block and the columns of U of its
+     last row; the rows of U of a supernode it depends on are gathered into blocks of at most maxsize by maxext */
+  et->maxsize = 0;
+  et->maxext  = 0;
+  for (u=0; u<nu; u++) {
+    s           = et->ustart[u+1] - et->ustart[u];
+    ext         = bdiag[et->ustart[u+1]-1] - bdiag[et->ustart[u+1]] - 1;
+    et->maxsize = PetscMax(et->maxsize,s);
+    et->maxext  = PetscMax(et->maxext,ext);
+    if (s > 1) maxpanel = PetscMax(maxpanel,s*(bi[et->ustart[u]+1] - bi[et->ustart[u]] + s + ext));
+  }
+  et->panelsize = maxpanel ? maxpanel + et->maxsize*et->maxsize + 2*et->maxsize*et->maxext : 0;
+  if (et->panelsize > PETSC_BLAS_INT_MAX) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Dense panels too large for BLAS, use a smaller -mat_etree_supernode_size");
+  ierr = PetscMalloc2(nt*n,PetscInt,&et->colmap,nt*et->panelsize,MatScalar,&et->panel);CHKERRQ(ierr);
+  for (i=0; i<nt*n; i++) et->colmap[i] = -1;
+
+  ierr = PetscMalloc6(nu,PetscInt,&parent,nu,PetscInt,&child,nu,PetscInt,&sibling,nu,PetscInt,&next,nu,PetscInt,&stack,nu,PetscInt,&order);CHKERRQ(ierr);
+  ierr = PetscMalloc5(nu,PetscInt,&chunk,nu,PetscInt,&level,nu,PetscBool,&local,nu,PetscReal,&work,nu+1,PetscInt,&lstart);CHKERRQ(ierr);
+
+  /* the elimination tree and the work of each supernode, counted as in the sparse row factorization */
+  for (u=0; u<nu; u++) {
+    parent[u] = -1;
+    work[u]   = 0.0;
+    for (i=et->ustart[u]; i<et->ustart[u+1]; i++) {
+      work[u] += 1 + (bi[i+1] - bi[i]) + (bdiag[i] - bdiag[i+1]);
+      for (j=bi[i]; j<bi[i+1]; j++) {
+        k        = bj[j];
+        work[u] += 2*(bdiag[k] - bdiag[k+1] - 1);
+        d        = unit[k];
+        if (d != u && parent[d] < 0) parent[d] = u;
+      }
+    }
+    total += work[u];
+  }
+  for (u=0; u<nu; u++) child[u] = -1;
+  for (u=nu-1; u>=0; u--) {
+    if (parent[u] >= 0) {
+      sibling[u]       = child[parent[u]];
+      child[parent[u]] = u;
+    }
+  }
+
+  /* postorder of the tree, in which each subtree is contiguous */
+  ierr = PetscMemcpy(next,child,nu*sizeof(PetscInt));CHKERRQ(ierr);
+  for (u=0,p=0; u<nu; u++) {
+    if (parent[u] >= 0) continue;
+    sp          = 0;
+    stack[sp++] = u;
+    while (sp) {
+      d = stack[sp-1];
+      if (next[d] >= 0) {
+        stack[sp++] = next[d];
+        next[d]     = sibling[next[d]];
+      } else {
+        order[p++] = d;
+        sp--;
+      }
+    }
+  }
+
+  /* pieces of the postorder with the same work; a supernode is factored independently by the thread of its piece
+     when all supernodes it depends on are */
+  for (p=0,cum=0.0; p<nu; p++) {
+    u        = order[p];
+    chunk[u] = PetscMin(nt-1,(PetscInt)(nt*(cum + 0.5*work[u])/total));
+    cum     += work[u];
+  }
+  ierr = PetscMemzero(et->cstart,(nt+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (u=0; u<nu; u++) {
+    local[u] = PETSC_TRUE;
+    for (i=et->ustart[u]; i<et->ustart[u+1] && local[u]; i++) {
+      for (j=bi[i]; j<bi[i+1]; j++) {
+        d = unit[bj[j]];
+        if (d != u && (!local[d] || chunk[d] != chunk[u])) {local[u] = PETSC_FALSE; break;}
+      }
+    }
+    if (local[u]) {
+      et->cstart[chunk[u]+1]++;
+      localwork += work[u];
+    }
+  }
+  for (t=0; t<nt; t++) et->cstart[t+1] += et->cstart[t];
+  ierr = PetscMemcpy(next,et->cstart,nt*sizeof(PetscInt));CHKERRQ(ierr);
+  for (u=0; u<nu; u++) {
+    if (local[u]) et->cunits[next[chunk[u]]++] = u;
+  }
+
+  /* levels of the other supernodes, whose supernodes of each level are split among the threads by work */
+  et->nlevels = 0;
+  for (u=0; u<nu; u++) {
+    if (local[u]) continue;
+    level[u] = 0;
+    for (i=et->ustart[u]; i<et->ustart[u+1]; i++) {
+      for (j=bi[i]; j<bi[i+1]; j++) {
+        d = unit[bj[j]];
+        if (d != u && !local[d]) level[u] = PetscMax(level[u],level[d]+1);
+      }
+    }
+    et->nlevels = PetscMax(et->nlevels,level[u]+1);
+  }
+  ierr = PetscMalloc2(nu-et->cstart[nt],PetscInt,&et->tunits,et->nlevels*(nt+1),PetscInt,&et->tstarts);CHKERRQ(ierr);
+  ierr = PetscMemzero(lstart,(et->nlevels+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  for (u=0; u<nu; u++) if (!local[u]) lstart[level[u]+1]++;
+  for (l=0; l<et->nlevels; l++) lstart[l+1] += lstart[l];
+  ierr = PetscMemcpy(next,lstart,et->nlevels*sizeof(PetscInt));CHKERRQ(ierr);
+  for (u=0; u<nu; u++) if (!local[u]) et->tunits[next[level[u]]++] = u;
+  for (l=0; l<et->nlevels; l++) {
+    PetscInt *ts = et->tstarts + l*(nt+1);
+    lwork = 0.0;
+    for (k=lstart[l]; k<lstart[l+1]; k++) lwork += work[et->tunits[k]];
+    ts[0] = lstart[l];
+    for (t=1,k=lstart[l],cum=0.0; t<nt; t++) {
+      while (k < lstart[l+1] && cum*nt < t*lwork) {cum += work[et->tunits[k]]; k++;}
+      ts[t] = k;
+    }
+    ts[nt] = lstart[l+1];
+  }
+
+  ierr = PetscMalloc3(nt*(n+1),MatScalar,&et->rtmp,nt,PetscInt,&et->smallpivot,nt,PetscLogDouble,&et->flops);CHKERRQ(ierr);
+  cnt  = (3*nu+1+nt+1+et->nlevels*(nt+1)+n+nt*n)*sizeof(PetscInt) + (nt*(n+1)+nt*et->panelsize)*sizeof(MatScalar);
+  ierr = PetscLogObjectMemory(B,cnt);CHKERRQ(ierr);
+  ierr = PetscInfo5(B,"%D supernodes of at most %D rows for %D rows, %D levels above the independent subtrees on %D threads\n",nu,et->maxsize,n,et->nlevels,nt);CHKERRQ(ierr);
+  ierr = PetscInfo1(B,"Fraction of the work in independent subtrees %G\n",total > 0.0 ? localwork/total : 1.0);CHKERRQ(ierr);
+
+  ierr = PetscFree6(parent,child,sibling,next,stack,order);CHKERRQ(ierr);
+  ierr = PetscFree5(chunk,level,local,work,lstart);CHKERRQ(ierr);
+
+  ierr = PetscContainerCreate(PETSC_COMM_SELF,&container);CHKERRQ(ierr);
+  ierr = PetscContainerSetPointer(container,et);CHKERRQ(ierr);
+  ierr = PetscContainerSetUserDestroy(container,PetscContainerDestroy_Mat_SeqAIJ_ETree);CHKERRQ(ierr);
+  ierr = PetscObjectCompose((PetscObject)B,"Mat_SeqAIJ_ETree",(PetscObject)container);CHKERRQ(ierr);
+  ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* any pivot that MatPivotCheck() could shift or reject; rs is the sum of the absolute values of the rest of the row */
+#define MatETreeSmallPivot(pivot,rs,info) (PetscAbsScalar(pivot) <= (info)->zeropivot*PetscMax(rs,1.0) || ((info)->shifttype == (PetscReal)MAT_SHIFT_POSITIVE_DEFINITE && PetscRealPart(pivot) <= (info)->zeropivot*(rs)))
+
+/* Factors row i as MatLUFactorNumeric_SeqAIJ() does, returns PETSC_TRUE if its pivot is small */
+static PetscBool MatLUFactorNumeric_SeqAIJ_ETree_Row(PetscInt i,Mat_SeqAIJ *a,Mat_SeqAIJ *b,const PetscInt *r,const PetscInt *ics,const MatFactorInfo *info,MatScalar *rtmp,PetscLogDouble *flops)
+{
+  const PetscInt  *ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j,*bdiag = b->diag,*ajtmp,*bjtmp,*pj;
+  const MatScalar *aa = a->a,*v;
+  MatScalar       *pc,*pv,multiplier;
+  PetscInt        j,m,nz,nzL,row;
+  PetscReal       rs;
+
+  /* zero rtmp */
+  nz    = bi[i+1] - bi[i];
+  bjtmp = bj + bi[i];
+  for (j=0; j<nz; j++) rtmp[bjtmp[j]] = 0.0;
+  nz    = bdiag[i] - bdiag[i+1];
+  bjtmp = bj + bdiag[i+1]+1;
+  for (j=0; j<nz; j++) rtmp[bjtmp[j]] = 0.0;
+
+  /* load in initial (unfactored row) */
+  nz    = ai[r[i]+1] - ai[r[i]];
+  ajtmp = aj + ai[r[i]];
+  v     = aa + ai[r[i]];
+  for (j=0; j<nz; j++) rtmp[ics[ajtmp[j]]] = v[j];
+
+  /* elimination */
+  bjtmp = bj + bi[i];
+  nzL   = bi[i+1] - bi[i];
+  for (j=0; j<nzL; j++) {
+    row = bjtmp[j];
+    pc  = rtmp + row;
+    if (*pc != 0.0) {
+      multiplier = *pc * b->a[bdiag[row]];
+      *pc        = multiplier;
+      pj         = b->j + bdiag[row+1]+1; /* beginning of U(row,:) */
+      pv         = b->a + bdiag[row+1]+1;
+      nz         = bdiag[row] - bdiag[row+1] - 1;
+      for (m=0; m<nz; m++) rtmp[pj[m]] -= multiplier * pv[m];
+      *flops += 1 + 2*nz;
+    }
+  }
+
+  /* finished row so stick it into b->a */
+  rs = 0.0;
+  pv = b->a + bi[i];
+  pj = b->j + bi[i];
+  nz = bi[i+1] - bi[i];
+  for (j=0; j<nz; j++) {pv[j] = rtmp[pj[j]]; rs += PetscAbsScalar(pv[j]);}
+  pv = b->a + bdiag[i+1]+1;
+  pj = b->j + bdiag[i+1]+1;
+  nz = bdiag[i] - bdiag[i+1] - 1;
+  for (j=0; j<nz; j++) {pv[j] = rtmp[pj[j]]; rs += PetscAbsScalar(pv[j]);}
+
+  if (MatETreeSmallPivot(rtmp[i],rs,info)) return PETSC_TRUE;
+  b->a[bdiag[i]] = 1.0/rtmp[i];
+  return PETSC_FALSE;
+}
+
+/*
+   Factors the rows of supernode u in a dense panel P, stored by columns, whose columns are those of L of the first row,
+   the diagonal block and those of U of the last row. The columns of L fall into runs J, one for each supernode S the
+   rows depend on, taken in increasing order: P(:,J) is replaced by the multipliers P(:,J) U(J,J)^{-1} and the product of
+   the multipliers with the rows J of U beyond S is subtracted from the columns of P that are in the structure. Then the
+   diagonal block is factored and the part of U beyond it is solved with its L. Entries outside of the structure of the
+   factor, for ILU(k), are dropped exactly as by the sparse row kernel. Returns the first row with a small pivot or -1.
+*/
+static PetscInt MatLUFactorNumeric_SeqAIJ_ETree_Panel(PetscInt u,Mat_SeqAIJ *a,Mat_SeqAIJ *b,const PetscInt *r,const PetscInt *ics,const MatFactorInfo *info,Mat_SeqAIJ_ETree *et,PetscInt *colmap,MatScalar *P,PetscLogDouble *flops)
+{
+  const PetscInt  *ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j,*bdiag = b->diag,*Lcols,*Ucols,*pj;
+  const MatScalar *aa = a->a,*pv;
+  const PetscInt  i0 = et->ustart[u],s = et->ustart[u+1] - i0,nL = bi[i0+1] - bi[i0],m = bdiag[i0+s-1] - bdiag[i0+s] - 1;
+  const PetscInt  ncols = nL + s + m;
+  MatScalar       *Ud = P + s*ncols,*W = Ud + et->maxsize*et->maxsize,*Z = W + et->maxsize*et->maxext,*D = P + nL*s,*E = D + s*s;
+  MatScalar       one = 1.0,zero = 0.0,inv;
+  PetscInt        i,j,k,x,y,c,p,q,S,kend,tj,me,nz,small = -1;
+  PetscBLASInt    bs = (PetscBLASInt)s,btj,bme,bm = (PetscBLASInt)m;
+  PetscReal       rs;
+
+  Lcols = bj + bi[i0];
+  Ucols = bj + bdiag[i0+s] + 1;
+  for (j=0; j<nL; j++) colmap[Lcols[j]] = j;
+  for (j=0; j<s; j++)  colmap[i0+j]     = nL + j;
+  for (j=0; j<m; j++)  colmap[Ucols[j]] = nL + s + j;
+
+  /* gather the rows of A */
+  for (j=0; j<s*ncols; j++) P[j] = 0.0;
+  for (k=0; k<s; k++) {
+    for (j=ai[r[i0+k]]; j<ai[r[i0+k]+1]; j++) {
+      c = colmap[ics[aj[j]]];
+      if (c >= 0) P[k+c*s] = aa[j];
+    }
+  }
+
+  /* updates by the supernodes of the columns of L */
+  for (p=0; p<nL; p=q) {
+    S    = et->unit[Lcols[p]];
+    kend = et->ustart[S+1];
+    for (q=p+1; q<nL && Lcols[q] < kend; q++) ;
+    tj   = q - p;
+    me   = bdiag[kend-1] - bdiag[kend] - 1;
+    btj  = (PetscBLASInt)tj;
+    bme  = (PetscBLASInt)me;
+    /* U(J,J) and the rows J of U beyond S; the columns of U of a row in S come before those beyond S */
+    for (j=0; j<tj*tj; j++) Ud[j] = 0.0;
+    for (x=0; x<tj; x++) {
+      k  = Lcols[p+x];
+      pj = bj + bdiag[k+1] + 1;
+      pv = b->a + bdiag[k+1] + 1;
+      nz = bdiag[k] - bdiag[k+1] - 1;
+      Ud[x+x*tj] = 1.0/b->a[bdiag[k]];
+      for (y=0; y<nz-me; y++) {
+        c = colmap[pj[y]];
+        if (c >= 0) Ud[x+(c-p)*tj] = pv[y];
+      }
+      for (y=0; y<me; y++) W[x+y*tj] = pv[nz-me+y];
+    }
+    BLAStrsm_("R","U","N","N",&bs,&btj,&one,Ud,&btj,P+p*s,&bs);
+    *flops += s*tj*tj;
+    if (me) {
+      BLASgemm_("N","N",&bs,&bme,&btj,&one,P+p*s,&bs,W,&btj,&zero,Z,&bs);
+      pj = bj + bdiag[kend] + 1;
+      for (y=0; y<me; y++) {
+        c = colmap[pj[y]];
+        if (c >= 0) for (x=0; x<s; x++) P[x+c*s] -= Z[x+y*s];
+      }
+      *flops += 2.0*s*tj*me;
+    }
+  }
+
+  /* factor the diagonal block, then the part of U beyond it */
+  for (k=0; k<s && small < 0; k++) {
+    if (D[k+k*s] == 0.0) {small = i0 + k; break;}
+    inv = 1.0/D[k+k*s];
+    for (x=k+1; x<s; x++) D[x+k*s] *= inv;
+    for (y=k+1; y<s; y++) {
+      for (x=k+1; x<s; x++) D[x+y*s] -= D[x+k*s]*D[k+y*s];
+    }
+  }
+  if (small < 0) {
+    if (m) BLAStrsm_("L","L","N","U",&bs,&bm,&one,D,&bs,E,&bs);
+    *flops += (2.0*s*s*s)/3.0 + (PetscLogDouble)s*s*m;
+
+    /* scatter the rows into the factor */
+    for (k=0; k<s; k++) {
+      i  = i0 + k;
+      rs = 0.0;
+      for (j=0; j<nL+k; j++) {
+        b->a[bi[i]+j] = P[k+j*s];
+        rs           += PetscAbsScalar(P[k+j*s]);
+      }
+      nz = bdiag[i] - bdiag[i+1] - 1;
+      for (j=0; j<nz; j++) {
+        b->a[bdiag[i+1]+1+j] = P[k+(nL+k+1+j)*s];
+        rs                  += PetscAbsScalar(P[k+(nL+k+1+j)*s]);
+      }
+      if (MatETreeSmallPivot(D[k+k*s],rs,info)) {small = i; break;}
+      b->a[bdiag[i]] = 1.0/D[k+k*s];
+    }
+  }
+
+  for (j=0; j<nL; j++) colmap[Lcols[j]] = -1;
+  for (j=0; j<s; j++)  colmap[i0+j]     = -1;
+  for (j=0; j<m; j++)  colmap[Ucols[j]] = -1;
+  return small;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatLUFactorNumeric_SeqAIJ_ETree_Kernel"
+/*
+   Factors the supernodes units[ts[thread_id]] ... units[ts[thread_id+1]-1], stopping at the first small pivot
+*/
+PetscErrorCode MatLUFactorNumeric_SeqAIJ_ETree_Kernel(PetscInt thread_id,Mat B,Mat A,const PetscInt *r,const PetscInt *ics,const PetscInt *units,const PetscInt *ts,const MatFactorInfo *info,Mat_SeqAIJ_ETree *et)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data;
+  const PetscInt n = A->rmap->n;
+  MatScalar      *rtmp = et->rtmp + thread_id*(n+1),*panel = et->panel + thread_id*et->panelsize;
+  PetscInt       *colmap = et->colmap + thread_id*n,k,u,i,small = -1;
+  PetscLogDouble flops = 0.0;
+
+  for (k=ts[thread_id]; k<ts[thread_id+1] && small < 0; k++) {
+    u = units[k];
+    i = et->ustart[u];
+    if (et->ustart[u+1] - i == 1) {
+      if (MatLUFactorNumeric_SeqAIJ_ETree_Row(i,a,b,r,ics,info,rtmp,&flops)) small = i;
+    } else {
+      small = MatLUFactorNumeric_SeqAIJ_ETree_Panel(u,a,b,r,ics,info,et,colmap,panel,&flops);
+    }
+  }
+  et->smallpivot[thread_id] = small;
+  et->flops[thread_id]     += flops;
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatLUFactorNumeric_SeqAIJ_ETree"
+PetscErrorCode MatLUFactorNumeric_SeqAIJ_ETree(Mat B,Mat A,const MatFactorInfo *info)
+{
+  Mat              C = B;
+  Mat_SeqAIJ       *b = (Mat_SeqAIJ*)C->data;
+  PetscErrorCode   ierr;
+  PetscContainer   container;
+  Mat_SeqAIJ_ETree *et;
+  const PetscInt   *r,*ic,*ts;
+  PetscInt         t,l,nt,smallpivot = -1;
+  PetscLogDouble   flops = 0.0;
+  PetscBool        row_identity,col_identity;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectQuery((PetscObject)C,"Mat_SeqAIJ_ETree",(PetscObject*)&container);CHKERRQ(ierr);
+  if (!container) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Factor has no elimination tree schedule, call MatLUFactorSymbolic() first");
+  ierr = PetscContainerGetPointer(container,(void**)&et);CHKERRQ(ierr);
+  nt   = et->nthreads;
+  for (t=0; t<nt; t++) {
+    et->smallpivot[t] = -1;
+    et->flops[t]      = 0.0;
+  }
+  ierr = ISGetIndices(b->row,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(b->icol,&ic);CHKERRQ(ierr);
+
+  /* the independent subtrees, then the levels above them */
+  for (l=-1; l<et->nlevels && smallpivot < 0; l++) {
+    const PetscInt *units = (l < 0) ? et->cunits : et->tunits;
+    ts = (l < 0) ? et->cstart : et->tstarts + l*(nt+1);
+#if defined(PETSC_THREADCOMM_ACTIVE)
+    ierr = PetscThreadCommRunKernel(((PetscObject)C)->comm,(PetscThreadKernel)MatLUFactorNumeric_SeqAIJ_ETree_Kernel,8,C,A,r,ic,units,ts,info,et);CHKERRQ(ierr);
+    ierr = PetscThreadCommBarrier(((PetscObject)C)->comm);CHKERRQ(ierr);
+#else
+    ierr = MatLUFactorNumeric_SeqAIJ_ETree_Kernel(0,C,A,r,ic,units,ts,info,et);CHKERRQ(ierr);
+#endif
+    for (t=0; t<nt; t++) {
+      if (et->smallpivot[t] >= 0 && (smallpivot < 0 || et->smallpivot[t] < smallpivot)) smallpivot = et->smallpivot[t];
+    }
+  }
+  ierr = ISRestoreIndices(b->icol,&ic);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(b->row,&r);CHKERRQ(ierr);
+  for (t=0; t<nt; t++) flops += et->flops[t];
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+
+  if (smallpivot >= 0) {
+    /* shifts change all the rows after the small pivot, so they are applied by the sequential factorization */
+    ierr = PetscInfo1(C,"Small pivot in row %D, factoring sequentially\n",smallpivot);CHKERRQ(ierr);
+    ierr = MatLUFactorNumeric_SeqAIJ(C,A,info);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
+  ierr = ISIdentity(b->row,&row_identity);CHKERRQ(ierr);
+  ierr = ISIdentity(b->icol,&col_identity);CHKERRQ(ierr);
+  if (row_identity && col_identity) {
+    C->ops->solve = MatSolve_SeqAIJ_NaturalOrdering;
+  } else {
+    C->ops->solve = MatSolve_SeqAIJ;
+  }
+  C->ops->solveadd          = MatSolveAdd_SeqAIJ;
+  C->ops->solvetranspose    = MatSolveTranspose_SeqAIJ;
+  C->ops->solvetransposeadd = MatSolveTransposeAdd_SeqAIJ;
+  C->ops->matsolve          = MatMatSolve_SeqAIJ;
+  C->assembled              = PETSC_TRUE;
+  C->preallocated           = PETSC_TRUE;
+  ierr = PetscLogFlops(C->cmap->n);CHKERRQ(ierr);
+  ierr = Mat_CheckInode_FactorLU(C,PETSC_FALSE);CHKERRQ(ierr);
+  ierr = MatFactorSetUpSolveLevels_SeqAIJ(C,A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqAIJETreeSetNumeric_Private"
+/*
+   The symbolic factorizations of MATSOLVERPETSC build the factor; its numeric factorization is replaced unless they
+   selected one of the factorizations in the old data structure
+*/
+static PetscErrorCode MatSeqAIJETreeSetNumeric_Private(Mat B)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (B->ops->lufactornumeric != MatLUFactorNumeric_SeqAIJ && B->ops->lufactornumeric != MatLUFactorNumeric_SeqAIJ_Inode) {
+    ierr = PetscInfo(B,"Factor in the inplace data structure, using the sequential numeric factorization\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = MatSeqAIJETreeSetUp_Private(B);CHKERRQ(ierr);
+  B->ops->lufactornumeric = MatLUFactorNumeric_SeqAIJ_ETree;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatLUFactorSymbolic_SeqAIJ_ETree"
+PetscErrorCode MatLUFactorSymbolic_SeqAIJ_ETree(Mat B,Mat A,IS isrow,IS iscol,const MatFactorInfo *info)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatLUFactorSymbolic_SeqAIJ(B,A,isrow,iscol,info);CHKERRQ(ierr);
+  ierr = MatSeqAIJETreeSetNumeric_Private(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatILUFactorSymbolic_SeqAIJ_ETree"
+PetscErrorCode MatILUFactorSymbolic_SeqAIJ_ETree(Mat B,Mat A,IS isrow,IS iscol,const MatFactorInfo *info)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatILUFactorSymbolic_SeqAIJ(B,A,isrow,iscol,info);CHKERRQ(ierr);
+  ierr = MatSeqAIJETreeSetNumeric_Private(B);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "MatGetFactor_seqaij_etree"
+PetscErrorCode MatGetFactor_seqaij_etree(Mat A,MatFactorType ftype,Mat *B)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (ftype != MAT_FACTOR_LU && ftype != MAT_FACTOR_ILU) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Factor type not supported");
+  ierr = MatGetFactor_seqaij_petsc(A,ftype,B);CHKERRQ(ierr);
+  (*B)->ops->lufactorsymbolic  = MatLUFactorSymbolic_SeqAIJ_ETree;
+  (*B)->ops->ilufactorsymbolic = MatILUFactorSymbolic_SeqAIJ_ETree;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
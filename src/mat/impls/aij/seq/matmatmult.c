@@ -8,6 +8,7 @@
 #include <../src/mat/utils/freespace.h>
 #include <../src/mat/utils/petscheap.h>
 #include <petscbt.h>
+#include <petscthreadcomm.h>
 #include <../src/mat/impls/dense/seq/dense.h> 
 
 #undef __FUNCT__
@@ -15,7 +16,7 @@
 PetscErrorCode MatMatMult_SeqAIJ_SeqAIJ(Mat A,Mat B,MatReuse scall,PetscReal fill,Mat *C)
 {
   PetscErrorCode ierr;
-  PetscBool      scalable=PETSC_FALSE,scalable_fast=PETSC_FALSE,heap = PETSC_FALSE,btheap = PETSC_FALSE;
+  PetscBool      scalable=PETSC_FALSE,scalable_fast=PETSC_FALSE,heap = PETSC_FALSE,btheap = PETSC_FALSE,llcondensed = PETSC_FALSE;
 
   PetscFunctionBegin;
   if (scall == MAT_INITIAL_MATRIX){
@@ -24,6 +25,7 @@ PetscErrorCode MatMatMult_SeqAIJ_SeqAIJ(Mat A,Mat B,MatReuse scall,PetscReal fil
     ierr = PetscOptionsBool("-matmatmult_scalable_fast","Use a scalable but slower C=A*B","",scalable_fast,&scalable_fast,PETSC_NULL);CHKERRQ(ierr);
     ierr = PetscOptionsBool("-matmatmult_heap","Use heap implementation of symbolic factorization C=A*B","",heap,&heap,PETSC_NULL);CHKERRQ(ierr);
     ierr = PetscOptionsBool("-matmatmult_btheap","Use btheap implementation of symbolic factorization C=A*B","",btheap,&btheap,PETSC_NULL);CHKERRQ(ierr);
+    ierr = PetscOptionsBool("-matmatmult_llcondensed","Use the sequential condensed linked list implementation of C=A*B","",llcondensed,&llcondensed,PETSC_NULL);CHKERRQ(ierr);
     ierr = PetscOptionsEnd();CHKERRQ(ierr);
     if (scalable_fast){
       ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Scalable_fast(A,B,fill,C);CHKERRQ(ierr);
@@ -33,8 +35,10 @@ PetscErrorCode MatMatMult_SeqAIJ_SeqAIJ(Mat A,Mat B,MatReuse scall,PetscReal fil
       ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Heap(A,B,fill,C);CHKERRQ(ierr);
     } else if (btheap) {
       ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_BTHeap(A,B,fill,C);CHKERRQ(ierr);
-    } else {
+    } else if (llcondensed) {
       ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ(A,B,fill,C);CHKERRQ(ierr);
+    } else { /* threaded, with dense or hash accumulators chosen from the estimated fill */
+      ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson(A,B,fill,C);CHKERRQ(ierr);
     }
   }
   
@@ -687,6 +691,307 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_BTHeap(Mat A,Mat B,PetscReal fil
   PetscFunctionReturn(0);
 }
 
+/*
+   Row-parallel Gustavson product C = A*B on the threads of the PetscThreadComm of A. The rows of C are split into
+   contiguous blocks of about the same number of flops, one per thread, and each thread forms its rows with its own
+   accumulator: a dense array of length bn, as MatMatMultNumeric_SeqAIJ_SeqAIJ() does, or an open addressing hash table
+   sized by the longest row of C when nthreads dense arrays would be larger than C itself.
+*/
+typedef struct {
+  PetscInt       nthreads;
+  PetscInt       *rstart;  /* thread t forms the rows rstart[t] to rstart[t+1]-1 of C */
+  PetscBool      hash;     /* accumulate in hash tables instead of dense arrays */
+  PetscInt       hsize;    /* length of each hash table, a power of 2 at least twice the longest row of C */
+  PetscInt       *keys;    /* per thread: the marker of length bn, or the hash keys (columns) */
+  PetscInt       *slots;   /* per thread: the hash positions in the row of C and the list of used slots */
+  PetscScalar    *dense;   /* per thread: the dense accumulator of length bn */
+  PetscLogDouble *flops;
+} Mat_MatMatMultGustavson;
+
+#define MatMatMultGustavsonHash(col,mask) ((PetscInt)(((size_t)(col)*(size_t)2654435761U) & (size_t)(mask)))
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscContainerDestroy_Mat_MatMatMultGustavson"
+PetscErrorCode PetscContainerDestroy_Mat_MatMatMultGustavson(void *ptr)
+{
+  PetscErrorCode          ierr;
+  Mat_MatMatMultGustavson *g = (Mat_MatMatMultGustavson*)ptr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree2(g->rstart,g->flops);CHKERRQ(ierr);
+  ierr = PetscFree(g->keys);CHKERRQ(ierr);
+  ierr = PetscFree(g->slots);CHKERRQ(ierr);
+  ierr = PetscFree(g->dense);CHKERRQ(ierr);
+  ierr = PetscFree(g);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson_Kernel"
+/*
+   Counts the nonzeros of the rows of C of the thread into ci[i+1] if cj is null, otherwise puts their sorted columns
+   into cj[ci[i]] ... cj[ci[i+1]-1]
+*/
+PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson_Kernel(PetscInt thread_id,Mat A,Mat B,Mat_MatMatMultGustavson *g,PetscInt *ci,PetscInt *cj)
+{
+  PetscErrorCode ierr;
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data;
+  const PetscInt *ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j,*bjj,bn = B->cmap->n,mask = g->hsize-1;
+  PetscInt       *keys,*used = PETSC_NULL,i,j,k,col,h,bnz,cnz,nused;
+
+  if (g->hash) {
+    keys = g->keys + thread_id*g->hsize;
+    used = g->slots + thread_id*2*g->hsize;
+  } else keys = g->keys + thread_id*bn;
+  for (i=g->rstart[thread_id]; i<g->rstart[thread_id+1]; i++) {
+    cnz = 0; nused = 0;
+    for (j=ai[i]; j<ai[i+1]; j++) {
+      bnz = bi[aj[j]+1] - bi[aj[j]];
+      bjj = bj + bi[aj[j]];
+      for (k=0; k<bnz; k++) {
+        col = bjj[k];
+        if (g->hash) {
+          h = MatMatMultGustavsonHash(col,mask);
+          while (keys[h] >= 0 && keys[h] != col) h = (h+1) & mask;
+          if (keys[h] == col) continue;
+          keys[h] = col; used[nused++] = h;
+        } else {
+          if (keys[col] == i) continue;
+          keys[col] = i;
+        }
+        if (cj) cj[ci[i]+cnz] = col;
+        cnz++;
+      }
+    }
+    if (g->hash) {
+      for (k=0; k<nused; k++) keys[used[k]] = -1;
+    }
+    if (cj) {
+      ierr = PetscSortInt(cnz,cj+ci[i]);CHKERRQ(ierr);
+    } else ci[i+1] = cnz;
+  }
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson"
+/*
+   MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson - Forms the structure of C = A*B in two threaded passes over the rows of
+   A, the first counting the nonzeros of each row of C and the second putting their columns in place. The accumulators
+   are dense unless nthreads arrays of length bn would hold more entries than the estimate of nnz(C), or
+   -matmatmult_hash <true,false> forces the choice.
+*/
+PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson(Mat A,Mat B,PetscReal fill,Mat *C)
+{
+  PetscErrorCode          ierr;
+  Mat_SeqAIJ              *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data,*c;
+  PetscInt                *ai = a->i,*aj = a->j,*bi = b->i,*ci,*cj;
+  PetscInt                am = A->rmap->n,bn = B->cmap->n,bm = B->rmap->n,i,j,t,nt = 1,w,maxrow = 0;
+  PetscReal               afill;
+  PetscLogDouble          work = 0.0,est = 0.0,*rwork;
+  Mat_MatMatMultGustavson *g;
+  PetscContainer          container;
+
+  PetscFunctionBegin;
+#if defined(PETSC_THREADCOMM_ACTIVE)
+  ierr = PetscThreadCommGetNThreads(((PetscObject)A)->comm,&nt);CHKERRQ(ierr);
+#endif
+  ierr = PetscNew(Mat_MatMatMultGustavson,&g);CHKERRQ(ierr);
+  g->nthreads = nt;
+  ierr = PetscMalloc2(nt+1,PetscInt,&g->rstart,nt,PetscLogDouble,&g->flops);CHKERRQ(ierr);
+
+  /* the flops of each row of C bound its number of nonzeros; split the rows by flops */
+  ierr = PetscMalloc((am+1)*sizeof(PetscLogDouble),&rwork);CHKERRQ(ierr);
+  rwork[0] = 0.0;
+  for (i=0; i<am; i++) {
+    w = 0;
+    for (j=ai[i]; j<ai[i+1]; j++) w += bi[aj[j]+1] - bi[aj[j]];
+    if (w > bn) w = bn;
+    if (w > maxrow) maxrow = w;
+    est       += w;
+    work      += ai[i+1] - ai[i] + w;
+    rwork[i+1] = work;
+  }
+  g->rstart[0] = 0;
+  for (t=1,i=0; t<nt; t++) {
+    while (i < am && rwork[i] < (work*t)/nt) i++;
+    g->rstart[t] = i;
+  }
+  g->rstart[nt] = am;
+  ierr = PetscFree(rwork);CHKERRQ(ierr);
+
+  g->hash = (PetscBool)((PetscLogDouble)nt*bn > est);
+  ierr = PetscOptionsGetBool(((PetscObject)A)->prefix,"-matmatmult_hash",&g->hash,PETSC_NULL);CHKERRQ(ierr);
+  if (g->hash) {
+    for (g->hsize=2; g->hsize < 2*maxrow; g->hsize *= 2) ;
+    ierr = PetscMalloc(nt*g->hsize*sizeof(PetscInt),&g->keys);CHKERRQ(ierr);
+    ierr = PetscMalloc(nt*2*g->hsize*sizeof(PetscInt),&g->slots);CHKERRQ(ierr);
+    for (i=0; i<nt*g->hsize; i++) g->keys[i] = -1;
+  } else {
+    ierr = PetscMalloc(nt*bn*sizeof(PetscInt),&g->keys);CHKERRQ(ierr);
+    ierr = PetscMalloc(nt*bn*sizeof(PetscScalar),&g->dense);CHKERRQ(ierr);
+    for (i=0; i<nt*bn; i++) g->keys[i] = -1;
+    ierr = PetscMemzero(g->dense,nt*bn*sizeof(PetscScalar));CHKERRQ(ierr);
+  }
+
+  /* count, then fill */
+  ierr = PetscMalloc((am+1)*sizeof(PetscInt),&ci);CHKERRQ(ierr);
+  ci[0] = 0;
+  cj    = PETSC_NULL;
+#if defined(PETSC_THREADCOMM_ACTIVE)
+  ierr = PetscThreadCommRunKernel(((PetscObject)A)->comm,(PetscThreadKernel)MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson_Kernel,5,A,B,g,ci,cj);CHKERRQ(ierr);
+  ierr = PetscThreadCommBarrier(((PetscObject)A)->comm);CHKERRQ(ierr);
+#else
+  ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson_Kernel(0,A,B,g,ci,cj);CHKERRQ(ierr);
+#endif
+  for (i=0; i<am; i++) ci[i+1] += ci[i];
+  ierr = PetscMalloc((ci[am]+1)*sizeof(PetscInt),&cj);CHKERRQ(ierr);
+  if (!g->hash) {
+    for (i=0; i<nt*bn; i++) g->keys[i] = -1;
+  }
+#if defined(PETSC_THREADCOMM_ACTIVE)
+  ierr = PetscThreadCommRunKernel(((PetscObject)A)->comm,(PetscThreadKernel)MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson_Kernel,5,A,B,g,ci,cj);CHKERRQ(ierr);
+  ierr = PetscThreadCommBarrier(((PetscObject)A)->comm);CHKERRQ(ierr);
+#else
+  ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson_Kernel(0,A,B,g,ci,cj);CHKERRQ(ierr);
+#endif
+
+  /* put together the new symbolic matrix */
+  ierr = MatCreateSeqAIJWithArrays(((PetscObject)A)->comm,am,bn,ci,cj,PETSC_NULL,C);CHKERRQ(ierr);
+  (*C)->rmap->bs = A->rmap->bs;
+  (*C)->cmap->bs = B->cmap->bs;
+  c = (Mat_SeqAIJ *)((*C)->data);
+  c->free_a  = PETSC_FALSE;
+  c->free_ij = PETSC_TRUE;
+  c->nonew   = 0;
+  (*C)->ops->matmultnumeric = MatMatMultNumeric_SeqAIJ_SeqAIJ_Gustavson;
+
+  ierr = PetscContainerCreate(PETSC_COMM_SELF,&container);CHKERRQ(ierr);
+  ierr = PetscContainerSetPointer(container,g);CHKERRQ(ierr);
+  ierr = PetscContainerSetUserDestroy(container,PetscContainerDestroy_Mat_MatMatMultGustavson);CHKERRQ(ierr);
+  ierr = PetscObjectCompose((PetscObject)(*C),"Mat_MatMatMultGustavson",(PetscObject)container);CHKERRQ(ierr);
+  ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
+
+  /* set MatInfo */
+  afill = (PetscReal)ci[am]/(ai[am]+bi[bm]) + 1.e-5;
+  if (afill < 1.0) afill = 1.0;
+  c->maxnz                     = ci[am];
+  c->nz                        = ci[am];
+  (*C)->info.mallocs           = 0;
+  (*C)->info.fill_ratio_given  = fill;
+  (*C)->info.fill_ratio_needed = afill;
+
+#if defined(PETSC_USE_INFO)
+  if (ci[am]) {
+    ierr = PetscInfo4((*C),"%D threads with %s accumulators; estimated %G nonzeros, %D in the product\n",nt,g->hash ? "hash" : "dense",(PetscReal)est,ci[am]);CHKERRQ(ierr);
+    ierr = PetscInfo1((*C),"Fill ratio: needed %G.\n",afill);CHKERRQ(ierr);
+  } else {
+    ierr = PetscInfo((*C),"Empty matrix product\n");CHKERRQ(ierr);
+  }
+#endif
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMatMultNumeric_SeqAIJ_SeqAIJ_Gustavson_Kernel"
+/* forms the rows of C of the thread; the dense variant sums in the same order as MatMatMultNumeric_SeqAIJ_SeqAIJ() */
+PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Gustavson_Kernel(PetscInt thread_id,Mat A,Mat B,Mat C,Mat_MatMatMultGustavson *g)
+{
+  Mat_SeqAIJ      *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data,*c = (Mat_SeqAIJ*)C->data;
+  const PetscInt  *ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j,*ci = c->i,*cj = c->j,*bjj,*cjj,mask = g->hsize-1;
+  const MatScalar *aa = a->a,*ba = b->a,*baj;
+  MatScalar       *ca = c->a,*caj,*dense = PETSC_NULL,valtmp;
+  PetscInt        *keys = PETSC_NULL,*pos = PETSC_NULL,*used = PETSC_NULL,i,j,k,h,bnz,cnz;
+  PetscLogDouble  flops = 0.0;
+
+  if (g->hash) {
+    keys = g->keys + thread_id*g->hsize;
+    pos  = g->slots + thread_id*2*g->hsize;
+    used = pos + g->hsize;
+  } else dense = g->dense + thread_id*B->cmap->n;
+  for (i=g->rstart[thread_id]; i<g->rstart[thread_id+1]; i++) {
+    cnz = ci[i+1] - ci[i];
+    cjj = cj + ci[i];
+    caj = ca + ci[i];
+    if (g->hash) {
+      /* map the columns of the row of C to their positions, then sum directly into the row */
+      for (k=0; k<cnz; k++) {
+        h = MatMatMultGustavsonHash(cjj[k],mask);
+        while (keys[h] >= 0) h = (h+1) & mask;
+        keys[h] = cjj[k]; pos[h] = k; used[k] = h;
+        caj[k]  = 0.0;
+      }
+      for (j=ai[i]; j<ai[i+1]; j++) {
+        bnz    = bi[aj[j]+1] - bi[aj[j]];
+        bjj    = bj + bi[aj[j]];
+        baj    = ba + bi[aj[j]];
+        valtmp = aa[j];
+        for (k=0; k<bnz; k++) {
+          h = MatMatMultGustavsonHash(bjj[k],mask);
+          while (keys[h] != bjj[k]) h = (h+1) & mask;
+          caj[pos[h]] += valtmp*baj[k];
+        }
+        flops += 2*bnz;
+      }
+      for (k=0; k<cnz; k++) keys[used[k]] = -1;
+    } else {
+      for (j=ai[i]; j<ai[i+1]; j++) {
+        bnz    = bi[aj[j]+1] - bi[aj[j]];
+        bjj    = bj + bi[aj[j]];
+        baj    = ba + bi[aj[j]];
+        valtmp = aa[j];
+        for (k=0; k<bnz; k++) dense[bjj[k]] += valtmp*baj[k];
+        flops += 2*bnz;
+      }
+      for (k=0; k<cnz; k++) {
+        caj[k]        = dense[cjj[k]];
+        dense[cjj[k]] = 0.0;
+      }
+    }
+  }
+  g->flops[thread_id] = flops;
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMatMultNumeric_SeqAIJ_SeqAIJ_Gustavson"
+PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Gustavson(Mat A,Mat B,Mat C)
+{
+  PetscErrorCode          ierr;
+  Mat_SeqAIJ              *c = (Mat_SeqAIJ*)C->data;
+  Mat_MatMatMultGustavson *g;
+  PetscContainer          container;
+  PetscInt                t;
+  PetscLogDouble          flops = 0.0;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectQuery((PetscObject)C,"Mat_MatMatMultGustavson",(PetscObject*)&container);CHKERRQ(ierr);
+  if (!container) { /* C was not formed by MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson(), for example a duplicate */
+    if (c->a && !c->matmult_abdense) {
+      ierr = PetscMalloc(B->cmap->N*sizeof(PetscScalar),&c->matmult_abdense);CHKERRQ(ierr);
+      ierr = PetscMemzero(c->matmult_abdense,B->cmap->N*sizeof(PetscScalar));CHKERRQ(ierr);
+    }
+    ierr = MatMatMultNumeric_SeqAIJ_SeqAIJ(A,B,C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscContainerGetPointer(container,(void**)&g);CHKERRQ(ierr);
+  if (!c->a) {
+    ierr = PetscMalloc((c->i[C->rmap->n]+1)*sizeof(MatScalar),&c->a);CHKERRQ(ierr);
+    c->free_a = PETSC_TRUE;
+  }
+#if defined(PETSC_THREADCOMM_ACTIVE)
+  ierr = PetscThreadCommRunKernel(((PetscObject)C)->comm,(PetscThreadKernel)MatMatMultNumeric_SeqAIJ_SeqAIJ_Gustavson_Kernel,4,A,B,C,g);CHKERRQ(ierr);
+  ierr = PetscThreadCommBarrier(((PetscObject)C)->comm);CHKERRQ(ierr);
+#else
+  ierr = MatMatMultNumeric_SeqAIJ_SeqAIJ_Gustavson_Kernel(0,A,B,C,g);CHKERRQ(ierr);
+#endif
+  for (t=0; t<g->nthreads; t++) flops += g->flops[t];
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /* This routine is not used. Should be removed! */
 #undef __FUNCT__
 #define __FUNCT__ "MatMatTransposeMult_SeqAIJ_SeqAIJ"
@@ -713,6 +1018,8 @@ PetscErrorCode PetscContainerDestroy_Mat_MatMatTransMult(void *ptr)
   ierr = MatTransposeColoringDestroy(&multtrans->matcoloring);CHKERRQ(ierr);
   ierr = MatDestroy(&multtrans->Bt_den);CHKERRQ(ierr);
   ierr = MatDestroy(&multtrans->ABt_den);CHKERRQ(ierr);
+  ierr = MatDestroy(&multtrans->Bt);CHKERRQ(ierr);
+  ierr = PetscFree(multtrans->btperm);CHKERRQ(ierr);
   ierr = PetscFree(multtrans);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -742,20 +1049,46 @@ PetscErrorCode MatDestroy_SeqAIJ_MatMatMultTrans(Mat A)
 PetscErrorCode MatMatTransposeMultSymbolic_SeqAIJ_SeqAIJ(Mat A,Mat B,PetscReal fill,Mat *C)
 {
   PetscErrorCode      ierr;
+  Mat_SeqAIJ          *b=(Mat_SeqAIJ*)B->data,*bt;
   Mat                 Bt;
-  PetscInt            *bti,*btj;
+  PetscInt            *bti,*btj,*btperm=PETSC_NULL,*next,bm=B->rmap->n,bn=B->cmap->n,i,k;
+  MatScalar           *bta=PETSC_NULL;
+  PetscBool           usecoloring=PETSC_FALSE,innerproduct=PETSC_FALSE;
   Mat_MatMatTransMult *multtrans;
   PetscContainer      container;
 
   PetscFunctionBegin;
-   /* create symbolic Bt */
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-matmattransmult_color",&usecoloring,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-matmattransmult_innerproduct",&innerproduct,PETSC_NULL);CHKERRQ(ierr);
   ierr = MatGetSymbolicTranspose_SeqAIJ(B,&bti,&btj);CHKERRQ(ierr);
-  ierr = MatCreateSeqAIJWithArrays(PETSC_COMM_SELF,B->cmap->n,B->rmap->n,bti,btj,PETSC_NULL,&Bt);CHKERRQ(ierr);
+  if (!usecoloring && !innerproduct) {
+    /* Bt with the values of B, which btperm places again at each numeric product */
+    ierr = PetscMalloc((bti[bn]+1)*sizeof(MatScalar),&bta);CHKERRQ(ierr);
+    ierr = PetscMalloc((b->i[bm]+1)*sizeof(PetscInt),&btperm);CHKERRQ(ierr);
+    ierr = PetscMalloc((bn+1)*sizeof(PetscInt),&next);CHKERRQ(ierr);
+    ierr = PetscMemcpy(next,bti,bn*sizeof(PetscInt));CHKERRQ(ierr);
+    for (i=0; i<bm; i++) {
+      for (k=b->i[i]; k<b->i[i+1]; k++) {
+        btperm[k]      = next[b->j[k]]++;
+        bta[btperm[k]] = b->a[k];
+      }
+    }
+    ierr = PetscFree(next);CHKERRQ(ierr);
+  }
+  /* create symbolic Bt */
+  ierr = MatCreateSeqAIJWithArrays(PETSC_COMM_SELF,B->cmap->n,B->rmap->n,bti,btj,bta,&Bt);CHKERRQ(ierr);
   Bt->rmap->bs = A->cmap->bs;
   Bt->cmap->bs = B->cmap->bs;
 
-  /* get symbolic C=A*Bt */
-  ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ(A,Bt,fill,C);CHKERRQ(ierr);
+  /* get symbolic C=A*Bt, formed by the threaded product unless the sparse inner products or the coloring are used */
+  if (bta) {
+    ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Gustavson(A,Bt,fill,C);CHKERRQ(ierr);
+    bt          = (Mat_SeqAIJ*)Bt->data;
+    bt->free_a  = PETSC_TRUE;
+    bt->free_ij = PETSC_TRUE;
+  } else {
+    ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ(A,Bt,fill,C);CHKERRQ(ierr);
+  }
 
   /* create a supporting struct for reuse intermidiate dense matrices with matcoloring */
   ierr = PetscNew(Mat_MatMatTransMult,&multtrans);CHKERRQ(ierr);
@@ -767,11 +1100,14 @@ PetscErrorCode MatMatTransposeMultSymbolic_SeqAIJ_SeqAIJ(Mat A,Mat B,PetscReal f
   ierr = PetscObjectCompose((PetscObject)(*C),"Mat_MatMatTransMult",(PetscObject)container);CHKERRQ(ierr);
   ierr = PetscContainerDestroy(&container);CHKERRQ(ierr);
 
-  multtrans->usecoloring = PETSC_FALSE;
+  multtrans->usecoloring = usecoloring;
   multtrans->destroy = (*C)->ops->destroy;
   (*C)->ops->destroy = MatDestroy_SeqAIJ_MatMatMultTrans;
+  if (bta) {
+    multtrans->Bt     = Bt;
+    multtrans->btperm = btperm;
+  }
 
-  ierr = PetscOptionsGetBool(PETSC_NULL,"-matmattransmult_color",&multtrans->usecoloring,PETSC_NULL);CHKERRQ(ierr);
   if (multtrans->usecoloring){
     /* Create MatTransposeColoring from symbolic C=A*B^T */
     MatTransposeColoring matcoloring;
@@ -806,8 +1142,10 @@ PetscErrorCode MatMatTransposeMultSymbolic_SeqAIJ_SeqAIJ(Mat A,Mat B,PetscReal f
 #endif
   }
   /* clean up */
-  ierr = MatDestroy(&Bt);CHKERRQ(ierr);
-  ierr = MatRestoreSymbolicTranspose_SeqAIJ(B,&bti,&btj);CHKERRQ(ierr);
+  if (!bta) {
+    ierr = MatDestroy(&Bt);CHKERRQ(ierr);
+    ierr = MatRestoreSymbolicTranspose_SeqAIJ(B,&bti,&btj);CHKERRQ(ierr);
+  }
 
 
 
@@ -936,6 +1274,19 @@ PetscErrorCode MatMatTransposeMultNumeric_SeqAIJ_SeqAIJ(Mat A,Mat B,Mat C)
 #endif
 
   PetscFunctionBegin;
+  ierr = PetscObjectQuery((PetscObject)C,"Mat_MatMatTransMult",(PetscObject *)&container);CHKERRQ(ierr);
+  if (!container) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Container does not exit");
+  ierr  = PetscContainerGetPointer(container,(void **)&multtrans);CHKERRQ(ierr);
+  if (multtrans->Bt){
+    /* put the values of B into Bt, then C = A*Bt with the threaded product */
+    MatScalar *bta = ((Mat_SeqAIJ*)multtrans->Bt->data)->a;
+    PetscInt  *btperm = multtrans->btperm,k;
+
+    for (k=0; k<bi[B->rmap->n]; k++) bta[btperm[k]] = ba[k];
+    ierr = MatMatMultNumeric_SeqAIJ_SeqAIJ_Gustavson(A,multtrans->Bt,C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
   /* clear old values in C */
   if (!c->a){
     ierr = PetscMalloc((ci[cm]+1)*sizeof(MatScalar),&ca);CHKERRQ(ierr);
@@ -945,10 +1296,6 @@ PetscErrorCode MatMatTransposeMultNumeric_SeqAIJ_SeqAIJ(Mat A,Mat B,Mat C)
     ca =  c->a;
   }
   ierr = PetscMemzero(ca,ci[cm]*sizeof(MatScalar));CHKERRQ(ierr);
-
-  ierr = PetscObjectQuery((PetscObject)C,"Mat_MatMatTransMult",(PetscObject *)&container);CHKERRQ(ierr);
-  if (!container) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Container does not exit");
-  ierr  = PetscContainerGetPointer(container,(void **)&multtrans);CHKERRQ(ierr);
   if (multtrans->usecoloring){
     MatTransposeColoring  matcoloring = multtrans->matcoloring;
     Mat                   Bt_dense;
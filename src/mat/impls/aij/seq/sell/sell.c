@@ -0,0 +1,441 @@
+
+/*
+  Defines the matrix-vector products for the MATSEQSELL matrix class.
+  This class is derived from the MATSEQAIJ class and retains the
+  compressed row storage (aka Yale sparse matrix format) but augments
+  it with a sliced ELLPACK (SELL-C-sigma) copy of the matrix that is
+  used for the products.
+
+  Unlike MATSEQAIJCRL, which pads every row to the length of the longest
+  row of the matrix, each slice of C rows is only padded to the length of
+  its own longest row. Sorting the rows by length within windows of sigma
+  rows groups rows of similar length into the same slice.
+*/
+#include <../src/mat/impls/aij/seq/sell/sell.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "MatDestroy_SeqSELL"
+PetscErrorCode MatDestroy_SeqSELL(Mat A)
+{
+  PetscErrorCode ierr;
+  Mat_SeqSELL    *sell = (Mat_SeqSELL*)A->spptr;
+
+  PetscFunctionBegin;
+  if (sell) {
+    ierr = PetscFree2(sell->val,sell->colidx);CHKERRQ(ierr);
+    ierr = PetscFree2(sell->sliidx,sell->rows);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(A->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectChangeTypeName((PetscObject)A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSeqSELLBuild_Private"
+/*
+   MatSeqSELLBuild_Private - Builds the SELL-C-sigma arrays from the AIJ arrays of A.
+
+   The products call this whenever the state of the matrix has changed since the arrays
+   were last built, so values changed by MatScale(), MatZeroEntries(), etc. are picked up.
+*/
+PetscErrorCode MatSeqSELLBuild_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqSELL    *sell = (Mat_SeqSELL*)A->spptr;
+  PetscInt       m = A->rmap->n,C,sigma,nslices,i,j,k,l,s,r,w,nrow,*len,*rows,*sliidx,*colidx;
+  PetscInt       *ai = a->i,*aj = a->j;
+  MatScalar      *aa = a->a,*val;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!sell->C) {
+    sell->C     = 8;
+    sell->sigma = 1;
+    ierr = PetscOptionsGetInt(((PetscObject)A)->prefix,"-mat_sell_chunk_size",&sell->C,PETSC_NULL);CHKERRQ(ierr);
+    ierr = PetscOptionsGetInt(((PetscObject)A)->prefix,"-mat_sell_sigma",&sell->sigma,PETSC_NULL);CHKERRQ(ierr);
+  }
+  C     = sell->C;
+  sigma = sell->sigma;
+  if (C < 1 || C > PETSC_SELL_MAXC) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Chunk size %D must be between 1 and %D",C,PETSC_SELL_MAXC);
+  if (sigma < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Sorting window %D must be positive",sigma);
+
+  nslices = (m+C-1)/C;
+  ierr = PetscFree2(sell->val,sell->colidx);CHKERRQ(ierr);
+  ierr = PetscFree2(sell->sliidx,sell->rows);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nslices+1,PetscInt,&sell->sliidx,nslices*C,PetscInt,&sell->rows);CHKERRQ(ierr);
+  sliidx = sell->sliidx;
+  rows   = sell->rows;
+
+  /* order the rows by decreasing length within each window of sigma rows */
+  ierr = PetscMalloc(m*sizeof(PetscInt),&len);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    rows[i] = i;
+    len[i]  = -(ai[i+1] - ai[i]);
+  }
+  for (i=m; i<nslices*C; i++) rows[i] = -1;
+  if (sigma > 1) {
+    for (i=0; i<m; i+=sigma) {
+      ierr = PetscSortIntWithArray(PetscMin(sigma,m-i),len+i,rows+i);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscFree(len);CHKERRQ(ierr);
+
+  /* each slice is as wide as its longest row */
+  sliidx[0] = 0;
+  for (s=0; s<nslices; s++) {
+    w = 0;
+    for (l=0; l<C; l++) {
+      r = rows[s*C+l];
+      if (r >= 0) w = PetscMax(w,ai[r+1]-ai[r]);
+    }
+    sliidx[s+1] = sliidx[s] + w*C;
+  }
+
+  ierr = PetscMalloc2(sliidx[nslices],MatScalar,&sell->val,sliidx[nslices],PetscInt,&sell->colidx);CHKERRQ(ierr);
+  val    = sell->val;
+  colidx = sell->colidx;
+  for (s=0; s<nslices; s++) {
+    w = (sliidx[s+1] - sliidx[s])/C;
+    for (l=0; l<C; l++) {
+      r    = rows[s*C+l];
+      nrow = (r >= 0) ? ai[r+1] - ai[r] : 0;
+      for (j=0,k=sliidx[s]+l; j<nrow; j++,k+=C) {
+        val[k]    = aa[ai[r]+j];
+        colidx[k] = aj[ai[r]+j];
+      }
+      for (; j<w; j++,k+=C) { /* padding, use a column of the row that is already in cache */
+        val[k]    = 0.0;
+        colidx[k] = nrow ? aj[ai[r]+nrow-1] : 0;
+      }
+    }
+  }
+
+  sell->m       = m;
+  sell->nz      = a->nz;
+  sell->nslices = nslices;
+  sell->state   = ((PetscObject)A)->state;
+  ierr = PetscInfo4(A,"Chunk size %D, sorting window %D, %D slices, percentage of 0's introduced for vectorized multiply %g\n",C,sigma,nslices,sliidx[nslices] ? 1.0-((double)a->nz)/((double)sliidx[nslices]) : 0.0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+extern PetscErrorCode MatAssemblyEnd_SeqAIJ(Mat,MatAssemblyType);
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAssemblyEnd_SeqSELL"
+PetscErrorCode MatAssemblyEnd_SeqSELL(Mat A,MatAssemblyType mode)
+{
+  PetscErrorCode ierr;
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+
+  PetscFunctionBegin;
+  a->inode.use = PETSC_FALSE;
+  ierr = MatAssemblyEnd_SeqAIJ(A,mode);CHKERRQ(ierr);
+  /* the SELL arrays are built by the first product after the assembly */
+  PetscFunctionReturn(0);
+}
+
+extern PetscErrorCode MatAXPY_SeqAIJ(Mat,PetscScalar,Mat,MatStructure);
+
+#undef __FUNCT__
+#define __FUNCT__ "MatAXPY_SeqSELL"
+PetscErrorCode MatAXPY_SeqSELL(Mat Y,PetscScalar a,Mat X,MatStructure str)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatAXPY_SeqAIJ(Y,a,X,str);CHKERRQ(ierr);
+  /* MatAXPY() does not change the state of Y, but the values of the SELL copy are now out of date */
+  ierr = PetscObjectStateIncrease((PetscObject)Y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   The products for a chunk height CC. They are expanded with constant CC for the common
+   chunk heights so the compiler can unroll the loops over the rows of a slice into vector
+   instructions; x is gathered and the partial sums are kept in vector registers.
+*/
+#define MatMult_SeqSELL_Slices(CC) \
+  for (s=0; s<nslices; s++) { \
+    for (l=0; l<CC; l++) sum[l] = 0.0; \
+    for (k=sliidx[s]; k<sliidx[s+1]; k+=CC) { \
+      for (l=0; l<CC; l++) sum[l] += val[k+l]*x[colidx[k+l]]; \
+    } \
+    for (l=0; l<CC; l++) { \
+      r = rows[s*CC+l]; \
+      if (r >= 0) y[r] = z ? z[r] + sum[l] : sum[l]; \
+    } \
+  }
+
+#define MatMultTranspose_SeqSELL_Slices(CC) \
+  for (s=0; s<nslices; s++) { \
+    for (l=0; l<CC; l++) { \
+      r     = rows[s*CC+l]; \
+      xl[l] = (r >= 0) ? x[r] : 0.0; \
+    } \
+    for (k=sliidx[s]; k<sliidx[s+1]; k+=CC) { \
+      for (l=0; l<CC; l++) y[colidx[k+l]] += val[k+l]*xl[l]; \
+    } \
+  }
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultAdd_SeqSELL_Private"
+/* y = A x, or y = z + A x if z is not null */
+static PetscErrorCode MatMultAdd_SeqSELL_Private(Mat A,const PetscScalar *x,const PetscScalar *z,PetscScalar *y)
+{
+  Mat_SeqSELL     *sell = (Mat_SeqSELL*)A->spptr;
+  PetscInt        C = sell->C,nslices = sell->nslices,s,k,l,r;
+  const PetscInt  *sliidx = sell->sliidx,*colidx = sell->colidx,*rows = sell->rows;
+  const MatScalar *val = sell->val;
+  PetscScalar     sum[PETSC_SELL_MAXC];
+
+  PetscFunctionBegin;
+  switch (C) {
+  case 4:
+    MatMult_SeqSELL_Slices(4);
+    break;
+  case 8:
+    MatMult_SeqSELL_Slices(8);
+    break;
+  case 16:
+    MatMult_SeqSELL_Slices(16);
+    break;
+  default:
+    MatMult_SeqSELL_Slices(C);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultTransposeAdd_SeqSELL_Private"
+/* y = y + A' x */
+static PetscErrorCode MatMultTransposeAdd_SeqSELL_Private(Mat A,const PetscScalar *x,PetscScalar *y)
+{
+  Mat_SeqSELL     *sell = (Mat_SeqSELL*)A->spptr;
+  PetscInt        C = sell->C,nslices = sell->nslices,s,k,l,r;
+  const PetscInt  *sliidx = sell->sliidx,*colidx = sell->colidx,*rows = sell->rows;
+  const MatScalar *val = sell->val;
+  PetscScalar     xl[PETSC_SELL_MAXC];
+
+  PetscFunctionBegin;
+  switch (C) {
+  case 4:
+    MatMultTranspose_SeqSELL_Slices(4);
+    break;
+  case 8:
+    MatMultTranspose_SeqSELL_Slices(8);
+    break;
+  case 16:
+    MatMultTranspose_SeqSELL_Slices(16);
+    break;
+  default:
+    MatMultTranspose_SeqSELL_Slices(C);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMult_SeqSELL"
+PetscErrorCode MatMult_SeqSELL(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqSELL       *sell = (Mat_SeqSELL*)A->spptr;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (sell->state != ((PetscObject)A)->state) {ierr = MatSeqSELLBuild_Private(A);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  ierr = MatMultAdd_SeqSELL_Private(A,x,PETSC_NULL,y);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*sell->nz - sell->m);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultAdd_SeqSELL"
+PetscErrorCode MatMultAdd_SeqSELL(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqSELL       *sell = (Mat_SeqSELL*)A->spptr;
+  const PetscScalar *x,*y;
+  PetscScalar       *z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (sell->state != ((PetscObject)A)->state) {ierr = MatSeqSELLBuild_Private(A);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(zz,&z);CHKERRQ(ierr);
+  if (zz != yy) {
+    ierr = VecGetArrayRead(yy,&y);CHKERRQ(ierr);
+  } else {
+    y = z;
+  }
+  ierr = MatMultAdd_SeqSELL_Private(A,x,y,z);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*sell->nz);CHKERRQ(ierr);
+  if (zz != yy) {
+    ierr = VecRestoreArrayRead(yy,&y);CHKERRQ(ierr);
+  }
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(zz,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultTransposeAdd_SeqSELL"
+PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqSELL       *sell = (Mat_SeqSELL*)A->spptr;
+  const PetscScalar *x;
+  PetscScalar       *z;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (sell->state != ((PetscObject)A)->state) {ierr = MatSeqSELLBuild_Private(A);CHKERRQ(ierr);}
+  if (zz != yy) {ierr = VecCopy(yy,zz);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(zz,&z);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqSELL_Private(A,x,z);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*sell->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(zz,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatMultTranspose_SeqSELL"
+PetscErrorCode MatMultTranspose_SeqSELL(Mat A,Vec xx,Vec yy)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqSELL(A,xx,yy,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* MatConvert_SeqAIJ_SeqSELL converts a SeqAIJ matrix into a
+ * SeqSELL matrix.  This routine is called by the MatCreate_SeqSELL()
+ * routine, but can also be used to convert an assembled SeqAIJ matrix
+ * into a SeqSELL one. */
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "MatConvert_SeqAIJ_SeqSELL"
+PetscErrorCode  MatConvert_SeqAIJ_SeqSELL(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode ierr;
+  Mat            B = *newmat;
+  Mat_SeqSELL    *sell;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  ierr = PetscNewLog(B,Mat_SeqSELL,&sell);CHKERRQ(ierr);
+  sell->state = -1;
+  B->spptr    = (void*)sell;
+
+  /* Set function pointers for methods that we inherit from AIJ but override. */
+  ((Mat_SeqAIJ*)B->data)->inode.use = PETSC_FALSE;
+  B->ops->assemblyend      = MatAssemblyEnd_SeqSELL;
+  B->ops->destroy          = MatDestroy_SeqSELL;
+  B->ops->axpy             = MatAXPY_SeqSELL;
+  B->ops->mult             = MatMult_SeqSELL;
+  B->ops->multadd          = MatMultAdd_SeqSELL;
+  B->ops->multtranspose    = MatMultTranspose_SeqSELL;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqSELL;
+
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQSELL);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
+#undef __FUNCT__
+#define __FUNCT__ "MatCreateSeqSELL"
+/*@C
+   MatCreateSeqSELL - Creates a sparse matrix of type SEQSELL.
+   This type inherits from AIJ, but keeps a sliced ELLPACK (SELL-C-sigma)
+   copy of the matrix that is used for the products with vectors. The rows
+   are stored in slices of C rows, each padded to the length of its longest
+   row, so the products process C rows at a time with stride-1 access to
+   the matrix entries. As with the AIJ type, it is important to preallocate
+   matrix storage in order to get good assembly performance.
+
+   Collective on MPI_Comm
+
+   Input Parameters:
++  comm - MPI communicator, set to PETSC_COMM_SELF
+.  m - number of rows
+.  n - number of columns
+.  nz - number of nonzeros per row (same for all rows)
+-  nnz - array containing the number of nonzeros in the various rows
+         (possibly different for each row) or PETSC_NULL
+
+   Output Parameter:
+.  A - the matrix
+
+   Options Database Keys:
++  -mat_sell_chunk_size <C> - number of rows in a slice, default 8
+-  -mat_sell_sigma <sigma> - rows are sorted by decreasing length within windows of sigma rows, default 1 (no sorting)
+
+   Notes:
+   If nnz is given then nz is ignored
+
+   Level: intermediate
+
+.keywords: matrix, ellpack, sell, sparse, vectorization
+
+.seealso: MatCreate(), MatCreateMPISELL(), MatCreateSeqAIJCRL(), MatSetValues()
+@*/
+PetscErrorCode  MatCreateSeqSELL(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,const PetscInt nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,m,n);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATSEQSELL);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(*A,nz,nnz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATSEQSELL - MATSEQSELL = "seqsell" - A matrix type for sparse matrices whose products with
+   vectors use the sliced ELLPACK (SELL-C-sigma) format.
+
+   The matrix is assembled and stored in AIJ format and supports all MATSEQAIJ operations. After
+   each change of the matrix the first product builds a copy in which slices of C rows are stored
+   column by column, padded to the longest row of the slice, and that copy is used by MatMult(),
+   MatMultAdd(), MatMultTranspose() and MatMultTransposeAdd().
+
+   Options Database Keys:
++  -mat_type seqsell - sets the matrix type to "seqsell" during a call to MatSetFromOptions()
+.  -mat_sell_chunk_size <C> - number of rows in a slice, at most 64, default 8
+-  -mat_sell_sigma <sigma> - rows are sorted by decreasing length within windows of sigma rows, default 1
+
+   Notes:
+   Choose C as a multiple of the number of scalars in a vector register. A sigma of a few
+   times C reduces the padding for matrices with irregular row lengths, use -info to see the
+   fraction of padding.
+
+   Level: intermediate
+
+.seealso: MatCreateSeqSELL(), MATMPISELL, MATSEQAIJCRL, MATSEQAIJ
+M*/
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "MatCreate_SeqSELL"
+PetscErrorCode  MatCreate_SeqSELL(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqSELL(A,MATSEQSELL,MAT_REUSE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
@@ -0,0 +1,38 @@
+
+#if !defined(__SELL_H)
+#define __SELL_H
+
+#include <../src/mat/impls/aij/seq/aij.h>
+
+/* largest supported chunk height, the kernels keep one partial sum per row of a chunk on the stack */
+#define PETSC_SELL_MAXC 64
+
+/*
+  Mat_SeqSELL - the sliced ELLPACK (SELL-C-sigma) copy of a MATSEQAIJ matrix.
+
+  The rows are grouped into slices of C consecutive rows. Each slice is stored column by
+  column, padded with explicit zeros to its longest row, so a slice is a dense C x width
+  block that is processed C rows at a time. Before slicing, the rows within each window of
+  sigma rows are sorted by decreasing length, which bounds the padding without scattering
+  the rows of the matrix over the whole vector.
+*/
+typedef struct {
+  PetscInt    C;        /* chunk (slice) height */
+  PetscInt    sigma;    /* rows are sorted by length within windows of sigma rows */
+  PetscInt    m;        /* number of rows */
+  PetscInt    nz;       /* number of nonzeros, excluding the padding */
+  PetscInt    nslices;  /* number of slices, (m+C-1)/C */
+  PetscInt    *sliidx;  /* start of each slice in val and colidx, length nslices+1 */
+  PetscInt    *colidx;  /* column indices, padding repeats a valid column of the same row */
+  MatScalar   *val;     /* values, padding is zero */
+  PetscInt    *rows;    /* row of the matrix stored in each slice lane, -1 for the lanes past the last row */
+  PetscInt    state;    /* object state of the matrix the SELL arrays were built from */
+} Mat_SeqSELL;
+
+extern PetscErrorCode MatSeqSELLBuild_Private(Mat);
+extern PetscErrorCode MatMult_SeqSELL(Mat,Vec,Vec);
+extern PetscErrorCode MatMultAdd_SeqSELL(Mat,Vec,Vec,Vec);
+extern PetscErrorCode MatMultTranspose_SeqSELL(Mat,Vec,Vec);
+extern PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat,Vec,Vec,Vec);
+
+#endif
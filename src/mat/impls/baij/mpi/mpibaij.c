@@ -3629,6 +3629,7 @@ PetscErrorCode MatLoad_MPIBAIJ(Mat newmat,PetscViewer viewer)
   PetscMPIInt    tag = ((PetscObject)viewer)->tag;
   PetscInt       *dlens = PETSC_NULL,*odlens = PETSC_NULL,*mask = PETSC_NULL,*masked1 = PETSC_NULL,*masked2 = PETSC_NULL,rowcount,odcount;
   PetscInt       dcount,kmax,k,nzcount,tmp,mend,sizesset=1,grows,gcols;
+  PetscBool      isMPIIO = PETSC_FALSE;
 
   PetscFunctionBegin;
   ierr = PetscOptionsBegin(comm,PETSC_NULL,"Options for loading MPIBAIJ matrix 2","Mat");CHKERRQ(ierr);
@@ -3637,7 +3638,13 @@ PetscErrorCode MatLoad_MPIBAIJ(Mat newmat,PetscViewer viewer)
 
   ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
   ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
-  if (!rank) {
+#if defined(PETSC_HAVE_MPIIO)
+  ierr = PetscViewerBinaryGetMPIIO(viewer,&isMPIIO);CHKERRQ(ierr);
+#endif
+  if (isMPIIO) {
+    ierr = PetscViewerBinaryRead(viewer,header,4,PETSC_INT);CHKERRQ(ierr);
+    if (header[0] != MAT_FILE_CLASSID) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"not matrix object");
+  } else if (!rank) {
     ierr = PetscViewerBinaryGetDescriptor(viewer,&fd);CHKERRQ(ierr);
     ierr = PetscBinaryRead(fd,(char *)header,4,PETSC_INT);CHKERRQ(ierr);
     if (header[0] != MAT_FILE_CLASSID) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"not matrix object");
@@ -3701,7 +3708,13 @@ PetscErrorCode MatLoad_MPIBAIJ(Mat newmat,PetscViewer viewer)
 
   /* distribute row lengths to all processors */
   ierr = PetscMalloc((mmax+1)*sizeof(PetscInt),&locrowlens);CHKERRQ(ierr);
-  if (!rank) {
+  if (isMPIIO) {
+#if defined(PETSC_HAVE_MPIIO)
+    /* every process reads its own rows from the file, the extra rows are padded by the reader */
+    ierr = MatLoadReadRows_MPIIO_Private(viewer,header,browners[rank],m,locrowlens,&ibuf,&buf);CHKERRQ(ierr);
+    mycols = ibuf;
+#endif
+  } else if (!rank) {
     mend = m;
     if (size == 1) mend = mend - extra_rows;
     ierr = PetscBinaryRead(fd,locrowlens,mend,PETSC_INT);CHKERRQ(ierr);
@@ -3728,7 +3741,7 @@ PetscErrorCode MatLoad_MPIBAIJ(Mat newmat,PetscViewer viewer)
     ierr = MPI_Recv(locrowlens,m,MPIU_INT,0,tag,comm,&status);CHKERRQ(ierr);
   }
 
-  if (!rank) {
+  if (!rank && !isMPIIO) {
     /* determine max buffer needed and allocate it */
     maxnz = procsnz[0];
     for (i=1; i<size; i++) {
@@ -3758,7 +3771,7 @@ PetscErrorCode MatLoad_MPIBAIJ(Mat newmat,PetscViewer viewer)
       ierr = MPI_Send(cols,nz+extra_rows,MPIU_INT,size-1,tag,comm);CHKERRQ(ierr);
     }
     ierr = PetscFree(cols);CHKERRQ(ierr);
-  } else {
+  } else if (!isMPIIO) {
     /* determine buffer space needed for message */
     nz = 0;
     for (i=0; i<m; i++) {
@@ -3809,7 +3822,7 @@ PetscErrorCode MatLoad_MPIBAIJ(Mat newmat,PetscViewer viewer)
   }
   ierr = MatMPIBAIJSetPreallocation(newmat,bs,0,dlens,0,odlens);CHKERRQ(ierr);
 
-  if (!rank) {
+  if (!rank && !isMPIIO) {
     ierr = PetscMalloc((maxnz+1)*sizeof(PetscScalar),&buf);CHKERRQ(ierr);
     /* read in my part of the matrix numerical values  */
     nz = procsnz[0];
@@ -3844,13 +3857,15 @@ PetscErrorCode MatLoad_MPIBAIJ(Mat newmat,PetscViewer viewer)
     }
     ierr = PetscFree(procsnz);CHKERRQ(ierr);
   } else {
-    /* receive numeric values */
-    ierr = PetscMalloc((nz+1)*sizeof(PetscScalar),&buf);CHKERRQ(ierr);
+    if (!isMPIIO) {
+      /* receive numeric values */
+      ierr = PetscMalloc((nz+1)*sizeof(PetscScalar),&buf);CHKERRQ(ierr);
 
-    /* receive message of values*/
+      /* receive message of values*/
+      ierr = MPIULong_Recv(buf,nz,MPIU_SCALAR,0,((PetscObject)newmat)->tag,comm);CHKERRQ(ierr);
+    }
     vals   = buf;
     mycols = ibuf;
-    ierr   = MPIULong_Recv(vals,nz,MPIU_SCALAR,0,((PetscObject)newmat)->tag,comm);CHKERRQ(ierr);
 
     /* insert into matrix */
     jj      = rstart*bs;
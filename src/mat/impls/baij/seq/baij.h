@@ -109,6 +109,8 @@ extern PetscErrorCode MatSolve_SeqBAIJ_15_NaturalOrdering_ver2(Mat,Vec,Vec);
 
 extern PetscErrorCode MatSolve_SeqBAIJ_N_inplace(Mat,Vec,Vec);
 extern PetscErrorCode MatSolve_SeqBAIJ_N(Mat,Vec,Vec);
+extern PetscErrorCode MatSolve_SeqBAIJ_N_Levels(Mat,Vec,Vec);
+extern PetscErrorCode MatFactorSetUpSolveLevels_SeqBAIJ(Mat,Mat);
 extern PetscErrorCode MatSolve_SeqBAIJ_N_NaturalOrdering(Mat,Vec,Vec);
 
 extern PetscErrorCode MatSolveTranspose_SeqBAIJ_1_inplace(Mat,Vec,Vec);
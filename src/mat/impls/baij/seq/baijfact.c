@@ -4,6 +4,7 @@
 */
 #include <../src/mat/impls/baij/seq/baij.h>
 #include <../src/mat/blockinvert.h>
+#include <petscthreadcomm.h>
 
 #undef __FUNCT__
 #define __FUNCT__ "MatLUFactorNumeric_SeqBAIJ_2"
@@ -1468,6 +1469,135 @@ PetscErrorCode MatSolve_SeqBAIJ_N(Mat A,Vec bb,Vec xx)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "MatSolveLevels_SeqBAIJ_N_Kernel"
+/*
+   Solves the block rows of one level handled by thread_id, see MatSolveLevels_SeqAIJ_Kernel()
+*/
+PetscErrorCode MatSolveLevels_SeqBAIJ_N_Kernel(PetscInt thread_id,Mat A,const PetscScalar *b,PetscScalar *t,PetscScalar *x,const PetscInt *r,const PetscInt *c,PetscInt *dir,PetscInt *level)
+{
+  Mat_SeqBAIJ            *a = (Mat_SeqBAIJ*)A->data;
+  Mat_SeqAIJ_SolveLevels *sl = &a->solvelevels;
+  const PetscInt         *ai = a->i,*aj = a->j,*adiag = a->diag,*rows = sl->rows[*dir],*ts = sl->tstarts[*dir] + (*level)*(sl->nthreads+1),*vi;
+  PetscInt               i,k,m,nz,bs = A->rmap->bs,bs2 = a->bs2;
+  const MatScalar        *aa = a->a,*v;
+  const PetscScalar      *bi;
+  PetscScalar            *s,*ls = sl->work + bs*thread_id,*xi;
+
+  if (*dir == 0) {
+    for (k=ts[thread_id]; k<ts[thread_id+1]; k++) {
+      i  = rows[k];
+      v  = aa + bs2*ai[i];
+      vi = aj + ai[i];
+      nz = ai[i+1] - ai[i];
+      s  = t + bs*i;
+      bi = b + bs*(r ? r[i] : i);
+      for (m=0; m<bs; m++) s[m] = bi[m];
+      for (m=0; m<nz; m++) {
+        PetscKernel_v_gets_v_minus_A_times_w(bs,s,v,t+bs*vi[m]);
+        v += bs2;
+      }
+    }
+  } else {
+    for (k=ts[thread_id]; k<ts[thread_id+1]; k++) {
+      i  = rows[k];
+      v  = aa + bs2*(adiag[i+1]+1);
+      vi = aj + adiag[i+1]+1;
+      nz = adiag[i] - adiag[i+1] - 1;
+      s  = t + bs*i;
+      for (m=0; m<bs; m++) ls[m] = s[m];
+      for (m=0; m<nz; m++) {
+        PetscKernel_v_gets_v_minus_A_times_w(bs,ls,v,t+bs*vi[m]);
+        v += bs2;
+      }
+      PetscKernel_w_gets_A_times_v(bs,ls,v,s); /* *inv(diagonal[i]) */
+      xi = x + bs*(c ? c[i] : i);
+      for (m=0; m<bs; m++) xi[m] = s[m];
+    }
+  }
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolve_SeqBAIJ_N_Levels"
+/*
+   MatSolve_SeqBAIJ_N() with the block rows of each level computed by all the threads, see MatSolve_SeqAIJ_Levels()
+*/
+PetscErrorCode MatSolve_SeqBAIJ_N_Levels(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqBAIJ            *a = (Mat_SeqBAIJ*)A->data;
+  Mat_SeqAIJ_SolveLevels *sl = &a->solvelevels;
+  PetscErrorCode         ierr;
+  PetscInt               l,dir;
+  const PetscInt         *r = PETSC_NULL,*c = PETSC_NULL;
+  PetscScalar            *x,*t = a->solve_work;
+  const PetscScalar      *b;
+
+  PetscFunctionBegin;
+  if (!a->mbs) PetscFunctionReturn(0);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  if (!sl->natural) {
+    ierr = ISGetIndices(a->row,&r);CHKERRQ(ierr);
+    ierr = ISGetIndices(a->col,&c);CHKERRQ(ierr);
+  }
+
+  for (dir=0; dir<2; dir++) {
+    for (l=0; l<sl->nlevels[dir]; l++) {
+#if defined(PETSC_THREADCOMM_ACTIVE)
+      ierr = PetscThreadCommRunKernel(((PetscObject)A)->comm,(PetscThreadKernel)MatSolveLevels_SeqBAIJ_N_Kernel,8,A,b,t,x,r,c,&dir,&l);CHKERRQ(ierr);
+      ierr = PetscThreadCommBarrier(((PetscObject)A)->comm);CHKERRQ(ierr);
+#else
+      ierr = MatSolveLevels_SeqBAIJ_N_Kernel(0,A,b,t,x,r,c,&dir,&l);CHKERRQ(ierr);
+#endif
+    }
+  }
+
+  if (!sl->natural) {
+    ierr = ISRestoreIndices(a->row,&r);CHKERRQ(ierr);
+    ierr = ISRestoreIndices(a->col,&c);CHKERRQ(ierr);
+  }
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2.0*(a->bs2)*(a->nz) - A->rmap->bs*A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatFactorSetUpSolveLevels_SeqBAIJ"
+/*
+   Called at the end of the numeric LU and ILU factorizations with a general block size, switches the solve to
+   MatSolve_SeqBAIJ_N_Levels() with -mat_solve_levels
+*/
+PetscErrorCode MatFactorSetUpSolveLevels_SeqBAIJ(Mat fact,Mat A)
+{
+  Mat_SeqBAIJ            *b = (Mat_SeqBAIJ*)fact->data;
+  Mat_SeqAIJ_SolveLevels *sl = &b->solvelevels;
+  PetscErrorCode         ierr;
+  PetscInt               n = b->mbs,i,*rs,*re;
+
+  PetscFunctionBegin;
+  ierr = MatSolveLevelsSetFromOptions_Private(fact,A,sl);CHKERRQ(ierr);
+  if (!sl->use) PetscFunctionReturn(0);
+  if (!sl->valid) {
+    ierr = MatSolveLevelsDestroy_Private(sl);CHKERRQ(ierr);
+    ierr = MatSolveLevelsCreate_Private(n,b->i,b->i+1,b->j,PETSC_TRUE,sl->nthreads,&sl->nlevels[0],&sl->start[0],&sl->rows[0],&sl->tstarts[0]);CHKERRQ(ierr);
+    ierr = PetscMalloc2(n,PetscInt,&rs,n,PetscInt,&re);CHKERRQ(ierr);
+    for (i=0; i<n; i++) {
+      rs[i] = b->diag[i+1] + 1;
+      re[i] = b->diag[i];
+    }
+    ierr = MatSolveLevelsCreate_Private(n,rs,re,b->j,PETSC_FALSE,sl->nthreads,&sl->nlevels[1],&sl->start[1],&sl->rows[1],&sl->tstarts[1]);CHKERRQ(ierr);
+    ierr = PetscFree2(rs,re);CHKERRQ(ierr);
+    ierr = PetscMalloc(sl->nthreads*fact->rmap->bs*sizeof(PetscScalar),&sl->work);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory(fact,2*(2*n+(sl->nlevels[0]+sl->nlevels[1])*(sl->nthreads+2))*sizeof(PetscInt)+sl->nthreads*fact->rmap->bs*sizeof(PetscScalar));CHKERRQ(ierr);
+    sl->valid = PETSC_TRUE;
+    ierr = PetscInfo4(fact,"Level scheduled triangular solves with %D and %D levels for %D block rows on %D threads\n",sl->nlevels[0],sl->nlevels[1],n,sl->nthreads);CHKERRQ(ierr);
+  }
+  fact->ops->solve = MatSolve_SeqBAIJ_N_Levels;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "MatBlockAbs_privat"
 /*
@@ -5762,6 +5762,7 @@ PetscErrorCode MatLUFactorNumeric_SeqBAIJ_N(Mat B,Mat A,const MatFactorInfo *inf
 
   C->assembled = PETSC_TRUE;
   ierr = PetscLogFlops(1.333333333333*bs*bs2*b->mbs);CHKERRQ(ierr); /* from inverting diagonal blocks */
+  ierr = MatFactorSetUpSolveLevels_SeqBAIJ(C,A);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -5784,6 +5785,7 @@ PetscErrorCode MatILUFactorSymbolic_SeqBAIJ_ilu0(Mat fact,Mat A,IS isrow,IS isco
   PetscFunctionBegin;
   ierr = MatDuplicateNoCreate_SeqBAIJ(fact,A,MAT_DO_NOT_COPY_VALUES,PETSC_FALSE);CHKERRQ(ierr);
   b    = (Mat_SeqBAIJ*)(fact)->data;
+  b->solvelevels.valid = PETSC_FALSE;
 
   /* allocate matrix arrays for new data structure */
   ierr = PetscMalloc3(bs2*ai[n]+1,PetscScalar,&b->a,ai[n]+1,PetscInt,&b->j,n+1,PetscInt,&b->i);CHKERRQ(ierr);
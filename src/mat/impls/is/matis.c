@@ -185,10 +185,12 @@ PetscErrorCode MatSetLocalToGlobalMapping_IS(Mat A,ISLocalToGlobalMapping rmappi
 }
 
 #define ISG2LMapApply(mapping,n,in,out) 0;\
-  if (!(mapping)->globals) {\
+  if (!(mapping)->globals && !(mapping)->globalht) {\
    PetscErrorCode _ierr = ISGlobalToLocalMappingApply((mapping),IS_GTOLM_MASK,0,0,0,0);CHKERRQ(_ierr);\
   }\
-  {\
+  if ((mapping)->globalht) {\
+   PetscErrorCode _ierr = ISGlobalToLocalMappingApply((mapping),IS_GTOLM_MASK,n,in,PETSC_NULL,out);CHKERRQ(_ierr);\
+  } else {\
     PetscInt _i,*_globals = (mapping)->globals,_start = (mapping)->globalstart,_end = (mapping)->globalend;\
     for (_i=0; _i<n; _i++) {\
       if (in[_i] < 0)           out[_i] = in[_i];\
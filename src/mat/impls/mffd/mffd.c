@@ -256,6 +256,7 @@ PetscErrorCode MatDestroy_MFFD(Mat mat)
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatMFFDSetFunctionError_C","",PETSC_NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatMFFDSetCheckh_C","",PETSC_NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatMFFDSetPeriod_C","",PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)mat,"MatMFFDSetReuseBase_C","",PETSC_NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatMFFDResetHHistory_C","",PETSC_NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)mat,"MatMFFDAddNullSpace_C","",PETSC_NULL);CHKERRQ(ierr);
 
@@ -396,7 +397,17 @@ PetscErrorCode MatMult_MFFD(Mat mat,Vec a,Vec y)
 
   /* compute func(U) as base for differencing; only needed first time in and not when provided by user */
   if (ctx->ncurrenth == 1 && ctx->current_f_allocated) {
-    ierr = (*ctx->func)(ctx->funcctx,U,F);CHKERRQ(ierr);
+    PetscInt ustate;
+
+    ierr = PetscObjectStateQuery((PetscObject)U,&ustate);CHKERRQ(ierr);
+    if (ctx->reusebase && ctx->current_f_uid == ((PetscObject)U)->id && ctx->current_f_ustate == ustate) {
+      ierr = PetscInfo(mat,"Base vector unchanged, reusing the function value\n");CHKERRQ(ierr);
+    } else {
+      ierr = (*ctx->func)(ctx->funcctx,U,F);CHKERRQ(ierr);
+      /* the state after the evaluation, which may have accessed U with VecGetArray() */
+      ierr = PetscObjectStateQuery((PetscObject)U,&ctx->current_f_ustate);CHKERRQ(ierr);
+      ctx->current_f_uid = ((PetscObject)U)->id;
+    }
   }
   ierr = (*ctx->func)(ctx->funcctx,w,y);CHKERRQ(ierr);
 
@@ -630,6 +641,7 @@ PetscErrorCode  MatSetFromOptions_MFFD(Mat mat)
 
   ierr = PetscOptionsReal("-mat_mffd_err","set sqrt relative error in function","MatMFFDSetFunctionError",mfctx->error_rel,&mfctx->error_rel,0);CHKERRQ(ierr);
   ierr = PetscOptionsInt("-mat_mffd_period","how often h is recomputed","MatMFFDSetPeriod",mfctx->recomputeperiod,&mfctx->recomputeperiod,0);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_mffd_reuse_base","Keep the function value at the base while the base does not change","MatMFFDSetReuseBase",mfctx->reusebase,&mfctx->reusebase,0);CHKERRQ(ierr);
 
   flg  = PETSC_FALSE;
   ierr = PetscOptionsBool("-mat_mffd_check_positivity","Insure that U + h*a is nonnegative","MatMFFDSetCheckh",flg,&flg,PETSC_NULL);CHKERRQ(ierr);
@@ -657,6 +669,21 @@ PetscErrorCode  MatMFFDSetPeriod_MFFD(Mat mat,PetscInt period)
 }
 EXTERN_C_END
 
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "MatMFFDSetReuseBase_MFFD"
+PetscErrorCode  MatMFFDSetReuseBase_MFFD(Mat mat,PetscBool reuse)
+{
+  MatMFFD ctx = (MatMFFD)mat->data;
+
+  PetscFunctionBegin;
+  PetscValidLogicalCollectiveBool(mat,reuse,2);
+  ctx->reusebase     = reuse;
+  ctx->current_f_uid = -1;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
 EXTERN_C_BEGIN
 #undef __FUNCT__
 #define __FUNCT__ "MatMFFDSetFunction_MFFD"
@@ -665,8 +692,9 @@ PetscErrorCode  MatMFFDSetFunction_MFFD(Mat mat,PetscErrorCode (*func)(void*,Vec
   MatMFFD ctx = (MatMFFD)mat->data;
 
   PetscFunctionBegin;
-  ctx->func    = func;
-  ctx->funcctx = funcctx;
+  ctx->func          = func;
+  ctx->funcctx       = funcctx;
+  ctx->current_f_uid = -1;
   PetscFunctionReturn(0);
 }
 EXTERN_C_END
@@ -718,6 +746,8 @@ PetscErrorCode  MatCreate_MFFD(Mat A)
 
   mfctx->vshift          = 0.0;
   mfctx->vscale          = 1.0;
+  mfctx->reusebase       = PETSC_FALSE;
+  mfctx->current_f_uid   = -1;
 
   /*
      Create the empty data structure to contain compute-h routines.
@@ -758,6 +788,7 @@ PetscErrorCode  MatCreate_MFFD(Mat A)
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)A,"MatMFFDSetFunction_C","MatMFFDSetFunction_MFFD",MatMFFDSetFunction_MFFD);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)A,"MatMFFDSetCheckh_C","MatMFFDSetCheckh_MFFD",MatMFFDSetCheckh_MFFD);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)A,"MatMFFDSetPeriod_C","MatMFFDSetPeriod_MFFD",MatMFFDSetPeriod_MFFD);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)A,"MatMFFDSetReuseBase_C","MatMFFDSetReuseBase_MFFD",MatMFFDSetReuseBase_MFFD);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)A,"MatMFFDSetFunctionError_C","MatMFFDSetFunctionError_MFFD",MatMFFDSetFunctionError_MFFD);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)A,"MatMFFDResetHHistory_C","MatMFFDResetHHistory_MFFD",MatMFFDResetHHistory_MFFD);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)A,"MatMFFDAddNullSpace_C","MatMFFDAddNullSpace_MFFD",MatMFFDAddNullSpace_MFFD);CHKERRQ(ierr);
@@ -792,7 +823,8 @@ EXTERN_C_END
    Options Database Keys: call MatSetFromOptions() to trigger these
 +  -mat_mffd_type - wp or ds (see MATMFFD_WP or MATMFFD_DS)
 -  -mat_mffd_err - square root of estimated relative error in function evaluation
--  -mat_mffd_period - how often h is recomputed, defaults to 1, everytime
+.  -mat_mffd_period - how often h is recomputed, defaults to 1, everytime
+-  -mat_mffd_reuse_base - keep the function value at the base while the base does not change, see MatMFFDSetReuseBase()
 
 
    Level: advanced
@@ -1010,6 +1042,44 @@ PetscErrorCode  MatMFFDSetPeriod(Mat mat,PetscInt period)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "MatMFFDSetReuseBase"
+/*@
+   MatMFFDSetReuseBase - Sets whether the function value at the base vector that the matrix computes itself is kept
+   while the base vector does not change
+
+   Logically Collective on Mat
+
+   Input Parameters:
++  mat - the matrix free matrix created via MatCreateMFFD()
+-  reuse - PETSC_TRUE to keep the function value
+
+   Options Database Keys:
+.  -mat_mffd_reuse_base <true,false> - Keep the function value at an unchanged base
+
+   Level: advanced
+
+   Notes:
+   When MatMFFDSetBase() is called without a function value, the function is evaluated at the base by the first
+   product after each MatAssemblyEnd(), for example once per linear solve. With this option it is evaluated again only
+   if the base vector is a different vector or has been modified (according to its object state), which saves a
+   function evaluation, and its reductions, in each linear solve at the same base. The function must not depend on
+   data that changes without changing the base vector.
+
+.keywords: SNES, matrix-free, parameters
+
+.seealso: MatMFFDSetBase(), MatMFFDSetPeriod(), MatCreateMFFD()
+@*/
+PetscErrorCode  MatMFFDSetReuseBase(Mat mat,PetscBool reuse)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(mat,MAT_CLASSID,1);
+  ierr = PetscTryMethod(mat,"MatMFFDSetReuseBase_C",(Mat,PetscBool),(mat,reuse));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "MatMFFDSetFunctionError"
 /*@
@@ -65,8 +65,9 @@ typedef struct {
 static PetscErrorCode MatMFFDCompute_DS(MatMFFD ctx,Vec U,Vec a,PetscScalar *h,PetscBool  *zeroa)
 {
   MatMFFD_DS      *hctx = (MatMFFD_DS*)ctx->hctx;
-  PetscReal        nrm,sum,umin = hctx->umin;
-  PetscScalar      dot;
+  PetscReal        nrm = 0.0,sum = 0.0,umin = hctx->umin,norms[2];
+  PetscScalar      dot = 0.0;
+  PetscBool        pending;
   PetscErrorCode   ierr;
 
   PetscFunctionBegin;
@@ -74,14 +75,23 @@ static PetscErrorCode MatMFFDCompute_DS(MatMFFD ctx,Vec U,Vec a,PetscScalar *h,P
     /*
      This algorithm requires 2 norms and 1 inner product. Rather than
      use directly the VecNorm() and VecDot() routines (and thus have
-     three separate collective operations, we use the VecxxxBegin/End() routines
+     three separate collective operations, we use the VecxxxBegin/End() routines;
+     both norms are computed in one pass over a. A pipelined Krylov method may
+     call this while its own split reductions are pending; then the blocking
+     routines are used.
     */
-    ierr = VecDotBegin(U,a,&dot);CHKERRQ(ierr);
-    ierr = VecNormBegin(a,NORM_1,&sum);CHKERRQ(ierr);
-    ierr = VecNormBegin(a,NORM_2,&nrm);CHKERRQ(ierr);
-    ierr = VecDotEnd(U,a,&dot);CHKERRQ(ierr);
-    ierr = VecNormEnd(a,NORM_1,&sum);CHKERRQ(ierr);
-    ierr = VecNormEnd(a,NORM_2,&nrm);CHKERRQ(ierr);
+    ierr = PetscCommSplitReductionGetPending(((PetscObject)U)->comm,&pending);CHKERRQ(ierr);
+    if (!pending) {
+      ierr = VecDotBegin(U,a,&dot);CHKERRQ(ierr);
+      ierr = VecNormBegin(a,NORM_1_AND_2,norms);CHKERRQ(ierr);
+      ierr = VecDotEnd(U,a,&dot);CHKERRQ(ierr);
+      ierr = VecNormEnd(a,NORM_1_AND_2,norms);CHKERRQ(ierr);
+    } else {
+      ierr = VecDot(U,a,&dot);CHKERRQ(ierr);
+      ierr = VecNorm(a,NORM_1_AND_2,norms);CHKERRQ(ierr);
+    }
+    sum = norms[0];
+    nrm = norms[1];
 
     if (nrm == 0.0) {
       *zeroa = PETSC_TRUE;
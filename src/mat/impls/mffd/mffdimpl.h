@@ -45,6 +45,8 @@ struct _p_MatMFFD {    /* context for default matrix-free SNES */
   Vec              current_f;                    /* location of F(u); used with F(u+h) */
   PetscBool        current_f_allocated;
   Vec              current_u;                    /* location of u; used with F(u+h) */
+  PetscBool        reusebase;                    /* keep the computed F(u) while u does not change */
+  PetscInt         current_f_uid,current_f_ustate; /* id and state of the u at which current_f was computed */
 
   PetscErrorCode   (*funci)(void*,PetscInt,Vec,PetscScalar*);  /* Evaluates func_[i]() */
   PetscErrorCode   (*funcisetbase)(void*,Vec);            /* Sets base for future evaluations of func_[i]() */
@@ -10,6 +10,8 @@
         1) || U || does not change between linear iterations so is reused
         2) In GMRES || a || == 1 and so does not need to ever be computed except at restart
            when it is recomputed.
+        3) Norms already known to the vectors (see VecNormAvailable()) are not recomputed, the others are
+           computed together with one reduction.
 
       Reference:  M. Pernice and H. F. Walker, "NITSOL: A Newton Iterative
       Solver for Nonlinear Systems", SIAM J. Sci. Stat. Comput.", 1998,
@@ -64,15 +66,28 @@ static PetscErrorCode MatMFFDCompute_WP(MatMFFD ctx,Vec U,Vec a,PetscScalar *h,P
 {
   MatMFFD_WP    *hctx = (MatMFFD_WP*)ctx->hctx;
   PetscReal      normU,norma;
+  PetscBool      needU,haveU = PETSC_TRUE,havea,pending;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
   if (!(ctx->count % ctx->recomputeperiod)) {
-    if (hctx->computenormU || !ctx->ncurrenth) {
-      ierr = VecNorm(U,NORM_2,&normU);CHKERRQ(ierr);
-      hctx->normUfact = PetscSqrtReal(1.0+normU);
+    needU = (PetscBool)(hctx->computenormU || !ctx->ncurrenth);
+    if (needU) {ierr = VecNormAvailable(U,NORM_2,&haveU,&normU);CHKERRQ(ierr);}
+    ierr = VecNormAvailable(a,NORM_2,&havea,&norma);CHKERRQ(ierr);
+    if (!haveU && !havea) {
+      /* one reduction for both norms, unless a pipelined Krylov method has its own reductions pending */
+      ierr = PetscCommSplitReductionGetPending(((PetscObject)U)->comm,&pending);CHKERRQ(ierr);
+      if (!pending) {
+        ierr  = VecNormBegin(U,NORM_2,&normU);CHKERRQ(ierr);
+        ierr  = VecNormBegin(a,NORM_2,&norma);CHKERRQ(ierr);
+        ierr  = VecNormEnd(U,NORM_2,&normU);CHKERRQ(ierr);
+        ierr  = VecNormEnd(a,NORM_2,&norma);CHKERRQ(ierr);
+        haveU = havea = PETSC_TRUE;
+      }
     }
-    ierr = VecNorm(a,NORM_2,&norma);CHKERRQ(ierr);
+    if (!haveU) {ierr = VecNorm(U,NORM_2,&normU);CHKERRQ(ierr);}
+    if (!havea) {ierr = VecNorm(a,NORM_2,&norma);CHKERRQ(ierr);}
+    if (needU) hctx->normUfact = PetscSqrtReal(1.0+normU);
     if (norma == 0.0) {
       *zeroa = PETSC_TRUE;
       PetscFunctionReturn(0);
@@ -82,6 +97,7 @@ static PetscErrorCode MatMFFDCompute_WP(MatMFFD ctx,Vec U,Vec a,PetscScalar *h,P
   } else {
     *h = ctx->currenth;
   }
+  ctx->count++;
   PetscFunctionReturn(0);
 }
 
@@ -143,6 +143,7 @@ PetscErrorCode MatDestroy_SeqSBAIJ(Mat A)
   ierr = PetscFree(a->sor_work);CHKERRQ(ierr);
   ierr = PetscFree(a->solves_work);CHKERRQ(ierr);
   ierr = PetscFree(a->mult_work);CHKERRQ(ierr);
+  ierr = MatSolveLevelsDestroy_Private(&a->solvelevels);CHKERRQ(ierr);
   ierr = PetscFree(a->saved_values);CHKERRQ(ierr);
   ierr = PetscFree(a->xtoy);CHKERRQ(ierr);
   if (a->free_jshort) {ierr = PetscFree(a->jshort);CHKERRQ(ierr);}
@@ -1702,6 +1703,7 @@ PetscErrorCode  MatSeqSBAIJSetPreallocation_SeqSBAIJ(Mat B,PetscInt bs,PetscInt
   b->bs2          = bs2;
   b->nz           = 0;
   b->maxnz        = nz;
+  b->solvelevels.valid = PETSC_FALSE;
 
   b->inew             = 0;
   b->jnew             = 0;
@@ -1423,6 +1423,7 @@ PetscErrorCode MatCholeskyFactorNumeric_SeqSBAIJ_1_NaturalOrdering(Mat B,Mat A,c
   B->ops->solvetranspose  = MatSolve_SeqSBAIJ_1_NaturalOrdering;
   B->ops->forwardsolve    = MatForwardSolve_SeqSBAIJ_1_NaturalOrdering;
   B->ops->backwardsolve   = MatBackwardSolve_SeqSBAIJ_1_NaturalOrdering;
+  ierr = MatFactorSetUpSolveLevels_SeqSBAIJ_1(B,A);CHKERRQ(ierr);
 
   B->assembled    = PETSC_TRUE;
   B->preallocated = PETSC_TRUE;
@@ -6,6 +6,7 @@
 #include <../src/mat/impls/sbaij/seq/sbaij.h>
 #include <../src/mat/impls/baij/seq/baij.h>
 #include <../src/mat/blockinvert.h>
+#include <petscthreadcomm.h>
 
 #undef __FUNCT__
 #define __FUNCT__ "MatSolve_SeqSBAIJ_N_inplace"
@@ -2017,6 +2018,137 @@ PetscErrorCode MatSolve_SeqSBAIJ_1_NaturalOrdering(Mat A,Vec bb,Vec xx)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "MatSolveLevels_SeqSBAIJ_1_Kernel"
+/*
+   Solves the rows of one level handled by thread_id. The forward solve with U^T*D gathers the unscaled values y of the
+   earlier rows through the columns of U, adding them in the order MatSolve_SeqSBAIJ_1() scatters them.
+*/
+PetscErrorCode MatSolveLevels_SeqSBAIJ_1_Kernel(PetscInt thread_id,Mat A,const PetscScalar *b,PetscScalar *t,PetscScalar *x,const PetscInt *rp,PetscInt *dir,PetscInt *level)
+{
+  Mat_SeqSBAIJ           *a = (Mat_SeqSBAIJ*)A->data;
+  Mat_SeqAIJ_SolveLevels *sl = &a->solvelevels;
+  const PetscInt         *ai = a->i,*aj = a->j,*adiag = a->diag,*rows = sl->rows[*dir],*ts = sl->tstarts[*dir] + (*level)*(sl->nthreads+1);
+  const PetscInt         *ti = sl->ti,*tj = sl->tj,*tv = sl->tv,*vj;
+  const MatScalar        *aa = a->a,*v;
+  PetscScalar            *y = sl->work,sum;
+  PetscInt               i,j,k,nz;
+
+  if (*dir == 0) {
+    for (k=ts[thread_id]; k<ts[thread_id+1]; k++) {
+      i   = rows[k];
+      sum = rp ? b[rp[i]] : b[i];
+      for (j=ti[i]; j<ti[i+1]; j++) sum += aa[tv[j]]*y[tj[j]];
+      y[i] = sum;
+      t[i] = sum*aa[adiag[i]]; /* aa[adiag[i]] = 1/D(i) */
+    }
+  } else {
+    for (k=ts[thread_id]; k<ts[thread_id+1]; k++) {
+      i   = rows[k];
+      v   = aa + adiag[i] - 1;
+      vj  = aj + adiag[i] - 1;
+      nz  = ai[i+1] - ai[i] - 1;
+      sum = t[i];
+      for (j=0; j<nz; j++) sum += v[-j]*t[vj[-j]];
+      t[i] = sum;
+      if (rp) x[rp[i]] = sum;
+    }
+  }
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatSolve_SeqSBAIJ_1_Levels"
+/*
+   MatSolve_SeqSBAIJ_1() with the rows of each level of the forward and backward solves computed by all the threads,
+   see MatSolve_SeqAIJ_Levels()
+*/
+PetscErrorCode MatSolve_SeqSBAIJ_1_Levels(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqSBAIJ           *a = (Mat_SeqSBAIJ*)A->data;
+  Mat_SeqAIJ_SolveLevels *sl = &a->solvelevels;
+  PetscErrorCode         ierr;
+  PetscInt               l,dir;
+  const PetscInt         *rp = PETSC_NULL;
+  PetscScalar            *x,*t;
+  const PetscScalar      *b;
+
+  PetscFunctionBegin;
+  if (!a->mbs) PetscFunctionReturn(0);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  if (sl->natural) {
+    t = x;
+  } else {
+    t    = a->solve_work;
+    ierr = ISGetIndices(a->row,&rp);CHKERRQ(ierr);
+  }
+
+  for (dir=0; dir<2; dir++) {
+    for (l=0; l<sl->nlevels[dir]; l++) {
+#if defined(PETSC_THREADCOMM_ACTIVE)
+      ierr = PetscThreadCommRunKernel(((PetscObject)A)->comm,(PetscThreadKernel)MatSolveLevels_SeqSBAIJ_1_Kernel,7,A,b,t,x,rp,&dir,&l);CHKERRQ(ierr);
+      ierr = PetscThreadCommBarrier(((PetscObject)A)->comm);CHKERRQ(ierr);
+#else
+      ierr = MatSolveLevels_SeqSBAIJ_1_Kernel(0,A,b,t,x,rp,&dir,&l);CHKERRQ(ierr);
+#endif
+    }
+  }
+
+  if (!sl->natural) {ierr = ISRestoreIndices(a->row,&rp);CHKERRQ(ierr);}
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(4.0*a->nz - 3.0*a->mbs);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatFactorSetUpSolveLevels_SeqSBAIJ_1"
+/*
+   Called at the end of the numeric Cholesky and ICC factorizations with block size 1, switches the solve to
+   MatSolve_SeqSBAIJ_1_Levels() with -mat_solve_levels. The forward solve needs U by columns, which is stored in ti, tj
+   and tv with the rows of each column in increasing order.
+*/
+PetscErrorCode MatFactorSetUpSolveLevels_SeqSBAIJ_1(Mat fact,Mat A)
+{
+  Mat_SeqSBAIJ           *b = (Mat_SeqSBAIJ*)fact->data;
+  Mat_SeqAIJ_SolveLevels *sl = &b->solvelevels;
+  PetscErrorCode         ierr;
+  PetscInt               n = b->mbs,i,j,*ai = b->i,*aj = b->j,nz = ai[n]-n,*tnext;
+
+  PetscFunctionBegin;
+  ierr = MatSolveLevelsSetFromOptions_Private(fact,A,sl);CHKERRQ(ierr);
+  if (!sl->use) PetscFunctionReturn(0);
+  if (!sl->valid) {
+    ierr = MatSolveLevelsDestroy_Private(sl);CHKERRQ(ierr);
+    ierr = PetscMalloc3(n+1,PetscInt,&sl->ti,nz,PetscInt,&sl->tj,nz,PetscInt,&sl->tv);CHKERRQ(ierr);
+    ierr = PetscMalloc(n*sizeof(PetscInt),&tnext);CHKERRQ(ierr);
+    ierr = PetscMemzero(sl->ti,(n+1)*sizeof(PetscInt));CHKERRQ(ierr);
+    for (i=0; i<n; i++) {
+      for (j=ai[i]; j<b->diag[i]; j++) sl->ti[aj[j]+1]++;
+    }
+    for (i=0; i<n; i++) {
+      sl->ti[i+1] += sl->ti[i];
+      tnext[i]     = sl->ti[i];
+    }
+    for (i=0; i<n; i++) {
+      for (j=ai[i]; j<b->diag[i]; j++) {
+        sl->tj[tnext[aj[j]]]   = i;
+        sl->tv[tnext[aj[j]]++] = j;
+      }
+    }
+    ierr = PetscFree(tnext);CHKERRQ(ierr);
+    ierr = MatSolveLevelsCreate_Private(n,sl->ti,sl->ti+1,sl->tj,PETSC_TRUE,sl->nthreads,&sl->nlevels[0],&sl->start[0],&sl->rows[0],&sl->tstarts[0]);CHKERRQ(ierr);
+    ierr = MatSolveLevelsCreate_Private(n,ai,b->diag,aj,PETSC_FALSE,sl->nthreads,&sl->nlevels[1],&sl->start[1],&sl->rows[1],&sl->tstarts[1]);CHKERRQ(ierr);
+    ierr = PetscMalloc(n*sizeof(PetscScalar),&sl->work);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory(fact,(n+1+2*nz+2*(2*n+(sl->nlevels[0]+sl->nlevels[1])*(sl->nthreads+2)))*sizeof(PetscInt)+n*sizeof(PetscScalar));CHKERRQ(ierr);
+    sl->valid = PETSC_TRUE;
+    ierr = PetscInfo4(fact,"Level scheduled triangular solves with %D and %D levels for %D rows on %D threads\n",sl->nlevels[0],sl->nlevels[1],n,sl->nthreads);CHKERRQ(ierr);
+  }
+  fact->ops->solve = MatSolve_SeqSBAIJ_1_Levels;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "MatSolve_SeqSBAIJ_1_NaturalOrdering_inplace"
 PetscErrorCode MatSolve_SeqSBAIJ_1_NaturalOrdering_inplace(Mat A,Vec bb,Vec xx)
@@ -34,6 +34,9 @@ extern PetscErrorCode  MatCreate_MPIAIJPERM(Mat);
 extern PetscErrorCode  MatCreate_SeqAIJCRL(Mat);
 extern PetscErrorCode  MatCreate_MPIAIJCRL(Mat);
 
+extern PetscErrorCode  MatCreate_SeqSELL(Mat);
+extern PetscErrorCode  MatCreate_MPISELL(Mat);
+
 extern PetscErrorCode  MatCreate_Scatter(Mat);
 extern PetscErrorCode  MatCreate_BlockMat(Mat);
 extern PetscErrorCode  MatCreate_Nest(Mat);
@@ -104,6 +107,10 @@ PetscErrorCode  MatRegisterAll(const char path[])
   ierr = MatRegisterDynamic(MATSEQAIJCRL,      path,"MatCreate_SeqAIJCRL",  MatCreate_SeqAIJCRL);CHKERRQ(ierr);
   ierr = MatRegisterDynamic(MATMPIAIJCRL,      path,"MatCreate_MPIAIJCRL",  MatCreate_MPIAIJCRL);CHKERRQ(ierr);
 
+  ierr = MatRegisterBaseName(MATSELL,MATSEQSELL,MATMPISELL);CHKERRQ(ierr);
+  ierr = MatRegisterDynamic(MATSEQSELL,        path,"MatCreate_SeqSELL",    MatCreate_SeqSELL);CHKERRQ(ierr);
+  ierr = MatRegisterDynamic(MATMPISELL,        path,"MatCreate_MPISELL",    MatCreate_MPISELL);CHKERRQ(ierr);
+
   ierr = MatRegisterBaseName(MATBAIJ,MATSEQBAIJ,MATMPIBAIJ);CHKERRQ(ierr);
   ierr = MatRegisterDynamic(MATMPIBAIJ,        path,"MatCreate_MPIBAIJ",    MatCreate_MPIBAIJ);CHKERRQ(ierr);
   ierr = MatRegisterDynamic(MATSEQBAIJ,        path,"MatCreate_SeqBAIJ",    MatCreate_SeqBAIJ);CHKERRQ(ierr);
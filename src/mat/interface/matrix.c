@@ -8086,6 +8086,10 @@ PetscErrorCode  MatFactorInfoInitialize(MatFactorInfo *info)
    Output Parameters:
 .  C - the product matrix
 
+   Options Database Keys:
+.  -matptap_allatonce - for MPIAIJ matrices, computes each row of A*P only when it is added to C, without storing the
+                        nonzero structure of A*P or a copy of the local rows of C; this uses less memory
+
    Notes:
    C will be created and must be destroyed by the user with MatDestroy().
 
@@ -8476,6 +8480,11 @@ PetscErrorCode  MatRARtSymbolic(Mat A,Mat R,PetscReal fill,Mat *C)
    Output Parameters:
 .  C - the product matrix
 
+   Options Database Keys:
++  -matmatmult_hash <true,false> - for SeqAIJ matrices, accumulate the rows of C in hash tables instead of dense arrays; by default
+                                   hash tables are used when the dense arrays of all the threads would be larger than C
+-  -matmatmult_llcondensed - for SeqAIJ matrices, use the sequential condensed linked list instead of the threaded algorithm
+
    Notes:
    Unless scall is MAT_REUSE_MATRIX C will be created.
 
@@ -8679,6 +8688,11 @@ PetscErrorCode  MatMatMultNumeric(Mat A,Mat B,Mat C)
    Output Parameters:
 .  C - the product matrix
 
+   Options Database Keys:
++  -matmattransmult_innerproduct - for SeqAIJ matrices, compute each nonzero of C as a sparse inner product instead of
+                                   forming A*B^T with the threaded algorithm on an explicit copy of B^T
+-  -matmattransmult_color - for SeqAIJ matrices, compute C from the dense product of A and a coloring of B^T
+
    Notes:
    C will be created if MAT_INITIAL_MATRIX and must be destroyed by the user with MatDestroy().
 
@@ -5,6 +5,8 @@
 */
 
 #include <petsc-private/matimpl.h>        /*I "petscmat.h" I*/
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <petscthreadcomm.h>
 
 #undef __FUNCT__
 #define __FUNCT__ "MatFDColoringSetF"
@@ -254,6 +256,84 @@ PetscErrorCode  MatFDColoringSetFunction(MatFDColoring matfd,PetscErrorCode (*f)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "MatFDColoringSetFunctionMulti"
+/*@C
+   MatFDColoringSetFunctionMulti - Sets a function that evaluates the function defining the Jacobian at several
+   vectors in one call, so that the perturbed vectors of several colors are evaluated together.
+
+   Logically Collective on MatFDColoring
+
+   Input Parameters:
++  coloring - the coloring context
+.  fmulti - the function
+-  fctx - the optional user-defined function context
+
+   Calling sequence of fmulti:
+$    PetscErrorCode fmulti(void *sctx,PetscInt n,Vec x[],Vec f[],void *fctx)
++  sctx - the SNES, if the Jacobian is computed by SNES, otherwise the context passed to MatFDColoringApply()
+.  n - the number of vectors
+.  x - the vectors at which the function is evaluated
+.  f - the function values at the vectors x
+-  fctx - the user-defined function context
+
+   Level: advanced
+
+   Notes:
+   This is used by MatFDColoringApply() for AIJ matrices; the batches contain at most the number of colors set with
+   MatFDColoringSetBatchSize() or -mat_fd_coloring_batch. When the function of MatFDColoringSetFunction() is also set,
+   it is used for the unperturbed function value. During the evaluation of a batch MatFDColoringGetPerturbedColumns()
+   returns the columns of its first color.
+
+.keywords: Mat, Jacobian, finite differences, set, function
+
+.seealso: MatFDColoringCreate(), MatFDColoringSetFunction(), MatFDColoringSetBatchSize(), MatFDColoringApply()
+
+@*/
+PetscErrorCode  MatFDColoringSetFunctionMulti(MatFDColoring matfd,PetscErrorCode (*fmulti)(void*,PetscInt,Vec[],Vec[],void*),void *fctx)
+{
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(matfd,MAT_FDCOLORING_CLASSID,1);
+  matfd->fmulti    = fmulti;
+  matfd->fmultictx = fctx;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatFDColoringSetBatchSize"
+/*@
+   MatFDColoringSetBatchSize - Sets the number of colors whose perturbed vectors are evaluated together by the
+   function set with MatFDColoringSetFunctionMulti().
+
+   Logically Collective on MatFDColoring
+
+   Input Parameters:
++  coloring - the coloring context
+-  nbatch - the number of colors in a batch, PETSC_DEFAULT for 8
+
+   Options Database Key:
+.  -mat_fd_coloring_batch <nbatch> - Sets the number of colors in a batch
+
+   Level: advanced
+
+   Notes:
+   Each color of a batch needs two work vectors.
+
+.keywords: Mat, Jacobian, finite differences, coloring
+
+.seealso: MatFDColoringSetFunctionMulti(), MatFDColoringApply()
+@*/
+PetscErrorCode  MatFDColoringSetBatchSize(MatFDColoring matfd,PetscInt nbatch)
+{
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(matfd,MAT_FDCOLORING_CLASSID,1);
+  PetscValidLogicalCollectiveInt(matfd,nbatch,2);
+  if (nbatch == PETSC_DEFAULT) nbatch = 8;
+  if (nbatch < 1) SETERRQ1(((PetscObject)matfd)->comm,PETSC_ERR_ARG_OUTOFRANGE,"Batch size %D must be positive",nbatch);
+  matfd->nbatch = nbatch;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "MatFDColoringSetFromOptions"
 /*@
@@ -278,6 +358,8 @@ PetscErrorCode  MatFDColoringSetFunction(MatFDColoring matfd,PetscErrorCode (*f)
            of relative error in the function)
 .  -mat_fd_coloring_umin <umin> - Sets umin, the minimum allowable u-value magnitude
 .  -mat_fd_type - "wp" or "ds" (see MATMFFD_WP or MATMFFD_DS)
+.  -mat_fd_coloring_batch <nbatch> - Sets the number of colors evaluated together by the function of MatFDColoringSetFunctionMulti()
+.  -mat_fd_coloring_set_values - Inserts the differences with MatSetValues() instead of directly into the values of AIJ matrices
 .  -mat_fd_coloring_view - Activates basic viewing
 .  -mat_fd_coloring_view ::ascii_info - Activates viewing info
 -  -mat_fd_coloring_view draw - Activates drawing
@@ -307,6 +389,9 @@ PetscErrorCode  MatFDColoringSetFromOptions(MatFDColoring matfd)
       else if (value[0] == 'd' && value[1] == 's') matfd->htype = "ds";
       else SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Unknown finite differencing type %s",value);
     }
+    ierr = PetscOptionsInt("-mat_fd_coloring_batch","Number of colors evaluated together by the multi-vector function","MatFDColoringSetBatchSize",matfd->nbatch,&matfd->nbatch,0);CHKERRQ(ierr);
+    if (matfd->nbatch < 1) SETERRQ1(((PetscObject)matfd)->comm,PETSC_ERR_ARG_OUTOFRANGE,"Batch size %D must be positive",matfd->nbatch);
+    ierr = PetscOptionsBool("-mat_fd_coloring_set_values","Insert the differences with MatSetValues()","None",matfd->setvalues,&matfd->setvalues,0);CHKERRQ(ierr);
     /* process any options handlers added with PetscObjectAddOptionsHandler() */
     ierr = PetscObjectProcessOptionsHandlers((PetscObject)matfd);CHKERRQ(ierr);
   PetscOptionsEnd();CHKERRQ(ierr);
@@ -384,6 +469,8 @@ PetscErrorCode  MatFDColoringCreate(Mat mat,ISColoring iscoloring,MatFDColoring
   c->currentcolor      = -1;
   c->htype             = "wp";
   c->fset              = PETSC_FALSE;
+  c->nbatch            = 8;
+  c->valaddr_id        = -1;
 
   *color = c;
   ierr = PetscObjectCompose((PetscObject)mat,"SNESMatFDColoring",(PetscObject)c);CHKERRQ(ierr);
@@ -420,6 +507,12 @@ PetscErrorCode  MatFDColoringDestroy(MatFDColoring *c)
     ierr = PetscFree((*c)->rows[i]);CHKERRQ(ierr);
     ierr = PetscFree((*c)->columnsforrow[i]);CHKERRQ(ierr);
     if ((*c)->vscaleforrow) {ierr = PetscFree((*c)->vscaleforrow[i]);CHKERRQ(ierr);}
+    if ((*c)->valaddr) {ierr = PetscFree((*c)->valaddr[i]);CHKERRQ(ierr);}
+  }
+  ierr = PetscFree((*c)->valaddr);CHKERRQ(ierr);
+  if ((*c)->nwork) {
+    ierr = VecDestroyVecs((*c)->nwork,&(*c)->wx);CHKERRQ(ierr);
+    ierr = VecDestroyVecs((*c)->nwork,&(*c)->wf);CHKERRQ(ierr);
   }
   ierr = PetscFree((*c)->ncolumns);CHKERRQ(ierr);
   ierr = PetscFree((*c)->columns);CHKERRQ(ierr);
@@ -490,7 +583,13 @@ PetscErrorCode  MatFDColoringGetPerturbedColumns(MatFDColoring coloring,PetscInt
 
     Level: intermediate
 
-.seealso: MatFDColoringCreate(), MatFDColoringDestroy(), MatFDColoringView(), MatFDColoringSetFunction()
+    Notes:
+    For AIJ matrices that have been assembled the differences are put directly into the values of the matrix, at
+    locations computed once for the coloring, by the threads of the PetscThreadComm of the matrix, unless
+    -mat_fd_coloring_set_values is given. If a function was set with MatFDColoringSetFunctionMulti() the perturbed
+    vectors of several colors are evaluated in one call.
+
+.seealso: MatFDColoringCreate(), MatFDColoringDestroy(), MatFDColoringView(), MatFDColoringSetFunction(), MatFDColoringSetFunctionMulti()
 
 .keywords: coloring, Jacobian, finite differences
 @*/
@@ -502,25 +601,127 @@ PetscErrorCode  MatFDColoringApply(Mat J,MatFDColoring coloring,Vec x1,MatStruct
   PetscValidHeaderSpecific(J,MAT_CLASSID,1);
   PetscValidHeaderSpecific(coloring,MAT_FDCOLORING_CLASSID,2);
   PetscValidHeaderSpecific(x1,VEC_CLASSID,3);
-  if (!coloring->f) SETERRQ(((PetscObject)J)->comm,PETSC_ERR_ARG_WRONGSTATE,"Must call MatFDColoringSetFunction()");
+  if (!coloring->f && !coloring->fmulti) SETERRQ(((PetscObject)J)->comm,PETSC_ERR_ARG_WRONGSTATE,"Must call MatFDColoringSetFunction()");
   if (!J->ops->fdcoloringapply) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_SUP,"Not supported for this matrix type %s",((PetscObject)J)->type_name);
   ierr = (*J->ops->fdcoloringapply)(J,coloring,x1,flag,sctx);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "MatFDColoringBuildValueMap_AIJ"
+/*
+   Computes, for each color and each of its rows, the location of the Jacobian entry in the values of an assembled
+   SeqAIJ or MPIAIJ matrix: k >= 0 is the k-th value of the (diagonal) SeqAIJ block, k < 0 the (-k-1)-th value of the
+   off-diagonal block. The map is kept until the matrix or its number of nonzeros changes.
+*/
+static PetscErrorCode MatFDColoringBuildValueMap_AIJ(Mat J,MatFDColoring coloring,PetscBool *direct)
+{
+  PetscErrorCode ierr;
+  PetscBool      assembled,isseq,ismpi;
+  Mat_SeqAIJ     *a,*b = PETSC_NULL;
+  const PetscInt *garray = PETSC_NULL;
+  PetscInt       k,l,row,col,pos,gpos,nz,cstart,cend,ngarray = 0,**valaddr;
+
+  PetscFunctionBegin;
+  *direct = PETSC_FALSE;
+  if (coloring->setvalues) PetscFunctionReturn(0);
+  ierr = MatAssembled(J,&assembled);CHKERRQ(ierr);
+  if (!assembled) PetscFunctionReturn(0);
+  ierr = PetscObjectTypeCompare((PetscObject)J,MATSEQAIJ,&isseq);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)J,MATMPIAIJ,&ismpi);CHKERRQ(ierr);
+  if (isseq) {
+    a      = (Mat_SeqAIJ*)J->data;
+    nz     = a->nz;
+    cstart = 0;
+    cend   = J->cmap->n;
+  } else if (ismpi) {
+    Mat_MPIAIJ *aij = (Mat_MPIAIJ*)J->data;
+    if (!aij->garray) PetscFunctionReturn(0);
+    a       = (Mat_SeqAIJ*)aij->A->data;
+    b       = (Mat_SeqAIJ*)aij->B->data;
+    garray  = aij->garray;
+    ngarray = aij->B->cmap->n;
+    nz      = a->nz + b->nz;
+    cstart  = J->cmap->rstart;
+    cend    = J->cmap->rend;
+  } else PetscFunctionReturn(0);
+  if (coloring->valaddr && coloring->valaddr_id == ((PetscObject)J)->id && coloring->valaddr_nz == nz) {
+    *direct = PETSC_TRUE;
+    PetscFunctionReturn(0);
+  }
+
+  if (!coloring->valaddr) {
+    ierr = PetscMalloc(coloring->ncolors*sizeof(PetscInt*),&coloring->valaddr);CHKERRQ(ierr);
+    for (k=0; k<coloring->ncolors; k++) {
+      ierr = PetscMalloc((coloring->nrows[k]+1)*sizeof(PetscInt),&coloring->valaddr[k]);CHKERRQ(ierr);
+      ierr = PetscLogObjectMemory(coloring,(coloring->nrows[k]+1)*sizeof(PetscInt));CHKERRQ(ierr);
+    }
+    ierr = PetscLogObjectMemory(coloring,coloring->ncolors*sizeof(PetscInt*));CHKERRQ(ierr);
+  }
+  valaddr              = coloring->valaddr;
+  coloring->valaddr_id = -1;
+  for (k=0; k<coloring->ncolors; k++) {
+    for (l=0; l<coloring->nrows[k]; l++) {
+      row = coloring->rows[k][l];
+      col = coloring->columnsforrow[k][l];
+      if (col >= cstart && col < cend) {
+        ierr = PetscFindInt(col-cstart,a->i[row+1]-a->i[row],a->j+a->i[row],&pos);CHKERRQ(ierr);
+        if (pos < 0) break;
+        valaddr[k][l] = a->i[row] + pos;
+      } else {
+        if (!b) break;
+        ierr = PetscFindInt(col,ngarray,garray,&gpos);CHKERRQ(ierr);
+        if (gpos < 0) break;
+        ierr = PetscFindInt(gpos,b->i[row+1]-b->i[row],b->j+b->i[row],&pos);CHKERRQ(ierr);
+        if (pos < 0) break;
+        valaddr[k][l] = -(b->i[row] + pos) - 1;
+      }
+    }
+    if (l < coloring->nrows[k]) {
+      ierr = PetscInfo2(coloring,"Entry of local row %D, column %D not in the nonzero structure; using MatSetValues()\n",row,col);CHKERRQ(ierr);
+      PetscFunctionReturn(0);
+    }
+  }
+  coloring->valaddr_id = ((PetscObject)J)->id;
+  coloring->valaddr_nz = nz;
+  ierr = PetscInfo1(coloring,"Computed the locations of the differences in the values of the matrix, %D nonzeros\n",nz);CHKERRQ(ierr);
+  *direct = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Puts the differences y[rows[l]] of one color, scaled by vscale[vsr[l]], at the locations addr[l] of the values aa of
+   the diagonal block and ba of the off-diagonal block; each thread takes a contiguous part of the rows.
+   sizes[] is {number of rows, number of threads}.
+*/
+PetscErrorCode MatFDColoringSetValues_AIJ_Kernel(PetscInt thread_id,PetscInt *sizes,PetscInt *rows,PetscInt *addr,PetscInt *vsr,PetscScalar *y,PetscScalar *vscale,PetscScalar *aa,PetscScalar *ba)
+{
+  PetscInt n = sizes[0],nt = sizes[1],lstart,lend,l,p;
+
+  lstart = thread_id*(n/nt) + PetscMin(thread_id,n%nt);
+  lend   = lstart + n/nt + (thread_id < n%nt ? 1 : 0);
+  for (l=lstart; l<lend; l++) {
+    p = addr[l];
+    if (p >= 0) aa[p]    = y[rows[l]]*vscale[vsr[l]];
+    else        ba[-p-1] = y[rows[l]]*vscale[vsr[l]];
+  }
+  return 0;
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "MatFDColoringApply_AIJ"
 PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,MatStructure *flag,void *sctx)
 {
   PetscErrorCode (*f)(void*,Vec,Vec,void*) = (PetscErrorCode (*)(void*,Vec,Vec,void *))coloring->f;
+  PetscErrorCode (*fmulti)(void*,PetscInt,Vec[],Vec[],void*) = coloring->fmulti;
   PetscErrorCode ierr;
-  PetscInt       k,start,end,l,row,col,srow,**vscaleforrow;
+  PetscInt       k,k0,i,nb,kn,start,end,l,row,col,srow,**vscaleforrow,sizes[2];
   PetscScalar    dx,*y,*xx,*w3_array;
-  PetscScalar    *vscale_array;
+  PetscScalar    *vscale_array,*aa = PETSC_NULL,*ba = PETSC_NULL;
   PetscReal      epsilon = coloring->error_rel,umin = coloring->umin,unorm;
-  Vec            w1=coloring->w1,w2=coloring->w2,w3;
+  Vec            w1=coloring->w1,w2=coloring->w2,w3,xk,yk;
   void           *fctx = coloring->fctx;
-  PetscBool      flg = PETSC_FALSE;
+  PetscBool      flg = PETSC_FALSE,direct;
   PetscInt       ctype=coloring->ctype,N,col_start=0,col_end=0;
   Vec            x1_tmp;
 
@@ -528,7 +729,7 @@ PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,MatSt
   PetscValidHeaderSpecific(J,MAT_CLASSID,1);
   PetscValidHeaderSpecific(coloring,MAT_FDCOLORING_CLASSID,2);
   PetscValidHeaderSpecific(x1,VEC_CLASSID,3);
-  if (!f) SETERRQ(((PetscObject)J)->comm,PETSC_ERR_ARG_WRONGSTATE,"Must call MatFDColoringSetFunction()");
+  if (!f && !fmulti) SETERRQ(((PetscObject)J)->comm,PETSC_ERR_ARG_WRONGSTATE,"Must call MatFDColoringSetFunction()");
 
   ierr = PetscLogEventBegin(MAT_FDColoringApply,coloring,J,x1,0);CHKERRQ(ierr);
   ierr = MatSetUnfactored(J);CHKERRQ(ierr);
@@ -556,7 +757,11 @@ PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,MatSt
   /* Set w1 = F(x1) */
   if (!coloring->fset) {
     ierr = PetscLogEventBegin(MAT_FDColoringFunction,0,0,0,0);CHKERRQ(ierr);
-    ierr = (*f)(sctx,x1_tmp,w1,fctx);CHKERRQ(ierr);
+    if (f) {
+      ierr = (*f)(sctx,x1_tmp,w1,fctx);CHKERRQ(ierr);
+    } else {
+      ierr = (*fmulti)(sctx,1,&x1_tmp,&w1,coloring->fmultictx);CHKERRQ(ierr);
+    }
     ierr = PetscLogEventEnd(MAT_FDColoringFunction,0,0,0,0);CHKERRQ(ierr);
   } else {
     coloring->fset = PETSC_FALSE;
@@ -568,6 +773,25 @@ PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,MatSt
   }
   w3 = coloring->w3;
 
+  /* with a multi-vector function the colors are perturbed and evaluated in batches of nb */
+  nb = 1;
+  if (fmulti) {
+    nb = PetscMax(1,PetscMin(coloring->nbatch,coloring->ncolors));
+    if (coloring->nwork < nb) {
+      if (coloring->nwork) {
+        ierr = VecDestroyVecs(coloring->nwork,&coloring->wx);CHKERRQ(ierr);
+        ierr = VecDestroyVecs(coloring->nwork,&coloring->wf);CHKERRQ(ierr);
+      }
+      ierr = VecDuplicateVecs(x1_tmp,nb,&coloring->wx);CHKERRQ(ierr);
+      ierr = VecDuplicateVecs(w1,nb,&coloring->wf);CHKERRQ(ierr);
+      for (i=0; i<nb; i++) {
+        ierr = PetscLogObjectParent(coloring,coloring->wx[i]);CHKERRQ(ierr);
+        ierr = PetscLogObjectParent(coloring,coloring->wf[i]);CHKERRQ(ierr);
+      }
+      coloring->nwork = nb;
+    }
+  }
+
     /* Compute all the local scale factors, including ghost points */
   ierr = VecGetLocalSize(x1_tmp,&N);CHKERRQ(ierr);
   ierr = VecGetArray(x1_tmp,&xx);CHKERRQ(ierr);
@@ -603,58 +827,98 @@ PetscErrorCode  MatFDColoringApply_AIJ(Mat J,MatFDColoring coloring,Vec x1,MatSt
     vscaleforrow = coloring->vscaleforrow;
   } else SETERRQ(((PetscObject)J)->comm,PETSC_ERR_ARG_NULL,"Null Object: coloring->vscaleforrow");
 
+  /* when the locations of the entries in the values of the matrix are known the differences are put there directly */
+  ierr = MatFDColoringBuildValueMap_AIJ(J,coloring,&direct);CHKERRQ(ierr);
+  if (direct) {
+    PetscBool ismpi;
+    ierr = PetscObjectTypeCompare((PetscObject)J,MATMPIAIJ,&ismpi);CHKERRQ(ierr);
+    if (ismpi) {
+      Mat_MPIAIJ *aij = (Mat_MPIAIJ*)J->data;
+      aa = ((Mat_SeqAIJ*)aij->A->data)->a;
+      ba = ((Mat_SeqAIJ*)aij->B->data)->a;
+    } else aa = ((Mat_SeqAIJ*)J->data)->a;
+    sizes[1] = 1;
+#if defined(PETSC_THREADCOMM_ACTIVE)
+    ierr = PetscThreadCommGetNThreads(((PetscObject)J)->comm,&sizes[1]);CHKERRQ(ierr);
+#endif
+  }
+
   /*
-    Loop over each color
+    Loop over each batch of colors
   */
   ierr = VecGetArray(coloring->vscale,&vscale_array);CHKERRQ(ierr);
-  for (k=0; k<coloring->ncolors; k++) {
-    coloring->currentcolor = k;
-    ierr = VecCopy(x1_tmp,w3);CHKERRQ(ierr);
-    ierr = VecGetArray(w3,&w3_array);CHKERRQ(ierr);
-    if (ctype == IS_COLORING_GLOBAL) w3_array = w3_array - start;
-    /*
-      Loop over each column associated with color
-      adding the perturbation to the vector w3.
-    */
-    for (l=0; l<coloring->ncolumns[k]; l++) {
-      col = coloring->columns[k][l];    /* local column of the matrix we are probing for */
-      if (coloring->htype[0] == 'w') {
-        dx = 1.0 + unorm;
-      } else {
-        dx  = xx[col];
+  for (k0=0; k0<coloring->ncolors; k0+=nb) {
+    kn = PetscMin(nb,coloring->ncolors-k0);
+    coloring->currentcolor = k0;
+    for (i=0; i<kn; i++) {
+      k    = k0 + i;
+      xk   = fmulti ? coloring->wx[i] : w3;
+      ierr = VecCopy(x1_tmp,xk);CHKERRQ(ierr);
+      ierr = VecGetArray(xk,&w3_array);CHKERRQ(ierr);
+      if (ctype == IS_COLORING_GLOBAL) w3_array = w3_array - start;
+      /*
+        Loop over each column associated with color
+        adding the perturbation to the vector xk.
+      */
+      for (l=0; l<coloring->ncolumns[k]; l++) {
+        col = coloring->columns[k][l];    /* local column of the matrix we are probing for */
+        if (coloring->htype[0] == 'w') {
+          dx = 1.0 + unorm;
+        } else {
+          dx  = xx[col];
+        }
+        if (dx == (PetscScalar)0.0) dx = 1.0;
+        if (PetscAbsScalar(dx) < umin && PetscRealPart(dx) >= 0.0)     dx = umin;
+        else if (PetscRealPart(dx) < 0.0 && PetscAbsScalar(dx) < umin) dx = -umin;
+        dx            *= epsilon;
+        if (!PetscAbsScalar(dx)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Computed 0 differencing parameter");
+        w3_array[col] += dx;
       }
-      if (dx == (PetscScalar)0.0) dx = 1.0;
-      if (PetscAbsScalar(dx) < umin && PetscRealPart(dx) >= 0.0)     dx = umin;
-      else if (PetscRealPart(dx) < 0.0 && PetscAbsScalar(dx) < umin) dx = -umin;
-      dx            *= epsilon;
-      if (!PetscAbsScalar(dx)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Computed 0 differencing parameter");
-      w3_array[col] += dx;
+      if (ctype == IS_COLORING_GLOBAL) w3_array = w3_array + start;
+      ierr = VecRestoreArray(xk,&w3_array);CHKERRQ(ierr);
     }
-    if (ctype == IS_COLORING_GLOBAL) w3_array = w3_array + start;
-    ierr = VecRestoreArray(w3,&w3_array);CHKERRQ(ierr);
 
     /*
-      Evaluate function at w3 = x1 + dx (here dx is a vector of perturbations)
-                           w2 = F(x1 + dx) - F(x1)
+      Evaluate function at xk = x1 + dx (here dx is a vector of perturbations)
+                           yk = F(x1 + dx) - F(x1)
     */
     ierr = PetscLogEventBegin(MAT_FDColoringFunction,0,0,0,0);CHKERRQ(ierr);
-    ierr = (*f)(sctx,w3,w2,fctx);CHKERRQ(ierr);
+    if (fmulti) {
+      ierr = (*fmulti)(sctx,kn,coloring->wx,coloring->wf,coloring->fmultictx);CHKERRQ(ierr);
+    } else {
+      ierr = (*f)(sctx,w3,w2,fctx);CHKERRQ(ierr);
+    }
     ierr = PetscLogEventEnd(MAT_FDColoringFunction,0,0,0,0);CHKERRQ(ierr);
-    ierr = VecAXPY(w2,-1.0,w1);CHKERRQ(ierr);
 
-    /*
-      Loop over rows of vector, putting results into Jacobian matrix
-    */
-    ierr = VecGetArray(w2,&y);CHKERRQ(ierr);
-    for (l=0; l<coloring->nrows[k]; l++) {
-      row    = coloring->rows[k][l];             /* local row index */
-      col    = coloring->columnsforrow[k][l];    /* global column index */
-      y[row] *= vscale_array[vscaleforrow[k][l]];
-      srow   = row + start;
-      ierr   = MatSetValues(J,1,&srow,1,&col,y+row,INSERT_VALUES);CHKERRQ(ierr);
+    for (i=0; i<kn; i++) {
+      k    = k0 + i;
+      yk   = fmulti ? coloring->wf[i] : w2;
+      ierr = VecAXPY(yk,-1.0,w1);CHKERRQ(ierr);
+
+      /*
+        Loop over rows of vector, putting results into Jacobian matrix
+      */
+      ierr = VecGetArray(yk,&y);CHKERRQ(ierr);
+      if (direct) {
+        sizes[0] = coloring->nrows[k];
+#if defined(PETSC_THREADCOMM_ACTIVE)
+        ierr = PetscThreadCommRunKernel(((PetscObject)J)->comm,(PetscThreadKernel)MatFDColoringSetValues_AIJ_Kernel,8,sizes,coloring->rows[k],coloring->valaddr[k],vscaleforrow[k],y,vscale_array,aa,ba);CHKERRQ(ierr);
+        ierr = PetscThreadCommBarrier(((PetscObject)J)->comm);CHKERRQ(ierr);
+#else
+        ierr = MatFDColoringSetValues_AIJ_Kernel(0,sizes,coloring->rows[k],coloring->valaddr[k],vscaleforrow[k],y,vscale_array,aa,ba);CHKERRQ(ierr);
+#endif
+      } else {
+        for (l=0; l<coloring->nrows[k]; l++) {
+          row    = coloring->rows[k][l];             /* local row index */
+          col    = coloring->columnsforrow[k][l];    /* global column index */
+          y[row] *= vscale_array[vscaleforrow[k][l]];
+          srow   = row + start;
+          ierr   = MatSetValues(J,1,&srow,1,&col,y+row,INSERT_VALUES);CHKERRQ(ierr);
+        }
+      }
+      ierr = VecRestoreArray(yk,&y);CHKERRQ(ierr);
     }
-    ierr = VecRestoreArray(w2,&y);CHKERRQ(ierr);
-  } /* endof for each color */
+  } /* endof for each batch of colors */
   if (ctype == IS_COLORING_GLOBAL) xx = xx + start;
   ierr = VecRestoreArray(coloring->vscale,&vscale_array);CHKERRQ(ierr);
   ierr = VecRestoreArray(x1_tmp,&xx);CHKERRQ(ierr);
@@ -0,0 +1,87 @@
+
+/*
+   Routines shared by the MatLoad() implementations of the parallel matrix formats
+*/
+#include <petsc-private/matimpl.h>
+
+#if defined(PETSC_HAVE_MPIIO)
+#undef __FUNCT__
+#define __FUNCT__ "MatLoadReadBlock_MPIIO_Private"
+/*
+   Collectively reads count entries of type dtype located disp bytes past the current offset
+   of the viewer, each process passes its own disp and count. Does not move the viewer offset.
+*/
+static PetscErrorCode MatLoadReadBlock_MPIIO_Private(PetscViewer viewer,MPI_Offset disp,void *data,PetscInt count,PetscDataType dtype)
+{
+  PetscErrorCode ierr;
+  MPI_File       mfdes;
+  MPI_Offset     off;
+  MPI_Datatype   mdtype;
+
+  PetscFunctionBegin;
+  ierr = PetscDataTypeToMPIDataType(dtype,&mdtype);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryGetMPIIODescriptor(viewer,&mfdes);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryGetMPIIOOffset(viewer,&off);CHKERRQ(ierr);
+  ierr = MPI_File_set_view(mfdes,off+disp,mdtype,mdtype,(char *)"native",MPI_INFO_NULL);CHKERRQ(ierr);
+  ierr = MPIU_File_read_all(mfdes,data,PetscMPIIntCast(count),mdtype,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatLoadReadRows_MPIIO_Private"
+/*
+   MatLoadReadRows_MPIIO_Private - Each process reads its own rows of a matrix stored in PETSc
+   binary format directly from the file with MPI-IO, instead of having the first process read the
+   whole file and send the pieces to the others.
+
+   Collective on PetscViewer
+
+   Input Parameters:
++  viewer - binary viewer in MPI-IO mode, positioned just after the header
+.  header - the header of the matrix, read with PetscViewerBinaryRead()
+.  rstart - first row owned by this process
+-  m - number of rows owned by this process
+
+   Output Parameters:
++  rowlens - the length of each of the m rows, allocated by the caller
+.  cols - the column indices of the rows, free with PetscFree()
+-  vals - the values of the rows, free with PetscFree()
+
+   Notes:
+   Rows at or past header[1] are not in the file, they are returned with a unit diagonal entry.
+   This is the padding the block formats add when the number of rows is not divisible by the
+   block size. On return the viewer is positioned after the matrix.
+
+   The number of nonzeros read by each process must fit in an int, as MPI-IO counts do.
+*/
+PetscErrorCode MatLoadReadRows_MPIIO_Private(PetscViewer viewer,const PetscInt header[],PetscInt rstart,PetscInt m,PetscInt rowlens[],PetscInt **cols,PetscScalar **vals)
+{
+  PetscErrorCode ierr;
+  MPI_Comm       comm = ((PetscObject)viewer)->comm;
+  PetscInt       M = header[1],NZ = header[3],mfile,nz = 0,nzend,nztotal,i;
+  MPI_Offset     isize = (MPI_Offset)sizeof(PetscInt),ssize = (MPI_Offset)sizeof(PetscScalar);
+
+  PetscFunctionBegin;
+  mfile = PetscMax(0,PetscMin(m,M-rstart));
+  ierr  = MatLoadReadBlock_MPIIO_Private(viewer,isize*PetscMax(0,PetscMin(rstart,M)),rowlens,mfile,PETSC_INT);CHKERRQ(ierr);
+  for (i=0; i<mfile; i++) nz += rowlens[i];
+  for (i=mfile; i<m; i++) rowlens[i] = 1;
+
+  /* the nonzeros of this process follow those of the processes with lower rank */
+  ierr = MPI_Scan(&nz,&nzend,1,MPIU_INT,MPI_SUM,comm);CHKERRQ(ierr);
+  ierr = MPI_Allreduce(&nz,&nztotal,1,MPIU_INT,MPI_SUM,comm);CHKERRQ(ierr);
+  if (nztotal != NZ) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_FILE_UNEXPECTED,"Row lengths in file add up to %D, header says %D nonzeros",nztotal,NZ);
+
+  ierr = PetscMalloc((nz+m-mfile+1)*sizeof(PetscInt),cols);CHKERRQ(ierr);
+  ierr = PetscMalloc((nz+m-mfile+1)*sizeof(PetscScalar),vals);CHKERRQ(ierr);
+  ierr = MatLoadReadBlock_MPIIO_Private(viewer,isize*(M+nzend-nz),*cols,nz,PETSC_INT);CHKERRQ(ierr);
+  ierr = MatLoadReadBlock_MPIIO_Private(viewer,isize*(M+NZ)+ssize*(nzend-nz),*vals,nz,PETSC_SCALAR);CHKERRQ(ierr);
+  for (i=mfile; i<m; i++) {
+    (*cols)[nz] = rstart + i;
+    (*vals)[nz] = 1.0;
+    nz++;
+  }
+  ierr = PetscViewerBinaryAddMPIIOOffset(viewer,isize*(M+NZ)+ssize*NZ);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
@@ -133,10 +133,10 @@ PetscErrorCode MatStashScatterEnd_Private(MatStash *stash)
   ierr = PetscFree(stash->send_waits);CHKERRQ(ierr);
   ierr = PetscFree(stash->recv_waits);CHKERRQ(ierr);
   ierr = PetscFree2(stash->svalues,stash->sindices);CHKERRQ(ierr);
-  ierr = PetscFree(stash->rvalues[0]);CHKERRQ(ierr);
-  ierr = PetscFree(stash->rvalues);CHKERRQ(ierr);
-  ierr = PetscFree(stash->rindices[0]);CHKERRQ(ierr);
-  ierr = PetscFree(stash->rindices);CHKERRQ(ierr);
+  for (i=0; i<stash->nrecvs; i++) {
+    ierr = PetscFree2(stash->rindices[i],stash->rvalues[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(stash->rindices,stash->rvalues);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -415,6 +415,63 @@ PetscErrorCode MatStashValuesColBlocked_Private(MatStash *stash,PetscInt row,Pet
   space->local_remaining -= n;
   PetscFunctionReturn(0);
 }
+/*
+   Context for the callbacks of PetscCommBuildTwoSidedF() used by MatStashScatterBegin_Private(). The
+   rendezvous message to each rank is the number of stashed entries sent to it.
+*/
+typedef struct {
+  PetscInt    bs2;
+  PetscInt    *sindices;     /* row and column indices packed by destination, see MatStashScatterBegin_Private() */
+  PetscScalar *svalues;      /* values packed by destination */
+  PetscInt    *sstarts;      /* location of the first entry going to each destination */
+  PetscInt    nrecvs,nralloc;
+  PetscInt    **rindices;    /* one buffer per received message */
+  PetscScalar **rvalues;
+} MatStashBTS;
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashBTSSend_Private"
+static PetscErrorCode MatStashBTSSend_Private(MPI_Comm comm,const PetscMPIInt tag[],PetscMPIInt i,PetscMPIInt rank,void *sdata,MPI_Request req[],void *ctx)
+{
+  MatStashBTS    *bts = (MatStashBTS*)ctx;
+  PetscMPIInt    n = *(PetscMPIInt*)sdata;
+  PetscInt       start = bts->sstarts[i];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Isend(bts->sindices+2*start,2*n,MPIU_INT,rank,tag[0],comm,&req[0]);CHKERRQ(ierr);
+  ierr = MPI_Isend(bts->svalues+bts->bs2*start,bts->bs2*n,MPIU_SCALAR,rank,tag[1],comm,&req[1]);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "MatStashBTSRecv_Private"
+static PetscErrorCode MatStashBTSRecv_Private(MPI_Comm comm,const PetscMPIInt tag[],PetscMPIInt rank,void *rdata,MPI_Request req[],void *ctx)
+{
+  MatStashBTS    *bts = (MatStashBTS*)ctx;
+  PetscMPIInt    n = *(PetscMPIInt*)rdata;
+  PetscInt       k = bts->nrecvs;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (k == bts->nralloc) {
+    PetscInt    **rindices,nralloc = PetscMax(2*bts->nralloc,4);
+    PetscScalar **rvalues;
+    ierr = PetscMalloc2(nralloc,PetscInt*,&rindices,nralloc,PetscScalar*,&rvalues);CHKERRQ(ierr);
+    ierr = PetscMemcpy(rindices,bts->rindices,k*sizeof(PetscInt*));CHKERRQ(ierr);
+    ierr = PetscMemcpy(rvalues,bts->rvalues,k*sizeof(PetscScalar*));CHKERRQ(ierr);
+    ierr = PetscFree2(bts->rindices,bts->rvalues);CHKERRQ(ierr);
+    bts->rindices = rindices;
+    bts->rvalues  = rvalues;
+    bts->nralloc  = nralloc;
+  }
+  ierr = PetscMalloc2(2*n,PetscInt,&bts->rindices[k],bts->bs2*n,PetscScalar,&bts->rvalues[k]);CHKERRQ(ierr);
+  ierr = MPI_Irecv(bts->rindices[k],2*n,MPIU_INT,rank,tag[0],comm,&req[0]);CHKERRQ(ierr);
+  ierr = MPI_Irecv(bts->rvalues[k],bts->bs2*n,MPIU_SCALAR,rank,tag[1],comm,&req[1]);CHKERRQ(ierr);
+  bts->nrecvs++;
+  PetscFunctionReturn(0);
+}
+
 /*
   MatStashScatterBegin_Private - Initiates the transfer of values to the
   correct owners. This function goes through the stash, and check the
@@ -429,29 +486,33 @@ PetscErrorCode MatStashValuesColBlocked_Private(MatStash *stash,PetscInt row,Pet
   Notes: The 'owners' array in the cased of the blocked-stash has the
   ranges specified blocked global indices, and for the regular stash in
   the proper global indices.
+
+  The receiving processes and the message lengths are discovered with
+  PetscCommBuildTwoSidedF(), which posts the messages with the stashed
+  values during the rendezvous instead of first gathering the number and
+  lengths of the messages over all processes.
 */
 #undef __FUNCT__
 #define __FUNCT__ "MatStashScatterBegin_Private"
 PetscErrorCode MatStashScatterBegin_Private(Mat mat,MatStash *stash,PetscInt *owners)
 {
-  PetscInt          *owner,*startv,*starti,tag1=stash->tag1,tag2=stash->tag2,bs2;
-  PetscInt          size=stash->size,nsends;
+  PetscInt          *owner,*startv,*starti,bs2;
+  PetscInt          size=stash->size,nsends,nreceives;
   PetscErrorCode    ierr;
-  PetscInt          count,*sindices,**rindices,i,j,idx,lastidx,l;
-  PetscScalar       **rvalues,*svalues;
+  PetscInt          count,*sindices,i,j,idx,lastidx,l;
+  PetscScalar       *svalues;
   MPI_Comm          comm = stash->comm;
-  MPI_Request       *send_waits,*recv_waits,*recv_waits1,*recv_waits2;
-  PetscMPIInt       *nprocs,*nlengths,nreceives;
+  MPI_Request       *send_waits,*recv_waits;
+  PetscMPIInt       *nlengths,*sendranks,*sendlens,*recvranks,*recvlens;
   PetscInt          *sp_idx,*sp_idy;
   PetscScalar       *sp_val;
   PetscMatStashSpace space,space_next;
+  MatStashBTS       bts;
 
   PetscFunctionBegin;
   bs2 = stash->bs*stash->bs;
 
   /*  first count number of contributors to each processor */
-  ierr  = PetscMalloc(size*sizeof(PetscMPIInt),&nprocs);CHKERRQ(ierr);
-  ierr  = PetscMemzero(nprocs,size*sizeof(PetscMPIInt));CHKERRQ(ierr);
   ierr  = PetscMalloc(size*sizeof(PetscMPIInt),&nlengths);CHKERRQ(ierr);
   ierr  = PetscMemzero(nlengths,size*sizeof(PetscMPIInt));CHKERRQ(ierr);
   ierr  = PetscMalloc((stash->n+1)*sizeof(PetscInt),&owner);CHKERRQ(ierr);
@@ -477,31 +538,16 @@ PetscErrorCode MatStashScatterBegin_Private(Mat mat,MatStash *stash,PetscInt *ow
   }
   /* Now check what procs get messages - and compute nsends. */
   for (i=0, nsends=0 ; i<size; i++) {
-    if (nlengths[i]) { nprocs[i] = 1; nsends ++;}
-  }
-
-  {PetscMPIInt  *onodes,*olengths;
-  /* Determine the number of messages to expect, their lengths, from from-ids */
-  ierr = PetscGatherNumberOfMessages(comm,nprocs,nlengths,&nreceives);CHKERRQ(ierr);
-  ierr = PetscGatherMessageLengths(comm,nsends,nreceives,nlengths,&onodes,&olengths);CHKERRQ(ierr);
-  /* since clubbing row,col - lengths are multiplied by 2 */
-  for (i=0; i<nreceives; i++) olengths[i] *=2;
-  ierr = PetscPostIrecvInt(comm,tag1,nreceives,onodes,olengths,&rindices,&recv_waits1);CHKERRQ(ierr);
-  /* values are size 'bs2' lengths (and remove earlier factor 2 */
-  for (i=0; i<nreceives; i++) olengths[i] = olengths[i]*bs2/2;
-  ierr = PetscPostIrecvScalar(comm,tag2,nreceives,onodes,olengths,&rvalues,&recv_waits2);CHKERRQ(ierr);
-  ierr = PetscFree(onodes);CHKERRQ(ierr);
-  ierr = PetscFree(olengths);CHKERRQ(ierr);
+    if (nlengths[i]) nsends++;
   }
 
-  /* do sends:
-      1) starts[i] gives the starting index in svalues for stuff going to
+  /* pack the stash by destination:
+      1) startv[i] gives the starting index in svalues for stuff going to
          the ith processor
+      2) the row indices going to the ith processor are followed by the column indices
   */
   ierr     = PetscMalloc2(bs2*stash->n,PetscScalar,&svalues,2*(stash->n+1),PetscInt,&sindices);CHKERRQ(ierr);
-  ierr     = PetscMalloc(2*nsends*sizeof(MPI_Request),&send_waits);CHKERRQ(ierr);
   ierr     = PetscMalloc2(size,PetscInt,&startv,size,PetscInt,&starti);CHKERRQ(ierr);
-  /* use 2 sends the first with all_a, the next with all_i and all_j */
   startv[0]  = 0; starti[0] = 0;
   for (i=1; i<size; i++) {
     startv[i] = startv[i-1] + nlengths[i-1];
@@ -537,40 +583,67 @@ PetscErrorCode MatStashScatterBegin_Private(Mat mat,MatStash *stash,PetscInt *ow
   startv[0] = 0;
   for (i=1; i<size; i++) { startv[i] = startv[i-1] + nlengths[i-1];}
 
+  ierr = PetscMalloc3(nsends,PetscMPIInt,&sendranks,nsends,PetscMPIInt,&sendlens,nsends,PetscInt,&bts.sstarts);CHKERRQ(ierr);
   for (i=0,count=0; i<size; i++) {
-    if (nprocs[i]) {
-      ierr = MPI_Isend(sindices+2*startv[i],2*nlengths[i],MPIU_INT,i,tag1,comm,send_waits+count++);CHKERRQ(ierr);
-      ierr = MPI_Isend(svalues+bs2*startv[i],bs2*nlengths[i],MPIU_SCALAR,i,tag2,comm,send_waits+count++);CHKERRQ(ierr);
+    if (nlengths[i]) {
+      sendranks[count]    = i;
+      sendlens[count]     = nlengths[i];
+      bts.sstarts[count++] = startv[i];
     }
   }
 #if defined(PETSC_USE_INFO)
   ierr = PetscInfo1(mat,"No of messages: %d \n",nsends);CHKERRQ(ierr);
-  for (i=0; i<size; i++) {
-    if (nprocs[i]) {
-      ierr = PetscInfo2(mat,"Mesg_to: %d: size: %d \n",i,nlengths[i]*bs2*sizeof(PetscScalar)+2*sizeof(PetscInt));CHKERRQ(ierr);
-    }
+  for (i=0; i<nsends; i++) {
+    ierr = PetscInfo2(mat,"Mesg_to: %d: size: %d \n",sendranks[i],sendlens[i]*bs2*sizeof(PetscScalar)+2*sizeof(PetscInt));CHKERRQ(ierr);
   }
 #endif
+
+  /* the messages with the row,col indices and the values are sent during the rendezvous */
+  bts.bs2      = bs2;
+  bts.sindices = sindices;
+  bts.svalues  = svalues;
+  bts.nrecvs   = 0;
+  bts.nralloc  = 0;
+  bts.rindices = PETSC_NULL;
+  bts.rvalues  = PETSC_NULL;
+  ierr = PetscCommBuildTwoSidedF(comm,1,MPI_INT,nsends,sendranks,sendlens,&nreceives,&recvranks,&recvlens,2,&send_waits,&recv_waits,MatStashBTSSend_Private,MatStashBTSRecv_Private,&bts);CHKERRQ(ierr);
+
+  if (stash->reproduce) {
+    /* process the messages in the order of the sending ranks, not in the order of arrival */
+    PetscMPIInt *perm;
+    PetscInt    **rindices;
+    PetscScalar **rvalues;
+    MPI_Request *waits;
+
+    ierr = PetscMalloc(nreceives*sizeof(PetscMPIInt),&perm);CHKERRQ(ierr);
+    for (i=0; i<nreceives; i++) perm[i] = i;
+    ierr = PetscSortMPIIntWithArray(nreceives,recvranks,perm);CHKERRQ(ierr);
+    ierr = PetscMalloc3(nreceives,PetscInt*,&rindices,nreceives,PetscScalar*,&rvalues,2*nreceives,MPI_Request,&waits);CHKERRQ(ierr);
+    for (i=0; i<nreceives; i++) {
+      rindices[i]   = bts.rindices[perm[i]];
+      rvalues[i]    = bts.rvalues[perm[i]];
+      waits[2*i]    = recv_waits[2*perm[i]];
+      waits[2*i+1]  = recv_waits[2*perm[i]+1];
+    }
+    ierr = PetscMemcpy(bts.rindices,rindices,nreceives*sizeof(PetscInt*));CHKERRQ(ierr);
+    ierr = PetscMemcpy(bts.rvalues,rvalues,nreceives*sizeof(PetscScalar*));CHKERRQ(ierr);
+    ierr = PetscMemcpy(recv_waits,waits,2*nreceives*sizeof(MPI_Request));CHKERRQ(ierr);
+    ierr = PetscFree3(rindices,rvalues,waits);CHKERRQ(ierr);
+    ierr = PetscFree(perm);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(recvranks);CHKERRQ(ierr);
+  ierr = PetscFree(recvlens);CHKERRQ(ierr);
+  ierr = PetscFree3(sendranks,sendlens,bts.sstarts);CHKERRQ(ierr);
   ierr = PetscFree(nlengths);CHKERRQ(ierr);
   ierr = PetscFree(owner);CHKERRQ(ierr);
   ierr = PetscFree2(startv,starti);CHKERRQ(ierr);
-  ierr = PetscFree(nprocs);CHKERRQ(ierr);
-
-  /* recv_waits need to be contiguous for MatStashScatterGetMesg_Private() */
-  ierr  = PetscMalloc(2*nreceives*sizeof(MPI_Request),&recv_waits);CHKERRQ(ierr);
-
-  for (i=0; i<nreceives; i++) {
-    recv_waits[2*i]   = recv_waits1[i];
-    recv_waits[2*i+1] = recv_waits2[i];
-  }
-  stash->recv_waits = recv_waits;
-  ierr = PetscFree(recv_waits1);CHKERRQ(ierr);
-  ierr = PetscFree(recv_waits2);CHKERRQ(ierr);
 
+  /* recv_waits are contiguous pairs (indices,values) as needed by MatStashScatterGetMesg_Private() */
+  stash->recv_waits  = recv_waits;
   stash->svalues     = svalues;
   stash->sindices    = sindices;
-  stash->rvalues     = rvalues;
-  stash->rindices    = rindices;
+  stash->rvalues     = bts.rvalues;
+  stash->rindices    = bts.rindices;
   stash->send_waits  = send_waits;
   stash->nsends      = nsends;
   stash->nrecvs      = nreceives;
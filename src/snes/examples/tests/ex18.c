@@ -0,0 +1,162 @@
+static char help[] = "Tests matrix-free Jacobian-vector products in a pipelined Krylov method and the reuse of the base function.\n\n\
+  -n <n>        number of grid points\n\n";
+
+/*
+   The Jacobian of F(u) = -u'' + u^3 is applied with MatCreateMFFD() for each way of computing h, checked against
+   the assembled Jacobian and used by KSPGROPPCG, which calls MatMult() while its own reductions are pending. The base
+   is set without a function value and two linear solves are done at the same base; with -mat_mffd_reuse_base the
+   function is evaluated at the base only once.
+*/
+#include <petscdmda.h>
+#include <petscksp.h>
+
+typedef struct {
+  DM       da;
+  Vec      base;
+  PetscInt nbase;      /* number of evaluations of the function at the base */
+} AppCtx;
+
+#undef __FUNCT__
+#define __FUNCT__ "FormFunction"
+static PetscErrorCode FormFunction(void *ptr,Vec X,Vec F)
+{
+  AppCtx         *user = (AppCtx*)ptr;
+  PetscErrorCode ierr;
+  Vec            Xl;
+  PetscScalar    *x,*f,d;
+  PetscInt       i,xs,xm,mx;
+
+  PetscFunctionBegin;
+  if (X == user->base) user->nbase++;
+  ierr = DMDAGetInfo(user->da,0,&mx,0,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(user->da,&xs,0,0,&xm,0,0);CHKERRQ(ierr);
+  d    = (PetscScalar)(mx+1)*(mx+1);
+  ierr = DMGetLocalVector(user->da,&Xl);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalBegin(user->da,X,INSERT_VALUES,Xl);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(user->da,X,INSERT_VALUES,Xl);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(user->da,Xl,&x);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(user->da,F,&f);CHKERRQ(ierr);
+  for (i=xs; i<xs+xm; i++) {
+    f[i] = d*(2.0*x[i] - (i > 0 ? x[i-1] : 0.0) - (i < mx-1 ? x[i+1] : 0.0)) + x[i]*x[i]*x[i];
+  }
+  ierr = DMDAVecRestoreArray(user->da,Xl,&x);CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArray(user->da,F,&f);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(user->da,&Xl);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "FormJacobian"
+static PetscErrorCode FormJacobian(AppCtx *user,Vec X,Mat A)
+{
+  PetscErrorCode ierr;
+  PetscScalar    *x,d,v[3];
+  PetscInt       i,xs,xm,mx,col[3];
+
+  PetscFunctionBegin;
+  ierr = DMDAGetInfo(user->da,0,&mx,0,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(user->da,&xs,0,0,&xm,0,0);CHKERRQ(ierr);
+  d    = (PetscScalar)(mx+1)*(mx+1);
+  ierr = DMDAVecGetArray(user->da,X,&x);CHKERRQ(ierr);
+  for (i=xs; i<xs+xm; i++) {
+    col[0] = i-1; col[1] = i; col[2] = i+1;
+    v[0]   = -d;  v[1]   = 2.0*d + 3.0*x[i]*x[i]; v[2] = -d;
+    if (i == 0) {
+      ierr = MatSetValues(A,1,&i,2,col+1,v+1,INSERT_VALUES);CHKERRQ(ierr);
+    } else if (i == mx-1) {
+      ierr = MatSetValues(A,1,&i,2,col,v,INSERT_VALUES);CHKERRQ(ierr);
+    } else {
+      ierr = MatSetValues(A,1,&i,3,col,v,INSERT_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = DMDAVecRestoreArray(user->da,X,&x);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **args)
+{
+  PetscErrorCode ierr;
+  AppCtx         user;
+  PetscInt       n = 40,t,solve;
+  Mat            A,J;
+  Vec            b,x,y,z;
+  KSP            ksp;
+  PC             pc;
+  PetscRandom    rand;
+  PetscReal      nrm,err;
+  const char     *types[2] = {MATMFFD_WP,MATMFFD_DS};
+
+  PetscInitialize(&argc,&args,(char *)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = DMDACreate1d(PETSC_COMM_WORLD,DMDA_BOUNDARY_NONE,n,1,1,PETSC_NULL,&user.da);CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(user.da,&user.base);CHKERRQ(ierr);
+  ierr = VecDuplicate(user.base,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(user.base,&x);CHKERRQ(ierr);
+  ierr = VecDuplicate(user.base,&y);CHKERRQ(ierr);
+  ierr = VecDuplicate(user.base,&z);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(user.base,rand);CHKERRQ(ierr);
+  ierr = VecSetRandom(b,rand);CHKERRQ(ierr);
+
+  ierr = DMCreateMatrix(user.da,MATAIJ,&A);CHKERRQ(ierr);
+  ierr = FormJacobian(&user,user.base,A);CHKERRQ(ierr);
+
+  for (t=0; t<2; t++) {
+    ierr = MatCreateMFFD(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,n,n,&J);CHKERRQ(ierr);
+    ierr = MatMFFDSetFunction(J,FormFunction,&user);CHKERRQ(ierr);
+    ierr = MatMFFDSetType(J,types[t]);CHKERRQ(ierr);
+    ierr = MatSetFromOptions(J);CHKERRQ(ierr);
+    ierr = MatMFFDSetBase(J,user.base,PETSC_NULL);CHKERRQ(ierr);
+    user.nbase = 0;
+
+    /* the product with a vector of O(1) entries */
+    ierr = MatMult(J,b,y);CHKERRQ(ierr);
+    ierr = MatMult(A,b,z);CHKERRQ(ierr);
+    ierr = VecNorm(z,NORM_2,&nrm);CHKERRQ(ierr);
+    ierr = VecAXPY(y,-1.0,z);CHKERRQ(ierr);
+    ierr = VecNorm(y,NORM_2,&err);CHKERRQ(ierr);
+    if (err > 1.e-5*nrm) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: product differs from the Jacobian by %G\n",types[t],err/nrm);CHKERRQ(ierr);
+    }
+
+    /* two linear solves at the same base, each starting with MatAssemblyBegin/End() as SNES does */
+    ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+    ierr = KSPSetOperators(ksp,J,J,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = KSPSetType(ksp,KSPGROPPCG);CHKERRQ(ierr);
+    ierr = KSPSetTolerances(ksp,1.e-6,PETSC_DEFAULT,PETSC_DEFAULT,200);CHKERRQ(ierr);
+    ierr = KSPSetFromOptions(ksp);CHKERRQ(ierr);
+    ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+    ierr = PCSetType(pc,PCNONE);CHKERRQ(ierr);
+    for (solve=0; solve<2; solve++) {
+      ierr = MatAssemblyBegin(J,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+      ierr = MatAssemblyEnd(J,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+      ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+      ierr = MatMult(A,x,y);CHKERRQ(ierr);
+      ierr = VecAXPY(y,-1.0,b);CHKERRQ(ierr);
+      ierr = VecNorm(y,NORM_2,&err);CHKERRQ(ierr);
+      ierr = VecNorm(b,NORM_2,&nrm);CHKERRQ(ierr);
+      if (err > 1.e-4*nrm) {
+        ierr = PetscPrintf(PETSC_COMM_WORLD,"%s, solve %D: residual %G\n",types[t],solve,err/nrm);CHKERRQ(ierr);
+      }
+    }
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: checked, %D evaluations at the base\n",types[t],user.nbase);CHKERRQ(ierr);
+    ierr = KSPDestroy(&ksp);CHKERRQ(ierr);
+    ierr = MatDestroy(&J);CHKERRQ(ierr);
+  }
+
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&user.base);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = DMDestroy(&user.da);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,135 @@
+static char help[] = "Tests computing the residual on a DMDA while the ghost values are exchanged.\n\n\
+  -dim <2,3>         dimension of the grid\n\
+  -M <M>             number of grid points in each direction\n\
+  -sw <s>            stencil width\n\
+  -box               use the box stencil instead of the star\n\
+  -periodic          periodic in all directions\n\n";
+
+/*
+   The interior box and the boundary strips of DMDAGetLocalInfoSplit() must cover the owned points exactly once, and the
+   residual of a local function reading all the points within the stencil width must not change with
+   -dmda_snes_overlap. The residual is first computed at two states so the cached local vector holds the ghost values
+   of the other state when the computation of the interior starts.
+*/
+#include <petscsnes.h>
+#include <petscdmda.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "FormFunctionLocal"
+static PetscErrorCode FormFunctionLocal(DMDALocalInfo *info,void *xx,void *ff,void *ptr)
+{
+  PetscInt    i,j,k,di,dj,dk,s = info->sw,kmax = info->dim == 3 ? s : 0;
+  PetscBool   periodic = (PetscBool)(info->bx == DMDA_BOUNDARY_PERIODIC);
+  PetscScalar v;
+
+  PetscFunctionBegin;
+  for (k=info->zs; k<info->zs+info->zm; k++) {
+    for (j=info->ys; j<info->ys+info->ym; j++) {
+      for (i=info->xs; i<info->xs+info->xm; i++) {
+        v = 0.0;
+        for (dk=-kmax; dk<=kmax; dk++) {
+          for (dj=-s; dj<=s; dj++) {
+            for (di=-s; di<=s; di++) {
+              PetscScalar xv;
+              if (info->st == DMDA_STENCIL_STAR && ((di != 0) + (dj != 0) + (dk != 0)) > 1) continue;
+              if (!periodic && (i+di < 0 || i+di >= info->mx || j+dj < 0 || j+dj >= info->my || k+dk < 0 || k+dk >= info->mz)) continue;
+              xv = info->dim == 3 ? ((PetscScalar***)xx)[k+dk][j+dj][i+di] : ((PetscScalar**)xx)[j+dj][i+di];
+              v += xv*xv/(1.0 + PetscAbsInt(di) + 2*PetscAbsInt(dj) + 3*PetscAbsInt(dk));
+            }
+          }
+        }
+        if (info->dim == 3) ((PetscScalar***)ff)[k][j][i] = v;
+        else ((PetscScalar**)ff)[j][i] = v;
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode   ierr;
+  PetscInt         dim = 3,M = 9,sw = 1,i,j,k,p,nboundary,bad = 0,gbad,idx;
+  PetscBool        box = PETSC_FALSE,periodic = PETSC_FALSE;
+  DM               da;
+  SNES             snes;
+  Vec              X[2],F[2],G;
+  PetscReal        diff[2];
+  PetscInt         *count;
+  DMDALocalInfo    info,interior,boundary[6],*piece;
+  DMDABoundaryType bt;
+  PetscRandom      rand;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-dim",&dim,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-M",&M,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-sw",&sw,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-box",&box,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-periodic",&periodic,PETSC_NULL);CHKERRQ(ierr);
+
+  bt = periodic ? DMDA_BOUNDARY_PERIODIC : DMDA_BOUNDARY_NONE;
+  if (dim == 2) {
+    ierr = DMDACreate2d(PETSC_COMM_WORLD,bt,bt,box ? DMDA_STENCIL_BOX : DMDA_STENCIL_STAR,M,M,PETSC_DECIDE,PETSC_DECIDE,1,sw,0,0,&da);CHKERRQ(ierr);
+  } else {
+    ierr = DMDACreate3d(PETSC_COMM_WORLD,bt,bt,bt,box ? DMDA_STENCIL_BOX : DMDA_STENCIL_STAR,M,M,M,PETSC_DECIDE,PETSC_DECIDE,PETSC_DECIDE,1,sw,0,0,0,&da);CHKERRQ(ierr);
+  }
+
+  /* each owned point must be in exactly one piece */
+  ierr = DMDAGetLocalInfo(da,&info);CHKERRQ(ierr);
+  ierr = DMDAGetLocalInfoSplit(da,&interior,&nboundary,boundary);CHKERRQ(ierr);
+  ierr = PetscMalloc(info.xm*info.ym*info.zm*sizeof(PetscInt),&count);CHKERRQ(ierr);
+  ierr = PetscMemzero(count,info.xm*info.ym*info.zm*sizeof(PetscInt));CHKERRQ(ierr);
+  for (p=-1; p<nboundary; p++) {
+    piece = p < 0 ? &interior : &boundary[p];
+    for (k=piece->zs; k<piece->zs+piece->zm; k++) {
+      for (j=piece->ys; j<piece->ys+piece->ym; j++) {
+        for (i=piece->xs; i<piece->xs+piece->xm; i++) {
+          if (i < info.xs || i >= info.xs+info.xm || j < info.ys || j >= info.ys+info.ym || k < info.zs || k >= info.zs+info.zm) {bad++; continue;}
+          idx = (i-info.xs) + info.xm*((j-info.ys) + info.ym*(k-info.zs));
+          count[idx]++;
+        }
+      }
+    }
+  }
+  for (i=0; i<info.xm*info.ym*info.zm; i++) if (count[i] != 1) bad++;
+  ierr = PetscFree(count);CHKERRQ(ierr);
+  ierr = MPI_Allreduce(&bad,&gbad,1,MPIU_INT,MPI_SUM,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  if (gbad) {ierr = PetscPrintf(PETSC_COMM_WORLD,"The interior and the boundary strips do not cover the owned points once\n");CHKERRQ(ierr);}
+  else {ierr = PetscPrintf(PETSC_COMM_WORLD,"The interior and the boundary strips cover the owned points once\n");CHKERRQ(ierr);}
+
+  ierr = SNESCreate(PETSC_COMM_WORLD,&snes);CHKERRQ(ierr);
+  ierr = SNESSetDM(snes,da);CHKERRQ(ierr);
+  ierr = DMDASNESSetFunctionLocal(da,INSERT_VALUES,FormFunctionLocal,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  for (i=0; i<2; i++) {
+    ierr = DMCreateGlobalVector(da,&X[i]);CHKERRQ(ierr);
+    ierr = VecDuplicate(X[i],&F[i]);CHKERRQ(ierr);
+    ierr = VecSetRandom(X[i],rand);CHKERRQ(ierr);
+    ierr = SNESComputeFunction(snes,X[i],F[i]);CHKERRQ(ierr);
+  }
+  ierr = VecDuplicate(F[0],&G);CHKERRQ(ierr);
+  /* the same as DMDASNESSetOverlap(da,PETSC_TRUE), through the options of the SNES */
+  ierr = PetscOptionsSetValue("-dmda_snes_overlap","1");CHKERRQ(ierr);
+  ierr = SNESSetFromOptions(snes);CHKERRQ(ierr);
+  for (i=0; i<2; i++) {
+    ierr = SNESComputeFunction(snes,X[i],G);CHKERRQ(ierr);
+    ierr = VecAXPY(G,-1.0,F[i]);CHKERRQ(ierr);
+    ierr = VecNorm(G,NORM_INFINITY,&diff[i]);CHKERRQ(ierr);
+  }
+  if (diff[0] != 0.0 || diff[1] != 0.0) {ierr = PetscPrintf(PETSC_COMM_WORLD,"The residuals computed with overlap differ by %G and %G\n",diff[0],diff[1]);CHKERRQ(ierr);}
+  else {ierr = PetscPrintf(PETSC_COMM_WORLD,"The residuals computed with overlap are the same\n");CHKERRQ(ierr);}
+
+  for (i=0; i<2; i++) {
+    ierr = VecDestroy(&X[i]);CHKERRQ(ierr);
+    ierr = VecDestroy(&F[i]);CHKERRQ(ierr);
+  }
+  ierr = VecDestroy(&G);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = SNESDestroy(&snes);CHKERRQ(ierr);
+  ierr = DMDestroy(&da);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
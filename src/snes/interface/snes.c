@@ -809,6 +809,12 @@ PetscErrorCode  SNESSetFromOptions(SNES snes)
     ierr = PetscOptionsEnum("-snes_npc_side","SNES nonlinear preconditioner side","SNESSetPCSide",PCSides,(PetscEnum)pcside,(PetscEnum*)&pcside,&flg);CHKERRQ(ierr);
     if (flg) {ierr = SNESSetPCSide(snes,pcside);CHKERRQ(ierr);}
 
+    if (snes->dm) {
+      DMSNES sdm;
+      ierr = DMGetDMSNES(snes->dm,&sdm);CHKERRQ(ierr);
+      if (sdm->ops->setfromoptions) {ierr = (*sdm->ops->setfromoptions)(snes,sdm);CHKERRQ(ierr);}
+    }
+
     for (i = 0; i < numberofsetfromoptions; i++) {
       ierr = (*othersetfromoptions[i])(snes);CHKERRQ(ierr);
     }
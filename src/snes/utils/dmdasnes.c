@@ -16,6 +16,10 @@ typedef struct {
   PetscErrorCode (*rhsplocal)(DMDALocalInfo*,void*,void*,void*);
   PetscErrorCode (*jacobianplocal)(DMDALocalInfo*,void*,Mat,Mat,MatStructure*,void*);
   void *picardlocalctx;
+
+  /*   For computing the interior while the ghost values are exchanged */
+  PetscBool      overlap;
+  PetscLogDouble overlapwork,overlapwait; /* totals over all evaluations */
 } DMSNES_DA;
 
 #undef __FUNCT__
@@ -44,6 +48,21 @@ static PetscErrorCode DMSNESDuplicate_DMDA(DMSNES oldsdm,DMSNES sdm)
 }
 
 
+#undef __FUNCT__
+#define __FUNCT__ "DMSNESSetFromOptions_DMDA"
+/* called by SNESSetFromOptions(), within its PetscOptionsBegin() so the options take the prefix of the SNES */
+static PetscErrorCode DMSNESSetFromOptions_DMDA(SNES snes,DMSNES sdm)
+{
+  DMSNES_DA      *dmdasnes = (DMSNES_DA*)sdm->data;
+  PetscBool      overlap = dmdasnes->overlap,flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsBool("-dmda_snes_overlap","Compute the interior of the subdomain while the ghost values are exchanged","DMDASNESSetOverlap",overlap,&overlap,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = DMDASNESSetOverlap(snes->dm,overlap);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "DMDASNESGetContext"
 static PetscErrorCode DMDASNESGetContext(DM dm,DMSNES sdm,DMSNES_DA  **dmdasnes)
@@ -54,13 +73,65 @@ static PetscErrorCode DMDASNESGetContext(DM dm,DMSNES sdm,DMSNES_DA  **dmdasnes)
   *dmdasnes = PETSC_NULL;
   if (!sdm->data) {
     ierr = PetscNewLog(dm,DMSNES_DA ,&sdm->data);CHKERRQ(ierr);
-    sdm->ops->destroy   = DMSNESDestroy_DMDA;
-    sdm->ops->duplicate = DMSNESDuplicate_DMDA;
+    sdm->ops->destroy        = DMSNESDestroy_DMDA;
+    sdm->ops->duplicate      = DMSNESDuplicate_DMDA;
+    sdm->ops->setfromoptions = DMSNESSetFromOptions_DMDA;
   }
   *dmdasnes = (DMSNES_DA *)sdm->data;
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "SNESComputeFunctionOverlap_DMDA"
+/*
+  Completes the residual evaluation after DMGlobalToLocalBegin() has been called: the local function is called on the
+  interior box, which does not need the ghost values, before DMGlobalToLocalEnd() and then on each boundary strip.
+ */
+static PetscErrorCode SNESComputeFunctionOverlap_DMDA(DM dm,Vec X,Vec Xloc,Vec F,DMSNES_DA *dmdasnes)
+{
+  PetscErrorCode ierr;
+  DMDALocalInfo  interior,boundary[6];
+  PetscInt       i,nboundary,ninterior,nowned;
+  PetscLogDouble t0,t1,t2,work,wait;
+  void           *x,*f;
+
+  PetscFunctionBegin;
+  ierr = DMDAGetLocalInfoSplit(dm,&interior,&nboundary,boundary);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(dm,F,&f);CHKERRQ(ierr);
+  ninterior = interior.xm*interior.ym*interior.zm;
+  ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+  if (ninterior) {
+    ierr = DMDAVecGetArray(dm,Xloc,&x);CHKERRQ(ierr);
+    CHKMEMQ;
+    ierr = (*dmdasnes->residuallocal)(&interior,x,f,dmdasnes->residuallocalctx);CHKERRQ(ierr);
+    CHKMEMQ;
+    ierr = DMDAVecRestoreArray(dm,Xloc,&x);CHKERRQ(ierr);
+  }
+  ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(dm,X,INSERT_VALUES,Xloc);CHKERRQ(ierr);
+  ierr = PetscGetTime(&t2);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(dm,Xloc,&x);CHKERRQ(ierr);
+  for (i=0,nowned=ninterior; i<nboundary; i++) {
+    CHKMEMQ;
+    ierr = (*dmdasnes->residuallocal)(&boundary[i],x,f,dmdasnes->residuallocalctx);CHKERRQ(ierr);
+    CHKMEMQ;
+    nowned += boundary[i].xm*boundary[i].ym*boundary[i].zm;
+  }
+  ierr = DMDAVecRestoreArray(dm,Xloc,&x);CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArray(dm,F,&f);CHKERRQ(ierr);
+
+  /* the overlap fraction is the part of the time from starting the exchange to having the ghost values spent computing */
+  work = t1 - t0;
+  wait = t2 - t1;
+  dmdasnes->overlapwork += work;
+  dmdasnes->overlapwait += wait;
+  ierr = PetscInfo7(dm,"Computed %D of %D points in %G s while exchanging ghost values, then waited %G s: overlap fraction %G, %G over all %G s of exchanges\n",ninterior,nowned,(PetscReal)work,(PetscReal)wait,
+                    (PetscReal)((work+wait > 0.0) ? work/(work+wait) : 1.0),
+                    (PetscReal)((dmdasnes->overlapwork+dmdasnes->overlapwait > 0.0) ? dmdasnes->overlapwork/(dmdasnes->overlapwork+dmdasnes->overlapwait) : 1.0),
+                    (PetscReal)(dmdasnes->overlapwork+dmdasnes->overlapwait));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "SNESComputeFunction_DMDA"
 /*
@@ -84,6 +155,11 @@ static PetscErrorCode SNESComputeFunction_DMDA(SNES snes,Vec X,Vec F,void *ctx)
   ierr = SNESGetDM(snes,&dm);CHKERRQ(ierr);
   ierr = DMGetLocalVector(dm,&Xloc);CHKERRQ(ierr);
   ierr = DMGlobalToLocalBegin(dm,X,INSERT_VALUES,Xloc);CHKERRQ(ierr);
+  if (dmdasnes->overlap && dmdasnes->residuallocalimode == INSERT_VALUES) {
+    ierr = SNESComputeFunctionOverlap_DMDA(dm,X,Xloc,F,dmdasnes);CHKERRQ(ierr);
+    ierr = DMRestoreLocalVector(dm,&Xloc);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = DMGlobalToLocalEnd(dm,X,INSERT_VALUES,Xloc);CHKERRQ(ierr);
   ierr = DMDAGetLocalInfo(dm,&info);CHKERRQ(ierr);
   ierr = DMDAVecGetArray(dm,Xloc,&x);CHKERRQ(ierr);
@@ -235,9 +311,12 @@ static PetscErrorCode SNESComputeJacobian_DMDA(SNES snes,Vec X,Mat *A,Mat *B,Mat
 .  f - dimensional pointer to residual, write the residual here
 -  ctx - optional context passed above
 
+   Options Database Keys:
+.  -dmda_snes_overlap - compute the interior of the subdomain while the ghost values are exchanged, read by SNESSetFromOptions(), see DMDASNESSetOverlap()
+
    Level: beginner
 
-.seealso: DMSNESSetFunction(), DMDASNESSetJacobian(), DMDACreate1d(), DMDACreate2d(), DMDACreate3d()
+.seealso: DMSNESSetFunction(), DMDASNESSetJacobian(), DMDASNESSetOverlap(), DMDACreate1d(), DMDACreate2d(), DMDACreate3d()
 @*/
 PetscErrorCode DMDASNESSetFunctionLocal(DM dm,InsertMode imode,PetscErrorCode (*func)(DMDALocalInfo*,void*,void*,void*),void *ctx)
 {
@@ -259,6 +338,46 @@ PetscErrorCode DMDASNESSetFunctionLocal(DM dm,InsertMode imode,PetscErrorCode (*
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "DMDASNESSetOverlap"
+/*@
+   DMDASNESSetOverlap - compute the residual of the interior of the subdomain while the ghost values are exchanged
+
+   Logically Collective
+
+   Input Arguments:
++  dm - DM with a local residual evaluation set with DMDASNESSetFunctionLocal()
+-  flg - PETSC_TRUE to overlap the exchange of ghost values with computation
+
+   Options Database Keys:
+.  -dmda_snes_overlap - overlap the exchange with computation, read by SNESSetFromOptions() of a SNES using this DM
+
+   Notes:
+   The local function is first called on the interior box of DMDAGetLocalInfoSplit(), between DMGlobalToLocalBegin()
+   and DMGlobalToLocalEnd(), and then on each of the boundary strips, so it must compute the residual at exactly the
+   points of the box in the DMDALocalInfo it is given, reading the state only within the stencil width of them. This
+   holds for the usual loops from info->xs to info->xs+info->xm. The fraction of the time of the exchange that was
+   spent computing is reported with -info. Only local functions that use INSERT_VALUES are overlapped.
+
+   Level: intermediate
+
+.seealso: DMDASNESSetFunctionLocal(), DMDAGetLocalInfoSplit()
+@*/
+PetscErrorCode DMDASNESSetOverlap(DM dm,PetscBool flg)
+{
+  PetscErrorCode ierr;
+  DMSNES         sdm;
+  DMSNES_DA      *dmdasnes;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(dm,DM_CLASSID,1);
+  PetscValidLogicalCollectiveBool(dm,flg,2);
+  ierr = DMGetDMSNESWrite(dm,&sdm);CHKERRQ(ierr);
+  ierr = DMDASNESGetContext(dm,sdm,&dmdasnes);CHKERRQ(ierr);
+  dmdasnes->overlap = flg;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "DMDASNESSetJacobianLocal"
 /*@C
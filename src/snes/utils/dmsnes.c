@@ -171,6 +171,7 @@ PetscErrorCode DMSNESCopy(DMSNES kdm,DMSNES nkdm)
   nkdm->ops->computeobjective      = kdm->ops->computeobjective;
   nkdm->ops->computepjacobian      = kdm->ops->computepjacobian;
   nkdm->ops->computepfunction      = kdm->ops->computepfunction;
+  nkdm->ops->setfromoptions        = kdm->ops->setfromoptions;
   nkdm->ops->destroy               = kdm->ops->destroy;
   nkdm->ops->duplicate             = kdm->ops->duplicate;
 
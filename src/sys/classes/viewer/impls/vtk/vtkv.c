@@ -1,4 +1,7 @@
 #include "../src/sys/classes/viewer/impls/vtk/vtkvimpl.h" /*I "petscviewer.h" I*/
+#if defined(PETSC_HAVE_ZLIB)
+#include <zlib.h>
+#endif
 
 /*MC
     PetscViewerVTKWriteFunction - functional form used to provide writer to the PetscViewerVTK
@@ -60,6 +63,10 @@ static PetscErrorCode PetscViewerDestroy_VTK(PetscViewer viewer)
  ierr = PetscObjectComposeFunctionDynamic((PetscObject)viewer,"PetscViewerFileSetName_C","",PETSC_NULL);CHKERRQ(ierr);
  ierr = PetscObjectComposeFunctionDynamic((PetscObject)viewer,"PetscViewerFileSetMode_C","",PETSC_NULL);CHKERRQ(ierr);
  ierr = PetscObjectComposeFunctionDynamic((PetscObject)viewer,"PetscViewerVTKAddField_C","",PETSC_NULL);CHKERRQ(ierr);
+ ierr = PetscObjectComposeFunctionDynamic((PetscObject)viewer,"PetscViewerVTKSetAggregators_C","",PETSC_NULL);CHKERRQ(ierr);
+ ierr = PetscObjectComposeFunctionDynamic((PetscObject)viewer,"PetscViewerVTKSetMPIIO_C","",PETSC_NULL);CHKERRQ(ierr);
+ ierr = PetscObjectComposeFunctionDynamic((PetscObject)viewer,"PetscViewerVTKSetCompression_C","",PETSC_NULL);CHKERRQ(ierr);
+ ierr = PetscObjectComposeFunctionDynamic((PetscObject)viewer,"PetscViewerVTKSetAsyncWriter_C","",PETSC_NULL);CHKERRQ(ierr);
  PetscFunctionReturn(0);
 }
 
@@ -91,7 +98,7 @@ PetscErrorCode  PetscViewerFileSetName_VTK(PetscViewer viewer,const char name[])
 {
   PetscViewer_VTK *vtk = (PetscViewer_VTK*)viewer->data;
   PetscErrorCode  ierr;
-  PetscBool       isvtk,isvts,isvtu;
+  PetscBool       isvtk,isvts,isvtu,ispvts = PETSC_FALSE,ispvtu = PETSC_FALSE;
   size_t          len;
 
   PetscFunctionBegin;
@@ -101,6 +108,13 @@ PetscErrorCode  PetscViewerFileSetName_VTK(PetscViewer viewer,const char name[])
   ierr = PetscStrcasecmp(name+len-4,".vtk",&isvtk);CHKERRQ(ierr);
   ierr = PetscStrcasecmp(name+len-4,".vts",&isvts);CHKERRQ(ierr);
   ierr = PetscStrcasecmp(name+len-4,".vtu",&isvtu);CHKERRQ(ierr);
+  if (len > 5) {
+    ierr = PetscStrcasecmp(name+len-5,".pvts",&ispvts);CHKERRQ(ierr);
+    ierr = PetscStrcasecmp(name+len-5,".pvtu",&ispvtu);CHKERRQ(ierr);
+  }
+  vtk->parallel = (PetscBool)(ispvts || ispvtu);
+  if (ispvts) isvts = PETSC_TRUE;
+  if (ispvtu) isvtu = PETSC_TRUE;
   if (isvtk) {
     if (viewer->format == PETSC_VIEWER_DEFAULT) {ierr = PetscViewerSetFormat(viewer,PETSC_VIEWER_ASCII_VTK);CHKERRQ(ierr);}
     if (viewer->format != PETSC_VIEWER_ASCII_VTK) SETERRQ2(((PetscObject)viewer)->comm,PETSC_ERR_ARG_INCOMP,"Cannot use file '%s' with format %s, should have '.vtk' extension",name,PetscViewerFormats[viewer->format]);
@@ -109,7 +123,7 @@ PetscErrorCode  PetscViewerFileSetName_VTK(PetscViewer viewer,const char name[])
     if (viewer->format != PETSC_VIEWER_VTK_VTS) SETERRQ2(((PetscObject)viewer)->comm,PETSC_ERR_ARG_INCOMP,"Cannot use file '%s' with format %s, should have '.vts' extension",name,PetscViewerFormats[viewer->format]);
   } else if (isvtu) {
     if (viewer->format == PETSC_VIEWER_DEFAULT) {ierr = PetscViewerSetFormat(viewer,PETSC_VIEWER_VTK_VTU);CHKERRQ(ierr);}
-    if (viewer->format != PETSC_VIEWER_VTK_VTU) SETERRQ2(((PetscObject)viewer)->comm,PETSC_ERR_ARG_INCOMP,"Cannot use file '%s' with format %s, should have '.vts' extension",name,PetscViewerFormats[viewer->format]);
+    if (viewer->format != PETSC_VIEWER_VTK_VTU) SETERRQ2(((PetscObject)viewer)->comm,PETSC_ERR_ARG_INCOMP,"Cannot use file '%s' with format %s, should have '.vtu' extension",name,PetscViewerFormats[viewer->format]);
   } else SETERRQ1(((PetscObject)viewer)->comm,PETSC_ERR_ARG_UNKNOWN_TYPE,"File '%s' has unrecognized extension",name);
   ierr = PetscStrallocpy(name,&vtk->filename);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -160,12 +174,74 @@ PetscErrorCode  PetscViewerVTKAddField_VTK(PetscViewer viewer,PetscObject dm,Pet
 }
 EXTERN_C_END
 
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKSetAggregators_VTK"
+PetscErrorCode  PetscViewerVTKSetAggregators_VTK(PetscViewer viewer,PetscInt naggregators)
+{
+  PetscViewer_VTK *vtk = (PetscViewer_VTK*)viewer->data;
+
+  PetscFunctionBegin;
+  if (naggregators != PETSC_DECIDE && naggregators < 1) SETERRQ1(((PetscObject)viewer)->comm,PETSC_ERR_ARG_OUTOFRANGE,"Number of aggregators %D must be positive",naggregators);
+  vtk->naggregators = naggregators;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKSetMPIIO_VTK"
+PetscErrorCode  PetscViewerVTKSetMPIIO_VTK(PetscViewer viewer,PetscBool flg)
+{
+  PetscViewer_VTK *vtk = (PetscViewer_VTK*)viewer->data;
+
+  PetscFunctionBegin;
+#if !defined(PETSC_HAVE_MPIIO)
+  if (flg) SETERRQ(((PetscObject)viewer)->comm,PETSC_ERR_SUP,"PETSc was configured without MPI-IO");
+#endif
+  vtk->mpiio = flg;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKSetCompression_VTK"
+PetscErrorCode  PetscViewerVTKSetCompression_VTK(PetscViewer viewer,PetscInt level)
+{
+  PetscViewer_VTK *vtk = (PetscViewer_VTK*)viewer->data;
+
+  PetscFunctionBegin;
+  if (level < 0 || level > 9) SETERRQ1(((PetscObject)viewer)->comm,PETSC_ERR_ARG_OUTOFRANGE,"Compression level %D must be between 0 and 9",level);
+#if !defined(PETSC_HAVE_ZLIB)
+  if (level) SETERRQ(((PetscObject)viewer)->comm,PETSC_ERR_SUP,"PETSc was configured without zlib, reconfigure with --with-zlib");
+#endif
+  vtk->compress = level;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKSetAsyncWriter_VTK"
+PetscErrorCode  PetscViewerVTKSetAsyncWriter_VTK(PetscViewer viewer,PetscAsyncWriter writer)
+{
+  PetscViewer_VTK *vtk = (PetscViewer_VTK*)viewer->data;
+
+  PetscFunctionBegin;
+  vtk->async = writer;
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
 EXTERN_C_BEGIN
 #undef __FUNCT__
 #define __FUNCT__ "PetscViewerCreate_VTK"
 PetscErrorCode  PetscViewerCreate_VTK(PetscViewer v)
 {
   PetscViewer_VTK *vtk;
+  PetscInt        level = 0;
+  PetscBool       flg = PETSC_FALSE;
   PetscErrorCode  ierr;
 
   PetscFunctionBegin;
@@ -177,6 +253,7 @@ PetscErrorCode  PetscViewerCreate_VTK(PetscViewer v)
   v->iformat      = 0;
   vtk->btype     = (PetscFileMode) -1;
   vtk->filename  = 0;
+  vtk->naggregators = PETSC_DECIDE;
 
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)v,"PetscViewerFileSetName_C","PetscViewerFileSetName_VTK",
                                            PetscViewerFileSetName_VTK);CHKERRQ(ierr);
@@ -184,6 +261,21 @@ PetscErrorCode  PetscViewerCreate_VTK(PetscViewer v)
                                            PetscViewerFileSetMode_VTK);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunctionDynamic((PetscObject)v,"PetscViewerVTKAddField_C","PetscViewerVTKAddField_VTK",
                                            PetscViewerVTKAddField_VTK);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)v,"PetscViewerVTKSetAggregators_C","PetscViewerVTKSetAggregators_VTK",
+                                           PetscViewerVTKSetAggregators_VTK);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)v,"PetscViewerVTKSetMPIIO_C","PetscViewerVTKSetMPIIO_VTK",
+                                           PetscViewerVTKSetMPIIO_VTK);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)v,"PetscViewerVTKSetCompression_C","PetscViewerVTKSetCompression_VTK",
+                                           PetscViewerVTKSetCompression_VTK);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)v,"PetscViewerVTKSetAsyncWriter_C","PetscViewerVTKSetAsyncWriter_VTK",
+                                           PetscViewerVTKSetAsyncWriter_VTK);CHKERRQ(ierr);
+
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-viewer_vtk_aggregators",&vtk->naggregators,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscViewerVTKSetAggregators(v,vtk->naggregators);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-viewer_vtk_mpiio",&flg,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscViewerVTKSetMPIIO(v,flg);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-viewer_vtk_compress",&level,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscViewerVTKSetCompression(v,level);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 EXTERN_C_END
@@ -230,6 +322,168 @@ PetscErrorCode PetscViewerVTKOpen(MPI_Comm comm,const char name[],PetscFileMode
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKSetAggregators"
+/*@
+   PetscViewerVTKSetAggregators - Sets the number of files into which the pieces of a parallel VTK file are written
+
+   Logically Collective on PetscViewer
+
+   Input Parameters:
++  viewer - the VTK viewer
+-  naggregators - the number of files, or PETSC_DECIDE for one for each 64 processes
+
+   Options Database Keys:
+.  -viewer_vtk_aggregators <n> - the number of files
+
+   Level: advanced
+
+   Notes:
+   A file name with the extension .pvts or .pvtu selects the parallel format: the named file is an index written by
+   the first process, and the pieces of consecutive groups of processes are written to the files name_0.vts,
+   name_1.vts, ... (or .vtu) next to it, all at the same time. With n processes and m files the first n%m groups have
+   n/m+1 processes and the others n/m; m is at most n. In each group the pieces are sent to its first process,
+   the aggregator, which writes them, or with PetscViewerVTKSetMPIIO() all the processes of the group write their
+   pieces with collective MPI-IO. The other extensions write a single file through the first process.
+
+.seealso: PetscViewerVTKOpen(), PetscViewerVTKSetMPIIO(), PetscViewerVTKSetCompression()
+@*/
+PetscErrorCode PetscViewerVTKSetAggregators(PetscViewer viewer,PetscInt naggregators)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidLogicalCollectiveInt(viewer,naggregators,2);
+  ierr = PetscTryMethod(viewer,"PetscViewerVTKSetAggregators_C",(PetscViewer,PetscInt),(viewer,naggregators));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKSetMPIIO"
+/*@
+   PetscViewerVTKSetMPIIO - Sets whether each VTK file is written by all the processes that have pieces in it, with
+   collective MPI-IO, instead of by one process that receives the pieces
+
+   Logically Collective on PetscViewer
+
+   Input Parameters:
++  viewer - the VTK viewer
+-  flg - PETSC_TRUE to use MPI-IO
+
+   Options Database Keys:
+.  -viewer_vtk_mpiio - use MPI-IO
+
+   Level: advanced
+
+   Notes:
+   Each process computes the location of its <Piece> element and of its arrays in the file from the sizes of those of
+   the processes before it, so no process holds more than its own piece. The file is the same as the one written
+   without MPI-IO.
+
+.seealso: PetscViewerVTKOpen(), PetscViewerVTKSetAggregators(), PetscViewerVTKSetCompression(), PetscViewerBinarySetMPIIO()
+@*/
+PetscErrorCode PetscViewerVTKSetMPIIO(PetscViewer viewer,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidLogicalCollectiveBool(viewer,flg,2);
+  ierr = PetscTryMethod(viewer,"PetscViewerVTKSetMPIIO_C",(PetscViewer,PetscBool),(viewer,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKSetCompression"
+/*@
+   PetscViewerVTKSetCompression - Sets the zlib compression level of the arrays written to .vts and .vtu files
+
+   Logically Collective on PetscViewer
+
+   Input Parameters:
++  viewer - the VTK viewer
+-  level - 0 for no compression (the default), 1 (fastest) to 9 (smallest)
+
+   Options Database Keys:
+.  -viewer_vtk_compress <level> - the compression level
+
+   Level: advanced
+
+   Notes:
+   The arrays are compressed in blocks of 32 kB by each process, in the format of vtkZLibDataCompressor.
+   Requires PETSc configured with zlib (--with-zlib).
+
+.seealso: PetscViewerVTKOpen(), PetscViewerVTKSetAggregators(), PetscViewerVTKSetMPIIO()
+@*/
+PetscErrorCode PetscViewerVTKSetCompression(PetscViewer viewer,PetscInt level)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  PetscValidLogicalCollectiveInt(viewer,level,2);
+  ierr = PetscTryMethod(viewer,"PetscViewerVTKSetCompression_C",(PetscViewer,PetscInt),(viewer,level));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKSetAsyncWriter"
+/*@C
+   PetscViewerVTKSetAsyncWriter - Sets an object that writes the .vts and .vtu files of the viewer in the background
+
+   Logically Collective on PetscViewer
+
+   Input Parameters:
++  viewer - the VTK viewer
+-  writer - the writer, or PETSC_NULL to write the files before PetscViewerFlush() returns
+
+   Level: developer
+
+   Notes:
+   Each process copies its <Piece> element and its arrays into a staging buffer of the writer and posts them to be
+   written where the sizes of the pieces of the processes before it put them, as with PetscViewerVTKSetMPIIO(); the
+   first process also posts the rest of the file. The index of a .pvts or .pvtu file is written by the first process
+   before PetscViewerFlush() returns. The writer must not be destroyed before the viewer is flushed.
+
+.seealso: PetscViewerVTKOpen(), PetscAsyncWriterCreate(), PetscViewerVTKSetMPIIO(), TSMonitorSolutionAsync()
+@*/
+PetscErrorCode PetscViewerVTKSetAsyncWriter(PetscViewer viewer,PetscAsyncWriter writer)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(viewer,PETSC_VIEWER_CLASSID,1);
+  ierr = PetscTryMethod(viewer,"PetscViewerVTKSetAsyncWriter_C",(PetscViewer,PetscAsyncWriter),(viewer,writer));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKGetDataSize"
+static PetscErrorCode PetscViewerVTKGetDataSize(PetscDataType dtype,PetscInt *size)
+{
+  PetscFunctionBegin;
+  switch (dtype) {
+  case PETSC_DOUBLE:
+    *size = sizeof(double);
+    break;
+  case PETSC_FLOAT:
+    *size = sizeof(float);
+    break;
+  case PETSC_INT:
+    *size = sizeof(PetscInt);
+    break;
+  case PETSC_ENUM:
+    *size = sizeof(PetscEnum);
+    break;
+  case PETSC_CHAR:
+    *size = sizeof(char);
+    break;
+  default: SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Data type not supported");
+  }
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscViewerVTKFWrite"
 /*@C
@@ -264,24 +518,7 @@ PetscErrorCode PetscViewerVTKFWrite(PetscViewer viewer,FILE *fp,const void *data
     size_t count;
     PetscInt size;
     PetscVTKInt bytes;
-    switch (dtype) {
-    case PETSC_DOUBLE:
-      size = sizeof(double);
-      break;
-    case PETSC_FLOAT:
-      size = sizeof(float);
-      break;
-    case PETSC_INT:
-      size = sizeof(PetscInt);
-      break;
-    case PETSC_ENUM:
-      size = sizeof(PetscEnum);
-      break;
-    case PETSC_CHAR:
-      size = sizeof(char);
-      break;
-    default: SETERRQ(((PetscObject)viewer)->comm,PETSC_ERR_SUP,"Data type not supported");
-    }
+    ierr = PetscViewerVTKGetDataSize(dtype,&size);CHKERRQ(ierr);
     bytes = PetscVTKIntCast(size*n);
 
     count = fwrite(&bytes,sizeof(int),1,fp);
@@ -295,3 +532,506 @@ PetscErrorCode PetscViewerVTKFWrite(PetscViewer viewer,FILE *fp,const void *data
   }
   PetscFunctionReturn(0);
 }
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKReserve"
+/* makes room for extra more bytes after the len used of the buffer str of size maxlen */
+static PetscErrorCode PetscViewerVTKReserve(char **str,size_t len,size_t *maxlen,size_t extra)
+{
+  char           *tmp;
+  size_t         newlen;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (len + extra <= *maxlen) PetscFunctionReturn(0);
+  newlen = PetscMax(2*(*maxlen),len + extra);
+  ierr   = PetscMalloc(newlen,&tmp);CHKERRQ(ierr);
+  if (len) {ierr = PetscMemcpy(tmp,*str,len);CHKERRQ(ierr);}
+  ierr    = PetscFree(*str);CHKERRQ(ierr);
+  *str    = tmp;
+  *maxlen = newlen;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKStringPrintf"
+/*@C
+   PetscViewerVTKStringPrintf - Appends formatted text to a string that grows as needed
+
+   Not Collective
+
+   Input Parameters:
++  s - the string, initially zeroed
+-  format - the usual printf() format string
+
+   Level: developer
+
+.seealso: PetscViewerVTKPieceWrite()
+@*/
+PetscErrorCode PetscViewerVTKStringPrintf(PetscViewerVTKString *s,const char format[],...)
+{
+  va_list        Argp;
+  size_t         fullLength;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscViewerVTKReserve(&s->str,s->len,&s->maxlen,256);CHKERRQ(ierr);
+  va_start(Argp,format);
+  ierr = PetscVSNPrintf(s->str+s->len,s->maxlen-s->len,format,&fullLength,Argp);CHKERRQ(ierr);
+  va_end(Argp);
+  if (fullLength >= s->maxlen-s->len) {
+    ierr = PetscViewerVTKReserve(&s->str,s->len,&s->maxlen,fullLength+1);CHKERRQ(ierr);
+    va_start(Argp,format);
+    ierr = PetscVSNPrintf(s->str+s->len,s->maxlen-s->len,format,&fullLength,Argp);CHKERRQ(ierr);
+    va_end(Argp);
+  }
+  s->len += fullLength;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKPieceAddArray"
+/*@C
+   PetscViewerVTKPieceAddArray - Encodes an array of the piece of this process as it is written to the appended data
+   section of a VTK file
+
+   Not Collective
+
+   Input Parameters:
++  viewer - the VTK viewer
+.  piece - the piece of this process, initially zeroed
+.  array - the values
+.  n - number of values
+-  dtype - data type of the values
+
+   Output Parameter:
+.  offset - the offset of the encoded array from the start of the piece, or PETSC_NULL
+
+   Level: developer
+
+   Notes:
+   The array is preceded by its size in bytes, or compressed with zlib in blocks preceded by their sizes, as set with
+   PetscViewerVTKSetCompression().
+
+.seealso: PetscViewerVTKPieceGetStart(), PetscViewerVTKPieceWrite(), PetscViewerVTKFWrite()
+@*/
+PetscErrorCode PetscViewerVTKPieceAddArray(PetscViewer viewer,PetscViewerVTKPiece *piece,const void *array,PetscInt n,PetscDataType dtype,Petsc64bitInt *offset)
+{
+  PetscViewer_VTK *vtk = (PetscViewer_VTK*)viewer->data;
+  PetscInt        size;
+  size_t          nbytes;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (n < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Trying to write a negative amount of data %D",n);
+  ierr   = PetscViewerVTKGetDataSize(dtype,&size);CHKERRQ(ierr);
+  nbytes = (size_t)size*(size_t)n;
+  if (offset) *offset = (Petsc64bitInt)piece->len;
+  if (!vtk->compress) {
+    PetscVTKInt bytes;
+
+    if (nbytes > PETSC_VTK_INT_MAX) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Array too long for 32-bit VTK binary format");
+    bytes = (PetscVTKInt)nbytes;
+    ierr  = PetscViewerVTKReserve(&piece->data,piece->len,&piece->maxlen,sizeof(bytes)+nbytes);CHKERRQ(ierr);
+    ierr  = PetscMemcpy(piece->data+piece->len,&bytes,sizeof(bytes));CHKERRQ(ierr);
+    piece->len += sizeof(bytes);
+    if (nbytes) {ierr = PetscMemcpy(piece->data+piece->len,array,nbytes);CHKERRQ(ierr);}
+    piece->len += nbytes;
+  } else {
+#if defined(PETSC_HAVE_ZLIB)
+    const size_t blocksize = 32768;
+    size_t       nblocks = (nbytes + blocksize - 1)/blocksize,b,start,hlen;
+    PetscVTKInt  *h;
+    int          err;
+
+    /* the header of vtkZLibDataCompressor: number of blocks, block size, size of the last partial block, compressed sizes */
+    hlen = (3 + nblocks)*sizeof(PetscVTKInt);
+    ierr = PetscMalloc(hlen,&h);CHKERRQ(ierr);
+    h[0] = (PetscVTKInt)nblocks;
+    h[1] = (PetscVTKInt)blocksize;
+    h[2] = (PetscVTKInt)(nbytes % blocksize);
+    ierr = PetscViewerVTKReserve(&piece->data,piece->len,&piece->maxlen,hlen + nblocks*compressBound(blocksize));CHKERRQ(ierr);
+    start = piece->len;
+    piece->len += hlen;
+    for (b=0; b<nblocks; b++) {
+      uLong  blen = (uLong)PetscMin(blocksize,nbytes - b*blocksize);
+      uLongf clen = compressBound(blen);
+
+      err = compress2((Bytef*)piece->data+piece->len,&clen,(const Bytef*)array+b*blocksize,blen,(int)vtk->compress);
+      if (err != Z_OK) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error %d in zlib compress2()",err);
+      h[3+b]      = (PetscVTKInt)clen;
+      piece->len += clen;
+    }
+    ierr = PetscMemcpy(piece->data+start,h,hlen);CHKERRQ(ierr);
+    ierr = PetscFree(h);CHKERRQ(ierr);
+#else
+    SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"PETSc was configured without zlib, reconfigure with --with-zlib");
+#endif
+  }
+  PetscFunctionReturn(0);
+}
+
+/* the file of a process when size processes write nfiles files, the first size%nfiles of them from one more process */
+PETSC_STATIC_INLINE PetscMPIInt PetscViewerVTKFileOfRank(PetscMPIInt rank,PetscMPIInt size,PetscMPIInt nfiles)
+{
+  PetscMPIInt g = size/nfiles,rem = size%nfiles;
+
+  if (rank < rem*(g+1)) return rank/(g+1);
+  return rem + (rank - rem*(g+1))/g;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKGetFileComm"
+/* the processes writing the same file as this one, the number of that file and the number of files */
+static PetscErrorCode PetscViewerVTKGetFileComm(PetscViewer viewer,MPI_Comm *fcomm,PetscMPIInt *file,PetscMPIInt *nfiles)
+{
+  PetscViewer_VTK *vtk = (PetscViewer_VTK*)viewer->data;
+  MPI_Comm        comm = ((PetscObject)viewer)->comm;
+  PetscMPIInt     rank,size;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  if (vtk->parallel) {
+    *nfiles = (vtk->naggregators == PETSC_DECIDE) ? (size + 63)/64 : (PetscMPIInt)PetscMin(vtk->naggregators,size);
+  } else *nfiles = 1;
+  *file = PetscViewerVTKFileOfRank(rank,size,*nfiles);
+  ierr  = MPI_Comm_split(comm,*file,rank,fcomm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKPieceGetStart"
+/*@C
+   PetscViewerVTKPieceGetStart - Gets the offset of the piece of this process in the appended data section of its file
+
+   Collective on PetscViewer
+
+   Input Parameters:
++  viewer - the VTK viewer
+-  piece - the piece of this process, with all its arrays
+
+   Output Parameter:
+.  start - the offset, to be added to the offsets of the arrays given by PetscViewerVTKPieceAddArray()
+
+   Level: developer
+
+.seealso: PetscViewerVTKPieceAddArray(), PetscViewerVTKPieceWrite()
+@*/
+PetscErrorCode PetscViewerVTKPieceGetStart(PetscViewer viewer,PetscViewerVTKPiece *piece,Petsc64bitInt *start)
+{
+  MPI_Comm       fcomm;
+  PetscMPIInt    file,nfiles,frank;
+  Petsc64bitInt  len = (Petsc64bitInt)piece->len;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr   = PetscViewerVTKGetFileComm(viewer,&fcomm,&file,&nfiles);CHKERRQ(ierr);
+  ierr   = MPI_Comm_rank(fcomm,&frank);CHKERRQ(ierr);
+  *start = 0;
+  ierr   = MPI_Exscan(&len,start,1,MPI_LONG_LONG_INT,MPI_SUM,fcomm);CHKERRQ(ierr);
+  if (!frank) *start = 0;
+  ierr   = MPI_Comm_free(&fcomm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKFPut"
+static PetscErrorCode PetscViewerVTKFPut(FILE *fp,const void *data,size_t len)
+{
+  PetscFunctionBegin;
+  if (len && fwrite(data,1,len,fp) != len) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_WRITE,"Error writing VTK file");
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKWriteFile_Aggregate"
+/* the first process of fcomm receives the pieces of the others, one at a time, and writes the file */
+static PetscErrorCode PetscViewerVTKWriteFile_Aggregate(PetscViewer viewer,MPI_Comm fcomm,const char fname[],const char prologue[],const char middle[],const char tail[],PetscViewerVTKPiece *piece)
+{
+  PetscMPIInt    frank,fsize,tag = ((PetscObject)viewer)->tag,r,count,pass;
+  MPI_Status     status;
+  FILE           *fp;
+  char           *buf = PETSC_NULL;
+  size_t         maxlen = 0,len;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(fcomm,&frank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(fcomm,&fsize);CHKERRQ(ierr);
+  if (frank) {
+    count = PetscMPIIntCast((PetscInt)piece->header.len);
+    ierr  = MPI_Send(piece->header.str,count,MPI_BYTE,0,tag,fcomm);CHKERRQ(ierr);
+    count = PetscMPIIntCast((PetscInt)piece->len);
+    ierr  = MPI_Send(piece->data,count,MPI_BYTE,0,tag,fcomm);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscFOpen(PETSC_COMM_SELF,fname,"wb",&fp);CHKERRQ(ierr);
+  ierr = PetscStrlen(prologue,&len);CHKERRQ(ierr);
+  ierr = PetscViewerVTKFPut(fp,prologue,len);CHKERRQ(ierr);
+  /* the <Piece> elements in the first pass, the appended data in the second */
+  for (pass=0; pass<2; pass++) {
+    if (pass) {
+      ierr = PetscStrlen(middle,&len);CHKERRQ(ierr);
+      ierr = PetscViewerVTKFPut(fp,middle,len);CHKERRQ(ierr);
+      ierr = PetscViewerVTKFPut(fp,piece->data,piece->len);CHKERRQ(ierr);
+    } else {
+      ierr = PetscViewerVTKFPut(fp,piece->header.str,piece->header.len);CHKERRQ(ierr);
+    }
+    for (r=1; r<fsize; r++) {
+      ierr = MPI_Probe(r,tag,fcomm,&status);CHKERRQ(ierr);
+      ierr = MPI_Get_count(&status,MPI_BYTE,&count);CHKERRQ(ierr);
+      ierr = PetscViewerVTKReserve(&buf,0,&maxlen,(size_t)count);CHKERRQ(ierr);
+      ierr = MPI_Recv(buf,count,MPI_BYTE,r,tag,fcomm,&status);CHKERRQ(ierr);
+      ierr = PetscViewerVTKFPut(fp,buf,(size_t)count);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscStrlen(tail,&len);CHKERRQ(ierr);
+  ierr = PetscViewerVTKFPut(fp,tail,len);CHKERRQ(ierr);
+  ierr = PetscFClose(PETSC_COMM_SELF,fp);CHKERRQ(ierr);
+  ierr = PetscFree(buf);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKGetPieceLocation"
+/* the sums of the lengths of the <Piece> elements and of the appended data of the processes of fcomm before this one, and of all of them */
+static PetscErrorCode PetscViewerVTKGetPieceLocation(MPI_Comm fcomm,PetscViewerVTKPiece *piece,Petsc64bitInt start[],Petsc64bitInt total[])
+{
+  PetscMPIInt    frank;
+  Petsc64bitInt  local[2];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr     = MPI_Comm_rank(fcomm,&frank);CHKERRQ(ierr);
+  local[0] = (Petsc64bitInt)piece->header.len;
+  local[1] = (Petsc64bitInt)piece->len;
+  start[0] = start[1] = 0;
+  ierr     = MPI_Exscan(local,start,2,MPI_LONG_LONG_INT,MPI_SUM,fcomm);CHKERRQ(ierr);
+  if (!frank) start[0] = start[1] = 0;
+  ierr     = MPI_Allreduce(local,total,2,MPI_LONG_LONG_INT,MPI_SUM,fcomm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#if defined(PETSC_HAVE_MPIIO)
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKWriteFile_MPIIO"
+/* all the processes of fcomm write their <Piece> element and their appended data where the sizes of those before them put them */
+static PetscErrorCode PetscViewerVTKWriteFile_MPIIO(MPI_Comm fcomm,const char fname[],const char prologue[],const char middle[],const char tail[],PetscViewerVTKPiece *piece)
+{
+  PetscMPIInt    frank,count;
+  MPI_File       fh;
+  MPI_Status     status;
+  Petsc64bitInt  start[2],total[2];
+  size_t         plen,mlen,tlen;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(fcomm,&frank);CHKERRQ(ierr);
+  ierr = PetscStrlen(prologue,&plen);CHKERRQ(ierr);
+  ierr = PetscStrlen(middle,&mlen);CHKERRQ(ierr);
+  ierr = PetscStrlen(tail,&tlen);CHKERRQ(ierr);
+  ierr = PetscViewerVTKGetPieceLocation(fcomm,piece,start,total);CHKERRQ(ierr);
+
+  ierr = MPI_File_open(fcomm,(char*)fname,MPI_MODE_WRONLY | MPI_MODE_CREATE,MPI_INFO_NULL,&fh);CHKERRQ(ierr);
+  ierr = MPI_File_set_size(fh,0);CHKERRQ(ierr);
+  if (!frank) {ierr = MPI_File_write_at(fh,0,(void*)prologue,(PetscMPIInt)plen,MPI_BYTE,&status);CHKERRQ(ierr);}
+  count = PetscMPIIntCast((PetscInt)piece->header.len);
+  ierr  = MPI_File_write_at_all(fh,(MPI_Offset)(plen + start[0]),piece->header.str,count,MPI_BYTE,&status);CHKERRQ(ierr);
+  if (!frank) {ierr = MPI_File_write_at(fh,(MPI_Offset)(plen + total[0]),(void*)middle,(PetscMPIInt)mlen,MPI_BYTE,&status);CHKERRQ(ierr);}
+  count = PetscMPIIntCast((PetscInt)piece->len);
+  ierr  = MPI_File_write_at_all(fh,(MPI_Offset)(plen + total[0] + mlen + start[1]),piece->data,count,MPI_BYTE,&status);CHKERRQ(ierr);
+  if (!frank) {ierr = MPI_File_write_at(fh,(MPI_Offset)(plen + total[0] + mlen + total[1]),(void*)tail,(PetscMPIInt)tlen,MPI_BYTE,&status);CHKERRQ(ierr);}
+  ierr = MPI_File_close(&fh);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKWriteFile_Async"
+/* the same layout as PetscViewerVTKWriteFile_MPIIO(), posted to the background writer */
+static PetscErrorCode PetscViewerVTKWriteFile_Async(PetscAsyncWriter writer,MPI_Comm fcomm,const char fname[],const char prologue[],const char middle[],const char tail[],PetscViewerVTKPiece *piece)
+{
+  PetscMPIInt    frank;
+  Petsc64bitInt  start[2],total[2],offsets[3];
+  size_t         plen,mlen,tlen,lens[3];
+  char           *buf;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(fcomm,&frank);CHKERRQ(ierr);
+  ierr = PetscStrlen(prologue,&plen);CHKERRQ(ierr);
+  ierr = PetscStrlen(middle,&mlen);CHKERRQ(ierr);
+  ierr = PetscStrlen(tail,&tlen);CHKERRQ(ierr);
+  ierr = PetscViewerVTKGetPieceLocation(fcomm,piece,start,total);CHKERRQ(ierr);
+  if (!frank) {
+    /* the prologue with the first <Piece> element, the middle with the first data, and the tail; then the file is truncated */
+    offsets[0] = 0;                                 lens[0] = plen + piece->header.len;
+    offsets[1] = plen + total[0];                   lens[1] = mlen + piece->len;
+    offsets[2] = plen + total[0] + mlen + total[1]; lens[2] = tlen;
+    ierr = PetscAsyncWriterGetBuffer(writer,lens[0] + lens[1] + lens[2],(void**)&buf);CHKERRQ(ierr);
+    ierr = PetscMemcpy(buf,prologue,plen);CHKERRQ(ierr);
+    ierr = PetscMemcpy(buf+plen,piece->header.str,piece->header.len);CHKERRQ(ierr);
+    ierr = PetscMemcpy(buf+lens[0],middle,mlen);CHKERRQ(ierr);
+    ierr = PetscMemcpy(buf+lens[0]+mlen,piece->data,piece->len);CHKERRQ(ierr);
+    ierr = PetscMemcpy(buf+lens[0]+lens[1],tail,tlen);CHKERRQ(ierr);
+    ierr = PetscAsyncWriterPost(writer,fname,3,offsets,lens,offsets[2] + (Petsc64bitInt)tlen);CHKERRQ(ierr);
+  } else {
+    offsets[0] = plen + start[0];                   lens[0] = piece->header.len;
+    offsets[1] = plen + total[0] + mlen + start[1]; lens[1] = piece->len;
+    ierr = PetscAsyncWriterGetBuffer(writer,lens[0] + lens[1],(void**)&buf);CHKERRQ(ierr);
+    ierr = PetscMemcpy(buf,piece->header.str,lens[0]);CHKERRQ(ierr);
+    ierr = PetscMemcpy(buf+lens[0],piece->data,lens[1]);CHKERRQ(ierr);
+    ierr = PetscAsyncWriterPost(writer,fname,2,offsets,lens,-1);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKWriteIndex"
+/* the index of a parallel file, listing the piece of each process or the file of each aggregator */
+static PetscErrorCode PetscViewerVTKWriteIndex(PetscViewer viewer,const char gridtype[],const char gridattr[],PetscViewerVTKPiece *piece,PetscMPIInt nfiles)
+{
+  PetscViewer_VTK *vtk = (PetscViewer_VTK*)viewer->data;
+  MPI_Comm        comm = ((PetscObject)viewer)->comm;
+  PetscMPIInt     rank,size,r,count,*counts = PETSC_NULL,*displs = PETSC_NULL;
+  char            *attrs = PETSC_NULL,*name,ext[4];
+  FILE            *fp;
+  size_t          len;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
+  if (piece->indexattr.len) {
+    count = PetscMPIIntCast((PetscInt)piece->indexattr.len);
+    if (!rank) {ierr = PetscMalloc2(size,PetscMPIInt,&counts,size+1,PetscMPIInt,&displs);CHKERRQ(ierr);}
+    ierr = MPI_Gather(&count,1,MPI_INT,counts,1,MPI_INT,0,comm);CHKERRQ(ierr);
+    if (!rank) {
+      displs[0] = 0;
+      for (r=0; r<size; r++) displs[r+1] = displs[r] + counts[r];
+      ierr = PetscMalloc(displs[size],&attrs);CHKERRQ(ierr);
+    }
+    ierr = MPI_Gatherv(piece->indexattr.str,count,MPI_BYTE,attrs,counts,displs,MPI_BYTE,0,comm);CHKERRQ(ierr);
+  }
+  if (!rank) {
+    /* Source is relative to the directory of the index */
+    ierr = PetscStrrchr(vtk->filename,'/',&name);CHKERRQ(ierr);
+    ierr = PetscStrlen(name,&len);CHKERRQ(ierr);
+    ierr = PetscStrcpy(ext,name+len-3);CHKERRQ(ierr);
+    ierr = PetscFOpen(PETSC_COMM_SELF,vtk->filename,"wb",&fp);CHKERRQ(ierr);
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fp,"<?xml version=\"1.0\"?>\n");CHKERRQ(ierr);
+#ifdef PETSC_WORDS_BIGENDIAN
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fp,"<VTKFile type=\"P%s\" version=\"0.1\" byte_order=\"BigEndian\">\n",gridtype);CHKERRQ(ierr);
+#else
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fp,"<VTKFile type=\"P%s\" version=\"0.1\" byte_order=\"LittleEndian\">\n",gridtype);CHKERRQ(ierr);
+#endif
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fp,"  <P%s GhostLevel=\"0\"%s%s>\n",gridtype,gridattr[0] ? " " : "",gridattr);CHKERRQ(ierr);
+    ierr = PetscViewerVTKFPut(fp,piece->pdata.str,piece->pdata.len);CHKERRQ(ierr);
+    if (attrs) {
+      for (r=0; r<size; r++) {
+        ierr = PetscFPrintf(PETSC_COMM_SELF,fp,"    <Piece %.*s Source=\"%.*s_%d.%s\"/>\n",counts[r],attrs+displs[r],(int)(len-5),name,PetscViewerVTKFileOfRank(r,size,nfiles),ext);CHKERRQ(ierr);
+      }
+    } else {
+      for (r=0; r<nfiles; r++) {
+        ierr = PetscFPrintf(PETSC_COMM_SELF,fp,"    <Piece Source=\"%.*s_%d.%s\"/>\n",(int)(len-5),name,r,ext);CHKERRQ(ierr);
+      }
+    }
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fp,"  </P%s>\n",gridtype);CHKERRQ(ierr);
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fp,"</VTKFile>\n");CHKERRQ(ierr);
+    ierr = PetscFClose(PETSC_COMM_SELF,fp);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(attrs);CHKERRQ(ierr);
+  ierr = PetscFree2(counts,displs);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKPieceWrite"
+/*@C
+   PetscViewerVTKPieceWrite - Writes the pieces of all processes to the XML VTK file of the viewer
+
+   Collective on PetscViewer
+
+   Input Parameters:
++  viewer - the VTK viewer
+.  gridtype - the type of the data set, StructuredGrid or UnstructuredGrid
+.  gridattr - attributes of the data set element, for example its WholeExtent, or ""
+-  piece - the piece of this process, whose <Piece> element uses the offsets from PetscViewerVTKPieceGetStart()
+
+   Level: developer
+
+   Notes:
+   The file is written by its first process, which receives the pieces of the others one at a time, or with
+   PetscViewerVTKSetMPIIO() by all the processes together, or with PetscViewerVTKSetAsyncWriter() by each process in
+   the background. For a .pvts or .pvtu file each group of processes set by PetscViewerVTKSetAggregators() writes its
+   own file in this way, and the first process writes the index.
+
+.seealso: PetscViewerVTKPieceAddArray(), PetscViewerVTKPieceGetStart(), DMDAVTKWriteAll()
+@*/
+PetscErrorCode PetscViewerVTKPieceWrite(PetscViewer viewer,const char gridtype[],const char gridattr[],PetscViewerVTKPiece *piece)
+{
+  PetscViewer_VTK *vtk = (PetscViewer_VTK*)viewer->data;
+  MPI_Comm        fcomm;
+  PetscMPIInt     file,nfiles;
+  char            fname[PETSC_MAX_PATH_LEN],prologue[1024],middle[256];
+  const char      tail[] = "\n  </AppendedData>\n</VTKFile>\n";
+  size_t          len;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  if (!vtk->filename) SETERRQ(((PetscObject)viewer)->comm,PETSC_ERR_ARG_WRONGSTATE,"Must call PetscViewerFileSetName() first");
+  ierr = PetscViewerVTKGetFileComm(viewer,&fcomm,&file,&nfiles);CHKERRQ(ierr);
+  if (vtk->parallel) {
+    ierr = PetscViewerVTKWriteIndex(viewer,gridtype,gridattr,piece,nfiles);CHKERRQ(ierr);
+    ierr = PetscStrlen(vtk->filename,&len);CHKERRQ(ierr);
+    ierr = PetscSNPrintf(fname,sizeof(fname),"%.*s_%d.%s",(int)(len-5),vtk->filename,file,vtk->filename+len-3);CHKERRQ(ierr);
+  } else {
+    ierr = PetscStrncpy(fname,vtk->filename,sizeof(fname));CHKERRQ(ierr);
+  }
+#ifdef PETSC_WORDS_BIGENDIAN
+  ierr = PetscSNPrintf(prologue,sizeof(prologue),"<?xml version=\"1.0\"?>\n<VTKFile type=\"%s\" version=\"0.1\" byte_order=\"BigEndian\"%s>\n  <%s%s%s>\n",gridtype,vtk->compress ? " compressor=\"vtkZLibDataCompressor\"" : "",gridtype,gridattr[0] ? " " : "",gridattr);CHKERRQ(ierr);
+#else
+  ierr = PetscSNPrintf(prologue,sizeof(prologue),"<?xml version=\"1.0\"?>\n<VTKFile type=\"%s\" version=\"0.1\" byte_order=\"LittleEndian\"%s>\n  <%s%s%s>\n",gridtype,vtk->compress ? " compressor=\"vtkZLibDataCompressor\"" : "",gridtype,gridattr[0] ? " " : "",gridattr);CHKERRQ(ierr);
+#endif
+  ierr = PetscSNPrintf(middle,sizeof(middle),"  </%s>\n  <AppendedData encoding=\"raw\">\n_",gridtype);CHKERRQ(ierr);
+  if (vtk->async) {
+    ierr = PetscViewerVTKWriteFile_Async(vtk->async,fcomm,fname,prologue,middle,tail,piece);CHKERRQ(ierr);
+  } else if (vtk->mpiio) {
+#if defined(PETSC_HAVE_MPIIO)
+    ierr = PetscViewerVTKWriteFile_MPIIO(fcomm,fname,prologue,middle,tail,piece);CHKERRQ(ierr);
+#endif
+  } else {
+    ierr = PetscViewerVTKWriteFile_Aggregate(viewer,fcomm,fname,prologue,middle,tail,piece);CHKERRQ(ierr);
+  }
+  ierr = MPI_Comm_free(&fcomm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscViewerVTKPieceDestroy"
+/*@C
+   PetscViewerVTKPieceDestroy - Frees the text and the arrays of a piece
+
+   Not Collective
+
+   Input Parameter:
+.  piece - the piece
+
+   Level: developer
+
+.seealso: PetscViewerVTKPieceWrite()
+@*/
+PetscErrorCode PetscViewerVTKPieceDestroy(PetscViewerVTKPiece *piece)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(piece->header.str);CHKERRQ(ierr);
+  ierr = PetscFree(piece->pdata.str);CHKERRQ(ierr);
+  ierr = PetscFree(piece->indexattr.str);CHKERRQ(ierr);
+  ierr = PetscFree(piece->data);CHKERRQ(ierr);
+  ierr = PetscMemzero(piece,sizeof(*piece));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
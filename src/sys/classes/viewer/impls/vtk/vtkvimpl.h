@@ -17,10 +17,40 @@ typedef struct {
   PetscObject                 dm;
   PetscViewerVTKObjectLink    link;
   PetscErrorCode              (*write)(PetscObject,PetscViewer);
+  PetscBool                   parallel;      /* .pvts or .pvtu: an index and one file for each aggregator */
+  PetscInt                    naggregators;  /* number of files of a parallel file, PETSC_DECIDE for one per 64 processes */
+  PetscBool                   mpiio;         /* each file is written by all its processes with MPI-IO */
+  PetscInt                    compress;      /* zlib compression level of the arrays, 0 for none */
+  PetscAsyncWriter            async;         /* writes the files in the background, not owned by the viewer */
 } PetscViewer_VTK;
 
 PETSC_EXTERN PetscErrorCode PetscViewerVTKFWrite(PetscViewer,FILE*,const void*,PetscInt,PetscDataType);
 
+/* Text that grows as it is printed to */
+typedef struct {
+  char   *str;
+  size_t len,maxlen;
+} PetscViewerVTKString;
+
+/*
+   The part of an XML file (.vts or .vtu) that comes from one process: its <Piece> element, with the offsets of its
+   arrays, and its arrays encoded as they are written to the appended data section. The declarations of the arrays and
+   the attributes of the piece in the index of a parallel file (.pvts or .pvtu) are also given here.
+*/
+typedef struct {
+  PetscViewerVTKString header;     /* the <Piece> element */
+  PetscViewerVTKString pdata;      /* <PPoints>, <PPointData> and <PCellData> of the index, the same on all processes */
+  PetscViewerVTKString indexattr;  /* attributes of the piece in the index, for example Extent; empty for one entry per file */
+  char                 *data;      /* the encoded arrays */
+  size_t               len,maxlen;
+} PetscViewerVTKPiece;
+
+PETSC_EXTERN PetscErrorCode PetscViewerVTKStringPrintf(PetscViewerVTKString*,const char[],...);
+PETSC_EXTERN PetscErrorCode PetscViewerVTKPieceAddArray(PetscViewer,PetscViewerVTKPiece*,const void*,PetscInt,PetscDataType,Petsc64bitInt*);
+PETSC_EXTERN PetscErrorCode PetscViewerVTKPieceGetStart(PetscViewer,PetscViewerVTKPiece*,Petsc64bitInt*);
+PETSC_EXTERN PetscErrorCode PetscViewerVTKPieceWrite(PetscViewer,const char[],const char[],PetscViewerVTKPiece*);
+PETSC_EXTERN PetscErrorCode PetscViewerVTKPieceDestroy(PetscViewerVTKPiece*);
+
 #if defined(PETSC_HAVE_STDINT_H) /* The VTK format requires a 32-bit integer */
 typedef int32_t PetscVTKInt;
 #else                            /* Hope int is 32 bits */
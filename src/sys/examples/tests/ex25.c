@@ -0,0 +1,76 @@
+
+static char help[] = "Tests the pooled PetscMalloc(), run with -malloc_pool.\n\n\
+  -n <n>        number of arrays allocated at the same time\n\
+  -its <its>    number of times the arrays are allocated and freed\n\
+  -timing       print the time of the allocations\n\n";
+
+/*
+   Compare the time of the many small allocations with and without the pool, for example
+      ./ex25 -timing -its 1000 -malloc no
+      ./ex25 -timing -its 1000 -malloc no -malloc_pool
+*/
+#include <petscsys.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       n = 1000,its = 10,i,j,k,**a,*lens,errors = 0;
+  PetscBool      timing = PETSC_FALSE;
+  PetscLogDouble t0,t1,reserved0,reserved,peak = 0,rounding,hitrate;
+  PetscRandom    rand;
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-its",&its,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-timing",&timing,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc2(n,PetscInt*,&a,n,PetscInt,&lens);CHKERRQ(ierr);
+
+  ierr = PetscMallocPoolGetUsage(PETSC_NULL,&reserved0,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+  for (k=0; k<its; k++) {
+    /* mostly small arrays of all sizes, every 16th too large for the pool */
+    for (i=0; i<n; i++) {
+      lens[i] = (i*(k+7)) % 97 + 1;
+      if (!(i%16)) lens[i] *= 100;
+      ierr = PetscMalloc(lens[i]*sizeof(PetscInt),&a[i]);CHKERRQ(ierr);
+      for (j=0; j<lens[i]; j++) a[i][j] = i+j;
+    }
+    /* free every other array and reallocate them with other sizes */
+    for (i=0; i<n; i+=2) {
+      ierr    = PetscFree(a[i]);CHKERRQ(ierr);
+      lens[i] = (lens[i]*3) % 61 + 1;
+      ierr    = PetscMalloc(lens[i]*sizeof(PetscInt),&a[i]);CHKERRQ(ierr);
+      for (j=0; j<lens[i]; j++) a[i][j] = i+j;
+    }
+    ierr = PetscMallocPoolGetUsage(PETSC_NULL,&reserved,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+    peak = PetscMax(peak,reserved);
+    for (i=n-1; i>=0; i--) {
+      for (j=0; j<lens[i]; j++) {
+        if (a[i][j] != i+j) errors++;
+      }
+      ierr = PetscFree(a[i]);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+  if (errors) {ierr = PetscPrintf(PETSC_COMM_WORLD,"%D entries were overwritten\n",errors);CHKERRQ(ierr);}
+  ierr = PetscFree2(a,lens);CHKERRQ(ierr);
+
+  /* the slabs created by the loop are returned when an object is destroyed, the older ones may hold memory still in use */
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscMallocPoolGetUsage(PETSC_NULL,&reserved,&rounding,&hitrate);CHKERRQ(ierr);
+  if (!peak) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"The memory pool is not in use\n");CHKERRQ(ierr);
+  } else if (reserved > reserved0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"The memory pool kept %G bytes after the release, %G before the allocations\n",reserved,reserved0);CHKERRQ(ierr);
+  } else {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"The memory pool returned the unused slabs\n");CHKERRQ(ierr);
+  }
+  if (timing) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Allocations %G s, %G%% served from the free lists, %G%% added by rounding\n",t1-t0,100.0*hitrate,100.0*rounding);CHKERRQ(ierr);
+  }
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,108 @@
+
+static char help[] = "Tests the timeline of nested events, run with -log_timeline.\n\n\
+  -its <its>    number of times the nested events are logged\n\
+  -n <n>        length of the array summed in the timed event\n\
+  -timing       print the cost of logging a small event\n\n";
+
+/*
+   Measure the overhead of the timeline on a small event, and compare with -log_summary alone
+      ./ex26 -timing -its 100000 -log_timeline
+      ./ex26 -timing -its 100000 -log_timeline -log_summary
+*/
+#include <petscthreadcomm.h>
+
+static PetscLogEvent OUTER,INNER,WORK;
+
+PetscErrorCode kernel_work(PetscInt trank,PetscScalar *values)
+{
+  PetscErrorCode ierr;
+
+  ierr = PetscLogEventBegin(WORK,0,0,0,0);CHKERRQ(ierr);
+  values[trank] += 1.0;
+  ierr = PetscLogEventEnd(WORK,0,0,0,0);CHKERRQ(ierr);
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "Dot"
+/* a computation of about the size of a VecDot() on a small vector */
+static PetscScalar Dot(PetscInt n,const PetscScalar *x)
+{
+  PetscInt    i;
+  PetscScalar sum = 0.0;
+
+  for (i=0; i<n; i++) sum += x[i]*x[i];
+  return sum;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       its = 2,i,j,n = 1000,nthreads,counts[5] = {0,0,0,0,0};
+  PetscBool      timing = PETSC_FALSE;
+  PetscMPIInt    rank,size;
+  PetscScalar    *x,*values,sum = 0.0;
+  PetscLogDouble t0,t1,t2;
+  const char     *names[5] = {"\"name\":\"Outer\"","\"name\":\"Inner\"","\"name\":\"Work\"","\"name\":\"ThreadCommKernel\"","\"depth\":1}"};
+  char           line[1024];
+  FILE           *fd;
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-its",&its,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-timing",&timing,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscLogEventRegister("Outer",0,&OUTER);CHKERRQ(ierr);
+  ierr = PetscLogEventRegister("Inner",0,&INNER);CHKERRQ(ierr);
+  ierr = PetscLogEventRegister("Work",0,&WORK);CHKERRQ(ierr);
+  ierr = PetscThreadCommGetNThreads(PETSC_COMM_WORLD,&nthreads);CHKERRQ(ierr);
+  ierr = PetscMalloc2(n,PetscScalar,&x,nthreads,PetscScalar,&values);CHKERRQ(ierr);
+  for (i=0; i<n; i++) x[i] = 1.0/(i+1);
+  for (i=0; i<nthreads; i++) values[i] = 0.0;
+
+  /* each Outer holds three Inner, the second of which runs a kernel on all the threads */
+  for (i=0; i<its; i++) {
+    ierr = PetscLogEventBegin(OUTER,0,0,0,0);CHKERRQ(ierr);
+    for (j=0; j<3; j++) {
+      ierr = PetscLogEventBegin(INNER,0,0,0,0);CHKERRQ(ierr);
+      if (j == 1) {
+        ierr = PetscThreadCommRunKernel(PETSC_COMM_WORLD,(PetscThreadKernel)kernel_work,1,values);CHKERRQ(ierr);
+        ierr = PetscThreadCommBarrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+      }
+      ierr = PetscLogEventEnd(INNER,0,0,0,0);CHKERRQ(ierr);
+    }
+    ierr = PetscLogEventEnd(OUTER,0,0,0,0);CHKERRQ(ierr);
+  }
+
+  if (timing) {
+    ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+    for (i=0; i<its; i++) {
+      ierr = PetscLogEventBegin(WORK,0,0,0,0);CHKERRQ(ierr);
+      sum += Dot(n,x);
+      ierr = PetscLogEventEnd(WORK,0,0,0,0);CHKERRQ(ierr);
+    }
+    ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+    for (i=0; i<its; i++) sum += Dot(n,x);
+    ierr = PetscGetTime(&t2);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Logged %G s, not logged %G s, %G%% overhead (%G)\n",t1-t0,t2-t1,100.0*((t1-t0)-(t2-t1))/(t2-t1),PetscRealPart(sum));CHKERRQ(ierr);
+  }
+
+  ierr = PetscLogTimelineDump("ex26.json");CHKERRQ(ierr);
+  if (!rank) {
+    fd = fopen("ex26.json","r");
+    if (!fd) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open ex26.json");
+    while (fgets(line,sizeof(line),fd)) {
+      for (i=0; i<4; i++) if (strstr(line,names[i])) counts[i]++;
+      if (strstr(line,names[1]) && strstr(line,names[4])) counts[4]++;
+    }
+    fclose(fd);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Outer %D, Inner %D, intervals at depth 1 %D per process\n",counts[0]/size,counts[1]/size,counts[4]/size);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Work %D per thread, in %s kernel intervals\n",(counts[2]-(timing ? its*size : 0))/(size*nthreads),counts[3] >= its*size*nthreads ? "as many" : "fewer");CHKERRQ(ierr);
+  ierr = PetscFree2(x,values);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,375 @@
+/*
+   Writes data to files in the background, from a pool of staging buffers
+*/
+#include <petscsys.h>
+#include <errno.h>
+#include <fcntl.h>
+#if defined(PETSC_HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
+#if defined (PETSC_HAVE_IO_H)
+#include <io.h>
+#endif
+#if defined(PETSC_HAVE_PTHREAD_H)
+#include <pthread.h>
+#endif
+
+#define PETSC_ASYNC_MAXSEG 3
+
+typedef struct {
+  char          *buf;
+  size_t        maxlen;
+  char          name[PETSC_MAX_PATH_LEN];
+  PetscInt      nseg;
+  Petsc64bitInt offset[PETSC_ASYNC_MAXSEG];
+  size_t        len[PETSC_ASYNC_MAXSEG];
+  Petsc64bitInt size;                   /* the file is truncated to this size after the write, unless it is negative */
+} PetscAsyncJob;
+
+struct _n_PetscAsyncWriter {
+  PetscInt        nbuffers;
+  PetscAsyncJob   *jobs;                /* the buffers jobs[head], ..., jobs[head+count-1] (mod nbuffers) are posted */
+  PetscInt        head,count;
+  PetscInt        current;              /* the buffer given by the last PetscAsyncWriterGetBuffer(), or -1 */
+  int             err;                  /* errno of the first failed write */
+  char            errname[PETSC_MAX_PATH_LEN];
+  PetscInt        nposted,nwaits;
+  PetscLogDouble  waittime;
+#if defined(PETSC_HAVE_PTHREAD_H)
+  PetscBool       done;
+  pthread_t       thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t  posted,freed;
+#endif
+};
+
+/*
+   Writes a job with system calls only, so it may run in a thread that must not call PETSc or MPI;
+   returns 0 or the errno of the failed call
+*/
+static int PetscAsyncJobWrite(PetscAsyncJob *job)
+{
+  int      fd,err = 0;
+  PetscInt s;
+  size_t   pos = 0,done;
+  ssize_t  n;
+
+#if defined(PETSC_HAVE_O_BINARY)
+  fd = open(job->name,O_WRONLY|O_CREAT|O_BINARY,0666);
+#else
+  fd = open(job->name,O_WRONLY|O_CREAT,0666);
+#endif
+  if (fd == -1) return errno ? errno : EIO;
+  for (s=0; s<job->nseg && !err; s++) {
+    if (lseek(fd,(off_t)job->offset[s],SEEK_SET) == (off_t)-1) {err = errno ? errno : EIO; break;}
+    for (done=0; done<job->len[s]; done+=(size_t)n) {
+      n = write(fd,job->buf+pos+done,job->len[s]-done);
+      if (n <= 0) {err = (n < 0 && errno) ? errno : EIO; break;}
+    }
+    pos += job->len[s];
+  }
+#if defined(PETSC_HAVE_UNISTD_H)
+  if (!err && job->size >= 0 && ftruncate(fd,(off_t)job->size)) err = errno ? errno : EIO;
+#endif
+  if (close(fd) && !err) err = errno ? errno : EIO;
+  return err;
+}
+
+#if defined(PETSC_HAVE_PTHREAD_H)
+static void *PetscAsyncWriterMain(void *arg)
+{
+  PetscAsyncWriter w = (PetscAsyncWriter)arg;
+  PetscAsyncJob    *job;
+  int              err;
+
+  pthread_mutex_lock(&w->mutex);
+  while (1) {
+    while (!w->count && !w->done) pthread_cond_wait(&w->posted,&w->mutex);
+    if (!w->count) break;
+    job = &w->jobs[w->head];
+    pthread_mutex_unlock(&w->mutex);
+    err = PetscAsyncJobWrite(job);
+    pthread_mutex_lock(&w->mutex);
+    if (err && !w->err) {
+      w->err = err;
+      strncpy(w->errname,job->name,sizeof(w->errname)-1);
+    }
+    w->head = (w->head + 1) % w->nbuffers;
+    w->count--;
+    pthread_cond_signal(&w->freed);
+  }
+  pthread_mutex_unlock(&w->mutex);
+  return PETSC_NULL;
+}
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscAsyncWriterCheckError"
+/*
+   err is w->err read while holding the mutex; w->errname is set once, before w->err becomes nonzero, so it can be read
+   without the mutex afterwards
+*/
+static PetscErrorCode PetscAsyncWriterCheckError(PetscAsyncWriter w,int err)
+{
+  PetscFunctionBegin;
+  if (err) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_FILE_WRITE,"Error writing file %s in the background: %s",w->errname,strerror(err));
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscAsyncWriterCreate"
+/*@C
+   PetscAsyncWriterCreate - Creates an object that writes data to files in the background
+
+   Not Collective
+
+   Input Parameter:
+.  nbuffers - the number of staging buffers, at least 1, for example 2 to fill one while the other is written
+
+   Output Parameter:
+.  writer - the writer
+
+   Level: developer
+
+   Notes:
+   The data is copied into a staging buffer given by PetscAsyncWriterGetBuffer() and written by a thread with
+   PetscAsyncWriterPost(), which returns immediately. The thread only makes system calls, so it neither calls MPI nor
+   needs MPI_THREAD_MULTIPLE; the processes of a parallel file compute where their data goes in the time loop, and
+   write disjoint parts of the same file. When all the buffers are posted PetscAsyncWriterGetBuffer() waits for the
+   first of them to be written. Without pthreads the data is written by PetscAsyncWriterPost().
+
+.seealso: PetscAsyncWriterGetBuffer(), PetscAsyncWriterPost(), PetscAsyncWriterFlush(), PetscAsyncWriterDestroy()
+@*/
+PetscErrorCode PetscAsyncWriterCreate(PetscInt nbuffers,PetscAsyncWriter *writer)
+{
+  PetscAsyncWriter w;
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  PetscValidPointer(writer,2);
+  if (nbuffers < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of buffers %D must be positive",nbuffers);
+  ierr = PetscNew(struct _n_PetscAsyncWriter,&w);CHKERRQ(ierr);
+  ierr = PetscMalloc(nbuffers*sizeof(PetscAsyncJob),&w->jobs);CHKERRQ(ierr);
+  ierr = PetscMemzero(w->jobs,nbuffers*sizeof(PetscAsyncJob));CHKERRQ(ierr);
+  w->nbuffers = nbuffers;
+  w->current  = -1;
+#if defined(PETSC_HAVE_PTHREAD_H)
+  if (pthread_mutex_init(&w->mutex,PETSC_NULL) || pthread_cond_init(&w->posted,PETSC_NULL) || pthread_cond_init(&w->freed,PETSC_NULL)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SYS,"Cannot initialize the synchronization of the writer thread");
+  if (pthread_create(&w->thread,PETSC_NULL,PetscAsyncWriterMain,w)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SYS,"Cannot create the writer thread");
+#endif
+  *writer = w;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscAsyncWriterGetBuffer"
+/*@C
+   PetscAsyncWriterGetBuffer - Gets a staging buffer to be filled with data and passed to PetscAsyncWriterPost()
+
+   Not Collective
+
+   Input Parameters:
++  writer - the writer
+-  len - the number of bytes
+
+   Output Parameter:
+.  buf - the buffer, valid until PetscAsyncWriterPost()
+
+   Level: developer
+
+   Notes:
+   Waits for a buffer to be written if all of them are posted.
+
+.seealso: PetscAsyncWriterCreate(), PetscAsyncWriterPost()
+@*/
+PetscErrorCode PetscAsyncWriterGetBuffer(PetscAsyncWriter w,size_t len,void **buf)
+{
+  PetscAsyncJob  *job;
+#if defined(PETSC_HAVE_PTHREAD_H)
+  PetscLogDouble t0,t1;
+  PetscBool      waited;
+#endif
+  int            err;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidPointer(w,1);
+  PetscValidPointer(buf,3);
+  if (w->current >= 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"The last buffer has not been posted");
+#if defined(PETSC_HAVE_PTHREAD_H)
+  /* no PETSc call while the mutex is held, since an error return would leave it locked */
+  ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+  pthread_mutex_lock(&w->mutex);
+  waited = (PetscBool)(w->count == w->nbuffers);
+  while (w->count == w->nbuffers) pthread_cond_wait(&w->freed,&w->mutex);
+  w->current = (w->head + w->count) % w->nbuffers;
+  err        = w->err;
+  pthread_mutex_unlock(&w->mutex);
+  if (waited) {
+    ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+    w->nwaits++;
+    w->waittime += t1 - t0;
+  }
+#else
+  w->current = 0;
+  err        = w->err;
+#endif
+  ierr = PetscAsyncWriterCheckError(w,err);CHKERRQ(ierr);
+  job  = &w->jobs[w->current];
+  if (len > job->maxlen) {
+    ierr        = PetscFree(job->buf);CHKERRQ(ierr);
+    ierr        = PetscMalloc(len,&job->buf);CHKERRQ(ierr);
+    job->maxlen = len;
+  }
+  *buf = job->buf;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscAsyncWriterPost"
+/*@C
+   PetscAsyncWriterPost - Posts the staging buffer to be written to a file in the background
+
+   Not Collective
+
+   Input Parameters:
++  writer - the writer
+.  name - the file, created if it does not exist
+.  nseg - the number of segments, at most 3, in which the buffer is written
+.  offsets - the location in the file of each segment
+.  lens - the number of bytes of each segment, which are consecutive in the buffer
+-  size - the size to which the file is truncated after the write, or -1 to keep its size
+
+   Level: developer
+
+   Notes:
+   The buffer is the one given by the last PetscAsyncWriterGetBuffer(), and is no longer accessible to the caller.
+   Only one process should truncate a file, after writing its last bytes. A file may be posted again before its
+   previous writes are complete, as TSMonitorSolutionAsync() appends every time step to the same binary file, provided
+   the byte ranges of the pending writes do not overlap; otherwise call PetscAsyncWriterFlush() first.
+
+.seealso: PetscAsyncWriterCreate(), PetscAsyncWriterGetBuffer(), PetscAsyncWriterFlush()
+@*/
+PetscErrorCode PetscAsyncWriterPost(PetscAsyncWriter w,const char name[],PetscInt nseg,const Petsc64bitInt offsets[],const size_t lens[],Petsc64bitInt size)
+{
+  PetscAsyncJob  *job;
+  PetscInt       s;
+  PetscErrorCode ierr;
+#if !defined(PETSC_HAVE_PTHREAD_H)
+  int            err;
+#endif
+
+  PetscFunctionBegin;
+  PetscValidPointer(w,1);
+  PetscValidCharPointer(name,2);
+  if (w->current < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Must call PetscAsyncWriterGetBuffer() first");
+  if (nseg < 0 || nseg > PETSC_ASYNC_MAXSEG) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of segments %D must be between 0 and %D",nseg,(PetscInt)PETSC_ASYNC_MAXSEG);
+  job  = &w->jobs[w->current];
+  ierr = PetscStrncpy(job->name,name,sizeof(job->name));CHKERRQ(ierr);
+  for (s=0; s<nseg; s++) {
+    job->offset[s] = offsets[s];
+    job->len[s]    = lens[s];
+  }
+  job->nseg  = nseg;
+  job->size  = size;
+  w->current = -1;
+  w->nposted++;
+#if defined(PETSC_HAVE_PTHREAD_H)
+  pthread_mutex_lock(&w->mutex);
+  w->count++;
+  pthread_cond_signal(&w->posted);
+  pthread_mutex_unlock(&w->mutex);
+#else
+  err = PetscAsyncJobWrite(job);
+  if (err && !w->err) {
+    w->err = err;
+    ierr   = PetscStrcpy(w->errname,name);CHKERRQ(ierr);
+  }
+  ierr = PetscAsyncWriterCheckError(w,w->err);CHKERRQ(ierr);
+#endif
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscAsyncWriterFlush"
+/*@C
+   PetscAsyncWriterFlush - Waits until all the posted buffers are written
+
+   Not Collective
+
+   Input Parameter:
+.  writer - the writer
+
+   Level: developer
+
+   Notes:
+   Generates an error if a write failed.
+
+.seealso: PetscAsyncWriterCreate(), PetscAsyncWriterPost(), PetscAsyncWriterDestroy()
+@*/
+PetscErrorCode PetscAsyncWriterFlush(PetscAsyncWriter w)
+{
+  int            err;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidPointer(w,1);
+#if defined(PETSC_HAVE_PTHREAD_H)
+  pthread_mutex_lock(&w->mutex);
+  while (w->count) pthread_cond_wait(&w->freed,&w->mutex);
+  err = w->err;
+  pthread_mutex_unlock(&w->mutex);
+#else
+  err = w->err;
+#endif
+  ierr = PetscAsyncWriterCheckError(w,err);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscAsyncWriterDestroy"
+/*@C
+   PetscAsyncWriterDestroy - Writes the posted buffers and destroys the writer
+
+   Not Collective
+
+   Input Parameter:
+.  writer - the writer
+
+   Level: developer
+
+.seealso: PetscAsyncWriterCreate(), PetscAsyncWriterFlush()
+@*/
+PetscErrorCode PetscAsyncWriterDestroy(PetscAsyncWriter *writer)
+{
+  PetscAsyncWriter w;
+  PetscInt         i;
+  int              err;
+  char             errname[PETSC_MAX_PATH_LEN];
+  PetscErrorCode   ierr;
+
+  PetscFunctionBegin;
+  if (!*writer) PetscFunctionReturn(0);
+  w = *writer;
+  *writer = PETSC_NULL;
+#if defined(PETSC_HAVE_PTHREAD_H)
+  pthread_mutex_lock(&w->mutex);
+  w->done = PETSC_TRUE;
+  pthread_cond_signal(&w->posted);
+  pthread_mutex_unlock(&w->mutex);
+  pthread_join(w->thread,PETSC_NULL);
+  pthread_mutex_destroy(&w->mutex);
+  pthread_cond_destroy(&w->posted);
+  pthread_cond_destroy(&w->freed);
+#endif
+  ierr = PetscInfo3(0,"%D buffers written, %D waits for a free buffer taking %G seconds\n",w->nposted,w->nwaits,(PetscReal)w->waittime);CHKERRQ(ierr);
+  for (i=0; i<w->nbuffers; i++) {
+    ierr = PetscFree(w->jobs[i].buf);CHKERRQ(ierr);
+  }
+  err  = w->err;
+  ierr = PetscStrcpy(errname,w->errname);CHKERRQ(ierr);
+  ierr = PetscFree(w->jobs);CHKERRQ(ierr);
+  ierr = PetscFree(w);CHKERRQ(ierr);
+  if (err) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_FILE_WRITE,"Error writing file %s in the background: %s",errname,strerror(err));
+  PetscFunctionReturn(0);
+}
@@ -105,6 +105,7 @@ PetscErrorCode  PetscLogDestroy(void)
   PetscFunctionBegin;
   ierr = PetscFree(petsc_actions);CHKERRQ(ierr);
   ierr = PetscFree(petsc_objects);CHKERRQ(ierr);
+  ierr = PetscLogTimelineDestroy();CHKERRQ(ierr);
   ierr = PetscLogSet(PETSC_NULL, PETSC_NULL);CHKERRQ(ierr);
 
   /* Resetting phase */
@@ -174,6 +175,7 @@ PetscErrorCode  PetscLogSet(PetscErrorCode (*b)(PetscLogEvent, int, PetscObject,
   PetscFunctionBegin;
   PetscLogPLB = b;
   PetscLogPLE = e;
+  if (b != PetscLogEventBeginTimeline) petsc_logTimeline = PETSC_FALSE;
   PetscFunctionReturn(0);
 }
 
@@ -0,0 +1,322 @@
+/*
+     Timeline logging: every thread records the nested intervals of the events it runs in a ring
+   buffer, the intervals are written in the Chrome trace event format by PetscLogTimelineDump().
+   The flat per-stage logging installed before PetscLogTimelineBegin() keeps working on top of it.
+*/
+#include <petsc-private/logimpl.h>  /*I    "petscsys.h"   I*/
+
+extern PetscErrorCode PetscLogBegin_Private(void);
+
+#define TIMELINE_MAXDEPTH 64           /* deeper intervals are not recorded, but kept balanced */
+
+typedef struct {
+  PetscLogDouble begin,end;
+  PetscLogEvent  event;
+  int            depth;                /* number of enclosing intervals of the same thread */
+} TimelineRecord;
+
+typedef struct _n_TimelineBuffer *TimelineBuffer;
+struct _n_TimelineBuffer {
+  TimelineRecord *records;             /* ring of the completed intervals */
+  size_t         size;                 /* capacity of the ring, a power of two */
+  size_t         ncompleted;           /* record i is in records[i & (size-1)] */
+  int            depth;
+  PetscLogEvent  open[TIMELINE_MAXDEPTH];
+  PetscLogDouble openbegin[TIMELINE_MAXDEPTH];
+  int            tid;                  /* 0 for the thread that called PetscLogTimelineBegin() */
+  TimelineBuffer next;
+};
+
+#if defined(PETSC_PTHREAD_LOCAL)
+static PETSC_PTHREAD_LOCAL TimelineBuffer timeline = 0;
+static PETSC_PTHREAD_LOCAL int            timelinegen = 0;
+#else
+static TimelineBuffer timeline = 0;
+static int            timelinegen = 0;
+#endif
+static int            timelinecurrentgen = 1;  /* buffers of an earlier generation were freed by PetscLogTimelineDestroy() */
+static TimelineBuffer timelines     = 0;  /* the buffers of all threads, most recent first */
+static int            timelinecount = 0;
+static size_t         timelinesize  = 0;
+static PetscLogDouble timelinebase  = 0.0;
+#if defined(PETSC_HAVE_PTHREADCLASSES)
+static pthread_mutex_t timelinelock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* the handlers that were installed before the timeline, called by the first thread only */
+static PetscErrorCode (*timelinePLB)(PetscLogEvent,int,PetscObject,PetscObject,PetscObject,PetscObject) = PETSC_NULL;
+static PetscErrorCode (*timelinePLE)(PetscLogEvent,int,PetscObject,PetscObject,PetscObject,PetscObject) = PETSC_NULL;
+
+PetscBool petsc_logTimeline = PETSC_FALSE;
+
+#undef __FUNCT__
+#define __FUNCT__ "TimelineBufferGet"
+/*
+   Gets the buffer of the calling thread, creating it on the first event of the thread. The
+   buffers are obtained with malloc() since PetscMalloc() may not be called from the threads
+   of a PetscThreadComm.
+*/
+static PetscErrorCode TimelineBufferGet(TimelineBuffer *tl)
+{
+  TimelineBuffer b;
+
+  PetscFunctionBegin;
+  if (timelinegen != timelinecurrentgen) {
+    b = (TimelineBuffer)calloc(1,sizeof(struct _n_TimelineBuffer));
+    if (!b) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_MEM,"Unable to allocate timeline");
+    b->records = (TimelineRecord*)malloc(timelinesize*sizeof(TimelineRecord));
+    if (!b->records) {free(b); SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_MEM,"Unable to allocate a timeline of %D intervals",(PetscInt)timelinesize);}
+    b->size = timelinesize;
+#if defined(PETSC_HAVE_PTHREADCLASSES)
+    pthread_mutex_lock(&timelinelock);
+#endif
+    b->tid    = timelinecount++;
+    b->next   = timelines;
+    timelines = b;
+#if defined(PETSC_HAVE_PTHREADCLASSES)
+    pthread_mutex_unlock(&timelinelock);
+#endif
+    timeline    = b;
+    timelinegen = timelinecurrentgen;
+  }
+  *tl = timeline;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogEventBeginTimeline"
+PetscErrorCode PetscLogEventBeginTimeline(PetscLogEvent event,int t,PetscObject o1,PetscObject o2,PetscObject o3,PetscObject o4)
+{
+  TimelineBuffer tl = timeline;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (timelinegen != timelinecurrentgen) {ierr = TimelineBufferGet(&tl);CHKERRQ(ierr);}
+  if (tl->depth < TIMELINE_MAXDEPTH) {
+    tl->open[tl->depth]      = event;
+    tl->openbegin[tl->depth] = MPI_Wtime();
+  }
+  tl->depth++;
+  if (!tl->tid && timelinePLB) {ierr = (*timelinePLB)(event,t,o1,o2,o3,o4);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogEventEndTimeline"
+PetscErrorCode PetscLogEventEndTimeline(PetscLogEvent event,int t,PetscObject o1,PetscObject o2,PetscObject o3,PetscObject o4)
+{
+  TimelineBuffer tl = timeline;
+  TimelineRecord *r;
+  int            k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (timelinegen != timelinecurrentgen || tl->depth < 1) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Logging event had unbalanced begin/end pairs");
+  if (tl->depth > TIMELINE_MAXDEPTH) {
+    tl->depth--;
+  } else {
+    /* the events are usually nested, but an interval may also end before one that started inside it */
+    for (k=tl->depth-1; k>=0 && tl->open[k] != event; k--) ;
+    if (k < 0) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Logging event had unbalanced begin/end pairs");
+    r        = &tl->records[tl->ncompleted++ & (tl->size-1)];
+    r->end   = MPI_Wtime();
+    r->begin = tl->openbegin[k];
+    r->event = event;
+    r->depth = k;
+    tl->depth--;
+    for (; k<tl->depth; k++) {
+      tl->open[k]      = tl->open[k+1];
+      tl->openbegin[k] = tl->openbegin[k+1];
+    }
+  }
+  if (!tl->tid && timelinePLE) {ierr = (*timelinePLE)(event,t,o1,o2,o3,o4);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogTimelineBegin"
+/*@C
+  PetscLogTimelineBegin - Turns on the recording of the nested intervals of all events, by all
+  threads, for a timeline view of the run.
+
+  Logically Collective on PETSC_COMM_WORLD
+
+  Input Parameter:
+. size - the number of most recent intervals kept for each thread, or PETSC_DECIDE
+
+  Options Database Keys:
++ -log_timeline [filename] - Activates PetscLogTimelineBegin() and calls PetscLogTimelineDump() in PetscFinalize()
+- -log_timeline_size <size> - The number of intervals kept for each thread, the default is 65536
+
+  Notes:
+  Each thread, including those of a PetscThreadComm running kernels, writes the intervals in a ring
+  buffer of its own, so recording takes no lock and no communication. Once the buffer is full the oldest
+  intervals are overwritten. The size is rounded up to a power of two.
+
+  The logging installed earlier with PetscLogBegin() or PetscLogAllBegin() goes on for the events
+  of the thread that calls this routine. Calling those routines afterwards turns the timeline off.
+
+  Level: advanced
+
+.keywords: log, timeline, trace
+.seealso: PetscLogTimelineDump(), PetscLogBegin(), PetscLogTraceBegin()
+@*/
+PetscErrorCode PetscLogTimelineBegin(PetscInt size)
+{
+  PetscErrorCode ierr;
+  TimelineBuffer tl;
+
+  PetscFunctionBegin;
+  if (petsc_logTimeline) PetscFunctionReturn(0);
+  if (size == PETSC_DECIDE || size == PETSC_DEFAULT) size = 65536;
+  if (size < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Timeline size %D must be positive",size);
+  for (timelinesize=1; timelinesize<(size_t)size; timelinesize<<=1) ;
+  ierr = PetscLogBegin_Private();CHKERRQ(ierr);
+  ierr = TimelineBufferGet(&tl);CHKERRQ(ierr);
+  ierr = MPI_Barrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+  timelinebase      = MPI_Wtime();
+  timelinePLB       = PetscLogPLB;
+  timelinePLE       = PetscLogPLE;
+  ierr = PetscLogSet(PetscLogEventBeginTimeline,PetscLogEventEndTimeline);CHKERRQ(ierr);
+  petsc_logTimeline = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TimelineAppend"
+/* Appends a formatted string to a character buffer, enlarging it as needed */
+static PetscErrorCode TimelineAppend(char **buf,size_t *len,size_t *maxlen,const char format[],...)
+{
+  PetscErrorCode ierr;
+  va_list        Argp;
+  size_t         fullLength = 0;
+  char           *tmp;
+
+  PetscFunctionBegin;
+  while (1) {
+    if (*len + fullLength + 256 > *maxlen) {
+      ierr = PetscMalloc(2*(*maxlen)+fullLength+1024,&tmp);CHKERRQ(ierr);
+      ierr = PetscMemcpy(tmp,*buf,*len);CHKERRQ(ierr);
+      ierr = PetscFree(*buf);CHKERRQ(ierr);
+      *buf    = tmp;
+      *maxlen = 2*(*maxlen)+fullLength+1024;
+    }
+    va_start(Argp,format);
+    ierr = PetscVSNPrintf(*buf+*len,*maxlen-*len,format,&fullLength,Argp);CHKERRQ(ierr);
+    va_end(Argp);
+    if (*len + fullLength < *maxlen) break;
+  }
+  *len += fullLength;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogTimelineDump"
+/*@C
+  PetscLogTimelineDump - Writes the intervals recorded since PetscLogTimelineBegin() in the Chrome trace
+  event format, which can be loaded in chrome://tracing or Perfetto.
+
+  Collective on PETSC_COMM_WORLD
+
+  Input Parameter:
+. filename - the name of the file, or PETSC_NULL for petsc_timeline.json
+
+  Notes:
+  Each MPI process appears as a process of the trace and each of its threads as a thread, the
+  times are in microseconds since PetscLogTimelineBegin(), after which all processes synchronized.
+  The first process gathers the intervals of the others one at a time and writes the file.
+  Intervals still open are not written.
+
+  The threads must not be logging events during this call.
+
+  Level: advanced
+
+.keywords: log, timeline, trace, dump
+.seealso: PetscLogTimelineBegin(), PetscLogDump()
+@*/
+PetscErrorCode PetscLogTimelineDump(const char filename[])
+{
+  PetscErrorCode   ierr;
+  PetscStageLog    stageLog;
+  PetscEventRegLog eventRegLog;
+  TimelineBuffer   tl;
+  TimelineRecord   *r;
+  PetscMPIInt      rank,size,p,len;
+  MPI_Status       status;
+  char             *buf = PETSC_NULL,*rbuf;
+  size_t           blen = 0,maxlen = 0,i,first;
+  PetscLogDouble   dropped = 0.0,totdropped;
+  FILE             *fd = PETSC_NULL;
+  int              err;
+
+  PetscFunctionBegin;
+  if (!timelines) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ORDER,"Must call PetscLogTimelineBegin() or use -log_timeline first");
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscLogGetStageLog(&stageLog);CHKERRQ(ierr);
+  ierr = PetscStageLogGetEventRegLog(stageLog,&eventRegLog);CHKERRQ(ierr);
+
+  ierr = TimelineAppend(&buf,&blen,&maxlen,"%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"[%d]\"}}",rank ? ",\n" : "",rank,rank);CHKERRQ(ierr);
+  for (tl=timelines; tl; tl=tl->next) {
+    ierr = TimelineAppend(&buf,&blen,&maxlen,",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",rank,tl->tid,tl->tid);CHKERRQ(ierr);
+    first = tl->ncompleted > tl->size ? tl->ncompleted - tl->size : 0;
+    dropped += (PetscLogDouble)first;
+    for (i=first; i<tl->ncompleted; i++) {
+      r    = &tl->records[i & (tl->size-1)];
+      ierr = TimelineAppend(&buf,&blen,&maxlen,",\n{\"name\":\"%s\",\"cat\":\"PETSc\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%d}}",
+                            eventRegLog->eventInfo[r->event].name,rank,tl->tid,1.e6*(r->begin-timelinebase),1.e6*(r->end-r->begin),r->depth);CHKERRQ(ierr);
+    }
+  }
+  ierr = MPI_Reduce(&dropped,&totdropped,1,MPIU_PETSCLOGDOUBLE,MPI_SUM,0,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  if (totdropped > 0.0) {ierr = PetscInfo1(0,"%g intervals were overwritten, use a larger -log_timeline_size\n",totdropped);CHKERRQ(ierr);}
+
+  if (!rank) {
+    if (!filename) filename = "petsc_timeline.json";
+    fd = fopen(filename,"w");
+    if (!fd) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file: %s",filename);
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fd,"{\"traceEvents\":[\n");CHKERRQ(ierr);
+    err  = fwrite(buf,1,blen,fd);
+    if (err != (int)blen) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_WRITE,"fwrite() failed on file");
+    for (p=1; p<size; p++) {
+      ierr = MPI_Recv(&len,1,MPI_INT,p,0,PETSC_COMM_WORLD,&status);CHKERRQ(ierr);
+      ierr = PetscMalloc(len*sizeof(char),&rbuf);CHKERRQ(ierr);
+      ierr = MPI_Recv(rbuf,len,MPI_CHAR,p,0,PETSC_COMM_WORLD,&status);CHKERRQ(ierr);
+      err  = fwrite(rbuf,1,len,fd);
+      if (err != len) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_FILE_WRITE,"fwrite() failed on file");
+      ierr = PetscFree(rbuf);CHKERRQ(ierr);
+    }
+    ierr = PetscFPrintf(PETSC_COMM_SELF,fd,"\n],\n\"displayTimeUnit\":\"ms\",\"otherData\":{\"overwritten\":%g}}\n",totdropped);CHKERRQ(ierr);
+    err  = fclose(fd);
+    if (err) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SYS,"fclose() failed on file");
+  } else {
+    len  = (PetscMPIInt)blen;
+    ierr = MPI_Send(&len,1,MPI_INT,0,0,PETSC_COMM_WORLD);CHKERRQ(ierr);
+    ierr = MPI_Send(buf,len,MPI_CHAR,0,0,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(buf);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscLogTimelineDestroy"
+/*
+   Frees the buffers of all threads, called by PetscLogDestroy()
+*/
+PetscErrorCode PetscLogTimelineDestroy(void)
+{
+  TimelineBuffer tl;
+
+  PetscFunctionBegin;
+  while ((tl = timelines)) {
+    timelines = tl->next;
+    free(tl->records);
+    free(tl);
+  }
+  timeline          = 0;
+  timelinecount     = 0;
+  timelinecurrentgen++;
+  timelinePLB       = PETSC_NULL;
+  timelinePLE       = PETSC_NULL;
+  petsc_logTimeline = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
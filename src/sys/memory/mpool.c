@@ -0,0 +1,352 @@
+/*
+     A pooled malloc() for PETSc. Small requests are rounded up to a power of two and
+  served from free lists of blocks of that size, the blocks are carved from larger
+  slabs obtained with PetscMallocAlign(). Each thread has its own pool so the common
+  path takes no lock.
+*/
+#include <petscsys.h>             /*I   "petscsys.h"   I*/
+
+extern PetscErrorCode PetscMallocAlign(size_t,int,const char[],const char[],const char[],void**);
+extern PetscErrorCode PetscFreeAlign(void*,int,const char[],const char[],const char[]);
+
+#define POOL_CLASSID    ((PetscClassId) 0x0b1c2d3e)
+#define POOL_NCLASSES   9                 /* blocks of POOL_MINSIZE,2*POOL_MINSIZE,... bytes */
+#define POOL_MINSIZE    (PETSC_MEMALIGN > 16 ? PETSC_MEMALIGN : 16)
+#define POOL_MAXSIZE    ((size_t)POOL_MINSIZE << (POOL_NCLASSES-1))
+#define POOL_SLABSIZE   65536             /* bytes of blocks in a slab, at least POOL_SLABMIN blocks */
+#define POOL_SLABMIN    16
+
+typedef struct _PoolSlab *PoolSlab;
+struct _PoolSlab {
+  PoolSlab next;
+  size_t   nlive;                         /* blocks of this slab currently handed out */
+  size_t   size;                          /* bytes of the slab, including this header */
+};
+
+#define SLAB_HEADER ((sizeof(struct _PoolSlab)+(PETSC_MEMALIGN-1)) & ~(PETSC_MEMALIGN-1))
+
+/* the header in front of every block handed out by the pool */
+typedef struct {
+  union {
+    PoolSlab slab;                        /* slab the block was carved from */
+    size_t   size;                        /* bytes of an allocation too large for the pool */
+  } u;
+  int          cls;                       /* size class, -1 for large allocations */
+  PetscClassId classid;
+} PoolBlock;
+
+#define BLOCK_HEADER ((sizeof(PoolBlock)+(PETSC_MEMALIGN-1)) & ~(PETSC_MEMALIGN-1))
+
+typedef struct _PoolData *PoolData;
+struct _PoolData {
+  void           *freelist[POOL_NCLASSES];/* free blocks, linked through their first word */
+  char           *cur[POOL_NCLASSES];     /* part of the newest slab of each class not yet carved */
+  char           *end[POOL_NCLASSES];
+  PoolSlab       slabs[POOL_NCLASSES];    /* the newest slab is first */
+  PetscInt       nempty;                  /* slabs without live blocks */
+  size_t         reserved;                /* bytes obtained from the system */
+  size_t         live;                    /* bytes of the blocks currently handed out */
+  PetscLogDouble nmalloc,nhit;            /* pooled requests, and those served from a free list */
+  PetscLogDouble requested,rounded;       /* bytes of all pooled requests, before and after rounding */
+  PoolData       next;
+};
+
+#if defined(PETSC_PTHREAD_LOCAL)
+static PETSC_PTHREAD_LOCAL PoolData pool = 0;
+#else
+static PoolData pool = 0;
+#endif
+static PoolData pools = 0;                /* all the pools, used for the statistics and to free them */
+#if defined(PETSC_HAVE_PTHREADCLASSES)
+static pthread_mutex_t poolslock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+PetscBool PetscMallocPoolActive = PETSC_FALSE;
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscMallocPoolGet_Private"
+static PetscErrorCode PetscMallocPoolGet_Private(PoolData *p)
+{
+  PetscFunctionBegin;
+  if (!pool) {
+    pool = (PoolData)calloc(1,sizeof(struct _PoolData));
+    if (!pool) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_MEM,"Unable to allocate memory pool");
+#if defined(PETSC_HAVE_PTHREADCLASSES)
+    pthread_mutex_lock(&poolslock);
+#endif
+    pool->next            = pools;
+    pools                 = pool;
+    PetscMallocPoolActive = PETSC_TRUE;
+#if defined(PETSC_HAVE_PTHREADCLASSES)
+    pthread_mutex_unlock(&poolslock);
+#endif
+  }
+  *p = pool;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscMallocPool"
+/*@C
+   PetscMallocPool - A malloc() that serves small requests from pools of fixed size blocks
+
+   Not Collective
+
+   Input Parameters:
++  mem - number of bytes requested
+.  line - line number where called
+.  func - function where called
+.  file - file where called
+-  dir - directory of the file
+
+   Output Parameter:
+.  result - the aligned memory
+
+   Options Database Key:
+.  -malloc_pool - use PetscMallocPool() and PetscFreePool() for all PetscMalloc() and PetscFree()
+
+   Notes:
+   Requests of up to 4096 bytes are rounded up to a power of two and served from a free
+   list of blocks of that size. The free lists are local to each thread, memory must be
+   freed with PetscFreePool() by the thread that allocated it. Larger requests go directly
+   to PetscMallocAlign().
+
+   The blocks are carved from slabs of 64 kilobytes that are returned to the system
+   by PetscMallocPoolRelease() once none of their blocks is in use, this is done
+   automatically when a PETSc object is destroyed.
+
+   Install with PetscMallocSet(PetscMallocPool,PetscFreePool) before PetscInitialize() or
+   with the option -malloc_pool. The tracing of -malloc_debug, -malloc_dump and -malloc_log
+   is done on top of the pool.
+
+   Level: developer
+
+   Concepts: memory^pool
+
+.seealso: PetscFreePool(), PetscMallocSet(), PetscMallocPoolGetUsage(), PetscMallocPoolRelease()
+@*/
+PetscErrorCode PetscMallocPool(size_t mem,int line,const char func[],const char file[],const char dir[],void **result)
+{
+  PetscErrorCode ierr;
+  PoolData       p;
+  PoolSlab       slab;
+  PoolBlock      *b;
+  size_t         size = POOL_MINSIZE,bsize,nblocks;
+  int            cls = 0;
+  char           *raw;
+
+  if (mem > POOL_MAXSIZE) {
+    ierr = PetscMallocAlign(mem+BLOCK_HEADER,line,func,file,dir,(void**)&raw);if (ierr) return ierr;
+    b           = (PoolBlock*)raw;
+    b->u.size   = mem+BLOCK_HEADER;
+    b->cls      = -1;
+    b->classid  = POOL_CLASSID;
+    ierr        = PetscMallocPoolGet_Private(&p);if (ierr) return ierr;
+    p->reserved += b->u.size;
+    p->live     += b->u.size;
+    *result     = (void*)(raw+BLOCK_HEADER);
+    return 0;
+  }
+  while (size < mem) {size <<= 1; cls++;}
+  ierr = PetscMallocPoolGet_Private(&p);if (ierr) return ierr;
+  bsize = BLOCK_HEADER + size;
+  p->nmalloc++;
+  p->requested += mem;
+  p->rounded   += size;
+  if (p->freelist[cls]) {
+    raw              = (char*)p->freelist[cls] - BLOCK_HEADER;
+    p->freelist[cls] = *(void**)p->freelist[cls];
+    p->nhit++;
+  } else {
+    if (p->cur[cls] == p->end[cls]) {
+      nblocks = PetscMax(POOL_SLABMIN,POOL_SLABSIZE/bsize);
+      ierr = PetscMallocAlign(SLAB_HEADER+nblocks*bsize,line,func,file,dir,(void**)&raw);if (ierr) return ierr;
+      slab             = (PoolSlab)raw;
+      slab->nlive      = 0;
+      slab->size       = SLAB_HEADER+nblocks*bsize;
+      slab->next       = p->slabs[cls];
+      p->slabs[cls]    = slab;
+      p->cur[cls]      = raw + SLAB_HEADER;
+      p->end[cls]      = p->cur[cls] + nblocks*bsize;
+      p->reserved     += slab->size;
+      p->nempty++;
+    }
+    raw          = p->cur[cls];
+    p->cur[cls] += bsize;
+    b            = (PoolBlock*)raw;
+    b->u.slab    = p->slabs[cls];
+    b->cls       = cls;
+  }
+  b = (PoolBlock*)raw;
+  b->classid = POOL_CLASSID;
+  if (!b->u.slab->nlive++) p->nempty--;
+  p->live += size;
+  *result  = (void*)(raw+BLOCK_HEADER);
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscFreePool"
+/*@C
+   PetscFreePool - Frees memory obtained with PetscMallocPool()
+
+   Not Collective
+
+   Input Parameters:
++  ptr - the memory
+.  line - line number where called
+.  func - function where called
+.  file - file where called
+-  dir - directory of the file
+
+   Level: developer
+
+.seealso: PetscMallocPool(), PetscMallocSet()
+@*/
+PetscErrorCode PetscFreePool(void *ptr,int line,const char func[],const char file[],const char dir[])
+{
+  PetscErrorCode ierr;
+  PoolData       p;
+  PoolBlock      *b;
+
+  if (!ptr) return 0;
+  b = (PoolBlock*)((char*)ptr - BLOCK_HEADER);
+  if (b->classid != POOL_CLASSID) return PetscError(PETSC_COMM_SELF,line,func,file,dir,PETSC_ERR_MEMC,PETSC_ERROR_INITIAL,"Memory not allocated by PetscMallocPool() or freed twice");
+  ierr = PetscMallocPoolGet_Private(&p);if (ierr) return ierr;
+  b->classid = 0;
+  if (b->cls < 0) {
+    p->reserved -= b->u.size;
+    p->live     -= b->u.size;
+    return PetscFreeAlign(b,line,func,file,dir);
+  }
+  p->live -= (size_t)POOL_MINSIZE << b->cls;
+  if (!--b->u.slab->nlive) p->nempty++;
+  *(void**)ptr        = p->freelist[b->cls];
+  p->freelist[b->cls] = ptr;
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscMallocPoolRelease"
+/*@C
+   PetscMallocPoolRelease - Returns the slabs of the memory pool of this thread none of whose
+   blocks are in use to the system
+
+   Not Collective
+
+   Notes:
+   This is called when a PETSc object is destroyed; it only does work if some slab became
+   unused since the last call.
+
+   Level: developer
+
+.seealso: PetscMallocPool(), PetscMallocPoolGetUsage()
+@*/
+PetscErrorCode PetscMallocPoolRelease(void)
+{
+  PetscErrorCode ierr;
+  PoolData       p = pool;
+  PoolSlab       slab,*prev;
+  void           *ptr,**link;
+  int            cls;
+
+  PetscFunctionBegin;
+  if (!p || !p->nempty) PetscFunctionReturn(0);
+  for (cls=0; cls<POOL_NCLASSES; cls++) {
+    /* drop the free blocks of the unused slabs from the free list */
+    link = &p->freelist[cls];
+    while ((ptr = *link)) {
+      if (!((PoolBlock*)((char*)ptr - BLOCK_HEADER))->u.slab->nlive) *link = *(void**)ptr;
+      else link = (void**)ptr;
+    }
+    /* the next block of this class is carved from a new slab if the newest one goes */
+    if (p->slabs[cls] && !p->slabs[cls]->nlive) p->cur[cls] = p->end[cls] = 0;
+    prev = &p->slabs[cls];
+    while ((slab = *prev)) {
+      if (slab->nlive) {prev = &slab->next; continue;}
+      *prev        = slab->next;
+      p->reserved -= slab->size;
+      p->nempty--;
+      ierr = PetscFreeAlign(slab,__LINE__,PETSC_FUNCTION_NAME,__FILE__,__SDIR__);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscMallocPoolGetUsage"
+/*@C
+   PetscMallocPoolGetUsage - Gets the memory usage and efficiency of the memory pools of all threads
+
+   Not Collective
+
+   Output Parameters:
++  live - bytes of the blocks currently handed out by the pools
+.  reserved - bytes the pools obtained from the system; 1 - live/reserved is the fraction lost to fragmentation
+.  rounding - fraction of the bytes handed out that was added by rounding requests up to the block size
+-  hitrate - fraction of the requests served from a free list without carving a new block
+
+   Notes:
+   Any output argument may be PETSC_NULL. All values are zero if the pool is not in use.
+
+   Level: intermediate
+
+   Concepts: memory usage
+
+.seealso: PetscMallocPool(), PetscMallocGetCurrentUsage(), PetscMemoryShowUsage()
+@*/
+PetscErrorCode PetscMallocPoolGetUsage(PetscLogDouble *live,PetscLogDouble *reserved,PetscLogDouble *rounding,PetscLogDouble *hitrate)
+{
+  PoolData       p;
+  PetscLogDouble l = 0,r = 0,nmalloc = 0,nhit = 0,requested = 0,rounded = 0;
+
+  PetscFunctionBegin;
+#if defined(PETSC_HAVE_PTHREADCLASSES)
+  pthread_mutex_lock(&poolslock);
+#endif
+  for (p=pools; p; p=p->next) {
+    l         += (PetscLogDouble)p->live;
+    r         += (PetscLogDouble)p->reserved;
+    nmalloc   += p->nmalloc;
+    nhit      += p->nhit;
+    requested += p->requested;
+    rounded   += p->rounded;
+  }
+#if defined(PETSC_HAVE_PTHREADCLASSES)
+  pthread_mutex_unlock(&poolslock);
+#endif
+  if (live)     *live     = l;
+  if (reserved) *reserved = r;
+  if (rounding) *rounding = rounded > 0 ? 1.0 - requested/rounded : 0.0;
+  if (hitrate)  *hitrate  = nmalloc > 0 ? nhit/nmalloc : 0.0;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscMallocPoolDestroy_Private"
+/*
+   Frees all the pools, called by PetscFinalize() after which no memory obtained with
+   PetscMallocPool() may be used.
+*/
+PetscErrorCode PetscMallocPoolDestroy_Private(void)
+{
+  PetscErrorCode ierr;
+  PoolData       p;
+  PoolSlab       slab;
+  int            cls;
+
+  PetscFunctionBegin;
+  while ((p = pools)) {
+    for (cls=0; cls<POOL_NCLASSES; cls++) {
+      while ((slab = p->slabs[cls])) {
+        p->slabs[cls] = slab->next;
+        ierr = PetscFreeAlign(slab,__LINE__,PETSC_FUNCTION_NAME,__FILE__,__SDIR__);CHKERRQ(ierr);
+      }
+    }
+    pools = p->next;
+    free(p);
+  }
+  pool                  = 0;
+  PetscMallocPoolActive = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
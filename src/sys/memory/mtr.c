@@ -20,6 +20,13 @@ extern PetscErrorCode  PetscFreeAlign(void*,int,const char[],const char[],const
 extern PetscErrorCode  PetscTrMallocDefault(size_t,int,const char[],const char[],const char[],void**);
 extern PetscErrorCode  PetscTrFreeDefault(void*,int,const char[],const char[],const char[]);
 
+/*
+     The traced blocks are obtained from these, the memory pool if it was installed before the tracing
+*/
+static PetscErrorCode (*PetscTrMallocBase)(size_t,int,const char[],const char[],const char[],void**) = PetscMallocAlign;
+static PetscErrorCode (*PetscTrFreeBase)(void*,int,const char[],const char[],const char[])          = PetscFreeAlign;
+extern PetscBool      PetscMallocPoolActive;
+
 
 #define CLASSID_VALUE   ((PetscClassId) 0xf0e0d0c9)
 #define ALREADY_FREED  ((PetscClassId) 0x0f0e0d9c)
@@ -75,6 +82,14 @@ PetscErrorCode PetscSetUseTrMalloc_Private(void)
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
+  if (PetscTrMalloc == PetscMallocPool) {
+    PetscTrMallocBase = PetscMallocPool;
+    PetscTrFreeBase   = PetscFreePool;
+    ierr = PetscMallocClear();CHKERRQ(ierr);
+  } else if (PetscTrMalloc != PetscTrMallocDefault) {
+    PetscTrMallocBase = PetscMallocAlign;
+    PetscTrFreeBase   = PetscFreeAlign;
+  }
   ierr = PetscMallocSet(PetscTrMallocDefault,PetscTrFreeDefault);CHKERRQ(ierr);
   TRallocated       = 0;
   TRfrags           = 0;
@@ -188,7 +203,7 @@ PetscErrorCode  PetscTrMallocDefault(size_t a,int lineno,const char function[],c
   }
 
   nsize = (a + (PETSC_MEMALIGN-1)) & ~(PETSC_MEMALIGN-1);
-  ierr = PetscMallocAlign(nsize+sizeof(TrSPACE)+sizeof(PetscClassId),lineno,function,filename,dir,(void**)&inew);CHKERRQ(ierr);
+  ierr = (*PetscTrMallocBase)(nsize+sizeof(TrSPACE)+sizeof(PetscClassId),lineno,function,filename,dir,(void**)&inew);CHKERRQ(ierr);
 
   head   = (TRSPACE *)inew;
   inew  += sizeof(TrSPACE);
@@ -322,7 +337,7 @@ PetscErrorCode  PetscTrFreeDefault(void *aa,int line,const char function[],const
   else TRhead = head->next;
 
   if (head->next) head->next->prev = head->prev;
-  ierr = PetscFreeAlign(a,line,function,file,dir);CHKERRQ(ierr);
+  ierr = (*PetscTrFreeBase)(a,line,function,file,dir);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -374,6 +389,12 @@ PetscErrorCode  PetscMemoryShowUsage(PetscViewer viewer,const char message[])
   } else {
     ierr = PetscViewerASCIIPrintf(viewer,"Run with -malloc to get statistics on PetscMalloc() calls\nOS cannot compute process memory\n");CHKERRQ(ierr);
   }
+  if (PetscMallocPoolActive) {
+    PetscLogDouble live,reserved,rounding,hitrate;
+
+    ierr = PetscMallocPoolGetUsage(&live,&reserved,&rounding,&hitrate);CHKERRQ(ierr);
+    ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d]Memory pool in use %g, reserved %g (%g%% fragmentation), %g%% added by rounding, %g%% of requests reused a free block\n",rank,live,reserved,reserved > 0 ? 100.0*(1.0-live/reserved) : 0.0,100.0*rounding,100.0*hitrate);CHKERRQ(ierr);
+  }
   ierr = PetscViewerFlush(viewer);CHKERRQ(ierr);
   ierr = PetscViewerASCIISynchronizedAllow(viewer,PETSC_FALSE);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -261,13 +261,16 @@ PetscErrorCode  PetscOptionsCheckInitial_Private(void)
   /*
       Setup the memory management; support for tracing malloc() usage
   */
+  flg1 = PETSC_FALSE;
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-malloc_pool",&flg1,PETSC_NULL);CHKERRQ(ierr);
+  if (flg1) {ierr = PetscMallocSet(PetscMallocPool,PetscFreePool);CHKERRQ(ierr);}
   ierr = PetscOptionsHasName(PETSC_NULL,"-malloc_log",&flg3);CHKERRQ(ierr);
   logthreshold = 0.0;
   ierr = PetscOptionsGetReal(PETSC_NULL,"-malloc_log_threshold",&logthreshold,&flg1);CHKERRQ(ierr);
   if (flg1) flg3 = PETSC_TRUE;
 #if defined(PETSC_USE_DEBUG)
   ierr = PetscOptionsGetBool(PETSC_NULL,"-malloc",&flg1,&flg2);CHKERRQ(ierr);
-  if ((!flg2 || flg1) && !petscsetmallocvisited) {
+  if ((!flg2 || flg1) && (!petscsetmallocvisited || PetscTrMalloc == PetscMallocPool)) {
     if (flg2 || !(PETSC_RUNNING_ON_VALGRIND)) {
       /* turn off default -malloc if valgrind is being used */
       ierr = PetscSetUseTrMalloc_Private();CHKERRQ(ierr);
@@ -503,6 +506,13 @@ PetscErrorCode  PetscOptionsCheckInitial_Private(void)
     }
     ierr = PetscLogTraceBegin(file);CHKERRQ(ierr);
   }
+
+  ierr = PetscOptionsHasName(PETSC_NULL,"-log_timeline",&flg1);CHKERRQ(ierr);
+  if (flg1) {
+    PetscInt size = PETSC_DECIDE;
+    ierr = PetscOptionsGetInt(PETSC_NULL,"-log_timeline_size",&size,PETSC_NULL);CHKERRQ(ierr);
+    ierr = PetscLogTimelineBegin(size);CHKERRQ(ierr);
+  }
 #endif
 
   /*
@@ -577,6 +587,7 @@ PetscErrorCode  PetscOptionsCheckInitial_Private(void)
     ierr = (*PetscHelpPrintf)(comm," -malloc_info: prints total memory usage\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -malloc_log: keeps log of all memory allocations\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -malloc_debug: enables extended checking for memory corruption\n");CHKERRQ(ierr);
+    ierr = (*PetscHelpPrintf)(comm," -malloc_pool: serve small PetscMalloc() requests from pools of fixed size blocks\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -options_table: dump list of options inputted\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -options_left: dump list of unused options\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -options_left no: don't dump list of unused options\n");CHKERRQ(ierr);
@@ -589,6 +600,8 @@ PetscErrorCode  PetscOptionsCheckInitial_Private(void)
     ierr = (*PetscHelpPrintf)(comm," -get_total_flops: total flops over all processors\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -log[_summary _summary_python]: logging objects and events\n");CHKERRQ(ierr);
     ierr = (*PetscHelpPrintf)(comm," -log_trace [filename]: prints trace of all PETSc calls\n");CHKERRQ(ierr);
+    ierr = (*PetscHelpPrintf)(comm," -log_timeline [filename]: writes the nested events of all threads as a Chrome trace\n");CHKERRQ(ierr);
+    ierr = (*PetscHelpPrintf)(comm," -log_timeline_size <size>: number of events kept for each thread\n");CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MPE)
     ierr = (*PetscHelpPrintf)(comm," -log_mpe: Also create logfile viewable through upshot\n");CHKERRQ(ierr);
 #endif
@@ -24,20 +24,50 @@
 #if defined(PETSC_HAVE_YAML)
 #include <yaml.h>
 #endif
+#include <../src/sys/utils/hash.h>
 
 /*
-    This table holds all the options set by the user. For simplicity, we use a static size database
+    Option names are compared without regard to case, so the hash function and the ordering
+    used for the table lower the case of each character.
+*/
+PETSC_STATIC_INLINE khint_t PetscOptionsHash_Private(const char *s)
+{
+  khint_t h = (khint_t)tolower((unsigned char)*s);
+  if (h) for (++s ; *s; ++s) h = (h << 5) - h + (khint_t)tolower((unsigned char)*s);
+  return h;
+}
+
+/* Compares at most n characters of a and b without regard to case, returns <0, 0, >0 like strncmp() */
+PETSC_STATIC_INLINE int PetscOptionsCompare_Private(const char *a,const char *b,size_t n)
+{
+  int ca,cb;
+  for (; n; n--,a++,b++) {
+    ca = tolower((unsigned char)*a); cb = tolower((unsigned char)*b);
+    if (ca != cb || !ca) return ca - cb;
+  }
+  return 0;
+}
+#define PetscOptionsEqual_Private(a,b) (!PetscOptionsCompare_Private((a),(b),(size_t)-1))
+
+KHASH_INIT(HOPT,const char*,int,1,PetscOptionsHash_Private,PetscOptionsEqual_Private)
+
+/*
+    This table holds all the options set by the user. The options are stored in the order they were
+    set in names[], values[] and used[], which grow as needed. A hash table maps each name to its
+    location and order[] lists the locations sorted by name, for viewing and prefix searches.
 */
-#define MAXOPTIONS 512
 #define MAXALIASES 25
 #define MAXOPTIONSMONITORS 5
 #define MAXPREFIXES 25
 
 typedef struct {
   int            N,argc,Naliases;
-  char           **args,*names[MAXOPTIONS],*values[MAXOPTIONS];
+  int            Nmax;                 /* allocated length of names[], values[], used[] and order[] */
+  char           **args,**names,**values;
+  int            *order;               /* locations of the options sorted by name */
+  khash_t(HOPT)  *ht;                  /* maps an option name to its location in names[] */
   char           *aliases1[MAXALIASES],*aliases2[MAXALIASES];
-  PetscBool      used[MAXOPTIONS];
+  PetscBool      *used;
   PetscBool      namegiven;
   char           programname[PETSC_MAX_PATH_LEN]; /* HP includes entire path in name */
 
@@ -66,6 +96,68 @@ extern PetscOptionsObjectType PetscOptionsObject;
           } \
         }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscOptionsLocate_Private"
+/*
+   PetscOptionsLocate_Private - Finds an option (given without the leading -) in the table,
+   loc is set to -1 if the option has not been set
+*/
+static PetscErrorCode PetscOptionsLocate_Private(const char name[],PetscInt *loc)
+{
+  khiter_t k;
+
+  PetscFunctionBegin;
+  k    = kh_get(HOPT,options->ht,name);
+  *loc = (k == kh_end(options->ht)) ? -1 : kh_val(options->ht,k);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscOptionsLowerBound_Private"
+/*
+   PetscOptionsLowerBound_Private - Returns the first position in order[] whose option name is not
+   less than the first len characters of name, all options starting with name follow it directly
+*/
+static PetscErrorCode PetscOptionsLowerBound_Private(const char name[],size_t len,PetscInt *pos)
+{
+  PetscInt lo = 0,hi = options->N,mid;
+
+  PetscFunctionBegin;
+  while (lo < hi) {
+    mid = (lo + hi)/2;
+    if (PetscOptionsCompare_Private(options->names[options->order[mid]],name,len) < 0) lo = mid + 1;
+    else hi = mid;
+  }
+  *pos = lo;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscOptionsGrow_Private"
+/*
+   PetscOptionsGrow_Private - Doubles the space available for options in the table
+*/
+static PetscErrorCode PetscOptionsGrow_Private(void)
+{
+  int       Nmax = options->Nmax ? 2*options->Nmax : 128;
+  char      **names,**values;
+  int       *order;
+  PetscBool *used;
+
+  PetscFunctionBegin;
+  names  = (char**)realloc(options->names,Nmax*sizeof(char*));
+  if (names) options->names = names;
+  values = (char**)realloc(options->values,Nmax*sizeof(char*));
+  if (values) options->values = values;
+  used   = (PetscBool*)realloc(options->used,Nmax*sizeof(PetscBool));
+  if (used) options->used = used;
+  order  = (int*)realloc(options->order,Nmax*sizeof(int));
+  if (order) options->order = order;
+  if (!names || !values || !used || !order) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_MEM,"Unable to allocate space for %d options",Nmax);
+  options->Nmax = Nmax;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscOptionsStringToInt"
 /*
@@ -684,7 +776,7 @@ PetscErrorCode  PetscOptionsInsert(int *argc,char ***args,const char file[])
 PetscErrorCode  PetscOptionsView(PetscViewer viewer)
 {
   PetscErrorCode ierr;
-  PetscInt       i;
+  PetscInt       i,loc;
   PetscBool      isascii;
 
   PetscFunctionBegin;
@@ -699,10 +791,11 @@ PetscErrorCode  PetscOptionsView(PetscViewer viewer)
     ierr = PetscViewerASCIIPrintf(viewer,"#No PETSc Option Table entries\n");CHKERRQ(ierr);
   }
   for (i=0; i<options->N; i++) {
-    if (options->values[i]) {
-      ierr = PetscViewerASCIIPrintf(viewer,"-%s %s\n",options->names[i],options->values[i]);CHKERRQ(ierr);
+    loc = options->order[i];
+    if (options->values[loc]) {
+      ierr = PetscViewerASCIIPrintf(viewer,"-%s %s\n",options->names[loc],options->values[loc]);CHKERRQ(ierr);
     } else {
-      ierr = PetscViewerASCIIPrintf(viewer,"-%s\n",options->names[i]);CHKERRQ(ierr);
+      ierr = PetscViewerASCIIPrintf(viewer,"-%s\n",options->names[loc]);CHKERRQ(ierr);
     }
   }
   if (options->N) {
@@ -732,7 +825,7 @@ PetscErrorCode  PetscOptionsView(PetscViewer viewer)
 PetscErrorCode  PetscOptionsGetAll(char *copts[])
 {
   PetscErrorCode ierr;
-  PetscInt       i;
+  PetscInt       i,loc;
   size_t         len = 1,lent = 0;
   char           *coptions = PETSC_NULL;
 
@@ -751,11 +844,12 @@ PetscErrorCode  PetscOptionsGetAll(char *copts[])
   ierr = PetscMalloc(len*sizeof(char),&coptions);CHKERRQ(ierr);
   coptions[0] = 0;
   for (i=0; i<options->N; i++) {
+    loc  = options->order[i];
     ierr = PetscStrcat(coptions,"-");CHKERRQ(ierr);
-    ierr = PetscStrcat(coptions,options->names[i]);CHKERRQ(ierr);
+    ierr = PetscStrcat(coptions,options->names[loc]);CHKERRQ(ierr);
     ierr = PetscStrcat(coptions," ");CHKERRQ(ierr);
-    if (options->values[i]) {
-      ierr = PetscStrcat(coptions,options->values[i]);CHKERRQ(ierr);
+    if (options->values[loc]) {
+      ierr = PetscStrcat(coptions,options->values[loc]);CHKERRQ(ierr);
       ierr = PetscStrcat(coptions," ");CHKERRQ(ierr);
     }
   }
@@ -861,6 +955,7 @@ PetscErrorCode  PetscOptionsClear(void)
     free(options->aliases1[i]);
     free(options->aliases2[i]);
   }
+  kh_clear(HOPT,options->ht);
   options->prefix[0] = 0;
   options->prefixind = 0;
   options->N        = 0;
@@ -888,6 +983,11 @@ PetscErrorCode  PetscOptionsDestroy(void)
   PetscFunctionBegin;
   if (!options) PetscFunctionReturn(0);
   ierr = PetscOptionsClear();CHKERRQ(ierr);
+  kh_destroy(HOPT,options->ht);
+  free(options->names);
+  free(options->values);
+  free(options->used);
+  free(options->order);
   free(options);
   options = 0;
   PetscFunctionReturn(0);
@@ -920,11 +1020,12 @@ PetscErrorCode  PetscOptionsSetValue(const char iname[],const char value[])
 {
   size_t         len;
   PetscErrorCode ierr;
-  PetscInt       N,n,i;
-  char           **names;
+  PetscInt       N,n,i,loc;
   char           fullname[2048];
   const char     *name = iname;
-  PetscBool      gt,match;
+  PetscBool      match;
+  khiter_t       k;
+  khint_t        ret;
 
   PetscFunctionBegin;
   if (!options) {ierr = PetscOptionsInsert(0,0,0);CHKERRQ(ierr);}
@@ -950,46 +1051,36 @@ PetscErrorCode  PetscOptionsSetValue(const char iname[],const char value[])
     }
   }
 
-  N     = options->N;
-  n     = N;
-  names = options->names;
-
-  for (i=0; i<N; i++) {
-    ierr = PetscStrcasecmp(names[i],name,&match);CHKERRQ(ierr);
-    ierr  = PetscStrgrt(names[i],name,&gt);CHKERRQ(ierr);
-    if (match) {
-      if (options->values[i]) free(options->values[i]);
-      ierr = PetscStrlen(value,&len);CHKERRQ(ierr);
-      if (len) {
-        options->values[i] = (char*)malloc((len+1)*sizeof(char));
-        ierr = PetscStrcpy(options->values[i],value);CHKERRQ(ierr);
-      } else { options->values[i] = 0;}
-      PetscOptionsMonitor(name,value);
-      PetscFunctionReturn(0);
-    } else if (gt) {
-      n = i;
-      break;
-    }
-  }
-  if (N >= MAXOPTIONS) {
-    SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_PLIB,"No more room in option table, limit %d recompile \n src/sys/objects/options.c with larger value for MAXOPTIONS\n",MAXOPTIONS);
-  }
-  /* shift remaining values down 1 */
-  for (i=N; i>n; i--) {
-    options->names[i]  = options->names[i-1];
-    options->values[i] = options->values[i-1];
-    options->used[i]   = options->used[i-1];
+  ierr = PetscOptionsLocate_Private(name,&loc);CHKERRQ(ierr);
+  if (loc >= 0) {
+    if (options->values[loc]) free(options->values[loc]);
+    ierr = PetscStrlen(value,&len);CHKERRQ(ierr);
+    if (len) {
+      options->values[loc] = (char*)malloc((len+1)*sizeof(char));
+      ierr = PetscStrcpy(options->values[loc],value);CHKERRQ(ierr);
+    } else { options->values[loc] = 0;}
+    PetscOptionsMonitor(name,value);
+    PetscFunctionReturn(0);
   }
-  /* insert new name and value */
+
+  N = options->N;
+  if (N >= options->Nmax) {ierr = PetscOptionsGrow_Private();CHKERRQ(ierr);}
+  /* insert new name and value at the end of the table */
   ierr = PetscStrlen(name,&len);CHKERRQ(ierr);
-  options->names[n] = (char*)malloc((len+1)*sizeof(char));
-  ierr = PetscStrcpy(options->names[n],name);CHKERRQ(ierr);
+  options->names[N] = (char*)malloc((len+1)*sizeof(char));
+  ierr = PetscStrcpy(options->names[N],name);CHKERRQ(ierr);
   ierr = PetscStrlen(value,&len);CHKERRQ(ierr);
   if (len) {
-    options->values[n] = (char*)malloc((len+1)*sizeof(char));
-    ierr = PetscStrcpy(options->values[n],value);CHKERRQ(ierr);
-  } else {options->values[n] = 0;}
-  options->used[n] = PETSC_FALSE;
+    options->values[N] = (char*)malloc((len+1)*sizeof(char));
+    ierr = PetscStrcpy(options->values[N],value);CHKERRQ(ierr);
+  } else {options->values[N] = 0;}
+  options->used[N] = PETSC_FALSE;
+  k = kh_put(HOPT,options->ht,options->names[N],&ret);
+  kh_val(options->ht,k) = N;
+  /* keep order[] sorted by name */
+  ierr = PetscOptionsLowerBound_Private(name,(size_t)-1,&n);CHKERRQ(ierr);
+  for (i=N; i>n; i--) options->order[i] = options->order[i-1];
+  options->order[n] = N;
   options->N++;
   PetscOptionsMonitor(name,value);
   PetscFunctionReturn(0);
@@ -1015,9 +1106,8 @@ PetscErrorCode  PetscOptionsSetValue(const char iname[],const char value[])
 PetscErrorCode  PetscOptionsClearValue(const char iname[])
 {
   PetscErrorCode ierr;
-  PetscInt       N,n,i;
-  char           **names,*name=(char*)iname;
-  PetscBool      gt,match;
+  PetscInt       N,n,i,loc,last;
+  char           *name=(char*)iname;
 
   PetscFunctionBegin;
   if (name[0] != '-') SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Name must begin with -: Instead %s",name);
@@ -1025,29 +1115,28 @@ PetscErrorCode  PetscOptionsClearValue(const char iname[])
 
   name++;
 
-  N     = options->N; n = 0;
-  names = options->names;
-
-  for (i=0; i<N; i++) {
-    ierr  = PetscStrcasecmp(names[i],name,&match);CHKERRQ(ierr);
-    ierr  = PetscStrgrt(names[i],name,&gt);CHKERRQ(ierr);
-    if (match) {
-      if (options->names[i])  free(options->names[i]);
-      if (options->values[i]) free(options->values[i]);
-      PetscOptionsMonitor(name,"");
-      break;
-    } else if (gt) {
-      PetscFunctionReturn(0); /* it was not listed */
+  ierr = PetscOptionsLocate_Private(name,&loc);CHKERRQ(ierr);
+  if (loc < 0) PetscFunctionReturn(0); /* it was not listed */
+  PetscOptionsMonitor(name,"");
+
+  /* remove it from order[] and the hash table */
+  N    = options->N;
+  ierr = PetscOptionsLowerBound_Private(name,(size_t)-1,&n);CHKERRQ(ierr);
+  for (i=n; i<N-1; i++) options->order[i] = options->order[i+1];
+  kh_del(HOPT,options->ht,kh_get(HOPT,options->ht,name));
+  free(options->names[loc]);
+  if (options->values[loc]) free(options->values[loc]);
+
+  /* move the last option into the hole */
+  last = N-1;
+  if (loc != last) {
+    options->names[loc]  = options->names[last];
+    options->values[loc] = options->values[last];
+    options->used[loc]   = options->used[last];
+    kh_val(options->ht,kh_get(HOPT,options->ht,options->names[loc])) = loc;
+    for (i=0; i<N-1; i++) {
+      if (options->order[i] == last) {options->order[i] = loc; break;}
     }
-    n++;
-  }
-  if (n == N) PetscFunctionReturn(0); /* it was not listed */
-
-  /* shift remaining values down 1 */
-  for (i=n; i<N-1; i++) {
-    options->names[i]  = options->names[i+1];
-    options->values[i] = options->values[i+1];
-    options->used[i]   = options->used[i+1];
   }
   options->N--;
   PetscFunctionReturn(0);
@@ -1104,15 +1193,12 @@ PetscErrorCode  PetscOptionsSetAlias(const char inewname[],const char ioldname[]
 PetscErrorCode PetscOptionsFindPair_Private(const char pre[],const char name[],char *value[],PetscBool  *flg)
 {
   PetscErrorCode ierr;
-  PetscInt       i,N;
+  PetscInt       i,loc;
   size_t         len;
-  char           **names,tmp[256];
-  PetscBool      match;
+  char           tmp[256];
 
   PetscFunctionBegin;
   if (!options) {ierr = PetscOptionsInsert(0,0,0);CHKERRQ(ierr);}
-  N = options->N;
-  names = options->names;
 
   if (name[0] != '-') SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Name must begin with -: Instead %s",name);
 
@@ -1143,16 +1229,12 @@ PetscErrorCode PetscOptionsFindPair_Private(const char pre[],const char name[],c
   }
 #endif
 
-  /* slow search */
   *flg = PETSC_FALSE;
-  for (i=0; i<N; i++) {
-    ierr = PetscStrcasecmp(names[i],tmp,&match);CHKERRQ(ierr);
-    if (match) {
-       *value           = options->values[i];
-       options->used[i] = PETSC_TRUE;
-       *flg             = PETSC_TRUE;
-       break;
-     }
+  ierr = PetscOptionsLocate_Private(tmp,&loc);CHKERRQ(ierr);
+  if (loc >= 0) {
+    *value             = options->values[loc];
+    options->used[loc] = PETSC_TRUE;
+    *flg               = PETSC_TRUE;
   }
   if (!*flg) {
     PetscInt j,cnt = 0,locs[16],loce[16];
@@ -1163,7 +1245,7 @@ PetscErrorCode PetscOptionsFindPair_Private(const char pre[],const char name[],c
       if (tmp[i] == '_') {
         for (j=i+1; j< (PetscInt)n; j++) {
           if (tmp[j] >= '0' && tmp[j] <= '9') continue;
-          if (tmp[j] == '_' && j > i+1) { /* found a number */
+          if (tmp[j] == '_' && j > i+1 && cnt < 16) { /* found a number */
             locs[cnt]   = i+1;
             loce[cnt++] = j+1;
           }
@@ -1190,15 +1272,12 @@ PetscErrorCode PetscOptionsFindPair_Private(const char pre[],const char name[],c
 PetscErrorCode PetscOptionsFindPairPrefix_Private(const char pre[], const char name[], char *value[], PetscBool *flg)
 {
   PetscErrorCode ierr;
-  PetscInt       i,N;
+  PetscInt       n,loc;
   size_t         len;
-  char           **names,tmp[256];
-  PetscBool      match;
+  char           tmp[256];
 
   PetscFunctionBegin;
   if (!options) {ierr = PetscOptionsInsert(0,0,0);CHKERRQ(ierr);}
-  N = options->N;
-  names = options->names;
 
   if (name[0] != '-') SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONG,"Name must begin with -: Instead %s",name);
 
@@ -1229,17 +1308,15 @@ PetscErrorCode PetscOptionsFindPairPrefix_Private(const char pre[], const char n
   }
 #endif
 
-  /* slow search */
-  *flg = PETSC_FALSE;
+  /* the options starting with tmp are contiguous in order[], the first one is at the lower bound */
+  if (flg) *flg = PETSC_FALSE;
   ierr = PetscStrlen(tmp,&len);CHKERRQ(ierr);
-  for (i = 0; i < N; ++i) {
-    ierr = PetscStrncmp(names[i], tmp, len, &match);CHKERRQ(ierr);
-    if (match) {
-      if (value) *value = options->values[i];
-      options->used[i]  = PETSC_TRUE;
-      if (flg)   *flg   = PETSC_TRUE;
-      break;
-    }
+  ierr = PetscOptionsLowerBound_Private(tmp,len,&n);CHKERRQ(ierr);
+  if (n < options->N && !PetscOptionsCompare_Private(options->names[options->order[n]],tmp,len)) {
+    loc = options->order[n];
+    if (value) *value    = options->values[loc];
+    options->used[loc]   = PETSC_TRUE;
+    if (flg)   *flg      = PETSC_TRUE;
   }
   PetscFunctionReturn(0);
 }
@@ -2069,18 +2146,12 @@ PetscErrorCode  PetscOptionsGetStringArray(const char pre[],const char name[],ch
 @*/
 PetscErrorCode  PetscOptionsUsed(const char *option,PetscBool *used)
 {
-  PetscInt       i;
+  PetscInt       loc;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
-  *used = PETSC_FALSE;
-  for (i=0; i<options->N; i++) {
-    ierr = PetscStrcmp(options->names[i],option,used);CHKERRQ(ierr);
-    if (*used) {
-      *used = options->used[i];
-      break;
-    }
-  }
+  ierr  = PetscOptionsLocate_Private(option,&loc);CHKERRQ(ierr);
+  *used = (loc >= 0) ? options->used[loc] : PETSC_FALSE;
   PetscFunctionReturn(0);
 }
 
@@ -2128,15 +2199,16 @@ PetscErrorCode  PetscOptionsAllUsed(PetscInt *N)
 PetscErrorCode  PetscOptionsLeft(void)
 {
   PetscErrorCode ierr;
-  PetscInt       i;
+  PetscInt       i,loc;
 
   PetscFunctionBegin;
   for (i=0; i<options->N; i++) {
-    if (!options->used[i]) {
-      if (options->values[i]) {
-        ierr = PetscPrintf(PETSC_COMM_WORLD,"Option left: name:-%s value: %s\n",options->names[i],options->values[i]);CHKERRQ(ierr);
+    loc = options->order[i];
+    if (!options->used[loc]) {
+      if (options->values[loc]) {
+        ierr = PetscPrintf(PETSC_COMM_WORLD,"Option left: name:-%s value: %s\n",options->names[loc],options->values[loc]);CHKERRQ(ierr);
       } else {
-        ierr = PetscPrintf(PETSC_COMM_WORLD,"Option left: name:-%s no value \n",options->names[i]);CHKERRQ(ierr);
+        ierr = PetscPrintf(PETSC_COMM_WORLD,"Option left: name:-%s no value \n",options->names[loc]);CHKERRQ(ierr);
       }
     }
   }
@@ -2161,6 +2233,8 @@ PetscErrorCode  PetscOptionsCreate(void)
   options->N                    = 0;
   options->Naliases             = 0;
   options->numbermonitors       = 0;
+  options->ht                   = kh_init(HOPT);
+  ierr = PetscOptionsGrow_Private();CHKERRQ(ierr);
 
   PetscOptionsObject.prefix = PETSC_NULL;
   PetscOptionsObject.title  = PETSC_NULL;
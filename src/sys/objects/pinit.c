@@ -597,6 +597,7 @@ PetscErrorCode  PetscFreeArguments(char **args)
 .  -malloc no - Indicates not to use error-checking malloc
 .  -malloc_debug - check for memory corruption at EVERY malloc or free
 .  -malloc_test - like -malloc_dump -malloc_debug, but only active for debugging builds
+.  -malloc_pool - serve small PetscMalloc() requests from thread-local pools of fixed size blocks, see PetscMallocPool()
 .  -fp_trap - Stops on floating point exceptions (Note that on the
               IBM RS6000 this slows code by at least a factor of 10.)
 .  -no_signal_handler - Indicates not to trap error signals
@@ -612,6 +613,7 @@ PetscErrorCode  PetscFreeArguments(char **args)
 +  -log_trace [filename] - Print traces of all PETSc calls
         to the screen (useful to determine where a program
         hangs without running in the debugger).  See PetscLogTraceBegin().
+.  -log_timeline [filename] - Records the nested events of all threads, see PetscLogTimelineBegin()
 .  -info <optional filename> - Prints verbose information to the screen
 -  -info_exclude <null,vec,mat,pc,ksp,snes,ts> - Excludes some of the verbose messages
 
@@ -878,6 +880,8 @@ PetscErrorCode  PetscInitialize(int *argc,char ***args,const char file[],const c
 
 extern PetscObject *PetscObjects;
 extern PetscInt    PetscObjectsCounts, PetscObjectsMaxCounts;
+extern PetscBool   PetscMallocPoolActive;
+extern PetscErrorCode PetscMallocPoolDestroy_Private(void);
 
 #undef __FUNCT__
 #define __FUNCT__ "PetscFinalize"
@@ -907,6 +911,8 @@ extern PetscInt    PetscObjectsCounts, PetscObjectsMaxCounts;
 .  -log_all [filename] - Logs extensive profiling information
         See PetscLogDump().
 .  -log [filename] - Logs basic profiline information  See PetscLogDump().
+.  -log_timeline [filename] - Writes the nested events of all threads in the Chrome trace format
+        to petsc_timeline.json or the given file. See PetscLogTimelineDump().
 .  -log_sync - Log the synchronization in scatters, inner products
         and norms
 -  -log_mpe [filename] - Creates a logfile viewable by the
@@ -984,6 +990,13 @@ PetscErrorCode  PetscFinalize(void)
     else          {ierr = PetscLogMPEDump(0);CHKERRQ(ierr);}
   }
 #endif
+  mname[0] = 0;
+  ierr = PetscOptionsGetString(PETSC_NULL,"-log_timeline",mname,PETSC_MAX_PATH_LEN,&flg1);CHKERRQ(ierr);
+  if (flg1) {
+    if (mname[0]) {ierr = PetscLogTimelineDump(mname);CHKERRQ(ierr);}
+    else          {ierr = PetscLogTimelineDump(0);CHKERRQ(ierr);}
+  }
+
   mname[0] = 0;
   ierr = PetscOptionsGetString(PETSC_NULL,"-log_summary",mname,PETSC_MAX_PATH_LEN,&flg1);CHKERRQ(ierr);
   if (flg1) {
@@ -1299,6 +1312,7 @@ PetscErrorCode  PetscFinalize(void)
    memory was not freed.
 
 */
+  if (PetscMallocPoolActive) {ierr = PetscMallocPoolDestroy_Private();CHKERRQ(ierr);}
   ierr = PetscMallocClear();CHKERRQ(ierr);
   PetscInitializeCalled = PETSC_FALSE;
   PetscFinalizeCalled   = PETSC_TRUE;
@@ -0,0 +1,197 @@
+static char help[] = "Benchmarks static and work-stealing schedules for a sparse matrix-vector product with skewed row lengths.\n\n\
+  -n <rows>       number of rows\n\
+  -maxnz <nz>     length of the longest row\n\
+  -skew <p>       row i has about 1+maxnz*(i/n)^p nonzeros, larger p concentrates the work in the last rows\n\
+  -grain <g>      grain size for the range kernel\n\
+  -its <its>      number of products timed\n\
+  -nblocks <nb>   number of blocks of rows for the nested range kernels\n\
+  -timing <bool>  print the timings\n\n";
+
+/*T
+   Concepts: PetscThreadComm^load balancing of irregular kernels
+   Processors: 1
+T*/
+
+/*
+  Run with, for example,
+     ./ex6 -threadcomm_type pthread -threadcomm_nthreads 4
+     ./ex6 -threadcomm_type worksteal -threadcomm_nthreads 4
+  With the pthread type PetscThreadCommRunRangeKernel() uses the same static schedule as
+  PetscThreadCommRunKernel(), with worksteal idle threads take rows from busy ones.
+*/
+#include <petscthreadcomm.h>
+
+typedef struct {
+  PetscInt    *ai,*aj;
+  PetscScalar *aa,*x,*y;
+  PetscInt    *trstarts;
+  PetscInt    badrow;   /* row at which SpMV_badrangekernel() fails */
+} SpMVCtx;
+
+/* The rows split into nblocks blocks, the product of each block is computed by a nested range kernel */
+typedef struct {
+  SpMVCtx         *spmv;
+  PetscThreadComm tcomm;
+  PetscInt        nblocks,n;
+} BlockCtx;
+
+static PetscErrorCode SpMVRows(PetscInt start,PetscInt end,SpMVCtx *ctx)
+{
+  PetscInt    i,j;
+  PetscScalar sum;
+
+  for (i=start; i<end; i++) {
+    sum = 0.0;
+    for (j=ctx->ai[i]; j<ctx->ai[i+1]; j++) sum += ctx->aa[j]*ctx->x[ctx->aj[j]];
+    ctx->y[i] = sum;
+  }
+  return 0;
+}
+
+/* Static schedule: one contiguous block of rows per thread */
+static PetscErrorCode SpMV_kernel(PetscInt trank,SpMVCtx *ctx)
+{
+  return SpMVRows(ctx->trstarts[trank],ctx->trstarts[trank+1],ctx);
+}
+
+static PetscErrorCode SpMV_rangekernel(PetscInt trank,PetscInt start,PetscInt end,SpMVCtx *ctx)
+{
+  return SpMVRows(start,end,ctx);
+}
+
+/* Fails on the range containing ctx->badrow, without touching the error handler from a thread */
+static PetscErrorCode SpMV_badrangekernel(PetscInt trank,PetscInt start,PetscInt end,SpMVCtx *ctx)
+{
+  if (start <= ctx->badrow && ctx->badrow < end) return PETSC_ERR_ARG_OUTOFRANGE;
+  return SpMVRows(start,end,ctx);
+}
+
+typedef struct {
+  SpMVCtx  *spmv;
+  PetscInt rstart;
+} NestedCtx;
+
+static PetscErrorCode SpMV_nestedrangekernel(PetscInt trank,PetscInt start,PetscInt end,NestedCtx *ctx)
+{
+  return SpMVRows(ctx->rstart+start,ctx->rstart+end,ctx->spmv);
+}
+
+/* Each block submits the rows it owns as a nested range kernel */
+static PetscErrorCode SpMV_blockrangekernel(PetscInt trank,PetscInt start,PetscInt end,BlockCtx *ctx)
+{
+  PetscErrorCode ierr;
+  PetscInt       b,rend;
+  NestedCtx      nctx;
+
+  nctx.spmv = ctx->spmv;
+  for (b=start; b<end; b++) {
+    nctx.rstart = b*ctx->n/ctx->nblocks;
+    rend        = (b+1)*ctx->n/ctx->nblocks;
+    ierr = PetscThreadKernelRunRange(trank,ctx->tcomm,(PetscThreadRangeKernel)SpMV_nestedrangekernel,rend-nctx.rstart,PETSC_DECIDE,&nctx);
+    if (ierr) return ierr;
+  }
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr,kerr;
+  PetscInt       n = 100000,maxnz = 2000,grain = PETSC_DECIDE,its = 20,i,j,k,nz;
+  PetscInt       skew = 8,nblocks = 16;
+  PetscReal      err = 0.0;
+  PetscScalar    *ystatic;
+  PetscLogDouble t0,t1,tstatic,trange;
+  PetscBool      timing = PETSC_TRUE;
+  SpMVCtx        ctx;
+  BlockCtx       bctx;
+
+  PetscInitialize(&argc,&argv,(char *)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-maxnz",&maxnz,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-skew",&skew,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-grain",&grain,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-its",&its,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-nblocks",&nblocks,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-timing",&timing,PETSC_NULL);CHKERRQ(ierr);
+  if (timing) {ierr = PetscThreadCommView(PETSC_COMM_WORLD,PETSC_VIEWER_STDOUT_WORLD);CHKERRQ(ierr);}
+  maxnz = PetscMin(maxnz,n);
+
+  /* Build a matrix whose row lengths grow like (i/n)^skew */
+  ierr = PetscMalloc((n+1)*sizeof(PetscInt),&ctx.ai);CHKERRQ(ierr);
+  ctx.ai[0] = 0;
+  for (i=0; i<n; i++) {
+    nz = 1 + (PetscInt)(maxnz*PetscPowRealInt((PetscReal)i/n,skew));
+    ctx.ai[i+1] = ctx.ai[i] + PetscMin(nz,n);
+  }
+  ierr = PetscMalloc(ctx.ai[n]*sizeof(PetscInt),&ctx.aj);CHKERRQ(ierr);
+  ierr = PetscMalloc(ctx.ai[n]*sizeof(PetscScalar),&ctx.aa);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    nz = ctx.ai[i+1] - ctx.ai[i];
+    for (k=0,j=ctx.ai[i]; j<ctx.ai[i+1]; j++,k++) {
+      ctx.aj[j] = (i + k*(n/nz)) % n;
+      ctx.aa[j] = 1.0/(1.0 + k);
+    }
+  }
+  ierr = PetscMalloc3(n,PetscScalar,&ctx.x,n,PetscScalar,&ctx.y,n,PetscScalar,&ystatic);CHKERRQ(ierr);
+  for (i=0; i<n; i++) ctx.x[i] = 1.0 + (PetscReal)(i%7);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Rows %D, nonzeros %D, shortest row %D, longest row %D\n",n,ctx.ai[n],ctx.ai[1]-ctx.ai[0],ctx.ai[n]-ctx.ai[n-1]);CHKERRQ(ierr);
+
+  /* Static schedule, rows split evenly among the threads */
+  ierr = PetscThreadCommGetOwnershipRanges(PETSC_COMM_WORLD,n,&ctx.trstarts);CHKERRQ(ierr);
+  ierr = PetscThreadCommRunKernel1(PETSC_COMM_WORLD,(PetscThreadKernel)SpMV_kernel,&ctx);CHKERRQ(ierr);
+  ierr = PetscThreadCommBarrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+  ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+  for (i=0; i<its; i++) {
+    ierr = PetscThreadCommRunKernel1(PETSC_COMM_WORLD,(PetscThreadKernel)SpMV_kernel,&ctx);CHKERRQ(ierr);
+    ierr = PetscThreadCommBarrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+  }
+  ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+  tstatic = (t1-t0)/its;
+  ierr = PetscMemcpy(ystatic,ctx.y,n*sizeof(PetscScalar));CHKERRQ(ierr);
+
+  /* Range kernel, dynamically load balanced with the worksteal type */
+  ierr = PetscThreadCommRunRangeKernel(PETSC_COMM_WORLD,(PetscThreadRangeKernel)SpMV_rangekernel,n,grain,&ctx);CHKERRQ(ierr);
+  ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+  for (i=0; i<its; i++) {
+    ierr = PetscThreadCommRunRangeKernel(PETSC_COMM_WORLD,(PetscThreadRangeKernel)SpMV_rangekernel,n,grain,&ctx);CHKERRQ(ierr);
+  }
+  ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+  trange = (t1-t0)/its;
+
+  for (i=0; i<n; i++) err = PetscMax(err,PetscAbsScalar(ctx.y[i]-ystatic[i]));
+  if (err > 0.0) {ierr = PetscPrintf(PETSC_COMM_WORLD,"Results differ, max error %G\n",err);CHKERRQ(ierr);}
+  if (timing) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Static schedule: %G ms per product, %G Mflop/s\n",1.e3*tstatic,2.e-6*ctx.ai[n]/tstatic);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Range kernel:    %G ms per product, %G Mflop/s, speedup %G\n",1.e3*trange,2.e-6*ctx.ai[n]/trange,tstatic/trange);CHKERRQ(ierr);
+  }
+
+  /* Blocks of rows, each one submitting its rows as a nested range kernel */
+  bctx.spmv    = &ctx;
+  bctx.nblocks = PetscMin(nblocks,n);
+  bctx.n       = n;
+  ierr = PetscCommGetThreadComm(PETSC_COMM_WORLD,&bctx.tcomm);CHKERRQ(ierr);
+  ierr = PetscMemzero(ctx.y,n*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscThreadCommRunRangeKernel(PETSC_COMM_WORLD,(PetscThreadRangeKernel)SpMV_blockrangekernel,bctx.nblocks,1,&bctx);CHKERRQ(ierr);
+  err  = 0.0;
+  for (i=0; i<n; i++) err = PetscMax(err,PetscAbsScalar(ctx.y[i]-ystatic[i]));
+  if (err > 0.0) {ierr = PetscPrintf(PETSC_COMM_WORLD,"Results of the nested range kernels differ, max error %G\n",err);CHKERRQ(ierr);}
+  else {ierr = PetscPrintf(PETSC_COMM_WORLD,"Nested range kernels over %D blocks agree with the static schedule\n",bctx.nblocks);CHKERRQ(ierr);}
+
+  /* The error returned by a kernel for one of the ranges is returned by PetscThreadCommRunRangeKernel() */
+  ctx.badrow = n/2;
+  ierr = PetscPushErrorHandler(PetscReturnErrorHandler,PETSC_NULL);CHKERRQ(ierr);
+  kerr = PetscThreadCommRunRangeKernel(PETSC_COMM_WORLD,(PetscThreadRangeKernel)SpMV_badrangekernel,n,grain,&ctx);
+  ierr = PetscPopErrorHandler();CHKERRQ(ierr);
+  if (kerr != PETSC_ERR_ARG_OUTOFRANGE) {ierr = PetscPrintf(PETSC_COMM_WORLD,"The error of the range kernel was lost\n");CHKERRQ(ierr);}
+  else {ierr = PetscPrintf(PETSC_COMM_WORLD,"The error of the range kernel was returned\n");CHKERRQ(ierr);}
+
+  ierr = PetscFree(ctx.trstarts);CHKERRQ(ierr);
+  ierr = PetscFree3(ctx.x,ctx.y,ystatic);CHKERRQ(ierr);
+  ierr = PetscFree(ctx.aa);CHKERRQ(ierr);
+  ierr = PetscFree(ctx.aj);CHKERRQ(ierr);
+  ierr = PetscFree(ctx.ai);CHKERRQ(ierr);
+  PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,416 @@
+/* Define feature test macros to make sure CPU_SET and other functions are available
+ */
+#define PETSC_DESIRE_FEATURE_TEST_MACROS
+
+#include <../src/sys/threadcomm/impls/worksteal/tcworkstealimpl.h>
+
+#define WS_THREAD_CREATED     0
+#define WS_THREAD_INITIALIZED 1
+#define WS_THREAD_TERMINATE   2
+
+#if defined(PETSC_PTHREAD_LOCAL)
+static PETSC_PTHREAD_LOCAL PetscInt PetscWorkStealRank;
+#else
+static pthread_key_t PetscWorkStealRankkey;
+#endif
+
+/* The thread pool, shared by all the thread communicators of this type */
+static PetscThreadComm_WorkSteal PetscWorkStealPool = PETSC_NULL;
+static PetscInt                  wscommcrtct        = 0;
+/* Number of tasks each thread is currently executing (nesting depth), only accessed by the owning thread */
+static PetscInt                  *PetscWorkStealDepth = PETSC_NULL;
+
+PETSC_STATIC_INLINE PetscInt PetscWorkStealGetRank_Private(void)
+{
+#if defined(PETSC_PTHREAD_LOCAL)
+  return PetscWorkStealRank;
+#else
+  return *((PetscInt*)pthread_getspecific(PetscWorkStealRankkey));
+#endif
+}
+
+PetscErrorCode PetscThreadCommGetRank_WorkSteal(PetscInt *trank)
+{
+  *trank = PetscWorkStealGetRank_Private();
+  return 0;
+}
+
+/* Pushes the task [start,end) at the bottom of the deque, returns PETSC_FALSE if the deque is full */
+static PetscBool PetscWorkStealPush_Private(PetscThreadCommDeque_WorkSteal *dq,PetscThreadCommRange_WorkSteal range,PetscInt start,PetscInt end)
+{
+  PetscBool                     pushed = PETSC_FALSE;
+  PetscThreadCommTask_WorkSteal *task;
+
+  pthread_mutex_lock(&dq->lock);
+  if (dq->bottom - dq->top < PETSC_WORKSTEAL_DEQUE_SIZE) {
+    task        = &dq->tasks[dq->bottom%PETSC_WORKSTEAL_DEQUE_SIZE];
+    task->range = range;
+    task->start = start;
+    task->end   = end;
+    dq->bottom++;
+    pushed      = PETSC_TRUE;
+  }
+  pthread_mutex_unlock(&dq->lock);
+  return pushed;
+}
+
+/* Takes the most recently pushed task, used by the owner of the deque */
+static PetscBool PetscWorkStealPop_Private(PetscThreadCommDeque_WorkSteal *dq,PetscThreadCommTask_WorkSteal *task)
+{
+  PetscBool found = PETSC_FALSE;
+
+  if (PetscReadOnce(PetscInt,dq->bottom) == PetscReadOnce(PetscInt,dq->top)) return PETSC_FALSE;
+  pthread_mutex_lock(&dq->lock);
+  if (dq->bottom > dq->top) {
+    dq->bottom--;
+    *task = dq->tasks[dq->bottom%PETSC_WORKSTEAL_DEQUE_SIZE];
+    found = PETSC_TRUE;
+    if (dq->bottom == dq->top) dq->bottom = dq->top = 0;
+  }
+  pthread_mutex_unlock(&dq->lock);
+  return found;
+}
+
+/* Takes the oldest task, used by the thieves */
+static PetscBool PetscWorkStealSteal_Private(PetscThreadCommDeque_WorkSteal *dq,PetscThreadCommTask_WorkSteal *task)
+{
+  PetscBool found = PETSC_FALSE;
+
+  if (PetscReadOnce(PetscInt,dq->bottom) == PetscReadOnce(PetscInt,dq->top)) return PETSC_FALSE;
+  pthread_mutex_lock(&dq->lock);
+  if (dq->bottom > dq->top) {
+    *task = dq->tasks[dq->top%PETSC_WORKSTEAL_DEQUE_SIZE];
+    dq->top++;
+    found = PETSC_TRUE;
+    if (dq->bottom == dq->top) dq->bottom = dq->top = 0;
+  }
+  pthread_mutex_unlock(&dq->lock);
+  return found;
+}
+
+/* Gets a task from the own deque, or steals one from the other threads */
+static PetscBool PetscWorkStealFindTask_Private(PetscInt rank,PetscThreadCommTask_WorkSteal *task)
+{
+  PetscThreadComm_WorkSteal pool = PetscWorkStealPool;
+  PetscInt                  i,victim,nthreads = pool->nthreads+1;
+
+  if (PetscWorkStealPop_Private(&pool->deques[rank],task)) return PETSC_TRUE;
+  for (i=1; i<nthreads; i++) {
+    victim = (rank+i)%nthreads;
+    if (PetscWorkStealSteal_Private(&pool->deques[victim],task)) {
+      pool->nsteals++; /* only informational, races are harmless */
+      return PETSC_TRUE;
+    }
+  }
+  return PETSC_FALSE;
+}
+
+/* Runs a task, exposing the upper half of the range to thieves until it is no larger than the grain size */
+static void PetscWorkStealRunTask_Private(PetscInt rank,PetscThreadCommTask_WorkSteal *task)
+{
+  PetscThreadComm_WorkSteal      pool  = PetscWorkStealPool;
+  PetscThreadCommRange_WorkSteal range = task->range;
+  PetscInt                       start = task->start,end = task->end,mid;
+  PetscErrorCode                 ierr;
+
+  while (end - start > range->grain) {
+    mid = start + (end - start)/2;
+    if (!PetscWorkStealPush_Private(&pool->deques[rank],range,mid,end)) break;
+    end = mid;
+  }
+  PetscWorkStealDepth[rank]++;
+  (void)PetscThreadCommLogKernelBegin();
+  ierr = (*range->func)(rank,start,end,range->ctx);
+  (void)PetscThreadCommLogKernelEnd();
+  PetscWorkStealDepth[rank]--;
+  pthread_mutex_lock(&range->lock);
+  if (ierr && !range->err) range->err = ierr;
+  range->pending -= end - start;
+  pthread_mutex_unlock(&range->lock);
+}
+
+/* Executes tasks (possibly belonging to other ranges) until all the iterations of range have completed */
+static void PetscWorkStealHelp_Private(PetscInt rank,PetscThreadCommRange_WorkSteal range)
+{
+  PetscThreadCommTask_WorkSteal task;
+
+  while (PetscReadOnce(PetscInt,range->pending) > 0) {
+    if (PetscWorkStealFindTask_Private(rank,&task)) PetscWorkStealRunTask_Private(rank,&task);
+    else PetscCPURelax();
+  }
+  /* Acquire the lock once more so that the writes made by the other threads are visible */
+  pthread_mutex_lock(&range->lock);
+  pthread_mutex_unlock(&range->lock);
+}
+
+void* PetscWorkStealFunc(void* arg)
+{
+  PetscThreadComm_WorkSteal     pool = PetscWorkStealPool;
+  PetscInt                      my_job_counter = 0,my_kernel_ctr = 0,glob_kernel_ctr;
+  PetscThreadCommJobCtx         job;
+  PetscThreadCommTask_WorkSteal task;
+  PetscInt                      rank = *(PetscInt*)arg;
+
+#if defined(PETSC_PTHREAD_LOCAL)
+  PetscWorkStealRank = rank;
+#else
+  pthread_setspecific(PetscWorkStealRankkey,arg);
+#endif
+  pool->status[rank] = WS_THREAD_INITIALIZED;
+
+  while (PetscReadOnce(PetscInt,pool->status[rank]) != WS_THREAD_TERMINATE) {
+    glob_kernel_ctr = PetscReadOnce(PetscInt,PetscJobQueue->kernel_ctr);
+    if (my_kernel_ctr < glob_kernel_ctr) {
+      /* Kernels launched with PetscThreadCommRunKernel() are run once by every thread */
+      job = &PetscJobQueue->jobs[my_job_counter];
+      if (rank < job->tcomm->nworkThreads) {
+        job->job_status[rank] = THREAD_JOB_RECIEVED;
+        PetscWorkStealDepth[rank]++;
+        PetscRunKernel(rank,job->nargs,job);
+        PetscWorkStealDepth[rank]--;
+        job->job_status[rank] = THREAD_JOB_COMPLETED;
+      }
+      my_job_counter = (my_job_counter+1)%job->tcomm->nkernels;
+      my_kernel_ctr++;
+    } else if (PetscWorkStealFindTask_Private(rank,&task)) {
+      PetscWorkStealRunTask_Private(rank,&task);
+    } else PetscCPURelax();
+  }
+  return NULL;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscThreadCommBarrier_WorkSteal"
+PetscErrorCode PetscThreadCommBarrier_WorkSteal(PetscThreadComm tcomm)
+{
+  PetscThreadCommJobCtx         job = &PetscJobQueue->jobs[tcomm->job_ctr];
+  PetscThreadCommTask_WorkSteal task;
+  PetscBool                     wait = PETSC_TRUE;
+  PetscInt                      i,status;
+
+  PetscFunctionBegin;
+  if (tcomm->nworkThreads == 1) PetscFunctionReturn(0);
+  /* Loop till all threads signal that they have done their job, meanwhile help with any pending tasks */
+  while (wait) {
+    wait = PETSC_FALSE;
+    for (i=0; i<tcomm->nworkThreads; i++) {
+      status = PetscReadOnce(PetscInt,job->job_status[i]);
+      if (status != THREAD_JOB_COMPLETED && status != THREAD_JOB_NONE) {wait = PETSC_TRUE; break;}
+    }
+    if (wait) {
+      if (PetscWorkStealFindTask_Private(0,&task)) PetscWorkStealRunTask_Private(0,&task);
+      else PetscCPURelax();
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscThreadCommRunKernel_WorkSteal"
+PetscErrorCode PetscThreadCommRunKernel_WorkSteal(MPI_Comm comm,PetscThreadCommJobCtx job)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  /* The main thread is always worker 0 */
+  job->job_status[0] = THREAD_JOB_RECIEVED;
+  PetscWorkStealDepth[0]++;
+  PetscRunKernel(0,job->nargs,job);
+  PetscWorkStealDepth[0]--;
+  job->job_status[0] = THREAD_JOB_COMPLETED;
+  if (PetscWorkStealPool->synchronizeafter) {
+    ierr = PetscThreadCommBarrier(comm);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/* May be called from inside kernels, so no PetscFunctionBegin/PetscFunctionReturn */
+PetscErrorCode PetscThreadCommRunRangeKernel_WorkSteal(PetscThreadComm tcomm,PetscInt trank,PetscThreadRangeKernel func,PetscInt N,PetscInt grain,void *ctx)
+{
+  PetscThreadComm_WorkSteal                pool = PetscWorkStealPool;
+  struct _p_PetscThreadCommRange_WorkSteal range;
+  PetscThreadCommTask_WorkSteal            task;
+  PetscInt                                 nthreads = tcomm->nworkThreads;
+  PetscInt                                 i,Q,R,start,end;
+
+  if (N <= 0) return 0;
+  if (grain == PETSC_DECIDE || grain == PETSC_DEFAULT) grain = pool->grain;
+  if (grain == PETSC_DECIDE) grain = N/(8*nthreads);
+  range.func    = func;
+  range.ctx     = ctx;
+  range.grain   = PetscMax(1,grain);
+  range.pending = N;
+  range.err     = 0;
+  pthread_mutex_init(&range.lock,PETSC_NULL);
+  task.range    = &range;
+
+  if (!PetscWorkStealDepth[trank]) {
+    /* Called from outside a kernel: start every thread on the contiguous block the static
+       schedule would have given it, idle threads then steal from the busy ones */
+    Q = N/nthreads; R = N - Q*nthreads;
+    for (i=nthreads-1; i>=0; i--) {
+      start = i*Q + PetscMin(i,R);
+      end   = start + Q + (i < R ? 1 : 0);
+      if (start == end) continue;
+      if (!PetscWorkStealPush_Private(&pool->deques[i],&range,start,end)) {
+        task.start = start; task.end = end;
+        PetscWorkStealRunTask_Private(trank,&task);
+      }
+    }
+  } else {
+    /* Nested submission from inside a kernel or task: the range goes on the calling thread's deque */
+    if (!PetscWorkStealPush_Private(&pool->deques[trank],&range,0,N)) {
+      task.start = 0; task.end = N;
+      PetscWorkStealRunTask_Private(trank,&task);
+    }
+  }
+  /* Returns with the lock taken and released, so range.err is the final one */
+  PetscWorkStealHelp_Private(trank,&range);
+  pthread_mutex_destroy(&range.lock);
+  return range.err;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscThreadCommView_WorkSteal"
+PetscErrorCode PetscThreadCommView_WorkSteal(PetscThreadComm tcomm,PetscViewer viewer)
+{
+  PetscErrorCode            ierr;
+  PetscThreadComm_WorkSteal pool = (PetscThreadComm_WorkSteal)tcomm->data;
+
+  PetscFunctionBegin;
+  if (pool->grain == PETSC_DECIDE) {
+    ierr = PetscViewerASCIIPrintf(viewer,"Work-stealing pool: grain size chosen per range kernel\n");CHKERRQ(ierr);
+  } else {
+    ierr = PetscViewerASCIIPrintf(viewer,"Work-stealing pool: grain size %D\n",pool->grain);CHKERRQ(ierr);
+  }
+  ierr = PetscViewerASCIIPrintf(viewer,"Number of successful steals = %D\n",pool->nsteals);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscThreadCommDestroy_WorkSteal"
+PetscErrorCode PetscThreadCommDestroy_WorkSteal(PetscThreadComm tcomm)
+{
+  PetscThreadComm_WorkSteal pool = (PetscThreadComm_WorkSteal)tcomm->data;
+  PetscErrorCode            ierr;
+  PetscInt                  i;
+  void                      *jstatus;
+
+  PetscFunctionBegin;
+  if (!pool) PetscFunctionReturn(0);
+  wscommcrtct--;
+  if (wscommcrtct) PetscFunctionReturn(0);
+  /* Terminate the thread pool */
+  ierr = PetscThreadCommBarrier_WorkSteal(tcomm);CHKERRQ(ierr);
+  for (i=1; i<=pool->nthreads; i++) {
+    pool->status[i] = WS_THREAD_TERMINATE;
+    ierr = pthread_join(pool->tid[i],&jstatus);CHKERRQ(ierr);
+  }
+  for (i=0; i<=pool->nthreads; i++) {
+    ierr = pthread_mutex_destroy(&pool->deques[i].lock);CHKERRQ(ierr);
+  }
+#if !defined(PETSC_PTHREAD_LOCAL)
+  ierr = pthread_key_delete(PetscWorkStealRankkey);CHKERRQ(ierr);
+#endif
+  ierr = PetscFree(pool->deques);CHKERRQ(ierr);
+  ierr = PetscFree(pool->tid);CHKERRQ(ierr);
+  ierr = PetscFree(pool->status);CHKERRQ(ierr);
+  ierr = PetscFree(pool->granks);CHKERRQ(ierr);
+  ierr = PetscFree(PetscWorkStealDepth);CHKERRQ(ierr);
+  ierr = PetscFree(pool);CHKERRQ(ierr);
+  PetscWorkStealPool = PETSC_NULL;
+  PetscFunctionReturn(0);
+}
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "PetscThreadCommCreate_WorkSteal"
+PetscErrorCode PetscThreadCommCreate_WorkSteal(PetscThreadComm tcomm)
+{
+  PetscThreadComm_WorkSteal pool;
+  PetscErrorCode            ierr;
+  PetscInt                  i,initialized;
+  pthread_attr_t            attr;
+#if defined(PETSC_HAVE_SCHED_CPU_SET_T)
+  PetscInt                  ncores;
+  cpu_set_t                 cpuset;
+#endif
+
+  PetscFunctionBegin;
+  ierr = PetscStrcpy(tcomm->type,WORKSTEAL);CHKERRQ(ierr);
+  tcomm->ops->runkernel      = PetscThreadCommRunKernel_WorkSteal;
+  tcomm->ops->runrangekernel = PetscThreadCommRunRangeKernel_WorkSteal;
+  tcomm->ops->barrier        = PetscThreadCommBarrier_WorkSteal;
+  tcomm->ops->getrank        = PetscThreadCommGetRank_WorkSteal;
+  tcomm->ops->view           = PetscThreadCommView_WorkSteal;
+  tcomm->ops->destroy        = PetscThreadCommDestroy_WorkSteal;
+  wscommcrtct++;
+  if (PetscWorkStealPool) { /* The pool is created only once, for PETSC_THREAD_COMM_WORLD */
+    tcomm->data = (void*)PetscWorkStealPool;
+    PetscFunctionReturn(0);
+  }
+
+  ierr = PetscNew(struct _p_PetscThreadComm_WorkSteal,&pool);CHKERRQ(ierr);
+  tcomm->data        = (void*)pool;
+  PetscWorkStealPool = pool;
+  pool->nthreads         = tcomm->nworkThreads-1;
+  pool->grain            = PETSC_DECIDE;
+  pool->synchronizeafter = PETSC_TRUE;
+  pool->nsteals          = 0;
+
+  ierr = PetscOptionsBegin(PETSC_COMM_WORLD,PETSC_NULL,"Work-stealing thread communicator options",PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-threadcomm_worksteal_grain","Default number of iterations below which a range kernel is not split","PetscThreadCommRunRangeKernel",pool->grain,&pool->grain,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-threadcomm_worksteal_synchronizeafter","Puts a barrier after every kernel call",PETSC_NULL,pool->synchronizeafter,&pool->synchronizeafter,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+
+  ierr = PetscMalloc(tcomm->nworkThreads*sizeof(PetscInt),&pool->granks);CHKERRQ(ierr);
+  ierr = PetscMalloc(tcomm->nworkThreads*sizeof(PetscInt),&pool->status);CHKERRQ(ierr);
+  ierr = PetscMalloc(tcomm->nworkThreads*sizeof(pthread_t),&pool->tid);CHKERRQ(ierr);
+  ierr = PetscMalloc(tcomm->nworkThreads*sizeof(PetscThreadCommDeque_WorkSteal),&pool->deques);CHKERRQ(ierr);
+  ierr = PetscMalloc(tcomm->nworkThreads*sizeof(PetscInt),&PetscWorkStealDepth);CHKERRQ(ierr);
+  for (i=0; i<tcomm->nworkThreads; i++) {
+    pool->granks[i]         = i;
+    pool->status[i]         = WS_THREAD_CREATED;
+    pool->deques[i].top     = 0;
+    pool->deques[i].bottom  = 0;
+    PetscWorkStealDepth[i]  = 0;
+    ierr = pthread_mutex_init(&pool->deques[i].lock,PETSC_NULL);CHKERRQ(ierr);
+  }
+
+  /* The main thread is worker 0 */
+#if defined(PETSC_PTHREAD_LOCAL)
+  PetscWorkStealRank = 0;
+#else
+  ierr = pthread_key_create(&PetscWorkStealRankkey,NULL);CHKERRQ(ierr);
+  ierr = pthread_setspecific(PetscWorkStealRankkey,&pool->granks[0]);CHKERRQ(ierr);
+#endif
+  pool->status[0] = WS_THREAD_INITIALIZED;
+  if (pool->nthreads) tcomm->leader = pool->granks[1];
+
+#if defined(PETSC_HAVE_SCHED_CPU_SET_T)
+  ierr = PetscGetNCores(&ncores);CHKERRQ(ierr);
+  CPU_ZERO(&cpuset);
+  CPU_SET(tcomm->affinities[0]%ncores,&cpuset);
+  sched_setaffinity(0,sizeof(cpu_set_t),&cpuset);
+#endif
+  for (i=1; i<tcomm->nworkThreads; i++) {
+    ierr = pthread_attr_init(&attr);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_SCHED_CPU_SET_T)
+    CPU_ZERO(&cpuset);
+    CPU_SET(tcomm->affinities[i]%ncores,&cpuset);
+    pthread_attr_setaffinity_np(&attr,sizeof(cpu_set_t),&cpuset);
+#endif
+    ierr = pthread_create(&pool->tid[i],&attr,&PetscWorkStealFunc,&pool->granks[i]);CHKERRQ(ierr);
+    ierr = pthread_attr_destroy(&attr);CHKERRQ(ierr);
+  }
+
+  /* Wait till all threads have been initialized */
+  do {
+    initialized = 0;
+    for (i=0; i<tcomm->nworkThreads; i++) {
+      if (PetscReadOnce(PetscInt,pool->status[i]) == WS_THREAD_INITIALIZED) initialized++;
+    }
+  } while (initialized != tcomm->nworkThreads);
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
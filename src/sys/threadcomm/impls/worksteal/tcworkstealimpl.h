@@ -0,0 +1,75 @@
+
+#ifndef __TCWORKSTEALIMPLH
+#define __TCWORKSTEALIMPLH
+
+#include <petsc-private/threadcommimpl.h>
+
+#if defined(PETSC_HAVE_PTHREAD_H)
+#include <pthread.h>
+#elif defined(PETSC_HAVE_WINPTHREADS_H)
+#include "winpthreads.h"       /* http://locklessinc.com/downloads/winpthreads.h */
+#endif
+
+/* Max. number of pending tasks in a thread's deque. When the deque is full a thread
+   simply runs the remaining range itself instead of splitting it further */
+#define PETSC_WORKSTEAL_DEQUE_SIZE 1024
+
+/*
+   PetscThreadCommRange_WorkSteal - A range kernel that is being executed by the thread pool.
+   All the tasks generated by splitting the range point back to it.
+*/
+typedef struct _p_PetscThreadCommRange_WorkSteal *PetscThreadCommRange_WorkSteal;
+struct _p_PetscThreadCommRange_WorkSteal{
+  PetscThreadRangeKernel func;      /* the range kernel */
+  void                   *ctx;      /* user context passed to the kernel */
+  PetscInt               grain;     /* ranges of at most grain iterations are not split further */
+  PetscInt               pending;   /* number of iterations not yet executed */
+  PetscErrorCode         err;       /* first nonzero error code returned by the kernel */
+  pthread_mutex_t        lock;      /* protects pending and err */
+};
+
+/* A task is a subrange [start,end) of a range kernel */
+typedef struct {
+  PetscThreadCommRange_WorkSteal range;
+  PetscInt                       start,end;
+} PetscThreadCommTask_WorkSteal;
+
+/*
+   PetscThreadCommDeque_WorkSteal - Per thread double ended queue of tasks. The owning thread pushes and
+   pops at the bottom, idle threads steal the oldest (and largest) tasks from the top.
+*/
+typedef struct {
+  PetscThreadCommTask_WorkSteal tasks[PETSC_WORKSTEAL_DEQUE_SIZE];
+  PetscInt                      top,bottom;   /* tasks in [top,bottom) modulo PETSC_WORKSTEAL_DEQUE_SIZE */
+  pthread_mutex_t               lock;
+  char                          pad[PETSC_LEVEL1_DCACHE_LINESIZE]; /* keep deques of different threads on separate cache lines */
+} PetscThreadCommDeque_WorkSteal;
+
+/*
+   PetscThreadComm_WorkSteal - Data structure for the work-stealing thread pool. The main thread
+   is always a worker with rank 0, so nworkThreads-1 pthreads are created.
+*/
+struct _p_PetscThreadComm_WorkSteal{
+  PetscInt                       nthreads;         /* Number of threads created */
+  pthread_t                      *tid;             /* thread ids */
+  PetscInt                       *granks;          /* thread ranks */
+  PetscInt                       *status;          /* thread status (created/initialized/terminate) */
+  PetscThreadCommDeque_WorkSteal *deques;          /* one deque per thread */
+  PetscInt                       grain;            /* default grain size for range kernels */
+  PetscBool                      synchronizeafter; /* Whether the main thread should be blocked till all threads complete the given kernel */
+  PetscInt                       nsteals;          /* number of successful steals, for -threadcomm_view */
+};
+
+typedef struct _p_PetscThreadComm_WorkSteal *PetscThreadComm_WorkSteal;
+
+#if defined(PETSC_CPU_RELAX)
+#define PetscCPURelax() do {PETSC_CPU_RELAX();} while(0)
+#else
+#define PetscCPURelax() do { } while(0)
+#endif
+
+EXTERN_C_BEGIN
+extern PetscErrorCode PetscThreadCommCreate_WorkSteal(PetscThreadComm);
+EXTERN_C_END
+
+#endif
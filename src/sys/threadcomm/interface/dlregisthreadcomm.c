@@ -52,6 +52,7 @@ PetscErrorCode PetscThreadCommInitializePackage(const char *path)
   if (PetscThreadCommPackageInitialized) PetscFunctionReturn(0);
   ierr = PetscLogEventRegister("ThreadCommRunKer",  0, &ThreadComm_RunKernel);CHKERRQ(ierr);
   ierr = PetscLogEventRegister("ThreadCommBarrie",    0, &ThreadComm_Barrier);CHKERRQ(ierr);
+  ierr = PetscLogEventRegister("ThreadCommKernel",    0, &ThreadComm_Kernel);CHKERRQ(ierr);
   ierr = PetscThreadCommInitialize();CHKERRQ(ierr);
   PetscThreadCommPackageInitialized = PETSC_TRUE;
   ierr = PetscRegisterFinalize(PetscThreadCommFinalizePackage);CHKERRQ(ierr);
@@ -12,7 +12,7 @@ static PetscThreadComm  tcomm_cached                     = 0;
 PetscThreadCommJobQueue PetscJobQueue                    = PETSC_NULL;
 
 /* Logging support */
-PetscLogEvent ThreadComm_RunKernel, ThreadComm_Barrier;
+PetscLogEvent ThreadComm_RunKernel, ThreadComm_Barrier, ThreadComm_Kernel;
 
 #undef __FUNCT__
 #define __FUNCT__ "PetscGetNCores"
@@ -1115,6 +1115,122 @@ PetscErrorCode PetscThreadCommRunKernel6(MPI_Comm comm,PetscErrorCode (*func)(Pe
   PetscFunctionReturn(0);
 }
 
+/* Context for running a range kernel with the static schedule on types that do not provide a runrangekernel operation */
+typedef struct {
+  PetscThreadRangeKernel func;
+  void                   *ctx;
+  PetscInt               *trstarts;
+  PetscErrorCode         *errs;     /* error code of each thread, each thread writes only its own entry */
+} PetscThreadCommRangeCtx;
+
+static PetscErrorCode PetscThreadCommRangeKernel_Static(PetscInt trank,PetscThreadCommRangeCtx *rctx)
+{
+  PetscInt start = rctx->trstarts[trank],end = rctx->trstarts[trank+1];
+
+  if (start < end) rctx->errs[trank] = (*rctx->func)(trank,start,end,rctx->ctx);
+  return rctx->errs[trank];
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscThreadCommRunRangeKernel"
+/*@C
+   PetscThreadCommRunRangeKernel - Runs a kernel over the iteration space [0,N) using the thread
+                                   communicator associated with the MPI communicator
+
+   Not Collective
+
+   Input Parameters:
++  comm  - the MPI communicator
+.  func  - the range kernel
+.  N     - size of the iteration space
+.  grain - ranges with at most grain iterations are never split, use PETSC_DECIDE to let the thread communicator choose
+-  ctx   - user context passed to the kernel
+
+   Options Database Keys:
+.  -threadcomm_worksteal_grain <grain> - default grain size for the worksteal type
+
+   Level: developer
+
+   Notes:
+   The kernel is called as func(thread_id,start,end,ctx) on disjoint subranges [start,end) that together
+   cover [0,N). Unlike PetscThreadCommRunKernel() the number of calls and the subranges each thread
+   gets are not fixed: with the worksteal type the ranges are split recursively and idle threads steal
+   work from busy ones, which balances irregular work such as matrix rows of very different lengths. The
+   other types use the static schedule of PetscThreadCommGetOwnershipRanges(), one call per thread.
+
+   The call returns after all the iterations have been executed. Called by the main thread only, kernels
+   use PetscThreadKernelRunRange() to submit nested work.
+
+   Example usage - PetscThreadCommRunRangeKernel(comm,(PetscThreadRangeKernel)kernel_func,N,PETSC_DECIDE,&ctx);
+   with kernel_func declared as
+   PetscErrorCode kernel_func(PetscInt thread_id,PetscInt start,PetscInt end,MyCtx *ctx)
+
+.seealso: PetscThreadCommRunKernel(), PetscThreadKernelRunRange(), PetscThreadCommGetOwnershipRanges()
+@*/
+PetscErrorCode PetscThreadCommRunRangeKernel(MPI_Comm comm,PetscThreadRangeKernel func,PetscInt N,PetscInt grain,void *ctx)
+{
+  PetscErrorCode          ierr,err;
+  PetscThreadComm         tcomm=0;
+  PetscThreadCommRangeCtx rctx;
+  PetscInt                i;
+
+  PetscFunctionBegin;
+  if (N < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Iteration space size %D cannot be negative",N);
+  ierr = PetscCommGetThreadComm(comm,&tcomm);CHKERRQ(ierr);
+  if (tcomm->ops->runrangekernel) {
+    ierr = PetscLogEventBegin(ThreadComm_RunKernel,0,0,0,0);CHKERRQ(ierr);
+    err  = (*tcomm->ops->runrangekernel)(tcomm,0,func,N,grain,ctx);
+    ierr = PetscLogEventEnd(ThreadComm_RunKernel,0,0,0,0);CHKERRQ(ierr);
+    CHKERRQ(err);
+  } else {
+    rctx.func = func;
+    rctx.ctx  = ctx;
+    ierr = PetscThreadCommGetOwnershipRanges(comm,N,&rctx.trstarts);CHKERRQ(ierr);
+    ierr = PetscMalloc(tcomm->nworkThreads*sizeof(PetscErrorCode),&rctx.errs);CHKERRQ(ierr);
+    ierr = PetscMemzero(rctx.errs,tcomm->nworkThreads*sizeof(PetscErrorCode));CHKERRQ(ierr);
+    ierr = PetscThreadCommRunKernel1(comm,(PetscThreadKernel)PetscThreadCommRangeKernel_Static,&rctx);CHKERRQ(ierr);
+    /* rctx lives on this stack frame */
+    ierr = PetscThreadCommBarrier(comm);CHKERRQ(ierr);
+    for (i=0; i<tcomm->nworkThreads; i++) if (rctx.errs[i]) break;
+    err  = (i < tcomm->nworkThreads) ? rctx.errs[i] : 0;
+    ierr = PetscFree(rctx.trstarts);CHKERRQ(ierr);
+    ierr = PetscFree(rctx.errs);CHKERRQ(ierr);
+    CHKERRQ(err);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscThreadKernelRunRange"
+/*
+   PetscThreadKernelRunRange - Runs a range kernel over [0,N) from inside a kernel (nested parallelism)
+
+   Input Parameters:
++  trank - rank of the calling thread
+.  tcomm - the thread communicator
+.  func  - the range kernel
+.  N     - size of the iteration space
+.  grain - ranges with at most grain iterations are never split, use PETSC_DECIDE to let the thread communicator choose
+-  ctx   - user context passed to the kernel
+
+   Level: developer
+
+   Notes:
+   This should be called only from kernels. With the worksteal type the range is put on the calling
+   thread's queue where other threads may steal parts of it; while waiting for those, the calling thread
+   executes other pending tasks. With the other types the calling thread runs the whole range itself.
+
+   Returns after all the iterations have been executed.
+
+.seealso: PetscThreadCommRunRangeKernel()
+*/
+PetscErrorCode PetscThreadKernelRunRange(PetscInt trank,PetscThreadComm tcomm,PetscThreadRangeKernel func,PetscInt N,PetscInt grain,void *ctx)
+{
+  if (N <= 0) return 0;
+  if (tcomm->ops->runrangekernel) return (*tcomm->ops->runrangekernel)(tcomm,trank,func,N,grain,ctx);
+  return (*func)(trank,0,N,ctx);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "Petsc_CopyThreadComm"
 /*
@@ -5,6 +5,7 @@ EXTERN_C_BEGIN
 extern PetscErrorCode PetscThreadCommCreate_NoThread(PetscThreadComm);
 #if defined(PETSC_HAVE_PTHREADCLASSES)
 extern PetscErrorCode PetscThreadCommCreate_PThread(PetscThreadComm);
+extern PetscErrorCode PetscThreadCommCreate_WorkSteal(PetscThreadComm);
 #endif
 #if defined(PETSC_HAVE_OPENMP)
 extern PetscErrorCode PetscThreadCommCreate_OpenMP(PetscThreadComm);
@@ -35,6 +36,7 @@ PetscErrorCode PetscThreadCommRegisterAll(const char path[])
   ierr = PetscThreadCommRegisterDynamic(NOTHREAD,         path,"PetscThreadCommCreate_NoThread",         PetscThreadCommCreate_NoThread);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_PTHREADCLASSES)
   ierr = PetscThreadCommRegisterDynamic(PTHREAD,          path,"PetscThreadCommCreate_PThread",          PetscThreadCommCreate_PThread);CHKERRQ(ierr);
+  ierr = PetscThreadCommRegisterDynamic(WORKSTEAL,        path,"PetscThreadCommCreate_WorkSteal",        PetscThreadCommCreate_WorkSteal);CHKERRQ(ierr);
 #endif
 #if defined(PETSC_HAVE_OPENMP)
   ierr = PetscThreadCommRegisterDynamic(OPENMP,         path,"PetscThreadCommCreate_OpenMP",         PetscThreadCommCreate_OpenMP);CHKERRQ(ierr);
@@ -208,6 +208,81 @@ static PetscErrorCode BuildTwoSided_Ibarrier(MPI_Comm comm,PetscMPIInt count,MPI
   ierr = SegArrayDestroy(&segdata);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
+
+#undef __FUNCT__
+#define __FUNCT__ "BuildTwoSidedF_Ibarrier"
+static PetscErrorCode BuildTwoSidedF_Ibarrier(MPI_Comm comm,PetscMPIInt count,MPI_Datatype dtype,PetscInt nto,const PetscMPIInt *toranks,const void *todata,PetscInt *nfrom,PetscMPIInt **fromranks,void *fromdata,PetscMPIInt ntags,MPI_Request **toreqs,MPI_Request **fromreqs,
+                                              PetscErrorCode (*send)(MPI_Comm,const PetscMPIInt[],PetscMPIInt,PetscMPIInt,void*,MPI_Request[],void*),
+                                              PetscErrorCode (*recv)(MPI_Comm,const PetscMPIInt[],PetscMPIInt,void*,MPI_Request[],void*),void *ctx)
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    nrecvs,tag,*tags,unitbytes,done;
+  PetscInt       i;
+  char           *tdata;
+  MPI_Request    *sendreqs,*usendreqs,barrier;
+  SegArray       segrank,segdata,segreq;
+
+  PetscFunctionBegin;
+  ierr = PetscCommGetNewTag(comm,&tag);CHKERRQ(ierr);
+  ierr = PetscMalloc(ntags*sizeof(PetscMPIInt),&tags);CHKERRQ(ierr);
+  for (i=0; i<ntags; i++) {
+    ierr = PetscCommGetNewTag(comm,&tags[i]);CHKERRQ(ierr);
+  }
+  ierr = MPI_Type_size(dtype,&unitbytes);CHKERRQ(ierr);
+  tdata = (char*)todata;
+  ierr = PetscMalloc(nto*sizeof(MPI_Request),&sendreqs);CHKERRQ(ierr);
+  ierr = PetscMalloc(nto*ntags*sizeof(MPI_Request),&usendreqs);CHKERRQ(ierr);
+  /* Post the synchronous header sends first, then the payload messages so they travel in the same round */
+  for (i=0; i<nto; i++) {
+    ierr = MPI_Issend((void*)(tdata+count*unitbytes*i),count,dtype,toranks[i],tag,comm,sendreqs+i);CHKERRQ(ierr);
+  }
+  for (i=0; i<nto; i++) {
+    ierr = (*send)(comm,tags,(PetscMPIInt)i,toranks[i],tdata+count*unitbytes*i,usendreqs+i*ntags,ctx);CHKERRQ(ierr);
+  }
+  ierr = SegArrayCreate(sizeof(PetscMPIInt),4,&segrank);CHKERRQ(ierr);
+  ierr = SegArrayCreate(unitbytes,4*count,&segdata);CHKERRQ(ierr);
+  ierr = SegArrayCreate(sizeof(MPI_Request),4*ntags,&segreq);CHKERRQ(ierr);
+
+  nrecvs  = 0;
+  barrier = MPI_REQUEST_NULL;
+  for (done=0; !done; ) {
+    PetscMPIInt flag;
+    MPI_Status  status;
+    ierr = MPI_Iprobe(MPI_ANY_SOURCE,tag,comm,&flag,&status);CHKERRQ(ierr);
+    if (flag) {                 /* incoming header, post the receives for its payload right away */
+      PetscMPIInt *recvrank;
+      void        *buf;
+      MPI_Request *req;
+      ierr = SegArrayGet(&segrank,1,&recvrank);CHKERRQ(ierr);
+      ierr = SegArrayGet(&segdata,count,&buf);CHKERRQ(ierr);
+      ierr = SegArrayGet(&segreq,ntags,&req);CHKERRQ(ierr);
+      *recvrank = status.MPI_SOURCE;
+      ierr = MPI_Recv(buf,count,dtype,status.MPI_SOURCE,tag,comm,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+      ierr = (*recv)(comm,tags,status.MPI_SOURCE,buf,req,ctx);CHKERRQ(ierr);
+      nrecvs++;
+    }
+    if (barrier == MPI_REQUEST_NULL) {
+      PetscMPIInt sent,nsends = PetscMPIIntCast(nto);
+      ierr = MPI_Testall(nsends,sendreqs,&sent,MPI_STATUSES_IGNORE);CHKERRQ(ierr);
+      if (sent) {
+        ierr = MPI_Ibarrier(comm,&barrier);CHKERRQ(ierr);
+        ierr = PetscFree(sendreqs);CHKERRQ(ierr);
+      }
+    } else {
+      ierr = MPI_Test(&barrier,&done,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+    }
+  }
+  *nfrom   = nrecvs;
+  *toreqs  = usendreqs;
+  ierr = SegArrayExtract(&segrank,fromranks);CHKERRQ(ierr);
+  ierr = SegArrayDestroy(&segrank);CHKERRQ(ierr);
+  ierr = SegArrayExtract(&segdata,fromdata);CHKERRQ(ierr);
+  ierr = SegArrayDestroy(&segdata);CHKERRQ(ierr);
+  ierr = SegArrayExtract(&segreq,fromreqs);CHKERRQ(ierr);
+  ierr = SegArrayDestroy(&segreq);CHKERRQ(ierr);
+  ierr = PetscFree(tags);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
 #endif
 
 #undef __FUNCT__
@@ -308,3 +383,98 @@ PetscErrorCode PetscCommBuildTwoSided(MPI_Comm comm,PetscMPIInt count,MPI_Dataty
   }
   PetscFunctionReturn(0);
 }
+
+#undef __FUNCT__
+#define __FUNCT__ "PetscCommBuildTwoSidedF"
+/*@C
+   PetscCommBuildTwoSidedF - discovers communicating ranks given one-sided information, calling user-defined functions during rendezvous
+
+   Collective on MPI_Comm
+
+   Input Arguments:
++  comm - communicator
+.  count - number of entries to send/receive in initial rendezvous (must match on all ranks)
+.  dtype - datatype to send/receive from each rank (must match on all ranks)
+.  nto - number of ranks to send data to
+.  toranks - ranks to send to (array of length nto)
+.  todata - data to send to each rank (packed)
+.  ntags - number of tags needed by send/recv callbacks
+.  send - callback invoked on sending process when ready to send primary payload
+.  recv - callback invoked on receiving process after delivery of rendezvous message
+-  ctx - context for callbacks
+
+   Output Arguments:
++  nfrom - number of ranks receiving messages from
+.  fromranks - ranks receiving messages from (length nfrom; caller should PetscFree())
+.  fromdata - packed data from each rank, each with count entries of type dtype (length nfrom, caller responsible for PetscFree())
+.  toreqs - array of nto*ntags sender requests (caller must wait on these, then PetscFree())
+-  fromreqs - array of nfrom*ntags receiver requests (caller must wait on these, then PetscFree())
+
+   Calling sequence of send:
+$  send(MPI_Comm comm,const PetscMPIInt tag[],PetscMPIInt i,PetscMPIInt rank,void *sdata,MPI_Request req[],void *ctx)
+
++  tag - ntags tags reserved for this call
+.  i - index of the destination in toranks
+.  rank - rank of the destination
+.  sdata - rendezvous data being sent to rank
+-  req - ntags requests, the callback posts one nonblocking send with each tag and stores its request here
+
+   Calling sequence of recv:
+$  recv(MPI_Comm comm,const PetscMPIInt tag[],PetscMPIInt rank,void *rdata,MPI_Request req[],void *ctx)
+
++  rank - rank of the sender
+.  rdata - rendezvous data received from rank, only valid during the call
+-  req - ntags requests, the callback posts one nonblocking receive with each tag and stores its request here
+
+   Level: developer
+
+   Notes:
+   With the IBARRIER type the payload messages are posted during the rendezvous, so no separate round is needed to
+   exchange message lengths before the data can be sent.  The receives are posted as soon as each rendezvous message
+   arrives, in arrival order, which is also the order of fromranks and fromreqs.
+
+   References:
+   Hoefler, Siebert and Lumsdaine, Scalable communication protocols for dynamic sparse data exchange, 2010.
+
+.seealso: PetscCommBuildTwoSided()
+@*/
+PetscErrorCode PetscCommBuildTwoSidedF(MPI_Comm comm,PetscMPIInt count,MPI_Datatype dtype,PetscInt nto,const PetscMPIInt *toranks,const void *todata,PetscInt *nfrom,PetscMPIInt **fromranks,void *fromdata,PetscMPIInt ntags,MPI_Request **toreqs,MPI_Request **fromreqs,
+                                       PetscErrorCode (*send)(MPI_Comm,const PetscMPIInt[],PetscMPIInt,PetscMPIInt,void*,MPI_Request[],void*),
+                                       PetscErrorCode (*recv)(MPI_Comm,const PetscMPIInt[],PetscMPIInt,void*,MPI_Request[],void*),void *ctx)
+{
+  PetscErrorCode    ierr;
+  BuildTwoSidedType buildtype;
+  PetscMPIInt       i,*tags,unitbytes;
+  char              *tdata,*fdata;
+  MPI_Request       *usendreqs,*recvreqs;
+
+  PetscFunctionBegin;
+  ierr = PetscBuildTwoSidedGetType(&buildtype);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPI_IBARRIER)
+  if (buildtype == BUILDTWOSIDED_IBARRIER) {
+    ierr = BuildTwoSidedF_Ibarrier(comm,count,dtype,nto,toranks,todata,nfrom,fromranks,fromdata,ntags,toreqs,fromreqs,send,recv,ctx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
+  /* Other methods discover the ranks first and then post the payload messages */
+  ierr = PetscCommBuildTwoSided(comm,count,dtype,nto,toranks,todata,nfrom,fromranks,fromdata);CHKERRQ(ierr);
+  ierr = PetscMalloc(ntags*sizeof(PetscMPIInt),&tags);CHKERRQ(ierr);
+  for (i=0; i<ntags; i++) {
+    ierr = PetscCommGetNewTag(comm,&tags[i]);CHKERRQ(ierr);
+  }
+  ierr = MPI_Type_size(dtype,&unitbytes);CHKERRQ(ierr);
+  ierr = PetscMalloc(nto*ntags*sizeof(MPI_Request),&usendreqs);CHKERRQ(ierr);
+  ierr = PetscMalloc(*nfrom*ntags*sizeof(MPI_Request),&recvreqs);CHKERRQ(ierr);
+  tdata = (char*)todata;
+  fdata = *(char**)fromdata;
+  for (i=0; i<*nfrom; i++) {
+    ierr = (*recv)(comm,tags,(*fromranks)[i],fdata+count*unitbytes*i,recvreqs+i*ntags,ctx);CHKERRQ(ierr);
+  }
+  for (i=0; i<nto; i++) {
+    ierr = (*send)(comm,tags,i,toranks[i],tdata+count*unitbytes*i,usendreqs+i*ntags,ctx);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(tags);CHKERRQ(ierr);
+  *toreqs   = usendreqs;
+  *fromreqs = recvreqs;
+  PetscFunctionReturn(0);
+}
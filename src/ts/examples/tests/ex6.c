@@ -0,0 +1,276 @@
+static char help[] = "Tests writing files in the background with PetscAsyncWriter and TSMonitorSolutionAsync().\n\n\
+  -M <M>             number of grid points in each direction\n\
+  -steps <steps>     number of time steps\n\
+  -nbuffers <n>      number of solutions that may be waiting to be written\n\
+  -benchmark         print the time of the solve with each way of writing\n\n";
+
+/*
+   First the writer itself: a buffer written as segments in reverse order, a truncated rewrite, more posts than
+   buffers so that PetscAsyncWriterGetBuffer() has to wait, and a write that fails, which must be reported by
+   PetscAsyncWriterFlush().
+
+   Then the heat equation u_t = u_xx + u_yy on a 2D DMDA is integrated twice with forward Euler. The first run keeps
+   a copy of every solution and writes VTK files with TSMonitorSolutionVTK(); the second writes the binary file and
+   the VTK files in the background, set up with -ts_monitor_draw_solution_binary, -ts_monitor_draw_solution_vtk and
+   -ts_monitor_solution_async. The solutions loaded back from the binary file must equal the copies, and the VTK files
+   of the two runs must be identical. -benchmark prints the time of each run; on a large grid, for example with
+   -M 1000 -steps 50, -info shows how often the monitor waited for a free buffer.
+*/
+#include <petscts.h>
+
+typedef struct {
+  PetscInt nsteps;
+  Vec      *u;    /* the solution at each step */
+} AppCtx;
+
+#undef __FUNCT__
+#define __FUNCT__ "RHSFunction"
+static PetscErrorCode RHSFunction(TS ts,PetscReal t,Vec U,Vec F,void *ptr)
+{
+  DM             da = (DM)ptr;
+  PetscErrorCode ierr;
+  Vec            Ul;
+  PetscScalar    **u,**f;
+  PetscReal      hx,hy;
+  PetscInt       i,j,xs,ys,xm,ym,mx,my;
+
+  PetscFunctionBegin;
+  ierr = DMDAGetInfo(da,0,&mx,&my,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(da,&xs,&ys,0,&xm,&ym,0);CHKERRQ(ierr);
+  hx   = 1.0/(mx-1);
+  hy   = 1.0/(my-1);
+  ierr = DMGetLocalVector(da,&Ul);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalBegin(da,U,INSERT_VALUES,Ul);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(da,U,INSERT_VALUES,Ul);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(da,Ul,&u);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(da,F,&f);CHKERRQ(ierr);
+  for (j=ys; j<ys+ym; j++) {
+    for (i=xs; i<xs+xm; i++) {
+      if (i == 0 || j == 0 || i == mx-1 || j == my-1) {
+        f[j][i] = 0.0;
+      } else {
+        f[j][i] = (u[j][i-1] - 2.0*u[j][i] + u[j][i+1])/(hx*hx) + (u[j-1][i] - 2.0*u[j][i] + u[j+1][i])/(hy*hy);
+      }
+    }
+  }
+  ierr = DMDAVecRestoreArray(da,Ul,&u);CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArray(da,F,&f);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(da,&Ul);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "StoreSolution"
+static PetscErrorCode StoreSolution(TS ts,PetscInt step,PetscReal ptime,Vec u,void *ptr)
+{
+  AppCtx         *user = (AppCtx*)ptr;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (step > user->nsteps) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Step %D beyond the %D steps of the run",step,user->nsteps);
+  ierr = VecCopy(u,user->u[step]);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "ReadFile"
+/* reads at most maxlen bytes of a file, which must exist */
+static PetscErrorCode ReadFile(const char name[],size_t maxlen,char buf[],size_t *len)
+{
+  FILE *fp;
+
+  PetscFunctionBegin;
+  fp = fopen(name,"rb");
+  if (!fp) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_FILE_OPEN,"Cannot open file %s",name);
+  *len = fread(buf,1,maxlen,fp);
+  fclose(fp);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckContents"
+static PetscErrorCode CheckContents(const char name[],const char expected[],size_t len)
+{
+  PetscErrorCode ierr;
+  char           buf[64];
+  size_t         n;
+  PetscBool      same;
+
+  PetscFunctionBegin;
+  ierr = ReadFile(name,sizeof buf,buf,&n);CHKERRQ(ierr);
+  ierr = PetscMemcmp(buf,expected,len,&same);CHKERRQ(ierr);
+  if (n != len || !same) {ierr = PetscPrintf(PETSC_COMM_SELF,"File %s written in the background is wrong\n",name);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckWriter"
+static PetscErrorCode CheckWriter(PetscMPIInt rank)
+{
+  PetscErrorCode   ierr;
+  PetscAsyncWriter w;
+  char             *buf,name[PETSC_MAX_PATH_LEN],others[8][PETSC_MAX_PATH_LEN];
+  Petsc64bitInt    offsets[3];
+  size_t           lens[3];
+  PetscInt         k;
+
+  PetscFunctionBegin;
+  /* one buffer, so that every post after the first one waits for the previous write */
+  ierr = PetscAsyncWriterCreate(1,&w);CHKERRQ(ierr);
+  ierr = PetscSNPrintf(name,sizeof name,"ex6_writer%d.bin",(int)rank);CHKERRQ(ierr);
+  ierr = PetscAsyncWriterGetBuffer(w,10,(void**)&buf);CHKERRQ(ierr);
+  ierr = PetscMemcpy(buf,"HELLOworld",10);CHKERRQ(ierr);
+  offsets[0] = 5; lens[0] = 5;
+  offsets[1] = 0; lens[1] = 5;
+  ierr = PetscAsyncWriterPost(w,name,2,offsets,lens,10);CHKERRQ(ierr);
+  for (k=0; k<8; k++) {
+    ierr = PetscSNPrintf(others[k],sizeof others[k],"ex6_writer%d_%d.bin",(int)rank,(int)k);CHKERRQ(ierr);
+    ierr = PetscAsyncWriterGetBuffer(w,3,(void**)&buf);CHKERRQ(ierr);
+    buf[0] = 'a' + (char)k; buf[1] = 'b' + (char)k; buf[2] = 'c' + (char)k;
+    offsets[0] = 0; lens[0] = 1;
+    offsets[1] = 1; lens[1] = 1;
+    offsets[2] = 2; lens[2] = 1;
+    ierr = PetscAsyncWriterPost(w,others[k],3,offsets,lens,3);CHKERRQ(ierr);
+  }
+  ierr = PetscAsyncWriterFlush(w);CHKERRQ(ierr);
+  ierr = CheckContents(name,"worldHELLO",10);CHKERRQ(ierr);
+  for (k=0; k<8; k++) {
+    char expected[3];
+    expected[0] = 'a' + (char)k; expected[1] = 'b' + (char)k; expected[2] = 'c' + (char)k;
+    ierr = CheckContents(others[k],expected,3);CHKERRQ(ierr);
+  }
+
+  /* overwrite two bytes and cut the file after them */
+  ierr = PetscAsyncWriterGetBuffer(w,2,(void**)&buf);CHKERRQ(ierr);
+  buf[0] = '!'; buf[1] = '!';
+  offsets[0] = 3; lens[0] = 2;
+  ierr = PetscAsyncWriterPost(w,name,1,offsets,lens,5);CHKERRQ(ierr);
+  ierr = PetscAsyncWriterDestroy(&w);CHKERRQ(ierr);
+  ierr = CheckContents(name,"wor!!",5);CHKERRQ(ierr);
+
+  /* a file in a directory that does not exist cannot be written */
+  ierr = PetscAsyncWriterCreate(2,&w);CHKERRQ(ierr);
+  ierr = PetscAsyncWriterGetBuffer(w,1,(void**)&buf);CHKERRQ(ierr);
+  buf[0] = 'x';
+  offsets[0] = 0; lens[0] = 1;
+  ierr = PetscAsyncWriterPost(w,"ex6_no_such_directory/ex6.bin",1,offsets,lens,-1);CHKERRQ(ierr);
+  ierr = PetscPushErrorHandler(PetscReturnErrorHandler,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscAsyncWriterFlush(w);
+  if (!ierr) {ierr = PetscPrintf(PETSC_COMM_SELF,"The failed write was not reported\n");CHKERRQ(ierr);}
+  ierr = PetscAsyncWriterDestroy(&w);
+  ierr = PetscPopErrorHandler();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       M = 17,steps = 10,nbuffers = 2,i,j,xs,ys,xm,ym,way,step;
+  PetscBool      benchmark = PETSC_FALSE,same;
+  PetscMPIInt    rank;
+  DM             da;
+  Vec            u,v;
+  TS             ts;
+  PetscViewer    viewer;
+  AppCtx         user;
+  PetscScalar    **a;
+  PetscReal      h;
+  PetscLogDouble t0,t1,tloc,tmax;
+  char           name[2][PETSC_MAX_PATH_LEN],value[16],*buf[2];
+  size_t         len[2],maxlen;
+  const char     *ways[2] = {"synchronous","asynchronous"};
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-M",&M,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-steps",&steps,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-nbuffers",&nbuffers,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-benchmark",&benchmark,PETSC_NULL);CHKERRQ(ierr);
+
+  ierr = CheckWriter(rank);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Checked the background writer\n");CHKERRQ(ierr);
+
+  ierr = DMDACreate2d(PETSC_COMM_WORLD,DMDA_BOUNDARY_NONE,DMDA_BOUNDARY_NONE,DMDA_STENCIL_STAR,M,M,PETSC_DECIDE,PETSC_DECIDE,1,1,0,0,&da);CHKERRQ(ierr);
+  ierr = DMDASetUniformCoordinates(da,0.0,1.0,0.0,1.0,0.0,1.0);CHKERRQ(ierr);
+  ierr = DMDASetFieldName(da,0,"u");CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(da,&u);CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject)u,"u_");CHKERRQ(ierr);
+  ierr = VecDuplicateVecs(u,steps+1,&user.u);CHKERRQ(ierr);
+  user.nsteps = steps;
+  h           = 1.0/(M-1);
+
+  for (way=0; way<2; way++) {
+    ierr = DMDAGetCorners(da,&xs,&ys,0,&xm,&ym,0);CHKERRQ(ierr);
+    ierr = DMDAVecGetArray(da,u,&a);CHKERRQ(ierr);
+    for (j=ys; j<ys+ym; j++) {
+      for (i=xs; i<xs+xm; i++) a[j][i] = PetscSinReal(PETSC_PI*i*h)*PetscSinReal(2.0*PETSC_PI*j*h) + i*j*h*h*(1.0-i*h)*(1.0-j*h);
+    }
+    ierr = DMDAVecRestoreArray(da,u,&a);CHKERRQ(ierr);
+
+    ierr = TSCreate(PETSC_COMM_WORLD,&ts);CHKERRQ(ierr);
+    ierr = TSSetType(ts,TSEULER);CHKERRQ(ierr);
+    ierr = TSSetDM(ts,da);CHKERRQ(ierr);
+    ierr = TSSetRHSFunction(ts,PETSC_NULL,RHSFunction,da);CHKERRQ(ierr);
+    ierr = TSSetInitialTimeStep(ts,0.0,0.2*h*h);CHKERRQ(ierr);
+    ierr = TSSetDuration(ts,steps,1.e12);CHKERRQ(ierr);
+    if (way == 0) {
+      ierr = TSMonitorSet(ts,StoreSolution,&user,PETSC_NULL);CHKERRQ(ierr);
+      ierr = TSMonitorSet(ts,TSMonitorSolutionVTK,(void*)"ex6_0-%03D.vts",PETSC_NULL);CHKERRQ(ierr);
+      ierr = TSSetFromOptions(ts);CHKERRQ(ierr);
+    } else {
+      ierr = PetscSNPrintf(value,sizeof value,"%D",nbuffers);CHKERRQ(ierr);
+      ierr = PetscOptionsSetValue("-ts_monitor_solution_async",value);CHKERRQ(ierr);
+      ierr = PetscOptionsSetValue("-ts_monitor_draw_solution_binary","ex6_1.bin");CHKERRQ(ierr);
+      ierr = PetscOptionsSetValue("-ts_monitor_draw_solution_vtk","ex6_1-%03D.vts");CHKERRQ(ierr);
+      ierr = TSSetFromOptions(ts);CHKERRQ(ierr);
+      ierr = PetscOptionsClearValue("-ts_monitor_solution_async");CHKERRQ(ierr);
+      ierr = PetscOptionsClearValue("-ts_monitor_draw_solution_binary");CHKERRQ(ierr);
+      ierr = PetscOptionsClearValue("-ts_monitor_draw_solution_vtk");CHKERRQ(ierr);
+    }
+
+    ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+    ierr = TSSolve(ts,u);CHKERRQ(ierr);
+    /* destroying the monitors waits for the last solutions to be written */
+    ierr = TSDestroy(&ts);CHKERRQ(ierr);
+    ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+    if (benchmark) {
+      tloc = t1 - t0;
+      ierr = MPI_Allreduce(&tloc,&tmax,1,MPI_DOUBLE,MPI_MAX,PETSC_COMM_WORLD);CHKERRQ(ierr);
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: %G s\n",ways[way],(PetscReal)tmax);CHKERRQ(ierr);
+    }
+  }
+
+  /* the binary file holds the solution of every step, in the natural ordering of the DMDA */
+  ierr = DMCreateGlobalVector(da,&v);CHKERRQ(ierr);
+  ierr = PetscViewerBinaryOpen(PETSC_COMM_WORLD,"ex6_1.bin",FILE_MODE_READ,&viewer);CHKERRQ(ierr);
+  for (step=0; step<=steps; step++) {
+    ierr = VecLoad(v,viewer);CHKERRQ(ierr);
+    ierr = VecEqual(v,user.u[step],&same);CHKERRQ(ierr);
+    if (!same) {ierr = PetscPrintf(PETSC_COMM_WORLD,"The solution of step %D in the binary file is wrong\n",step);CHKERRQ(ierr);}
+  }
+  ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+  ierr = VecDestroy(&v);CHKERRQ(ierr);
+
+  if (!rank) {
+    maxlen = 1000 + 100*M*M;
+    ierr   = PetscMalloc2(maxlen,char,&buf[0],maxlen,char,&buf[1]);CHKERRQ(ierr);
+    for (step=0; step<=steps; step++) {
+      for (way=0; way<2; way++) {
+        ierr = PetscSNPrintf(name[way],sizeof name[way],"ex6_%D-%03D.vts",way,step);CHKERRQ(ierr);
+        ierr = ReadFile(name[way],maxlen,buf[way],&len[way]);CHKERRQ(ierr);
+      }
+      ierr = PetscMemcmp(buf[0],buf[1],PetscMin(len[0],len[1]),&same);CHKERRQ(ierr);
+      if (len[0] != len[1] || !same) {ierr = PetscPrintf(PETSC_COMM_SELF,"The VTK files of step %D differ\n",step);CHKERRQ(ierr);}
+    }
+    ierr = PetscFree2(buf[0],buf[1]);CHKERRQ(ierr);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Wrote the solutions of %D steps in the background and checked them\n",steps);CHKERRQ(ierr);
+
+  ierr = VecDestroyVecs(steps+1,&user.u);CHKERRQ(ierr);
+  ierr = VecDestroy(&u);CHKERRQ(ierr);
+  ierr = DMDestroy(&da);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,280 @@
+static char help[] = "Tests the Jacobian formed by TS from a mass matrix and a lagged dF/dU.\n\n\
+  -n <n>        number of grid points\n\
+  -lumped       use a lumped (diagonal) mass matrix\n\n";
+
+/*
+   The reaction-diffusion problem M u_t + K u + k u^2 = 0 with linear finite elements in 1D is integrated twice,
+   with a routine assembling a*M + K + 2 k diag(u) set by TSSetIJacobian() and with TSSetIJacobianSplit(), which
+   forms it from M and dF/dU = K + 2 k diag(u), computed as set by -ts_ijacobian_split_lag. The solutions must agree
+   up to the tolerance of the nonlinear solver.
+
+   Before that, the matrix TSComputeIJacobian() forms from M and dF/dU is compared with a*M + dF/dU assembled
+   directly, for the consistent mass matrix (SAME_NONZERO_PATTERN) and the lumped one (SUBSET_NONZERO_PATTERN), at a
+   first evaluation and at a second one with another shift that reuses dF/dU.
+*/
+#include <petscts.h>
+
+typedef struct {
+  DM        da;
+  PetscReal k;          /* reaction rate */
+  PetscBool lumped;
+  PetscInt  nassembly;  /* number of assemblies of a matrix by the user */
+} AppCtx;
+
+#undef __FUNCT__
+#define __FUNCT__ "FormIFunction"
+static PetscErrorCode FormIFunction(TS ts,PetscReal t,Vec U,Vec Udot,Vec F,void *ptr)
+{
+  AppCtx         *user = (AppCtx*)ptr;
+  PetscErrorCode ierr;
+  Vec            Ul,Udotl;
+  PetscScalar    *u,*udot,*f,m;
+  PetscReal      h;
+  PetscInt       i,xs,xm,mx;
+
+  PetscFunctionBegin;
+  ierr = DMDAGetInfo(user->da,0,&mx,0,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(user->da,&xs,0,0,&xm,0,0);CHKERRQ(ierr);
+  h    = 1.0/(mx+1);
+  ierr = DMGetLocalVector(user->da,&Ul);CHKERRQ(ierr);
+  ierr = DMGetLocalVector(user->da,&Udotl);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalBegin(user->da,U,INSERT_VALUES,Ul);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(user->da,U,INSERT_VALUES,Ul);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalBegin(user->da,Udot,INSERT_VALUES,Udotl);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(user->da,Udot,INSERT_VALUES,Udotl);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(user->da,Ul,&u);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(user->da,Udotl,&udot);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(user->da,F,&f);CHKERRQ(ierr);
+  for (i=xs; i<xs+xm; i++) {
+    if (user->lumped) m = h*udot[i];
+    else m = h/6.0*(4.0*udot[i] + (i > 0 ? udot[i-1] : 0.0) + (i < mx-1 ? udot[i+1] : 0.0));
+    f[i] = m + (2.0*u[i] - (i > 0 ? u[i-1] : 0.0) - (i < mx-1 ? u[i+1] : 0.0))/h + h*user->k*u[i]*u[i];
+  }
+  ierr = DMDAVecRestoreArray(user->da,Ul,&u);CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArray(user->da,Udotl,&udot);CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArray(user->da,F,&f);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(user->da,&Ul);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(user->da,&Udotl);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "AssembleMatrix"
+/* assembles a*M + b*dF/dU, where dF/dU is computed at U when b is nonzero */
+static PetscErrorCode AssembleMatrix(AppCtx *user,Vec U,PetscReal a,PetscReal b,Mat A)
+{
+  PetscErrorCode ierr;
+  PetscScalar    *u,v[3];
+  PetscReal      h;
+  PetscInt       i,xs,xm,mx,col[3];
+
+  PetscFunctionBegin;
+  user->nassembly++;
+  ierr = DMDAGetInfo(user->da,0,&mx,0,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(user->da,&xs,0,0,&xm,0,0);CHKERRQ(ierr);
+  h    = 1.0/(mx+1);
+  if (b != 0.0) {ierr = DMDAVecGetArray(user->da,U,&u);CHKERRQ(ierr);}
+  for (i=xs; i<xs+xm; i++) {
+    col[0] = i-1; col[1] = i; col[2] = i+1;
+    if (user->lumped) {
+      v[0] = -b/h;  v[1] = a*h + 2.0*b/h; v[2] = -b/h;
+    } else {
+      v[0] = a*h/6.0 - b/h; v[1] = a*h*4.0/6.0 + 2.0*b/h; v[2] = a*h/6.0 - b/h;
+    }
+    if (b != 0.0) v[1] += b*2.0*h*user->k*u[i];
+    if (user->lumped && b == 0.0) {
+      ierr = MatSetValues(A,1,&i,1,&i,v+1,INSERT_VALUES);CHKERRQ(ierr);
+    } else if (i == 0) {
+      ierr = MatSetValues(A,1,&i,2,col+1,v+1,INSERT_VALUES);CHKERRQ(ierr);
+    } else if (i == mx-1) {
+      ierr = MatSetValues(A,1,&i,2,col,v,INSERT_VALUES);CHKERRQ(ierr);
+    } else {
+      ierr = MatSetValues(A,1,&i,3,col,v,INSERT_VALUES);CHKERRQ(ierr);
+    }
+  }
+  if (b != 0.0) {ierr = DMDAVecRestoreArray(user->da,U,&u);CHKERRQ(ierr);}
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "FormIJacobian"
+static PetscErrorCode FormIJacobian(TS ts,PetscReal t,Vec U,Vec Udot,PetscReal a,Mat *A,Mat *B,MatStructure *flag,void *ptr)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr  = AssembleMatrix((AppCtx*)ptr,U,a,1.0,*B);CHKERRQ(ierr);
+  *flag = SAME_NONZERO_PATTERN;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "FormJacobianU"
+static PetscErrorCode FormJacobianU(TS ts,PetscReal t,Vec U,Vec Udot,Mat J,void *ptr)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = AssembleMatrix((AppCtx*)ptr,U,0.0,1.0,J);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "FormInitialSolution"
+static PetscErrorCode FormInitialSolution(AppCtx *user,Vec U)
+{
+  PetscErrorCode ierr;
+  PetscScalar    *u;
+  PetscInt       i,xs,xm,mx;
+
+  PetscFunctionBegin;
+  ierr = DMDAGetInfo(user->da,0,&mx,0,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(user->da,&xs,0,0,&xm,0,0);CHKERRQ(ierr);
+  ierr = DMDAVecGetArray(user->da,U,&u);CHKERRQ(ierr);
+  for (i=xs; i<xs+xm; i++) u[i] = PetscSinReal(PETSC_PI*(i+1)/(mx+1)) + 0.5*PetscSinReal(3.0*PETSC_PI*(i+1)/(mx+1));
+  ierr = DMDAVecRestoreArray(user->da,U,&u);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CreateMassMatrix"
+static PetscErrorCode CreateMassMatrix(AppCtx *user,Mat *M)
+{
+  PetscErrorCode ierr;
+  PetscInt       xm,mx;
+
+  PetscFunctionBegin;
+  if (user->lumped) {
+    ierr = DMDAGetInfo(user->da,0,&mx,0,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+    ierr = DMDAGetCorners(user->da,0,0,0,&xm,0,0);CHKERRQ(ierr);
+    ierr = MatCreateAIJ(PETSC_COMM_WORLD,xm,xm,mx,mx,1,PETSC_NULL,0,PETSC_NULL,M);CHKERRQ(ierr);
+  } else {
+    ierr = DMCreateMatrix(user->da,MATAIJ,M);CHKERRQ(ierr);
+  }
+  ierr = AssembleMatrix(user,PETSC_NULL,1.0,0.0,*M);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckSplitJacobian"
+/* compares the Jacobian formed by TS from M and dF/dU with a*M + dF/dU assembled directly, for two shifts */
+static PetscErrorCode CheckSplitJacobian(AppCtx *user)
+{
+  PetscErrorCode ierr;
+  TS             ts;
+  Mat            A,J,M,H;
+  Vec            U,Udot;
+  MatStructure   flg;
+  PetscReal      shift[2] = {10.0,1000.0},nrm,err;
+  PetscBool      equal = PETSC_TRUE;
+  PetscInt       i;
+
+  PetscFunctionBegin;
+  ierr = DMCreateGlobalVector(user->da,&U);CHKERRQ(ierr);
+  ierr = VecDuplicate(U,&Udot);CHKERRQ(ierr);
+  ierr = FormInitialSolution(user,U);CHKERRQ(ierr);
+  ierr = VecZeroEntries(Udot);CHKERRQ(ierr);
+  ierr = DMCreateMatrix(user->da,MATAIJ,&A);CHKERRQ(ierr);
+  ierr = DMCreateMatrix(user->da,MATAIJ,&J);CHKERRQ(ierr);
+  ierr = DMCreateMatrix(user->da,MATAIJ,&H);CHKERRQ(ierr);
+  ierr = CreateMassMatrix(user,&M);CHKERRQ(ierr);
+
+  ierr = TSCreate(PETSC_COMM_WORLD,&ts);CHKERRQ(ierr);
+  ierr = TSSetDM(ts,user->da);CHKERRQ(ierr);
+  ierr = TSSetIFunction(ts,PETSC_NULL,FormIFunction,user);CHKERRQ(ierr);
+  ierr = TSSetIJacobianSplit(ts,A,A,M,user->lumped ? SUBSET_NONZERO_PATTERN : SAME_NONZERO_PATTERN,J,FormJacobianU,user);CHKERRQ(ierr);
+  ierr = TSSetIJacobianSplitLag(ts,-1);CHKERRQ(ierr);
+  for (i=0; i<2; i++) {
+    ierr = TSComputeIJacobian(ts,0.0,U,Udot,shift[i],&A,&A,&flg,PETSC_FALSE);CHKERRQ(ierr);
+    ierr = AssembleMatrix(user,U,shift[i],1.0,H);CHKERRQ(ierr);
+    ierr = MatNorm(H,NORM_FROBENIUS,&nrm);CHKERRQ(ierr);
+    ierr = MatAXPY(H,-1.0,A,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = MatNorm(H,NORM_FROBENIUS,&err);CHKERRQ(ierr);
+    if (err > PETSC_SMALL*nrm) equal = PETSC_FALSE;
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Split Jacobian with %s: %s a*M + dF/dU\n",user->lumped ? "SUBSET_NONZERO_PATTERN" : "SAME_NONZERO_PATTERN",equal ? "equal to" : "differs from");CHKERRQ(ierr);
+
+  ierr = TSDestroy(&ts);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = MatDestroy(&J);CHKERRQ(ierr);
+  ierr = MatDestroy(&M);CHKERRQ(ierr);
+  ierr = MatDestroy(&H);CHKERRQ(ierr);
+  ierr = VecDestroy(&U);CHKERRQ(ierr);
+  ierr = VecDestroy(&Udot);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  AppCtx         user;
+  PetscInt       n = 50,i,way,steps[2],nassembly[2];
+  PetscBool      lumped;
+  TS             ts;
+  Mat            A,J,M;
+  Vec            U[2];
+  PetscReal      nrm,err;
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);CHKERRQ(ierr);
+  user.k      = 100.0;
+  user.lumped = PETSC_FALSE;
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetReal(PETSC_NULL,"-k",&user.k,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-lumped",&user.lumped,PETSC_NULL);CHKERRQ(ierr);
+  ierr = DMDACreate1d(PETSC_COMM_WORLD,DMDA_BOUNDARY_NONE,n,1,1,PETSC_NULL,&user.da);CHKERRQ(ierr);
+
+  lumped = user.lumped;
+  for (i=0; i<2; i++) {
+    user.lumped = i ? PETSC_TRUE : PETSC_FALSE;
+    ierr = CheckSplitJacobian(&user);CHKERRQ(ierr);
+  }
+  user.lumped = lumped;
+
+  for (way=0; way<2; way++) {
+    user.nassembly = 0;
+    ierr = DMCreateGlobalVector(user.da,&U[way]);CHKERRQ(ierr);
+    ierr = FormInitialSolution(&user,U[way]);CHKERRQ(ierr);
+
+    ierr = TSCreate(PETSC_COMM_WORLD,&ts);CHKERRQ(ierr);
+    ierr = TSSetDM(ts,user.da);CHKERRQ(ierr);
+    ierr = TSSetType(ts,TSARKIMEX);CHKERRQ(ierr);
+    ierr = TSSetIFunction(ts,PETSC_NULL,FormIFunction,&user);CHKERRQ(ierr);
+    ierr = DMCreateMatrix(user.da,MATAIJ,&A);CHKERRQ(ierr);
+    if (way == 0) {
+      ierr = TSSetIJacobian(ts,A,A,FormIJacobian,&user);CHKERRQ(ierr);
+    } else {
+      ierr = DMCreateMatrix(user.da,MATAIJ,&J);CHKERRQ(ierr);
+      ierr = CreateMassMatrix(&user,&M);CHKERRQ(ierr);
+      ierr = TSSetIJacobianSplit(ts,A,A,M,user.lumped ? SUBSET_NONZERO_PATTERN : SAME_NONZERO_PATTERN,J,FormJacobianU,&user);CHKERRQ(ierr);
+      ierr = MatDestroy(&J);CHKERRQ(ierr);
+      ierr = MatDestroy(&M);CHKERRQ(ierr);
+      user.nassembly = 0;
+    }
+    ierr = MatDestroy(&A);CHKERRQ(ierr);
+    ierr = TSSetInitialTimeStep(ts,0.0,1.e-4);CHKERRQ(ierr);
+    ierr = TSSetDuration(ts,1000,0.05);CHKERRQ(ierr);
+    ierr = TSSetExactFinalTime(ts,TS_EXACTFINALTIME_INTERPOLATE);CHKERRQ(ierr);
+    ierr = TSSetFromOptions(ts);CHKERRQ(ierr);
+    ierr = TSSolve(ts,U[way]);CHKERRQ(ierr);
+    ierr = TSGetTimeStepNumber(ts,&steps[way]);CHKERRQ(ierr);
+    nassembly[way] = user.nassembly;
+    ierr = TSDestroy(&ts);CHKERRQ(ierr);
+  }
+
+  ierr = VecNorm(U[0],NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  ierr = VecAXPY(U[1],-1.0,U[0]);CHKERRQ(ierr);
+  ierr = VecNorm(U[1],NORM_INFINITY,&err);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Same number of steps: %s\n",steps[0] == steps[1] ? "yes" : "no");CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Same solution: %s\n",err <= 1.e-5*nrm ? "yes" : "no");CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Fewer assemblies with the split Jacobian: %s\n",nassembly[1] < nassembly[0] ? "yes" : "no");CHKERRQ(ierr);
+
+  ierr = VecDestroy(&U[0]);CHKERRQ(ierr);
+  ierr = VecDestroy(&U[1]);CHKERRQ(ierr);
+  ierr = DMDestroy(&user.da);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,191 @@
+static char help[] = "Tests and benchmarks the low-storage Runge-Kutta methods on 1D acoustics.\n\n\
+  -M <M>             number of grid points\n\
+  -steps <n>         number of time steps of the benchmark\n\
+  -benchmark         compare the memory and throughput of the explicit Runge-Kutta methods\n\n";
+
+/*
+   The acoustic equations p_t + u_x = 0, u_t + p_x = 0 are discretized on a periodic 1D DMDA with first order upwinding
+   of the characteristic variables p+u and p-u. The test checks the order of convergence in time of each TSLSRK scheme
+   against a reference solution and solves once more with the step size adapted from the embedded error estimate.
+
+   With -benchmark the methods are compared on a large grid, for example
+
+      mpiexec -n 16 ./ex8 -M 20000000 -steps 20 -benchmark
+
+   reporting the memory allocated by the solver per degree of freedom, the rate of stage computations and the rate at
+   which the solver streams the solution and its own vectors, assuming each is read or written once per stage. The memory is only
+   measured when PETSc tracks its allocations, which is the default in debug builds and otherwise needs -malloc.
+*/
+#include <petscts.h>
+
+typedef struct {
+  DM       da;
+  PetscInt nfunc;               /* number of right hand side evaluations */
+} AppCtx;
+
+#undef __FUNCT__
+#define __FUNCT__ "RHSFunction"
+static PetscErrorCode RHSFunction(TS ts,PetscReal t,Vec U,Vec F,void *ptr)
+{
+  AppCtx         *user = (AppCtx*)ptr;
+  DM             da    = user->da;
+  PetscErrorCode ierr;
+  Vec            Ul;
+  PetscScalar    **u,**f,wl,wr,dwr,dwl;
+  PetscReal      hx;
+  PetscInt       i,xs,xm,mx;
+
+  PetscFunctionBegin;
+  ierr = DMDAGetInfo(da,0,&mx,0,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(da,&xs,0,0,&xm,0,0);CHKERRQ(ierr);
+  hx   = 1.0/mx;
+  ierr = DMGetLocalVector(da,&Ul);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalBegin(da,U,INSERT_VALUES,Ul);CHKERRQ(ierr);
+  ierr = DMGlobalToLocalEnd(da,U,INSERT_VALUES,Ul);CHKERRQ(ierr);
+  ierr = DMDAVecGetArrayDOF(da,Ul,&u);CHKERRQ(ierr);
+  ierr = DMDAVecGetArrayDOF(da,F,&f);CHKERRQ(ierr);
+  for (i=xs; i<xs+xm; i++) {
+    /* p+u travels to the right and p-u to the left */
+    wr  = u[i][0] + u[i][1];
+    wl  = u[i][0] - u[i][1];
+    dwr = -(wr - (u[i-1][0] + u[i-1][1]))/hx;
+    dwl = ((u[i+1][0] - u[i+1][1]) - wl)/hx;
+    f[i][0] = 0.5*(dwr + dwl);
+    f[i][1] = 0.5*(dwr - dwl);
+  }
+  ierr = DMDAVecRestoreArrayDOF(da,Ul,&u);CHKERRQ(ierr);
+  ierr = DMDAVecRestoreArrayDOF(da,F,&f);CHKERRQ(ierr);
+  ierr = DMRestoreLocalVector(da,&Ul);CHKERRQ(ierr);
+  ierr = PetscLogFlops(10.0*xm);CHKERRQ(ierr);
+  user->nfunc++;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "FormInitialSolution"
+static PetscErrorCode FormInitialSolution(DM da,Vec U)
+{
+  PetscErrorCode ierr;
+  PetscScalar    **u;
+  PetscInt       i,xs,xm,mx;
+
+  PetscFunctionBegin;
+  ierr = DMDAGetInfo(da,0,&mx,0,0,0,0,0,0,0,0,0,0,0);CHKERRQ(ierr);
+  ierr = DMDAGetCorners(da,&xs,0,0,&xm,0,0);CHKERRQ(ierr);
+  ierr = DMDAVecGetArrayDOF(da,U,&u);CHKERRQ(ierr);
+  for (i=xs; i<xs+xm; i++) {
+    u[i][0] = PetscSinReal(2.0*PETSC_PI*i/mx);
+    u[i][1] = 0.0;
+  }
+  ierr = DMDAVecRestoreArrayDOF(da,U,&u);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "Solve"
+/*
+   Integrates to time T from the initial solution with the given method, in the given number of steps or adapting the
+   step size from that initial size. Returns the memory allocated by the solver and the time of the solve.
+*/
+static PetscErrorCode Solve(AppCtx *user,TSType type,const char subtype[],PetscBool adapt,PetscReal T,PetscInt steps,Vec U,PetscLogDouble *mem,PetscLogDouble *time,PetscInt *nsteps)
+{
+  PetscErrorCode ierr;
+  TS             ts;
+  TSAdapt        tsadapt;
+  PetscBool      islsrk,isssp;
+  PetscLogDouble m0,m1,t0,t1,tloc;
+
+  PetscFunctionBegin;
+  ierr = FormInitialSolution(user->da,U);CHKERRQ(ierr);
+  ierr = PetscMallocGetCurrentUsage(&m0);CHKERRQ(ierr);
+  ierr = TSCreate(PETSC_COMM_WORLD,&ts);CHKERRQ(ierr);
+  ierr = TSSetType(ts,type);CHKERRQ(ierr);
+  ierr = PetscStrcmp(type,TSLSRK,&islsrk);CHKERRQ(ierr);
+  ierr = PetscStrcmp(type,TSSSP,&isssp);CHKERRQ(ierr);
+  if (islsrk) {ierr = TSLSRKSetType(ts,subtype);CHKERRQ(ierr);}
+  if (isssp) {ierr = TSSSPSetType(ts,subtype);CHKERRQ(ierr);}
+  ierr = TSSetDM(ts,user->da);CHKERRQ(ierr);
+  ierr = TSSetRHSFunction(ts,PETSC_NULL,RHSFunction,user);CHKERRQ(ierr);
+  ierr = TSSetInitialTimeStep(ts,0.0,T/steps);CHKERRQ(ierr);
+  ierr = TSSetDuration(ts,adapt ? 100*steps : steps,T);CHKERRQ(ierr);
+  ierr = TSSetExactFinalTime(ts,TS_EXACTFINALTIME_MATCHSTEP);CHKERRQ(ierr);
+  ierr = TSGetTSAdapt(ts,&tsadapt);CHKERRQ(ierr);
+  ierr = TSAdaptSetType(tsadapt,adapt ? TSADAPTBASIC : TSADAPTNONE);CHKERRQ(ierr);
+  if (adapt) {ierr = TSSetTolerances(ts,1.e-6,PETSC_NULL,1.e-6,PETSC_NULL);CHKERRQ(ierr);}
+  ierr = TSSetFromOptions(ts);CHKERRQ(ierr);
+  user->nfunc = 0;
+  ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+  ierr = TSSolve(ts,U);CHKERRQ(ierr);
+  ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+  ierr = PetscMallocGetCurrentUsage(&m1);CHKERRQ(ierr);
+  if (nsteps) {ierr = TSGetTimeStepNumber(ts,nsteps);CHKERRQ(ierr);}
+  ierr = TSDestroy(&ts);CHKERRQ(ierr);
+  if (mem) {
+    m1  -= m0;
+    ierr = MPI_Allreduce(&m1,mem,1,MPI_DOUBLE,MPI_SUM,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  }
+  if (time) {
+    tloc = t1 - t0;
+    ierr = MPI_Allreduce(&tloc,time,1,MPI_DOUBLE,MPI_MAX,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       M = 64,steps = 40,N,i,j,nsteps,nfunc;
+  PetscBool      benchmark = PETSC_FALSE;
+  AppCtx         user;
+  Vec            U,Uref;
+  PetscReal      T = 0.5,err[2];
+  PetscLogDouble mem,time;
+  const char     *lsrktypes[3] = {TSLSRKW2,TSLSRKW3,TSLSRKCK4};
+  const char     *types[5]     = {TSRK,TSSSP,TSLSRK,TSLSRK,TSLSRK};
+  const char     *subtypes[5]  = {PETSC_NULL,TSSSPRK104,TSLSRKW3,TSLSRKCK4,TSLSRKCK4};
+  const PetscBool adapts[5]    = {PETSC_FALSE,PETSC_FALSE,PETSC_FALSE,PETSC_FALSE,PETSC_TRUE};
+
+  ierr = PetscInitialize(&argc,&argv,(char*)0,help);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-M",&M,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-steps",&steps,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-benchmark",&benchmark,PETSC_NULL);CHKERRQ(ierr);
+
+  ierr = DMDACreate1d(PETSC_COMM_WORLD,DMDA_BOUNDARY_PERIODIC,M,2,1,PETSC_NULL,&user.da);CHKERRQ(ierr);
+  ierr = DMCreateGlobalVector(user.da,&U);CHKERRQ(ierr);
+  ierr = VecDuplicate(U,&Uref);CHKERRQ(ierr);
+  ierr = VecGetSize(U,&N);CHKERRQ(ierr);
+
+  if (!benchmark) {
+    /* the error of the reference solution is 4096 times smaller than the error of the coarsest solution below */
+    ierr = Solve(&user,TSLSRK,TSLSRKCK4,PETSC_FALSE,T,8*steps,Uref,PETSC_NULL,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+    for (i=0; i<3; i++) {
+      for (j=0; j<2; j++) {
+        ierr = Solve(&user,TSLSRK,lsrktypes[i],PETSC_FALSE,T,steps<<j,U,PETSC_NULL,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+        ierr = VecAXPY(U,-1.0,Uref);CHKERRQ(ierr);
+        ierr = VecNorm(U,NORM_INFINITY,&err[j]);CHKERRQ(ierr);
+      }
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"%s: order %.1f\n",lsrktypes[i],(double)(PetscLogReal(err[0]/err[1])/PetscLogReal(2.0)));CHKERRQ(ierr);
+    }
+    ierr = Solve(&user,TSLSRK,TSLSRKCK4,PETSC_TRUE,T,steps,U,PETSC_NULL,PETSC_NULL,&nsteps);CHKERRQ(ierr);
+    ierr = VecAXPY(U,-1.0,Uref);CHKERRQ(ierr);
+    ierr = VecNorm(U,NORM_INFINITY,&err[0]);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%s with adaptive steps: %s than %D steps, error %s than 1e-5\n",TSLSRKCK4,nsteps < steps ? "fewer" : "not fewer",steps,err[0] < 1.e-5 ? "smaller" : "larger");CHKERRQ(ierr);
+  } else {
+    /* time steps of half the grid spacing are stable for all the methods */
+    T = 0.5*steps/M;
+    for (i=0; i<5; i++) {
+      ierr  = Solve(&user,types[i],subtypes[i],adapts[i],T,steps,U,&mem,&time,&nsteps);CHKERRQ(ierr);
+      nfunc = user.nfunc;
+      ierr  = PetscPrintf(PETSC_COMM_WORLD,"%s %s%s: %G bytes/DOF, %D steps, %D stages, %G s, %G Mdof-stages/s, %G GB/s\n",types[i],subtypes[i] ? subtypes[i] : "",adapts[i] ? " adaptive" : "",
+                          mem/N,nsteps,nfunc,time,1.e-6*N*nfunc/time,1.e-9*(mem + N*sizeof(PetscScalar))*nfunc/time);CHKERRQ(ierr);
+    }
+  }
+
+  ierr = VecDestroy(&U);CHKERRQ(ierr);
+  ierr = VecDestroy(&Uref);CHKERRQ(ierr);
+  ierr = DMDestroy(&user.da);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
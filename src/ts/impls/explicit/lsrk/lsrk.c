@@ -0,0 +1,668 @@
+/*
+  Code for timestepping with low-storage explicit Runge-Kutta methods
+
+  Notes:
+  The methods are written in the two-register (2N) form of Williamson
+
+    dQ_i = A_i dQ_{i-1} + h F(t + c_i h, U)
+    U    = U + B_i dQ_i,   i = 1,...,s
+
+  so the stage values are never stored. Since the right hand side is computed into a vector of its own, a step needs
+  the solution, dQ and F. When the step size is adapted, the solution at the beginning of the step (for rolling back
+  rejected steps) and the embedded solution are also kept, which is 5 vectors independent of the number of stages.
+*/
+#include <petsc-private/tsimpl.h>                /*I   "petscts.h"   I*/
+
+static TSLSRKType TSLSRKDefault = TSLSRKCK4;
+static PetscBool  TSLSRKRegisterAllCalled;
+static PetscBool  TSLSRKPackageInitialized;
+
+typedef struct _LSRKTableau *LSRKTableau;
+struct _LSRKTableau {
+  char      *name;
+  PetscInt  order;               /* Classical approximation order of the method */
+  PetscInt  s;                   /* Number of stages */
+  PetscReal *A,*B,*c;            /* 2N coefficients and abscissa of each stage */
+  PetscReal *bembed;             /* Butcher weights of the embedded formula of order one less (order-1) */
+  PetscReal ccfl;                /* Placeholder for CFL coefficient relative to forward Euler */
+};
+typedef struct _LSRKTableauLink *LSRKTableauLink;
+struct _LSRKTableauLink {
+  struct _LSRKTableau tab;
+  LSRKTableauLink     next;
+};
+static LSRKTableauLink LSRKTableauList;
+
+typedef struct {
+  LSRKTableau  tableau;
+  Vec          dQ;               /* Second register */
+  Vec          F;                /* Right hand side at the current stage */
+  Vec          U0;               /* Solution at the beginning of the step, only kept when the step may be rejected */
+  Vec          Uhat;             /* Embedded solution, only computed when the step size is adapted */
+  TSStepStatus status;
+} TS_LSRK;
+
+/*MC
+     TSLSRKW2 - Second order two stage low-storage Runge-Kutta scheme (the midpoint method in 2N form).
+
+     The embedded formula is forward Euler.
+
+     Level: advanced
+
+.seealso: TSLSRK
+M*/
+/*MC
+     TSLSRKW3 - Third order three stage low-storage Runge-Kutta scheme of Williamson.
+
+     The embedded second order formula does not use the first stage.
+
+     References:
+     J. H. Williamson, Low-storage Runge-Kutta schemes, J. Comput. Phys. 35 (1980), 48-56.
+
+     Level: advanced
+
+.seealso: TSLSRK
+M*/
+/*MC
+     TSLSRKCK4 - Fourth order five stage low-storage Runge-Kutta scheme of Carpenter and Kennedy.
+
+     This is the default. The embedded third order formula does not use the second stage.
+
+     References:
+     M. H. Carpenter and C. A. Kennedy, Fourth-order 2N-storage Runge-Kutta schemes, NASA TM 109112, 1994.
+
+     Level: advanced
+
+.seealso: TSLSRK
+M*/
+
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKRegisterAll"
+/*@C
+  TSLSRKRegisterAll - Registers all of the low-storage Runge-Kutta methods in TSLSRK
+
+  Not Collective, but should be called by all processes which will need the schemes to be registered
+
+  Level: advanced
+
+.keywords: TS, TSLSRK, register, all
+
+.seealso:  TSLSRKRegisterDestroy()
+@*/
+PetscErrorCode TSLSRKRegisterAll(void)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (TSLSRKRegisterAllCalled) PetscFunctionReturn(0);
+  TSLSRKRegisterAllCalled = PETSC_TRUE;
+
+  {
+    const PetscReal
+      A[2] = {0.0,-0.5},
+      B[2] = {0.5,1.0},
+      bembed[2] = {1.0,0.0};
+    ierr = TSLSRKRegister(TSLSRKW2,2,2,A,B,bembed);CHKERRQ(ierr);
+  }
+  {
+    const PetscReal
+      A[3] = {0.0,-5.0/9.0,-153.0/128.0},
+      B[3] = {1.0/3.0,15.0/16.0,8.0/15.0},
+      bembed[3] = {0.0,3.0/5.0,2.0/5.0};
+    ierr = TSLSRKRegister(TSLSRKW3,3,3,A,B,bembed);CHKERRQ(ierr);
+  }
+  {
+    const PetscReal
+      A[5] = {0.0,
+              -567301805773.0/1357537059087.0,
+              -2404267990393.0/2016746695238.0,
+              -3550918686646.0/2091501179385.0,
+              -1275806237668.0/842570457699.0},
+      B[5] = {1432997174477.0/9575080441755.0,
+              5161836677717.0/13612068292357.0,
+              1720146321549.0/2090206949498.0,
+              3134564353537.0/4481467310338.0,
+              2277821191437.0/14882151754819.0},
+      bembed[5] = {0.16592854486508934,0.0,0.27298494277824931,0.41304217797261045,0.14804433438405087};
+    ierr = TSLSRKRegister(TSLSRKCK4,4,5,A,B,bembed);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKRegisterDestroy"
+/*@C
+   TSLSRKRegisterDestroy - Frees the list of schemes that were registered by TSLSRKRegister().
+
+   Not Collective
+
+   Level: advanced
+
+.keywords: TSLSRK, register, destroy
+.seealso: TSLSRKRegister(), TSLSRKRegisterAll()
+@*/
+PetscErrorCode TSLSRKRegisterDestroy(void)
+{
+  PetscErrorCode  ierr;
+  LSRKTableauLink link;
+
+  PetscFunctionBegin;
+  while ((link = LSRKTableauList)) {
+    LSRKTableau t = &link->tab;
+    LSRKTableauList = link->next;
+    ierr = PetscFree3(t->A,t->B,t->c);CHKERRQ(ierr);
+    ierr = PetscFree(t->bembed);CHKERRQ(ierr);
+    ierr = PetscFree(t->name);CHKERRQ(ierr);
+    ierr = PetscFree(link);CHKERRQ(ierr);
+  }
+  TSLSRKRegisterAllCalled = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKInitializePackage"
+/*@C
+  TSLSRKInitializePackage - This function initializes everything in the TSLSRK package. It is called
+  from PetscDLLibraryRegister() when using dynamic libraries, and on the first call to TSCreate_LSRK()
+  when using static libraries.
+
+  Input Parameter:
+  path - The dynamic library path, or PETSC_NULL
+
+  Level: developer
+
+.keywords: TS, TSLSRK, initialize, package
+.seealso: PetscInitialize()
+@*/
+PetscErrorCode TSLSRKInitializePackage(const char path[])
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (TSLSRKPackageInitialized) PetscFunctionReturn(0);
+  TSLSRKPackageInitialized = PETSC_TRUE;
+  ierr = TSLSRKRegisterAll();CHKERRQ(ierr);
+  ierr = PetscRegisterFinalize(TSLSRKFinalizePackage);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKFinalizePackage"
+/*@C
+  TSLSRKFinalizePackage - This function destroys everything in the TSLSRK package. It is
+  called from PetscFinalize().
+
+  Level: developer
+
+.keywords: Petsc, destroy, package
+.seealso: PetscFinalize()
+@*/
+PetscErrorCode TSLSRKFinalizePackage(void)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  TSLSRKPackageInitialized = PETSC_FALSE;
+  ierr = TSLSRKRegisterDestroy();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKRegister"
+/*@C
+   TSLSRKRegister - register a low-storage Runge-Kutta scheme by providing its coefficients in the 2N form of Williamson
+
+   Not Collective, but the same schemes should be registered on all processes on which they will be used
+
+   Input Parameters:
++  name - identifier for method
+.  order - approximation order of method
+.  s - number of stages, this is the dimension of the arrays below
+.  A - coefficients multiplying the second register in each stage, A[0] must be 0 (dimension s)
+.  B - coefficients of the update of the solution in each stage (dimension s)
+-  bembed - weights of an embedded formula of order one less in the Butcher form of the method (dimension s; PETSC_NULL if not available)
+
+   Notes:
+   Each stage computes dQ = A[i] dQ + h F(t + c[i] h,U) followed by U = U + B[i] dQ. The abscissa c are computed from A
+   and B. The embedded solution is U0 + h sum_i bembed[i] F_i, where F_i is the right hand side computed in stage i.
+
+   Several low-storage methods are provided, this function is only needed to create new methods.
+
+   Level: advanced
+
+.keywords: TS, register
+
+.seealso: TSLSRK
+@*/
+PetscErrorCode TSLSRKRegister(TSLSRKType name,PetscInt order,PetscInt s,const PetscReal A[],const PetscReal B[],const PetscReal bembed[])
+{
+  PetscErrorCode  ierr;
+  LSRKTableauLink link;
+  LSRKTableau     t;
+  PetscInt        i,j,k;
+  PetscReal       *K;
+
+  PetscFunctionBegin;
+  if (s < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of stages %D must be positive",s);
+  if (A[0] != 0.0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"First coefficient A[0]=%G must be zero",A[0]);
+  ierr = PetscMalloc(sizeof(*link),&link);CHKERRQ(ierr);
+  ierr = PetscMemzero(link,sizeof(*link));CHKERRQ(ierr);
+  t = &link->tab;
+  ierr = PetscStrallocpy(name,&t->name);CHKERRQ(ierr);
+  t->order = order;
+  t->s     = s;
+  t->ccfl  = 1.0;
+  ierr = PetscMalloc3(s,PetscReal,&t->A,s,PetscReal,&t->B,s,PetscReal,&t->c);CHKERRQ(ierr);
+  ierr = PetscMemcpy(t->A,A,s*sizeof(A[0]));CHKERRQ(ierr);
+  ierr = PetscMemcpy(t->B,B,s*sizeof(B[0]));CHKERRQ(ierr);
+  /* dQ_k = sum_j K[k][j] h F_j and U_i = U_0 + sum_{k<i} B_k dQ_k, so c_i = sum_{k<i} B_k sum_j K[k][j] */
+  ierr = PetscMalloc(s*s*sizeof(PetscReal),&K);CHKERRQ(ierr);
+  ierr = PetscMemzero(K,s*s*sizeof(PetscReal));CHKERRQ(ierr);
+  for (k=0; k<s; k++) {
+    for (j=0; j<k; j++) K[k*s+j] = A[k]*K[(k-1)*s+j];
+    K[k*s+k] = 1.0;
+  }
+  for (i=0; i<s; i++) {
+    for (k=0,t->c[i]=0; k<i; k++) for (j=0; j<=k; j++) t->c[i] += B[k]*K[k*s+j];
+  }
+  ierr = PetscFree(K);CHKERRQ(ierr);
+  if (bembed) {
+    ierr = PetscMalloc(s*sizeof(PetscReal),&t->bembed);CHKERRQ(ierr);
+    ierr = PetscMemcpy(t->bembed,bembed,s*sizeof(bembed[0]));CHKERRQ(ierr);
+  }
+  link->next = LSRKTableauList;
+  LSRKTableauList = link;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKUpdateStage"
+/*
+  Completes stage i once F = F(t + c_i h,U) is known, in a single pass over the vectors:
+
+    dQ   = A_i dQ + h F
+    U    = U + B_i dQ
+    Uhat = Uhat + h bembed_i F
+
+  In the first stage A_0 = 0 so dQ is not read, and U0 and Uhat are initialized from U before it is updated.
+*/
+static PetscErrorCode TSLSRKUpdateStage(TS ts,PetscInt i,PetscReal h)
+{
+  TS_LSRK           *lsrk = (TS_LSRK*)ts->data;
+  LSRKTableau       tab   = lsrk->tableau;
+  const PetscReal   a     = tab->A[i],b = tab->B[i];
+  const PetscScalar *f;
+  PetscScalar       *u,*dq,*u0 = PETSC_NULL,*uhat = PETSC_NULL,hf;
+  PetscReal         be = 0;
+  PetscInt          k,n;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetLocalSize(ts->vec_sol,&n);CHKERRQ(ierr);
+  ierr = VecGetArray(ts->vec_sol,&u);CHKERRQ(ierr);
+  ierr = VecGetArray(lsrk->dQ,&dq);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(lsrk->F,&f);CHKERRQ(ierr);
+  if (lsrk->Uhat) {
+    be   = tab->bembed[i];
+    ierr = VecGetArray(lsrk->Uhat,&uhat);CHKERRQ(ierr);
+  }
+  if (i == 0) {
+    if (lsrk->U0) {ierr = VecGetArray(lsrk->U0,&u0);CHKERRQ(ierr);}
+    if (u0 && uhat) {
+      for (k=0; k<n; k++) {hf = h*f[k]; u0[k] = u[k]; uhat[k] = u[k] + be*hf; dq[k] = hf; u[k] += b*hf;}
+    } else if (u0) {
+      for (k=0; k<n; k++) {hf = h*f[k]; u0[k] = u[k]; dq[k] = hf; u[k] += b*hf;}
+    } else {
+      for (k=0; k<n; k++) {hf = h*f[k]; dq[k] = hf; u[k] += b*hf;}
+    }
+    if (lsrk->U0) {ierr = VecRestoreArray(lsrk->U0,&u0);CHKERRQ(ierr);}
+  } else {
+    if (uhat) {
+      for (k=0; k<n; k++) {hf = h*f[k]; dq[k] = a*dq[k] + hf; u[k] += b*dq[k]; uhat[k] += be*hf;}
+    } else {
+      for (k=0; k<n; k++) {dq[k] = a*dq[k] + h*f[k]; u[k] += b*dq[k];}
+    }
+  }
+  if (lsrk->Uhat) {ierr = VecRestoreArray(lsrk->Uhat,&uhat);CHKERRQ(ierr);}
+  ierr = VecRestoreArrayRead(lsrk->F,&f);CHKERRQ(ierr);
+  ierr = VecRestoreArray(lsrk->dQ,&dq);CHKERRQ(ierr);
+  ierr = VecRestoreArray(ts->vec_sol,&u);CHKERRQ(ierr);
+  ierr = PetscLogFlops((i ? 5.0 : 3.0)*n + (lsrk->Uhat ? 2.0*n : 0));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSEvaluateStep_LSRK"
+/*
+  The solution is updated in place while the stages are computed and the embedded solution alongside it, so once
+  the stages are done both formulas are available until the next step begins.
+*/
+static PetscErrorCode TSEvaluateStep_LSRK(TS ts,PetscInt order,Vec X,PetscBool *done)
+{
+  TS_LSRK        *lsrk = (TS_LSRK*)ts->data;
+  LSRKTableau    tab   = lsrk->tableau;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (lsrk->status == TS_STEP_INCOMPLETE) SETERRQ(((PetscObject)ts)->comm,PETSC_ERR_ORDER,"The stages of the step have not been computed");
+  if (order == tab->order) {
+    if (X != ts->vec_sol) {ierr = VecCopy(ts->vec_sol,X);CHKERRQ(ierr);}
+    if (done) *done = PETSC_TRUE;
+    PetscFunctionReturn(0);
+  } else if (order == tab->order-1 && lsrk->Uhat) {
+    ierr = VecCopy(lsrk->Uhat,X);CHKERRQ(ierr);
+    if (done) *done = PETSC_TRUE;
+    PetscFunctionReturn(0);
+  }
+  if (done) *done = PETSC_FALSE;
+  else if (order == tab->order-1 && tab->bembed) SETERRQ1(((PetscObject)ts)->comm,PETSC_ERR_SUP,"LSRK '%s' only computes the embedded formula when the step size is adapted",tab->name);
+  else SETERRQ3(((PetscObject)ts)->comm,PETSC_ERR_SUP,"LSRK '%s' of order %D cannot evaluate step at order %D",tab->name,tab->order,order);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSStep_LSRK"
+static PetscErrorCode TSStep_LSRK(TS ts)
+{
+  TS_LSRK         *lsrk = (TS_LSRK*)ts->data;
+  LSRKTableau     tab   = lsrk->tableau;
+  const PetscInt  s     = tab->s;
+  const PetscReal *c    = tab->c;
+  TSAdapt         adapt;
+  PetscInt        i,reject,next_scheme;
+  PetscReal       next_time_step;
+  PetscReal       t;
+  PetscBool       accept,fixed;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  /* The extra vectors are only needed when the controller may reject the step or change its size */
+  ierr = TSGetTSAdapt(ts,&adapt);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)adapt,TSADAPTNONE,&fixed);CHKERRQ(ierr);
+  if (!fixed && !lsrk->U0) {
+    ierr = VecDuplicate(ts->vec_sol,&lsrk->U0);CHKERRQ(ierr);
+    if (tab->bembed) {ierr = VecDuplicate(ts->vec_sol,&lsrk->Uhat);CHKERRQ(ierr);}
+  } else if (fixed && lsrk->U0) {
+    ierr = VecDestroy(&lsrk->U0);CHKERRQ(ierr);
+    ierr = VecDestroy(&lsrk->Uhat);CHKERRQ(ierr);
+  }
+
+  next_time_step = ts->time_step;
+  t = ts->ptime;
+  accept = PETSC_TRUE;
+  lsrk->status = TS_STEP_INCOMPLETE;
+
+  for (reject=0; reject<ts->max_reject && !ts->reason; reject++,ts->reject++) {
+    PetscReal h = ts->time_step;
+    ierr = TSPreStep(ts);CHKERRQ(ierr);
+    for (i=0; i<s; i++) {
+      ierr = TSComputeRHSFunction(ts,t+h*c[i],ts->vec_sol,lsrk->F);CHKERRQ(ierr);
+      ierr = TSLSRKUpdateStage(ts,i,h);CHKERRQ(ierr);
+    }
+    lsrk->status = TS_STEP_PENDING;
+
+    /* Register only the current method as a candidate because we're not supporting multiple candidates yet. */
+    ierr = TSAdaptCandidatesClear(adapt);CHKERRQ(ierr);
+    ierr = TSAdaptCandidateAdd(adapt,tab->name,tab->order,1,tab->ccfl,1.*tab->s,PETSC_TRUE);CHKERRQ(ierr);
+    ierr = TSAdaptChoose(adapt,ts,ts->time_step,&next_scheme,&next_time_step,&accept);CHKERRQ(ierr);
+    if (accept) {
+      /* ignore next_scheme for now */
+      ts->ptime += ts->time_step;
+      ts->time_step = next_time_step;
+      ts->steps++;
+      lsrk->status = TS_STEP_COMPLETE;
+      break;
+    } else {                    /* Roll back the current step */
+      if (!lsrk->U0) SETERRQ(((PetscObject)ts)->comm,PETSC_ERR_PLIB,"Cannot roll back a step that was not saved");
+      ierr = VecCopy(lsrk->U0,ts->vec_sol);CHKERRQ(ierr);
+      ts->time_step = next_time_step;
+      lsrk->status = TS_STEP_INCOMPLETE;
+    }
+  }
+  if (lsrk->status != TS_STEP_COMPLETE && !ts->reason) ts->reason = TS_DIVERGED_STEP_REJECTED;
+  PetscFunctionReturn(0);
+}
+
+/*------------------------------------------------------------*/
+#undef __FUNCT__
+#define __FUNCT__ "TSReset_LSRK"
+static PetscErrorCode TSReset_LSRK(TS ts)
+{
+  TS_LSRK        *lsrk = (TS_LSRK*)ts->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecDestroy(&lsrk->dQ);CHKERRQ(ierr);
+  ierr = VecDestroy(&lsrk->F);CHKERRQ(ierr);
+  ierr = VecDestroy(&lsrk->U0);CHKERRQ(ierr);
+  ierr = VecDestroy(&lsrk->Uhat);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSDestroy_LSRK"
+static PetscErrorCode TSDestroy_LSRK(TS ts)
+{
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = TSReset_LSRK(ts);CHKERRQ(ierr);
+  ierr = PetscFree(ts->data);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ts,"TSLSRKGetType_C","",PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ts,"TSLSRKSetType_C","",PETSC_NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSSetUp_LSRK"
+static PetscErrorCode TSSetUp_LSRK(TS ts)
+{
+  TS_LSRK        *lsrk = (TS_LSRK*)ts->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!lsrk->tableau) {
+    ierr = TSLSRKSetType(ts,TSLSRKDefault);CHKERRQ(ierr);
+  }
+  ierr = VecDuplicate(ts->vec_sol,&lsrk->dQ);CHKERRQ(ierr);
+  ierr = VecDuplicate(ts->vec_sol,&lsrk->F);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+/*------------------------------------------------------------*/
+
+#undef __FUNCT__
+#define __FUNCT__ "TSSetFromOptions_LSRK"
+static PetscErrorCode TSSetFromOptions_LSRK(TS ts)
+{
+  TS_LSRK        *lsrk = (TS_LSRK*)ts->data;
+  PetscErrorCode ierr;
+  char           lsrktype[256];
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead("Low-storage RK ODE solver options");CHKERRQ(ierr);
+  {
+    LSRKTableauLink link;
+    PetscInt        count,choice;
+    PetscBool       flg;
+    const char      **namelist;
+    ierr = PetscStrncpy(lsrktype,lsrk->tableau ? lsrk->tableau->name : TSLSRKDefault,sizeof(lsrktype));CHKERRQ(ierr);
+    for (link=LSRKTableauList,count=0; link; link=link->next,count++) ;
+    ierr = PetscMalloc(count*sizeof(char*),&namelist);CHKERRQ(ierr);
+    for (link=LSRKTableauList,count=0; link; link=link->next,count++) namelist[count] = link->tab.name;
+    ierr = PetscOptionsEList("-ts_lsrk_type","Family of low-storage RK method","TSLSRKSetType",(const char*const*)namelist,count,lsrktype,&choice,&flg);CHKERRQ(ierr);
+    ierr = TSLSRKSetType(ts,flg ? namelist[choice] : lsrktype);CHKERRQ(ierr);
+    ierr = PetscFree(namelist);CHKERRQ(ierr);
+  }
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSView_LSRK"
+static PetscErrorCode TSView_LSRK(TS ts,PetscViewer viewer)
+{
+  TS_LSRK        *lsrk = (TS_LSRK*)ts->data;
+  PetscBool      iascii;
+  PetscErrorCode ierr;
+  TSAdapt        adapt;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    TSLSRKType lsrktype;
+    ierr = TSLSRKGetType(ts,&lsrktype);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"  Low-storage RK %s: order %D, %D stages\n",lsrktype,lsrk->tableau->order,lsrk->tableau->s);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"  Work vectors: %D\n",(lsrk->dQ ? 2 : 0) + (lsrk->U0 ? 1 : 0) + (lsrk->Uhat ? 1 : 0));CHKERRQ(ierr);
+  }
+  ierr = TSGetTSAdapt(ts,&adapt);CHKERRQ(ierr);
+  ierr = TSAdaptView(adapt,viewer);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKSetType"
+/*@C
+  TSLSRKSetType - Set the type of low-storage Runge-Kutta scheme
+
+  Logically collective
+
+  Input Parameter:
++  ts - timestepping context
+-  lsrktype - type of low-storage scheme
+
+  Level: intermediate
+
+.seealso: TSLSRKGetType(), TSLSRK, TSLSRKW2, TSLSRKW3, TSLSRKCK4
+@*/
+PetscErrorCode TSLSRKSetType(TS ts,TSLSRKType lsrktype)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ts,TS_CLASSID,1);
+  ierr = PetscTryMethod(ts,"TSLSRKSetType_C",(TS,TSLSRKType),(ts,lsrktype));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKGetType"
+/*@C
+  TSLSRKGetType - Get the type of low-storage Runge-Kutta scheme
+
+  Logically collective
+
+  Input Parameter:
+.  ts - timestepping context
+
+  Output Parameter:
+.  lsrktype - type of low-storage scheme
+
+  Level: intermediate
+
+.seealso: TSLSRKSetType()
+@*/
+PetscErrorCode TSLSRKGetType(TS ts,TSLSRKType *lsrktype)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ts,TS_CLASSID,1);
+  ierr = PetscUseMethod(ts,"TSLSRKGetType_C",(TS,TSLSRKType*),(ts,lsrktype));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKGetType_LSRK"
+PetscErrorCode  TSLSRKGetType_LSRK(TS ts,TSLSRKType *lsrktype)
+{
+  TS_LSRK        *lsrk = (TS_LSRK*)ts->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!lsrk->tableau) {
+    ierr = TSLSRKSetType(ts,TSLSRKDefault);CHKERRQ(ierr);
+  }
+  *lsrktype = lsrk->tableau->name;
+  PetscFunctionReturn(0);
+}
+#undef __FUNCT__
+#define __FUNCT__ "TSLSRKSetType_LSRK"
+PetscErrorCode  TSLSRKSetType_LSRK(TS ts,TSLSRKType lsrktype)
+{
+  TS_LSRK         *lsrk = (TS_LSRK*)ts->data;
+  PetscErrorCode  ierr;
+  PetscBool       match;
+  LSRKTableauLink link;
+
+  PetscFunctionBegin;
+  if (lsrk->tableau) {
+    ierr = PetscStrcmp(lsrk->tableau->name,lsrktype,&match);CHKERRQ(ierr);
+    if (match) PetscFunctionReturn(0);
+  }
+  for (link = LSRKTableauList; link; link=link->next) {
+    ierr = PetscStrcmp(link->tab.name,lsrktype,&match);CHKERRQ(ierr);
+    if (match) {
+      /* the work vectors do not depend on the number of stages, but the embedded solution depends on the scheme */
+      ierr = VecDestroy(&lsrk->U0);CHKERRQ(ierr);
+      ierr = VecDestroy(&lsrk->Uhat);CHKERRQ(ierr);
+      lsrk->tableau = &link->tab;
+      PetscFunctionReturn(0);
+    }
+  }
+  SETERRQ1(((PetscObject)ts)->comm,PETSC_ERR_ARG_UNKNOWN_TYPE,"Could not find '%s'",lsrktype);
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
+
+/* ------------------------------------------------------------ */
+/*MC
+      TSLSRK - ODE solver using low-storage explicit Runge-Kutta schemes
+
+  These methods are intended for large explicit problems, such as wave propagation, where the memory of the stage
+  vectors of a classical Runge-Kutta method limits the problem size. The stages are computed in the 2N form of
+  Williamson with one fused pass over the vectors per stage, so the memory does not depend on the number of stages:
+  3 vectors (the solution, the second register and the right hand side) with -ts_adapt_type none, and 5 when the
+  step size is adapted with the embedded formula.
+
+  Notes:
+  The default is TSLSRKCK4, it can be changed with TSLSRKSetType() or -ts_lsrk_type
+
+  Only problems provided with TSSetRHSFunction() can be solved. TSInterpolate() is not available since the stages
+  are not stored.
+
+  Level: beginner
+
+.seealso:  TSCreate(), TS, TSSetType(), TSLSRKSetType(), TSLSRKGetType(), TSLSRKW2, TSLSRKW3, TSLSRKCK4, TSLSRKType,
+           TSLSRKRegister(), TSSSP, TSRK
+
+M*/
+EXTERN_C_BEGIN
+#undef __FUNCT__
+#define __FUNCT__ "TSCreate_LSRK"
+PetscErrorCode  TSCreate_LSRK(TS ts)
+{
+  TS_LSRK        *lsrk;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+#if !defined(PETSC_USE_DYNAMIC_LIBRARIES)
+  ierr = TSLSRKInitializePackage(PETSC_NULL);CHKERRQ(ierr);
+#endif
+
+  ts->ops->reset          = TSReset_LSRK;
+  ts->ops->destroy        = TSDestroy_LSRK;
+  ts->ops->view           = TSView_LSRK;
+  ts->ops->setup          = TSSetUp_LSRK;
+  ts->ops->step           = TSStep_LSRK;
+  ts->ops->evaluatestep   = TSEvaluateStep_LSRK;
+  ts->ops->setfromoptions = TSSetFromOptions_LSRK;
+
+  ierr = PetscNewLog(ts,TS_LSRK,&lsrk);CHKERRQ(ierr);
+  ts->data = (void*)lsrk;
+
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ts,"TSLSRKGetType_C","TSLSRKGetType_LSRK",TSLSRKGetType_LSRK);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunctionDynamic((PetscObject)ts,"TSLSRKSetType_C","TSLSRKSetType_LSRK",TSLSRKSetType_LSRK);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+EXTERN_C_END
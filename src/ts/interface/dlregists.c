@@ -51,6 +51,7 @@ PetscErrorCode  TSInitializePackage(const char path[])
   ierr = TSGLInitializePackage(path);CHKERRQ(ierr);
   ierr = TSARKIMEXInitializePackage(path);CHKERRQ(ierr);
   ierr = TSRosWInitializePackage(path);CHKERRQ(ierr);
+  ierr = TSLSRKInitializePackage(path);CHKERRQ(ierr);
   ierr = TSAdaptInitializePackage(path);CHKERRQ(ierr);
   ierr = TSGLAdaptInitializePackage(path);CHKERRQ(ierr);
   /* Register Classes */
@@ -73,7 +73,9 @@ static PetscErrorCode TSSetTypeFromOptions(TS ts)
 .  -ts_monitor_draw_solution - Monitor solution graphically
 .  -ts_monitor_draw_error - Monitor error graphically
 .  -ts_monitor_draw_solution_binary <filename> - Save each solution to a binary file
--  -ts_monitor_draw_solution_vtk <filename.vts> - Save each time step to a binary file, use filename-%%03D.vts
+.  -ts_monitor_draw_solution_vtk <filename.vts> - Save each time step to a binary file, use filename-%%03D.vts
+.  -ts_monitor_solution_async <nbuffers> - Write the solutions of the two previous options in the background, see TSMonitorSolutionAsync()
+-  -ts_ijacobian_split_lag <lag> - Compute dF/dU at every lag-th evaluation of the Jacobian, see TSSetIJacobianSplit()
 
    Level: beginner
 
@@ -83,7 +85,7 @@ static PetscErrorCode TSSetTypeFromOptions(TS ts)
 @*/
 PetscErrorCode  TSSetFromOptions(TS ts)
 {
-  PetscBool              opt,flg;
+  PetscBool              opt,flg,async = PETSC_FALSE;
   PetscErrorCode         ierr;
   PetscViewer            monviewer;
   char                   monfilename[PETSC_MAX_PATH_LEN];
@@ -92,6 +94,7 @@ PetscErrorCode  TSSetFromOptions(TS ts)
   PetscReal              time_step;
   TSExactFinalTimeOption eftopt;
   char                   dir[16];
+  PetscInt               nbuffers = 0,lag;
 
   PetscFunctionBegin;
   PetscValidHeaderSpecific(ts, TS_CLASSID,1);
@@ -198,9 +201,22 @@ PetscErrorCode  TSSetFromOptions(TS ts)
       ierr = TSMonitorDrawCtxCreate(((PetscObject)ts)->comm,0,0,PETSC_DECIDE,PETSC_DECIDE,600,400,howoften,&ctx);CHKERRQ(ierr);
       ierr = TSMonitorSet(ts,TSMonitorDrawError,ctx,(PetscErrorCode (*)(void**))TSMonitorDrawCtxDestroy);CHKERRQ(ierr);
     }
+    ierr = PetscOptionsInt("-ts_ijacobian_split_lag","Compute dF/dU at every lag-th evaluation of the Jacobian, only once if -1","TSSetIJacobianSplitLag",ts->ijacobiansplit.lag,&lag,&flg);CHKERRQ(ierr);
+    if (flg) {ierr = TSSetIJacobianSplitLag(ts,lag);CHKERRQ(ierr);}
+    opt  = PETSC_FALSE;
+    ierr = PetscOptionsName("-ts_monitor_solution_async","Write the solutions of -ts_monitor_draw_solution_binary and _vtk in the background","TSMonitorSolutionAsync",&opt);CHKERRQ(ierr);
+    if (opt) {
+      nbuffers = 2;
+      ierr = PetscOptionsInt("-ts_monitor_solution_async","Number of solutions that may be waiting to be written","TSMonitorSolutionAsync",nbuffers,&nbuffers,PETSC_NULL);CHKERRQ(ierr);
+    }
     opt  = PETSC_FALSE;
     ierr = PetscOptionsString("-ts_monitor_draw_solution_binary","Save each solution to a binary file","TSMonitorSolutionBinary",0,monfilename,PETSC_MAX_PATH_LEN,&flg);CHKERRQ(ierr);
-    if (flg) {
+    if (flg && nbuffers) {
+      TSMonitorAsyncCtx ctx;
+      async = PETSC_TRUE;
+      ierr = TSMonitorAsyncCtxCreate(((PetscObject)ts)->comm,PETSCVIEWERBINARY,monfilename[0] ? monfilename : "binaryoutput",nbuffers,&ctx);CHKERRQ(ierr);
+      ierr = TSMonitorSet(ts,TSMonitorSolutionAsync,ctx,(PetscErrorCode (*)(void**))TSMonitorAsyncCtxDestroy);CHKERRQ(ierr);
+    } else if (flg) {
       PetscViewer ctx;
       if (monfilename[0]) {
         ierr = PetscViewerBinaryOpen(((PetscObject)ts)->comm,monfilename,FILE_MODE_WRITE,&ctx);CHKERRQ(ierr);
@@ -223,8 +239,18 @@ PetscErrorCode  TSSetFromOptions(TS ts)
         if (!ptr2 && (*ptr < '0' || '9' < *ptr)) SETERRQ(((PetscObject)ts)->comm,PETSC_ERR_USER,"Invalid file template argument to -ts_monitor_draw_solution_vtk, should look like filename-%%03D.vts");
         if (ptr2) break;
       }
-      ierr = PetscStrallocpy(monfilename,&filetemplate);CHKERRQ(ierr);
-      ierr = TSMonitorSet(ts,TSMonitorSolutionVTK,filetemplate,(PetscErrorCode (*)(void**))TSMonitorSolutionVTKDestroy);CHKERRQ(ierr);
+      if (nbuffers) {
+        TSMonitorAsyncCtx ctx;
+        async = PETSC_TRUE;
+        ierr = TSMonitorAsyncCtxCreate(((PetscObject)ts)->comm,PETSCVIEWERVTK,monfilename,nbuffers,&ctx);CHKERRQ(ierr);
+        ierr = TSMonitorSet(ts,TSMonitorSolutionAsync,ctx,(PetscErrorCode (*)(void**))TSMonitorAsyncCtxDestroy);CHKERRQ(ierr);
+      } else {
+        ierr = PetscStrallocpy(monfilename,&filetemplate);CHKERRQ(ierr);
+        ierr = TSMonitorSet(ts,TSMonitorSolutionVTK,filetemplate,(PetscErrorCode (*)(void**))TSMonitorSolutionVTKDestroy);CHKERRQ(ierr);
+      }
+    }
+    if (nbuffers && !async) {
+      ierr = PetscInfo(ts,"Ignoring -ts_monitor_solution_async without -ts_monitor_draw_solution_binary or -ts_monitor_draw_solution_vtk\n");CHKERRQ(ierr);
     }
 
     ierr = PetscOptionsString("-ts_monitor_dmda_ray","Display a ray of the solution","None","y=0",dir,16,&flg);CHKERRQ(ierr);
@@ -627,7 +653,7 @@ PetscErrorCode TSComputeIJacobian(TS ts,PetscReal t,Vec U,Vec Udot,PetscReal shi
 
   ierr = PetscObjectStateQuery((PetscObject)U,&Ustate);CHKERRQ(ierr);
   ierr = PetscObjectStateQuery((PetscObject)Udot,&Udotstate);CHKERRQ(ierr);
-  if (ts->ijacobian.time == t && (ts->problem_type == TS_LINEAR || (ts->ijacobian.X == U && ts->ijacobian.Xstate == Ustate && ts->ijacobian.Xdot == Udot && ts->ijacobian.Xdotstate == Udotstate && ts->ijacobian.imex == imex))) {
+  if (!ts->ijacobiansplit.f && ts->ijacobian.time == t && (ts->problem_type == TS_LINEAR || (ts->ijacobian.X == U && ts->ijacobian.Xstate == Ustate && ts->ijacobian.Xdot == Udot && ts->ijacobian.Xdotstate == Udotstate && ts->ijacobian.imex == imex))) {
     *flg = ts->ijacobian.mstructure;
     ierr = MatScale(*A, shift / ts->ijacobian.shift);CHKERRQ(ierr);
     PetscFunctionReturn(0);
@@ -1056,12 +1082,160 @@ PetscErrorCode  TSSetIJacobian(TS ts,Mat A,Mat B,TSIJacobian f,void *ctx)
 
   ierr = TSGetDM(ts,&dm);CHKERRQ(ierr);
   ierr = DMTSSetIJacobian(dm,f,ctx);CHKERRQ(ierr);
+  ts->ijacobiansplit.f = PETSC_NULL;
 
   ierr = TSGetSNES(ts,&snes);CHKERRQ(ierr);
   ierr = SNESSetJacobian(snes,A,B,SNESTSFormJacobian,ts);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "TSComputeIJacobian_Split"
+/*
+   The TSIJacobian set by TSSetIJacobianSplit(): forms A = dF/dU + shift*dF/dU_t from the stored matrices, computing
+   dF/dU with the user's routine only when it is older than the lag
+*/
+static PetscErrorCode TSComputeIJacobian_Split(TS ts,PetscReal t,Vec U,Vec Udot,PetscReal shift,Mat *A,Mat *B,MatStructure *flg,void *ctx)
+{
+  PetscErrorCode ierr;
+  PetscBool      assembled;
+
+  PetscFunctionBegin;
+  if (ts->ijacobiansplit.age < 0 || (ts->ijacobiansplit.lag > 0 && ts->ijacobiansplit.age >= ts->ijacobiansplit.lag)) {
+    PetscStackPush("TS user split implicit Jacobian");
+    ierr = (*ts->ijacobiansplit.f)(ts,t,U,Udot,ts->ijacobiansplit.J,ts->ijacobiansplit.ctx);CHKERRQ(ierr);
+    PetscStackPop;
+    ts->ijacobiansplit.age = 0;
+    ts->ijacobiansplit.nj++;
+  } else {
+    ierr = PetscInfo2(ts,"Changing only the shift to %G, dF/dU was computed %D evaluations ago\n",shift,ts->ijacobiansplit.age);CHKERRQ(ierr);
+    ts->ijacobiansplit.nshift++;
+  }
+  ts->ijacobiansplit.age++;
+
+  /* the values are copied and the shifted mass matrix is added to them, keeping the nonzero pattern of J */
+  ierr = MatAssembled(*A,&assembled);CHKERRQ(ierr);
+  ierr = MatCopy(ts->ijacobiansplit.J,*A,assembled ? SAME_NONZERO_PATTERN : DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatAXPY(*A,shift,ts->ijacobiansplit.M,ts->ijacobiansplit.mstructure);CHKERRQ(ierr);
+  if (*B != *A) {
+    ierr = MatAssembled(*B,&assembled);CHKERRQ(ierr);
+    ierr = MatCopy(ts->ijacobiansplit.J,*B,assembled ? SAME_NONZERO_PATTERN : DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = MatAXPY(*B,shift,ts->ijacobiansplit.M,ts->ijacobiansplit.mstructure);CHKERRQ(ierr);
+  }
+  *flg = SAME_NONZERO_PATTERN;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSSetIJacobianSplit"
+/*@C
+   TSSetIJacobianSplit - Set the matrix dF/dU_t and the function to compute the matrix dF/dU, from which TS forms
+        dF/dU + a*dF/dU_t where F(t,U,U_t) is the function you provided with TSSetIFunction().
+
+   Logically Collective on TS
+
+   Input Parameters:
++  ts  - the TS context obtained from TSCreate()
+.  A   - Jacobian matrix
+.  B   - preconditioning matrix for A (may be same as A)
+.  M   - the matrix dF/dU_t, which must not depend on t, U or U_t
+.  str - the nonzero pattern of M relative to the one of J, SAME_NONZERO_PATTERN or SUBSET_NONZERO_PATTERN
+.  J   - the matrix dF/dU, with the nonzero pattern of A and B
+.  f   - the routine computing dF/dU
+-  ctx - user-defined context for private data for the routine (may be PETSC_NULL)
+
+   Calling sequence of f:
+$  f(TS ts,PetscReal t,Vec U,Vec U_t,Mat J,void *ctx);
+
++  t    - time at step/stage being solved
+.  U    - state vector
+.  U_t  - time derivative of state vector
+.  J    - the matrix to fill with dF/dU, which must be assembled
+-  ctx  - [optional] user-defined context for matrix evaluation routine
+
+   Options Database:
+.  -ts_ijacobian_split_lag <lag> - computes dF/dU at every lag-th evaluation of the Jacobian, only once if -1
+
+   Notes:
+   The implicit methods (TSTHETA, TSARKIMEX, TSROSW) need the Jacobian for a new shift a at every stage or step, often
+   only because the step size changed. With this routine the Jacobian is formed with MatCopy() and MatAXPY(), without
+   calling MatSetValues(), and dF/dU is only computed again as set by TSSetIJacobianSplitLag(). Since the Jacobian
+   is always formed from the same matrices it keeps their nonzero pattern, so SUBSET_NONZERO_PATTERN computes the
+   locations of the entries of M in J only once.
+
+   The Jacobian is only formed when SNES asks for it; use SNESSetLagJacobian() and SNESSetLagPreconditioner() to
+   reuse it during the nonlinear solve of a stage, and TSSetIJacobianSplitLag() to reuse dF/dU between solves.
+
+   This replaces the routine set with TSSetIJacobian(). The number of evaluations of dF/dU and of evaluations changing
+   only the shift is printed by TSView().
+
+   Level: intermediate
+
+.keywords: TS, timestep, DAE, Jacobian, mass matrix, lag
+
+.seealso: TSSetIJacobian(), TSSetIJacobianSplitLag(), TSSetIFunction(), SNESSetLagJacobian(), MatAXPY()
+@*/
+PetscErrorCode TSSetIJacobianSplit(TS ts,Mat A,Mat B,Mat M,MatStructure str,Mat J,TSIJacobianSplit f,void *ctx)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ts,TS_CLASSID,1);
+  PetscValidHeaderSpecific(M,MAT_CLASSID,4);
+  PetscValidLogicalCollectiveEnum(ts,str,5);
+  PetscValidHeaderSpecific(J,MAT_CLASSID,6);
+  PetscCheckSameComm(ts,1,M,4);
+  PetscCheckSameComm(ts,1,J,6);
+  if (str != SAME_NONZERO_PATTERN && str != SUBSET_NONZERO_PATTERN) SETERRQ(((PetscObject)ts)->comm,PETSC_ERR_ARG_OUTOFRANGE,"The nonzero pattern of M must be the same as or a subset of the one of J");
+  ierr = PetscObjectReference((PetscObject)M);CHKERRQ(ierr);
+  ierr = PetscObjectReference((PetscObject)J);CHKERRQ(ierr);
+  ierr = MatDestroy(&ts->ijacobiansplit.M);CHKERRQ(ierr);
+  ierr = MatDestroy(&ts->ijacobiansplit.J);CHKERRQ(ierr);
+  ierr = TSSetIJacobian(ts,A,B,TSComputeIJacobian_Split,PETSC_NULL);CHKERRQ(ierr);
+  ts->ijacobiansplit.M          = M;
+  ts->ijacobiansplit.J          = J;
+  ts->ijacobiansplit.mstructure = str;
+  ts->ijacobiansplit.f          = f;
+  ts->ijacobiansplit.ctx        = ctx;
+  ts->ijacobiansplit.age        = -1;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSSetIJacobianSplitLag"
+/*@
+   TSSetIJacobianSplitLag - Sets how often the matrix dF/dU set with TSSetIJacobianSplit() is computed
+
+   Logically Collective on TS
+
+   Input Parameters:
++  ts - the TS context obtained from TSCreate()
+-  lag - -1 computes dF/dU only at the first evaluation of the Jacobian, 1 at every evaluation, 2 at every other
+         evaluation, etc.
+
+   Options Database:
+.  -ts_ijacobian_split_lag <lag> - sets the lag
+
+   Notes:
+   The default is 1. The other evaluations of the Jacobian only change the shift. A lagged dF/dU slows the
+   convergence of Newton's method, it does not change the solution of the nonlinear systems.
+
+   Level: intermediate
+
+.keywords: TS, timestep, DAE, Jacobian, lag
+
+.seealso: TSSetIJacobianSplit(), SNESSetLagJacobian()
+@*/
+PetscErrorCode TSSetIJacobianSplitLag(TS ts,PetscInt lag)
+{
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ts,TS_CLASSID,1);
+  PetscValidLogicalCollectiveInt(ts,lag,2);
+  if (lag < -1 || !lag) SETERRQ1(((PetscObject)ts)->comm,PETSC_ERR_ARG_OUTOFRANGE,"Lag %D must be -1 or positive",lag);
+  ts->ijacobiansplit.lag = lag;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "TSLoad"
 /*@C
@@ -1182,6 +1356,9 @@ PetscErrorCode  TSView(TS ts,PetscViewer viewer)
     }
     ierr = PetscViewerASCIIPrintf(viewer,"  total number of linear solver iterations=%D\n",ts->ksp_its);CHKERRQ(ierr);
     ierr = PetscViewerASCIIPrintf(viewer,"  total number of rejected steps=%D\n",ts->reject);CHKERRQ(ierr);
+    if (ts->ijacobiansplit.f) {
+      ierr = PetscViewerASCIIPrintf(viewer,"  split Jacobian with lag %D: %D evaluations of dF/dU, %D evaluations changing only the shift\n",ts->ijacobiansplit.lag,ts->ijacobiansplit.nj,ts->ijacobiansplit.nshift);CHKERRQ(ierr);
+    }
     ierr = DMGetDMTS(ts->dm,&sdm);CHKERRQ(ierr);
     ierr = DMTSView(sdm,viewer);CHKERRQ(ierr);
     if (ts->ops->view) {
@@ -1672,6 +1849,8 @@ PetscErrorCode  TSDestroy(TS *ts)
   ierr = SNESDestroy(&(*ts)->snes);CHKERRQ(ierr);
   ierr = DMDestroy(&(*ts)->dm);CHKERRQ(ierr);
   ierr = TSMonitorCancel((*ts));CHKERRQ(ierr);
+  ierr = MatDestroy(&(*ts)->ijacobiansplit.M);CHKERRQ(ierr);
+  ierr = MatDestroy(&(*ts)->ijacobiansplit.J);CHKERRQ(ierr);
 
   ierr = PetscHeaderDestroy(ts);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -3764,6 +3943,185 @@ PetscErrorCode TSMonitorSolutionVTKDestroy(void *filenametemplate)
   PetscFunctionReturn(0);
 }
 
+struct _n_TSMonitorAsyncCtx {
+  PetscAsyncWriter writer;
+  PetscViewerType  type;        /* PETSCVIEWERBINARY or PETSCVIEWERVTK */
+  char             *filename;   /* the binary file, or the template of the names of the VTK files */
+  Petsc64bitInt    offset;      /* location of the next solution in the binary file */
+};
+
+#undef __FUNCT__
+#define __FUNCT__ "TSMonitorAsyncCtxCreate"
+/*@C
+   TSMonitorAsyncCtxCreate - Creates the context used by TSMonitorSolutionAsync()
+
+   Collective on MPI_Comm
+
+   Input Parameters:
++  comm - the communicator of the TS
+.  type - PETSCVIEWERBINARY to append the solutions to a binary file or PETSCVIEWERVTK to write a VTK file per time step
+.  filename - the binary file, or the template of the names of the VTK files (e.g. filename-%03D.vts)
+-  nbuffers - the number of solutions that may be waiting to be written, at least 1
+
+   Output Parameter:
+.  ctx - the context
+
+   Options Database:
+.  -ts_monitor_solution_async <nbuffers> - writes the solutions of -ts_monitor_draw_solution_binary and -ts_monitor_draw_solution_vtk in the background
+
+   Level: intermediate
+
+   Notes:
+   The binary file is truncated by this routine.
+
+.keywords: TS, monitor, asynchronous, output
+
+.seealso: TSMonitorSolutionAsync(), TSMonitorAsyncCtxDestroy(), PetscAsyncWriterCreate()
+@*/
+PetscErrorCode TSMonitorAsyncCtxCreate(MPI_Comm comm,PetscViewerType type,const char filename[],PetscInt nbuffers,TSMonitorAsyncCtx *ctx)
+{
+  PetscErrorCode ierr;
+  PetscBool      isbinary,isvtk;
+  PetscMPIInt    rank;
+  int            fd;
+
+  PetscFunctionBegin;
+  PetscValidCharPointer(filename,3);
+  PetscValidPointer(ctx,5);
+  ierr = PetscStrcmp(type,PETSCVIEWERBINARY,&isbinary);CHKERRQ(ierr);
+  ierr = PetscStrcmp(type,PETSCVIEWERVTK,&isvtk);CHKERRQ(ierr);
+  if (!isbinary && !isvtk) SETERRQ1(comm,PETSC_ERR_SUP,"Cannot write the solution with viewer type %s in the background",type);
+  ierr = PetscNew(struct _n_TSMonitorAsyncCtx,ctx);CHKERRQ(ierr);
+  ierr = PetscAsyncWriterCreate(nbuffers,&(*ctx)->writer);CHKERRQ(ierr);
+  ierr = PetscStrallocpy(filename,&(*ctx)->filename);CHKERRQ(ierr);
+  (*ctx)->type = isbinary ? PETSCVIEWERBINARY : PETSCVIEWERVTK;
+  if (isbinary) {
+    ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
+    if (!rank) {
+      ierr = PetscBinaryOpen(filename,FILE_MODE_WRITE,&fd);CHKERRQ(ierr);
+      ierr = PetscBinaryClose(fd);CHKERRQ(ierr);
+    }
+    ierr = MPI_Barrier(comm);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSMonitorAsyncCtxDestroy"
+/*@C
+   TSMonitorAsyncCtxDestroy - Waits for the solutions to be written and destroys the context of TSMonitorSolutionAsync()
+
+   Not Collective
+
+   Input Parameter:
+.  ctx - the context
+
+   Level: intermediate
+
+.keywords: TS, monitor, asynchronous, output
+
+.seealso: TSMonitorSolutionAsync(), TSMonitorAsyncCtxCreate()
+@*/
+PetscErrorCode TSMonitorAsyncCtxDestroy(TSMonitorAsyncCtx *ctx)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!*ctx) PetscFunctionReturn(0);
+  ierr = PetscFree((*ctx)->filename);CHKERRQ(ierr);
+  ierr = PetscAsyncWriterDestroy(&(*ctx)->writer);CHKERRQ(ierr);
+  ierr = PetscFree(*ctx);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "TSMonitorSolutionAsync"
+/*@C
+   TSMonitorSolutionAsync - Monitors progress of the TS solvers by writing the solution at each timestep in the background
+
+   Collective on TS
+
+   Input Parameters:
++  ts - the TS context
+.  step - current time-step
+.  ptime - current time
+.  u - current state
+-  ctx - the context created with TSMonitorAsyncCtxCreate()
+
+   Level: intermediate
+
+   Notes:
+   The solution is copied to a staging buffer, which a thread writes to the file while the time stepping goes on.
+   The monitor only waits when all the buffers are still being written. The binary file is the same as the one of
+   TSMonitorSolutionBinary(), without the .info file, and the VTK files are the same as the ones of TSMonitorSolutionVTK().
+
+   This function is normally passed as an argument to TSMonitorSet() along with TSMonitorAsyncCtxDestroy().
+
+.keywords: TS, vector, monitor, view, asynchronous
+
+.seealso: TSMonitorSet(), TSMonitorAsyncCtxCreate(), TSMonitorSolutionBinary(), TSMonitorSolutionVTK(), PetscViewerVTKSetAsyncWriter()
+@*/
+PetscErrorCode TSMonitorSolutionAsync(TS ts,PetscInt step,PetscReal ptime,Vec u,void *actx)
+{
+  TSMonitorAsyncCtx ctx = (TSMonitorAsyncCtx)actx;
+  PetscErrorCode    ierr;
+  PetscBool         isvtk,isda = PETSC_FALSE;
+  char              filename[PETSC_MAX_PATH_LEN];
+  PetscViewer       viewer;
+  DM                dm;
+  Vec               x = u;
+  PetscMPIInt       rank;
+  PetscInt          N,rstart,rend,*tr;
+  size_t            hlen,len;
+  Petsc64bitInt     offset;
+  char              *buf;
+  const PetscScalar *xa;
+
+  PetscFunctionBegin;
+  ierr = PetscStrcmp(ctx->type,PETSCVIEWERVTK,&isvtk);CHKERRQ(ierr);
+  if (isvtk) {
+    /* the data of the pieces is gathered while the viewer is destroyed and written by the thread */
+    ierr = PetscSNPrintf(filename,sizeof(filename),ctx->filename,step);CHKERRQ(ierr);
+    ierr = PetscViewerVTKOpen(((PetscObject)ts)->comm,filename,FILE_MODE_WRITE,&viewer);CHKERRQ(ierr);
+    ierr = PetscViewerVTKSetAsyncWriter(viewer,ctx->writer);CHKERRQ(ierr);
+    ierr = VecView(u,viewer);CHKERRQ(ierr);
+    ierr = PetscViewerDestroy(&viewer);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
+  /* VecView() writes a DMDA vector in the natural ordering */
+  ierr = VecGetDM(u,&dm);CHKERRQ(ierr);
+  if (dm) {ierr = PetscObjectTypeCompare((PetscObject)dm,DMDA,&isda);CHKERRQ(ierr);}
+  if (isda) {
+    ierr = DMDACreateNaturalVector(dm,&x);CHKERRQ(ierr);
+    ierr = DMDAGlobalToNaturalBegin(dm,u,INSERT_VALUES,x);CHKERRQ(ierr);
+    ierr = DMDAGlobalToNaturalEnd(dm,u,INSERT_VALUES,x);CHKERRQ(ierr);
+  }
+  ierr = MPI_Comm_rank(((PetscObject)x)->comm,&rank);CHKERRQ(ierr);
+  ierr = VecGetSize(x,&N);CHKERRQ(ierr);
+  ierr = VecGetOwnershipRange(x,&rstart,&rend);CHKERRQ(ierr);
+  hlen = rank ? 0 : 2*sizeof(PetscInt);
+  len  = hlen + (rend-rstart)*sizeof(PetscScalar);
+  ierr = PetscAsyncWriterGetBuffer(ctx->writer,len,(void**)&buf);CHKERRQ(ierr);
+  if (!rank) {
+    tr    = (PetscInt*)buf;
+    tr[0] = VEC_FILE_CLASSID;
+    tr[1] = N;
+  }
+  ierr = VecGetArrayRead(x,&xa);CHKERRQ(ierr);
+  ierr = PetscMemcpy(buf+hlen,xa,(rend-rstart)*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(x,&xa);CHKERRQ(ierr);
+  if (isda) {ierr = VecDestroy(&x);CHKERRQ(ierr);}
+#if !defined(PETSC_WORDS_BIGENDIAN)
+  if (!rank) {ierr = PetscByteSwap(buf,PETSC_INT,2);CHKERRQ(ierr);}
+  ierr = PetscByteSwap(buf+hlen,PETSC_SCALAR,rend-rstart);CHKERRQ(ierr);
+#endif
+  offset = ctx->offset + (rank ? 2*sizeof(PetscInt) + rstart*sizeof(PetscScalar) : 0);
+  ierr   = PetscAsyncWriterPost(ctx->writer,ctx->filename,1,&offset,&len,-1);CHKERRQ(ierr);
+  ctx->offset += 2*sizeof(PetscInt) + N*sizeof(PetscScalar);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "TSGetTSAdapt"
 /*@
@@ -0,0 +1,106 @@
+
+static char help[] = "Tests ISGlobalToLocalMappingApply() with the array and the hash table global to local maps.\n\n\
+  -n <n>        number of local indices of the mapping\n\
+  -nglobal <N>  size of the global numbering the local indices are spread over\n\
+  -its <its>    number of repetitions with -timing\n\
+  -timing       print the number of indices mapped per second by each map\n\n";
+
+/*
+   The hash table is chosen automatically when the local indices are sparse in their global range, compare for example
+      ./ex7 -timing -n 100000 -nglobal 100000000 -its 20
+*/
+#include <petscis.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode         ierr;
+  PetscInt               n = 1000,N = 100000,its = 10,nq,i,k,*indices,*query,*out[2],nout[2],m;
+  PetscBool              timing = PETSC_FALSE;
+  PetscReal              r;
+  PetscLogDouble         t0,t1;
+  PetscRandom            rand;
+  ISLocalToGlobalMapping ltog[3];
+  ISGlobalToLocalMappingType types[2] = {IS_GTOLM_MASK,IS_GTOLM_DROP};
+  const char             *names[2] = {"array","hash table"};
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-nglobal",&N,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-its",&its,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-timing",&timing,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_SELF,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+
+  /* an owned contiguous block, ghosts spread over the global numbering, some unused (negative) and repeated entries */
+  ierr = PetscMalloc(n*sizeof(PetscInt),&indices);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    if (i < n/2) indices[i] = N/3 + i;
+    else if (i%17 == 0) indices[i] = -1;
+    else if (i%23 == 0) indices[i] = indices[i-1];
+    else {
+      ierr       = PetscRandomGetValueReal(rand,&r);CHKERRQ(ierr);
+      indices[i] = (PetscInt)(r*N);
+    }
+  }
+  for (k=0; k<3; k++) {
+    ierr = ISLocalToGlobalMappingCreate(PETSC_COMM_SELF,n,indices,PETSC_COPY_VALUES,&ltog[k]);CHKERRQ(ierr);
+  }
+
+  /* about half of the queries are local indices, the rest any global index and a few out of range */
+  nq   = 4*n;
+  ierr = PetscMalloc3(nq,PetscInt,&query,nq,PetscInt,&out[0],nq,PetscInt,&out[1]);CHKERRQ(ierr);
+  for (i=0; i<nq; i++) {
+    ierr = PetscRandomGetValueReal(rand,&r);CHKERRQ(ierr);
+    if (i%2) query[i] = indices[(PetscInt)(r*n)];
+    else     query[i] = (PetscInt)(r*(N+4)) - 2;
+  }
+
+  /* the global to local map is created at the first application, the array in ltog[0] and the hash table in ltog[1] */
+  ierr = PetscOptionsSetValue("-is_gtolm_hash","false");CHKERRQ(ierr);
+  ierr = ISGlobalToLocalMappingApply(ltog[0],IS_GTOLM_MASK,0,PETSC_NULL,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsSetValue("-is_gtolm_hash","true");CHKERRQ(ierr);
+  ierr = ISGlobalToLocalMappingApply(ltog[1],IS_GTOLM_MASK,0,PETSC_NULL,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsClearValue("-is_gtolm_hash");CHKERRQ(ierr);
+  ierr = ISGlobalToLocalMappingApply(ltog[2],IS_GTOLM_MASK,0,PETSC_NULL,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_SELF,"%D local indices spread over %D global indices use the %s\n",n,N,names[ltog[2]->globalht ? 1 : 0]);CHKERRQ(ierr);
+
+  for (m=0; m<2; m++) {
+    for (k=0; k<2; k++) {
+      ierr = ISGlobalToLocalMappingApply(ltog[k],types[m],nq,query,&nout[k],out[k]);CHKERRQ(ierr);
+    }
+    if (nout[0] != nout[1]) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Array map gives %D indices, hash table %D",nout[0],nout[1]);
+    for (i=0; i<nout[0]; i++) {
+      if (out[0][i] != out[1][i]) SETERRQ4(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Query %D: array map gives %D, hash table %D for global %D",i,out[0][i],out[1][i],query[i]);
+    }
+    for (i=0; i<nout[0]; i++) {
+      if (out[0][i] >= 0 && indices[out[0][i]] < 0) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Local index %D has no global index but was returned for query %D",out[0][i],i);
+    }
+    for (k=0; k<2; k++) {
+      ierr = ISGlobalToLocalMappingApply(ltog[k],types[m],nq,query,&nout[k],PETSC_NULL);CHKERRQ(ierr);
+    }
+    if (nout[0] != nout[1]) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Array map counts %D indices, hash table %D",nout[0],nout[1]);
+    ierr = PetscPrintf(PETSC_COMM_SELF,"%s: checked\n",types[m] == IS_GTOLM_MASK ? "IS_GTOLM_MASK" : "IS_GTOLM_DROP");CHKERRQ(ierr);
+  }
+
+  if (timing) {
+    for (k=0; k<2; k++) {
+      ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+      for (i=0; i<its; i++) {
+        ierr = ISGlobalToLocalMappingApply(ltog[k],IS_GTOLM_MASK,nq,query,PETSC_NULL,out[k]);CHKERRQ(ierr);
+      }
+      ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+      ierr = PetscPrintf(PETSC_COMM_SELF,"  %s: %G million indices per second\n",names[k],1.e-6*its*nq/(t1-t0));CHKERRQ(ierr);
+    }
+  }
+
+  ierr = PetscFree3(query,out[0],out[1]);CHKERRQ(ierr);
+  ierr = PetscFree(indices);CHKERRQ(ierr);
+  for (k=0; k<3; k++) {
+    ierr = ISLocalToGlobalMappingDestroy(&ltog[k]);CHKERRQ(ierr);
+  }
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -1,5 +1,6 @@
 
 #include <petsc-private/isimpl.h>    /*I "petscis.h"  I*/
+#include <../src/sys/utils/hash.h>
 
 PetscClassId  IS_LTOGM_CLASSID;
 
@@ -205,7 +206,8 @@ PetscErrorCode  ISLocalToGlobalMappingCreate(MPI_Comm cm,PetscInt n,const PetscI
     Do not create the global to local mapping. This is only created if
     ISGlobalToLocalMapping() is called
   */
-  (*mapping)->globals = 0;
+  (*mapping)->globals  = 0;
+  (*mapping)->globalht = 0;
   if (mode == PETSC_COPY_VALUES) {
     ierr = PetscMalloc(n*sizeof(PetscInt),&in);CHKERRQ(ierr);
     ierr = PetscMemcpy(in,indices,n*sizeof(PetscInt));CHKERRQ(ierr);
@@ -329,6 +331,10 @@ PetscErrorCode  ISLocalToGlobalMappingDestroy(ISLocalToGlobalMapping *mapping)
   if (--((PetscObject)(*mapping))->refct > 0) {*mapping = 0;PetscFunctionReturn(0);}
   ierr = PetscFree((*mapping)->indices);CHKERRQ(ierr);
   ierr = PetscFree((*mapping)->globals);CHKERRQ(ierr);
+  if ((*mapping)->globalht) {
+    PetscHashI ht = (PetscHashI)(*mapping)->globalht;
+    PetscHashIDestroy(ht);
+  }
   ierr = PetscHeaderDestroy(mapping);CHKERRQ(ierr);
   *mapping = 0;
   PetscFunctionReturn(0);
@@ -419,11 +425,20 @@ M*/
 #define __FUNCT__ "ISGlobalToLocalMappingSetUp_Private"
 /*
     Creates the global fields in the ISLocalToGlobalMapping structure
+
+    An array indexed by the global index, from the smallest to the largest global index of the mapping, is used when
+    the local indices cover at least one in ISGTOLM_HASH_DENSITY of that range, otherwise a hash table from the global
+    to the local indices. The array is faster to search but costs memory proportional to the range, which for a
+    ghosted or unstructured mapping may be most of the global problem on every process. The choice can be forced
+    with -is_gtolm_hash <true,false>.
 */
+#define ISGTOLM_HASH_DENSITY 8
 static PetscErrorCode ISGlobalToLocalMappingSetUp_Private(ISLocalToGlobalMapping mapping)
 {
   PetscErrorCode ierr;
-  PetscInt       i,*idx = mapping->indices,n = mapping->n,end,start,*globals;
+  PetscInt       i,*idx = mapping->indices,n = mapping->n,end,start,*globals,nv = 0;
+  PetscBool      usehash;
+  PetscHashI     ht;
 
   PetscFunctionBegin;
   end   = 0;
@@ -433,11 +448,27 @@ static PetscErrorCode ISGlobalToLocalMappingSetUp_Private(ISLocalToGlobalMapping
     if (idx[i] < 0) continue;
     if (idx[i] < start) start = idx[i];
     if (idx[i] > end)   end   = idx[i];
+    nv++;
   }
   if (start > end) {start = 0; end = -1;}
   mapping->globalstart = start;
   mapping->globalend   = end;
 
+  usehash = (PetscBool)((end-start+1)/ISGTOLM_HASH_DENSITY > nv);
+  ierr    = PetscOptionsGetBool(PETSC_NULL,"-is_gtolm_hash",&usehash,PETSC_NULL);CHKERRQ(ierr);
+  if (usehash) {
+    PetscHashICreate(ht);
+    PetscHashIResize(ht,nv);
+    for (i=0; i<n; i++) {
+      if (idx[i] < 0) continue;
+      PetscHashIAdd(ht,idx[i],i);
+    }
+    mapping->globalht = (void*)ht;
+    ierr = PetscLogObjectMemory(mapping,kh_n_buckets(ht)*2*sizeof(PetscInt));CHKERRQ(ierr);
+    ierr = PetscInfo3(mapping,"Hash table for %D local indices with global indices from %D to %D\n",nv,start,end);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
   ierr             = PetscMalloc((end-start+2)*sizeof(PetscInt),&globals);CHKERRQ(ierr);
   mapping->globals = globals;
   for (i=0; i<end-start+1; i++) {
@@ -475,11 +506,16 @@ static PetscErrorCode ISGlobalToLocalMappingSetUp_Private(ISLocalToGlobalMapping
              and then allocate the required space and call ISGlobalToLocalMappingApply()
              a second time to set the values.
 
+    Options Database Key:
+.   -is_gtolm_hash <true,false> - always, or never, use a hash table for the global to local map
+
     Notes:
     Either nout or idxout may be PETSC_NULL. idx and idxout may be identical.
 
-    This is not scalable in memory usage. Each processor requires O(Nglobal) size
-    array to compute these.
+    The global to local map is created at the first call. It is an array over the range of the global
+    indices of the mapping, O(Nglobal) memory on each process when the local indices are spread over the
+    global numbering, unless the local indices are sparse in that range, in which case a hash table with
+    memory proportional to the number of local indices is used instead.
 
     Level: advanced
 
@@ -495,17 +531,45 @@ PetscErrorCode  ISGlobalToLocalMappingApply(ISLocalToGlobalMapping mapping,ISGlo
                                   PetscInt n,const PetscInt idx[],PetscInt *nout,PetscInt idxout[])
 {
   PetscInt       i,*globals,nf = 0,tmp,start,end;
+  PetscHashI     ht;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
   PetscValidHeaderSpecific(mapping,IS_LTOGM_CLASSID,1);
-  if (!mapping->globals) {
+  if (!mapping->globals && !mapping->globalht) {
     ierr = ISGlobalToLocalMappingSetUp_Private(mapping);CHKERRQ(ierr);
   }
   globals = mapping->globals;
+  ht      = (PetscHashI)mapping->globalht;
   start   = mapping->globalstart;
   end     = mapping->globalend;
 
+  if (ht) {
+    if (type == IS_GTOLM_MASK) {
+      if (idxout) {
+        for (i=0; i<n; i++) {
+          if (idx[i] < 0) idxout[i] = idx[i];
+          else if (idx[i] < start) idxout[i] = -1;
+          else if (idx[i] > end)   idxout[i] = -1;
+          else PetscHashIMap(ht,idx[i],idxout[i]);
+        }
+      }
+      if (nout) *nout = n;
+    } else {
+      for (i=0; i<n; i++) {
+        if (idx[i] < 0) continue;
+        if (idx[i] < start) continue;
+        if (idx[i] > end) continue;
+        PetscHashIMap(ht,idx[i],tmp);
+        if (tmp < 0) continue;
+        if (idxout) idxout[nf] = tmp;
+        nf++;
+      }
+      if (nout) *nout = nf;
+    }
+    PetscFunctionReturn(0);
+  }
+
   if (type == IS_GTOLM_MASK) {
     if (idxout) {
       for (i=0; i<n; i++) {
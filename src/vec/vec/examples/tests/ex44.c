@@ -0,0 +1,105 @@
+
+static char help[] = "Tests VecMDotNorm() and VecMAXPYNorm() against VecMDot(), VecMAXPY() and VecNorm().\n\n\
+  -n <n>        local length of the vectors\n\
+  -its <its>    number of repetitions with -timing\n\
+  -timing       print the time of the fused and of the separate operations\n\n";
+
+/*
+   The fused operations are what the classical Gram-Schmidt of GMRES uses, compare for example
+      ./ex44 -timing -n 1000000 -its 20
+*/
+#include <petscvec.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       n = 2500,its = 10,nvs[6] = {1,3,5,30,33,130},nv,i,k;
+  PetscBool      timing = PETSC_FALSE;
+  PetscScalar    *dots,*fdots,*alpha;
+  PetscReal      nrm,fnrm,err,tol = PETSC_SQRT_MACHINE_EPSILON;
+  PetscLogDouble t0,t1,t2;
+  PetscRandom    rand;
+  Vec            x,w,z,*y;
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-its",&its,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-timing",&timing,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = VecCreate(PETSC_COMM_WORLD,&x);CHKERRQ(ierr);
+  ierr = VecSetSizes(x,n,PETSC_DECIDE);CHKERRQ(ierr);
+  ierr = VecSetFromOptions(x);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&w);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&z);CHKERRQ(ierr);
+  ierr = VecSetRandom(x,rand);CHKERRQ(ierr);
+  ierr = VecDuplicateVecs(x,nvs[5],&y);CHKERRQ(ierr);
+  for (i=0; i<nvs[5]; i++) {ierr = VecSetRandom(y[i],rand);CHKERRQ(ierr);}
+  ierr = PetscMalloc3(nvs[5],PetscScalar,&dots,nvs[5],PetscScalar,&fdots,nvs[5],PetscScalar,&alpha);CHKERRQ(ierr);
+  for (i=0; i<nvs[5]; i++) alpha[i] = -1.0/(i+2);
+
+  for (k=0; k<6; k++) {
+    nv = nvs[k];
+    /* the dot products and the norm of x */
+    ierr = VecMDot(x,nv,y,dots);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_2,&nrm);CHKERRQ(ierr);
+    ierr = VecMDotNorm(x,nv,y,fdots,&fnrm);CHKERRQ(ierr);
+    err  = PetscAbsReal(nrm-fnrm)/nrm;
+    for (i=0; i<nv; i++) err = PetscMax(err,PetscAbsScalar(dots[i]-fdots[i])/nrm);
+    if (err > tol) {ierr = PetscPrintf(PETSC_COMM_WORLD,"VecMDotNorm() with %D vectors differs by %G\n",nv,err);CHKERRQ(ierr);}
+
+    /* the update and its norm */
+    ierr = VecCopy(x,w);CHKERRQ(ierr);
+    ierr = VecMAXPY(w,nv,alpha,y);CHKERRQ(ierr);
+    ierr = VecNorm(w,NORM_2,&nrm);CHKERRQ(ierr);
+    ierr = VecCopy(x,z);CHKERRQ(ierr);
+    ierr = VecMAXPYNorm(z,nv,alpha,y,&fnrm);CHKERRQ(ierr);
+    err  = PetscAbsReal(nrm-fnrm)/nrm;
+    ierr = VecAXPY(z,-1.0,w);CHKERRQ(ierr);
+    ierr = VecNorm(z,NORM_2,&fnrm);CHKERRQ(ierr);
+    err  = PetscMax(err,fnrm/nrm);
+    if (err > tol) {ierr = PetscPrintf(PETSC_COMM_WORLD,"VecMAXPYNorm() with %D vectors differs by %G\n",nv,err);CHKERRQ(ierr);}
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"%D vectors: checked\n",nv);CHKERRQ(ierr);
+
+    if (timing) {
+      /* the norms are cached with the vectors, so the state of w is increased to have them computed again */
+      ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+      for (i=0; i<its; i++) {
+        ierr = VecMDot(w,nv,y,dots);CHKERRQ(ierr);
+        ierr = VecNorm(w,NORM_2,&nrm);CHKERRQ(ierr);
+        ierr = PetscObjectStateIncrease((PetscObject)w);CHKERRQ(ierr);
+      }
+      ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+      for (i=0; i<its; i++) {
+        ierr = VecMDotNorm(w,nv,y,dots,&nrm);CHKERRQ(ierr);
+        ierr = PetscObjectStateIncrease((PetscObject)w);CHKERRQ(ierr);
+      }
+      ierr = PetscGetTime(&t2);CHKERRQ(ierr);
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"  VecMDot()+VecNorm() %G s, VecMDotNorm() %G s\n",(t1-t0)/its,(t2-t1)/its);CHKERRQ(ierr);
+      ierr = PetscGetTime(&t0);CHKERRQ(ierr);
+      for (i=0; i<its; i++) {
+        ierr = VecMAXPY(w,nv,alpha,y);CHKERRQ(ierr);
+        ierr = VecNorm(w,NORM_2,&nrm);CHKERRQ(ierr);
+        ierr = VecScale(w,1.0/nrm);CHKERRQ(ierr);
+      }
+      ierr = PetscGetTime(&t1);CHKERRQ(ierr);
+      for (i=0; i<its; i++) {
+        ierr = VecMAXPYNorm(w,nv,alpha,y,&nrm);CHKERRQ(ierr);
+        ierr = VecScale(w,1.0/nrm);CHKERRQ(ierr);
+      }
+      ierr = PetscGetTime(&t2);CHKERRQ(ierr);
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"  VecMAXPY()+VecNorm() %G s, VecMAXPYNorm() %G s\n",(t1-t0)/its,(t2-t1)/its);CHKERRQ(ierr);
+    }
+  }
+
+  ierr = PetscFree3(dots,fdots,alpha);CHKERRQ(ierr);
+  ierr = VecDestroyVecs(nvs[5],&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  ierr = VecDestroy(&z);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,148 @@
+
+static char help[] = "Tests VecScatterBegin() and VecScatterEnd() with messages between processes on the same node through MPI-3 shared memory, -vecscatter_shared.\n\n\
+  -n <n>        local number of blocks of the parallel vector\n\
+  -nghost <m>   number of blocks each process gathers from the whole vector\n\n";
+
+/*
+   The scatters with and without -vecscatter_shared are compared for block sizes 1, 2 and 3, forward and reverse,
+   with INSERT_VALUES and ADD_VALUES, several times in a row since the shared memory buffers alternate between scatters.
+   With MPI-3 shared windows the private scatter data is read to check that the messages between the processes, which
+   all run on one node, actually went through shared memory.
+*/
+#include <petsc-private/vecimpl.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckEqual"
+static PetscErrorCode CheckEqual(Vec x,Vec y,const char *name,PetscInt bs,PetscInt it)
+{
+  PetscErrorCode ierr;
+  Vec            w;
+  PetscReal      nrm;
+
+  PetscFunctionBegin;
+  ierr = VecDuplicate(x,&w);CHKERRQ(ierr);
+  ierr = VecWAXPY(w,-1.0,x,y);CHKERRQ(ierr);
+  ierr = VecNorm(w,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+  if (nrm > 1.e-12) {ierr = PetscPrintf(PETSC_COMM_SELF,"%s, block size %D, scatter %D: shared memory scatter differs by %G\n",name,bs,it,nrm);CHKERRQ(ierr);}
+  ierr = VecDestroy(&w);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckShared"
+static PetscErrorCode CheckShared(VecScatter scat,PetscInt bs)
+{
+#if defined(PETSC_HAVE_MPI_WIN_ALLOCATE_SHARED)
+  PetscErrorCode         ierr;
+  VecScatter_MPI_General *to = (VecScatter_MPI_General*)scat->todata;
+  PetscInt               cnt[2] = {0,0},gcnt[2];
+#endif
+
+  PetscFunctionBegin;
+  /* without MPI-3 shared windows -vecscatter_shared is ignored and all the messages go through MPI */
+#if defined(PETSC_HAVE_MPI_WIN_ALLOCATE_SHARED)
+  if (to->type == VEC_SCATTER_MPI_GENERAL) {
+    cnt[0] = to->n;
+    cnt[1] = to->use_shared ? to->nshared : 0;
+  }
+  ierr = MPI_Allreduce(cnt,gcnt,2,MPIU_INT,MPI_SUM,((PetscObject)scat)->comm);CHKERRQ(ierr);
+  if (gcnt[1] != gcnt[0]) {ierr = PetscPrintf(((PetscObject)scat)->comm,"Block size %D: only %D of the %D messages went through shared memory\n",bs,gcnt[1],gcnt[0]);CHKERRQ(ierr);}
+#endif
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       n = 50,m = 40,bs,N,i,it,*idx;
+  PetscMPIInt    rank;
+  PetscReal      r;
+  PetscRandom    rand;
+  Vec            x,gx[2],y[2];
+  IS             from,to;
+  VecScatter     scat[2];
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-nghost",&m,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  ierr = PetscMalloc(m*sizeof(PetscInt),&idx);CHKERRQ(ierr);
+
+  for (bs=1; bs<4; bs++) {
+    ierr = VecCreateMPI(PETSC_COMM_WORLD,bs*n,PETSC_DETERMINE,&x);CHKERRQ(ierr);
+    ierr = VecGetSize(x,&N);CHKERRQ(ierr);
+    N   /= bs;
+    ierr = VecDuplicate(x,&gx[0]);CHKERRQ(ierr);
+    ierr = VecDuplicate(x,&gx[1]);CHKERRQ(ierr);
+    ierr = VecCreateSeq(PETSC_COMM_SELF,bs*m,&y[0]);CHKERRQ(ierr);
+    ierr = VecDuplicate(y[0],&y[1]);CHKERRQ(ierr);
+
+    /* blocks of the neighbours, some repeated, and any others */
+    for (i=0; i<m; i++) {
+      if (i%4 == 0)      idx[i] = (rank*n + N - 1 - i/4) % N;
+      else if (i%4 == 1) idx[i] = (rank*n + n + i/4) % N;
+      else if (i%4 == 2) idx[i] = idx[i-1];
+      else {
+        ierr   = PetscRandomGetValueReal(rand,&r);CHKERRQ(ierr);
+        idx[i] = (PetscInt)(r*N);
+      }
+    }
+    ierr = ISCreateBlock(PETSC_COMM_SELF,bs,m,idx,PETSC_COPY_VALUES,&from);CHKERRQ(ierr);
+    ierr = ISCreateStride(PETSC_COMM_SELF,bs*m,0,1,&to);CHKERRQ(ierr);
+    ierr = VecScatterCreate(x,from,y[0],to,&scat[0]);CHKERRQ(ierr);
+    ierr = PetscOptionsSetValue("-vecscatter_shared",PETSC_NULL);CHKERRQ(ierr);
+    ierr = VecScatterCreate(x,from,y[1],to,&scat[1]);CHKERRQ(ierr);
+    ierr = PetscOptionsClearValue("-vecscatter_shared");CHKERRQ(ierr);
+    ierr = CheckShared(scat[1],bs);CHKERRQ(ierr);
+    ierr = ISDestroy(&from);CHKERRQ(ierr);
+    ierr = ISDestroy(&to);CHKERRQ(ierr);
+
+    for (it=0; it<3; it++) {
+      ierr = VecSetRandom(x,rand);CHKERRQ(ierr);
+      for (i=0; i<2; i++) {
+        ierr = VecSet(y[i],1.0);CHKERRQ(ierr);
+        ierr = VecScatterBegin(scat[i],x,y[i],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+        ierr = VecScatterEnd(scat[i],x,y[i],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      }
+      ierr = CheckEqual(y[0],y[1],"forward, INSERT_VALUES",bs,it);CHKERRQ(ierr);
+
+      for (i=0; i<2; i++) {
+        ierr = VecScatterBegin(scat[i],x,y[i],ADD_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+        ierr = VecScatterEnd(scat[i],x,y[i],ADD_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      }
+      ierr = CheckEqual(y[0],y[1],"forward, ADD_VALUES",bs,it);CHKERRQ(ierr);
+
+      /* the messages are unpacked in a different order with shared memory, so the sums may differ by roundoff */
+      for (i=0; i<2; i++) {
+        ierr = VecCopy(x,gx[i]);CHKERRQ(ierr);
+        ierr = VecScatterBegin(scat[i],y[i],gx[i],ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+        ierr = VecScatterEnd(scat[i],y[i],gx[i],ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+      }
+      ierr = CheckEqual(gx[0],gx[1],"reverse, ADD_VALUES",bs,it);CHKERRQ(ierr);
+
+      for (i=0; i<2; i++) {
+        ierr = VecScatterBegin(scat[i],y[i],gx[i],INSERT_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+        ierr = VecScatterEnd(scat[i],y[i],gx[i],INSERT_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+      }
+      ierr = CheckEqual(gx[0],gx[1],"reverse, INSERT_VALUES",bs,it);CHKERRQ(ierr);
+    }
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Block size %D: checked\n",bs);CHKERRQ(ierr);
+
+    ierr = VecScatterDestroy(&scat[0]);CHKERRQ(ierr);
+    ierr = VecScatterDestroy(&scat[1]);CHKERRQ(ierr);
+    ierr = VecDestroy(&x);CHKERRQ(ierr);
+    ierr = VecDestroy(&gx[0]);CHKERRQ(ierr);
+    ierr = VecDestroy(&gx[1]);CHKERRQ(ierr);
+    ierr = VecDestroy(&y[0]);CHKERRQ(ierr);
+    ierr = VecDestroy(&y[1]);CHKERRQ(ierr);
+  }
+
+  ierr = PetscFree(idx);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
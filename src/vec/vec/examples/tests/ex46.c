@@ -0,0 +1,114 @@
+
+static char help[] = "Tests VecScatterBegin() and VecScatterEnd() from a parallel vector for block sizes without their own kernels, and with\n\
+the messages packed as runs of blocks, -vecscatter_runs.\n\n\
+  -n <n>        local number of blocks of the parallel vector\n\n";
+
+/*
+   Each process gathers contiguous and strided ranges of blocks, repeated blocks and random blocks. The forward scatter is
+   checked against the whole vector, the reverse scatter with and without runs against each other.
+*/
+#include <petscvec.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode    ierr;
+  PetscInt          n = 40,bss[7] = {1,2,3,5,10,12,15},b,bs,N,m,i,j,k,*idx;
+  PetscMPIInt       rank,size;
+  PetscReal         r,nrm,err;
+  PetscRandom       rand;
+  Vec               x,xall,gx[3],y[3],w;
+  IS                from,to;
+  VecScatter        scat[3],toall;
+  const PetscScalar *xa,*ya;
+  const char        *runs[3] = {"false","true",PETSC_NULL};
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  N    = n*size;
+  ierr = PetscMalloc(4*N*sizeof(PetscInt),&idx);CHKERRQ(ierr);
+
+  for (b=0; b<7; b++) {
+    bs   = bss[b];
+    ierr = VecCreateMPI(PETSC_COMM_WORLD,bs*n,PETSC_DETERMINE,&x);CHKERRQ(ierr);
+
+    /* the blocks of the next process, every third block of the previous one, repeated and random blocks */
+    m = 0;
+    for (i=0; i<n; i++) idx[m++] = (((rank+1)%size)*n + i) % N;
+    for (i=0; i<n; i+=3) idx[m++] = (((rank+size-1)%size)*n + i) % N;
+    for (i=0; i<n/4; i++) {
+      idx[m] = idx[m-1]; m++;
+      ierr   = PetscRandomGetValueReal(rand,&r);CHKERRQ(ierr);
+      idx[m++] = (PetscInt)(r*N);
+    }
+    for (i=n/2; i>n/4; i--) idx[m++] = (rank*n + i) % N;
+
+    ierr = ISCreateBlock(PETSC_COMM_SELF,bs,m,idx,PETSC_COPY_VALUES,&from);CHKERRQ(ierr);
+    ierr = ISCreateStride(PETSC_COMM_SELF,bs*m,0,1,&to);CHKERRQ(ierr);
+    for (k=0; k<3; k++) {
+      ierr = VecCreateSeq(PETSC_COMM_SELF,bs*m,&y[k]);CHKERRQ(ierr);
+      ierr = VecDuplicate(x,&gx[k]);CHKERRQ(ierr);
+      if (runs[k]) {ierr = PetscOptionsSetValue("-vecscatter_runs",runs[k]);CHKERRQ(ierr);}
+      ierr = VecScatterCreate(x,from,y[k],to,&scat[k]);CHKERRQ(ierr);
+      ierr = PetscOptionsClearValue("-vecscatter_runs");CHKERRQ(ierr);
+    }
+    ierr = ISDestroy(&from);CHKERRQ(ierr);
+    ierr = ISDestroy(&to);CHKERRQ(ierr);
+    ierr = VecScatterCreateToAll(x,&toall,&xall);CHKERRQ(ierr);
+
+    ierr = VecSetRandom(x,rand);CHKERRQ(ierr);
+    ierr = VecScatterBegin(toall,x,xall,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    ierr = VecScatterEnd(toall,x,xall,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    ierr = VecGetArrayRead(xall,&xa);CHKERRQ(ierr);
+    for (k=0; k<3; k++) {
+      ierr = VecScatterBegin(scat[k],x,y[k],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      ierr = VecScatterEnd(scat[k],x,y[k],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      ierr = VecScatterBegin(scat[k],x,y[k],ADD_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      ierr = VecScatterEnd(scat[k],x,y[k],ADD_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      ierr = VecGetArrayRead(y[k],&ya);CHKERRQ(ierr);
+      err  = 0.0;
+      for (i=0; i<m; i++) {
+        for (j=0; j<bs; j++) err = PetscMax(err,PetscAbsScalar(ya[i*bs+j]-2.0*xa[idx[i]*bs+j]));
+      }
+      ierr = VecRestoreArrayRead(y[k],&ya);CHKERRQ(ierr);
+      if (err > 1.e-14) {ierr = PetscPrintf(PETSC_COMM_SELF,"[%d] block size %D, runs %s: forward scatter differs by %G\n",rank,bs,runs[k] ? runs[k] : "default",err);CHKERRQ(ierr);}
+    }
+    ierr = VecRestoreArrayRead(xall,&xa);CHKERRQ(ierr);
+
+    /* the blocks received from several processes may be summed in a different order */
+    for (k=0; k<3; k++) {
+      ierr = VecCopy(x,gx[k]);CHKERRQ(ierr);
+      ierr = VecScatterBegin(scat[k],y[k],gx[k],ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+      ierr = VecScatterEnd(scat[k],y[k],gx[k],ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+      ierr = VecScatterBegin(scat[k],y[k],gx[k],MAX_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+      ierr = VecScatterEnd(scat[k],y[k],gx[k],MAX_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+    }
+    ierr = VecDuplicate(x,&w);CHKERRQ(ierr);
+    for (k=1; k<3; k++) {
+      ierr = VecWAXPY(w,-1.0,gx[0],gx[k]);CHKERRQ(ierr);
+      ierr = VecNorm(w,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+      if (nrm > 1.e-12) {ierr = PetscPrintf(PETSC_COMM_WORLD,"Block size %D, runs %s: reverse scatter differs by %G\n",bs,runs[k] ? runs[k] : "default",nrm);CHKERRQ(ierr);}
+    }
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Block size %D: checked\n",bs);CHKERRQ(ierr);
+
+    ierr = VecDestroy(&w);CHKERRQ(ierr);
+    for (k=0; k<3; k++) {
+      ierr = VecScatterDestroy(&scat[k]);CHKERRQ(ierr);
+      ierr = VecDestroy(&y[k]);CHKERRQ(ierr);
+      ierr = VecDestroy(&gx[k]);CHKERRQ(ierr);
+    }
+    ierr = VecScatterDestroy(&toall);CHKERRQ(ierr);
+    ierr = VecDestroy(&xall);CHKERRQ(ierr);
+    ierr = VecDestroy(&x);CHKERRQ(ierr);
+  }
+
+  ierr = PetscFree(idx);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
@@ -0,0 +1,122 @@
+
+static char help[] = "Tests VecScatterBeginMulti() and VecScatterEndMulti(), the scatter of several vectors at once.\n\n\
+  -n <n>        local number of blocks of the parallel vectors\n\
+  -k <k>        number of vectors scattered together\n\n";
+
+/*
+   The scatter of k vectors at once is compared with k scatters of one vector, for several block sizes, forward and
+   reverse, with INSERT_VALUES and ADD_VALUES. A second scatter with fewer vectors reuses the message buffers.
+*/
+#include <petscvec.h>
+
+#undef __FUNCT__
+#define __FUNCT__ "CheckEqual"
+static PetscErrorCode CheckEqual(PetscInt k,Vec x[],Vec y[],const char *name,PetscInt bs)
+{
+  PetscErrorCode ierr;
+  PetscInt       j;
+  Vec            w;
+  PetscReal      nrm;
+
+  PetscFunctionBegin;
+  for (j=0; j<k; j++) {
+    ierr = VecDuplicate(x[j],&w);CHKERRQ(ierr);
+    ierr = VecWAXPY(w,-1.0,x[j],y[j]);CHKERRQ(ierr);
+    ierr = VecNorm(w,NORM_INFINITY,&nrm);CHKERRQ(ierr);
+    if (nrm > 1.e-12) {ierr = PetscPrintf(PETSC_COMM_SELF,"%s, block size %D, vector %D: scatter of several vectors differs by %G\n",name,bs,j,nrm);CHKERRQ(ierr);}
+    ierr = VecDestroy(&w);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "main"
+int main(int argc,char **argv)
+{
+  PetscErrorCode ierr;
+  PetscInt       n = 20,k = 4,bss[4] = {1,2,3,7},b,bs,N,m,i,j,kk,*idx;
+  PetscMPIInt    rank,size;
+  PetscReal      r;
+  PetscRandom    rand;
+  Vec            x,yl,*gx[2],*y[2];
+  IS             from,to;
+  VecScatter     scat;
+
+  PetscInitialize(&argc,&argv,(char*)0,help);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-n",&n,PETSC_NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(PETSC_NULL,"-k",&k,PETSC_NULL);CHKERRQ(ierr);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = MPI_Comm_size(PETSC_COMM_WORLD,&size);CHKERRQ(ierr);
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand);CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand);CHKERRQ(ierr);
+  N    = n*size;
+  ierr = PetscMalloc(2*N*sizeof(PetscInt),&idx);CHKERRQ(ierr);
+
+  for (b=0; b<4; b++) {
+    bs   = bss[b];
+    ierr = VecCreateMPI(PETSC_COMM_WORLD,bs*n,PETSC_DETERMINE,&x);CHKERRQ(ierr);
+
+    /* the blocks of the next process, some of this process, some repeated and random ones */
+    m = 0;
+    for (i=0; i<n; i+=2) idx[m++] = (((rank+1)%size)*n + i) % N;
+    for (i=0; i<n; i+=5) idx[m++] = rank*n + i;
+    for (i=0; i<n/4; i++) {
+      idx[m] = idx[m-1]; m++;
+      ierr   = PetscRandomGetValueReal(rand,&r);CHKERRQ(ierr);
+      idx[m++] = (PetscInt)(r*N);
+    }
+    ierr = ISCreateBlock(PETSC_COMM_SELF,bs,m,idx,PETSC_COPY_VALUES,&from);CHKERRQ(ierr);
+    ierr = ISCreateStride(PETSC_COMM_SELF,bs*m,0,1,&to);CHKERRQ(ierr);
+    ierr = VecCreateSeq(PETSC_COMM_SELF,bs*m,&yl);CHKERRQ(ierr);
+    ierr = VecScatterCreate(x,from,yl,to,&scat);CHKERRQ(ierr);
+    ierr = ISDestroy(&from);CHKERRQ(ierr);
+    ierr = ISDestroy(&to);CHKERRQ(ierr);
+    for (i=0; i<2; i++) {
+      ierr = VecDuplicateVecs(x,k,&gx[i]);CHKERRQ(ierr);
+      ierr = VecDuplicateVecs(yl,k,&y[i]);CHKERRQ(ierr);
+    }
+    for (j=0; j<k; j++) {
+      ierr = VecSetRandom(gx[0][j],rand);CHKERRQ(ierr);
+      ierr = VecCopy(gx[0][j],gx[1][j]);CHKERRQ(ierr);
+      ierr = VecSet(y[0][j],1.0);CHKERRQ(ierr);
+      ierr = VecSet(y[1][j],1.0);CHKERRQ(ierr);
+    }
+
+    /* all k vectors, then the first k-1 vectors again with the buffers of the first scatter */
+    for (kk=k; kk>=k-1 && kk>0; kk--) {
+      for (j=0; j<kk; j++) {
+        ierr = VecScatterBegin(scat,gx[0][j],y[0][j],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+        ierr = VecScatterEnd(scat,gx[0][j],y[0][j],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+        ierr = VecScatterBegin(scat,gx[0][j],y[0][j],ADD_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+        ierr = VecScatterEnd(scat,gx[0][j],y[0][j],ADD_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      }
+      ierr = VecScatterBeginMulti(scat,kk,gx[1],y[1],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      ierr = VecScatterEndMulti(scat,kk,gx[1],y[1],INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      ierr = VecScatterBeginMulti(scat,kk,gx[1],y[1],ADD_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      ierr = VecScatterEndMulti(scat,kk,gx[1],y[1],ADD_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+      ierr = CheckEqual(k,y[0],y[1],"forward",bs);CHKERRQ(ierr);
+
+      for (j=0; j<kk; j++) {
+        ierr = VecScatterBegin(scat,y[0][j],gx[0][j],ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+        ierr = VecScatterEnd(scat,y[0][j],gx[0][j],ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+      }
+      ierr = VecScatterBeginMulti(scat,kk,y[1],gx[1],ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+      ierr = VecScatterEndMulti(scat,kk,y[1],gx[1],ADD_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+      ierr = CheckEqual(k,gx[0],gx[1],"reverse",bs);CHKERRQ(ierr);
+    }
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Block size %D: checked\n",bs);CHKERRQ(ierr);
+
+    ierr = VecScatterDestroy(&scat);CHKERRQ(ierr);
+    ierr = VecDestroy(&yl);CHKERRQ(ierr);
+    ierr = VecDestroy(&x);CHKERRQ(ierr);
+    for (i=0; i<2; i++) {
+      ierr = VecDestroyVecs(k,&gx[i]);CHKERRQ(ierr);
+      ierr = VecDestroyVecs(k,&y[i]);CHKERRQ(ierr);
+    }
+  }
+
+  ierr = PetscFree(idx);CHKERRQ(ierr);
+  ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return 0;
+}
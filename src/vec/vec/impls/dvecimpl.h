@@ -20,6 +20,8 @@ extern PetscErrorCode VecMTDot_Seq(Vec,PetscInt,const Vec[],PetscScalar *);
 extern PetscErrorCode VecMin_Seq(Vec,PetscInt*,PetscReal *);
 extern PetscErrorCode VecSet_Seq(Vec,PetscScalar);
 extern PetscErrorCode VecMAXPY_Seq(Vec,PetscInt,const PetscScalar *,Vec *);
+extern PetscErrorCode VecMDotNorm_Seq(Vec,PetscInt,const Vec[],PetscScalar *,PetscReal *);
+extern PetscErrorCode VecMAXPYNorm_Seq(Vec,PetscInt,const PetscScalar *,Vec *,PetscReal *);
 extern PetscErrorCode VecAYPX_Seq(Vec,PetscScalar,Vec);
 extern PetscErrorCode VecWAXPY_Seq(Vec,PetscScalar,Vec,Vec);
 extern PetscErrorCode VecAXPBYPCZ_Seq(Vec,PetscScalar,PetscScalar,PetscScalar,Vec,Vec);
@@ -204,6 +204,8 @@ PetscErrorCode  VecCreate_MPICUSP(Vec vv)
   vv->ops->axpy            = VecAXPY_SeqCUSP;
   vv->ops->axpby           = VecAXPBY_SeqCUSP;
   vv->ops->maxpy           = VecMAXPY_SeqCUSP;
+  vv->ops->mdotnorm        = 0;
+  vv->ops->maxpynorm       = 0;
   vv->ops->aypx            = VecAYPX_SeqCUSP;
   vv->ops->axpbypcz        = VecAXPBYPCZ_SeqCUSP;
   vv->ops->pointwisemult   = VecPointwiseMult_SeqCUSP;
@@ -159,7 +159,12 @@ static struct _VecOps DvOps = { VecDuplicate_MPI, /* 1 */
             0,
             0,
             VecStrideGather_Default,
-            VecStrideScatter_Default
+            VecStrideScatter_Default,
+            0,
+            0,
+            0,
+            VecMDotNorm_MPI,
+            VecMAXPYNorm_MPI
 };
 
 #undef __FUNCT__
@@ -43,6 +43,45 @@ PetscErrorCode VecMTDot_MPI(Vec xin,PetscInt nv,const Vec y[],PetscScalar *z)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "VecMDotNorm_MPI"
+PetscErrorCode VecMDotNorm_MPI(Vec xin,PetscInt nv,const Vec y[],PetscScalar *z,PetscReal *xnorm)
+{
+  PetscScalar    awork[129],asum[129],*work = awork,*sum = asum;
+  PetscReal      nrm;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (nv > 128) {
+    ierr = PetscMalloc2(nv+1,PetscScalar,&work,nv+1,PetscScalar,&sum);CHKERRQ(ierr);
+  }
+  ierr = VecMDotNorm_Seq(xin,nv,y,work,&nrm);CHKERRQ(ierr);
+  /* the dot products and the norm share a single reduction */
+  work[nv] = nrm*nrm;
+  ierr = MPI_Allreduce(work,sum,nv+1,MPIU_SCALAR,MPIU_SUM,((PetscObject)xin)->comm);CHKERRQ(ierr);
+  ierr = PetscMemcpy(z,sum,nv*sizeof(PetscScalar));CHKERRQ(ierr);
+  *xnorm = PetscSqrtReal(PetscRealPart(sum[nv]));
+  if (nv > 128) {
+    ierr = PetscFree2(work,sum);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecMAXPYNorm_MPI"
+PetscErrorCode VecMAXPYNorm_MPI(Vec xin,PetscInt nv,const PetscScalar *alpha,Vec *y,PetscReal *xnorm)
+{
+  PetscReal      work,sum;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecMAXPYNorm_Seq(xin,nv,alpha,y,&work);CHKERRQ(ierr);
+  work = work*work;
+  ierr = MPI_Allreduce(&work,&sum,1,MPIU_REAL,MPIU_SUM,((PetscObject)xin)->comm);CHKERRQ(ierr);
+  *xnorm = PetscSqrtReal(sum);
+  PetscFunctionReturn(0);
+}
+
 #include <../src/vec/vec/impls/seq/ftn-kernels/fnorm.h>
 #undef __FUNCT__
 #define __FUNCT__ "VecNorm_MPI"
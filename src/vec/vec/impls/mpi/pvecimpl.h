@@ -22,6 +22,8 @@ extern PetscErrorCode VecMDot_MPI(Vec,PetscInt,const Vec[],PetscScalar *);
 extern PetscErrorCode VecTDot_MPI(Vec,Vec,PetscScalar *);
 extern PetscErrorCode VecMTDot_MPI(Vec,PetscInt,const Vec[],PetscScalar *);
 extern PetscErrorCode VecNorm_MPI(Vec,NormType,PetscReal *);
+extern PetscErrorCode VecMDotNorm_MPI(Vec,PetscInt,const Vec[],PetscScalar *,PetscReal *);
+extern PetscErrorCode VecMAXPYNorm_MPI(Vec,PetscInt,const PetscScalar *,Vec *,PetscReal *);
 extern PetscErrorCode VecMax_MPI(Vec,PetscInt *,PetscReal *);
 extern PetscErrorCode VecMin_MPI(Vec,PetscInt *,PetscReal *);
 extern PetscErrorCode VecDestroy_MPI(Vec);
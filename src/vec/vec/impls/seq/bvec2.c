@@ -1240,7 +1240,12 @@ static struct _VecOps DvOps = {VecDuplicate_Seq, /* 1 */
             0,
             0,
             VecStrideGather_Default,
-            VecStrideScatter_Default
+            VecStrideScatter_Default,
+            0,
+            0,
+            0,
+            VecMDotNorm_Seq,
+            VecMAXPYNorm_Seq
           };
 
 
@@ -904,6 +904,295 @@ PetscErrorCode VecMAXPY_Seq(Vec xin, PetscInt nv,const PetscScalar *alpha,Vec *y
 }
 #endif
 
+/*
+   The fused kernels used by the GMRES orthogonalization: they go over x in tiles small
+   enough to stay in the first level cache, so that x is loaded from memory only once while
+   all the y vectors stream through, instead of once for each group of four y vectors and
+   once more for the norm.
+*/
+#define VEC_FUSED_TILE 1024
+
+/* x'conj(x) on the entries start <= i < end, in independent partial sums so that the additions overlap */
+PETSC_STATIC_INLINE PetscReal VecNorm2_Tile(PetscInt start,PetscInt end,const PetscScalar *x)
+{
+  PetscInt  i;
+  PetscReal sum0 = 0.0,sum1 = 0.0,sum2 = 0.0,sum3 = 0.0;
+
+  for (i=start; i+4<=end; i+=4) {
+    sum0 += PetscRealPart(x[i]*PetscConj(x[i]));
+    sum1 += PetscRealPart(x[i+1]*PetscConj(x[i+1]));
+    sum2 += PetscRealPart(x[i+2]*PetscConj(x[i+2]));
+    sum3 += PetscRealPart(x[i+3]*PetscConj(x[i+3]));
+  }
+  for (; i<end; i++) sum0 += PetscRealPart(x[i]*PetscConj(x[i]));
+  return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/* z[j] = x'conj(y[j]) and nrm = x'conj(x) on the entries start <= i < end */
+static void VecMDotNorm_Tiled(PetscInt start,PetscInt end,const PetscScalar *x,PetscInt nv,const PetscScalar **y,PetscScalar *z,PetscReal *nrm)
+{
+  PetscInt          i,j,t,tend;
+  PetscScalar       sum0,sum1,sum2,sum3,xi;
+  PetscReal         sum = 0.0;
+  const PetscScalar *yy0,*yy1,*yy2,*yy3;
+
+  for (j=0; j<nv; j++) z[j] = 0.0;
+  for (t=start; t<end; t+=VEC_FUSED_TILE) {
+    tend = PetscMin(t+VEC_FUSED_TILE,end);
+    sum += VecNorm2_Tile(t,tend,x);
+    for (j=0; j+4<=nv; j+=4) {
+      yy0 = y[j]; yy1 = y[j+1]; yy2 = y[j+2]; yy3 = y[j+3];
+      sum0 = sum1 = sum2 = sum3 = 0.0;
+      for (i=t; i<tend; i++) {
+        xi    = x[i];
+        sum0 += xi*PetscConj(yy0[i]);
+        sum1 += xi*PetscConj(yy1[i]);
+        sum2 += xi*PetscConj(yy2[i]);
+        sum3 += xi*PetscConj(yy3[i]);
+      }
+      z[j] += sum0; z[j+1] += sum1; z[j+2] += sum2; z[j+3] += sum3;
+    }
+    switch (nv-j) {
+    case 3:
+      yy0 = y[j]; yy1 = y[j+1]; yy2 = y[j+2];
+      sum0 = sum1 = sum2 = 0.0;
+      for (i=t; i<tend; i++) {
+        xi    = x[i];
+        sum0 += xi*PetscConj(yy0[i]);
+        sum1 += xi*PetscConj(yy1[i]);
+        sum2 += xi*PetscConj(yy2[i]);
+      }
+      z[j] += sum0; z[j+1] += sum1; z[j+2] += sum2;
+      break;
+    case 2:
+      yy0 = y[j]; yy1 = y[j+1];
+      sum0 = sum1 = 0.0;
+      for (i=t; i<tend; i++) {
+        xi    = x[i];
+        sum0 += xi*PetscConj(yy0[i]);
+        sum1 += xi*PetscConj(yy1[i]);
+      }
+      z[j] += sum0; z[j+1] += sum1;
+      break;
+    case 1:
+      yy0  = y[j];
+      sum0 = 0.0;
+      for (i=t; i<tend; i++) sum0 += x[i]*PetscConj(yy0[i]);
+      z[j] += sum0;
+      break;
+    }
+  }
+  *nrm = sum;
+}
+
+/* x = x + sum alpha[j] y[j] and nrm = x'conj(x) on the entries start <= i < end */
+static void VecMAXPYNorm_Tiled(PetscInt start,PetscInt end,PetscScalar *x,PetscInt nv,const PetscScalar *alpha,const PetscScalar **y,PetscReal *nrm)
+{
+  PetscInt          i,j,t,tend;
+  PetscScalar       alpha0,alpha1,alpha2,alpha3;
+  PetscReal         sum = 0.0;
+  const PetscScalar *yy0,*yy1,*yy2,*yy3;
+
+#if defined(PETSC_HAVE_PRAGMA_DISJOINT)
+#pragma disjoint(*x,*yy0,*yy1,*yy2,*yy3,*alpha)
+#endif
+  for (t=start; t<end; t+=VEC_FUSED_TILE) {
+    tend = PetscMin(t+VEC_FUSED_TILE,end);
+    for (j=0; j+4<=nv; j+=4) {
+      yy0 = y[j]; yy1 = y[j+1]; yy2 = y[j+2]; yy3 = y[j+3];
+      alpha0 = alpha[j]; alpha1 = alpha[j+1]; alpha2 = alpha[j+2]; alpha3 = alpha[j+3];
+      for (i=t; i<tend; i++) x[i] += alpha0*yy0[i] + alpha1*yy1[i] + alpha2*yy2[i] + alpha3*yy3[i];
+    }
+    switch (nv-j) {
+    case 3:
+      yy0 = y[j]; yy1 = y[j+1]; yy2 = y[j+2];
+      alpha0 = alpha[j]; alpha1 = alpha[j+1]; alpha2 = alpha[j+2];
+      for (i=t; i<tend; i++) x[i] += alpha0*yy0[i] + alpha1*yy1[i] + alpha2*yy2[i];
+      break;
+    case 2:
+      yy0 = y[j]; yy1 = y[j+1];
+      alpha0 = alpha[j]; alpha1 = alpha[j+1];
+      for (i=t; i<tend; i++) x[i] += alpha0*yy0[i] + alpha1*yy1[i];
+      break;
+    case 1:
+      yy0 = y[j]; alpha0 = alpha[j];
+      for (i=t; i<tend; i++) x[i] += alpha0*yy0[i];
+      break;
+    }
+    sum += VecNorm2_Tile(t,tend,x);
+  }
+  *nrm = sum;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecGetArraysRead_Private"
+static PetscErrorCode VecGetArraysRead_Private(PetscInt nv,const Vec y[],const PetscScalar **yy)
+{
+  PetscErrorCode ierr;
+  PetscInt       j;
+
+  PetscFunctionBegin;
+  for (j=0; j<nv; j++) {ierr = VecGetArrayRead(y[j],&yy[j]);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecRestoreArraysRead_Private"
+static PetscErrorCode VecRestoreArraysRead_Private(PetscInt nv,const Vec y[],const PetscScalar **yy)
+{
+  PetscErrorCode ierr;
+  PetscInt       j;
+
+  PetscFunctionBegin;
+  for (j=0; j<nv; j++) {ierr = VecRestoreArrayRead(y[j],&yy[j]);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
+#if defined(PETSC_THREADCOMM_ACTIVE)
+PetscErrorCode VecMDotNorm_kernel(PetscInt thread_id,Vec xin,PetscInt *nvp,const PetscScalar **yy,PetscThreadCommReduction red)
+{
+  PetscErrorCode    ierr;
+  PetscInt          *trstarts=xin->map->trstarts,nv=*nvp,j;
+  const PetscScalar *xx;
+  PetscScalar       z[PETSC_REDUCTIONS_MAX];
+  PetscReal         nrm;
+
+  ierr = VecGetArrayRead(xin,&xx);CHKERRQ(ierr);
+  VecMDotNorm_Tiled(trstarts[thread_id],trstarts[thread_id+1],xx,nv,yy,z,&nrm);
+  ierr = VecRestoreArrayRead(xin,&xx);CHKERRQ(ierr);
+  z[nv] = nrm;
+  for (j=0; j<=nv; j++) {
+    ierr = PetscThreadReductionKernelPost(thread_id,red,&z[j]);CHKERRQ(ierr);
+  }
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecMDotNorm_Seq"
+PetscErrorCode VecMDotNorm_Seq(Vec xin,PetscInt nv,const Vec yin[],PetscScalar *z,PetscReal *xnorm)
+{
+  PetscErrorCode           ierr;
+  PetscThreadCommReduction red;
+  const PetscScalar        *ayy[PETSC_REDUCTIONS_MAX],**yy = ayy;
+  PetscScalar              nrm;
+  PetscInt                 *nvp,nfirst,j;
+
+  PetscFunctionBegin;
+  /* the norm and the last dot products are computed in one sweep, within the number of reductions the threads can carry */
+  nfirst = PetscMax(nv-(PETSC_REDUCTIONS_MAX-1),0);
+  if (nfirst) {ierr = VecMDot_Seq(xin,nfirst,yin,z);CHKERRQ(ierr);}
+  nv  -= nfirst;
+  yin += nfirst;
+  z   += nfirst;
+  ierr = VecGetArraysRead_Private(nv,yin,yy);CHKERRQ(ierr);
+  ierr = PetscThreadCommGetInts(((PetscObject)xin)->comm,&nvp,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+  *nvp = nv;
+  ierr = PetscThreadReductionBegin(((PetscObject)xin)->comm,THREADCOMM_SUM,PETSC_SCALAR,nv+1,&red);CHKERRQ(ierr);
+  ierr = PetscThreadCommRunKernel4(((PetscObject)xin)->comm,(PetscThreadKernel)VecMDotNorm_kernel,xin,nvp,(void*)yy,red);CHKERRQ(ierr);
+  for (j=0; j<nv; j++) {
+    ierr = PetscThreadReductionEnd(red,&z[j]);CHKERRQ(ierr);
+  }
+  ierr = PetscThreadReductionEnd(red,&nrm);CHKERRQ(ierr);
+  ierr = VecRestoreArraysRead_Private(nv,yin,yy);CHKERRQ(ierr);
+  *xnorm = PetscSqrtReal(PetscRealPart(nrm));
+  ierr = PetscLogFlops(2.0*(nv+1)*xin->map->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode VecMAXPYNorm_kernel(PetscInt thread_id,Vec xin,PetscInt *nvp,const PetscScalar *alpha,const PetscScalar **yy,PetscThreadCommReduction red)
+{
+  PetscErrorCode ierr;
+  PetscInt       *trstarts=xin->map->trstarts;
+  PetscScalar    *xx;
+  PetscReal      nrm;
+
+  ierr = VecGetArray(xin,&xx);CHKERRQ(ierr);
+  VecMAXPYNorm_Tiled(trstarts[thread_id],trstarts[thread_id+1],xx,*nvp,alpha,yy,&nrm);
+  ierr = VecRestoreArray(xin,&xx);CHKERRQ(ierr);
+  ierr = PetscThreadReductionKernelPost(thread_id,red,&nrm);CHKERRQ(ierr);
+  return 0;
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecMAXPYNorm_Seq"
+PetscErrorCode VecMAXPYNorm_Seq(Vec xin,PetscInt nv,const PetscScalar *alpha,Vec *y,PetscReal *xnorm)
+{
+  PetscErrorCode           ierr;
+  PetscThreadCommReduction red;
+  const PetscScalar        *ayy[128],**yy = ayy;
+  PetscInt                 *nvp;
+
+  PetscFunctionBegin;
+  if (nv > 128) {
+    ierr = PetscMalloc(nv*sizeof(PetscScalar*),&yy);CHKERRQ(ierr);
+  }
+  ierr = VecGetArraysRead_Private(nv,y,yy);CHKERRQ(ierr);
+  ierr = PetscThreadCommGetInts(((PetscObject)xin)->comm,&nvp,PETSC_NULL,PETSC_NULL);CHKERRQ(ierr);
+  *nvp = nv;
+  ierr = PetscThreadReductionBegin(((PetscObject)xin)->comm,THREADCOMM_SUM,PETSC_REAL,1,&red);CHKERRQ(ierr);
+  ierr = PetscThreadCommRunKernel(((PetscObject)xin)->comm,(PetscThreadKernel)VecMAXPYNorm_kernel,5,xin,nvp,(void*)alpha,(void*)yy,red);CHKERRQ(ierr);
+  ierr = PetscThreadReductionEnd(red,xnorm);CHKERRQ(ierr);
+  ierr = VecRestoreArraysRead_Private(nv,y,yy);CHKERRQ(ierr);
+  if (nv > 128) {
+    ierr = PetscFree(yy);CHKERRQ(ierr);
+  }
+  *xnorm = PetscSqrtReal(*xnorm);
+  ierr = PetscLogFlops(2.0*(nv+1)*xin->map->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#else
+#undef __FUNCT__
+#define __FUNCT__ "VecMDotNorm_Seq"
+PetscErrorCode VecMDotNorm_Seq(Vec xin,PetscInt nv,const Vec yin[],PetscScalar *z,PetscReal *xnorm)
+{
+  PetscErrorCode    ierr;
+  const PetscScalar *xx,*ayy[128],**yy = ayy;
+  PetscInt          n = xin->map->n;
+
+  PetscFunctionBegin;
+  if (nv > 128) {
+    ierr = PetscMalloc(nv*sizeof(PetscScalar*),&yy);CHKERRQ(ierr);
+  }
+  ierr = VecGetArrayRead(xin,&xx);CHKERRQ(ierr);
+  ierr = VecGetArraysRead_Private(nv,yin,yy);CHKERRQ(ierr);
+  VecMDotNorm_Tiled(0,n,xx,nv,yy,z,xnorm);
+  ierr = VecRestoreArraysRead_Private(nv,yin,yy);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xin,&xx);CHKERRQ(ierr);
+  if (nv > 128) {
+    ierr = PetscFree(yy);CHKERRQ(ierr);
+  }
+  *xnorm = PetscSqrtReal(*xnorm);
+  ierr = PetscLogFlops(2.0*(nv+1)*n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecMAXPYNorm_Seq"
+PetscErrorCode VecMAXPYNorm_Seq(Vec xin,PetscInt nv,const PetscScalar *alpha,Vec *y,PetscReal *xnorm)
+{
+  PetscErrorCode    ierr;
+  PetscScalar       *xx;
+  const PetscScalar *ayy[128],**yy = ayy;
+  PetscInt          n = xin->map->n;
+
+  PetscFunctionBegin;
+  if (nv > 128) {
+    ierr = PetscMalloc(nv*sizeof(PetscScalar*),&yy);CHKERRQ(ierr);
+  }
+  ierr = VecGetArray(xin,&xx);CHKERRQ(ierr);
+  ierr = VecGetArraysRead_Private(nv,y,yy);CHKERRQ(ierr);
+  VecMAXPYNorm_Tiled(0,n,xx,nv,alpha,yy,xnorm);
+  ierr = VecRestoreArraysRead_Private(nv,y,yy);CHKERRQ(ierr);
+  ierr = VecRestoreArray(xin,&xx);CHKERRQ(ierr);
+  if (nv > 128) {
+    ierr = PetscFree(yy);CHKERRQ(ierr);
+  }
+  *xnorm = PetscSqrtReal(*xnorm);
+  ierr = PetscLogFlops(2.0*(nv+1)*n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
 #include <../src/vec/vec/impls/seq/ftn-kernels/faypx.h>
 #if defined(PETSC_THREADCOMM_ACTIVE)
 PetscErrorCode VecAYPX_kernel(PetscInt thread_id,Vec yin,PetscScalar *alpha_p,Vec xin)
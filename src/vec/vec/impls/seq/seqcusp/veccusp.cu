@@ -1931,6 +1931,8 @@ PetscErrorCode  VecCreate_SeqCUSP(Vec V)
   V->ops->mdot_local      = VecMDot_SeqCUSP;
   V->ops->maxpy           = VecMAXPY_SeqCUSP;
   V->ops->mdot            = VecMDot_SeqCUSP;
+  V->ops->mdotnorm        = 0;
+  V->ops->maxpynorm       = 0;
   V->ops->aypx            = VecAYPX_SeqCUSP;
   V->ops->waxpy           = VecWAXPY_SeqCUSP;
   V->ops->dotnorm2        = VecDotNorm2_SeqCUSP;
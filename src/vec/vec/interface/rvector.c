@@ -1244,6 +1244,130 @@ PetscErrorCode  VecMAXPY(Vec y,PetscInt nv,const PetscScalar alpha[],Vec x[])
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "VecMDotNorm"
+/*@
+   VecMDotNorm - Computes vector multiple dot products and the 2-norm of the first vector,
+   with one pass over the entries of x and a single reduction.
+
+   Collective on Vec
+
+   Input Parameters:
++  x - one vector
+.  nv - number of vectors
+-  y - array of vectors.
+
+   Output Parameters:
++  val - array of the dot products (does not allocate the array)
+-  xnorm - the 2-norm of x
+
+   Notes:
+   The dot products are computed as in VecMDot(), val = y^H x.  The norm is cached
+   with the vector, so a later VecNorm() of x with NORM_2 does not communicate.
+
+   Level: advanced
+
+   Concepts: inner product^multiple
+   Concepts: vector^norm
+
+.seealso: VecMDot(), VecNorm(), VecMAXPYNorm(), VecDotNorm2()
+@*/
+PetscErrorCode  VecMDotNorm(Vec x,PetscInt nv,const Vec y[],PetscScalar val[],PetscReal *xnorm)
+{
+  PetscErrorCode ierr;
+  PetscInt       i;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(x,VEC_CLASSID,1);
+  if (nv < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of vectors (given %D) must be positive",nv);
+  PetscValidPointer(y,3);
+  PetscValidHeaderSpecific(*y,VEC_CLASSID,3);
+  PetscValidScalarPointer(val,4);
+  PetscValidRealPointer(xnorm,5);
+  PetscValidType(x,1);
+  PetscValidType(*y,3);
+  PetscCheckSameTypeAndComm(x,1,*y,3);
+  PetscCheckSameSizeVec(x,*y);
+
+  ierr = PetscLogEventBarrierBegin(VEC_MDotNormBarrier,x,*y,0,0,((PetscObject)x)->comm);CHKERRQ(ierr);
+  if (x->ops->mdotnorm) {
+    ierr = (*x->ops->mdotnorm)(x,nv,y,val,xnorm);CHKERRQ(ierr);
+  } else {
+    ierr = (*x->ops->mdot)(x,nv,y,val);CHKERRQ(ierr);
+    ierr = (*x->ops->norm)(x,NORM_2,xnorm);CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventBarrierEnd(VEC_MDotNormBarrier,x,*y,0,0,((PetscObject)x)->comm);CHKERRQ(ierr);
+  for (i=0; i<nv; i++) {
+    if (PetscIsInfOrNanScalar(val[i])) SETERRQ1(((PetscObject)x)->comm,PETSC_ERR_FP,"Infinite or not-a-number generated in mdot, entry %D",i);
+  }
+  if (PetscIsInfOrNanReal(*xnorm)) SETERRQ(((PetscObject)x)->comm,PETSC_ERR_FP,"Infinite or not-a-number generated in norm");
+  ierr = PetscObjectComposedDataSetReal((PetscObject)x,NormIds[NORM_2],*xnorm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecMAXPYNorm"
+/*@
+   VecMAXPYNorm - Computes y = y + sum alpha[j] x[j] and the 2-norm of the result,
+   with one pass over the entries of y
+
+   Collective on Vec
+
+   Input Parameters:
++  nv - number of scalars and x-vectors
+.  alpha - array of scalars
+.  y - one vector
+-  x - array of vectors
+
+   Output Parameter:
+.  ynorm - the 2-norm of the updated y
+
+   Notes: y cannot be any of the x vectors
+
+   The norm is cached with the vector, so a later VecNorm() or VecNormalize() of y
+   does not communicate.
+
+   Level: advanced
+
+   Concepts: BLAS
+   Concepts: vector^norm
+
+.seealso: VecMAXPY(), VecNorm(), VecMDotNorm()
+@*/
+PetscErrorCode  VecMAXPYNorm(Vec y,PetscInt nv,const PetscScalar alpha[],Vec x[],PetscReal *ynorm)
+{
+  PetscErrorCode ierr;
+  PetscInt       i;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(y,VEC_CLASSID,1);
+  if (nv < 1) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of vectors (given %D) must be positive",nv);
+  PetscValidScalarPointer(alpha,3);
+  PetscValidPointer(x,4);
+  PetscValidHeaderSpecific(*x,VEC_CLASSID,4);
+  PetscValidRealPointer(ynorm,5);
+  PetscValidType(y,1);
+  PetscValidType(*x,4);
+  PetscCheckSameTypeAndComm(y,1,*x,4);
+  PetscCheckSameSizeVec(y,*x);
+  for (i=0; i<nv; i++) {
+    PetscValidLogicalCollectiveScalar(y,alpha[i],3);
+  }
+
+  ierr = PetscLogEventBegin(VEC_MAXPYNorm,*x,y,0,0);CHKERRQ(ierr);
+  if (y->ops->maxpynorm) {
+    ierr = (*y->ops->maxpynorm)(y,nv,alpha,x,ynorm);CHKERRQ(ierr);
+  } else {
+    ierr = (*y->ops->maxpy)(y,nv,alpha,x);CHKERRQ(ierr);
+    ierr = (*y->ops->norm)(y,NORM_2,ynorm);CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventEnd(VEC_MAXPYNorm,*x,y,0,0);CHKERRQ(ierr);
+  if (PetscIsInfOrNanReal(*ynorm)) SETERRQ(((PetscObject)y)->comm,PETSC_ERR_FP,"Infinite or not-a-number generated in norm");
+  ierr = PetscObjectStateIncrease((PetscObject)y);CHKERRQ(ierr);
+  ierr = PetscObjectComposedDataSetReal((PetscObject)y,NormIds[NORM_2],*ynorm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "VecGetSubVector"
 /*@
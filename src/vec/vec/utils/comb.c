@@ -203,6 +203,41 @@ PetscErrorCode PetscCommSplitReductionBegin(MPI_Comm comm)
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "PetscCommSplitReductionGetPending"
+/*@
+   PetscCommSplitReductionGetPending - Determines whether split-mode reductions begun on a communicator still wait for
+   their VecxxxEnd()
+
+   Not Collective
+
+   Input Arguments:
+.  comm - communicator
+
+   Output Arguments:
+.  pending - PETSC_TRUE if VecxxxBegin() has been called on comm without all the matching VecxxxEnd()
+
+   Level: developer
+
+   Note:
+   VecxxxBegin() cannot be called while reductions are pending, for example in a MatMult() called by a pipelined Krylov
+   method between the begin and the end of its own reductions; code that may run there can use this to choose the
+   blocking VecDot() and VecNorm() instead.
+
+.seealso: PetscCommSplitReductionBegin(), VecNormBegin(), VecDotBegin()
+@*/
+PetscErrorCode PetscCommSplitReductionGetPending(MPI_Comm comm,PetscBool *pending)
+{
+  PetscErrorCode      ierr;
+  PetscSplitReduction *sr;
+
+  PetscFunctionBegin;
+  PetscValidPointer(pending,2);
+  ierr     = PetscSplitReductionGet(comm,&sr);CHKERRQ(ierr);
+  *pending = (sr->state != STATE_BEGIN || sr->numopsbegin > 0) ? PETSC_TRUE : PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "PetscSplitReductionEnd"
 static PetscErrorCode PetscSplitReductionEnd(PetscSplitReduction *sr)
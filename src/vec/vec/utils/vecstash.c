@@ -64,7 +64,7 @@ PetscErrorCode VecStashCreate_Private(MPI_Comm comm,PetscInt bs,VecStash *stash)
   stash->nrecvs      = 0;
   stash->svalues     = 0;
   stash->rvalues     = 0;
-  stash->rmax        = 0;
+  stash->rindices    = 0;
   stash->nprocs      = 0;
   stash->nprocessed  = 0;
   stash->donotstash  = PETSC_FALSE;
@@ -100,7 +100,7 @@ PetscErrorCode VecStashDestroy_Private(VecStash *stash)
 PetscErrorCode VecStashScatterEnd_Private(VecStash *stash)
 {
   PetscErrorCode ierr;
-  PetscInt       nsends=stash->nsends,oldnmax;
+  PetscInt       nsends=stash->nsends,oldnmax,i;
   MPI_Status     *send_status;
 
   PetscFunctionBegin;
@@ -122,7 +122,6 @@ PetscErrorCode VecStashScatterEnd_Private(VecStash *stash)
   stash->nmax       = 0;
   stash->n          = 0;
   stash->reallocs   = -1;
-  stash->rmax       = 0;
   stash->nprocessed = 0;
 
   ierr = PetscFree2(stash->array,stash->idx);CHKERRQ(ierr);
@@ -131,7 +130,10 @@ PetscErrorCode VecStashScatterEnd_Private(VecStash *stash)
   ierr = PetscFree(stash->send_waits);CHKERRQ(ierr);
   ierr = PetscFree(stash->recv_waits);CHKERRQ(ierr);
   ierr = PetscFree2(stash->svalues,stash->sindices);CHKERRQ(ierr);
-  ierr = PetscFree2(stash->rvalues,stash->rindices);CHKERRQ(ierr);
+  for (i=0; i<stash->nrecvs; i++) {
+    ierr = PetscFree2(stash->rindices[i],stash->rvalues[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(stash->rindices,stash->rvalues);CHKERRQ(ierr);
   ierr = PetscFree(stash->nprocs);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -219,6 +221,63 @@ PetscErrorCode VecStashExpand_Private(VecStash *stash,PetscInt incr)
   stash->reallocs++;
   PetscFunctionReturn(0);
 }
+/*
+   Context for the callbacks of PetscCommBuildTwoSidedF() used by VecStashScatterBegin_Private(). The
+   rendezvous message to each rank is the number of stashed entries sent to it.
+*/
+typedef struct {
+  PetscInt    bs;
+  PetscInt    *sindices;     /* indices packed by destination */
+  PetscScalar *svalues;      /* values packed by destination */
+  PetscInt    *sstarts;      /* location of the first entry going to each destination */
+  PetscInt    nrecvs,nralloc;
+  PetscInt    **rindices;    /* one buffer per received message */
+  PetscScalar **rvalues;
+} VecStashBTS;
+
+#undef __FUNCT__
+#define __FUNCT__ "VecStashBTSSend_Private"
+static PetscErrorCode VecStashBTSSend_Private(MPI_Comm comm,const PetscMPIInt tag[],PetscMPIInt i,PetscMPIInt rank,void *sdata,MPI_Request req[],void *ctx)
+{
+  VecStashBTS    *bts = (VecStashBTS*)ctx;
+  PetscMPIInt    n = *(PetscMPIInt*)sdata;
+  PetscInt       start = bts->sstarts[i];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Isend(bts->svalues+bts->bs*start,bts->bs*n,MPIU_SCALAR,rank,tag[0],comm,&req[0]);CHKERRQ(ierr);
+  ierr = MPI_Isend(bts->sindices+start,n,MPIU_INT,rank,tag[1],comm,&req[1]);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecStashBTSRecv_Private"
+static PetscErrorCode VecStashBTSRecv_Private(MPI_Comm comm,const PetscMPIInt tag[],PetscMPIInt rank,void *rdata,MPI_Request req[],void *ctx)
+{
+  VecStashBTS    *bts = (VecStashBTS*)ctx;
+  PetscMPIInt    n = *(PetscMPIInt*)rdata;
+  PetscInt       k = bts->nrecvs;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (k == bts->nralloc) {
+    PetscInt    **rindices,nralloc = PetscMax(2*bts->nralloc,4);
+    PetscScalar **rvalues;
+    ierr = PetscMalloc2(nralloc,PetscInt*,&rindices,nralloc,PetscScalar*,&rvalues);CHKERRQ(ierr);
+    ierr = PetscMemcpy(rindices,bts->rindices,k*sizeof(PetscInt*));CHKERRQ(ierr);
+    ierr = PetscMemcpy(rvalues,bts->rvalues,k*sizeof(PetscScalar*));CHKERRQ(ierr);
+    ierr = PetscFree2(bts->rindices,bts->rvalues);CHKERRQ(ierr);
+    bts->rindices = rindices;
+    bts->rvalues  = rvalues;
+    bts->nralloc  = nralloc;
+  }
+  ierr = PetscMalloc2(n,PetscInt,&bts->rindices[k],bts->bs*n,PetscScalar,&bts->rvalues[k]);CHKERRQ(ierr);
+  ierr = MPI_Irecv(bts->rvalues[k],bts->bs*n,MPIU_SCALAR,rank,tag[0],comm,&req[0]);CHKERRQ(ierr);
+  ierr = MPI_Irecv(bts->rindices[k],n,MPIU_INT,rank,tag[1],comm,&req[1]);CHKERRQ(ierr);
+  bts->nrecvs++;
+  PetscFunctionReturn(0);
+}
+
 /*
   VecStashScatterBegin_Private - Initiates the transfer of values to the
   correct owners. This function goes through the stash, and check the
@@ -233,18 +292,24 @@ PetscErrorCode VecStashExpand_Private(VecStash *stash,PetscInt incr)
   Notes: The 'owners' array in the cased of the blocked-stash has the
   ranges specified blocked global indices, and for the regular stash in
   the proper global indices.
+
+  The receiving processes and the message lengths are discovered with
+  PetscCommBuildTwoSidedF(), so the receive buffers have the exact length
+  of each message and no reduction over all processes is needed.
 */
 #undef __FUNCT__
 #define __FUNCT__ "VecStashScatterBegin_Private"
 PetscErrorCode VecStashScatterBegin_Private(VecStash *stash,PetscInt *owners)
 {
   PetscErrorCode ierr;
-  PetscMPIInt    size = stash->size,tag1=stash->tag1,tag2=stash->tag2;
+  PetscMPIInt    size = stash->size;
   PetscInt       *owner,*start,*nprocs,nsends,nreceives;
-  PetscInt       nmax,count,*sindices,*rindices,i,j,idx,bs=stash->bs,lastidx;
-  PetscScalar    *rvalues,*svalues;
+  PetscInt       count,*sindices,i,j,idx,bs=stash->bs,lastidx;
+  PetscScalar    *svalues;
   MPI_Comm       comm = stash->comm;
   MPI_Request    *send_waits,*recv_waits;
+  PetscMPIInt    *sendranks,*sendlens,*recvranks,*recvlens;
+  VecStashBTS    bts;
 
   PetscFunctionBegin;
 
@@ -267,29 +332,12 @@ PetscErrorCode VecStashScatterBegin_Private(VecStash *stash,PetscInt *owners)
   }
   nsends = 0;  for (i=0; i<size; i++) { nsends += nprocs[2*i+1];}
 
-  /* inform other processors of number of messages and max length*/
-  ierr = PetscMaxSum(comm,nprocs,&nmax,&nreceives);CHKERRQ(ierr);
-
-  /* post receives:
-     since we don't know how long each individual message is we
-     allocate the largest needed buffer for each receive. Potentially
-     this is a lot of wasted space.
-  */
-  ierr     = PetscMalloc2(nreceives*nmax*bs,PetscScalar,&rvalues,nreceives*nmax,PetscInt,&rindices);CHKERRQ(ierr);
-  ierr     = PetscMalloc(2*nreceives*sizeof(MPI_Request),&recv_waits);CHKERRQ(ierr);
-  for (i=0,count=0; i<nreceives; i++) {
-    ierr = MPI_Irecv(rvalues+bs*nmax*i,bs*nmax,MPIU_SCALAR,MPI_ANY_SOURCE,tag1,comm,recv_waits+count++);CHKERRQ(ierr);
-    ierr = MPI_Irecv(rindices+nmax*i,nmax,MPIU_INT,MPI_ANY_SOURCE,tag2,comm,recv_waits+count++);CHKERRQ(ierr);
-  }
-
-  /* do sends:
+  /* pack the stash by destination:
       1) starts[i] gives the starting index in svalues for stuff going to
          the ith processor
   */
   ierr = PetscMalloc2(stash->n*bs,PetscScalar,&svalues,stash->n,PetscInt,&sindices);CHKERRQ(ierr);
-  ierr = PetscMalloc(2*nsends*sizeof(MPI_Request),&send_waits);CHKERRQ(ierr);
   ierr = PetscMalloc(size*sizeof(PetscInt),&start);CHKERRQ(ierr);
-  /* use 2 sends the first with all_v, the next with all_i */
   start[0] = 0;
   for (i=1; i<size; i++) {
     start[i] = start[i-1] + nprocs[2*i-2];
@@ -306,12 +354,28 @@ PetscErrorCode VecStashScatterBegin_Private(VecStash *stash,PetscInt *owners)
   }
   start[0] = 0;
   for (i=1; i<size; i++) { start[i] = start[i-1] + nprocs[2*i-2];}
+
+  ierr = PetscMalloc3(nsends,PetscMPIInt,&sendranks,nsends,PetscMPIInt,&sendlens,nsends,PetscInt,&bts.sstarts);CHKERRQ(ierr);
   for (i=0,count=0; i<size; i++) {
     if (nprocs[2*i+1]) {
-      ierr = MPI_Isend(svalues+bs*start[i],bs*nprocs[2*i],MPIU_SCALAR,i,tag1,comm,send_waits+count++);CHKERRQ(ierr);
-      ierr = MPI_Isend(sindices+start[i],nprocs[2*i],MPIU_INT,i,tag2,comm,send_waits+count++);CHKERRQ(ierr);
+      sendranks[count]     = i;
+      sendlens[count]      = nprocs[2*i];
+      bts.sstarts[count++] = start[i];
     }
   }
+
+  /* the messages with the values and the indices are sent during the rendezvous */
+  bts.bs       = bs;
+  bts.sindices = sindices;
+  bts.svalues  = svalues;
+  bts.nrecvs   = 0;
+  bts.nralloc  = 0;
+  bts.rindices = PETSC_NULL;
+  bts.rvalues  = PETSC_NULL;
+  ierr = PetscCommBuildTwoSidedF(comm,1,MPI_INT,nsends,sendranks,sendlens,&nreceives,&recvranks,&recvlens,2,&send_waits,&recv_waits,VecStashBTSSend_Private,VecStashBTSRecv_Private,&bts);CHKERRQ(ierr);
+  ierr = PetscFree(recvranks);CHKERRQ(ierr);
+  ierr = PetscFree(recvlens);CHKERRQ(ierr);
+  ierr = PetscFree3(sendranks,sendlens,bts.sstarts);CHKERRQ(ierr);
   ierr = PetscFree(owner);CHKERRQ(ierr);
   ierr = PetscFree(start);CHKERRQ(ierr);
   /* This memory is reused in scatter end  for a different purpose*/
@@ -320,13 +384,12 @@ PetscErrorCode VecStashScatterBegin_Private(VecStash *stash,PetscInt *owners)
 
   stash->svalues    = svalues;
   stash->sindices   = sindices;
-  stash->rvalues    = rvalues;
-  stash->rindices   = rindices;
+  stash->rvalues    = bts.rvalues;
+  stash->rindices   = bts.rindices;
   stash->nsends     = nsends;
   stash->nrecvs     = nreceives;
   stash->send_waits = send_waits;
   stash->recv_waits = recv_waits;
-  stash->rmax       = nmax;
   PetscFunctionReturn(0);
 }
 
@@ -384,8 +447,8 @@ PetscErrorCode VecStashScatterGetMesg_Private(VecStash *stash,PetscMPIInt *nvals
     i1 = flg_v[2*recv_status.MPI_SOURCE];
     i2 = flg_v[2*recv_status.MPI_SOURCE+1];
     if (i1 != -1 && i2 != -1) {
-      *rows       = stash->rindices + i2*stash->rmax;
-      *vals       = stash->rvalues + i1*bs*stash->rmax;
+      *rows       = stash->rindices[i2];
+      *vals       = stash->rvalues[i1];
       *flg        = 1;
       stash->nprocessed ++;
       match_found = PETSC_TRUE;
@@ -26,13 +26,13 @@ PetscErrorCode VecScatterView_MPI(VecScatter ctx,PetscViewer viewer)
     ierr = MPI_Comm_rank(((PetscObject)ctx)->comm,&rank);CHKERRQ(ierr);
     ierr = PetscViewerGetFormat(viewer,&format);CHKERRQ(ierr);
     if (format ==  PETSC_VIEWER_ASCII_INFO) {
-      PetscInt nsend_max,nrecv_max,lensend_max,lenrecv_max,alldata,itmp;
+      PetscInt nsend_max,nrecv_max,lensend_max,lenrecv_max,alldata,itmp,nidx[4],gnidx[4];
 
       ierr = MPI_Reduce(&to->n,&nsend_max,1,MPIU_INT,MPI_MAX,0,((PetscObject)ctx)->comm);CHKERRQ(ierr);
       ierr = MPI_Reduce(&from->n,&nrecv_max,1,MPIU_INT,MPI_MAX,0,((PetscObject)ctx)->comm);CHKERRQ(ierr);
-      itmp = to->starts[to->n+1];
+      itmp = to->starts[to->n];
       ierr = MPI_Reduce(&itmp,&lensend_max,1,MPIU_INT,MPI_MAX,0,((PetscObject)ctx)->comm);CHKERRQ(ierr);
-      itmp = from->starts[from->n+1];
+      itmp = from->starts[from->n];
       ierr = MPI_Reduce(&itmp,&lenrecv_max,1,MPIU_INT,MPI_MAX,0,((PetscObject)ctx)->comm);CHKERRQ(ierr);
       ierr = MPI_Reduce(&itmp,&alldata,1,MPIU_INT,MPI_SUM,0,((PetscObject)ctx)->comm);CHKERRQ(ierr);
 
@@ -42,10 +42,31 @@ PetscErrorCode VecScatterView_MPI(VecScatter ctx,PetscViewer viewer)
       ierr = PetscViewerASCIIPrintf(viewer,"  Maximum data sent %D\n",(int)(lensend_max*to->bs*sizeof(PetscScalar)));CHKERRQ(ierr);
       ierr = PetscViewerASCIIPrintf(viewer,"  Maximum data received %D\n",(int)(lenrecv_max*to->bs*sizeof(PetscScalar)));CHKERRQ(ierr);
       ierr = PetscViewerASCIIPrintf(viewer,"  Total data sent %D\n",(int)(alldata*to->bs*sizeof(PetscScalar)));CHKERRQ(ierr);
+      /* the indices are stored as runs of blocks on the processes where they compress well */
+      nidx[0] = to->starts[to->n];
+      nidx[1] = to->use_runs ? to->runstarts[to->n] : to->starts[to->n];
+      nidx[2] = from->starts[from->n];
+      nidx[3] = from->use_runs ? from->runstarts[from->n] : from->starts[from->n];
+      ierr = MPI_Reduce(nidx,gnidx,4,MPIU_INT,MPI_SUM,0,((PetscObject)ctx)->comm);CHKERRQ(ierr);
+      ierr = PetscViewerASCIIPrintf(viewer,"  Blocks sent %D, stored as %D runs or single blocks\n",gnidx[0],gnidx[1]);CHKERRQ(ierr);
+      ierr = PetscViewerASCIIPrintf(viewer,"  Blocks received %D, stored as %D runs or single blocks\n",gnidx[2],gnidx[3]);CHKERRQ(ierr);
+      if (to->use_shared) {
+        ierr = MPI_Reduce(&to->nshared,&itmp,1,MPIU_INT,MPI_MAX,0,((PetscObject)ctx)->comm);CHKERRQ(ierr);
+        ierr = PetscViewerASCIIPrintf(viewer,"  Maximum number sends through shared memory %D\n",itmp);CHKERRQ(ierr);
+      }
 
     } else {
       ierr = PetscViewerASCIISynchronizedAllow(viewer,PETSC_TRUE);CHKERRQ(ierr);
       ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] Number sends = %D; Number to self = %D\n",rank,to->n,to->local.n);CHKERRQ(ierr);
+      if (to->use_shared) {
+        ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] The last %D sends and %D receives are through shared memory\n",rank,to->nshared,from->nshared);CHKERRQ(ierr);
+      }
+      if (to->use_runs) {
+        ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] Sends packed as %D runs (first index, blocks, distance)\n",rank,to->runstarts[to->n]);CHKERRQ(ierr);
+        for (i=0; i<to->runstarts[to->n]; i++){
+          ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] %D %D %D\n",rank,to->runs[3*i],to->runs[3*i+1],to->runs[3*i+2]);CHKERRQ(ierr);
+        }
+      }
       if (to->n) {
         for (i=0; i<to->n; i++){
           ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d]   %D length = %D to whom %D\n",rank,i,to->starts[i+1]-to->starts[i],to->procs[i]);CHKERRQ(ierr);
@@ -67,6 +88,12 @@ PetscErrorCode VecScatterView_MPI(VecScatter ctx,PetscViewer viewer)
           ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] %D \n",rank,from->indices[i]);CHKERRQ(ierr);
         }
       }
+      if (from->use_runs) {
+        ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] Receives unpacked as %D runs (first index, blocks, distance)\n",rank,from->runstarts[from->n]);CHKERRQ(ierr);
+        for (i=0; i<from->runstarts[from->n]; i++){
+          ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] %D %D %D\n",rank,from->runs[3*i],from->runs[3*i+1],from->runs[3*i+2]);CHKERRQ(ierr);
+        }
+      }
       if (to->local.n) {
         ierr = PetscViewerASCIISynchronizedPrintf(viewer,"[%d] Indices for local part of scatter\n",rank);CHKERRQ(ierr);
         for (i=0; i<to->local.n; i++){
@@ -179,6 +206,27 @@ PetscErrorCode VecScatterDestroy_PtoP(VecScatter ctx)
     ierr = PetscFree2(from->counts,from->displs);CHKERRQ(ierr);
   }
 
+  if (to->use_runs) {
+    ierr = PetscFree2(to->runstarts,to->runs);CHKERRQ(ierr);
+  }
+  if (from->use_runs) {
+    ierr = PetscFree2(from->runstarts,from->runs);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(to->multivalues);CHKERRQ(ierr);
+  ierr = PetscFree(to->multirequests);CHKERRQ(ierr);
+  ierr = PetscFree(from->multivalues);CHKERRQ(ierr);
+  ierr = PetscFree(from->multirequests);CHKERRQ(ierr);
+
+#if defined(PETSC_HAVE_MPI_WIN_ALLOCATE_SHARED)
+  if (to->use_shared) {
+    ierr = MPI_Win_unlock_all(to->shmwin);CHKERRQ(ierr);
+    ierr = MPI_Win_free(&to->shmwin);CHKERRQ(ierr);
+    ierr = MPI_Comm_free(&to->shmcomm);CHKERRQ(ierr);
+    ierr = PetscFree2(to->shmsend,to->shmrecv);CHKERRQ(ierr);
+    ierr = PetscFree2(from->shmsend,from->shmrecv);CHKERRQ(ierr);
+  }
+#endif
+
   /* release MPI resources obtained with MPI_Send_init() and MPI_Recv_init() */
   /*
      IBM's PE version of MPI has a bug where freeing these guys will screw up later
@@ -187,12 +235,12 @@ PetscErrorCode VecScatterDestroy_PtoP(VecScatter ctx)
 #if !defined(PETSC_HAVE_BROKEN_REQUEST_FREE)
   if (!to->use_alltoallv && !to->use_window) {   /* currently the to->requests etc are ALWAYS allocated even if not used */
     if (to->requests) {
-      for (i=0; i<to->n; i++) {
+      for (i=0; i<to->n-to->nshared; i++) {
         ierr = MPI_Request_free(to->requests + i);CHKERRQ(ierr);
       }
     }
     if (to->rev_requests) {
-      for (i=0; i<to->n; i++) {
+      for (i=0; i<to->n-to->nshared; i++) {
         ierr = MPI_Request_free(to->rev_requests + i);CHKERRQ(ierr);
       }
     }
@@ -204,13 +252,13 @@ PetscErrorCode VecScatterDestroy_PtoP(VecScatter ctx)
   */
   if (!to->use_alltoallv && !to->use_window) {    /* currently the from->requests etc are ALWAYS allocated even if not used */
     if (from->requests) {
-      for (i=0; i<from->n; i++) {
+      for (i=0; i<from->n-from->nshared; i++) {
         ierr = MPI_Request_free(from->requests + i);CHKERRQ(ierr);
       }
     }
 
     if (from->rev_requests) {
-      for (i=0; i<from->n; i++) {
+      for (i=0; i<from->n-from->nshared; i++) {
         ierr = MPI_Request_free(from->rev_requests + i);CHKERRQ(ierr);
       }
     }
@@ -276,6 +324,23 @@ PetscErrorCode VecScatterLocalOptimizeCopy_Private(VecScatter scatter,VecScatter
 
 /* --------------------------------------------------------------------------------------*/
 
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterCopyRuns_Private"
+static PetscErrorCode VecScatterCopyRuns_Private(VecScatter_MPI_General *in,VecScatter_MPI_General *out)
+{
+  PetscErrorCode ierr;
+  PetscInt       nruns;
+
+  PetscFunctionBegin;
+  if (!in->use_runs) PetscFunctionReturn(0);
+  nruns = in->runstarts[in->n];
+  ierr  = PetscMalloc2(in->n+1,PetscInt,&out->runstarts,3*nruns,PetscInt,&out->runs);CHKERRQ(ierr);
+  ierr  = PetscMemcpy(out->runstarts,in->runstarts,(in->n+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr  = PetscMemcpy(out->runs,in->runs,3*nruns*sizeof(PetscInt));CHKERRQ(ierr);
+  out->use_runs = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "VecScatterCopy_PtoP_X"
 PetscErrorCode VecScatterCopy_PtoP_X(VecScatter in,VecScatter out)
@@ -288,6 +353,8 @@ PetscErrorCode VecScatterCopy_PtoP_X(VecScatter in,VecScatter out)
   PetscFunctionBegin;
   out->begin     = in->begin;
   out->end       = in->end;
+  out->beginmulti = in->beginmulti;
+  out->endmulti   = in->endmulti;
   out->copy      = in->copy;
   out->destroy   = in->destroy;
   out->view      = in->view;
@@ -307,6 +374,7 @@ PetscErrorCode VecScatterCopy_PtoP_X(VecScatter in,VecScatter out)
   ierr = PetscMemcpy(out_to->indices,in_to->indices,ny*sizeof(PetscInt));CHKERRQ(ierr);
   ierr = PetscMemcpy(out_to->starts,in_to->starts,(out_to->n+1)*sizeof(PetscInt));CHKERRQ(ierr);
   ierr = PetscMemcpy(out_to->procs,in_to->procs,(out_to->n)*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  ierr = VecScatterCopyRuns_Private(in_to,out_to);CHKERRQ(ierr);
 
   out->todata       = (void*)out_to;
   out_to->local.n   = in_to->local.n;
@@ -334,6 +402,7 @@ PetscErrorCode VecScatterCopy_PtoP_X(VecScatter in,VecScatter out)
   ierr = PetscMemcpy(out_from->indices,in_from->indices,ny*sizeof(PetscInt));CHKERRQ(ierr);
   ierr = PetscMemcpy(out_from->starts,in_from->starts,(out_from->n+1)*sizeof(PetscInt));CHKERRQ(ierr);
   ierr = PetscMemcpy(out_from->procs,in_from->procs,(out_from->n)*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  ierr = VecScatterCopyRuns_Private(in_from,out_from);CHKERRQ(ierr);
   out->fromdata       = (void*)out_from;
   out_from->local.n   = in_from->local.n;
   out_from->local.nonmatching_computed = PETSC_FALSE;
@@ -375,6 +444,8 @@ PetscErrorCode VecScatterCopy_PtoP_X(VecScatter in,VecScatter out)
     if (flg) {
       out_to->use_readyreceiver    = PETSC_TRUE;
       out_from->use_readyreceiver  = PETSC_TRUE;
+      out->beginmulti              = 0;
+      out->endmulti                = 0;
       for (i=0; i<out_to->n; i++) {
         ierr = MPI_Rsend_init(Ssvalues+bs*sstarts[i],bs*sstarts[i+1]-bs*sstarts[i],MPIU_SCALAR,sprocs[i],tag,comm,swaits+i);CHKERRQ(ierr);
       }
@@ -420,6 +491,8 @@ PetscErrorCode VecScatterCopy_PtoP_AllToAll(VecScatter in,VecScatter out)
   ierr = MPI_Comm_size(((PetscObject)in)->comm,&size);CHKERRQ(ierr);
   out->begin     = in->begin;
   out->end       = in->end;
+  out->beginmulti = in->beginmulti;
+  out->endmulti   = in->endmulti;
   out->copy      = in->copy;
   out->destroy   = in->destroy;
   out->view      = in->view;
@@ -439,6 +512,7 @@ PetscErrorCode VecScatterCopy_PtoP_AllToAll(VecScatter in,VecScatter out)
   ierr = PetscMemcpy(out_to->indices,in_to->indices,ny*sizeof(PetscInt));CHKERRQ(ierr);
   ierr = PetscMemcpy(out_to->starts,in_to->starts,(out_to->n+1)*sizeof(PetscInt));CHKERRQ(ierr);
   ierr = PetscMemcpy(out_to->procs,in_to->procs,(out_to->n)*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  ierr = VecScatterCopyRuns_Private(in_to,out_to);CHKERRQ(ierr);
 
   out->todata       = (void*)out_to;
   out_to->local.n   = in_to->local.n;
@@ -466,6 +540,7 @@ PetscErrorCode VecScatterCopy_PtoP_AllToAll(VecScatter in,VecScatter out)
   ierr = PetscMemcpy(out_from->indices,in_from->indices,ny*sizeof(PetscInt));CHKERRQ(ierr);
   ierr = PetscMemcpy(out_from->starts,in_from->starts,(out_from->n+1)*sizeof(PetscInt));CHKERRQ(ierr);
   ierr = PetscMemcpy(out_from->procs,in_from->procs,(out_from->n)*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  ierr = VecScatterCopyRuns_Private(in_from,out_from);CHKERRQ(ierr);
   out->fromdata       = (void*)out_from;
   out_from->local.n   = in_from->local.n;
   out_from->local.nonmatching_computed = PETSC_FALSE;
@@ -490,7 +565,7 @@ PetscErrorCode VecScatterCopy_PtoP_AllToAll(VecScatter in,VecScatter out)
 
     Fortran kernels etc. could be used.
 */
-PETSC_STATIC_INLINE void Pack_1(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y)
+PETSC_STATIC_INLINE void Pack_1(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
 {
   PetscInt i;
   for (i=0; i<n; i++) {
@@ -500,7 +575,7 @@ PETSC_STATIC_INLINE void Pack_1(PetscInt n,const PetscInt *indicesx,const PetscS
 
 #undef __FUNCT__
 #define __FUNCT__ "UnPack_1"
-PETSC_STATIC_INLINE PetscErrorCode UnPack_1(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode UnPack_1(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i;
   PetscFunctionBegin;
@@ -535,7 +610,7 @@ PETSC_STATIC_INLINE PetscErrorCode UnPack_1(PetscInt n,const PetscScalar *x,cons
 
 #undef __FUNCT__
 #define __FUNCT__ "Scatter_1"
-PETSC_STATIC_INLINE PetscErrorCode Scatter_1(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode Scatter_1(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i;
   PetscFunctionBegin;
@@ -569,7 +644,7 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_1(PetscInt n,const PetscInt *indicesx
 }
 
   /* ----------------------------------------------------------------------------------------------- */
-PETSC_STATIC_INLINE void Pack_2(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y)
+PETSC_STATIC_INLINE void Pack_2(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
 {
   PetscInt i,idx;
 
@@ -583,7 +658,7 @@ PETSC_STATIC_INLINE void Pack_2(PetscInt n,const PetscInt *indicesx,const PetscS
 
 #undef __FUNCT__
 #define __FUNCT__ "UnPack_2"
-PETSC_STATIC_INLINE PetscErrorCode UnPack_2(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode UnPack_2(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idy;
 
@@ -628,7 +703,7 @@ PETSC_STATIC_INLINE PetscErrorCode UnPack_2(PetscInt n,const PetscScalar *x,cons
 
 #undef __FUNCT__
 #define __FUNCT__ "Scatter_2"
-PETSC_STATIC_INLINE PetscErrorCode Scatter_2(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode Scatter_2(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idx,idy;
 
@@ -671,7 +746,7 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_2(PetscInt n,const PetscInt *indicesx
   PetscFunctionReturn(0);
 }
   /* ----------------------------------------------------------------------------------------------- */
-PETSC_STATIC_INLINE void Pack_3(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y)
+PETSC_STATIC_INLINE void Pack_3(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
 {
   PetscInt i,idx;
 
@@ -685,7 +760,7 @@ PETSC_STATIC_INLINE void Pack_3(PetscInt n,const PetscInt *indicesx,const PetscS
 }
 #undef __FUNCT__
 #define __FUNCT__ "UnPack_3"
-PETSC_STATIC_INLINE PetscErrorCode UnPack_3(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode UnPack_3(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idy;
 
@@ -733,7 +808,7 @@ PETSC_STATIC_INLINE PetscErrorCode UnPack_3(PetscInt n,const PetscScalar *x,cons
 
 #undef __FUNCT__
 #define __FUNCT__ "Scatter_3"
-PETSC_STATIC_INLINE PetscErrorCode Scatter_3(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode Scatter_3(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idx,idy;
 
@@ -779,7 +854,7 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_3(PetscInt n,const PetscInt *indicesx
   PetscFunctionReturn(0);
 }
   /* ----------------------------------------------------------------------------------------------- */
-PETSC_STATIC_INLINE void Pack_4(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y)
+PETSC_STATIC_INLINE void Pack_4(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
 {
   PetscInt i,idx;
 
@@ -794,7 +869,7 @@ PETSC_STATIC_INLINE void Pack_4(PetscInt n,const PetscInt *indicesx,const PetscS
 }
 #undef __FUNCT__
 #define __FUNCT__ "UnPack_4"
-PETSC_STATIC_INLINE PetscErrorCode UnPack_4(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode UnPack_4(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idy;
 
@@ -845,7 +920,7 @@ PETSC_STATIC_INLINE PetscErrorCode UnPack_4(PetscInt n,const PetscScalar *x,cons
 
 #undef __FUNCT__
 #define __FUNCT__ "Scatter_4"
-PETSC_STATIC_INLINE PetscErrorCode Scatter_4(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode Scatter_4(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idx,idy;
 
@@ -894,7 +969,7 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_4(PetscInt n,const PetscInt *indicesx
   PetscFunctionReturn(0);
 }
   /* ----------------------------------------------------------------------------------------------- */
-PETSC_STATIC_INLINE void Pack_5(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y)
+PETSC_STATIC_INLINE void Pack_5(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
 {
   PetscInt i,idx;
 
@@ -911,7 +986,7 @@ PETSC_STATIC_INLINE void Pack_5(PetscInt n,const PetscInt *indicesx,const PetscS
 
 #undef __FUNCT__
 #define __FUNCT__ "UnPack_5"
-PETSC_STATIC_INLINE PetscErrorCode UnPack_5(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode UnPack_5(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idy;
 
@@ -965,7 +1040,7 @@ PETSC_STATIC_INLINE PetscErrorCode UnPack_5(PetscInt n,const PetscScalar *x,cons
 
 #undef __FUNCT__
 #define __FUNCT__ "Scatter_5"
-PETSC_STATIC_INLINE PetscErrorCode Scatter_5(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode Scatter_5(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idx,idy;
 
@@ -1017,7 +1092,7 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_5(PetscInt n,const PetscInt *indicesx
   PetscFunctionReturn(0);
 }
   /* ----------------------------------------------------------------------------------------------- */
-PETSC_STATIC_INLINE void Pack_6(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y)
+PETSC_STATIC_INLINE void Pack_6(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
 {
   PetscInt i,idx;
 
@@ -1035,7 +1110,7 @@ PETSC_STATIC_INLINE void Pack_6(PetscInt n,const PetscInt *indicesx,const PetscS
 
 #undef __FUNCT__
 #define __FUNCT__ "UnPack_6"
-PETSC_STATIC_INLINE PetscErrorCode UnPack_6(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode UnPack_6(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idy;
 
@@ -1092,7 +1167,7 @@ PETSC_STATIC_INLINE PetscErrorCode UnPack_6(PetscInt n,const PetscScalar *x,cons
 
 #undef __FUNCT__
 #define __FUNCT__ "Scatter_6"
-PETSC_STATIC_INLINE PetscErrorCode Scatter_6(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode Scatter_6(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idx,idy;
 
@@ -1147,7 +1222,7 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_6(PetscInt n,const PetscInt *indicesx
   PetscFunctionReturn(0);
 }
   /* ----------------------------------------------------------------------------------------------- */
-PETSC_STATIC_INLINE void Pack_7(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y)
+PETSC_STATIC_INLINE void Pack_7(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
 {
   PetscInt i,idx;
 
@@ -1166,7 +1241,7 @@ PETSC_STATIC_INLINE void Pack_7(PetscInt n,const PetscInt *indicesx,const PetscS
 
 #undef __FUNCT__
 #define __FUNCT__ "UnPack_7"
-PETSC_STATIC_INLINE PetscErrorCode UnPack_7(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode UnPack_7(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idy;
 
@@ -1226,7 +1301,7 @@ PETSC_STATIC_INLINE PetscErrorCode UnPack_7(PetscInt n,const PetscScalar *x,cons
 
 #undef __FUNCT__
 #define __FUNCT__ "Scatter_7"
-PETSC_STATIC_INLINE PetscErrorCode Scatter_7(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode Scatter_7(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idx,idy;
 
@@ -1284,7 +1359,7 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_7(PetscInt n,const PetscInt *indicesx
   PetscFunctionReturn(0);
 }
   /* ----------------------------------------------------------------------------------------------- */
-PETSC_STATIC_INLINE void Pack_8(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y)
+PETSC_STATIC_INLINE void Pack_8(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
 {
   PetscInt i,idx;
 
@@ -1304,7 +1379,7 @@ PETSC_STATIC_INLINE void Pack_8(PetscInt n,const PetscInt *indicesx,const PetscS
 
 #undef __FUNCT__
 #define __FUNCT__ "UnPack_8"
-PETSC_STATIC_INLINE PetscErrorCode UnPack_8(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode UnPack_8(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idy;
 
@@ -1367,7 +1442,7 @@ PETSC_STATIC_INLINE PetscErrorCode UnPack_8(PetscInt n,const PetscScalar *x,cons
 
 #undef __FUNCT__
 #define __FUNCT__ "Scatter_8"
-PETSC_STATIC_INLINE PetscErrorCode Scatter_8(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode Scatter_8(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idx,idy;
 
@@ -1429,7 +1504,7 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_8(PetscInt n,const PetscInt *indicesx
 }
 
   /* ----------------------------------------------------------------------------------------------- */
-PETSC_STATIC_INLINE void Pack_12(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y)
+PETSC_STATIC_INLINE void Pack_12(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
 {
   PetscInt i,idx;
 
@@ -1453,7 +1528,7 @@ PETSC_STATIC_INLINE void Pack_12(PetscInt n,const PetscInt *indicesx,const Petsc
 
 #undef __FUNCT__
 #define __FUNCT__ "UnPack_12"
-PETSC_STATIC_INLINE PetscErrorCode UnPack_12(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode UnPack_12(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idy;
 
@@ -1528,7 +1603,7 @@ PETSC_STATIC_INLINE PetscErrorCode UnPack_12(PetscInt n,const PetscScalar *x,con
 
 #undef __FUNCT__
 #define __FUNCT__ "Scatter_12"
-PETSC_STATIC_INLINE PetscErrorCode Scatter_12(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv)
+PETSC_STATIC_INLINE PetscErrorCode Scatter_12(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
 {
   PetscInt i,idx,idy;
 
@@ -1601,7 +1676,216 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_12(PetscInt n,const PetscInt *indices
   PetscFunctionReturn(0);
 }
 
-/* Create the VecScatterBegin/End_P for our chosen block sizes */
+  /* ----------------------------------------------------------------------------------------------- */
+/*
+    Any other block size, with the block size given at run time
+*/
+PETSC_STATIC_INLINE void Pack_bs(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,PetscScalar *y,PetscInt bs)
+{
+  PetscInt       i,idx;
+  PetscErrorCode ierr;
+
+  for (i=0; i<n; i++) {
+    idx  = *indicesx++;
+    ierr = PetscMemcpy(y,x + idx,bs*sizeof(PetscScalar));CHKERRV(ierr);
+    y   += bs;
+  }
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "UnPack_bs"
+PETSC_STATIC_INLINE PetscErrorCode UnPack_bs(PetscInt n,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
+{
+  PetscInt       i,j,idy;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  switch (addv) {
+  case INSERT_VALUES:
+  case INSERT_ALL_VALUES:
+    for (i=0; i<n; i++) {
+      idy  = *indicesy++;
+      ierr = PetscMemcpy(y + idy,x,bs*sizeof(PetscScalar));CHKERRQ(ierr);
+      x   += bs;
+    }
+    break;
+  case ADD_VALUES:
+  case ADD_ALL_VALUES:
+    for (i=0; i<n; i++) {
+      idy = *indicesy++;
+      for (j=0; j<bs; j++) y[idy+j] += x[j];
+      x  += bs;
+    }
+    break;
+#if !defined(PETSC_USE_COMPLEX)
+  case MAX_VALUES:
+    for (i=0; i<n; i++) {
+      idy = *indicesy++;
+      for (j=0; j<bs; j++) y[idy+j] = PetscMax(y[idy+j],x[j]);
+      x  += bs;
+    }
+#else
+  case MAX_VALUES:
+#endif
+  case NOT_SET_VALUES:
+    break;
+  default:
+    SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "Cannot handle insert mode %d", addv);
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "Scatter_bs"
+PETSC_STATIC_INLINE PetscErrorCode Scatter_bs(PetscInt n,const PetscInt *indicesx,const PetscScalar *x,const PetscInt *indicesy,PetscScalar *y,InsertMode addv,PetscInt bs)
+{
+  PetscInt       i,j,idx,idy;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  switch (addv) {
+  case INSERT_VALUES:
+  case INSERT_ALL_VALUES:
+    for (i=0; i<n; i++) {
+      idx  = *indicesx++;
+      idy  = *indicesy++;
+      ierr = PetscMemcpy(y + idy,x + idx,bs*sizeof(PetscScalar));CHKERRQ(ierr);
+    }
+    break;
+  case ADD_VALUES:
+  case ADD_ALL_VALUES:
+    for (i=0; i<n; i++) {
+      idx = *indicesx++;
+      idy = *indicesy++;
+      for (j=0; j<bs; j++) y[idy+j] += x[idx+j];
+    }
+    break;
+#if !defined(PETSC_USE_COMPLEX)
+  case MAX_VALUES:
+    for (i=0; i<n; i++) {
+      idx = *indicesx++;
+      idy = *indicesy++;
+      for (j=0; j<bs; j++) y[idy+j] = PetscMax(y[idy+j],x[idx+j]);
+    }
+#else
+  case MAX_VALUES:
+#endif
+  case NOT_SET_VALUES:
+    break;
+  default:
+    SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "Cannot handle insert mode %d", addv);
+  }
+  PetscFunctionReturn(0);
+}
+
+  /* ----------------------------------------------------------------------------------------------- */
+/*
+    Packs and unpacks messages stored as runs of blocks, see VecScatterCreateRuns_Private(). Each run is the
+    first index, the number of blocks and the distance between them; runs of adjacent blocks are a single copy.
+*/
+#undef __FUNCT__
+#define __FUNCT__ "PackRuns"
+PETSC_STATIC_INLINE PetscErrorCode PackRuns(PetscInt nruns,const PetscInt *runs,const PetscScalar *x,PetscScalar *y,PetscInt bs)
+{
+  PetscInt       r,i,j,n,stride;
+  PetscErrorCode ierr;
+  const PetscScalar *xr;
+
+  PetscFunctionBegin;
+  for (r=0; r<nruns; r++) {
+    xr     = x + runs[3*r];
+    n      = runs[3*r+1];
+    stride = runs[3*r+2];
+    if (stride == bs) {
+      ierr = PetscMemcpy(y,xr,n*bs*sizeof(PetscScalar));CHKERRQ(ierr);
+    } else if (bs == 1) {
+      for (i=0; i<n; i++) y[i] = xr[i*stride];
+    } else {
+      for (i=0; i<n; i++) {
+        for (j=0; j<bs; j++) y[i*bs+j] = xr[i*stride+j];
+      }
+    }
+    y += n*bs;
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "UnPackRuns"
+PETSC_STATIC_INLINE PetscErrorCode UnPackRuns(PetscInt nruns,const PetscInt *runs,const PetscScalar *x,PetscScalar *y,InsertMode addv,PetscInt bs)
+{
+  PetscInt       r,i,j,n,stride;
+  PetscErrorCode ierr;
+  PetscScalar    *yr;
+
+  PetscFunctionBegin;
+  for (r=0; r<nruns; r++) {
+    yr     = y + runs[3*r];
+    n      = runs[3*r+1];
+    stride = runs[3*r+2];
+    switch (addv) {
+    case INSERT_VALUES:
+    case INSERT_ALL_VALUES:
+      if (stride == bs) {
+        ierr = PetscMemcpy(yr,x,n*bs*sizeof(PetscScalar));CHKERRQ(ierr);
+      } else {
+        for (i=0; i<n; i++) {
+          for (j=0; j<bs; j++) yr[i*stride+j] = x[i*bs+j];
+        }
+      }
+      break;
+    case ADD_VALUES:
+    case ADD_ALL_VALUES:
+      if (stride == bs) {
+        for (i=0; i<n*bs; i++) yr[i] += x[i];
+      } else {
+        for (i=0; i<n; i++) {
+          for (j=0; j<bs; j++) yr[i*stride+j] += x[i*bs+j];
+        }
+      }
+      break;
+#if !defined(PETSC_USE_COMPLEX)
+    case MAX_VALUES:
+      for (i=0; i<n; i++) {
+        for (j=0; j<bs; j++) yr[i*stride+j] = PetscMax(yr[i*stride+j],x[i*bs+j]);
+      }
+      break;
+#else
+    case MAX_VALUES:
+#endif
+    case NOT_SET_VALUES:
+      break;
+    default:
+      SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_ARG_WRONG, "Cannot handle insert mode %d", addv);
+    }
+    x += n*bs;
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterMultiSetUp_Private"
+/*
+   Makes room for the messages of k vectors at once, the buffer is kept for later VecScatterBeginMulti() with as many or fewer vectors
+*/
+static PetscErrorCode VecScatterMultiSetUp_Private(VecScatter_MPI_General *gen,PetscInt k)
+{
+  PetscErrorCode ierr;
+  PetscInt       size = k*gen->bs*gen->starts[gen->n];
+
+  PetscFunctionBegin;
+  if (!gen->multirequests) {
+    ierr = PetscMalloc(gen->n*sizeof(MPI_Request),&gen->multirequests);CHKERRQ(ierr);
+  }
+  if (size > gen->multisize) {
+    ierr = PetscFree(gen->multivalues);CHKERRQ(ierr);
+    ierr = PetscMalloc(size*sizeof(PetscScalar),&gen->multivalues);CHKERRQ(ierr);
+    gen->multisize = size;
+  }
+  PetscFunctionReturn(0);
+}
+
+/* Create the VecScatterBegin/End_P and VecScatterBegin/EndMulti_P for our chosen block sizes, and for any other block size */
 #define BS 1
 #include <../src/vec/vec/utils/vpscat.h>
 #define BS 2
@@ -1620,6 +1904,8 @@ PETSC_STATIC_INLINE PetscErrorCode Scatter_12(PetscInt n,const PetscInt *indices
 #include <../src/vec/vec/utils/vpscat.h>
 #define BS 12
 #include <../src/vec/vec/utils/vpscat.h>
+#define BS bs
+#include <../src/vec/vec/utils/vpscat.h>
 
 /* ==========================================================================================*/
 
@@ -1720,31 +2006,81 @@ PetscErrorCode VecScatterCreateLocal(VecScatter ctx,PetscInt nsends,const PetscI
   PetscFunctionReturn(0);
 }
 
+/*
+   Context for the callbacks of PetscCommBuildTwoSidedF() used by VecScatterCreate_PtoS(). The
+   rendezvous message to each rank is the number of indices sent to it.
+*/
+typedef struct {
+  PetscInt    *svalues;      /* indices packed by destination */
+  PetscInt    *sstarts;      /* location of the first index going to each destination */
+  PetscInt    nrecvs,nralloc;
+  PetscInt    **rvalues;     /* one buffer per received message */
+} VecScatterBTS;
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterBTSSend_Private"
+static PetscErrorCode VecScatterBTSSend_Private(MPI_Comm comm,const PetscMPIInt tag[],PetscMPIInt i,PetscMPIInt rank,void *sdata,MPI_Request req[],void *ctx)
+{
+  VecScatterBTS  *bts = (VecScatterBTS*)ctx;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Isend(bts->svalues+bts->sstarts[i],*(PetscMPIInt*)sdata,MPIU_INT,rank,tag[0],comm,&req[0]);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterBTSRecv_Private"
+static PetscErrorCode VecScatterBTSRecv_Private(MPI_Comm comm,const PetscMPIInt tag[],PetscMPIInt rank,void *rdata,MPI_Request req[],void *ctx)
+{
+  VecScatterBTS  *bts = (VecScatterBTS*)ctx;
+  PetscMPIInt    n = *(PetscMPIInt*)rdata;
+  PetscInt       k = bts->nrecvs;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (k == bts->nralloc) {
+    PetscInt **rvalues,nralloc = PetscMax(2*bts->nralloc,4);
+    ierr = PetscMalloc(nralloc*sizeof(PetscInt*),&rvalues);CHKERRQ(ierr);
+    ierr = PetscMemcpy(rvalues,bts->rvalues,k*sizeof(PetscInt*));CHKERRQ(ierr);
+    ierr = PetscFree(bts->rvalues);CHKERRQ(ierr);
+    bts->rvalues = rvalues;
+    bts->nralloc = nralloc;
+  }
+  ierr = PetscMalloc(n*sizeof(PetscInt),&bts->rvalues[k]);CHKERRQ(ierr);
+  ierr = MPI_Irecv(bts->rvalues[k],n,MPIU_INT,rank,tag[0],comm,&req[0]);CHKERRQ(ierr);
+  bts->nrecvs++;
+  PetscFunctionReturn(0);
+}
+
 /*
    bs indicates how many elements there are in each block. Normally this would be 1.
 
    contains check that PetscMPIInt can handle the sizes needed
+
+   The processes sending to this one are discovered with PetscCommBuildTwoSidedF(), so no
+   collective operation over arrays of the size of the communicator is needed.
 */
 #undef __FUNCT__
 #define __FUNCT__ "VecScatterCreate_PtoS"
 PetscErrorCode VecScatterCreate_PtoS(PetscInt nx,const PetscInt *inidx,PetscInt ny,const PetscInt *inidy,Vec xin,Vec yin,PetscInt bs,VecScatter ctx)
 {
   VecScatter_MPI_General *from,*to;
-  PetscMPIInt            size,rank,imdex,tag,n;
-  PetscInt               *source = PETSC_NULL,*owners = PETSC_NULL;
+  PetscMPIInt            size,rank;
+  PetscInt               *owners = PETSC_NULL;
   PetscInt               *lowner = PETSC_NULL,*start = PETSC_NULL,lengthy,lengthx;
-  PetscMPIInt            *nprocs = PETSC_NULL,nrecvs;
-  PetscInt               i,j,idx,nsends;
+  PetscMPIInt            *nprocs = PETSC_NULL,*perm;
+  PetscInt               i,j,idx,nsends,nrecvs;
   PetscInt               *owner = PETSC_NULL,*starts = PETSC_NULL,count,slen;
-  PetscInt               *rvalues,*svalues,base,*values,nprocslocal,recvtotal,*rsvalues;
-  PetscMPIInt            *onodes1,*olengths1;
+  PetscInt               *svalues,base,*values,nprocslocal;
+  PetscMPIInt            *onodes1,*olengths1,*sendranks,*sendlens;
   MPI_Comm               comm;
   MPI_Request            *send_waits = PETSC_NULL,*recv_waits = PETSC_NULL;
-  MPI_Status             recv_status,*send_status;
+  MPI_Status             *send_status;
+  VecScatterBTS          bts;
   PetscErrorCode         ierr;
 
   PetscFunctionBegin;
-  ierr = PetscObjectGetNewTag((PetscObject)ctx,&tag);CHKERRQ(ierr);
   ierr = PetscObjectGetComm((PetscObject)xin,&comm);CHKERRQ(ierr);
   ierr = MPI_Comm_rank(comm,&rank);CHKERRQ(ierr);
   ierr = MPI_Comm_size(comm,&size);CHKERRQ(ierr);
@@ -1774,25 +2110,12 @@ PetscErrorCode VecScatterCreate_PtoS(PetscInt nx,const PetscInt *inidx,PetscInt
   nprocslocal  = nprocs[rank];
   nprocs[rank] = 0;
   if (nprocslocal) nsends--;
-  /* inform other processors of number of messages and max length*/
-  ierr = PetscGatherNumberOfMessages(comm,PETSC_NULL,nprocs,&nrecvs);CHKERRQ(ierr);
-  ierr = PetscGatherMessageLengths(comm,nsends,nrecvs,nprocs,&onodes1,&olengths1);CHKERRQ(ierr);
-  ierr = PetscSortMPIIntWithArray(nrecvs,onodes1,olengths1);CHKERRQ(ierr);
-  recvtotal = 0; for (i=0; i<nrecvs; i++) recvtotal += olengths1[i];
 
-  /* post receives:   */
-  ierr = PetscMalloc3(recvtotal,PetscInt,&rvalues,nrecvs,PetscInt,&source,nrecvs,MPI_Request,&recv_waits);CHKERRQ(ierr);
-  count  = 0;
-  for (i=0; i<nrecvs; i++) {
-    ierr  = MPI_Irecv((rvalues+count),olengths1[i],MPIU_INT,onodes1[i],tag,comm,recv_waits+i);CHKERRQ(ierr);
-    count += olengths1[i];
-  }
-
-  /* do sends:
+  /* pack the sends:
      1) starts[i] gives the starting index in svalues for stuff going to
      the ith processor
   */
-  ierr = PetscMalloc3(nx,PetscInt,&svalues,nsends,MPI_Request,&send_waits,size+1,PetscInt,&starts);CHKERRQ(ierr);
+  ierr = PetscMalloc2(nx,PetscInt,&svalues,size+1,PetscInt,&starts);CHKERRQ(ierr);
 
   starts[0]  = 0;
   for (i=1; i<size; i++) { starts[i] = starts[i-1] + nprocs[i-1];}
@@ -1803,25 +2126,35 @@ PetscErrorCode VecScatterCreate_PtoS(PetscInt nx,const PetscInt *inidx,PetscInt
   }
   starts[0] = 0;
   for (i=1; i<size+1; i++) { starts[i] = starts[i-1] + nprocs[i-1];}
+  ierr = PetscMalloc3(nsends,PetscMPIInt,&sendranks,nsends,PetscMPIInt,&sendlens,nsends,PetscInt,&bts.sstarts);CHKERRQ(ierr);
   count = 0;
   for (i=0; i<size; i++) {
     if (nprocs[i]) {
-      ierr = MPI_Isend(svalues+starts[i],nprocs[i],MPIU_INT,i,tag,comm,send_waits+count++);CHKERRQ(ierr);
+      sendranks[count]     = i;
+      sendlens[count]      = nprocs[i];
+      bts.sstarts[count++] = starts[i];
     }
   }
 
+  /* discover the processes sending to us, the indices are sent during the rendezvous */
+  bts.svalues  = svalues;
+  bts.nrecvs   = 0;
+  bts.nralloc  = 0;
+  bts.rvalues  = PETSC_NULL;
+  ierr = PetscCommBuildTwoSidedF(comm,1,MPI_INT,nsends,sendranks,sendlens,&nrecvs,&onodes1,&olengths1,1,&send_waits,&recv_waits,VecScatterBTSSend_Private,VecScatterBTSRecv_Private,&bts);CHKERRQ(ierr);
+  ierr = PetscFree3(sendranks,sendlens,bts.sstarts);CHKERRQ(ierr);
+
   /*  wait on receives */
-  count  = nrecvs;
-  slen   = 0;
-  while (count) {
-    ierr = MPI_Waitany(nrecvs,recv_waits,&imdex,&recv_status);CHKERRQ(ierr);
-    /* unpack receives into our local space */
-    ierr = MPI_Get_count(&recv_status,MPIU_INT,&n);CHKERRQ(ierr);
-    slen += n;
-    count--;
+  if (nrecvs) {
+    ierr = MPI_Waitall(nrecvs,recv_waits,MPI_STATUSES_IGNORE);CHKERRQ(ierr);
   }
+  ierr = PetscFree(recv_waits);CHKERRQ(ierr);
 
-  if (slen != recvtotal) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Total message lengths %D not expected %D",slen,recvtotal);
+  /* sort the received messages by rank */
+  ierr = PetscMalloc(nrecvs*sizeof(PetscMPIInt),&perm);CHKERRQ(ierr);
+  for (i=0; i<nrecvs; i++) perm[i] = i;
+  ierr = PetscSortMPIIntWithArray(nrecvs,onodes1,perm);CHKERRQ(ierr);
+  slen = 0; for (i=0; i<nrecvs; i++) slen += olengths1[i];
 
   /* allocate entire send scatter context */
   ierr  = PetscNewLog(ctx,VecScatter_MPI_General,&to);CHKERRQ(ierr);
@@ -1836,20 +2169,22 @@ PetscErrorCode VecScatterCreate_PtoS(PetscInt nx,const PetscInt *inidx,PetscInt
 
     /* move the data into the send scatter */
     base     = owners[rank];
-    rsvalues = rvalues;
     for (i=0; i<nrecvs; i++) {
-      to->starts[i+1] = to->starts[i] + olengths1[i];
+      to->starts[i+1] = to->starts[i] + olengths1[perm[i]];
       to->procs[i]    = onodes1[i];
-      values = rsvalues;
-      rsvalues += olengths1[i];
-      for (j=0; j<olengths1[i]; j++) {
+      values = bts.rvalues[perm[i]];
+      for (j=0; j<olengths1[perm[i]]; j++) {
         to->indices[to->starts[i] + j] = values[j] - base;
       }
     }
   }
+  for (i=0; i<nrecvs; i++) {
+    ierr = PetscFree(bts.rvalues[i]);CHKERRQ(ierr);
+  }
+  ierr = PetscFree(bts.rvalues);CHKERRQ(ierr);
+  ierr = PetscFree(perm);CHKERRQ(ierr);
   ierr = PetscFree(olengths1);CHKERRQ(ierr);
   ierr = PetscFree(onodes1);CHKERRQ(ierr);
-  ierr = PetscFree3(rvalues,source,recv_waits);CHKERRQ(ierr);
 
   /* allocate entire receive scatter context */
   ierr = PetscNewLog(ctx,VecScatter_MPI_General,&from);CHKERRQ(ierr);
@@ -1885,7 +2220,8 @@ PetscErrorCode VecScatterCreate_PtoS(PetscInt nx,const PetscInt *inidx,PetscInt
     ierr = MPI_Waitall(nsends,send_waits,send_status);CHKERRQ(ierr);
     ierr = PetscFree(send_status);CHKERRQ(ierr);
   }
-  ierr = PetscFree3(svalues,send_waits,starts);CHKERRQ(ierr);
+  ierr = PetscFree(send_waits);CHKERRQ(ierr);
+  ierr = PetscFree2(svalues,starts);CHKERRQ(ierr);
 
   if (nprocslocal) {
     PetscInt nt = from->local.n = to->local.n = nprocslocal;
@@ -1923,6 +2259,204 @@ PetscErrorCode VecScatterCreate_PtoS(PetscInt nx,const PetscInt *inidx,PetscInt
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_MPI_WIN_ALLOCATE_SHARED)
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterSharedReorder_Private"
+/*
+    Moves the messages to processes on this node (noderank[i] != MPI_UNDEFINED) to the end of the list, keeping the
+    order otherwise, so that the MPI requests are only for the first n - nshared messages
+*/
+static PetscErrorCode VecScatterSharedReorder_Private(VecScatter_MPI_General *gen,PetscMPIInt *noderank)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,j,k,cnt = 0,*starts,*indices,pass;
+  PetscMPIInt    *procs,*ranks;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc4(gen->n+1,PetscInt,&starts,gen->starts[gen->n],PetscInt,&indices,gen->n,PetscMPIInt,&procs,gen->n,PetscMPIInt,&ranks);CHKERRQ(ierr);
+  starts[0] = 0;
+  for (pass=0,k=0; pass<2; pass++) {
+    for (i=0; i<gen->n; i++) {
+      if ((noderank[i] == MPI_UNDEFINED) != !pass) continue;
+      for (j=gen->starts[i]; j<gen->starts[i+1]; j++) indices[cnt++] = gen->indices[j];
+      procs[k]    = gen->procs[i];
+      ranks[k]    = noderank[i];
+      starts[k+1] = cnt;
+      k++;
+    }
+    if (!pass) gen->nshared = gen->n - k;
+  }
+  ierr = PetscMemcpy(gen->starts,starts,(gen->n+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(gen->indices,indices,gen->starts[gen->n]*sizeof(PetscInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(gen->procs,procs,gen->n*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  ierr = PetscMemcpy(noderank,ranks,gen->n*sizeof(PetscMPIInt));CHKERRQ(ierr);
+  ierr = PetscFree4(starts,indices,procs,ranks);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterCreateShared_Private"
+/*
+    Sets up the exchange of the messages between processes on the same node through MPI-3 shared memory.
+
+    Each process owns a segment of a shared window holding two buffers (used by alternate scatters) into which it
+    packs its messages to the other processes on the node, in VecScatterBegin(). In VecScatterEnd(), after a barrier
+    on the node, each process unpacks its messages from the node directly from the segments of the senders. Since a
+    process cannot pack into a buffer again before all the processes on the node have passed the barrier of the next
+    scatter, one barrier per scatter is enough.
+
+    The to and from lists are reordered so the messages within the node come last; they are used as send and receive
+    lists in the forward and in the reverse scatters.
+*/
+static PetscErrorCode VecScatterCreateShared_Private(VecScatter ctx,VecScatter_MPI_General *to,VecScatter_MPI_General *from)
+{
+  MPI_Comm       comm = ((PetscObject)ctx)->comm,shmcomm;
+  MPI_Group      group,shmgroup;
+  MPI_Win        win;
+  MPI_Request    *requests;
+  MPI_Aint       size;
+  PetscMPIInt    tag[2],*torank,*fromrank,dispunit,nrequests = 0;
+  PetscInt       bs = to->bs,k,p,toff,foff,tolen,fromlen,half,*tooffset,*fromoffset,*topeer,*frompeer,nsh[2],gnsh[2];
+  PetscScalar    *base,*peer;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MPI_Comm_split_type(comm,MPI_COMM_TYPE_SHARED,0,MPI_INFO_NULL,&shmcomm);CHKERRQ(ierr);
+  ierr = MPI_Comm_group(comm,&group);CHKERRQ(ierr);
+  ierr = MPI_Comm_group(shmcomm,&shmgroup);CHKERRQ(ierr);
+  ierr = PetscMalloc2(to->n,PetscMPIInt,&torank,from->n,PetscMPIInt,&fromrank);CHKERRQ(ierr);
+  ierr = MPI_Group_translate_ranks(group,(PetscMPIInt)to->n,to->procs,shmgroup,torank);CHKERRQ(ierr);
+  ierr = MPI_Group_translate_ranks(group,(PetscMPIInt)from->n,from->procs,shmgroup,fromrank);CHKERRQ(ierr);
+  ierr = MPI_Group_free(&group);CHKERRQ(ierr);
+  ierr = MPI_Group_free(&shmgroup);CHKERRQ(ierr);
+  ierr = VecScatterSharedReorder_Private(to,torank);CHKERRQ(ierr);
+  ierr = VecScatterSharedReorder_Private(from,fromrank);CHKERRQ(ierr);
+
+  /* each buffer holds the messages of the to list followed by those of the from list */
+  toff    = to->n - to->nshared;
+  foff    = from->n - from->nshared;
+  tolen   = bs*(to->starts[to->n] - to->starts[toff]);
+  fromlen = bs*(from->starts[from->n] - from->starts[foff]);
+  half    = tolen + fromlen;
+  ierr = MPI_Win_allocate_shared((MPI_Aint)(2*half*sizeof(PetscScalar)),sizeof(PetscScalar),MPI_INFO_NULL,shmcomm,&base,&win);CHKERRQ(ierr);
+  ierr = MPI_Win_lock_all(MPI_MODE_NOCHECK,win);CHKERRQ(ierr);
+
+  ierr = PetscMalloc2(2*to->nshared,PetscScalar*,&to->shmsend,2*to->nshared,PetscScalar*,&to->shmrecv);CHKERRQ(ierr);
+  ierr = PetscMalloc2(2*from->nshared,PetscScalar*,&from->shmsend,2*from->nshared,PetscScalar*,&from->shmrecv);CHKERRQ(ierr);
+  ierr = PetscMalloc5(to->nshared,PetscInt,&tooffset,from->nshared,PetscInt,&fromoffset,to->nshared,PetscInt,&topeer,from->nshared,PetscInt,&frompeer,2*(to->nshared+from->nshared),MPI_Request,&requests);CHKERRQ(ierr);
+  for (k=0; k<to->nshared; k++) {
+    tooffset[k] = bs*(to->starts[toff+k] - to->starts[toff]);
+    for (p=0; p<2; p++) to->shmsend[2*k+p] = base + p*half + tooffset[k];
+  }
+  for (k=0; k<from->nshared; k++) {
+    fromoffset[k] = tolen + bs*(from->starts[foff+k] - from->starts[foff]);
+    for (p=0; p<2; p++) from->shmsend[2*k+p] = base + p*half + fromoffset[k];
+  }
+
+  /* tell the receivers where in my segment their messages are, for the forward (to list) and reverse (from list) scatters */
+  ierr = PetscObjectGetNewTag((PetscObject)ctx,&tag[0]);CHKERRQ(ierr);
+  ierr = PetscObjectGetNewTag((PetscObject)ctx,&tag[1]);CHKERRQ(ierr);
+  for (k=0; k<from->nshared; k++) {
+    ierr = MPI_Irecv(frompeer+k,1,MPIU_INT,from->procs[foff+k],tag[0],comm,requests+nrequests++);CHKERRQ(ierr);
+  }
+  for (k=0; k<to->nshared; k++) {
+    ierr = MPI_Irecv(topeer+k,1,MPIU_INT,to->procs[toff+k],tag[1],comm,requests+nrequests++);CHKERRQ(ierr);
+  }
+  for (k=0; k<to->nshared; k++) {
+    ierr = MPI_Isend(tooffset+k,1,MPIU_INT,to->procs[toff+k],tag[0],comm,requests+nrequests++);CHKERRQ(ierr);
+  }
+  for (k=0; k<from->nshared; k++) {
+    ierr = MPI_Isend(fromoffset+k,1,MPIU_INT,from->procs[foff+k],tag[1],comm,requests+nrequests++);CHKERRQ(ierr);
+  }
+  ierr = MPI_Waitall(nrequests,requests,MPI_STATUSES_IGNORE);CHKERRQ(ierr);
+
+  for (k=0; k<from->nshared; k++) {
+    ierr = MPI_Win_shared_query(win,fromrank[foff+k],&size,&dispunit,&peer);CHKERRQ(ierr);
+    for (p=0; p<2; p++) from->shmrecv[2*k+p] = peer + p*(size/(2*sizeof(PetscScalar))) + frompeer[k];
+  }
+  for (k=0; k<to->nshared; k++) {
+    ierr = MPI_Win_shared_query(win,torank[toff+k],&size,&dispunit,&peer);CHKERRQ(ierr);
+    for (p=0; p<2; p++) to->shmrecv[2*k+p] = peer + p*(size/(2*sizeof(PetscScalar))) + topeer[k];
+  }
+  ierr = PetscFree5(tooffset,fromoffset,topeer,frompeer,requests);CHKERRQ(ierr);
+  ierr = PetscFree2(torank,fromrank);CHKERRQ(ierr);
+
+  to->use_shared = from->use_shared = PETSC_TRUE;
+  to->shmcomm    = from->shmcomm    = shmcomm;
+  to->shmwin     = from->shmwin     = win;
+  to->shmparity  = from->shmparity  = 0;
+
+  nsh[0] = to->nshared; nsh[1] = to->n;
+  ierr = MPI_Allreduce(nsh,gnsh,2,MPIU_INT,MPI_SUM,comm);CHKERRQ(ierr);
+  ierr = PetscInfo2(ctx,"Using MPI-3 shared memory for %D of the %D messages\n",gnsh[0],gnsh[1]);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterCreateRuns_Private"
+/*
+    Finds the runs of blocks at a constant distance in the indices of each message, for example the rows of a plane
+    of a DMDA. They are used to pack or unpack the messages when there are at most a quarter as many runs as blocks,
+    or always or never with -vecscatter_runs <true,false>.
+*/
+static PetscErrorCode VecScatterCreateRuns_Private(VecScatter ctx,VecScatter_MPI_General *gen,PetscBool set,PetscBool use)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,j,k,d,end,pass,nruns = 0,bs = gen->bs,*idx = gen->indices;
+
+  PetscFunctionBegin;
+  for (pass=0; pass<2; pass++) {
+    nruns = 0;
+    for (i=0; i<gen->n; i++) {
+      if (pass) gen->runstarts[i] = nruns;
+      end = gen->starts[i+1];
+      for (j=gen->starts[i]; j<end; j=k) {
+        d = (j+1 < end) ? idx[j+1] - idx[j] : bs;
+        for (k=j+1; k<end && idx[k]-idx[k-1] == d; k++) ;
+        /* rather start a run of adjacent blocks than pair a block with the first of them */
+        if (k-j == 2 && d != bs && k < end && idx[k]-idx[k-1] == bs) {k = j+1; d = bs;}
+        if (pass) {
+          gen->runs[3*nruns]   = idx[j];
+          gen->runs[3*nruns+1] = k-j;
+          gen->runs[3*nruns+2] = d;
+        }
+        nruns++;
+      }
+    }
+    if (!pass) {
+      if (!set) use = (PetscBool)(nruns && 4*nruns <= gen->starts[gen->n]);
+      if (!use) PetscFunctionReturn(0);
+      ierr = PetscMalloc2(gen->n+1,PetscInt,&gen->runstarts,3*nruns,PetscInt,&gen->runs);CHKERRQ(ierr);
+    }
+  }
+  gen->runstarts[gen->n] = nruns;
+  gen->use_runs          = PETSC_TRUE;
+  ierr = PetscInfo2(ctx,"Packing %D blocks as %D runs\n",gen->starts[gen->n],nruns);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterRemapRuns_Private"
+/*
+    Called by VecScatterRemap() after it has changed the indices of gen; the runs found from the old indices are
+    discarded and found again from the new ones.
+*/
+PetscErrorCode VecScatterRemapRuns_Private(VecScatter ctx,VecScatter_MPI_General *gen)
+{
+  PetscErrorCode ierr;
+  PetscBool      use_runs = PETSC_FALSE,set;
+
+  PetscFunctionBegin;
+  if (gen->use_runs) {
+    ierr = PetscFree2(gen->runstarts,gen->runs);CHKERRQ(ierr);
+    gen->use_runs = PETSC_FALSE;
+  }
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-vecscatter_runs",&use_runs,&set);CHKERRQ(ierr);
+  ierr = VecScatterCreateRuns_Private(ctx,gen,set,use_runs);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*
    bs indicates how many elements there are in each block. Normally this would be 1.
 */
@@ -1935,6 +2469,7 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
   PetscInt       bs   = to->bs;
   PetscMPIInt    size;
   PetscInt       i, n;
+  PetscBool      use_shared = PETSC_FALSE,use_runs = PETSC_FALSE,set;
   PetscErrorCode ierr;
 
   PetscFunctionBegin;
@@ -1978,6 +2513,25 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
   from->use_window = to->use_window;
 #endif
 
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-vecscatter_shared",&use_shared,PETSC_NULL);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_MPI_WIN_ALLOCATE_SHARED)
+  if (use_shared && (to->use_alltoallv || to->use_window)) {
+    ierr = PetscInfo(ctx,"Ignoring -vecscatter_shared with -vecscatter_alltoall or -vecscatter_window\n");CHKERRQ(ierr);
+    use_shared = PETSC_FALSE;
+  }
+  if (use_shared) {
+    ierr = VecScatterCreateShared_Private(ctx,to,from);CHKERRQ(ierr);
+  }
+#else
+  if (use_shared) {
+    ierr = PetscInfo(ctx,"Ignoring -vecscatter_shared, MPI_Win_allocate_shared() was not found by configure\n");CHKERRQ(ierr);
+  }
+#endif
+
+  ierr = PetscOptionsGetBool(PETSC_NULL,"-vecscatter_runs",&use_runs,&set);CHKERRQ(ierr);
+  ierr = VecScatterCreateRuns_Private(ctx,to,set,use_runs);CHKERRQ(ierr);
+  ierr = VecScatterCreateRuns_Private(ctx,from,set,use_runs);CHKERRQ(ierr);
+
   if (to->use_alltoallv) {
 
     ierr       = PetscMalloc2(size,PetscMPIInt,&to->counts,size,PetscMPIInt,&to->displs);CHKERRQ(ierr);
@@ -2097,6 +2651,10 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
     /* Register the receives that you will use later (sends for scatter reverse) */
     ierr = PetscOptionsGetBool(PETSC_NULL,"-vecscatter_rsend",&use_rsend,PETSC_NULL);CHKERRQ(ierr);
     ierr = PetscOptionsGetBool(PETSC_NULL,"-vecscatter_ssend",&use_ssend,PETSC_NULL);CHKERRQ(ierr);
+    if (use_rsend && to->use_shared) {
+      ierr = PetscInfo(ctx,"Ignoring -vecscatter_rsend with -vecscatter_shared\n");CHKERRQ(ierr);
+      use_rsend = PETSC_FALSE;
+    }
     if (use_rsend) {
       ierr = PetscInfo(ctx,"Using VecScatter ready receiver mode\n");CHKERRQ(ierr);
       to->use_readyreceiver    = PETSC_TRUE;
@@ -2109,7 +2667,7 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
       ierr = PetscInfo(ctx,"Using VecScatter Ssend mode\n");CHKERRQ(ierr);
     }
 
-    for (i=0; i<from->n; i++) {
+    for (i=0; i<from->n-from->nshared; i++) {
       if (use_rsend) {
         ierr = MPI_Rsend_init(Srvalues+bs*rstarts[i],bs*rstarts[i+1]-bs*rstarts[i],MPIU_SCALAR,rprocs[i],tagr,comm,rev_swaits+i);CHKERRQ(ierr);
       } else if (use_ssend) {
@@ -2119,7 +2677,7 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
       }
     }
 
-    for (i=0; i<to->n; i++) {
+    for (i=0; i<to->n-to->nshared; i++) {
       if (use_rsend) {
         ierr = MPI_Rsend_init(Ssvalues+bs*sstarts[i],bs*sstarts[i+1]-bs*sstarts[i],MPIU_SCALAR,sprocs[i],tag,comm,swaits+i);CHKERRQ(ierr);
       } else if (use_ssend) {
@@ -2129,10 +2687,10 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
       }
     }
     /* Register receives for scatter and reverse */
-    for (i=0; i<from->n; i++) {
+    for (i=0; i<from->n-from->nshared; i++) {
       ierr = MPI_Recv_init(Srvalues+bs*rstarts[i],bs*rstarts[i+1]-bs*rstarts[i],MPIU_SCALAR,rprocs[i],tag,comm,rwaits+i);CHKERRQ(ierr);
     }
-    for (i=0; i<to->n; i++) {
+    for (i=0; i<to->n-to->nshared; i++) {
       ierr = MPI_Recv_init(Ssvalues+bs*sstarts[i],bs*sstarts[i+1]-bs*sstarts[i],MPIU_SCALAR,sprocs[i],tagr,comm,rev_rwaits+i);CHKERRQ(ierr);
     }
     if (use_rsend) {
@@ -2155,41 +2713,67 @@ PetscErrorCode VecScatterCreateCommon_PtoS(VecScatter_MPI_General *from,VecScatt
   case 12:
     ctx->begin     = VecScatterBegin_12;
     ctx->end       = VecScatterEnd_12;
+    ctx->beginmulti = VecScatterBeginMulti_12;
+    ctx->endmulti   = VecScatterEndMulti_12;
     break;
   case 8:
     ctx->begin     = VecScatterBegin_8;
     ctx->end       = VecScatterEnd_8;
+    ctx->beginmulti = VecScatterBeginMulti_8;
+    ctx->endmulti   = VecScatterEndMulti_8;
     break;
   case 7:
     ctx->begin     = VecScatterBegin_7;
     ctx->end       = VecScatterEnd_7;
+    ctx->beginmulti = VecScatterBeginMulti_7;
+    ctx->endmulti   = VecScatterEndMulti_7;
     break;
   case 6:
     ctx->begin     = VecScatterBegin_6;
     ctx->end       = VecScatterEnd_6;
+    ctx->beginmulti = VecScatterBeginMulti_6;
+    ctx->endmulti   = VecScatterEndMulti_6;
     break;
   case 5:
     ctx->begin     = VecScatterBegin_5;
     ctx->end       = VecScatterEnd_5;
+    ctx->beginmulti = VecScatterBeginMulti_5;
+    ctx->endmulti   = VecScatterEndMulti_5;
     break;
   case 4:
     ctx->begin     = VecScatterBegin_4;
     ctx->end       = VecScatterEnd_4;
+    ctx->beginmulti = VecScatterBeginMulti_4;
+    ctx->endmulti   = VecScatterEndMulti_4;
     break;
   case 3:
     ctx->begin     = VecScatterBegin_3;
     ctx->end       = VecScatterEnd_3;
+    ctx->beginmulti = VecScatterBeginMulti_3;
+    ctx->endmulti   = VecScatterEndMulti_3;
     break;
   case 2:
     ctx->begin     = VecScatterBegin_2;
     ctx->end       = VecScatterEnd_2;
+    ctx->beginmulti = VecScatterBeginMulti_2;
+    ctx->endmulti   = VecScatterEndMulti_2;
     break;
   case 1:
     ctx->begin     = VecScatterBegin_1;
     ctx->end       = VecScatterEnd_1;
+    ctx->beginmulti = VecScatterBeginMulti_1;
+    ctx->endmulti   = VecScatterEndMulti_1;
     break;
   default:
-    SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Blocksize not supported");
+    ctx->begin     = VecScatterBegin_bs;
+    ctx->end       = VecScatterEnd_bs;
+    ctx->beginmulti = VecScatterBeginMulti_bs;
+    ctx->endmulti   = VecScatterEndMulti_bs;
+  }
+  /* the scatters of several vectors at once use plain MPI_Isend() and MPI_Irecv() */
+  if (to->use_alltoallv || to->use_alltoallw || to->use_window || to->use_shared || to->use_readyreceiver) {
+    ctx->beginmulti = 0;
+    ctx->endmulti   = 0;
   }
   ctx->view      = VecScatterView_MPI;
   /* Check if the local scatter is actually a copy; important special case */
@@ -33,8 +33,8 @@ PetscErrorCode PETSCMAP1(VecScatterBegin)(VecScatter ctx,Vec xin,Vec yin,InsertM
   }
   bs       = to->bs;
   svalues  = to->values;
-  nrecvs   = from->n;
-  nsends   = to->n;
+  nrecvs   = from->n - from->nshared;
+  nsends   = to->n - to->nshared;
   indices  = to->indices;
   sstarts  = to->starts;
 #if defined(PETSC_HAVE_CUSP)
@@ -104,7 +104,11 @@ PetscErrorCode PETSCMAP1(VecScatterBegin)(VecScatter ctx,Vec xin,Vec yin,InsertM
 #endif
     if (ctx->packtogether || to->use_alltoallv || to->use_window) {
       /* this version packs all the messages together and sends, when -vecscatter_packtogether used */
-      PETSCMAP1(Pack)(sstarts[nsends],indices,xv,svalues);
+      if (to->use_runs) {
+        ierr = PackRuns(to->runstarts[nsends],to->runs,xv,svalues,bs);CHKERRQ(ierr);
+      } else {
+        PETSCMAP1(Pack)(sstarts[nsends],indices,xv,svalues,bs);
+      }
       if (to->use_alltoallv) {
         ierr = MPI_Alltoallv(to->values,to->counts,to->displs,MPIU_SCALAR,from->values,from->counts,from->displs,MPIU_SCALAR,((PetscObject)ctx)->comm);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MPI_WIN_CREATE)
@@ -118,12 +122,16 @@ PetscErrorCode PETSCMAP1(VecScatterBegin)(VecScatter ctx,Vec xin,Vec yin,InsertM
         }
 #endif
       } else if (nsends) {
-        ierr = MPI_Startall_isend(to->starts[to->n],nsends,swaits);CHKERRQ(ierr);
+        ierr = MPI_Startall_isend(to->starts[nsends],nsends,swaits);CHKERRQ(ierr);
       }
     } else {
       /* this version packs and sends one at a time */
       for (i=0; i<nsends; i++) {
-        PETSCMAP1(Pack)(sstarts[i+1]-sstarts[i],indices + sstarts[i],xv,svalues + bs*sstarts[i]);
+        if (to->use_runs) {
+          ierr = PackRuns(to->runstarts[i+1]-to->runstarts[i],to->runs + 3*to->runstarts[i],xv,svalues + bs*sstarts[i],bs);CHKERRQ(ierr);
+        } else {
+          PETSCMAP1(Pack)(sstarts[i+1]-sstarts[i],indices + sstarts[i],xv,svalues + bs*sstarts[i],bs);
+        }
         ierr = MPI_Start_isend(sstarts[i+1]-sstarts[i],swaits+i);CHKERRQ(ierr);
       }
     }
@@ -132,6 +140,17 @@ PetscErrorCode PETSCMAP1(VecScatterBegin)(VecScatter ctx,Vec xin,Vec yin,InsertM
       /* post receives since they were not previously posted   */
       if (nrecvs) {ierr = MPI_Startall_irecv(from->starts[nrecvs]*bs,nrecvs,rwaits);CHKERRQ(ierr);}
     }
+
+#if defined(PETSC_HAVE_MPI_WIN_ALLOCATE_SHARED)
+    /* pack the messages to processes on this node into the shared memory they read them from in VecScatterEnd() */
+    for (i=nsends; i<to->n; i++) {
+      if (to->use_runs) {
+        ierr = PackRuns(to->runstarts[i+1]-to->runstarts[i],to->runs + 3*to->runstarts[i],xv,to->shmsend[2*(i-nsends)+to->shmparity],bs);CHKERRQ(ierr);
+      } else {
+        PETSCMAP1(Pack)(sstarts[i+1]-sstarts[i],indices + sstarts[i],xv,to->shmsend[2*(i-nsends)+to->shmparity],bs);
+      }
+    }
+#endif
   }
 
   /* take care of local scatters */
@@ -139,7 +158,7 @@ PetscErrorCode PETSCMAP1(VecScatterBegin)(VecScatter ctx,Vec xin,Vec yin,InsertM
     if (to->local.is_copy && addv == INSERT_VALUES) {
       ierr = PetscMemcpy(yv + from->local.copy_start,xv + to->local.copy_start,to->local.copy_length);CHKERRQ(ierr);
     } else {
-      ierr = PETSCMAP1(Scatter)(to->local.n,to->local.vslots,xv,from->local.vslots,yv,addv);CHKERRQ(ierr);
+      ierr = PETSCMAP1(Scatter)(to->local.n,to->local.vslots,xv,from->local.vslots,yv,addv,bs);CHKERRQ(ierr);
     }
   }
 #if defined(PETSC_HAVE_CUSP)
@@ -164,7 +183,7 @@ PetscErrorCode PETSCMAP1(VecScatterEnd)(VecScatter ctx,Vec xin,Vec yin,InsertMod
   VecScatter_MPI_General *to,*from;
   PetscScalar            *rvalues,*yv;
   PetscErrorCode         ierr;
-  PetscInt               nrecvs,nsends,*indices,count,*rstarts,bs;
+  PetscInt               i,nrecvs,nsends,*indices,count,*rstarts,bs;
   PetscMPIInt            imdex;
   MPI_Request            *rwaits,*swaits;
   MPI_Status             xrstatus,*rstatus,*sstatus;
@@ -187,18 +206,39 @@ PetscErrorCode PETSCMAP1(VecScatterEnd)(VecScatter ctx,Vec xin,Vec yin,InsertMod
   }
   bs       = from->bs;
   rvalues  = from->values;
-  nrecvs   = from->n;
-  nsends   = to->n;
+  nrecvs   = from->n - from->nshared;
+  nsends   = to->n - to->nshared;
   indices  = from->indices;
   rstarts  = from->starts;
 
+#if defined(PETSC_HAVE_MPI_WIN_ALLOCATE_SHARED)
+  if (to->use_shared) {
+    /* once all the processes on this node have packed their messages, unpack ours directly from their memory */
+    ierr = MPI_Win_sync(to->shmwin);CHKERRQ(ierr);
+    ierr = MPI_Barrier(to->shmcomm);CHKERRQ(ierr);
+    ierr = MPI_Win_sync(to->shmwin);CHKERRQ(ierr);
+    for (i=nrecvs; i<from->n; i++) {
+      if (from->use_runs) {
+        ierr = UnPackRuns(from->runstarts[i+1]-from->runstarts[i],from->runs + 3*from->runstarts[i],from->shmrecv[2*(i-nrecvs)+from->shmparity],yv,addv,bs);CHKERRQ(ierr);
+      } else {
+        ierr = PETSCMAP1(UnPack)(rstarts[i+1]-rstarts[i],from->shmrecv[2*(i-nrecvs)+from->shmparity],indices + rstarts[i],yv,addv,bs);CHKERRQ(ierr);
+      }
+    }
+    to->shmparity = from->shmparity = !to->shmparity;
+  }
+#endif
+
   if (ctx->packtogether || (to->use_alltoallw && (addv != INSERT_VALUES)) || (to->use_alltoallv && !to->use_alltoallw) || to->use_window) {
 #if defined(PETSC_HAVE_MPI_WIN_CREATE)
     if (to->use_window) {ierr = MPI_Win_fence(0,from->window);CHKERRQ(ierr);}
     else
 #endif
     if (nrecvs && !to->use_alltoallv) {ierr = MPI_Waitall(nrecvs,rwaits,rstatus);CHKERRQ(ierr);}
-    ierr = PETSCMAP1(UnPack)(from->starts[from->n],from->values,indices,yv,addv);CHKERRQ(ierr);
+    if (from->use_runs) {
+      ierr = UnPackRuns(from->runstarts[nrecvs],from->runs,from->values,yv,addv,bs);CHKERRQ(ierr);
+    } else {
+      ierr = PETSCMAP1(UnPack)(from->starts[nrecvs],from->values,indices,yv,addv,bs);CHKERRQ(ierr);
+    }
   } else if (!to->use_alltoallw) {
     /* unpack one at a time */
     count = nrecvs;
@@ -210,7 +250,11 @@ PetscErrorCode PETSCMAP1(VecScatterEnd)(VecScatter ctx,Vec xin,Vec yin,InsertMod
         ierr = MPI_Waitany(nrecvs,rwaits,&imdex,&xrstatus);CHKERRQ(ierr);
       }
       /* unpack receives into our local space */
-      ierr = PETSCMAP1(UnPack)(rstarts[imdex+1] - rstarts[imdex],rvalues + bs*rstarts[imdex],indices + rstarts[imdex],yv,addv);CHKERRQ(ierr);
+      if (from->use_runs) {
+        ierr = UnPackRuns(from->runstarts[imdex+1]-from->runstarts[imdex],from->runs + 3*from->runstarts[imdex],rvalues + bs*rstarts[imdex],yv,addv,bs);CHKERRQ(ierr);
+      } else {
+        ierr = PETSCMAP1(UnPack)(rstarts[imdex+1] - rstarts[imdex],rvalues + bs*rstarts[imdex],indices + rstarts[imdex],yv,addv,bs);CHKERRQ(ierr);
+      }
       count--;
     }
   }
@@ -232,6 +276,116 @@ PetscErrorCode PETSCMAP1(VecScatterEnd)(VecScatter ctx,Vec xin,Vec yin,InsertMod
   PetscFunctionReturn(0);
 }
 
+/* --------------------------------------------------------------------------------------*/
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterBeginMulti_" PetscStringize(BS)
+/*
+    Sends one message to each process with its values of all the k vectors, the vectors one after the other
+*/
+PetscErrorCode PETSCMAP1(VecScatterBeginMulti)(VecScatter ctx,PetscInt k,Vec *xin,Vec *yin,InsertMode addv,ScatterMode mode)
+{
+  VecScatter_MPI_General *to,*from;
+  PetscScalar            *xv,*yv,*svalues;
+  PetscErrorCode         ierr;
+  PetscInt               i,j,len,*indices,*sstarts,*rstarts,bs;
+  MPI_Comm               comm = ((PetscObject)ctx)->comm;
+  PetscMPIInt            tag  = ((PetscObject)ctx)->tag;
+
+  PetscFunctionBegin;
+  if (mode & SCATTER_REVERSE) {
+    to   = (VecScatter_MPI_General*)ctx->fromdata;
+    from = (VecScatter_MPI_General*)ctx->todata;
+  } else {
+    to   = (VecScatter_MPI_General*)ctx->todata;
+    from = (VecScatter_MPI_General*)ctx->fromdata;
+  }
+  bs       = to->bs;
+  indices  = to->indices;
+  sstarts  = to->starts;
+  rstarts  = from->starts;
+
+  if (!(mode & SCATTER_LOCAL)) {
+    ierr = VecScatterMultiSetUp_Private(to,k);CHKERRQ(ierr);
+    ierr = VecScatterMultiSetUp_Private(from,k);CHKERRQ(ierr);
+    for (i=0; i<from->n; i++) {
+      ierr = MPI_Irecv(from->multivalues + k*bs*rstarts[i],k*bs*(rstarts[i+1]-rstarts[i]),MPIU_SCALAR,from->procs[i],tag,comm,from->multirequests+i);CHKERRQ(ierr);
+    }
+  }
+  svalues = to->multivalues;
+
+  for (j=0; j<k; j++) {
+    ierr = VecGetArrayRead(xin[j],(const PetscScalar**)&xv);CHKERRQ(ierr);
+    if (xin[j] != yin[j]) {ierr = VecGetArray(yin[j],&yv);CHKERRQ(ierr);} else {yv = xv;}
+    if (!(mode & SCATTER_LOCAL)) {
+      for (i=0; i<to->n; i++) {
+        len = sstarts[i+1]-sstarts[i];
+        if (to->use_runs) {
+          ierr = PackRuns(to->runstarts[i+1]-to->runstarts[i],to->runs + 3*to->runstarts[i],xv,svalues + bs*(k*sstarts[i] + j*len),bs);CHKERRQ(ierr);
+        } else {
+          PETSCMAP1(Pack)(len,indices + sstarts[i],xv,svalues + bs*(k*sstarts[i] + j*len),bs);
+        }
+      }
+    }
+    if (to->local.n) {
+      if (to->local.is_copy && addv == INSERT_VALUES) {
+        ierr = PetscMemcpy(yv + from->local.copy_start,xv + to->local.copy_start,to->local.copy_length);CHKERRQ(ierr);
+      } else {
+        ierr = PETSCMAP1(Scatter)(to->local.n,to->local.vslots,xv,from->local.vslots,yv,addv,bs);CHKERRQ(ierr);
+      }
+    }
+    ierr = VecRestoreArrayRead(xin[j],(const PetscScalar**)&xv);CHKERRQ(ierr);
+    if (xin[j] != yin[j]) {ierr = VecRestoreArray(yin[j],&yv);CHKERRQ(ierr);}
+  }
+
+  if (!(mode & SCATTER_LOCAL)) {
+    for (i=0; i<to->n; i++) {
+      ierr = MPI_Isend(svalues + k*bs*sstarts[i],k*bs*(sstarts[i+1]-sstarts[i]),MPIU_SCALAR,to->procs[i],tag,comm,to->multirequests+i);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterEndMulti_" PetscStringize(BS)
+PetscErrorCode PETSCMAP1(VecScatterEndMulti)(VecScatter ctx,PetscInt k,Vec *xin,Vec *yin,InsertMode addv,ScatterMode mode)
+{
+  VecScatter_MPI_General *to,*from;
+  PetscScalar            *rvalues,*yv;
+  PetscErrorCode         ierr;
+  PetscInt               i,j,len,*indices,*rstarts,bs;
+
+  PetscFunctionBegin;
+  if (mode & SCATTER_LOCAL) PetscFunctionReturn(0);
+  if (mode & SCATTER_REVERSE) {
+    to   = (VecScatter_MPI_General*)ctx->fromdata;
+    from = (VecScatter_MPI_General*)ctx->todata;
+  } else {
+    to   = (VecScatter_MPI_General*)ctx->todata;
+    from = (VecScatter_MPI_General*)ctx->fromdata;
+  }
+  bs       = from->bs;
+  rvalues  = from->multivalues;
+  indices  = from->indices;
+  rstarts  = from->starts;
+
+  if (from->n) {ierr = MPI_Waitall(from->n,from->multirequests,MPI_STATUSES_IGNORE);CHKERRQ(ierr);}
+  for (j=0; j<k; j++) {
+    ierr = VecGetArray(yin[j],&yv);CHKERRQ(ierr);
+    for (i=0; i<from->n; i++) {
+      len = rstarts[i+1]-rstarts[i];
+      if (from->use_runs) {
+        ierr = UnPackRuns(from->runstarts[i+1]-from->runstarts[i],from->runs + 3*from->runstarts[i],rvalues + bs*(k*rstarts[i] + j*len),yv,addv,bs);CHKERRQ(ierr);
+      } else {
+        ierr = PETSCMAP1(UnPack)(len,rvalues + bs*(k*rstarts[i] + j*len),indices + rstarts[i],yv,addv,bs);CHKERRQ(ierr);
+      }
+    }
+    ierr = VecRestoreArray(yin[j],&yv);CHKERRQ(ierr);
+  }
+  if (to->n) {ierr = MPI_Waitall(to->n,to->multirequests,MPI_STATUSES_IGNORE);CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
+
 #undef PETSCMAP1_a
 #undef PETSCMAP1_b
 #undef PETSCMAP1
@@ -808,6 +808,7 @@ PetscErrorCode VecScatterView_SSToSS(VecScatter in,PetscViewer viewer)
 extern PetscErrorCode VecScatterCreate_PtoS(PetscInt,const PetscInt *,PetscInt,const PetscInt *,Vec,Vec,PetscInt,VecScatter);
 extern PetscErrorCode VecScatterCreate_PtoP(PetscInt,const PetscInt *,PetscInt,const PetscInt *,Vec,Vec,PetscInt,VecScatter);
 extern PetscErrorCode VecScatterCreate_StoP(PetscInt,const PetscInt *,PetscInt,const PetscInt *,Vec,Vec,PetscInt,VecScatter);
+extern PetscErrorCode VecScatterRemapRuns_Private(VecScatter,VecScatter_MPI_General*);
 
 /* =======================================================================*/
 #define VEC_SEQ_ID 0
@@ -817,10 +818,11 @@ extern PetscErrorCode VecScatterCreate_StoP(PetscInt,const PetscInt *,PetscInt,c
 #define IS_BLOCK_ID   2
 
 /*
-   Blocksizes we have optimized scatters for
+   Blocksizes we have optimized scatters for, 1 to 8 and 12 have their own kernels and the others share kernels that
+   take the block size at run time
 */
 
-#define VecScatterOptimizedBS(mbs) ((2 <= mbs && mbs <= 8) || mbs == 12)
+#define VecScatterOptimizedBS(mbs) (2 <= mbs)
 
 PetscErrorCode  VecScatterCreateEmpty(MPI_Comm comm,VecScatter *newctx)
 {
@@ -874,6 +876,8 @@ PetscErrorCode  VecScatterCreateEmpty(MPI_Comm comm,VecScatter *newctx)
 .  -vecscatter_alltoall     - Uses MPI all to all communication for scatter
 .  -vecscatter_window       - Use MPI 2 window operations to move data
 .  -vecscatter_nopack       - Avoid packing to work vector when possible (if used with -vecscatter_alltoall then will use MPI_Alltoallw()
+.  -vecscatter_shared       - Exchange the messages between processes on the same node through MPI-3 shared memory instead of MPI (needs MPI_Win_allocate_shared(), ignored otherwise)
+.  -vecscatter_runs <true,false> - Pack and unpack the messages as runs of blocks at a constant distance, by default when there are at most a quarter as many runs as blocks
 -  -vecscatter_reproduce    - insure that the order of the communications are done the same for each scatter, this under certain circumstances
                               will make the results of scatters deterministic when otherwise they are not (it may be slower also).
 
@@ -1715,6 +1719,129 @@ PetscErrorCode  VecScatterEnd(VecScatter ctx,Vec x,Vec y,InsertMode addv,Scatter
   PetscFunctionReturn(0);
 }
 
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterBeginMulti"
+/*@
+   VecScatterBeginMulti - Begins the scatter of several vectors at once with the same scatter
+   context. Complete the scattering phase with VecScatterEndMulti().
+
+   Neighbor-wise Collective on VecScatter and Vec
+
+   Input Parameters:
++  inctx - scatter context generated by VecScatterCreate()
+.  k - the number of vectors
+.  x - the k vectors from which we scatter
+.  y - the k vectors to which we scatter
+.  addv - either ADD_VALUES or INSERT_VALUES
+-  mode - the scattering mode, usually SCATTER_FORWARD.  The available modes are:
+    SCATTER_FORWARD or SCATTER_REVERSE
+
+   Level: advanced
+
+   Notes:
+   Has the same result as k calls of VecScatterBegin() and VecScatterEnd() with x[j] and y[j], but
+   for a parallel scatter sends one message with the values of all k vectors to each process, instead
+   of k messages, which is much cheaper when the messages are short. This is the case, for example, for
+   the ghost values of the columns of a dense matrix multiplied by a sparse one.
+
+   The message buffers grow with k and are kept in the scatter context for later calls.
+
+   Scatters that use -vecscatter_alltoall, -vecscatter_nopack, -vecscatter_window, -vecscatter_shared
+   or -vecscatter_rsend, and scatters between sequential vectors, scatter the vectors one at a time.
+
+   The values of the x[j] cannot be changed between the calls to VecScatterBeginMulti() and
+   VecScatterEndMulti().
+
+.seealso: VecScatterEndMulti(), VecScatterBegin(), VecScatterCreate()
+@*/
+PetscErrorCode  VecScatterBeginMulti(VecScatter inctx,PetscInt k,Vec x[],Vec y[],InsertMode addv,ScatterMode mode)
+{
+  PetscErrorCode ierr;
+  PetscInt       j;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(inctx,VEC_SCATTER_CLASSID,1);
+  if (k < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of vectors %D cannot be negative",k);
+  if (k) {
+    PetscValidPointer(x,3);
+    PetscValidPointer(y,4);
+  }
+  if (inctx->inuse) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE," Scatter ctx already in use");
+  if (!inctx->beginmulti) {
+    for (j=0; j<k; j++) {
+      ierr = VecScatterBegin(inctx,x[j],y[j],addv,mode);CHKERRQ(ierr);
+      ierr = VecScatterEnd(inctx,x[j],y[j],addv,mode);CHKERRQ(ierr);
+    }
+    PetscFunctionReturn(0);
+  }
+#if defined(PETSC_USE_DEBUG)
+  for (j=0; j<k; j++) {
+    PetscInt to_n,from_n;
+
+    PetscValidHeaderSpecific(x[j],VEC_CLASSID,3);
+    PetscValidHeaderSpecific(y[j],VEC_CLASSID,4);
+    ierr = VecGetLocalSize(x[j],&from_n);CHKERRQ(ierr);
+    ierr = VecGetLocalSize(y[j],&to_n);CHKERRQ(ierr);
+    if (mode & SCATTER_REVERSE) {
+      if (to_n != inctx->from_n || from_n != inctx->to_n) SETERRQ5(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Vectors %D wrong sizes %D and %D for reverse scatter %D and %D",j,from_n,to_n,inctx->to_n,inctx->from_n);
+    } else {
+      if (to_n != inctx->to_n || from_n != inctx->from_n) SETERRQ5(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Vectors %D wrong sizes %D and %D for scatter %D and %D",j,from_n,to_n,inctx->from_n,inctx->to_n);
+    }
+  }
+#endif
+  CHKMEMQ;
+
+  inctx->inuse = PETSC_TRUE;
+  ierr = PetscLogEventBarrierBegin(VEC_ScatterBarrier,0,0,0,0,((PetscObject)inctx)->comm);CHKERRQ(ierr);
+  ierr = (*inctx->beginmulti)(inctx,k,x,y,addv,mode);CHKERRQ(ierr);
+  if (inctx->beginandendtogether) {
+    inctx->inuse = PETSC_FALSE;
+    ierr = (*inctx->endmulti)(inctx,k,x,y,addv,mode);CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventBarrierEnd(VEC_ScatterBarrier,0,0,0,0,((PetscObject)inctx)->comm);CHKERRQ(ierr);
+  CHKMEMQ;
+  PetscFunctionReturn(0);
+}
+
+#undef __FUNCT__
+#define __FUNCT__ "VecScatterEndMulti"
+/*@
+   VecScatterEndMulti - Ends the scatter of several vectors at once.  Call
+   after first calling VecScatterBeginMulti().
+
+   Neighbor-wise Collective on VecScatter and Vec
+
+   Input Parameters:
++  ctx - scatter context generated by VecScatterCreate()
+.  k - the number of vectors
+.  x - the k vectors from which we scatter
+.  y - the k vectors to which we scatter
+.  addv - either ADD_VALUES or INSERT_VALUES.
+-  mode - the scattering mode, usually SCATTER_FORWARD.  The available modes are:
+     SCATTER_FORWARD, SCATTER_REVERSE
+
+   Level: advanced
+
+.seealso: VecScatterBeginMulti(), VecScatterEnd(), VecScatterCreate()
+@*/
+PetscErrorCode  VecScatterEndMulti(VecScatter ctx,PetscInt k,Vec x[],Vec y[],InsertMode addv,ScatterMode mode)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ctx,VEC_SCATTER_CLASSID,1);
+  ctx->inuse = PETSC_FALSE;
+  if (!ctx->endmulti) PetscFunctionReturn(0);
+  CHKMEMQ;
+  if (!ctx->beginandendtogether) {
+    ierr = PetscLogEventBegin(VEC_ScatterEnd,ctx,0,0,0);CHKERRQ(ierr);
+    ierr = (*ctx->endmulti)(ctx,k,x,y,addv,mode);CHKERRQ(ierr);
+    ierr = PetscLogEventEnd(VEC_ScatterEnd,ctx,0,0,0);CHKERRQ(ierr);
+  }
+  CHKMEMQ;
+  PetscFunctionReturn(0);
+}
+
 #undef __FUNCT__
 #define __FUNCT__ "VecScatterDestroy"
 /*@C
@@ -1841,6 +1968,7 @@ PetscErrorCode  VecScatterRemap(VecScatter scat,PetscInt *rto,PetscInt *rfrom)
   VecScatter_Seq_General *to,*from;
   VecScatter_MPI_General *mto;
   PetscInt               i;
+  PetscErrorCode         ierr;
 
   PetscFunctionBegin;
   PetscValidHeaderSpecific(scat,VEC_SCATTER_CLASSID,1);
@@ -1858,6 +1986,7 @@ PetscErrorCode  VecScatterRemap(VecScatter scat,PetscInt *rto,PetscInt *rfrom)
       for (i=0; i<mto->starts[mto->n]; i++) {
         mto->indices[i] = rto[mto->indices[i]];
       }
+      ierr = VecScatterRemapRuns_Private(scat,mto);CHKERRQ(ierr);
       /* handle local part */
       to = &mto->local;
       for (i=0; i<to->n; i++) {